@@ -0,0 +1,255 @@
+#ifndef LATENCY_HISTOGRAM_H_
+#define LATENCY_HISTOGRAM_H_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/cache_aligned.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * LatencyClock - The clock the latency harness reads around every operation
+ *
+ * On x86 it reads the time-stamp counter, which costs a few nanoseconds
+ * instead of the tens a steady_clock call may take, fenced so that the
+ * operation being timed can not move across the read. The tick length is
+ * calibrated once against steady_clock. Elsewhere it is steady_clock itself.
+ */
+class LatencyClock {
+ public:
+  static auto now() noexcept -> uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_lfence();
+    uint64_t ticks = __rdtsc();
+    _mm_lfence();
+    return ticks;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+
+  static auto ns_per_tick() -> double {
+    static const double kNsPerTick = calibrate();
+    return kNsPerTick;
+  }
+
+ private:
+  static auto calibrate() -> double {
+#if defined(__x86_64__) || defined(__i386__)
+    using Clock = std::chrono::steady_clock;
+    auto start_time = Clock::now();
+    uint64_t start_ticks = now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    uint64_t end_ticks = now();
+    auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() -
+                                                            start_time);
+    return elapsed.count() / static_cast<double>(end_ticks - start_ticks);
+#else
+    return 1.0;
+#endif
+  }
+};
+
+/**
+ * LatencyHistogram - A log-linear histogram of latencies in clock ticks, in
+ * the spirit of HdrHistogram
+ *
+ * Values below kSubBuckets are counted exactly. Above, every power of two is
+ * split into kSubBuckets / 2 equal buckets, so a percentile is off by at most
+ * 1 / 32 of its value (about 3%), whatever its magnitude. Recording is a few
+ * instructions on a fixed array and never allocates, so every thread records
+ * into its own histogram and they are merged afterwards.
+ */
+class LatencyHistogram {
+  static constexpr size_t kSubBucketBits = 6;
+  static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+  static constexpr size_t kHalfSubBuckets = kSubBuckets / 2;
+  static constexpr size_t kNumBuckets =
+      kSubBuckets + (64 - kSubBucketBits) * kHalfSubBuckets;
+
+ public:
+  auto record(uint64_t value) noexcept -> void {
+    counts_[index_of(value)]++;
+    total_++;
+    max_ = std::max(max_, value);
+  }
+
+  auto merge(const LatencyHistogram& other) noexcept -> void {
+    for (size_t i = 0; i < kNumBuckets; i++) {
+      counts_[i] += other.counts_[i];
+    }
+    total_ += other.total_;
+    max_ = std::max(max_, other.max_);
+  }
+
+  auto reset() noexcept -> void { *this = LatencyHistogram(); }
+
+  auto count() const noexcept -> uint64_t { return total_; }
+
+  auto max() const noexcept -> uint64_t { return max_; }
+
+  /**
+   * The smallest recorded value that at least a `p` fraction of all values
+   * does not exceed, rounded up to the end of its bucket
+   */
+  auto percentile(double p) const noexcept -> uint64_t {
+    if (total_ == 0) {
+      return 0;
+    }
+    auto rank = static_cast<uint64_t>(std::ceil(p * total_));
+    rank = std::clamp<uint64_t>(rank, 1, total_);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets; i++) {
+      seen += counts_[i];
+      if (seen >= rank) {
+        return std::min(highest_in(i), max_);
+      }
+    }
+    return max_;
+  }
+
+ private:
+  static auto index_of(uint64_t value) noexcept -> size_t {
+    if (value < kSubBuckets) {
+      return value;
+    }
+    // The position of the highest set bit, at least kSubBucketBits
+    size_t magnitude = std::bit_width(value) - 1;
+    size_t shift = magnitude - (kSubBucketBits - 1);
+    size_t sub_bucket = (value >> shift) - kHalfSubBuckets;
+    return kSubBuckets + (magnitude - kSubBucketBits) * kHalfSubBuckets +
+           sub_bucket;
+  }
+
+  static auto highest_in(size_t index) noexcept -> uint64_t {
+    if (index < kSubBuckets) {
+      return index;
+    }
+    size_t magnitude = (index - kSubBuckets) / kHalfSubBuckets + kSubBucketBits;
+    size_t sub_bucket = (index - kSubBuckets) % kHalfSubBuckets;
+    size_t shift = magnitude - (kSubBucketBits - 1);
+    return ((sub_bucket + kHalfSubBuckets + 1) << shift) - 1;
+  }
+
+  std::array<uint64_t, kNumBuckets> counts_{};
+  uint64_t total_{0};
+  uint64_t max_{0};
+};
+
+/**
+ * ThreadLatency - The latencies one benchmark thread records, and how long it
+ * was running
+ */
+class ThreadLatency {
+ public:
+  // Brackets the thread's share of one benchmark iteration
+  auto start() noexcept -> void { started_at_ = LatencyClock::now(); }
+
+  auto stop() noexcept -> void {
+    active_ticks_ += LatencyClock::now() - started_at_;
+  }
+
+  /**
+   * Runs `fn` as one operation and records its latency
+   */
+  template<typename Fn>
+  auto measure(Fn&& fn) -> void {
+    uint64_t begin = LatencyClock::now();
+    fn();
+    histogram_.record(LatencyClock::now() - begin);
+  }
+
+  auto histogram() const noexcept -> const LatencyHistogram& {
+    return histogram_;
+  }
+
+  // Operations per second while the thread was running
+  auto throughput() const noexcept -> double {
+    if (active_ticks_ == 0) {
+      return 0;
+    }
+    return histogram_.count() * 1e9 /
+           (active_ticks_ * LatencyClock::ns_per_tick());
+  }
+
+ private:
+  LatencyHistogram histogram_;
+  uint64_t started_at_{0};
+  uint64_t active_ticks_{0};
+};
+
+/**
+ * LatencyRecorder - Per-operation latency and fairness for multi-threaded
+ * benchmarks
+ *
+ * Thread `i` brackets its work with `thread(i).start()` and `stop()` and
+ * times each operation with `thread(i).measure(fn)`, across all iterations of
+ * the benchmark. report() merges the threads' histograms and adds the
+ * following counters, which Google Benchmark also writes as columns of its
+ * CSV output (`--benchmark_out_format=csv`) for the plot scripts:
+ *
+ * - p50_ns, p90_ns, p99_ns, p999_ns, max_ns: latency percentiles
+ * - thread_ops_min, thread_ops_max: the throughput of the slowest and fastest
+ *   thread, in operations per second
+ * - fairness: Jain's index of the per-thread throughputs, from 1 / n when one
+ *   thread does all the work up to 1 when all threads progress equally
+ *
+ * Timing adds two clock reads per operation, which the throughput of the same
+ * benchmark includes.
+ */
+class LatencyRecorder {
+ public:
+  explicit LatencyRecorder(size_t num_threads) : threads_(num_threads) {}
+
+  auto thread(size_t i) noexcept -> ThreadLatency& { return *threads_[i]; }
+
+  auto report(benchmark::State& state) const -> void {
+    LatencyHistogram merged;
+    double sum = 0;
+    double sum_of_squares = 0;
+    double min_throughput = 0;
+    double max_throughput = 0;
+    for (size_t i = 0; i < threads_.size(); i++) {
+      const ThreadLatency& latency = *threads_[i];
+      merged.merge(latency.histogram());
+      double throughput = latency.throughput();
+      sum += throughput;
+      sum_of_squares += throughput * throughput;
+      min_throughput =
+          i == 0 ? throughput : std::min(min_throughput, throughput);
+      max_throughput = std::max(max_throughput, throughput);
+    }
+
+    double ns_per_tick = LatencyClock::ns_per_tick();
+    auto to_ns = [ns_per_tick](uint64_t ticks) { return ticks * ns_per_tick; };
+    state.counters["p50_ns"] = to_ns(merged.percentile(0.5));
+    state.counters["p90_ns"] = to_ns(merged.percentile(0.9));
+    state.counters["p99_ns"] = to_ns(merged.percentile(0.99));
+    state.counters["p999_ns"] = to_ns(merged.percentile(0.999));
+    state.counters["max_ns"] = to_ns(merged.max());
+    state.counters["thread_ops_min"] = min_throughput;
+    state.counters["thread_ops_max"] = max_throughput;
+    state.counters["fairness"] =
+        sum_of_squares == 0 ? 1
+                            : sum * sum / (threads_.size() * sum_of_squares);
+  }
+
+ private:
+  // Padded so that threads recording at once do not share cache lines
+  std::vector<CacheAligned<ThreadLatency>> threads_;
+};
+
+#endif  // LATENCY_HISTOGRAM_H_
@@ -0,0 +1,166 @@
+#ifndef PERF_COUNTERS_H_
+#define PERF_COUNTERS_H_
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * PerfCounters - Hardware performance counters over a multi-threaded benchmark
+ *
+ * Counts instructions, cycles, last-level cache misses, branch misses and
+ * cache misses served by another NUMA node with perf_event_open. The counters
+ * are opened on the benchmark's main thread with `inherit` set, so they also
+ * count every thread it starts afterwards; a thread's counts are added once it
+ * exits, so stop() must come after the threads are joined. Google Benchmark's
+ * own `--benchmark_perf_counters` only counts the thread running the benchmark
+ * function, which here merely starts and joins the workers.
+ *
+ * Collection is off unless the environment variable LAMP_PERF_COUNTERS is set,
+ * so default runs keep their columns. Events the CPU or the kernel does not
+ * offer (e.g. under a hypervisor, or with a restrictive
+ * /proc/sys/kernel/perf_event_paranoid) are left out of the report. Usage:
+ *
+ *   PerfCounters perf;
+ *   perf.start();
+ *   for (auto _ : state) { ... }
+ *   perf.stop();
+ *   perf.report(state, total_operations);
+ *
+ * report() adds `<event>_per_op` counters and `ipc`, which Google Benchmark
+ * writes as columns of its CSV output. Setup done on the main thread between
+ * start() and stop(), even while timing is paused, is counted as well.
+ */
+class PerfCounters {
+  struct Event {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+  };
+
+#ifdef __linux__
+  static constexpr uint64_t kNodeReadMiss =
+      PERF_COUNT_HW_CACHE_NODE | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+  static constexpr std::array<Event, 5> kEvents{{
+      {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {"cache_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      {"remote_node_misses", PERF_TYPE_HW_CACHE, kNodeReadMiss},
+  }};
+#else
+  static constexpr std::array<Event, 0> kEvents{};
+#endif
+
+ public:
+  PerfCounters() {
+    fds_.fill(-1);
+    if (std::getenv("LAMP_PERF_COUNTERS") == nullptr) {
+      return;
+    }
+#ifdef __linux__
+    for (size_t i = 0; i < kEvents.size(); i++) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = kEvents[i].type;
+      attr.config = kEvents[i].config;
+      attr.disabled = 1;
+      attr.inherit = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      // To scale the count up if the event shared its counter with others
+      attr.read_format =
+          PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      fds_[i] = static_cast<int>(
+          syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  auto operator=(const PerfCounters&) -> PerfCounters& = delete;
+
+  ~PerfCounters() {
+#ifdef __linux__
+    for (int fd : fds_) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+  auto start() -> void {
+#ifdef __linux__
+    for (int fd : fds_) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+
+  auto stop() -> void {
+#ifdef __linux__
+    for (size_t i = 0; i < kEvents.size(); i++) {
+      if (fds_[i] < 0) {
+        continue;
+      }
+      ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+      // The value, then the time the event was enabled and running
+      uint64_t values[3];
+      if (read(fds_[i], values, sizeof(values)) != sizeof(values)) {
+        continue;
+      }
+      counts_[i] = values[2] == 0 ? 0
+                                  : static_cast<double>(values[0]) *
+                                        values[1] / values[2];
+      valid_[i] = true;
+    }
+#endif
+  }
+
+  /**
+   * Adds every counted event divided by `operations`, and the instructions
+   * per cycle, to the benchmark's counters
+   */
+  auto report(benchmark::State& state, double operations) const -> void {
+    if (operations <= 0) {
+      return;
+    }
+    for (size_t i = 0; i < kEvents.size(); i++) {
+      if (valid_[i]) {
+        state.counters[std::string(kEvents[i].name) + "_per_op"] =
+            counts_[i] / operations;
+      }
+    }
+    // Instructions and cycles are the first two events
+    if constexpr (kEvents.size() >= 2) {
+      if (valid_[0] && valid_[1] && counts_[1] > 0) {
+        state.counters["ipc"] = counts_[0] / counts_[1];
+      }
+    }
+  }
+
+ private:
+  std::array<int, kEvents.size()> fds_;
+  std::array<double, kEvents.size()> counts_{};
+  std::array<bool, kEvents.size()> valid_{};
+};
+
+#endif  // PERF_COUNTERS_H_
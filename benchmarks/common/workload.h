@@ -0,0 +1,305 @@
+#ifndef WORKLOAD_H_
+#define WORKLOAD_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/perf_counters.h"
+#include "util/backoff.h"
+
+/**
+ * How the keys of a workload are drawn from [1, key_range]
+ *
+ * - kUniform: every key equally often
+ * - kZipfian: the key of rank r with a probability proportional to
+ *   1 / r^theta, as in YCSB. Ranks are scattered over the key range, so the
+ *   hot keys are not all at the head of a sorted list.
+ * - kHotspot: a `hot_ops` fraction of the operations on a `hot_keys` fraction
+ *   of the keys, scattered the same way, and the rest uniformly
+ * - kSequential: every thread walks the key range in order from its own
+ *   starting point
+ */
+enum class KeyDistribution : int {
+  kUniform,
+  kZipfian,
+  kHotspot,
+  kSequential,
+};
+
+enum class WorkloadOp {
+  kContains,
+  kAdd,
+  kRemove,
+  kScan,
+};
+
+/**
+ * OpMix - The percentages of each operation, which add up to 100
+ */
+struct OpMix {
+  int contains_;
+  int add_;
+  int remove_;
+  int scan_{0};
+};
+
+/**
+ * WorkloadSpec - A set workload: its operation mix, its key distribution and
+ * the size the set settles at
+ *
+ * The key range is chosen so that the set holds about `size` keys in steady
+ * state: every operation on a key leaves it present with probability
+ * add / (add + remove), whatever the distribution, so the range is
+ * size * (add + remove) / add keys.
+ */
+struct WorkloadSpec {
+  int size_;
+  OpMix mix_;
+  KeyDistribution distribution_{KeyDistribution::kUniform};
+  double zipf_theta_{0.99};
+  double hot_keys_{0.2};
+  double hot_ops_{0.8};
+  // The number of consecutive keys a scan visits
+  int scan_length_{100};
+
+  auto key_range() const -> int {
+    if (mix_.add_ == 0) {
+      return 2 * size_;
+    }
+    return static_cast<int>(static_cast<int64_t>(size_) *
+                            (mix_.add_ + mix_.remove_) / mix_.add_);
+  }
+
+  // The fraction of the key range present in steady state
+  auto occupancy() const -> double {
+    if (mix_.add_ + mix_.remove_ == 0) {
+      return 0.5;
+    }
+    return static_cast<double>(mix_.add_) / (mix_.add_ + mix_.remove_);
+  }
+};
+
+/**
+ * Workload - The state of a WorkloadSpec that threads share, computed once
+ */
+class Workload {
+ public:
+  explicit Workload(const WorkloadSpec& spec)
+      : spec_(spec), key_range_(spec.key_range()) {
+    if (spec_.distribution_ == KeyDistribution::kZipfian) {
+      // Gray et al., "Quickly generating billion-record synthetic databases"
+      double theta = spec_.zipf_theta_;
+      zeta_n_ = zeta(key_range_, theta);
+      alpha_ = 1 / (1 - theta);
+      eta_ = (1 - std::pow(2.0 / key_range_, 1 - theta)) /
+             (1 - zeta(2, theta) / zeta_n_);
+      half_pow_theta_ = 1 + std::pow(0.5, theta);
+    }
+  }
+
+  auto spec() const -> const WorkloadSpec& { return spec_; }
+
+  auto key_range() const -> int { return key_range_; }
+
+  /**
+   * Adds each key of the range with the steady-state probability, so that
+   * measurements start from the state the workload converges to
+   */
+  template<typename Set>
+  auto prefill(Set& set) const -> void {
+    double occupancy = spec_.occupancy();
+    auto threshold = static_cast<uint64_t>(occupancy * 0x1.0p64);
+    for (int key = 1; key <= key_range_; key++) {
+      if (occupancy >= 1 || random_uint64() < threshold) {
+        set.add(key);
+      }
+    }
+  }
+
+ private:
+  friend class WorkloadThread;
+
+  static auto zeta(int n, double theta) -> double {
+    double sum = 0;
+    for (int i = 1; i <= n; i++) {
+      sum += 1 / std::pow(static_cast<double>(i), theta);
+    }
+    return sum;
+  }
+
+  // Maps a rank to a key, a bijection of [0, key_range) that spreads
+  // neighboring ranks over the range
+  auto scatter(uint64_t rank) const -> int {
+    constexpr uint64_t kPrime = 2654435761;  // coprime to any smaller range
+    return static_cast<int>(rank * kPrime % key_range_) + 1;
+  }
+
+  WorkloadSpec spec_;
+  int key_range_;
+  double zeta_n_{0};
+  double alpha_{0};
+  double eta_{0};
+  double half_pow_theta_{0};
+};
+
+/**
+ * WorkloadThread - Draws the operations of one benchmark thread
+ *
+ * Draws come from the thread's own wyrand generator (random_uint64()), which
+ * takes no lock and shares no state, unlike rand() or a shared engine.
+ */
+class WorkloadThread {
+ public:
+  WorkloadThread(const Workload& workload, int thread_id, int num_threads)
+      : workload_(workload),
+        next_sequential_(static_cast<int64_t>(workload.key_range_) *
+                         thread_id / num_threads) {}
+
+  auto next_op() -> WorkloadOp {
+    const OpMix& mix = workload_.spec_.mix_;
+    int percent = static_cast<int>(random_below(100));
+    if (percent < mix.contains_) {
+      return WorkloadOp::kContains;
+    }
+    percent -= mix.contains_;
+    if (percent < mix.add_) {
+      return WorkloadOp::kAdd;
+    }
+    percent -= mix.add_;
+    if (percent < mix.remove_) {
+      return WorkloadOp::kRemove;
+    }
+    return WorkloadOp::kScan;
+  }
+
+  auto next_key() -> int {
+    const WorkloadSpec& spec = workload_.spec_;
+    uint64_t range = workload_.key_range_;
+    switch (spec.distribution_) {
+      case KeyDistribution::kUniform:
+        return static_cast<int>(random_below(range)) + 1;
+      case KeyDistribution::kZipfian:
+        return workload_.scatter(zipfian_rank());
+      case KeyDistribution::kHotspot: {
+        auto hot = std::max<uint64_t>(1, spec.hot_keys_ * range);
+        if (random_fraction() < spec.hot_ops_) {
+          return workload_.scatter(random_below(hot));
+        }
+        return workload_.scatter(hot + random_below(range - hot));
+      }
+      case KeyDistribution::kSequential:
+        next_sequential_ = (next_sequential_ + 1) % range;
+        return static_cast<int>(next_sequential_) + 1;
+    }
+    return 1;
+  }
+
+  /**
+   * Draws an operation and a key and applies it to `set`. A scan visits the
+   * keys in [key, key + scan_length) with for_each_in_range(), or with one
+   * contains() per key on sets that cannot be traversed.
+   */
+  template<typename Set>
+  auto run_one(Set& set) -> void {
+    WorkloadOp op = next_op();
+    int key = next_key();
+    switch (op) {
+      case WorkloadOp::kContains:
+        benchmark::DoNotOptimize(set.contains(key));
+        break;
+      case WorkloadOp::kAdd:
+        benchmark::DoNotOptimize(set.add(key));
+        break;
+      case WorkloadOp::kRemove:
+        benchmark::DoNotOptimize(set.remove(key));
+        break;
+      case WorkloadOp::kScan:
+        scan(set, key, key + workload_.spec_.scan_length_);
+        break;
+    }
+  }
+
+ private:
+  template<typename Set>
+  static auto scan(Set& set, int lo, int hi) -> void {
+    int found = 0;
+    if constexpr (requires { set.for_each_in_range(lo, hi, [](int) {}); }) {
+      // for_each_in_range() includes its upper bound
+      set.for_each_in_range(lo, hi - 1, [&found](int) { found++; });
+    } else {
+      for (int key = lo; key < hi; key++) {
+        found += set.contains(key);
+      }
+    }
+    benchmark::DoNotOptimize(found);
+  }
+
+  // A uniform number in [0, n), by a multiply-shift
+  static auto random_below(uint64_t n) -> uint64_t {
+    return static_cast<uint64_t>(
+        (static_cast<unsigned __int128>(random_uint64()) * n) >> 64);
+  }
+
+  static auto random_fraction() -> double {
+    return static_cast<double>(random_uint64() >> 11) * 0x1.0p-53;
+  }
+
+  auto zipfian_rank() -> uint64_t {
+    double u = random_fraction();
+    double uz = u * workload_.zeta_n_;
+    if (uz < 1) {
+      return 0;
+    }
+    if (uz < workload_.half_pow_theta_) {
+      return 1;
+    }
+    auto rank = static_cast<uint64_t>(
+        workload_.key_range_ *
+        std::pow(workload_.eta_ * u - workload_.eta_ + 1, workload_.alpha_));
+    return std::min<uint64_t>(rank, workload_.key_range_ - 1);
+  }
+
+  const Workload& workload_;
+  int64_t next_sequential_;
+};
+
+/**
+ * Runs `ops_per_thread` operations of `workload` on `set` from each of
+ * `num_threads` threads, once per benchmark iteration. Reports the `ops`
+ * throughput counter, and the hardware counters per operation when
+ * PerfCounters is enabled.
+ */
+template<typename Set>
+auto run_workload(benchmark::State& state, Set& set, const Workload& workload,
+                  int num_threads, int ops_per_thread) -> void {
+  PerfCounters perf;
+  perf.start();
+  for (auto _ : state) {
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        WorkloadThread thread(workload, t, num_threads);
+        for (int i = 0; i < ops_per_thread; ++i) {
+          thread.run_one(set);
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+  perf.stop();
+
+  double operations =
+      static_cast<double>(state.iterations()) * num_threads * ops_per_thread;
+  state.counters["ops"] =
+      benchmark::Counter(operations, benchmark::Counter::kIsRate);
+  perf.report(state, operations);
+}
+
+#endif  // WORKLOAD_H_
@@ -0,0 +1,104 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "counting/combining_tree.h"
+#include "counting/counting_network.h"
+#include "counting/sharded_counter.h"
+
+static constexpr int kMaxThreads = 32;
+
+// The baseline: every thread increments a single atomic
+class AtomicCounter {
+ public:
+  explicit AtomicCounter(size_t /*width*/) {}
+
+  auto get_and_increment() -> int64_t {
+    return counter_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<int64_t> counter_{0};
+};
+
+// Every thread increments the counter kNumIterations times, as in
+// lock_benchmark's ProtectedCounter loop
+template<typename CounterType>
+static void BM_Counter(benchmark::State& state) {
+  const uint32_t kNumThreads = state.range(0);
+  constexpr uint32_t kNumIterations = 10000;
+
+  for (auto _ : state) {
+    CounterType counter(kNumThreads);
+
+    // Barrier to synchronize thread start
+    std::atomic<bool> start{false};
+    std::atomic<uint32_t> threads_ready{0};
+
+    std::vector<std::thread> threads;
+    threads.reserve(kNumThreads);
+    for (uint32_t i = 0; i < kNumThreads; i++) {
+      threads.emplace_back([&counter, &start, &threads_ready]() {
+        threads_ready.fetch_add(1);
+        while (!start.load(std::memory_order_acquire)) {
+          std::this_thread::yield();
+        }
+        for (uint32_t j = 0; j < kNumIterations; j++) {
+          benchmark::DoNotOptimize(counter.get_and_increment());
+        }
+      });
+    }
+    while (threads_ready.load() < kNumThreads) {
+      std::this_thread::yield();
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    start.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+      t.join();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end_time - start_time);
+
+    state.SetIterationTime(elapsed.count() / 1e9);
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * kNumThreads *
+                          kNumIterations);
+}
+
+BENCHMARK(BM_Counter<AtomicCounter>)
+    ->RangeMultiplier(2)
+    ->Range(1, kMaxThreads)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Counter<CombiningTree>)
+    ->RangeMultiplier(2)
+    ->Range(1, kMaxThreads)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Counter<CountingNetwork<Bitonic>>)
+    ->RangeMultiplier(2)
+    ->Range(1, kMaxThreads)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Counter<CountingNetwork<Periodic>>)
+    ->RangeMultiplier(2)
+    ->Range(1, kMaxThreads)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Counter<ShardedCounter>)
+    ->RangeMultiplier(2)
+    ->Range(1, kMaxThreads)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
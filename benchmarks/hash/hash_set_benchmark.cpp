@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/workload.h"
+#include "hash/lock_free_hash_map.h"
+#include "hash/lock_free_hash_set.h"
+#include "hash/refinable_hash_set.h"
+#include "hash/striped_hash_set.h"
+#include "synchronization/backoff_lock.h"
+#include "synchronization/mcs_lock.h"
+#include "synchronization/ttas_lock.h"
+
+// Constants for benchmark configuration
+constexpr int kInitialSize = 10000;
+constexpr int kOperationsPerThread = 100000;
+constexpr int kMaxThreads = 8;
+// Sizes of the large-table benchmarks, far beyond the last-level cache
+constexpr int kLargeSizes[] = {1000000, 10000000, 100000000};
+
+using StripedTTASSet = StripedHashSet<int, TTASLock<>>;
+using StripedBackoffSet =
+    StripedHashSet<int, BackoffLock<std::chrono::microseconds>>;
+using StripedMCSSet = StripedHashSet<int, MCSLock<>>;
+using RefinableTTASSet = RefinableHashSet<int, TTASLock<>>;
+using RefinableBackoffSet =
+    RefinableHashSet<int, BackoffLock<std::chrono::microseconds>>;
+using RefinableMCSSet = RefinableHashSet<int, MCSLock<>>;
+
+// Runs LockFreeHashMap through the set workloads, with every key mapped to
+// itself
+class LockFreeHashMapSet {
+ public:
+  auto add(int key) -> bool { return map_.insert(key, key); }
+  auto remove(int key) -> bool { return map_.erase(key); }
+  auto contains(int key) -> bool { return map_.contains(key); }
+
+ private:
+  LockFreeHashMap<int, int> map_;
+};
+
+// Benchmark for write-heavy workload (20% contains, 40% add, 40% remove) on a
+// table that is already large enough, so it rarely resizes. `state.range(1)`
+// is the KeyDistribution.
+template<typename SetType>
+static void BM_WriteHeavyWorkload(benchmark::State& state) {
+  const int thread_count = state.range(0);
+  const auto distribution = static_cast<KeyDistribution>(state.range(1));
+
+  Workload workload(WorkloadSpec{kInitialSize, {20, 40, 40}, distribution});
+  SetType set;
+  workload.prefill(set);
+  run_workload(state, set, workload, thread_count, kOperationsPerThread);
+}
+
+// Every thread inserts distinct keys into an initially empty set, so the table
+// doubles many times under load. Reports the longest single add(), which is
+// the pause a caller observes when it has to wait for (or perform) a resize.
+template<typename SetType>
+static void BM_ResizeUnderLoad(benchmark::State& state) {
+  const int thread_count = state.range(0);
+  double max_pause_us = 0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto set = std::make_unique<SetType>();
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    std::vector<double> thread_max_pause_us(thread_count, 0);
+    state.ResumeTiming();
+
+    for (int t = 0; t < thread_count; ++t) {
+      threads.emplace_back([&set, &thread_max_pause_us, thread_count, t]() {
+        double max_us = 0;
+        for (int i = 0; i < kOperationsPerThread; ++i) {
+          auto start = std::chrono::steady_clock::now();
+          set->add(i * thread_count + t);
+          auto end = std::chrono::steady_clock::now();
+          max_us = std::max(
+              max_us,
+              std::chrono::duration<double, std::micro>(end - start).count());
+        }
+        thread_max_pause_us[t] = max_us;
+      });
+    }
+
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    state.PauseTiming();
+    for (double pause_us : thread_max_pause_us) {
+      max_pause_us = std::max(max_pause_us, pause_us);
+    }
+    set.reset();
+    state.ResumeTiming();
+  }
+
+  state.counters["ops"] = benchmark::Counter(
+      static_cast<double>(thread_count) * kOperationsPerThread *
+          state.iterations(),
+      benchmark::Counter::kIsRate);
+  state.counters["max_pause_us"] = max_pause_us;
+}
+
+// Benchmark for read-heavy workload (90% contains, 5% add, 5% remove) on a
+// table of `state.range(1)` keys, where nearly every lookup misses the cache
+template<typename SetType>
+static void BM_LargeReadHeavyWorkload(benchmark::State& state) {
+  const int thread_count = state.range(0);
+  const int size = state.range(1);
+
+  Workload workload(WorkloadSpec{size, {90, 5, 5}});
+  SetType set;
+  workload.prefill(set);
+  run_workload(state, set, workload, thread_count, kOperationsPerThread);
+}
+
+#define REGISTER_HASH_SET_BENCHMARKS(SetType)              \
+  BENCHMARK(BM_WriteHeavyWorkload<SetType>)                \
+      ->ArgsProduct(                                       \
+          {benchmark::CreateRange(1, kMaxThreads, 2),      \
+           {static_cast<int64_t>(KeyDistribution::kUniform), \
+            static_cast<int64_t>(KeyDistribution::kZipfian)}}) \
+      ->Unit(benchmark::kMillisecond)                      \
+      ->UseRealTime();                                     \
+  BENCHMARK(BM_ResizeUnderLoad<SetType>)                   \
+      ->RangeMultiplier(2)                                 \
+      ->Range(1, kMaxThreads)                              \
+      ->Unit(benchmark::kMillisecond)                      \
+      ->UseRealTime();
+
+REGISTER_HASH_SET_BENCHMARKS(StripedTTASSet)
+REGISTER_HASH_SET_BENCHMARKS(StripedBackoffSet)
+REGISTER_HASH_SET_BENCHMARKS(StripedMCSSet)
+REGISTER_HASH_SET_BENCHMARKS(RefinableTTASSet)
+REGISTER_HASH_SET_BENCHMARKS(RefinableBackoffSet)
+REGISTER_HASH_SET_BENCHMARKS(RefinableMCSSet)
+REGISTER_HASH_SET_BENCHMARKS(LockFreeHashSet<int>)
+REGISTER_HASH_SET_BENCHMARKS(LockFreeHashMapSet)
+
+#define REGISTER_LARGE_HASH_SET_BENCHMARK(SetType)                          \
+  BENCHMARK(BM_LargeReadHeavyWorkload<SetType>)                             \
+      ->ArgsProduct({benchmark::CreateRange(1, kMaxThreads, 2),             \
+                     {std::begin(kLargeSizes), std::end(kLargeSizes)}})     \
+      ->Unit(benchmark::kMillisecond)                                       \
+      ->UseRealTime();
+
+REGISTER_LARGE_HASH_SET_BENCHMARK(StripedTTASSet)
+REGISTER_LARGE_HASH_SET_BENCHMARK(LockFreeHashSet<int>)
+REGISTER_LARGE_HASH_SET_BENCHMARK(LockFreeHashMapSet)
+
+BENCHMARK_MAIN();
@@ -4,16 +4,33 @@
 #include <vector>
 
 #include "benchmark/benchmark.h"
+#include "common/latency_histogram.h"
+#include "common/workload.h"
+#include "hash/lock_free_hash_set.h"
 #include "list/coarse_list.h"
 #include "list/fine_list.h"
 #include "list/lazy_list.h"
 #include "list/lock_free_list.h"
 #include "list/optimistic_list.h"
+#include "list/unrolled_lazy_list.h"
+#include "memory/pool_allocator.h"
+#include "skiplist/lazy_skip_list.h"
+#include "skiplist/lock_free_skip_list.h"
+#include "synchronization/backoff_lock.h"
+#include "synchronization/elided_lock.h"
+#include "synchronization/mcs_lock.h"
+#include "synchronization/qspin_lock.h"
+#include "synchronization/shared_ttas_lock.h"
+#include "synchronization/ticket_lock.h"
+#include "synchronization/ttas_lock.h"
+#include "tree/optimistic_btree.h"
+#include "util/sharded.h"
 
 // Constants for benchmark configuration
 constexpr int kSmallSize = 100;
 constexpr int kMediumSize = 1000;
 constexpr int kLargeSize = 10000;
+constexpr int kHugeSize = 1000000;  // Only for the hash set, skip lists, tree
 constexpr int kOperationsPerThread = 100000;
 constexpr int kMaxThreads = 8;
 
@@ -29,153 +46,175 @@ void InitializeList(ListType& list, int size) {
   }
 }
 
-// Benchmark for read-heavy workload (80% contains, 15% add, 5% remove)
+// Runs `mix` with keys drawn from `distribution` on a set prefilled to the
+// steady state in which it holds about `list_size` keys
 template<typename ListType>
-static void BM_ReadHeavyWorkload(benchmark::State& state) {
+static void RunWorkload(benchmark::State& state, OpMix mix,
+                        KeyDistribution distribution) {
   const int thread_count = state.range(0);
   const int list_size = state.range(1);
 
+  Workload workload(WorkloadSpec{list_size, mix, distribution});
   ListType list;
-  InitializeList(list, list_size);
+  workload.prefill(list);
+  run_workload(state, list, workload, thread_count, kOperationsPerThread);
+}
 
-  std::atomic<int> counter(0);
+// Benchmark for read-heavy workload (80% contains, 15% add, 5% remove)
+template<typename ListType>
+static void BM_ReadHeavyWorkload(benchmark::State& state) {
+  RunWorkload<ListType>(state, {80, 15, 5}, KeyDistribution::kUniform);
+}
 
-  for (auto _ : state) {
-    state.PauseTiming();
-    std::vector<std::thread> threads;
-    threads.reserve(thread_count);
-    counter.store(0);
-    state.ResumeTiming();
+// Benchmark for write-heavy workload (20% contains, 40% add, 40% remove)
+template<typename ListType>
+static void BM_WriteHeavyWorkload(benchmark::State& state) {
+  RunWorkload<ListType>(state, {20, 40, 40}, KeyDistribution::kUniform);
+}
 
-    for (int t = 0; t < thread_count; ++t) {
-      threads.emplace_back([&list, &counter, list_size]() {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> val_dist(1, list_size * 10);
-        std::uniform_int_distribution<> op_dist(1, 100);
+// Benchmark for balanced workload (34% contains, 33% add, 33% remove)
+template<typename ListType>
+static void BM_BalancedWorkload(benchmark::State& state) {
+  RunWorkload<ListType>(state, {34, 33, 33}, KeyDistribution::kUniform);
+}
 
-        for (int i = 0; i < kOperationsPerThread; ++i) {
-          int op = op_dist(gen);
-          int val = val_dist(gen);
+// The read-heavy mix with skewed keys: `state.range(2)` is a KeyDistribution.
+// Hot keys contend on the same nodes, which uniform keys rarely do.
+template<typename ListType>
+static void BM_SkewedWorkload(benchmark::State& state) {
+  RunWorkload<ListType>(state, {80, 15, 5},
+                        static_cast<KeyDistribution>(state.range(2)));
+}
 
-          if (op <= 80) {
-            // 80% contains operations
-            list.contains(val);
-          } else if (op <= 95) {
-            // 15% add operations
-            list.add(val);
-          } else {
-            // 5% remove operations
-            list.remove(val);
-          }
-          counter.fetch_add(1, std::memory_order_relaxed);
-        }
-      });
-    }
+// A mix with 10% range scans of 100 keys, with Zipfian keys
+template<typename ListType>
+static void BM_ScanWorkload(benchmark::State& state) {
+  RunWorkload<ListType>(state, {70, 10, 10, 10}, KeyDistribution::kZipfian);
+}
 
-    for (auto& t : threads) {
-      t.join();
-    }
+// Benchmark for single operations with different list sizes
+template<typename ListType, typename OperationType>
+static void BM_SingleOperation(benchmark::State& state, OperationType operation,
+                               ListType*) {
+  const int list_size = state.range(0);
+
+  ListType list;
+  InitializeList(list, list_size);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<> val_dist(1, list_size * 10);
+
+  for (auto _ : state) {
+    int val = val_dist(gen);
+    operation(list, val);
   }
+}
 
-  state.counters["ops"] =
-      benchmark::Counter(counter.load(), benchmark::Counter::kIsRate);
+// Starts a thread that adds and removes random values until `done` is set
+template<typename ListType>
+std::thread StartBackgroundWriter(ListType& list, int size,
+                                  std::atomic<bool>& done) {
+  return std::thread([&list, &done, size]() {
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<> val_dist(1, size * 10);
+    while (!done.load(std::memory_order_relaxed)) {
+      int val = val_dist(gen);
+      list.add(val);
+      list.remove(val);
+    }
+  });
 }
 
-// Benchmark for write-heavy workload (20% contains, 40% add, 40% remove)
+// Benchmark for reading every item of the list with a single weakly
+// consistent traversal, while another thread keeps updating it
 template<typename ListType>
-static void BM_WriteHeavyWorkload(benchmark::State& state) {
-  const int thread_count = state.range(0);
-  const int list_size = state.range(1);
+static void BM_RangeScan(benchmark::State& state) {
+  const int list_size = state.range(0);
 
   ListType list;
   InitializeList(list, list_size);
+  std::atomic<bool> done(false);
+  std::thread writer = StartBackgroundWriter(list, list_size, done);
 
-  std::atomic<int> counter(0);
-
+  int64_t items = 0;
   for (auto _ : state) {
-    state.PauseTiming();
-    std::vector<std::thread> threads;
-    threads.reserve(thread_count);
-    counter.store(0);
-    state.ResumeTiming();
+    list.for_each_in_range(1, list_size * 10, [&items](int) { items++; });
+  }
 
-    for (int t = 0; t < thread_count; ++t) {
-      threads.emplace_back([&list, &counter, list_size]() {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> val_dist(1, list_size * 10);
-        std::uniform_int_distribution<> op_dist(1, 100);
+  done.store(true);
+  writer.join();
+  state.counters["items"] = benchmark::Counter(static_cast<double>(items),
+                                               benchmark::Counter::kIsRate);
+}
 
-        for (int i = 0; i < kOperationsPerThread; ++i) {
-          int op = op_dist(gen);
-          int val = val_dist(gen);
+// The same read with one contains() per candidate value, as callers had to do
+// before the lists could be traversed
+template<typename ListType>
+static void BM_ContainsScan(benchmark::State& state) {
+  const int list_size = state.range(0);
 
-          if (op <= 20) {
-            // 20% contains operations
-            list.contains(val);
-          } else if (op <= 60) {
-            // 40% add operations
-            list.add(val);
-          } else {
-            // 40% remove operations
-            list.remove(val);
-          }
-          counter.fetch_add(1);
-        }
-      });
-    }
+  ListType list;
+  InitializeList(list, list_size);
+  std::atomic<bool> done(false);
+  std::thread writer = StartBackgroundWriter(list, list_size, done);
 
-    for (auto& t : threads) {
-      t.join();
+  int64_t items = 0;
+  for (auto _ : state) {
+    for (int val = 1; val <= list_size * 10; ++val) {
+      if (list.contains(val)) {
+        items++;
+      }
     }
   }
 
-  state.counters["ops"] =
-      benchmark::Counter(counter.load(), benchmark::Counter::kIsRate);
+  done.store(true);
+  writer.join();
+  state.counters["items"] = benchmark::Counter(static_cast<double>(items),
+                                               benchmark::Counter::kIsRate);
 }
 
-// Benchmark for balanced workload (33% contains, 33% add, 33% remove)
+// The read-heavy mix with every operation timed. Reports latency percentiles,
+// where the lists that lock or restart their traversal on a conflict show a
+// longer tail than their throughput suggests, and per-thread fairness.
 template<typename ListType>
-static void BM_BalancedWorkload(benchmark::State& state) {
+static void BM_OperationLatency(benchmark::State& state) {
   const int thread_count = state.range(0);
   const int list_size = state.range(1);
 
   ListType list;
   InitializeList(list, list_size);
-
-  std::atomic<int> counter(0);
+  LatencyRecorder recorder(thread_count);
 
   for (auto _ : state) {
     state.PauseTiming();
     std::vector<std::thread> threads;
     threads.reserve(thread_count);
-    counter.store(0);
     state.ResumeTiming();
 
     for (int t = 0; t < thread_count; ++t) {
-      threads.emplace_back([&list, &counter, list_size]() {
+      threads.emplace_back([&list, &recorder, t, list_size]() {
         std::random_device rd;
         std::mt19937 gen(rd());
         std::uniform_int_distribution<> val_dist(1, list_size * 10);
         std::uniform_int_distribution<> op_dist(1, 100);
+        ThreadLatency& latency = recorder.thread(t);
 
+        latency.start();
         for (int i = 0; i < kOperationsPerThread; ++i) {
           int op = op_dist(gen);
           int val = val_dist(gen);
-
-          if (op <= 33) {
-            // 33% contains operations
-            list.contains(val);
-          } else if (op <= 66) {
-            // 33% add operations
-            list.add(val);
-          } else {
-            // 33% remove operations
-            list.remove(val);
-          }
-          counter.fetch_add(1);
+          latency.measure([&list, op, val]() {
+            if (op <= 80) {
+              list.contains(val);
+            } else if (op <= 95) {
+              list.add(val);
+            } else {
+              list.remove(val);
+            }
+          });
         }
+        latency.stop();
       });
     }
 
@@ -184,27 +223,9 @@ static void BM_BalancedWorkload(benchmark::State& state) {
     }
   }
 
-  state.counters["ops"] =
-      benchmark::Counter(counter.load(), benchmark::Counter::kIsRate);
-}
-
-// Benchmark for single operations with different list sizes
-template<typename ListType, typename OperationType>
-static void BM_SingleOperation(benchmark::State& state, OperationType operation,
-                               ListType*) {
-  const int list_size = state.range(0);
-
-  ListType list;
-  InitializeList(list, list_size);
-
-  std::random_device rd;
-  std::mt19937 gen(rd());
-  std::uniform_int_distribution<> val_dist(1, list_size * 10);
-
-  for (auto _ : state) {
-    int val = val_dist(gen);
-    operation(list, val);
-  }
+  recorder.report(state);
+  state.SetItemsProcessed(state.iterations() * thread_count *
+                          kOperationsPerThread);
 }
 
 // Define operations as function objects
@@ -244,6 +265,24 @@ REGISTER_READ_HEAVY_BENCHMARK(FineList<int>)
 REGISTER_READ_HEAVY_BENCHMARK(OptimisticList<int>)
 REGISTER_READ_HEAVY_BENCHMARK(LazyList<int>)
 REGISTER_READ_HEAVY_BENCHMARK(LockFreeList<int>)
+REGISTER_READ_HEAVY_BENCHMARK(UnrolledLazyList<int>)
+REGISTER_READ_HEAVY_BENCHMARK(LockFreeHashSet<int>)
+REGISTER_READ_HEAVY_BENCHMARK(LazySkipList<int>)
+REGISTER_READ_HEAVY_BENCHMARK(LockFreeSkipList<int>)
+REGISTER_READ_HEAVY_BENCHMARK(OptimisticBTree<int>)
+
+// The hash set and the skip lists are the only sets that can hold millions of
+// items
+#define REGISTER_HUGE_READ_HEAVY_BENCHMARK(ListType)                         \
+  BENCHMARK(BM_ReadHeavyWorkload<ListType>)                                  \
+      ->ArgsProduct({benchmark::CreateRange(1, kMaxThreads, 2), {kHugeSize}}) \
+      ->Unit(benchmark::kMillisecond)                                        \
+      ->UseRealTime();
+
+REGISTER_HUGE_READ_HEAVY_BENCHMARK(LockFreeHashSet<int>)
+REGISTER_HUGE_READ_HEAVY_BENCHMARK(LazySkipList<int>)
+REGISTER_HUGE_READ_HEAVY_BENCHMARK(LockFreeSkipList<int>)
+REGISTER_HUGE_READ_HEAVY_BENCHMARK(OptimisticBTree<int>)
 
 // Write-heavy workload benchmarks
 #define REGISTER_WRITE_HEAVY_BENCHMARK(ListType)                \
@@ -258,6 +297,84 @@ REGISTER_WRITE_HEAVY_BENCHMARK(FineList<int>)
 REGISTER_WRITE_HEAVY_BENCHMARK(OptimisticList<int>)
 REGISTER_WRITE_HEAVY_BENCHMARK(LazyList<int>)
 REGISTER_WRITE_HEAVY_BENCHMARK(LockFreeList<int>)
+REGISTER_WRITE_HEAVY_BENCHMARK(UnrolledLazyList<int>)
+REGISTER_WRITE_HEAVY_BENCHMARK(LockFreeHashSet<int>)
+REGISTER_WRITE_HEAVY_BENCHMARK(LazySkipList<int>)
+REGISTER_WRITE_HEAVY_BENCHMARK(LockFreeSkipList<int>)
+REGISTER_WRITE_HEAVY_BENCHMARK(OptimisticBTree<int>)
+
+// The same lists with pooled nodes, where every add would otherwise go through
+// the global allocator
+using PooledLazyList =
+    LazyList<int, std::hash<int>, EpochBasedReclamation, void, PoolAllocator>;
+using PooledLockFreeList = LockFreeList<int, std::hash<int>,
+                                        EpochBasedReclamation, void,
+                                        PoolAllocator>;
+
+REGISTER_WRITE_HEAVY_BENCHMARK(PooledLazyList)
+REGISTER_WRITE_HEAVY_BENCHMARK(PooledLockFreeList)
+
+// LockFreeList<int> retries a lost CAS right away; this one spins for a
+// random, growing number of pauses first
+using BackoffLockFreeList =
+    LockFreeList<int, std::hash<int>, EpochBasedReclamation, void,
+                 DefaultAllocator, PauseBackoff<>>;
+
+REGISTER_WRITE_HEAVY_BENCHMARK(BackoffLockFreeList)
+
+// LazyList<int> split by hash into 16 independent lists, each a sixteenth as
+// long and locked independently
+using ShardedLazyList = Sharded<LazyList<int>, 16>;
+
+REGISTER_WRITE_HEAVY_BENCHMARK(ShardedLazyList)
+
+// The lock-based lists with other locks than TTASLock. CoarseList serializes
+// every operation on one lock, where queue locks scale best with many threads;
+// the per-node locks of FineList and LazyList are mostly uncontended, where
+// the lock with the shortest uncontended path wins.
+using CoarseTicketList =
+    CoarseList<int, std::hash<int>, void, DefaultAllocator, TicketLock<>>;
+using CoarseMCSList =
+    CoarseList<int, std::hash<int>, void, DefaultAllocator, MCSLock<>>;
+using CoarseBackoffList =
+    CoarseList<int, std::hash<int>, void, DefaultAllocator, BackoffLock<>>;
+// Runs the critical sections as hardware transactions where the processor
+// supports them, and behaves as CoarseList<int> elsewhere
+using CoarseElidedList = CoarseList<int, std::hash<int>, void,
+                                    DefaultAllocator, ElidedLock<TTASLock<>>>;
+// contains() couples the node locks in shared mode
+using FineSharedList =
+    FineList<int, std::hash<int>, void, DefaultAllocator, SharedTTASLock<>>;
+using FineTicketList =
+    FineList<int, std::hash<int>, void, DefaultAllocator, TicketLock<>>;
+using FineMCSList =
+    FineList<int, std::hash<int>, void, DefaultAllocator, MCSLock<>>;
+using LazyTicketList = LazyList<int, std::hash<int>, EpochBasedReclamation,
+                                void, DefaultAllocator, TicketLock<>>;
+using LazyMCSList = LazyList<int, std::hash<int>, EpochBasedReclamation, void,
+                             DefaultAllocator, MCSLock<>>;
+// A test-and-set word until a node's lock is contended, and a queue lock after
+using CoarseQSpinList =
+    CoarseList<int, std::hash<int>, void, DefaultAllocator, QSpinLock<>>;
+using FineQSpinList =
+    FineList<int, std::hash<int>, void, DefaultAllocator, QSpinLock<>>;
+using LazyQSpinList = LazyList<int, std::hash<int>, EpochBasedReclamation,
+                               void, DefaultAllocator, QSpinLock<>>;
+
+REGISTER_WRITE_HEAVY_BENCHMARK(CoarseTicketList)
+REGISTER_WRITE_HEAVY_BENCHMARK(CoarseMCSList)
+REGISTER_WRITE_HEAVY_BENCHMARK(CoarseBackoffList)
+REGISTER_WRITE_HEAVY_BENCHMARK(CoarseElidedList)
+REGISTER_READ_HEAVY_BENCHMARK(CoarseElidedList)
+REGISTER_WRITE_HEAVY_BENCHMARK(FineSharedList)
+REGISTER_READ_HEAVY_BENCHMARK(FineSharedList)
+REGISTER_WRITE_HEAVY_BENCHMARK(FineTicketList)
+REGISTER_WRITE_HEAVY_BENCHMARK(FineMCSList)
+REGISTER_WRITE_HEAVY_BENCHMARK(LazyTicketList)
+REGISTER_WRITE_HEAVY_BENCHMARK(LazyMCSList)
+REGISTER_WRITE_HEAVY_BENCHMARK(CoarseQSpinList)
+REGISTER_WRITE_HEAVY_BENCHMARK(FineQSpinList)
+REGISTER_WRITE_HEAVY_BENCHMARK(LazyQSpinList)
 
 // Balanced workload benchmarks
 #define REGISTER_BALANCED_BENCHMARK(ListType)                   \
@@ -272,6 +389,11 @@ REGISTER_BALANCED_BENCHMARK(FineList<int>)
 REGISTER_BALANCED_BENCHMARK(OptimisticList<int>)
 REGISTER_BALANCED_BENCHMARK(LazyList<int>)
 REGISTER_BALANCED_BENCHMARK(LockFreeList<int>)
+REGISTER_BALANCED_BENCHMARK(UnrolledLazyList<int>)
+REGISTER_BALANCED_BENCHMARK(LockFreeHashSet<int>)
+REGISTER_BALANCED_BENCHMARK(LazySkipList<int>)
+REGISTER_BALANCED_BENCHMARK(LockFreeSkipList<int>)
+REGISTER_BALANCED_BENCHMARK(OptimisticBTree<int>)
 
 // Register single operation benchmarks for different list types
 #define REGISTER_SINGLE_OP_BENCHMARKS(ListType)                              \
@@ -301,5 +423,78 @@ REGISTER_SINGLE_OP_BENCHMARKS(FineList<int>)
 REGISTER_SINGLE_OP_BENCHMARKS(OptimisticList<int>)
 REGISTER_SINGLE_OP_BENCHMARKS(LazyList<int>)
 REGISTER_SINGLE_OP_BENCHMARKS(LockFreeList<int>)
+REGISTER_SINGLE_OP_BENCHMARKS(UnrolledLazyList<int>)
+REGISTER_SINGLE_OP_BENCHMARKS(LockFreeHashSet<int>)
+REGISTER_SINGLE_OP_BENCHMARKS(LazySkipList<int>)
+REGISTER_SINGLE_OP_BENCHMARKS(LockFreeSkipList<int>)
+REGISTER_SINGLE_OP_BENCHMARKS(OptimisticBTree<int>)
+
+// Full traversal versus repeated lookups
+#define REGISTER_SCAN_BENCHMARKS(ListType)                          \
+  BENCHMARK(BM_RangeScan<ListType>)                                 \
+      ->Args({kMediumSize})                                         \
+      ->Args({kLargeSize})                                          \
+      ->Unit(benchmark::kMillisecond)                               \
+      ->UseRealTime();                                              \
+  BENCHMARK(BM_ContainsScan<ListType>)                              \
+      ->Args({kMediumSize})                                         \
+      ->Args({kLargeSize})                                          \
+      ->Unit(benchmark::kMillisecond)                               \
+      ->UseRealTime();
+
+REGISTER_SCAN_BENCHMARKS(LazyList<int>)
+REGISTER_SCAN_BENCHMARKS(LockFreeList<int>)
+
+// Skewed keys: Zipfian, hotspot (80% of the operations on 20% of the keys) and
+// sequential
+#define REGISTER_SKEWED_BENCHMARK(ListType)                               \
+  BENCHMARK(BM_SkewedWorkload<ListType>)                                  \
+      ->ArgsProduct({benchmark::CreateRange(1, kMaxThreads, 2),           \
+                     {kMediumSize},                                       \
+                     {static_cast<int64_t>(KeyDistribution::kZipfian),    \
+                      static_cast<int64_t>(KeyDistribution::kHotspot),    \
+                      static_cast<int64_t>(KeyDistribution::kSequential)}}) \
+      ->Unit(benchmark::kMillisecond)                                     \
+      ->UseRealTime();
+
+REGISTER_SKEWED_BENCHMARK(CoarseList<int>)
+REGISTER_SKEWED_BENCHMARK(FineList<int>)
+REGISTER_SKEWED_BENCHMARK(OptimisticList<int>)
+REGISTER_SKEWED_BENCHMARK(LazyList<int>)
+REGISTER_SKEWED_BENCHMARK(LockFreeList<int>)
+REGISTER_SKEWED_BENCHMARK(UnrolledLazyList<int>)
+REGISTER_SKEWED_BENCHMARK(LockFreeHashSet<int>)
+REGISTER_SKEWED_BENCHMARK(LazySkipList<int>)
+REGISTER_SKEWED_BENCHMARK(LockFreeSkipList<int>)
+REGISTER_SKEWED_BENCHMARK(OptimisticBTree<int>)
+
+// Range scans mixed with updates, for the sets that can be traversed, and the
+// skip lists, which scan with one contains() per key
+#define REGISTER_SCAN_WORKLOAD_BENCHMARK(ListType)                \
+  BENCHMARK(BM_ScanWorkload<ListType>)                            \
+      ->ArgsProduct({benchmark::CreateRange(1, kMaxThreads, 2),   \
+                     {kMediumSize}})                              \
+      ->Unit(benchmark::kMillisecond)                             \
+      ->UseRealTime();
+
+REGISTER_SCAN_WORKLOAD_BENCHMARK(LazyList<int>)
+REGISTER_SCAN_WORKLOAD_BENCHMARK(LockFreeList<int>)
+REGISTER_SCAN_WORKLOAD_BENCHMARK(LockFreeSkipList<int>)
+REGISTER_SCAN_WORKLOAD_BENCHMARK(OptimisticBTree<int>)
+
+// Per-operation latency and fairness under the read-heavy mix
+#define REGISTER_LATENCY_BENCHMARK(ListType)                    \
+  BENCHMARK(BM_OperationLatency<ListType>)                      \
+      ->ArgsProduct({benchmark::CreateRange(1, kMaxThreads, 2), \
+                     {kMediumSize}})                            \
+      ->Unit(benchmark::kMillisecond)                           \
+      ->UseRealTime();
+
+REGISTER_LATENCY_BENCHMARK(CoarseList<int>)
+REGISTER_LATENCY_BENCHMARK(FineList<int>)
+REGISTER_LATENCY_BENCHMARK(OptimisticList<int>)
+REGISTER_LATENCY_BENCHMARK(LazyList<int>)
+REGISTER_LATENCY_BENCHMARK(LockFreeList<int>)
+REGISTER_LATENCY_BENCHMARK(UnrolledLazyList<int>)
 
 BENCHMARK_MAIN();
@@ -0,0 +1,203 @@
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/latency_histogram.h"
+#include "memory/background_reclaimer.h"
+#include "memory/epoch_based_reclamation.h"
+#include "memory/garbage_list.h"
+#include "memory/hazard_ptr.h"
+#include "memory/rcu.h"
+#include "util/backoff.h"
+
+// Constants for benchmark configuration
+constexpr int kNumSlots = 1024;
+constexpr int kOperationsPerThread = 10000;
+constexpr int kMaxThreads = 8;
+
+struct Node {
+  explicit Node(int value) : value_(value) {}
+  int value_;
+};
+
+// Emulates a read-mostly traversal: every operation visits all slots, and
+// protects each node before dereferencing it, the way a list traversal
+// protects each node it hops to.
+template<typename Reclaimer>
+static auto Traverse(Reclaimer& reclaimer,
+                     std::vector<std::atomic<Node*>>& slots) -> long {
+  long sum = 0;
+  reclaimer.op_begin();
+  for (auto& slot : slots) {
+    Node* node;
+    do {
+      node = slot.load(std::memory_order_acquire);
+      reclaimer.try_reserve(node);
+      if (node == slot.load(std::memory_order_acquire)) {
+        break;
+      }
+      reclaimer.unreserve(node);
+    } while (true);
+    sum += node->value_;
+    reclaimer.unreserve(node);
+  }
+  reclaimer.op_end();
+  return sum;
+}
+
+// Replace one slot and retire the node it held.
+template<typename Reclaimer>
+static auto Replace(Reclaimer& reclaimer,
+                    std::vector<std::atomic<Node*>>& slots, int index,
+                    int value) -> void {
+  reclaimer.op_begin();
+  Node* old_node = slots[index].exchange(new Node(value));
+  reclaimer.sched_for_reclaim(old_node);
+  reclaimer.op_end();
+}
+
+// QSBR domains learn that a thread holds no references only when it says so
+template<typename Reclaimer>
+static auto Quiesce(Reclaimer& reclaimer) -> void {
+  if constexpr (requires { reclaimer.quiescent_state(); }) {
+    reclaimer.quiescent_state();
+  }
+}
+
+// Read-mostly workload (update percentage given by the second argument)
+template<typename Reclaimer>
+static void BM_ReadMostlyTraversal(benchmark::State& state) {
+  const int thread_count = state.range(0);
+  const int update_percentage = state.range(1);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto reclaimer = std::make_unique<Reclaimer>();
+    std::vector<std::atomic<Node*>> slots(kNumSlots);
+    for (int i = 0; i < kNumSlots; i++) {
+      slots[i].store(new Node(i), std::memory_order_relaxed);
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    state.ResumeTiming();
+
+    for (int t = 0; t < thread_count; ++t) {
+      threads.emplace_back([&reclaimer, &slots, update_percentage]() {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_int_distribution<> slot_dist(0, kNumSlots - 1);
+        std::uniform_int_distribution<> op_dist(1, 100);
+
+        for (int i = 0; i < kOperationsPerThread; ++i) {
+          if (op_dist(gen) <= update_percentage) {
+            Replace(*reclaimer, slots, slot_dist(gen), i);
+          } else {
+            benchmark::DoNotOptimize(Traverse(*reclaimer, slots));
+          }
+          Quiesce(*reclaimer);
+        }
+        reclaimer->unregister_thread();
+      });
+    }
+
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    state.PauseTiming();
+    for (auto& slot : slots) {
+      delete slot.load(std::memory_order_relaxed);
+    }
+    reclaimer.reset();
+    state.ResumeTiming();
+  }
+
+  state.counters["ops"] = benchmark::Counter(
+      static_cast<double>(thread_count) * kOperationsPerThread *
+          state.iterations(),
+      benchmark::Counter::kIsRate);
+}
+
+// Every operation replaces a slot, so retired nodes expire all the time, and
+// the latency of each replacement is recorded. Freeing a batch inline shows up
+// in the tail; with `state.range(1)` set, a BackgroundReclaimer frees them.
+template<typename Reclaimer>
+static void BM_RetireLatency(benchmark::State& state) {
+  const int thread_count = state.range(0);
+  const bool background = state.range(1) != 0;
+
+  std::unique_ptr<BackgroundReclaimer> background_reclaimer;
+  if (background) {
+    background_reclaimer = std::make_unique<BackgroundReclaimer>();
+    background_reclaimer->install();
+  }
+  LatencyRecorder recorder(thread_count);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto reclaimer = std::make_unique<Reclaimer>();
+    std::vector<std::atomic<Node*>> slots(kNumSlots);
+    for (int i = 0; i < kNumSlots; i++) {
+      slots[i].store(new Node(i), std::memory_order_relaxed);
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    state.ResumeTiming();
+
+    for (int t = 0; t < thread_count; ++t) {
+      threads.emplace_back([&reclaimer, &slots, &recorder, t]() {
+        ThreadLatency& latency = recorder.thread(t);
+        latency.start();
+        for (int i = 0; i < kOperationsPerThread; ++i) {
+          int index = static_cast<int>(random_uint64() % kNumSlots);
+          latency.measure([&reclaimer, &slots, index, i]() {
+            Replace(*reclaimer, slots, index, i);
+          });
+          Quiesce(*reclaimer);
+        }
+        latency.stop();
+        reclaimer->unregister_thread();
+      });
+    }
+
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    state.PauseTiming();
+    for (auto& slot : slots) {
+      delete slot.load(std::memory_order_relaxed);
+    }
+    reclaimer.reset();
+    state.ResumeTiming();
+  }
+
+  recorder.report(state);
+  state.counters["ops"] = benchmark::Counter(
+      static_cast<double>(thread_count) * kOperationsPerThread *
+          state.iterations(),
+      benchmark::Counter::kIsRate);
+}
+
+#define REGISTER_RECLAMATION_BENCHMARK(Reclaimer)               \
+  BENCHMARK(BM_ReadMostlyTraversal<Reclaimer>)                  \
+      ->ArgsProduct({benchmark::CreateRange(1, kMaxThreads, 2), \
+                     {1, 10}})                                  \
+      ->Unit(benchmark::kMillisecond)                           \
+      ->UseRealTime();                                          \
+  BENCHMARK(BM_RetireLatency<Reclaimer>)                        \
+      ->ArgsProduct({benchmark::CreateRange(1, kMaxThreads, 2), \
+                     {0, 1}})                                   \
+      ->Unit(benchmark::kMillisecond)                           \
+      ->UseRealTime();
+
+REGISTER_RECLAMATION_BENCHMARK(HazardPtr)
+REGISTER_RECLAMATION_BENCHMARK(EpochBasedReclamation)
+REGISTER_RECLAMATION_BENCHMARK(GarbageList)
+REGISTER_RECLAMATION_BENCHMARK(QsbrRcu)
+REGISTER_RECLAMATION_BENCHMARK(MembRcu)
+
+BENCHMARK_MAIN();
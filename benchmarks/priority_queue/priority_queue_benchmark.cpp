@@ -0,0 +1,137 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "priority_queue/flat_combining_priority_queue.h"
+#include "priority_queue/simple_tree.h"
+#include "priority_queue/skip_queue.h"
+#include "priority_queue/spray_list.h"
+
+static constexpr int kMinThreads = 1;
+static constexpr int kMaxThreads = 16;
+static constexpr int kMultiThreads = 2;
+static constexpr int kNumOps = 100000;
+static constexpr int kInitialSize = 10000;
+// The number of distinct priorities, so that SimpleTree can hold them all
+static constexpr uint32_t kRange = 1024;
+
+// The baseline: a std::priority_queue behind a mutex
+class LockedHeap {
+  using Entry = std::pair<uint32_t, int>;
+
+ public:
+  explicit LockedHeap(size_t /*num_threads*/) {}
+
+  auto add(int item, uint32_t priority) -> void {
+    std::lock_guard<std::mutex> lock(mutex_);
+    heap_.emplace(priority, item);
+  }
+
+  auto remove_min() -> std::optional<int> {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (heap_.empty()) {
+      return std::nullopt;
+    }
+    int item = heap_.top().second;
+    heap_.pop();
+    return item;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<>> heap_;
+};
+
+class FlatCombiningPriorityQueueWrapper
+    : public FlatCombiningPriorityQueue<int> {
+ public:
+  explicit FlatCombiningPriorityQueueWrapper(size_t /*num_threads*/) {}
+};
+
+class SkipQueueWrapper : public SkipQueue<int> {
+ public:
+  explicit SkipQueueWrapper(size_t /*num_threads*/) {}
+};
+
+class SprayListWrapper : public SprayList<int> {
+ public:
+  explicit SprayListWrapper(size_t num_threads) : SprayList(num_threads) {}
+};
+
+class SimpleTreeWrapper : public SimpleTree<int> {
+ public:
+  explicit SimpleTreeWrapper(size_t /*num_threads*/) : SimpleTree(kRange) {}
+};
+
+// Every thread alternates add() and remove_min() with random priorities on a
+// queue that starts with kInitialSize items
+template<typename QueueType>
+static void BM_AddRemoveMin(benchmark::State& state) {
+  const int kThreads = state.range(0);
+  const int kOpsPerThread = kNumOps / kThreads;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    QueueType queue(kThreads);
+    std::minstd_rand gen(42);
+    for (int i = 0; i < kInitialSize; i++) {
+      queue.add(i, gen() % kRange);
+    }
+    std::vector<std::thread> threads;
+    state.ResumeTiming();
+
+    for (int t = 0; t < kThreads; t++) {
+      threads.emplace_back([&queue, t, kOpsPerThread]() {
+        std::minstd_rand gen(t);
+        for (int i = 0; i < kOpsPerThread; i++) {
+          queue.add(i, gen() % kRange);
+          benchmark::DoNotOptimize(queue.remove_min());
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * kThreads *
+                          kOpsPerThread * 2);
+}
+
+BENCHMARK_TEMPLATE(BM_AddRemoveMin, LockedHeap)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_AddRemoveMin, FlatCombiningPriorityQueueWrapper)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_AddRemoveMin, SkipQueueWrapper)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_AddRemoveMin, SprayListWrapper)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_AddRemoveMin, SimpleTreeWrapper)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
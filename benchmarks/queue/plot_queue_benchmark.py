@@ -90,3 +90,27 @@ for i, ops_count in enumerate(operations_counts):
 plt.tight_layout(rect=[0, 0, 1, 0.95])  # Make room for the suptitle
 plt.savefig("queue_performance_comparison.png", dpi=300, bbox_inches="tight")
 plt.show()
+
+# Plot the tail latency of single operations, if the CSV has the columns the
+# latency benchmarks (BM_OperationLatency) report
+if "p99_ns" in df.columns:
+    df["p99_ns"] = pd.to_numeric(df["p99_ns"], errors="coerce")
+    latency = df[df["p99_ns"].notna()]
+    if not latency.empty:
+        fig, ax = plt.subplots(figsize=(8, 6))
+        grouped = latency.groupby(["queue_type", "threads"])["p99_ns"].mean()
+        for queue_type, queue_data in grouped.reset_index().groupby("queue_type"):
+            ax.plot(
+                queue_data["threads"],
+                queue_data["p99_ns"],
+                marker="o",
+                label=queue_type,
+            )
+        ax.set_xlabel("Number of Threads")
+        ax.set_ylabel("p99 Latency (ns)")
+        ax.set_title("Queue Operation Tail Latency")
+        ax.grid(True, linestyle="--", alpha=0.7)
+        ax.legend()
+        plt.tight_layout()
+        plt.savefig("queue_latency_comparison.png", dpi=300, bbox_inches="tight")
+        plt.show()
@@ -1,11 +1,34 @@
 #include <benchmark/benchmark.h>
+#include <algorithm>
+#include <optional>
+#include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
+#include "common/latency_histogram.h"
+#include "common/perf_counters.h"
+#include "queue/baskets_queue.h"
+#include "queue/blocking_queue.h"
 #include "queue/bounded_queue.h"
+#include "queue/elimination_queue.h"
+#include "queue/faa_array_queue.h"
+#include "queue/flat_combining_queue.h"
 #include "queue/lock_free_queue.h"
 #include "queue/lock_free_queue_recycle.h"
+#include "queue/mpmc_queue.h"
+#include "queue/mpsc_queue.h"
+#include "queue/queue_traits.h"
+#include "queue/spsc_queue.h"
+#include "queue/synchronous_dual_queue.h"
+#include "queue/synchronous_queue.h"
 #include "queue/unbounded_queue.h"
+#include "synchronization/mcs_lock.h"
+#include "synchronization/ticket_lock.h"
+#include "synchronization/ttas_lock.h"
+#include "util/atomic_stamped_ptr.h"
+#include "util/backoff.h"
+#include "util/sharded.h"
 
 // Test data type
 struct TestData {
@@ -13,6 +36,16 @@ struct TestData {
   char padding[60];  // Pad to 64 bytes to avoid false sharing
 };
 
+// A payload that owns a heap buffer, like the string messages passed through
+// the queues in practice. Copying it allocates and copies the buffer; moving it
+// only hands the pointer over.
+struct LargeTestData {
+  int value;
+  std::string buffer;
+};
+
+static constexpr size_t kLargePayloadSize = 4096;
+
 static constexpr int kMinThreads = 2;
 static constexpr int kMaxThreads = 32;
 static constexpr int kMultiThreads = 2;
@@ -107,6 +140,8 @@ static void BM_ProducerConsumer(benchmark::State& state) {
   const int64_t kTotalItems =
       kItemsPerThread * kProducerThreads * 2;  // Total increases with threads
 
+  PerfCounters perf;
+  perf.start();
   for (auto _ : state) {
     state.PauseTiming();
     QueueType queue;
@@ -120,15 +155,16 @@ static void BM_ProducerConsumer(benchmark::State& state) {
 
     // Start consumers - each consumer processes items until done
     for (int t = 0; t < kConsumerThreads; ++t) {
-      consumers.emplace_back([&queue, kItemsPerThread, kConsumerThreads]() {
-        // Each consumer tries to process roughly kTotalItems/kConsumerThreads
-        // items
-        for (int i = 0; i < kItemsPerThread; i++) {
-          try {
-            TestData item = queue.dequeue();
-            benchmark::DoNotOptimize(item);
-          } catch (...) {
-            continue;
+      consumers.emplace_back([&queue, kItemsPerThread]() {
+        // Each consumer takes as many items as a producer enqueues, polling
+        // the queue and yielding while it is empty
+        int64_t consumed = 0;
+        while (consumed < kItemsPerThread) {
+          if (auto item = queue.try_dequeue()) {
+            benchmark::DoNotOptimize(*item);
+            consumed++;
+          } else {
+            std::this_thread::yield();
           }
         }
       });
@@ -153,20 +189,287 @@ static void BM_ProducerConsumer(benchmark::State& state) {
     }
   }
 
+  perf.stop();
+
   state.SetItemsProcessed(int64_t(state.iterations()) * kTotalItems);
+  perf.report(state, static_cast<double>(state.iterations()) * kTotalItems);
+}
+
+// Like BM_ProducerConsumer, but consumers wait in dequeue() instead of
+// polling
+template<typename QueueType>
+static void BM_BlockingProducerConsumer(benchmark::State& state) {
+  const int64_t kItemsPerThread = state.range(0);
+  const int kThreads = state.range(1);
+  const int64_t kTotalItems = kItemsPerThread * kThreads * 2;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    QueueType queue;
+    state.ResumeTiming();
+
+    std::vector<std::thread> threads;
+    threads.reserve(kThreads * 2);
+    for (int t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&queue, kItemsPerThread]() {
+        for (int64_t i = 0; i < kItemsPerThread; i++) {
+          TestData item = queue.dequeue();
+          benchmark::DoNotOptimize(item);
+        }
+      });
+    }
+    for (int t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&queue, t, kItemsPerThread]() {
+        for (int i = 0; i < kItemsPerThread; ++i) {
+          TestData data{static_cast<int>(t * kItemsPerThread + i), {0}};
+          queue.enqueue(data);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * kTotalItems);
+}
+
+// Producers feeding a single consumer: 1P/1C for range(1) == 1, NP/1C
+// otherwise. The consumer dequeues every item, so queues restricted to a single
+// consumer can be compared with the general ones.
+template<typename QueueType>
+static void BM_SingleConsumer(benchmark::State& state) {
+  const int64_t kItemsPerThread = state.range(0);
+  const int kProducerThreads = state.range(1);
+  const int64_t kTotalItems = kItemsPerThread * kProducerThreads;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    QueueType queue;
+    state.ResumeTiming();
+
+    std::thread consumer([&queue, kTotalItems]() {
+      int64_t consumed = 0;
+      while (consumed < kTotalItems) {
+        if (auto item = queue.try_dequeue()) {
+          benchmark::DoNotOptimize(*item);
+          consumed++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+
+    std::vector<std::thread> producers;
+    producers.reserve(kProducerThreads);
+    for (int t = 0; t < kProducerThreads; ++t) {
+      producers.emplace_back([&queue, t, kItemsPerThread]() {
+        for (int i = 0; i < kItemsPerThread; ++i) {
+          TestData data{static_cast<int>(t * kItemsPerThread + i), {0}};
+          queue.enqueue(data);
+        }
+      });
+    }
+
+    for (auto& thread : producers) {
+      thread.join();
+    }
+    consumer.join();
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * kTotalItems);
+}
+
+// Producers hand items to a single consumer in batches of range(1) items; a
+// batch size of 1 measures the per-item cost that batching amortizes
+template<typename QueueType>
+static void BM_BulkTransfer(benchmark::State& state) {
+  const int64_t kItemsPerThread = state.range(0);
+  const int kBatchSize = state.range(1);
+  const int kProducerThreads = 2;
+  const int64_t kTotalItems = kItemsPerThread * kProducerThreads;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    QueueType queue;
+    state.ResumeTiming();
+
+    std::thread consumer([&queue, kTotalItems, kBatchSize]() {
+      std::vector<TestData> items(kBatchSize);
+      int64_t consumed = 0;
+      while (consumed < kTotalItems) {
+        consumed += queue.dequeue_bulk(items.begin(), kBatchSize);
+        benchmark::DoNotOptimize(items.data());
+      }
+    });
+
+    std::vector<std::thread> producers;
+    producers.reserve(kProducerThreads);
+    for (int t = 0; t < kProducerThreads; ++t) {
+      producers.emplace_back([&queue, t, kItemsPerThread, kBatchSize]() {
+        std::vector<TestData> batch(kBatchSize);
+        for (int64_t i = 0; i < kItemsPerThread; i += kBatchSize) {
+          int64_t count = std::min<int64_t>(kBatchSize, kItemsPerThread - i);
+          for (int64_t j = 0; j < count; j++) {
+            batch[j].value = static_cast<int>(t * kItemsPerThread + i + j);
+          }
+          queue.enqueue_bulk(batch.begin(), batch.begin() + count);
+        }
+      });
+    }
+
+    for (auto& thread : producers) {
+      thread.join();
+    }
+    consumer.join();
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * kTotalItems);
+}
+
+// A producer builds large payloads and hands them to a consumer, copying each
+// one into the queue when kMove is false and moving it in when kMove is true.
+// The consumer always moves items out, so the difference is the cost of the
+// copies.
+template<typename QueueType, bool kMove>
+static void BM_LargePayloadTransfer(benchmark::State& state) {
+  const int64_t kItems = state.range(0);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    QueueType queue;
+    state.ResumeTiming();
+
+    std::thread consumer([&queue, kItems]() {
+      int64_t consumed = 0;
+      while (consumed < kItems) {
+        if (auto item = queue.try_dequeue()) {
+          benchmark::DoNotOptimize(item->buffer.data());
+          consumed++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+
+    for (int64_t i = 0; i < kItems; i++) {
+      LargeTestData data{static_cast<int>(i),
+                         std::string(kLargePayloadSize, 'x')};
+      if constexpr (kMove) {
+        queue.enqueue(std::move(data));
+      } else {
+        queue.enqueue(data);
+      }
+    }
+    consumer.join();
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * kItems);
+  state.SetBytesProcessed(int64_t(state.iterations()) * kItems *
+                          kLargePayloadSize);
+}
+
+// Latency of single operations under contention: every thread alternates
+// enqueue() and try_dequeue() and times each call. Reports latency percentiles
+// and per-thread fairness, since throughput alone hides a long tail.
+template<typename QueueType>
+static void BM_OperationLatency(benchmark::State& state) {
+  const int64_t kOpsPerThread = state.range(0);
+  const int kThreads = state.range(1);
+
+  LatencyRecorder recorder(kThreads);
+  for (auto _ : state) {
+    state.PauseTiming();
+    QueueType queue;
+    state.ResumeTiming();
+
+    std::vector<std::thread> threads;
+    threads.reserve(kThreads);
+    for (int t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&queue, &recorder, t, kOpsPerThread]() {
+        ThreadLatency& latency = recorder.thread(t);
+        latency.start();
+        for (int64_t i = 0; i < kOpsPerThread; i++) {
+          latency.measure([&queue, i]() {
+            queue.enqueue(TestData{static_cast<int>(i), {0}});
+          });
+          latency.measure([&queue]() {
+            auto item = queue.try_dequeue();
+            benchmark::DoNotOptimize(item);
+          });
+        }
+        latency.stop();
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  recorder.report(state);
+  state.SetItemsProcessed(int64_t(state.iterations()) * kOpsPerThread *
+                          kThreads * 2);
 }
 
 // Specialized benchmarks for BoundedQueue which needs capacity
-template<typename T>
+template<typename T, typename Lock = TTASLock<>>
 class BoundedQueueWrapper {
-  BoundedQueue<T> queue;
+  BoundedQueue<T, Lock> queue;
 
  public:
   BoundedQueueWrapper() : queue(1000000) {}  // Default capacity for benchmarks
 
-  void enqueue(const T& value) { queue.enqueue(value); }
+  void enqueue(T value) { queue.enqueue(std::move(value)); }
+
+  T dequeue() { return queue.dequeue(); }
+
+  std::optional<T> try_dequeue() { return queue.try_dequeue(); }
+
+  template<typename InputIt>
+  void enqueue_bulk(InputIt first, InputIt last) {
+    queue.enqueue_bulk(first, last);
+  }
+
+  template<typename OutputIt>
+  size_t dequeue_bulk(OutputIt out, size_t max) {
+    return queue.dequeue_bulk(out, max);
+  }
+};
+
+// MPMCQueue preallocates its slots, so the capacity only needs to hold the
+// largest single-threaded run; freeing them is timed and dominates the
+// smallest runs. It is left out of the multi-threaded enqueue benchmark, which
+// enqueues more items than that without any consumer.
+template<typename T>
+class MPMCQueueWrapper {
+  MPMCQueue<T> queue;
+
+ public:
+  MPMCQueueWrapper() : queue(kMaxOps) {}
+
+  void enqueue(T value) { queue.enqueue(std::move(value)); }
 
   T dequeue() { return queue.dequeue(); }
+
+  std::optional<T> try_dequeue() { return queue.try_dequeue(); }
+};
+
+// The ring buffer picked for one producer and one consumer
+template<typename T>
+class SPSCQueueWrapper {
+  QueueTraits<Concurrency::kSingle, Concurrency::kSingle>::Bounded<T> queue;
+
+ public:
+  SPSCQueueWrapper() : queue(kRingCapacity) {}
+
+  void enqueue(T value) { queue.enqueue(std::move(value)); }
+
+  T dequeue() { return queue.dequeue(); }
+
+  std::optional<T> try_dequeue() { return queue.try_dequeue(); }
+
+ private:
+  static constexpr size_t kRingCapacity = 1024;
 };
 
 // Register benchmarks for all queue types
@@ -183,6 +486,10 @@ BENCHMARK_TEMPLATE(BM_SingleThreadedEnqueue, LockFreeQueue<TestData>)
     ->RangeMultiplier(kMultiOps)
     ->Range(kMinOps, kMaxOps)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_SingleThreadedEnqueue, MPMCQueueWrapper<TestData>)
+    ->RangeMultiplier(kMultiOps)
+    ->Range(kMinOps, kMaxOps)
+    ->Unit(benchmark::kMillisecond);
 BENCHMARK_TEMPLATE(BM_SingleThreadedEnqueue, UnboundedQueue<TestData>)
     ->RangeMultiplier(kMultiOps)
     ->Range(kMinOps, kMaxOps)
@@ -201,6 +508,10 @@ BENCHMARK_TEMPLATE(BM_SingleThreadedDequeue, LockFreeQueue<TestData>)
     ->RangeMultiplier(kMultiOps)
     ->Range(kMinOps, kMaxOps)
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_SingleThreadedDequeue, MPMCQueueWrapper<TestData>)
+    ->RangeMultiplier(kMultiOps)
+    ->Range(kMinOps, kMaxOps)
+    ->Unit(benchmark::kMillisecond);
 BENCHMARK_TEMPLATE(BM_SingleThreadedDequeue, UnboundedQueue<TestData>)
     ->RangeMultiplier(kMultiOps)
     ->Range(kMinOps, kMaxOps)
@@ -213,6 +524,12 @@ BENCHMARK_TEMPLATE(BM_MultiThreadedEnqueue, BoundedQueueWrapper<TestData>)
                                           kMultiThreads)})
     ->UseRealTime()
     ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MultiThreadedEnqueue, FlatCombiningQueue<TestData>)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                          kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
 BENCHMARK_TEMPLATE(BM_MultiThreadedEnqueue, LockFreeQueueRecycle<TestData>)
     ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
                    benchmark::CreateRange(kMinThreads, kMaxThreads,
@@ -232,7 +549,38 @@ BENCHMARK_TEMPLATE(BM_MultiThreadedEnqueue, UnboundedQueue<TestData>)
     ->UseRealTime()
     ->Unit(benchmark::kMillisecond);
 
+// Contention on the tail: LockFreeQueue retrying at once, backing off, and
+// BasketsQueue, whose enqueuers that lose the tail CAS insert into a basket
+using BackoffLockFreeQueue = LockFreeQueue<TestData, PauseBackoff<>>;
+
+BENCHMARK_TEMPLATE(BM_MultiThreadedEnqueue, BackoffLockFreeQueue)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                          kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MultiThreadedEnqueue, BasketsQueue<TestData>)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                          kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
 // Producer-consumer benchmark
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, BasketsQueue<TestData>)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                          kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, BackoffLockFreeQueue)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                          kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
 BENCHMARK_TEMPLATE(BM_ProducerConsumer, BoundedQueueWrapper<TestData>)
     ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
                    benchmark::CreateRange(kMinThreads, kMaxThreads,
@@ -240,6 +588,27 @@ BENCHMARK_TEMPLATE(BM_ProducerConsumer, BoundedQueueWrapper<TestData>)
     ->UseRealTime()
     ->Unit(benchmark::kMillisecond);
 
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, EliminationQueue<TestData>)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                          kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, FAAArrayQueue<TestData>)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                          kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, FlatCombiningQueue<TestData>)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                          kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
 BENCHMARK_TEMPLATE(BM_ProducerConsumer, LockFreeQueueRecycle<TestData>)
     ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
                    benchmark::CreateRange(kMinThreads, kMaxThreads,
@@ -254,6 +623,13 @@ BENCHMARK_TEMPLATE(BM_ProducerConsumer, LockFreeQueue<TestData>)
     ->UseRealTime()
     ->Unit(benchmark::kMillisecond);
 
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, MPMCQueueWrapper<TestData>)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                          kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
 BENCHMARK_TEMPLATE(BM_ProducerConsumer, UnboundedQueue<TestData>)
     ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
                    benchmark::CreateRange(kMinThreads, kMaxThreads,
@@ -261,4 +637,160 @@ BENCHMARK_TEMPLATE(BM_ProducerConsumer, UnboundedQueue<TestData>)
     ->UseRealTime()
     ->Unit(benchmark::kMillisecond);
 
+// The two-lock queues with each lock. Producers contend on one lock and
+// consumers on another, so queue locks pay off once many threads share a lock,
+// and the ticket lock keeps short critical sections cheap.
+#define REGISTER_PRODUCER_CONSUMER_LOCK_BENCHMARK(QueueType)                \
+  BENCHMARK_TEMPLATE(BM_ProducerConsumer, QueueType)                        \
+      ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),   \
+                     benchmark::CreateRange(kMinThreads, kMaxThreads,       \
+                                            kMultiThreads)})                \
+      ->UseRealTime()                                                       \
+      ->Unit(benchmark::kMillisecond);
+
+using TicketBoundedQueue = BoundedQueueWrapper<TestData, TicketLock<>>;
+using MCSBoundedQueue = BoundedQueueWrapper<TestData, MCSLock<>>;
+using TicketUnboundedQueue = UnboundedQueue<TestData, TicketLock<>>;
+using MCSUnboundedQueue = UnboundedQueue<TestData, MCSLock<>>;
+
+REGISTER_PRODUCER_CONSUMER_LOCK_BENCHMARK(TicketBoundedQueue)
+REGISTER_PRODUCER_CONSUMER_LOCK_BENCHMARK(MCSBoundedQueue)
+REGISTER_PRODUCER_CONSUMER_LOCK_BENCHMARK(TicketUnboundedQueue)
+REGISTER_PRODUCER_CONSUMER_LOCK_BENCHMARK(MCSUnboundedQueue)
+
+// LockFreeQueue split into one shard per CPU: producers enqueue into the
+// shard of their CPU and consumers drain their own shard before stealing, so
+// the queue keeps FIFO order only within a shard
+using ShardedLockFreeQueue = Sharded<LockFreeQueue<TestData>, 64>;
+
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, ShardedLockFreeQueue)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                          kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Consumers park instead of polling, which shows in the CPU time
+BENCHMARK_TEMPLATE(BM_BlockingProducerConsumer,
+                   BlockingQueue<LockFreeQueue<TestData>>)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                          kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Tail latency of single operations
+BENCHMARK_TEMPLATE(BM_OperationLatency, BasketsQueue<TestData>)
+    ->ArgsProduct({{kMinOps}, benchmark::CreateRange(1, kMaxThreads,
+                                                     kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_OperationLatency, FAAArrayQueue<TestData>)
+    ->ArgsProduct({{kMinOps}, benchmark::CreateRange(1, kMaxThreads,
+                                                     kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_OperationLatency, LockFreeQueue<TestData>)
+    ->ArgsProduct({{kMinOps}, benchmark::CreateRange(1, kMaxThreads,
+                                                     kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_OperationLatency, MPMCQueueWrapper<TestData>)
+    ->ArgsProduct({{kMinOps}, benchmark::CreateRange(1, kMaxThreads,
+                                                     kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_OperationLatency, UnboundedQueue<TestData>)
+    ->ArgsProduct({{kMinOps}, benchmark::CreateRange(1, kMaxThreads,
+                                                     kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Synchronous handoff: every enqueue waits for a dequeue
+BENCHMARK_TEMPLATE(BM_BlockingProducerConsumer, SynchronousQueue<TestData>)
+    ->ArgsProduct({{kMinOps}, benchmark::CreateRange(1, kMaxThreads,
+                                                     kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_BlockingProducerConsumer, SynchronousDualQueue<TestData>)
+    ->ArgsProduct({{kMinOps}, benchmark::CreateRange(1, kMaxThreads,
+                                                     kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Single consumer: 1P/1C and NP/1C
+BENCHMARK_TEMPLATE(BM_SingleConsumer, SPSCQueueWrapper<TestData>)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps), {1}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_SingleConsumer, MPSCQueue<TestData>)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(1, kMaxThreads, kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_SingleConsumer, MPMCQueueWrapper<TestData>)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(1, kMaxThreads, kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_SingleConsumer, LockFreeQueue<TestData>)
+    ->ArgsProduct({benchmark::CreateRange(kMinOps, kMaxOps, kMultiOps),
+                   benchmark::CreateRange(1, kMaxThreads, kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Bulk transfer
+BENCHMARK_TEMPLATE(BM_BulkTransfer, BoundedQueueWrapper<TestData>)
+    ->ArgsProduct({{kMaxOps}, benchmark::CreateRange(1, 512, 8)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_BulkTransfer, LockFreeQueue<TestData>)
+    ->ArgsProduct({{kMaxOps}, benchmark::CreateRange(1, 512, 8)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_BulkTransfer, UnboundedQueue<TestData>)
+    ->ArgsProduct({{kMaxOps}, benchmark::CreateRange(1, 512, 8)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Copying versus moving large payloads
+#define REGISTER_LARGE_PAYLOAD_BENCHMARK(QueueType)                     \
+  BENCHMARK_TEMPLATE(BM_LargePayloadTransfer, QueueType, false)         \
+      ->RangeMultiplier(kMultiOps)                                      \
+      ->Range(kMinOps, kMaxOps)                                         \
+      ->UseRealTime()                                                   \
+      ->Unit(benchmark::kMillisecond);                                  \
+  BENCHMARK_TEMPLATE(BM_LargePayloadTransfer, QueueType, true)          \
+      ->RangeMultiplier(kMultiOps)                                      \
+      ->Range(kMinOps, kMaxOps)                                         \
+      ->UseRealTime()                                                   \
+      ->Unit(benchmark::kMillisecond);
+
+REGISTER_LARGE_PAYLOAD_BENCHMARK(BoundedQueueWrapper<LargeTestData>)
+REGISTER_LARGE_PAYLOAD_BENCHMARK(FAAArrayQueue<LargeTestData>)
+REGISTER_LARGE_PAYLOAD_BENCHMARK(LockFreeQueue<LargeTestData>)
+REGISTER_LARGE_PAYLOAD_BENCHMARK(LockFreeQueueRecycle<LargeTestData>)
+REGISTER_LARGE_PAYLOAD_BENCHMARK(MPMCQueueWrapper<LargeTestData>)
+REGISTER_LARGE_PAYLOAD_BENCHMARK(MPSCQueue<LargeTestData>)
+REGISTER_LARGE_PAYLOAD_BENCHMARK(UnboundedQueue<LargeTestData>)
+
+// Reports which AtomicStampedPtr representation the stamped structures use
+static const bool kStampReported = [] {
+  benchmark::AddCustomContext(
+      "atomic_stamped_ptr",
+      std::string(AtomicStampedPtr<int>::kRepresentation) +
+          (AtomicStampedPtr<int>::kIsLockFree ? ", lock-free" : ", may lock"));
+  return true;
+}();
+
 BENCHMARK_MAIN();
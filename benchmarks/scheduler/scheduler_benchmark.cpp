@@ -0,0 +1,241 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "queue/lock_free_queue.h"
+#include "scheduler/executor.h"
+#include "scheduler/work_stealing_pool.h"
+#include "util/backoff.h"
+
+static constexpr int kMinThreads = 1;
+static constexpr int kMaxThreads = 8;
+static constexpr int kMultiThreads = 2;
+
+// The baseline: every worker takes tasks from, and submits them to, a single
+// shared LockFreeQueue
+class CentralQueuePool {
+  using Task = std::function<void()>;
+
+ public:
+  explicit CentralQueuePool(size_t num_workers) {
+    for (size_t i = 0; i < num_workers; i++) {
+      workers_.emplace_back([this]() { run(); });
+    }
+  }
+
+  ~CentralQueuePool() {
+    wait_idle();
+    stop_.store(true, std::memory_order_release);
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  auto submit(Task task) -> void {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    queue_.enqueue(new Task(std::move(task)));
+  }
+
+  auto wait_idle() -> void {
+    while (pending_.load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+ private:
+  auto run() -> void {
+    while (true) {
+      std::optional<Task*> task = queue_.try_dequeue();
+      if (!task.has_value()) {
+        Backoff<std::chrono::microseconds> backoff(
+            WorkStealingPool::kMinIdleDelay, WorkStealingPool::kMaxIdleDelay);
+        while (!stop_.load(std::memory_order_acquire) &&
+               !(task = queue_.try_dequeue()).has_value()) {
+          backoff.backoff();
+        }
+        if (!task.has_value()) {
+          break;
+        }
+      }
+      (**task)();
+      delete *task;
+      pending_.fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  LockFreeQueue<Task*> queue_;
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> pending_{0};
+  std::atomic<bool> stop_{false};
+};
+
+// A binary fork-join tree of tasks: each inner task forks two subtasks, and
+// each leaf does a little work
+template<typename PoolType>
+static void BM_ForkJoin(benchmark::State& state) {
+  const int kDepth = state.range(0);
+  const int kThreads = state.range(1);
+
+  PoolType pool(kThreads);
+  std::atomic<int64_t> leaves{0};
+  std::function<void(int)> fork = [&](int depth) {
+    if (depth == 0) {
+      int64_t sum = 0;
+      for (int i = 0; i < 100; i++) {
+        benchmark::DoNotOptimize(sum += i);
+      }
+      leaves.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    pool.submit([&fork, depth]() { fork(depth - 1); });
+    pool.submit([&fork, depth]() { fork(depth - 1); });
+  };
+
+  for (auto _ : state) {
+    pool.submit([&fork, kDepth]() { fork(kDepth); });
+    pool.wait_idle();
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) *
+                          ((int64_t(1) << (kDepth + 1)) - 1));
+}
+
+// Independent tasks submitted from outside the pool
+template<typename PoolType>
+static void BM_FlatTasks(benchmark::State& state) {
+  const int64_t kNumTasks = state.range(0);
+  const int kThreads = state.range(1);
+
+  PoolType pool(kThreads);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kNumTasks; i++) {
+      pool.submit([]() { benchmark::ClobberMemory(); });
+    }
+    pool.wait_idle();
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * kNumTasks);
+}
+
+// The time from submitting a single task to the task starting, one task at a
+// time, so idle workers are parked or spinning when each task arrives
+template<typename PoolType>
+static void BM_SubmitToStartLatency(benchmark::State& state) {
+  using Clock = std::chrono::steady_clock;
+  const int kThreads = state.range(0);
+
+  PoolType pool(kThreads);
+  std::atomic<Clock::rep> started{0};
+  Clock::rep total_latency = 0;
+  for (auto _ : state) {
+    Clock::rep submitted = Clock::now().time_since_epoch().count();
+    pool.submit([&started]() {
+      started.store(Clock::now().time_since_epoch().count(),
+                    std::memory_order_release);
+    });
+    pool.wait_idle();
+    total_latency += started.load(std::memory_order_acquire) - submitted;
+  }
+
+  state.counters["latency_ns"] = benchmark::Counter(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          Clock::duration(total_latency))
+          .count(),
+      benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_TEMPLATE(BM_ForkJoin, CentralQueuePool)
+    ->ArgsProduct({{16}, benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                                kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ForkJoin, WorkStealingPool)
+    ->ArgsProduct({{16}, benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                                kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_FlatTasks, CentralQueuePool)
+    ->ArgsProduct({{100000}, benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                                    kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_FlatTasks, WorkStealingPool)
+    ->ArgsProduct({{100000}, benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                                    kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ForkJoin, Executor<CentralQueue>)
+    ->ArgsProduct({{16}, benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                                kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ForkJoin, Executor<WorkStealing>)
+    ->ArgsProduct({{16}, benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                                kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ForkJoin, Executor<ShardedQueues>)
+    ->ArgsProduct({{16}, benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                                kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_FlatTasks, Executor<CentralQueue>)
+    ->ArgsProduct({{100000}, benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                                    kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_FlatTasks, Executor<WorkStealing>)
+    ->ArgsProduct({{100000}, benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                                    kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_FlatTasks, Executor<ShardedQueues>)
+    ->ArgsProduct({{100000}, benchmark::CreateRange(kMinThreads, kMaxThreads,
+                                                    kMultiThreads)})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_SubmitToStartLatency, CentralQueuePool)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_SubmitToStartLatency, WorkStealingPool)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_SubmitToStartLatency, Executor<CentralQueue>)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_SubmitToStartLatency, Executor<WorkStealing>)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_SubmitToStartLatency, Executor<ShardedQueues>)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
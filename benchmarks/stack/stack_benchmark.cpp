@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "stack/elimination_backoff_stack.h"
+#include "stack/flat_combining_stack.h"
+#include "stack/lock_free_stack.h"
+#include "util/atomic_stamped_ptr.h"
+
+static constexpr int kMinThreads = 1;
+static constexpr int kMaxThreads = 32;
+static constexpr int kMultiThreads = 2;
+static constexpr int kNumOps = 100000;
+static constexpr size_t kEliminationCapacity = 16;
+
+class EliminationBackoffStackWrapper : public EliminationBackoffStack<int> {
+ public:
+  EliminationBackoffStackWrapper()
+      : EliminationBackoffStack(kEliminationCapacity) {}
+};
+
+using EliminatingLockFreeStack =
+    LockFreeStack<int, std::chrono::microseconds, DefaultAllocator,
+                  WithElimination<kEliminationCapacity>>;
+
+// Every thread alternates push() and try_pop(), which gives the elimination
+// array pairs of opposite operations to match
+template<typename StackType>
+static void BM_PushPop(benchmark::State& state) {
+  const int kThreads = state.range(0);
+  const int kOpsPerThread = kNumOps / kThreads;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    StackType stack;
+    std::vector<std::thread> threads;
+    state.ResumeTiming();
+
+    for (int t = 0; t < kThreads; t++) {
+      threads.emplace_back([&stack, kOpsPerThread]() {
+        int value = 0;
+        for (int i = 0; i < kOpsPerThread; i++) {
+          stack.push(i);
+          benchmark::DoNotOptimize(stack.try_pop(value));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * kThreads *
+                          kOpsPerThread * 2);
+}
+
+BENCHMARK_TEMPLATE(BM_PushPop, EliminationBackoffStackWrapper)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_PushPop, FlatCombiningStack<int>)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_PushPop, LockFreeStack<int>)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_PushPop, EliminatingLockFreeStack)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Reports which AtomicStampedPtr representation the stamped structures use
+static const bool kStampReported = [] {
+  benchmark::AddCustomContext(
+      "atomic_stamped_ptr",
+      std::string(AtomicStampedPtr<int>::kRepresentation) +
+          (AtomicStampedPtr<int>::kIsLockFree ? ", lock-free" : ", may lock"));
+  return true;
+}();
+
+BENCHMARK_MAIN();
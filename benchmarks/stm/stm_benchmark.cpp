@@ -0,0 +1,188 @@
+#include <benchmark/benchmark.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "list/coarse_list.h"
+#include "queue/unbounded_queue.h"
+#include "stm/tm_list.h"
+#include "stm/tm_queue.h"
+#include "synchronization/scoped_lock.h"
+#include "synchronization/ttas_lock.h"
+#include "util/backoff.h"
+
+static constexpr int kMinThreads = 1;
+static constexpr int kMaxThreads = 32;
+static constexpr int kMultiThreads = 2;
+static constexpr int kNumOps = 100000;
+static constexpr int kNumContainers = 8;
+static constexpr int kNumItems = 256;
+
+// Composed operations move an item between two of `kNumContainers`
+// containers, either in one transaction or under one lock around them all,
+// which is how the move is made atomic without an STM.
+
+class TMLists {
+ public:
+  TMLists() {
+    for (int i = 0; i < kNumItems; i++) {
+      lists_[i % kNumContainers].add(i);
+    }
+  }
+
+  auto move(int item, int from, int to) -> bool {
+    return atomically([&]() {
+      if (!lists_[from].remove(item)) {
+        return false;
+      }
+      lists_[to].add(item);
+      return true;
+    });
+  }
+
+ private:
+  std::array<TMList<int>, kNumContainers> lists_;
+};
+
+class CoarseLockedLists {
+ public:
+  CoarseLockedLists() {
+    for (int i = 0; i < kNumItems; i++) {
+      lists_[i % kNumContainers].add(i);
+    }
+  }
+
+  auto move(int item, int from, int to) -> bool {
+    ScopedLock<TTASLock<>> guard(lock_);
+    if (!lists_[from].remove(item)) {
+      return false;
+    }
+    lists_[to].add(item);
+    return true;
+  }
+
+ private:
+  TTASLock<> lock_;
+  std::array<CoarseList<int>, kNumContainers> lists_;
+};
+
+class TMQueues {
+ public:
+  TMQueues() {
+    for (int i = 0; i < kNumItems; i++) {
+      queues_[i % kNumContainers].enqueue(i);
+    }
+  }
+
+  auto transfer(int from, int to) -> bool {
+    return atomically([&]() {
+      auto value = queues_[from].try_dequeue();
+      if (!value) {
+        return false;
+      }
+      queues_[to].enqueue(*value);
+      return true;
+    });
+  }
+
+ private:
+  std::array<TMQueue<int>, kNumContainers> queues_;
+};
+
+class CoarseLockedQueues {
+ public:
+  CoarseLockedQueues() {
+    for (int i = 0; i < kNumItems; i++) {
+      queues_[i % kNumContainers].enqueue(i);
+    }
+  }
+
+  auto transfer(int from, int to) -> bool {
+    ScopedLock<TTASLock<>> guard(lock_);
+    auto value = queues_[from].try_dequeue();
+    if (!value) {
+      return false;
+    }
+    queues_[to].enqueue(*value);
+    return true;
+  }
+
+ private:
+  TTASLock<> lock_;
+  std::array<UnboundedQueue<int>, kNumContainers> queues_;
+};
+
+template<typename Containers, typename Op>
+static void run_composed(benchmark::State& state, Op op) {
+  const int kThreads = state.range(0);
+  const int kOpsPerThread = kNumOps / kThreads;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto containers = std::make_unique<Containers>();
+    std::vector<std::thread> threads;
+    state.ResumeTiming();
+
+    for (int t = 0; t < kThreads; t++) {
+      threads.emplace_back([&containers, &op, kOpsPerThread]() {
+        for (int i = 0; i < kOpsPerThread; i++) {
+          uint64_t random = random_uint64();
+          int from = static_cast<int>(random % kNumContainers);
+          int to = static_cast<int>((random >> 8) % kNumContainers);
+          int item = static_cast<int>((random >> 16) % kNumItems);
+          benchmark::DoNotOptimize(op(*containers, item, from, to));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  state.SetItemsProcessed(int64_t(state.iterations()) * kThreads *
+                          kOpsPerThread);
+}
+
+// Removes a random item from one list and adds it to another, if present
+template<typename Lists>
+static void BM_ComposedListMove(benchmark::State& state) {
+  run_composed<Lists>(state, [](Lists& lists, int item, int from, int to) {
+    return lists.move(item, from, to);
+  });
+}
+
+// Moves the front of one queue to the back of another
+template<typename Queues>
+static void BM_ComposedQueueTransfer(benchmark::State& state) {
+  run_composed<Queues>(state, [](Queues& queues, int, int from, int to) {
+    return queues.transfer(from, to);
+  });
+}
+
+BENCHMARK_TEMPLATE(BM_ComposedListMove, TMLists)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ComposedListMove, CoarseLockedLists)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ComposedQueueTransfer, TMQueues)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_ComposedQueueTransfer, CoarseLockedQueues)
+    ->RangeMultiplier(kMultiThreads)
+    ->Range(kMinThreads, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
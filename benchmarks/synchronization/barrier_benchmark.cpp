@@ -0,0 +1,82 @@
+#include <barrier>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "synchronization/barrier.h"
+
+// Arrives at `barrier` as thread `id`, for the barriers that take no id too
+template<typename Barrier>
+static auto arrive_and_wait(Barrier& barrier, size_t id) -> void {
+  if constexpr (requires { barrier.arrive_and_wait(id); }) {
+    barrier.arrive_and_wait(id);
+  } else {
+    barrier.arrive_and_wait();
+  }
+}
+
+// Every thread runs `kNumPhases` empty phases, so the benchmark measures the
+// barrier alone: the time per phase is the latency of one episode.
+template<typename Barrier>
+static void BM_Barrier(benchmark::State& state) {
+  const size_t kNumThreads = state.range(0);
+  constexpr uint32_t kNumPhases = 1000;
+
+  for (auto _ : state) {
+    Barrier barrier(kNumThreads);
+    std::vector<std::thread> threads;
+    threads.reserve(kNumThreads);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (size_t id = 0; id < kNumThreads; id++) {
+      threads.emplace_back([&barrier, id]() {
+        for (uint32_t phase = 0; phase < kNumPhases; phase++) {
+          arrive_and_wait(barrier, id);
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end_time - start_time);
+
+    state.SetIterationTime(elapsed.count() / 1e9);
+    state.counters["phases_per_second"] =
+        benchmark::Counter(kNumPhases, benchmark::Counter::kIsRate);
+  }
+}
+
+BENCHMARK(BM_Barrier<std::barrier<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 128)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Barrier<SenseReversingBarrier<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 128)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Barrier<CombiningTreeBarrier<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 128)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Barrier<StaticTreeBarrier<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 128)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Barrier<DisseminationBarrier<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 128)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
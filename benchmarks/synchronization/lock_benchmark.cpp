@@ -1,18 +1,41 @@
+#include <chrono>
+#include <fstream>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
 #include "benchmark/benchmark.h"
+#include "common/latency_histogram.h"
 #include "synchronization/backoff_lock.h"
 #include "synchronization/clh_lock.h"
+#include "synchronization/cohort_lock.h"
+#include "synchronization/composite_lock.h"
+#include "synchronization/elided_lock.h"
+#include "synchronization/hbo_lock.h"
 #include "synchronization/mcs_lock.h"
+#include "synchronization/partitioned_ticket_lock.h"
+#include "synchronization/qspin_lock.h"
+#include "synchronization/reentrant_lock.h"
 #include "synchronization/tas_lock.h"
 #include "synchronization/ticket_lock.h"
+#include "synchronization/timeout_lock.h"
 #include "synchronization/ttas_lock.h"
+#include "synchronization/twa_lock.h"
+#include "util/atomic_stamped_ptr.h"
+#include "util/numa.h"
 
-thread_local MCSLock::QNode MCSLock::my_node_;
-thread_local CLHLock::QNode* CLHLock::my_pred_ = nullptr;
-thread_local CLHLock::QNode* CLHLock::my_node_ = new QNode();
+#ifdef __linux__
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// A BackoffLock that sleeps for every backoff delay, as Backoff did before it
+// learned to spin through short delays
+class SleepingBackoffLock : public BackoffLock<> {
+ public:
+  SleepingBackoffLock() : BackoffLock(5, 25, std::chrono::microseconds(0)) {}
+};
 
 // A simple counter protected by the lock being benchmarked
 class ProtectedCounter {
@@ -24,6 +47,9 @@ class ProtectedCounter {
     lock.unlock();
   }
 
+  // For callers that acquire the lock themselves
+  auto increment_locked() noexcept -> void { counter_++; }
+
   auto get() const noexcept -> uint64_t { return counter_; }
 
   auto reset() noexcept -> void { counter_ = 0; }
@@ -32,9 +58,27 @@ class ProtectedCounter {
   uint64_t counter_{0};
 };
 
-// Templated Lock Benchmark
+// Pins the calling thread, the `i`-th one of a benchmark, to a CPU of NUMA
+// node `i % numa_node_count()`, so that consecutive threads sit on different
+// nodes and every handoff between them crosses the interconnect
+static auto pin_across_nodes(uint32_t i) -> void {
+#ifdef __linux__
+  const NumaMap& map = NumaMap::instance();
+  const std::vector<int>& cpus = map.cpus(i % map.node_count());
+  if (cpus.empty()) {
+    return;
+  }
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpus[(i / map.node_count()) % cpus.size()], &cpu_set);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#else
+  (void)i;
+#endif
+}
+
 template<typename LockType>
-static void BM_Lock(benchmark::State& state) {
+static void run_lock_benchmark(benchmark::State& state, bool pin) {
   // Number of threads to use
   const uint32_t kNumThreads = state.range(0);
   constexpr uint32_t kNumIterations = 10000;
@@ -56,7 +100,11 @@ static void BM_Lock(benchmark::State& state) {
 
     // Create threads
     for (uint32_t i = 0; i < kNumThreads; i++) {
-      threads.emplace_back([&counter, &lock, &start, &threads_ready]() {
+      threads.emplace_back([&counter, &lock, &start, &threads_ready, pin, i]() {
+        if (pin) {
+          pin_across_nodes(i);
+        }
+
         // Signal this thread is ready
         threads_ready.fetch_add(1);
 
@@ -104,6 +152,137 @@ static void BM_Lock(benchmark::State& state) {
   }
 }
 
+// The resident set size of the process in MiB, or 0 where it is unknown
+static auto resident_set_mib() -> double {
+#ifdef __linux__
+  std::ifstream statm("/proc/self/statm");
+  uint64_t size = 0;
+  uint64_t resident = 0;
+  if (statm >> size >> resident) {
+    return static_cast<double>(resident * sysconf(_SC_PAGESIZE)) /
+           (1024 * 1024);
+  }
+#endif
+  return 0;
+}
+
+// Every thread acquires the lock with a short timeout, so that many attempts
+// give up in the middle of the queue. Reports the growth of the resident set
+// over all iterations, which stays flat unless abandoned nodes leak.
+template<typename LockType>
+static void BM_TimedLock(benchmark::State& state) {
+  const uint32_t kNumThreads = state.range(0);
+  constexpr uint32_t kNumIterations = 10000;
+
+  ProtectedCounter counter;
+  LockType lock;
+  const double rss_before = resident_set_mib();
+
+  for (auto _ : state) {
+    std::atomic<uint64_t> timed_out{0};
+    std::vector<std::thread> threads;
+    threads.reserve(kNumThreads);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < kNumThreads; i++) {
+      threads.emplace_back([&counter, &lock, &timed_out]() {
+        constexpr auto kTimeout = std::chrono::microseconds(5);
+        for (uint32_t j = 0; j < kNumIterations; j++) {
+          if (lock.try_lock_for(kTimeout)) {
+            counter.increment_locked();
+            lock.unlock();
+          } else {
+            timed_out.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end_time - start_time);
+
+    state.SetIterationTime(elapsed.count() / 1e6);
+    state.counters["ops_per_second"] = benchmark::Counter(
+        kNumThreads * kNumIterations, benchmark::Counter::kIsRate);
+    state.counters["timed_out"] = static_cast<double>(timed_out.load());
+  }
+
+  state.counters["rss_growth_mib"] = resident_set_mib() - rss_before;
+}
+
+// Times every acquire-increment-release of run_lock_benchmark separately.
+// Reports the latency percentiles, which show the handoff delays a fair queue
+// lock bounds and a test-and-set lock does not, and how evenly the threads
+// shared the lock.
+template<typename LockType>
+static void BM_LockLatency(benchmark::State& state) {
+  const uint32_t kNumThreads = state.range(0);
+  constexpr uint32_t kNumIterations = 10000;
+
+  ProtectedCounter counter;
+  LockType lock;
+  LatencyRecorder recorder(kNumThreads);
+
+  for (auto _ : state) {
+    counter.reset();
+    std::vector<std::thread> threads;
+    threads.reserve(kNumThreads);
+    for (uint32_t i = 0; i < kNumThreads; i++) {
+      threads.emplace_back([&counter, &lock, &recorder, i]() {
+        ThreadLatency& latency = recorder.thread(i);
+        latency.start();
+        for (uint32_t j = 0; j < kNumIterations; j++) {
+          latency.measure([&counter, &lock]() { counter.increment(lock); });
+        }
+        latency.stop();
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    if (counter.get() != kNumThreads * kNumIterations) {
+      state.SkipWithError("Race condition detected!");
+    }
+  }
+
+  recorder.report(state);
+  state.SetItemsProcessed(state.iterations() * kNumThreads * kNumIterations);
+}
+
+// A single thread re-enters the lock `state.range(0)` deep, as code that
+// calls back into itself under the lock does
+template<typename LockType>
+static void BM_NestedLock(benchmark::State& state) {
+  const int64_t kDepth = state.range(0);
+  LockType lock;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kDepth; i++) {
+      lock.lock();
+    }
+    for (int64_t i = 0; i < kDepth; i++) {
+      lock.unlock();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kDepth);
+}
+
+// Templated Lock Benchmark
+template<typename LockType>
+static void BM_Lock(benchmark::State& state) {
+  run_lock_benchmark<LockType>(state, false);
+}
+
+// The same benchmark with threads spread round-robin over the NUMA nodes,
+// which shows the cost of handing the lock and the counter across nodes
+template<typename LockType>
+static void BM_LockAcrossNodes(benchmark::State& state) {
+  run_lock_benchmark<LockType>(state, true);
+}
+
 // Register benchmarks. Test with 1, 2, 4, 8, 16, 32 threads
 BENCHMARK(BM_Lock<BackoffLock<>>)
     ->RangeMultiplier(2)
@@ -111,13 +290,38 @@ BENCHMARK(BM_Lock<BackoffLock<>>)
     ->UseRealTime()
     ->Unit(benchmark::kMillisecond);
 
-BENCHMARK(BM_Lock<CLHLock>)
+BENCHMARK(BM_Lock<SleepingBackoffLock>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Lock<CLHLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Lock<MCSLock<>>)
     ->RangeMultiplier(2)
     ->Range(2, 32)
     ->UseRealTime()
     ->Unit(benchmark::kMillisecond);
 
-BENCHMARK(BM_Lock<MCSLock>)
+// The same queue lock under each wait policy
+BENCHMARK(BM_Lock<MCSLock<SpinWait>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Lock<MCSLock<PauseBackoffWait<>>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Lock<MCSLock<SpinThenPark<>>>)
     ->RangeMultiplier(2)
     ->Range(2, 32)
     ->UseRealTime()
@@ -129,13 +333,110 @@ BENCHMARK(BM_Lock<TASLock>)
     ->UseRealTime()
     ->Unit(benchmark::kMillisecond);
 
-BENCHMARK(BM_Lock<TicketLock>)
+BENCHMARK(BM_Lock<TicketLock<>>)
     ->RangeMultiplier(2)
     ->Range(2, 32)
     ->UseRealTime()
     ->Unit(benchmark::kMillisecond);
 
-BENCHMARK(BM_Lock<TTASLock>)
+// Ticket locks whose waiters do not all spin on one word
+BENCHMARK(BM_Lock<PartitionedTicketLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Lock<TWALock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Lock<TTASLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(1, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// As fast as TTASLock alone, and queues up like MCSLock once contended
+BENCHMARK(BM_Lock<QSpinLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(1, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Every critical section updates the same counter, so elided sections
+// conflict and the adaptive penalty soon sends them to the TTASLock
+BENCHMARK(BM_Lock<ElidedLock<TTASLock<>>>)
+    ->RangeMultiplier(2)
+    ->Range(1, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// From one thread, where it takes its fast path, as TTASLock above
+BENCHMARK(BM_Lock<CompositeLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(1, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// NUMA-aware locks next to the plain locks they are built from, with threads
+// pinned across nodes
+BENCHMARK(BM_LockAcrossNodes<BackoffLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LockAcrossNodes<HBOLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LockAcrossNodes<MCSLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LockAcrossNodes<CohortLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Timed acquisition, where abandoned queue nodes have to be reclaimed
+BENCHMARK(BM_TimedLock<TOLock>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_TimedLock<CLHLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_TimedLock<MCSLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_TimedLock<CompositeLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Re-entry by the owner, which ReentrantLock serves without atomic writes
+BENCHMARK(BM_NestedLock<ReentrantLock<>>)->Arg(1)->Arg(8);
+
+BENCHMARK(BM_NestedLock<std::recursive_mutex>)->Arg(1)->Arg(8);
+
+BENCHMARK(BM_Lock<ReentrantLock<>>)
     ->RangeMultiplier(2)
     ->Range(2, 32)
     ->UseRealTime()
@@ -147,7 +448,65 @@ BENCHMARK(BM_Lock<std::mutex>)
     ->UseRealTime()
     ->Unit(benchmark::kMillisecond);
 
+// Per-acquisition latency and fairness
+BENCHMARK(BM_LockLatency<TASLock>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LockLatency<TTASLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LockLatency<TicketLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LockLatency<PartitionedTicketLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LockLatency<TWALock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LockLatency<CLHLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LockLatency<MCSLock<>>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LockLatency<std::mutex>)
+    ->RangeMultiplier(2)
+    ->Range(2, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
 // Add more benchmarks for your other lock implementations here
 
 // Main function to run the benchmarks
+// Reports which AtomicStampedPtr representation the stamped structures use
+static const bool kStampReported = [] {
+  benchmark::AddCustomContext(
+      "atomic_stamped_ptr",
+      std::string(AtomicStampedPtr<int>::kRepresentation) +
+          (AtomicStampedPtr<int>::kIsLockFree ? ", lock-free" : ", may lock"));
+  return true;
+}();
+
 BENCHMARK_MAIN();
@@ -1,16 +1,29 @@
 #include <atomic>
-#include <barrier>
 #include <thread>
 #include <vector>
 
 #include "benchmark/benchmark.h"
+#include "common/latency_histogram.h"
+#include "synchronization/barrier.h"
+#include "synchronization/bravo_lock.h"
+#include "synchronization/distributed_read_write_lock.h"
 #include "synchronization/fifo_read_write_lock.h"
+#include "synchronization/mcs_read_write_lock.h"
+#include "synchronization/phase_fair_read_write_lock.h"
+#include "synchronization/reentrant_read_write_lock.h"
 #include "synchronization/simple_read_write_lock.h"
+#include "util/backoff.h"
 
 // Shared test parameters
 constexpr uint32_t kSharedValue = 42;
 constexpr uint32_t kWriteValue = 100;
 
+// A uniform random number in [0, 1). Unlike rand(), it takes no lock, which
+// would serialize the readers of every lock under test.
+static auto random_fraction() -> double {
+  return static_cast<double>(random_uint64() >> 11) * 0x1.0p-53;
+}
+
 // Common benchmark function that can be used with different lock
 // implementations
 template<typename LockType>
@@ -36,7 +49,7 @@ static void BM_ReadHeavyWorkload(benchmark::State& state) {
     threads.clear();
 
     // Create a barrier to ensure all threads start at the same time
-    std::barrier sync_point(kNumThreads + 1);
+    SenseReversingBarrier<> sync_point(kNumThreads + 1);
 
     for (size_t i = 0; i < kNumThreads; i++) {
       threads.emplace_back([&]() {
@@ -45,7 +58,7 @@ static void BM_ReadHeavyWorkload(benchmark::State& state) {
 
         for (size_t op = 0; op < kOperationsPerThread; op++) {
           // Determine if this operation should be a read or write
-          bool do_read = (static_cast<double>(rand()) / RAND_MAX) < read_ratio;
+          bool do_read = random_fraction() < read_ratio;
 
           if (do_read) {
             // Read operation
@@ -117,7 +130,7 @@ static void BM_WriteHeavyWorkload(benchmark::State& state) {
     threads.clear();
 
     // Create a barrier to ensure all threads start at the same time
-    std::barrier sync_point(kNumThreads + 1);
+    SenseReversingBarrier<> sync_point(kNumThreads + 1);
 
     for (size_t i = 0; i < kNumThreads; i++) {
       threads.emplace_back([&]() {
@@ -126,8 +139,7 @@ static void BM_WriteHeavyWorkload(benchmark::State& state) {
 
         for (size_t op = 0; op < kOperationsPerThread; op++) {
           // Determine if this operation should be a write or read
-          bool do_write =
-              (static_cast<double>(rand()) / RAND_MAX) < write_ratio;
+          bool do_write = random_fraction() < write_ratio;
 
           if (do_write) {
             // Write operation
@@ -199,7 +211,7 @@ static void BM_BalancedWorkload(benchmark::State& state) {
     threads.clear();
 
     // Create a barrier to ensure all threads start at the same time
-    std::barrier sync_point(kNumThreads + 1);
+    SenseReversingBarrier<> sync_point(kNumThreads + 1);
 
     for (size_t i = 0; i < kNumThreads; i++) {
       threads.emplace_back([&]() {
@@ -208,7 +220,7 @@ static void BM_BalancedWorkload(benchmark::State& state) {
 
         for (size_t op = 0; op < kOperationsPerThread; op++) {
           // Determine if this operation should be a read or write
-          bool do_read = (static_cast<double>(rand()) / RAND_MAX) < read_ratio;
+          bool do_read = random_fraction() < read_ratio;
 
           if (do_read) {
             // Read operation
@@ -279,7 +291,7 @@ static void BM_HighContention(benchmark::State& state) {
     threads.clear();
 
     // Create a barrier to ensure all threads start at the same time
-    std::barrier sync_point(kNumThreads + 1);
+    SenseReversingBarrier<> sync_point(kNumThreads + 1);
 
     for (size_t i = 0; i < kNumThreads; i++) {
       threads.emplace_back([&]() {
@@ -356,7 +368,7 @@ static void BM_LowContention(benchmark::State& state) {
     threads.clear();
 
     // Create a barrier to ensure all threads start at the same time
-    std::barrier sync_point(kNumThreads + 1);
+    SenseReversingBarrier<> sync_point(kNumThreads + 1);
 
     for (size_t i = 0; i < kNumThreads; i++) {
       threads.emplace_back([&, i]() {
@@ -446,7 +458,7 @@ static void BM_ReaderStarvation(benchmark::State& state) {
     threads.clear();
 
     // Create a barrier to ensure all threads start at the same time
-    std::barrier sync_point(kNumThreads + 1);
+    SenseReversingBarrier<> sync_point(kNumThreads + 1);
 
     // Create writer threads first (more likely to get priority with some
     // implementations)
@@ -534,7 +546,7 @@ static void BM_WriterStarvation(benchmark::State& state) {
     threads.clear();
 
     // Barrier to synchronize thread startup
-    std::barrier sync_point(kNumThreads + 1);
+    SenseReversingBarrier<> sync_point(kNumThreads + 1);
 
     // Create reader threads
     for (size_t i = 0; i < kNumReaderThreads; i++) {
@@ -618,84 +630,333 @@ static void BM_WriterStarvation(benchmark::State& state) {
       benchmark::Counter::kAvgThreads);  // Reads per write ratio
 }
 
+// The read-heavy mix of BM_ReadHeavyWorkload with every lock-protected section
+// timed. Reports latency percentiles over reads and writes together, where the
+// tail is made of the operations that waited behind a writer, and how evenly
+// the threads progressed.
+template<typename LockType>
+static void BM_ReadWriteLatency(benchmark::State& state) {
+  LockType lock;
+  uint32_t shared_data = kSharedValue;
+  constexpr double read_ratio = 0.95;
+
+  const size_t kNumThreads = state.range(0);
+  const size_t kOperationsPerThread = state.range(1);
+  LatencyRecorder recorder(kNumThreads);
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    threads.clear();
+    SenseReversingBarrier<> sync_point(kNumThreads + 1);
+
+    for (size_t i = 0; i < kNumThreads; i++) {
+      threads.emplace_back([&, i]() {
+        ThreadLatency& latency = recorder.thread(i);
+        sync_point.arrive_and_wait();
+
+        latency.start();
+        for (size_t op = 0; op < kOperationsPerThread; op++) {
+          if (random_fraction() < read_ratio) {
+            latency.measure([&]() {
+              lock.read_lock();
+              benchmark::DoNotOptimize(shared_data);
+              lock.read_unlock();
+            });
+          } else {
+            latency.measure([&]() {
+              lock.write_lock();
+              shared_data = kWriteValue;
+              benchmark::DoNotOptimize(shared_data);
+              shared_data = kSharedValue;
+              lock.write_unlock();
+            });
+          }
+        }
+        latency.stop();
+      });
+    }
+
+    sync_point.arrive_and_wait();
+    state.ResumeTiming();
+
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+  recorder.report(state);
+  state.SetItemsProcessed(state.iterations() * kNumThreads *
+                          kOperationsPerThread);
+}
+
 // Register benchmarks for SimpleReadWriteLock
-BENCHMARK_TEMPLATE(BM_ReadHeavyWorkload, SimpleReadWriteLock)
+BENCHMARK_TEMPLATE(BM_ReadHeavyWorkload, SimpleReadWriteLock<>)
     ->Args({4, 10000})  // 4 threads, 10k ops per thread
     ->Args({8, 5000})   // 8 threads, 5k ops per thread
     ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
     ->UseRealTime();
 
-BENCHMARK_TEMPLATE(BM_WriteHeavyWorkload, SimpleReadWriteLock)
+BENCHMARK_TEMPLATE(BM_WriteHeavyWorkload, SimpleReadWriteLock<>)
     ->Args({4, 5000})   // 4 threads, 5k ops per thread
     ->Args({8, 2500})   // 8 threads, 2.5k ops per thread
     ->Args({16, 1250})  // 16 threads, 1.25k ops per thread
     ->UseRealTime();
 
-BENCHMARK_TEMPLATE(BM_BalancedWorkload, SimpleReadWriteLock)
+BENCHMARK_TEMPLATE(BM_BalancedWorkload, SimpleReadWriteLock<>)
     ->Args({4, 10000})  // 4 threads, 10k ops per thread
     ->Args({8, 5000})   // 8 threads, 5k ops per thread
     ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
     ->UseRealTime();
 
-BENCHMARK_TEMPLATE(BM_HighContention, SimpleReadWriteLock)
+BENCHMARK_TEMPLATE(BM_HighContention, SimpleReadWriteLock<>)
     ->Args({32, 1000})  // 32 threads, 1k ops per thread (high thread count)
     ->Args({64,
             500})  // 64 threads, 500 ops per thread (very high thread count)
     ->UseRealTime();
 
-BENCHMARK_TEMPLATE(BM_LowContention, SimpleReadWriteLock)
+BENCHMARK_TEMPLATE(BM_LowContention, SimpleReadWriteLock<>)
     ->Args({2, 10000})  // 2 threads, 10k ops per thread (low thread count)
     ->Args({4, 5000})   // 4 threads, 5k ops per thread
     ->UseRealTime();
 
-BENCHMARK_TEMPLATE(BM_ReaderStarvation, SimpleReadWriteLock)
+BENCHMARK_TEMPLATE(BM_ReaderStarvation, SimpleReadWriteLock<>)
     ->Args({16, 2000})  // 16 threads, 2k ops per thread
     ->Args({32, 1000})  // 32 threads, 1k ops per thread
     ->UseRealTime();
 
-BENCHMARK_TEMPLATE(BM_WriterStarvation, SimpleReadWriteLock)
+BENCHMARK_TEMPLATE(BM_WriterStarvation, SimpleReadWriteLock<>)
     ->Args({16, 2000})  // 16 threads, 2k ops per thread
     ->Args({32, 1000})  // 32 threads, 1k ops per thread
     ->UseRealTime();
 
 // Register benchmarks for FIFOReadWriteLock
-BENCHMARK_TEMPLATE(BM_ReadHeavyWorkload, FIFOReadWriteLock)
+BENCHMARK_TEMPLATE(BM_ReadHeavyWorkload, FIFOReadWriteLock<>)
+    ->Args({4, 10000})  // 4 threads, 10k ops per thread
+    ->Args({8, 5000})   // 8 threads, 5k ops per thread
+    ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_WriteHeavyWorkload, FIFOReadWriteLock<>)
+    ->Args({4, 5000})   // 4 threads, 5k ops per thread
+    ->Args({8, 2500})   // 8 threads, 2.5k ops per thread
+    ->Args({16, 1250})  // 16 threads, 1.25k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_BalancedWorkload, FIFOReadWriteLock<>)
+    ->Args({4, 10000})  // 4 threads, 10k ops per thread
+    ->Args({8, 5000})   // 8 threads, 5k ops per thread
+    ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_HighContention, FIFOReadWriteLock<>)
+    ->Args({32, 1000})  // 32 threads, 1k ops per thread (high thread count)
+    ->Args({64,
+            500})  // 64 threads, 500 ops per thread (very high thread count)
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_LowContention, FIFOReadWriteLock<>)
+    ->Args({2, 10000})  // 2 threads, 10k ops per thread (low thread count)
+    ->Args({4, 5000})   // 4 threads, 5k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_ReaderStarvation, FIFOReadWriteLock<>)
+    ->Args({16, 2000})  // 16 threads, 2k ops per thread
+    ->Args({32, 1000})  // 32 threads, 1k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_WriterStarvation, FIFOReadWriteLock<>)
+    ->Args({16, 2000})  // 16 threads, 2k ops per thread
+    ->Args({32, 1000})  // 32 threads, 1k ops per thread
+    ->UseRealTime();
+
+// Register benchmarks for DistributedReadWriteLock
+BENCHMARK_TEMPLATE(BM_ReadHeavyWorkload, DistributedReadWriteLock<>)
+    ->Args({4, 10000})  // 4 threads, 10k ops per thread
+    ->Args({8, 5000})   // 8 threads, 5k ops per thread
+    ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_WriteHeavyWorkload, DistributedReadWriteLock<>)
+    ->Args({4, 5000})   // 4 threads, 5k ops per thread
+    ->Args({8, 2500})   // 8 threads, 2.5k ops per thread
+    ->Args({16, 1250})  // 16 threads, 1.25k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_BalancedWorkload, DistributedReadWriteLock<>)
+    ->Args({4, 10000})  // 4 threads, 10k ops per thread
+    ->Args({8, 5000})   // 8 threads, 5k ops per thread
+    ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_HighContention, DistributedReadWriteLock<>)
+    ->Args({32, 1000})  // 32 threads, 1k ops per thread (high thread count)
+    ->Args({64,
+            500})  // 64 threads, 500 ops per thread (very high thread count)
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_LowContention, DistributedReadWriteLock<>)
+    ->Args({2, 10000})  // 2 threads, 10k ops per thread (low thread count)
+    ->Args({4, 5000})   // 4 threads, 5k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_ReaderStarvation, DistributedReadWriteLock<>)
+    ->Args({16, 2000})  // 16 threads, 2k ops per thread
+    ->Args({32, 1000})  // 32 threads, 1k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_WriterStarvation, DistributedReadWriteLock<>)
+    ->Args({16, 2000})  // 16 threads, 2k ops per thread
+    ->Args({32, 1000})  // 32 threads, 1k ops per thread
+    ->UseRealTime();
+
+// Register benchmarks for PhaseFairReadWriteLock
+BENCHMARK_TEMPLATE(BM_ReadHeavyWorkload, PhaseFairReadWriteLock<>)
+    ->Args({4, 10000})  // 4 threads, 10k ops per thread
+    ->Args({8, 5000})   // 8 threads, 5k ops per thread
+    ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_WriteHeavyWorkload, PhaseFairReadWriteLock<>)
+    ->Args({4, 5000})   // 4 threads, 5k ops per thread
+    ->Args({8, 2500})   // 8 threads, 2.5k ops per thread
+    ->Args({16, 1250})  // 16 threads, 1.25k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_BalancedWorkload, PhaseFairReadWriteLock<>)
+    ->Args({4, 10000})  // 4 threads, 10k ops per thread
+    ->Args({8, 5000})   // 8 threads, 5k ops per thread
+    ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_HighContention, PhaseFairReadWriteLock<>)
+    ->Args({32, 1000})  // 32 threads, 1k ops per thread (high thread count)
+    ->Args({64,
+            500})  // 64 threads, 500 ops per thread (very high thread count)
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_LowContention, PhaseFairReadWriteLock<>)
+    ->Args({2, 10000})  // 2 threads, 10k ops per thread (low thread count)
+    ->Args({4, 5000})   // 4 threads, 5k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_ReaderStarvation, PhaseFairReadWriteLock<>)
+    ->Args({16, 2000})  // 16 threads, 2k ops per thread
+    ->Args({32, 1000})  // 32 threads, 1k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_WriterStarvation, PhaseFairReadWriteLock<>)
+    ->Args({16, 2000})  // 16 threads, 2k ops per thread
+    ->Args({32, 1000})  // 32 threads, 1k ops per thread
+    ->UseRealTime();
+
+// Register benchmarks for MCSReadWriteLock
+BENCHMARK_TEMPLATE(BM_ReadHeavyWorkload, MCSReadWriteLock<>)
     ->Args({4, 10000})  // 4 threads, 10k ops per thread
     ->Args({8, 5000})   // 8 threads, 5k ops per thread
     ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
     ->UseRealTime();
 
-BENCHMARK_TEMPLATE(BM_WriteHeavyWorkload, FIFOReadWriteLock)
+BENCHMARK_TEMPLATE(BM_WriteHeavyWorkload, MCSReadWriteLock<>)
     ->Args({4, 5000})   // 4 threads, 5k ops per thread
     ->Args({8, 2500})   // 8 threads, 2.5k ops per thread
     ->Args({16, 1250})  // 16 threads, 1.25k ops per thread
     ->UseRealTime();
 
-BENCHMARK_TEMPLATE(BM_BalancedWorkload, FIFOReadWriteLock)
+BENCHMARK_TEMPLATE(BM_BalancedWorkload, MCSReadWriteLock<>)
+    ->Args({4, 10000})  // 4 threads, 10k ops per thread
+    ->Args({8, 5000})   // 8 threads, 5k ops per thread
+    ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
+    ->UseRealTime();
+
+// Register benchmarks for ReentrantReadWriteLock
+BENCHMARK_TEMPLATE(BM_ReadHeavyWorkload, ReentrantReadWriteLock<>)
     ->Args({4, 10000})  // 4 threads, 10k ops per thread
     ->Args({8, 5000})   // 8 threads, 5k ops per thread
     ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
     ->UseRealTime();
 
-BENCHMARK_TEMPLATE(BM_HighContention, FIFOReadWriteLock)
+BENCHMARK_TEMPLATE(BM_WriteHeavyWorkload, ReentrantReadWriteLock<>)
+    ->Args({4, 5000})   // 4 threads, 5k ops per thread
+    ->Args({8, 2500})   // 8 threads, 2.5k ops per thread
+    ->Args({16, 1250})  // 16 threads, 1.25k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_BalancedWorkload, ReentrantReadWriteLock<>)
+    ->Args({4, 10000})  // 4 threads, 10k ops per thread
+    ->Args({8, 5000})   // 8 threads, 5k ops per thread
+    ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
+    ->UseRealTime();
+
+// Register benchmarks for BravoLock
+BENCHMARK_TEMPLATE(BM_ReadHeavyWorkload, BravoLock<>)
+    ->Args({4, 10000})  // 4 threads, 10k ops per thread
+    ->Args({8, 5000})   // 8 threads, 5k ops per thread
+    ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_WriteHeavyWorkload, BravoLock<>)
+    ->Args({4, 5000})   // 4 threads, 5k ops per thread
+    ->Args({8, 2500})   // 8 threads, 2.5k ops per thread
+    ->Args({16, 1250})  // 16 threads, 1.25k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_BalancedWorkload, BravoLock<>)
+    ->Args({4, 10000})  // 4 threads, 10k ops per thread
+    ->Args({8, 5000})   // 8 threads, 5k ops per thread
+    ->Args({16, 2500})  // 16 threads, 2.5k ops per thread
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_HighContention, BravoLock<>)
     ->Args({32, 1000})  // 32 threads, 1k ops per thread (high thread count)
     ->Args({64,
             500})  // 64 threads, 500 ops per thread (very high thread count)
     ->UseRealTime();
 
-BENCHMARK_TEMPLATE(BM_LowContention, FIFOReadWriteLock)
+BENCHMARK_TEMPLATE(BM_LowContention, BravoLock<>)
     ->Args({2, 10000})  // 2 threads, 10k ops per thread (low thread count)
     ->Args({4, 5000})   // 4 threads, 5k ops per thread
     ->UseRealTime();
 
-BENCHMARK_TEMPLATE(BM_ReaderStarvation, FIFOReadWriteLock)
+BENCHMARK_TEMPLATE(BM_ReaderStarvation, BravoLock<>)
     ->Args({16, 2000})  // 16 threads, 2k ops per thread
     ->Args({32, 1000})  // 32 threads, 1k ops per thread
     ->UseRealTime();
 
-BENCHMARK_TEMPLATE(BM_WriterStarvation, FIFOReadWriteLock)
+BENCHMARK_TEMPLATE(BM_WriterStarvation, BravoLock<>)
     ->Args({16, 2000})  // 16 threads, 2k ops per thread
     ->Args({32, 1000})  // 32 threads, 1k ops per thread
     ->UseRealTime();
 
+// Per-operation latency and fairness of every lock under the read-heavy mix
+BENCHMARK_TEMPLATE(BM_ReadWriteLatency, SimpleReadWriteLock<>)
+    ->Args({8, 5000})
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_ReadWriteLatency, FIFOReadWriteLock<>)
+    ->Args({8, 5000})
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_ReadWriteLatency, DistributedReadWriteLock<>)
+    ->Args({8, 5000})
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_ReadWriteLatency, PhaseFairReadWriteLock<>)
+    ->Args({8, 5000})
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_ReadWriteLatency, MCSReadWriteLock<>)
+    ->Args({8, 5000})
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_ReadWriteLatency, ReentrantReadWriteLock<>)
+    ->Args({8, 5000})
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_ReadWriteLatency, BravoLock<>)
+    ->Args({8, 5000})
+    ->UseRealTime();
+
 BENCHMARK_MAIN();
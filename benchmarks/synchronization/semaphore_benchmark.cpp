@@ -0,0 +1,103 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "synchronization/lock_free_semaphore.h"
+#include "synchronization/semaphore.h"
+
+// A connection pool: many workers share a few permits, each holding one for a
+// short piece of work. Most workers are parked at any time, so a release that
+// wakes every waiter shows up as wasted wake-ups and lower throughput.
+template<typename SemaphoreType>
+static void BM_ConnectionPool(benchmark::State& state) {
+  const uint32_t kNumThreads = state.range(0);
+  constexpr int kPermits = 8;
+  constexpr uint32_t kTotalOperations = 64000;
+  const uint32_t kNumIterations = kTotalOperations / kNumThreads;
+
+  for (auto _ : state) {
+    SemaphoreType sem{kPermits};
+    std::atomic<uint64_t> work{0};
+    std::vector<std::thread> threads;
+    threads.reserve(kNumThreads);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < kNumThreads; i++) {
+      threads.emplace_back([&sem, &work, kNumIterations]() {
+        for (uint32_t j = 0; j < kNumIterations; j++) {
+          sem.acquire();
+          work.fetch_add(1, std::memory_order_relaxed);
+          sem.release();
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end_time - start_time);
+
+    state.SetIterationTime(elapsed.count() / 1e9);
+    state.counters["ops_per_second"] = benchmark::Counter(
+        kNumThreads * kNumIterations, benchmark::Counter::kIsRate);
+  }
+}
+
+// Workers that return their permits in batches, as a pool that refills
+// several connections at once
+template<typename SemaphoreType>
+static void BM_BatchRelease(benchmark::State& state) {
+  const uint32_t kNumWaiters = state.range(0);
+  constexpr int kBatch = 16;
+
+  for (auto _ : state) {
+    SemaphoreType sem{0};
+    std::vector<std::thread> threads;
+    threads.reserve(kNumWaiters);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < kNumWaiters; i++) {
+      threads.emplace_back([&sem]() { sem.acquire(); });
+    }
+    for (uint32_t released = 0; released < kNumWaiters; released += kBatch) {
+      sem.release(kBatch);
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end_time - start_time);
+
+    state.SetIterationTime(elapsed.count() / 1e9);
+  }
+}
+
+BENCHMARK(BM_ConnectionPool<Semaphore<>>)
+    ->RangeMultiplier(4)
+    ->Range(8, 512)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_ConnectionPool<LockFreeSemaphore>)
+    ->RangeMultiplier(4)
+    ->Range(8, 512)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_BatchRelease<Semaphore<>>)
+    ->RangeMultiplier(4)
+    ->Range(16, 512)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_BatchRelease<LockFreeSemaphore>)
+    ->RangeMultiplier(4)
+    ->Range(16, 512)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
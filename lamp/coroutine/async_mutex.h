@@ -0,0 +1,120 @@
+#ifndef ASYNC_MUTEX_H_
+#define ASYNC_MUTEX_H_
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+
+#include "coroutine/executor.h"
+
+/**
+ * AsyncMutex - A mutex that coroutines acquire with `co_await mutex.lock()`,
+ * without blocking their thread
+ *
+ * The state is one word: unlocked, locked without waiters, or the head of a
+ * stack of waiting awaiters. A coroutine that finds the mutex locked pushes
+ * its awaiter, which lives in its own frame, with a CAS and suspends, so
+ * waiting neither allocates nor occupies a thread. unlock() hands the mutex
+ * to the oldest waiter and resumes it on the executor. To keep the order
+ * FIFO, the holder takes the whole stack with one exchange when its private
+ * list of waiters runs out, and reverses it into that list; only the holder
+ * touches the list.
+ *
+ * Modeled on cppcoro's async_mutex. The mutex must outlive its waiters.
+ */
+class AsyncMutex {
+ public:
+  class LockAwaiter {
+   public:
+    explicit LockAwaiter(AsyncMutex& mutex) : mutex_(mutex) {}
+
+    auto await_ready() -> bool { return mutex_.try_lock(); }
+
+    auto await_suspend(std::coroutine_handle<> handle) -> bool {
+      handle_ = handle;
+      uintptr_t state = mutex_.state_.load(std::memory_order_acquire);
+      while (true) {
+        if (state == kUnlocked) {
+          if (mutex_.state_.compare_exchange_weak(state, kLockedNoWaiters,
+                                                  std::memory_order_acquire,
+                                                  std::memory_order_acquire)) {
+            // Acquired after all; continue without suspending
+            return false;
+          }
+          continue;
+        }
+        next_ = reinterpret_cast<LockAwaiter*>(state);
+        // Once pushed, the awaiter may be resumed before this call returns
+        if (mutex_.state_.compare_exchange_weak(
+                state, reinterpret_cast<uintptr_t>(this),
+                std::memory_order_release, std::memory_order_acquire)) {
+          return true;
+        }
+      }
+    }
+
+    auto await_resume() const -> void {}
+
+   private:
+    friend class AsyncMutex;
+
+    AsyncMutex& mutex_;
+    std::coroutine_handle<> handle_;
+    LockAwaiter* next_{nullptr};
+  };
+
+  explicit AsyncMutex(ExecutorRef executor = {}) : executor_(executor) {}
+
+  AsyncMutex(const AsyncMutex&) = delete;
+  auto operator=(const AsyncMutex&) -> AsyncMutex& = delete;
+
+  /**
+   * @brief Acquire the mutex with `co_await lock()`
+   */
+  auto lock() -> LockAwaiter { return LockAwaiter(*this); }
+
+  auto try_lock() -> bool {
+    uintptr_t state = kUnlocked;
+    return state_.compare_exchange_strong(state, kLockedNoWaiters,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Release the mutex, or hand it to the oldest waiter
+   */
+  auto unlock() -> void {
+    LockAwaiter* head = waiters_;
+    if (head == nullptr) {
+      uintptr_t state = kLockedNoWaiters;
+      if (state_.compare_exchange_strong(state, kUnlocked,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+        return;
+      }
+      // Waiters arrived; take all of them, oldest first
+      state = state_.exchange(kLockedNoWaiters, std::memory_order_acquire);
+      auto waiter = reinterpret_cast<LockAwaiter*>(state);
+      while (waiter != nullptr) {
+        LockAwaiter* next = waiter->next_;
+        waiter->next_ = head;
+        head = waiter;
+        waiter = next;
+      }
+    }
+    waiters_ = head->next_;
+    // The mutex stays locked; it now belongs to the resumed coroutine
+    executor_.schedule(head->handle_);
+  }
+
+ private:
+  static constexpr uintptr_t kLockedNoWaiters = 0;
+  static constexpr uintptr_t kUnlocked = 1;
+
+  std::atomic<uintptr_t> state_{kUnlocked};
+  // Waiters in FIFO order, owned by the holder of the mutex
+  LockAwaiter* waiters_{nullptr};
+  ExecutorRef executor_;
+};
+
+#endif  // ASYNC_MUTEX_H_
@@ -0,0 +1,129 @@
+#ifndef ASYNC_QUEUE_H_
+#define ASYNC_QUEUE_H_
+
+#include <coroutine>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include "coroutine/async_semaphore.h"
+#include "coroutine/executor.h"
+#include "queue/faa_array_queue.h"
+#include "util/backoff.h"
+
+/**
+ * AsyncQueue - A bounded FIFO queue whose items and free slots coroutines
+ * wait for with `co_await`, without blocking their thread
+ *
+ * The items live in a lock-free FAAArrayQueue. Two AsyncSemaphores count the
+ * items and the free slots: `co_await async_dequeue()` first takes an item
+ * permit, suspending while there is none, and then dequeues an item, which
+ * is guaranteed to be there; `co_await async_enqueue(value)` takes a slot
+ * permit the same way. The waiting coroutines are resumed on the executor.
+ *
+ * The queue must outlive its waiters.
+ */
+template<typename T>
+class AsyncQueue {
+ public:
+  class EnqueueAwaiter {
+   public:
+    EnqueueAwaiter(AsyncQueue& queue, T value)
+        : queue_(queue), value_(std::move(value)), slot_(queue.slots_) {}
+
+    auto await_ready() -> bool { return slot_.await_ready(); }
+
+    auto await_suspend(std::coroutine_handle<> handle) -> bool {
+      return slot_.await_suspend(handle);
+    }
+
+    auto await_resume() -> void { queue_.push(std::move(value_)); }
+
+   private:
+    AsyncQueue& queue_;
+    T value_;
+    AsyncSemaphore::AcquireAwaiter slot_;
+  };
+
+  class DequeueAwaiter {
+   public:
+    explicit DequeueAwaiter(AsyncQueue& queue)
+        : queue_(queue), item_(queue.items_) {}
+
+    auto await_ready() -> bool { return item_.await_ready(); }
+
+    auto await_suspend(std::coroutine_handle<> handle) -> bool {
+      return item_.await_suspend(handle);
+    }
+
+    auto await_resume() -> T { return queue_.pop(); }
+
+   private:
+    AsyncQueue& queue_;
+    AsyncSemaphore::AcquireAwaiter item_;
+  };
+
+  explicit AsyncQueue(
+      int64_t capacity = std::numeric_limits<int64_t>::max(),
+      ExecutorRef executor = {})
+      : items_(0, executor), slots_(capacity, executor) {}
+
+  AsyncQueue(const AsyncQueue&) = delete;
+  auto operator=(const AsyncQueue&) -> AsyncQueue& = delete;
+
+  /**
+   * @brief Append `value` with `co_await async_enqueue(value)`, waiting while
+   * the queue is full
+   */
+  auto async_enqueue(T value) -> EnqueueAwaiter {
+    return EnqueueAwaiter(*this, std::move(value));
+  }
+
+  /**
+   * @brief Remove the front item with `co_await async_dequeue()`, waiting
+   * while the queue is empty
+   */
+  auto async_dequeue() -> DequeueAwaiter { return DequeueAwaiter(*this); }
+
+  auto try_enqueue(T value) -> bool {
+    if (!slots_.try_acquire()) {
+      return false;
+    }
+    push(std::move(value));
+    return true;
+  }
+
+  auto try_dequeue() -> std::optional<T> {
+    if (!items_.try_acquire()) {
+      return std::nullopt;
+    }
+    return pop();
+  }
+
+ private:
+  auto push(T value) -> void {
+    queue_.enqueue(std::move(value));
+    items_.release();
+  }
+
+  // Only called with an item permit, which is released after its item is
+  // enqueued. The loop covers a try_dequeue() that gives up on slots whose
+  // enqueuers it overtook before it reaches that item.
+  auto pop() -> T {
+    while (true) {
+      std::optional<T> value = queue_.try_dequeue();
+      if (value.has_value()) {
+        slots_.release();
+        return std::move(*value);
+      }
+      cpu_relax();
+    }
+  }
+
+  FAAArrayQueue<T> queue_;
+  AsyncSemaphore items_;
+  AsyncSemaphore slots_;
+};
+
+#endif  // ASYNC_QUEUE_H_
@@ -0,0 +1,116 @@
+#ifndef ASYNC_SEMAPHORE_H_
+#define ASYNC_SEMAPHORE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <optional>
+
+#include "coroutine/executor.h"
+#include "queue/faa_array_queue.h"
+#include "util/backoff.h"
+
+/**
+ * AsyncSemaphore - A counting semaphore whose permits coroutines wait for
+ * with `co_await semaphore.async_acquire()`, without blocking their thread
+ *
+ * The count goes negative by the number of waiters. An acquirer that takes
+ * the count to zero or below enqueues its coroutine handle into a lock-free
+ * FAAArrayQueue and suspends; release() raises the count and, for each
+ * waiter it finds, dequeues a handle and resumes it on the executor. A
+ * releaser may see a waiter before the waiter has enqueued its handle, and
+ * then spins for the few instructions in between.
+ *
+ * The semaphore must outlive its waiters.
+ */
+class AsyncSemaphore {
+ public:
+  class AcquireAwaiter {
+   public:
+    explicit AcquireAwaiter(AsyncSemaphore& semaphore)
+        : semaphore_(semaphore) {}
+
+    auto await_ready() -> bool { return semaphore_.try_acquire(); }
+
+    auto await_suspend(std::coroutine_handle<> handle) -> bool {
+      return semaphore_.acquire_or_wait(handle);
+    }
+
+    auto await_resume() const -> void {}
+
+   private:
+    AsyncSemaphore& semaphore_;
+  };
+
+  explicit AsyncSemaphore(int64_t value, ExecutorRef executor = {})
+      : value_(value), executor_(executor) {}
+
+  AsyncSemaphore(const AsyncSemaphore&) = delete;
+  auto operator=(const AsyncSemaphore&) -> AsyncSemaphore& = delete;
+
+  /**
+   * @brief Take a permit with `co_await async_acquire()`
+   */
+  auto async_acquire() -> AcquireAwaiter { return AcquireAwaiter(*this); }
+
+  auto try_acquire() -> bool {
+    int64_t value = value_.load(std::memory_order_relaxed);
+    while (value > 0) {
+      if (value_.compare_exchange_weak(value, value - 1,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Return `count` permits, resuming up to `count` waiters
+   */
+  auto release(int64_t count = 1) -> void {
+    if (count <= 0) {
+      return;
+    }
+    int64_t value = value_.fetch_add(count, std::memory_order_acq_rel);
+    for (int64_t i = std::min(count, -value); i > 0; i--) {
+      resume_one();
+    }
+  }
+
+  // The available permits, or minus the number of waiters (for testing and
+  // debugging)
+  auto get_value() const -> int64_t {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Takes a permit, or enqueues `handle` to be resumed with one; returns
+  // whether the coroutine must suspend
+  auto acquire_or_wait(std::coroutine_handle<> handle) -> bool {
+    if (value_.fetch_sub(1, std::memory_order_acq_rel) > 0) {
+      return false;
+    }
+    waiters_.enqueue(handle);
+    return true;
+  }
+
+  auto resume_one() -> void {
+    while (true) {
+      std::optional<std::coroutine_handle<>> handle = waiters_.try_dequeue();
+      if (handle.has_value()) {
+        executor_.schedule(*handle);
+        return;
+      }
+      // The waiter has taken its place in the count but not in the queue yet
+      cpu_relax();
+    }
+  }
+
+  std::atomic<int64_t> value_;
+  FAAArrayQueue<std::coroutine_handle<>> waiters_;
+  ExecutorRef executor_;
+};
+
+#endif  // ASYNC_SEMAPHORE_H_
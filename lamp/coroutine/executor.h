@@ -0,0 +1,93 @@
+#ifndef EXECUTOR_H_
+#define EXECUTOR_H_
+
+#include <concepts>
+#include <coroutine>
+#include <exception>
+#include <functional>
+
+/**
+ * TaskExecutor - Something that runs submitted tasks on its threads, such as
+ * WorkStealingPool or Executor
+ */
+template<typename E>
+concept TaskExecutor = requires(E& executor, std::function<void()> task) {
+  executor.submit(std::move(task));
+};
+
+/**
+ * ExecutorRef - A reference to a TaskExecutor, on which the coroutine
+ * primitives resume the coroutines they release
+ *
+ * A default-constructed reference resumes coroutines inline, on the thread
+ * that releases them, before the releasing call returns. That is cheapest,
+ * but the releasing thread then runs the resumed coroutine up to its next
+ * suspension, which nests if that coroutine releases a waiter in turn.
+ */
+class ExecutorRef {
+ public:
+  ExecutorRef() = default;
+
+  template<TaskExecutor E>
+  ExecutorRef(E& executor)
+      : executor_(&executor),
+        schedule_([](void* executor, std::coroutine_handle<> handle) {
+          static_cast<E*>(executor)->submit([handle]() { handle.resume(); });
+        }) {}
+
+  auto is_inline() const -> bool { return executor_ == nullptr; }
+
+  auto schedule(std::coroutine_handle<> handle) const -> void {
+    if (executor_ == nullptr) {
+      handle.resume();
+    } else {
+      schedule_(executor_, handle);
+    }
+  }
+
+ private:
+  void* executor_{nullptr};
+  void (*schedule_)(void*, std::coroutine_handle<>){nullptr};
+};
+
+/**
+ * Suspends the calling coroutine and resumes it on `executor`; an inline
+ * reference does not suspend at all
+ */
+inline auto resume_on(ExecutorRef executor) {
+  struct Awaiter {
+    ExecutorRef executor_;
+
+    auto await_ready() const -> bool { return executor_.is_inline(); }
+
+    auto await_suspend(std::coroutine_handle<> handle) const -> void {
+      executor_.schedule(handle);
+    }
+
+    auto await_resume() const -> void {}
+  };
+  return Awaiter{executor};
+}
+
+/**
+ * DetachedTask - The return type of a coroutine that starts right away and
+ * frees itself when it finishes, for fire-and-forget work
+ *
+ * Nobody awaits the coroutine, so an exception escaping it terminates the
+ * program.
+ */
+struct DetachedTask {
+  struct promise_type {
+    auto get_return_object() -> DetachedTask { return {}; }
+
+    auto initial_suspend() noexcept -> std::suspend_never { return {}; }
+
+    auto final_suspend() noexcept -> std::suspend_never { return {}; }
+
+    auto return_void() -> void {}
+
+    auto unhandled_exception() -> void { std::terminate(); }
+  };
+};
+
+#endif  // EXECUTOR_H_
@@ -0,0 +1,194 @@
+#ifndef COMBINING_TREE_H_
+#define COMBINING_TREE_H_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "synchronization/scoped_lock.h"
+#include "synchronization/ttas_lock.h"
+#include "util/cache_aligned.h"
+#include "util/thread_index.h"
+
+/**
+ * CombiningTree - A shared counter in which concurrent increments are combined
+ * on their way up a binary tree [Her08]
+ *
+ * Every pair of threads shares a leaf. A thread climbs from its leaf towards
+ * the root until it meets a node that another thread has reached first; it
+ * then hands its increments to that thread and waits, while the first thread
+ * carries the combined increments on up. Only the thread that reaches the root
+ * touches the counter itself, and on the way back down every waiting thread
+ * gets its own share of the range of values that was taken at once. Under
+ * high contention a single update of the root serves many threads; without
+ * contention an increment costs O(log width) lock acquisitions.
+ *
+ * Each node is guarded by a TTASLock, and threads wait for a node by spinning
+ * with the lock released. The counter is linearizable.
+ */
+class CombiningTree {
+  enum class Status {
+    kIdle,
+    kFirst,   // One thread is combining here
+    kSecond,  // A second thread has handed its value to the first
+    kResult,  // The first thread has left the second thread's result
+    kRoot,
+  };
+
+  struct Node {
+    TTASLock<> lock_;
+    Status status_{Status::kIdle};
+    bool locked_{false};  // Reserved by a thread that is combining through it
+    int64_t first_value_{0};
+    int64_t second_value_{0};
+    int64_t result_{0};
+    Node* parent_{nullptr};
+
+    // Spins until `locked_` is cleared; `lock_` must be held
+    auto wait_unlocked() -> void {
+      while (locked_) {
+        wait();
+      }
+    }
+
+    // Lets other threads update the node; `lock_` must be held
+    auto wait() -> void {
+      lock_.unlock();
+      std::this_thread::yield();
+      lock_.lock();
+    }
+
+    // Whether the thread should keep climbing after this node
+    auto precombine() -> bool {
+      ScopedLock<TTASLock<>> scoped_lock{lock_};
+      // A leaf shared by more than two threads may still be serving the
+      // previous pair after the second thread has unlocked it
+      while (locked_ || status_ == Status::kSecond ||
+             status_ == Status::kResult) {
+        wait();
+      }
+      switch (status_) {
+        case Status::kIdle:
+          status_ = Status::kFirst;
+          return true;
+        case Status::kFirst:
+          locked_ = true;
+          status_ = Status::kSecond;
+          return false;
+        default:  // kRoot
+          return false;
+      }
+    }
+
+    // Adds the value of the second thread, if any, to the climber's
+    auto combine(int64_t combined) -> int64_t {
+      ScopedLock<TTASLock<>> scoped_lock{lock_};
+      wait_unlocked();
+      locked_ = true;
+      first_value_ = combined;
+      if (status_ == Status::kSecond) {
+        return first_value_ + second_value_;
+      }
+      return first_value_;
+    }
+
+    // Applies `combined` at the node where the climb stopped
+    auto op(int64_t combined) -> int64_t {
+      ScopedLock<TTASLock<>> scoped_lock{lock_};
+      if (status_ == Status::kRoot) {
+        int64_t prior = result_;
+        result_ += combined;
+        return prior;
+      }
+      // kSecond: leave the value to the first thread and wait for the result
+      second_value_ = combined;
+      locked_ = false;
+      while (status_ != Status::kResult) {
+        wait();
+      }
+      locked_ = false;
+      status_ = Status::kIdle;
+      return result_;
+    }
+
+    // Hands `prior` down to the second thread, if any
+    auto distribute(int64_t prior) -> void {
+      ScopedLock<TTASLock<>> scoped_lock{lock_};
+      if (status_ == Status::kFirst) {
+        status_ = Status::kIdle;
+        locked_ = false;
+      } else {  // kSecond
+        result_ = prior + first_value_;
+        status_ = Status::kResult;
+      }
+    }
+  };
+
+ public:
+  /**
+   * @param width the number of threads expected to increment concurrently,
+   * rounded up to a power of two; more threads share leaves
+   */
+  explicit CombiningTree(
+      size_t width = std::max(2U, std::thread::hardware_concurrency()))
+      : num_nodes_(std::bit_ceil(std::max<size_t>(width, 2)) - 1),
+        nodes_(std::make_unique<CacheAligned<Node>[]>(num_nodes_)) {
+    nodes_[0]->status_ = Status::kRoot;
+    for (size_t i = 1; i < num_nodes_; i++) {
+      nodes_[i]->parent_ = &*nodes_[(i - 1) / 2];
+    }
+  }
+
+  CombiningTree(const CombiningTree&) = delete;
+  auto operator=(const CombiningTree&) -> CombiningTree& = delete;
+
+  /**
+   * Increments the counter
+   *
+   * @return the value before the increment
+   */
+  auto get_and_increment() -> int64_t {
+    // The leaves are the last (num_nodes_ + 1) / 2 nodes, two threads each
+    size_t num_leaves = (num_nodes_ + 1) / 2;
+    Node* leaf = &*nodes_[num_nodes_ - 1 - (this_thread_index() / 2) %
+                                             num_leaves];
+
+    Node* stop = leaf;
+    while (stop->precombine()) {
+      stop = stop->parent_;
+    }
+
+    std::vector<Node*> path;
+    int64_t combined = 1;
+    for (Node* node = leaf; node != stop; node = node->parent_) {
+      combined = node->combine(combined);
+      path.push_back(node);
+    }
+
+    int64_t prior = stop->op(combined);
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+      (*it)->distribute(prior);
+    }
+    return prior;
+  }
+
+  /**
+   * The current value, which does not include increments that are still
+   * being combined
+   */
+  auto get() -> int64_t {
+    ScopedLock<TTASLock<>> scoped_lock{nodes_[0]->lock_};
+    return nodes_[0]->result_;
+  }
+
+ private:
+  const size_t num_nodes_;
+  // A complete binary tree in heap order; nodes_[0] is the root
+  std::unique_ptr<CacheAligned<Node>[]> nodes_;
+};
+
+#endif  // COMBINING_TREE_H_
@@ -0,0 +1,199 @@
+#ifndef COUNTING_NETWORK_H_
+#define COUNTING_NETWORK_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "util/cache_aligned.h"
+#include "util/thread_index.h"
+
+/**
+ * Balancer - A toggle that sends tokens alternately to its top (0) and bottom
+ * (1) output wire
+ */
+class Balancer {
+ public:
+  auto traverse() -> size_t {
+    return toggle_->fetch_xor(1, std::memory_order_relaxed);
+  }
+
+ private:
+  // Threads that traverse different balancers must not share a line
+  CacheAligned<std::atomic<size_t>> toggle_{0};
+};
+
+/**
+ * Merger - The merging network of a Bitonic network. Merges two sequences of
+ * width / 2 wires with the step property into one of `width` wires.
+ */
+class Merger {
+ public:
+  explicit Merger(size_t width) : width_(width), layer_(width / 2) {
+    if (width_ > 2) {
+      half_[0] = std::make_unique<Merger>(width_ / 2);
+      half_[1] = std::make_unique<Merger>(width_ / 2);
+    }
+  }
+
+  auto traverse(size_t input) -> size_t {
+    size_t output = 0;
+    if (width_ > 2) {
+      // The even wires of the top half and the odd wires of the bottom half
+      // go to one half, the others to the other
+      size_t half = input < width_ / 2 ? input % 2 : 1 - input % 2;
+      output = half_[half]->traverse(input / 2);
+    }
+    return 2 * output + layer_[output].traverse();
+  }
+
+ private:
+  const size_t width_;
+  std::unique_ptr<Merger> half_[2];
+  std::vector<Balancer> layer_;
+};
+
+/**
+ * Bitonic - The bitonic counting network of [Asp94], of depth O(log^2 width)
+ */
+class Bitonic {
+ public:
+  explicit Bitonic(size_t width) : width_(width), merger_(width) {
+    if (width_ > 2) {
+      half_[0] = std::make_unique<Bitonic>(width_ / 2);
+      half_[1] = std::make_unique<Bitonic>(width_ / 2);
+    }
+  }
+
+  auto width() const -> size_t { return width_; }
+
+  auto traverse(size_t input) -> size_t {
+    size_t subnet = input / (width_ / 2);
+    size_t output = 0;
+    if (width_ > 2) {
+      output = half_[subnet]->traverse(input - subnet * (width_ / 2));
+    }
+    return merger_.traverse(subnet * (width_ / 2) + output);
+  }
+
+ private:
+  const size_t width_;
+  std::unique_ptr<Bitonic> half_[2];
+  Merger merger_;
+};
+
+/**
+ * Periodic - The periodic counting network of [Asp94]: log(width) identical
+ * blocks, each of depth log(width)
+ */
+class Periodic {
+  // A layer of balancers that connect wire i to wire width - 1 - i, followed
+  // by a block of width / 2 on either half
+  class Block {
+   public:
+    explicit Block(size_t width) : width_(width), layer_(width / 2) {
+      if (width_ > 2) {
+        north_ = std::make_unique<Block>(width_ / 2);
+        south_ = std::make_unique<Block>(width_ / 2);
+      }
+    }
+
+    auto traverse(size_t input) -> size_t {
+      size_t low = std::min(input, width_ - 1 - input);
+      size_t wire = layer_[low].traverse() == 0 ? low : width_ - 1 - low;
+      if (width_ == 2) {
+        return wire;
+      }
+      if (wire < width_ / 2) {
+        return north_->traverse(wire);
+      }
+      return width_ / 2 + south_->traverse(wire - width_ / 2);
+    }
+
+   private:
+    const size_t width_;
+    std::vector<Balancer> layer_;
+    std::unique_ptr<Block> north_;
+    std::unique_ptr<Block> south_;
+  };
+
+ public:
+  explicit Periodic(size_t width) : width_(width) {
+    for (int i = std::countr_zero(width_); i > 0; i--) {
+      blocks_.push_back(std::make_unique<Block>(width_));
+    }
+  }
+
+  auto width() const -> size_t { return width_; }
+
+  auto traverse(size_t input) -> size_t {
+    size_t wire = input;
+    for (auto& block : blocks_) {
+      wire = block->traverse(wire);
+    }
+    return wire;
+  }
+
+ private:
+  const size_t width_;
+  std::vector<std::unique_ptr<Block>> blocks_;
+};
+
+/**
+ * CountingNetwork - A shared counter built from a counting network of
+ * balancers, Bitonic or Periodic [Asp94]
+ *
+ * A thread enters the network on a wire chosen by its thread index, and the
+ * wire it leaves on has its own counter that hands out the values congruent to
+ * the wire modulo the width. The network spreads the tokens evenly over the
+ * output wires, so in a quiescent state the values handed out are exactly
+ * 0 .. n - 1. Threads on different paths touch different balancers, so the
+ * network has no single hot spot.
+ *
+ * The counter is quiescently consistent, not linearizable: a
+ * get_and_increment() that starts after another has returned may still
+ * return a smaller value.
+ */
+template<typename Network = Bitonic>
+class CountingNetwork {
+ public:
+  /**
+   * @param width the number of wires, rounded up to a power of two
+   */
+  explicit CountingNetwork(
+      size_t width = std::max(2U, std::thread::hardware_concurrency()))
+      : network_(std::bit_ceil(std::max<size_t>(width, 2))),
+        counters_(std::make_unique<CacheAligned<std::atomic<int64_t>>[]>(
+            network_.width())) {
+    for (size_t i = 0; i < network_.width(); i++) {
+      counters_[i]->store(static_cast<int64_t>(i), std::memory_order_relaxed);
+    }
+  }
+
+  CountingNetwork(const CountingNetwork&) = delete;
+  auto operator=(const CountingNetwork&) -> CountingNetwork& = delete;
+
+  /**
+   * Increments the counter
+   *
+   * @return the value before the increment
+   */
+  auto get_and_increment() -> int64_t {
+    size_t wire = network_.traverse(this_thread_index() % network_.width());
+    return counters_[wire]->fetch_add(
+        static_cast<int64_t>(network_.width()), std::memory_order_relaxed);
+  }
+
+  auto width() const -> size_t { return network_.width(); }
+
+ private:
+  Network network_;
+  std::unique_ptr<CacheAligned<std::atomic<int64_t>>[]> counters_;
+};
+
+#endif  // COUNTING_NETWORK_H_
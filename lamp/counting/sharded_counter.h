@@ -0,0 +1,89 @@
+#ifndef SHARDED_COUNTER_H_
+#define SHARDED_COUNTER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "util/cache_aligned.h"
+#include "util/thread_index.h"
+
+/**
+ * ShardedCounter - A counter split into per-thread shards that are only summed
+ * up when the total is read
+ *
+ * Each thread increments the shard chosen by its thread index, so threads that
+ * do not share a shard never contend for a cache line, and an increment is a
+ * single uncontended fetch-and-add. Reading the total walks all shards, so it
+ * suits counters that are updated often and read rarely, such as statistics.
+ *
+ * get_and_increment() returns unique values, but not consecutive ones: shard
+ * `i` hands out the values congruent to `i` modulo the number of shards. The
+ * total is not a snapshot; it includes some of the increments that run
+ * concurrently with it.
+ */
+class ShardedCounter {
+ public:
+  /**
+   * @param num_shards the number of shards, typically the number of threads
+   */
+  explicit ShardedCounter(
+      size_t num_shards = std::max(1U, std::thread::hardware_concurrency()))
+      : num_shards_(std::max<size_t>(num_shards, 1)),
+        shards_(std::make_unique<CacheAligned<std::atomic<int64_t>>[]>(
+            num_shards_)) {}
+
+  ShardedCounter(const ShardedCounter&) = delete;
+  auto operator=(const ShardedCounter&) -> ShardedCounter& = delete;
+
+  /**
+   * Increments the calling thread's shard, when the old value is not needed
+   */
+  auto increment() -> void {
+    shards_[shard_index()]->fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Adds `delta`, which may be negative, to the calling thread's shard, e.g.
+   * to track the size of a container
+   */
+  auto add(int64_t delta) -> void {
+    shards_[shard_index()]->fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  /**
+   * Increments the counter
+   *
+   * @return a value that no other call returns
+   */
+  auto get_and_increment() -> int64_t {
+    size_t index = shard_index();
+    int64_t count = shards_[index]->fetch_add(1, std::memory_order_relaxed);
+    return count * static_cast<int64_t>(num_shards_) +
+           static_cast<int64_t>(index);
+  }
+
+  /**
+   * The sum of all shards
+   */
+  auto get() const -> int64_t {
+    int64_t total = 0;
+    for (size_t i = 0; i < num_shards_; i++) {
+      total += shards_[i]->load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+ private:
+  auto shard_index() const -> size_t {
+    return this_thread_index() % num_shards_;
+  }
+
+  const size_t num_shards_;
+  std::unique_ptr<CacheAligned<std::atomic<int64_t>>[]> shards_;
+};
+
+#endif  // SHARDED_COUNTER_H_
@@ -0,0 +1,190 @@
+#ifndef WORK_STEALING_DEQUE_H_
+#define WORK_STEALING_DEQUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#include "memory/epoch_based_reclamation.h"
+#include "memory/operation_guard.h"
+#include "util/cache_aligned.h"
+
+/**
+ * WorkStealingDeque - A dynamic circular work-stealing deque (Chase-Lev)
+ * [Cha05], with the memory orders of [Le13]
+ *
+ * A single owner thread pushes and pops items at the bottom, and any number of
+ * thieves steal them from the top. The owner synchronizes with thieves only
+ * when the deque holds at most one item, so push() and pop() are a few plain
+ * loads and stores in the common case; thieves race for the top item with a
+ * CAS.
+ *
+ * The items live in a circular array that the owner replaces by one twice as
+ * large when it is full. Thieves may still be reading the old array, so it is
+ * handed to the `Reclaimer` and freed once no steal can reach it. The array
+ * never shrinks.
+ *
+ * `T` must be trivially copyable (typically a pointer to a task), because a
+ * thief may read a slot while the owner overwrites it; the thief then loses
+ * the CAS and discards what it read.
+ */
+template<typename T, typename Reclaimer = EpochBasedReclamation>
+class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "WorkStealingDeque copies items racily, so they must be "
+                "trivially copyable");
+  static_assert(!Reclaimer::kRequiresReservation,
+                "WorkStealingDeque reads the array without reserving it, so "
+                "it needs a reclaimer that protects whole operations");
+
+  struct Array {
+    const size_t mask_;
+    std::unique_ptr<std::atomic<T>[]> slots_;
+
+    explicit Array(size_t capacity)
+        : mask_(capacity - 1),
+          slots_(std::make_unique<std::atomic<T>[]>(capacity)) {}
+
+    auto capacity() const -> size_t { return mask_ + 1; }
+
+    auto get(int64_t index) const -> T {
+      return slots_[static_cast<size_t>(index) & mask_].load(
+          std::memory_order_relaxed);
+    }
+
+    auto put(int64_t index, T value) -> void {
+      slots_[static_cast<size_t>(index) & mask_].store(
+          value, std::memory_order_relaxed);
+    }
+  };
+
+ public:
+  static constexpr size_t kDefaultCapacity = 64;
+
+  /**
+   * @param capacity the initial capacity, rounded up to a power of two
+   */
+  explicit WorkStealingDeque(size_t capacity = kDefaultCapacity)
+      : array_(new Array(std::bit_ceil(std::max<size_t>(capacity, 2)))) {}
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  auto operator=(const WorkStealingDeque&) -> WorkStealingDeque& = delete;
+
+  ~WorkStealingDeque() { delete array_.load(std::memory_order_relaxed); }
+
+  /**
+   * Pushes an item at the bottom. Must only be called by the owner.
+   */
+  auto push(T value) -> void {
+    int64_t bottom = bottom_->load(std::memory_order_relaxed);
+    int64_t top = top_->load(std::memory_order_acquire);
+    Array* array = array_.load(std::memory_order_relaxed);
+    if (bottom - top > static_cast<int64_t>(array->capacity()) - 1) {
+      array = grow(array, top, bottom);
+    }
+    array->put(bottom, value);
+    // Publishes the item (and a grown array) to thieves that read the bottom
+    bottom_->store(bottom + 1, std::memory_order_release);
+  }
+
+  /**
+   * Pops the item at the bottom, i.e., the one pushed last. Must only be
+   * called by the owner.
+   *
+   * @return the item, or std::nullopt if the deque was empty
+   */
+  auto pop() -> std::optional<T> {
+    int64_t bottom = bottom_->load(std::memory_order_relaxed) - 1;
+    Array* array = array_.load(std::memory_order_relaxed);
+    bottom_->store(bottom, std::memory_order_relaxed);
+    // Claims the bottom item before reading the top; pairs with the fence in
+    // steal()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_->load(std::memory_order_relaxed);
+
+    std::optional<T> value;
+    if (top <= bottom) {
+      value = array->get(bottom);
+      if (top == bottom) {
+        // The last item: race the thieves for it
+        if (!top_->compare_exchange_strong(top, top + 1,
+                                           std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+          value = std::nullopt;
+        }
+        bottom_->store(bottom + 1, std::memory_order_relaxed);
+      }
+    } else {
+      bottom_->store(bottom + 1, std::memory_order_relaxed);
+    }
+    return value;
+  }
+
+  /**
+   * Steals the item at the top, i.e., the oldest one. May be called by any
+   * thread.
+   *
+   * @return the item, or std::nullopt if the deque was empty or another
+   * thread took the item first
+   */
+  auto steal() -> std::optional<T> {
+    OperationGuard guard(reclaimer_);
+    int64_t top = top_->load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = bottom_->load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return std::nullopt;
+    }
+    Array* array = array_.load(std::memory_order_acquire);
+    T value = array->get(top);
+    if (!top_->compare_exchange_strong(top, top + 1,
+                                       std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+      return std::nullopt;
+    }
+    return value;
+  }
+
+  /**
+   * The number of items, which may be stale by the time it is returned
+   */
+  auto size() const -> size_t {
+    int64_t bottom = bottom_->load(std::memory_order_relaxed);
+    int64_t top = top_->load(std::memory_order_relaxed);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+  }
+
+  auto empty() const -> bool { return size() == 0; }
+
+  /**
+   * The capacity of the current array
+   */
+  auto capacity() const -> size_t {
+    return array_.load(std::memory_order_relaxed)->capacity();
+  }
+
+ private:
+  // Copies the items in [top, bottom) into an array twice as large
+  auto grow(Array* array, int64_t top, int64_t bottom) -> Array* {
+    auto bigger = new Array(array->capacity() * 2);
+    for (int64_t i = top; i < bottom; i++) {
+      bigger->put(i, array->get(i));
+    }
+    array_.store(bigger, std::memory_order_release);
+    reclaimer_.sched_for_reclaim(array);
+    return bigger;
+  }
+
+  // Thieves update the top, and the owner mostly the bottom
+  CacheAligned<std::atomic<int64_t>> top_{0};
+  CacheAligned<std::atomic<int64_t>> bottom_{0};
+  std::atomic<Array*> array_;
+  Reclaimer reclaimer_;  // Frees the arrays replaced by grow()
+};
+
+#endif  // WORK_STEALING_DEQUE_H_
@@ -0,0 +1,452 @@
+#ifndef LOCK_FREE_HASH_MAP_H_
+#define LOCK_FREE_HASH_MAP_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+#include "memory/epoch_based_reclamation.h"
+#include "memory/operation_guard.h"
+#include "util/backoff.h"
+#include "util/cache_aligned.h"
+
+/**
+ * LockFreeHashMap - A lock-free hash map with open addressing and cooperative
+ * incremental resizing, in the style of Click's non-blocking hash table
+ *
+ * The table is an array of slots, each a key word and a value word, searched
+ * by linear probing. A key is inserted by a CAS on the first empty key word of
+ * its probe sequence and then stays in that slot for the lifetime of the
+ * table; values are installed, replaced and erased by CAS on the value word,
+ * and an erased value leaves a tombstone. Lookups take no locks and write no
+ * shared memory, and there is no per-key allocation.
+ *
+ * When a table becomes half full of keys, or an insert has to probe more than
+ * `kMaxProbes` slots to claim one, the thread that notices allocates a table
+ * sized for four times the live entries and links it as the old table's
+ * successor. The old table is then migrated chunk by chunk: threads claim a
+ * chunk with a fetch-and-add and copy its live entries, so every writer that
+ * meets the migration helps with one chunk and the thread that started it
+ * copies all the chunks nobody has claimed. A slot is copied by writing its
+ * value into the new table and then sealing the old slot with a CAS to a
+ * "moved" marker; if the value changed in between, the copy is redone. A
+ * key is always claimed in the oldest table, even in a slot that is already
+ * sealed, and an operation that meets a sealed slot continues in the new
+ * table, so a key is always found in exactly one place. Lookups probe until
+ * they reach an empty key word, so a long probe sequence slows a table down
+ * but never hides a key. Once every chunk is copied, the new table becomes
+ * the root and the old one is freed by the `Reclaimer`. A table can only start
+ * migrating once its predecessor has finished, so a writer that fills the new
+ * table while chunks of the old one are still being copied waits for them.
+ *
+ * Keys and values are stored as 64-bit words, so `K` and `V` must be
+ * trivially copyable and at most 8 bytes, e.g. integers or pointers. Three
+ * words are reserved: the key whose bits are all ones, and the values whose
+ * bits are all ones or all ones but the lowest. Types narrower than 8 bytes
+ * are zero-extended and never collide with them; for 8-byte types these are,
+ * e.g., -1 and -2 for int64_t.
+ */
+template<typename K, typename V, typename Hash = std::hash<K>,
+         typename Reclaimer = EpochBasedReclamation>
+class LockFreeHashMap {
+  static_assert(std::is_trivially_copyable_v<K> && sizeof(K) <= 8 &&
+                    std::is_trivially_copyable_v<V> && sizeof(V) <= 8,
+                "LockFreeHashMap stores keys and values as 64-bit words");
+  static_assert(!Reclaimer::kRequiresReservation,
+                "LockFreeHashMap reads tables without reserving them, so it "
+                "needs a reclaimer that protects whole operations");
+
+  static constexpr uint64_t kEmptyKey = ~uint64_t{0};
+  static constexpr uint64_t kAbsent = ~uint64_t{0};     // No value, or erased
+  static constexpr uint64_t kMoved = ~uint64_t{0} - 1;  // Copied to next table
+
+  static constexpr size_t kMinCapacity = 16;
+  static constexpr size_t kChunkSize = 1024;
+  static constexpr size_t kMaxProbes = 64;
+
+  struct Slot {
+    std::atomic<uint64_t> key_{kEmptyKey};
+    std::atomic<uint64_t> value_{kAbsent};
+  };
+
+  struct Table {
+    explicit Table(size_t capacity)
+        : mask_(capacity - 1), slots_(new Slot[capacity]) {}
+
+    auto capacity() const -> size_t { return mask_ + 1; }
+
+    auto num_chunks() const -> size_t {
+      return (capacity() + kChunkSize - 1) / kChunkSize;
+    }
+
+    const size_t mask_;
+    const std::unique_ptr<Slot[]> slots_;
+    // Keys claimed, including erased ones, which still occupy their slots
+    CacheAligned<std::atomic<size_t>> claimed_{0};
+    // Set when claims probe too far, e.g. because of a poor hash
+    std::atomic<bool> crowded_{false};
+    std::atomic<Table*> next_{nullptr};
+    std::atomic<size_t> next_chunk_{0};  // The next chunk to migrate
+    std::atomic<size_t> chunks_done_{0};
+  };
+
+ public:
+  LockFreeHashMap() : LockFreeHashMap(kMinCapacity) {}
+
+  /**
+   * Creates a map with room for about `capacity / 2` keys before it resizes
+   */
+  explicit LockFreeHashMap(size_t capacity)
+      : root_(new Table(std::bit_ceil(std::max(capacity, kMinCapacity)))) {}
+
+  LockFreeHashMap(const LockFreeHashMap&) = delete;
+  auto operator=(const LockFreeHashMap&) -> LockFreeHashMap& = delete;
+
+  /**
+   * Destructor - Frees the current table. Tables replaced by a resize are
+   * owned by the reclaimer and freed by its destructor.
+   *
+   * NOT thread-safe - caller must ensure no other threads are accessing the
+   * map
+   */
+  ~LockFreeHashMap() {
+    Table* table = root_.load(std::memory_order_relaxed);
+    while (table != nullptr) {
+      Table* next = table->next_.load(std::memory_order_relaxed);
+      delete table;
+      table = next;
+    }
+  }
+
+  /**
+   * Maps `key` to `value`, inserting the key if needed
+   *
+   * @return true if the key was inserted, false if an existing value was
+   * replaced
+   */
+  auto insert_or_assign(const K& key, const V& value) -> bool {
+    uint64_t word = value_word(value);
+    return update(key, true, [word](uint64_t) { return word; }) == kAbsent;
+  }
+
+  /**
+   * Maps `key` to `value` unless the key is already in the map
+   *
+   * @return true if the key was inserted, false if it was already present
+   */
+  auto insert(const K& key, const V& value) -> bool {
+    uint64_t word = value_word(value);
+    return update(key, true, [word](uint64_t old) {
+             return old == kAbsent ? word : old;
+           }) == kAbsent;
+  }
+
+  /**
+   * Looks up the value of a key
+   *
+   * Lock-free, and wait-free unless the map is being resized
+   *
+   * @return a copy of the value, or std::nullopt if the key is not in the map
+   */
+  auto find(const K& key) -> std::optional<V> {
+    uint64_t key_word = to_word(key);
+    assert(key_word != kEmptyKey && "the key with all bits set is reserved");
+    size_t hash = hash_of(key);
+    OperationGuard guard(reclaimer_);
+    Table* table = root_.load(std::memory_order_acquire);
+    while (table != nullptr) {
+      bool forward;
+      Slot* slot = find_slot(table, key_word, hash, false, forward);
+      if (slot != nullptr) {
+        uint64_t value = slot->value_.load(std::memory_order_acquire);
+        if (value == kAbsent) {
+          return std::nullopt;
+        }
+        if (value != kMoved) {
+          return from_word<V>(value);
+        }
+      } else if (!forward) {
+        return std::nullopt;
+      }
+      table = table->next_.load(std::memory_order_acquire);
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * Checks if a key is in the map
+   */
+  auto contains(const K& key) -> bool { return find(key).has_value(); }
+
+  /**
+   * Removes a key and its value from the map. The key's slot stays claimed
+   * until the next resize.
+   *
+   * @return true if the key was found and removed, false otherwise
+   */
+  auto erase(const K& key) -> bool {
+    return update(key, false, [](uint64_t) { return kAbsent; }) != kAbsent;
+  }
+
+  /**
+   * The number of slots of the current table
+   */
+  auto capacity() const -> size_t {
+    return root_.load(std::memory_order_acquire)->capacity();
+  }
+
+ private:
+  template<typename T>
+  static auto to_word(const T& item) -> uint64_t {
+    uint64_t word = 0;
+    std::memcpy(&word, &item, sizeof(T));
+    return word;
+  }
+
+  template<typename T>
+  static auto from_word(uint64_t word) -> T {
+    T item;
+    std::memcpy(&item, &word, sizeof(T));
+    return item;
+  }
+
+  static auto value_word(const V& value) -> uint64_t {
+    uint64_t word = to_word(value);
+    assert(word < kMoved && "the two values with the most bits set are "
+                            "reserved");
+    return word;
+  }
+
+  // Scrambles the user's hash, since linear probing degrades badly with a
+  // hash such as std::hash<int>, which is the identity (MurmurHash3's fmix64)
+  auto hash_of(const K& key) const -> size_t {
+    uint64_t hash = hash_(key);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  /**
+   * Finds the slot of `key` in `table`, or claims the first empty slot of its
+   * probe sequence for it if `claim` is set
+   *
+   * A key's slot is claimed even if it was sealed in the meantime, so that
+   * there is only ever one slot per key in a table, and operations on the key
+   * go through it until it is sealed. Returns nullptr if the key has no slot
+   * and none was claimed; `forward` is then set if the key may be in the next
+   * table, because its empty slot is sealed or because the table has no empty
+   * slot left. A claim that probes more than kMaxProbes slots marks a table
+   * that is not sparse as crowded, which triggers a resize.
+   */
+  auto find_slot(Table* table, uint64_t key, size_t hash, bool claim,
+                 bool& forward) -> Slot* {
+    forward = false;
+    for (size_t i = 0; i < table->capacity(); i++) {
+      Slot& slot = table->slots_[(hash + i) & table->mask_];
+      uint64_t slot_key = slot.key_.load(std::memory_order_acquire);
+      if (slot_key == kEmptyKey) {
+        if (!claim) {
+          forward = slot.value_.load(std::memory_order_acquire) == kMoved;
+          return nullptr;
+        }
+        if (slot.key_.compare_exchange_strong(slot_key, key,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+          size_t claimed =
+              table->claimed_->fetch_add(1, std::memory_order_relaxed);
+          if (i >= kMaxProbes && claimed >= table->capacity() / 8) {
+            table->crowded_.store(true, std::memory_order_relaxed);
+          }
+          return &slot;
+        }
+        // Another key took the slot; `slot_key` is that key
+      }
+      if (slot_key == key) {
+        return &slot;
+      }
+    }
+    forward = true;
+    return nullptr;
+  }
+
+  /**
+   * Replaces the value `old` of `key` with `next_value(old)`, where `old` is
+   * kAbsent if the key has no value, and returns `old`. Claims a slot for the
+   * key if `claim` is set.
+   */
+  template<typename NextValue>
+  auto update(const K& key, bool claim, NextValue next_value) -> uint64_t {
+    uint64_t key_word = to_word(key);
+    assert(key_word != kEmptyKey && "the key with all bits set is reserved");
+    size_t hash = hash_of(key);
+    OperationGuard guard(reclaimer_);
+    Table* table = root_.load(std::memory_order_acquire);
+    while (true) {
+      bool forward;
+      Slot* slot = find_slot(table, key_word, hash, claim, forward);
+      if (slot == nullptr && !forward) {
+        return kAbsent;
+      }
+      if (slot != nullptr) {
+        if (claim && is_full(table)) {
+          start_migration(table);
+        }
+        uint64_t old = slot->value_.load(std::memory_order_acquire);
+        while (old != kMoved) {
+          uint64_t desired = next_value(old);
+          if (desired == old) {
+            return old;
+          }
+          if (slot->value_.compare_exchange_weak(old, desired,
+                                                 std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+            return old;
+          }
+        }
+      }
+      table = next_table(table, claim);
+      if (table == nullptr) {
+        return kAbsent;
+      }
+    }
+  }
+
+  // Whether `table` is due to be replaced and is not being replaced already
+  static auto is_full(const Table* table) -> bool {
+    return (table->claimed_->load(std::memory_order_relaxed) >=
+                table->capacity() / 2 ||
+            table->crowded_.load(std::memory_order_relaxed)) &&
+           table->next_.load(std::memory_order_relaxed) == nullptr;
+  }
+
+  /**
+   * The successor of `table`, after helping to migrate `table` to it. Starts a
+   * migration if there is no successor and `grow` is set, or returns nullptr.
+   */
+  auto next_table(Table* table, bool grow) -> Table* {
+    Table* next = table->next_.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return grow ? start_migration(table) : nullptr;
+    }
+    help_migrate(table, false);
+    return next;
+  }
+
+  // Allocates the successor of the full `table` and copies it over, helped by
+  // the other writers
+  auto start_migration(Table* table) -> Table* {
+    // A table migrates only once its predecessors have finished migrating.
+    // Other threads may also have migrated `table` itself since the caller
+    // found it full, and moved the root past it. The root only leaves a table
+    // that has a successor, so reading the root before `table->next_` ensures
+    // that a root other than `table` is one of its predecessors.
+    Table* root = root_.load(std::memory_order_acquire);
+    Table* next = table->next_.load(std::memory_order_acquire);
+    while (root != table && next == nullptr) {
+      help_migrate(root, true);
+      while (root_.load(std::memory_order_acquire) == root) {
+        cpu_relax();  // a chunk is still being copied by another thread
+      }
+      root = root_.load(std::memory_order_acquire);
+      next = table->next_.load(std::memory_order_acquire);
+    }
+
+    if (next == nullptr) {
+      // Room for four times the live entries, and at least twice what the
+      // old table may still hand over if its free slots are claimed during
+      // the migration, so that copies never run out of slots
+      size_t live = 0;
+      size_t free = 0;
+      for (size_t i = 0; i < table->capacity(); i++) {
+        Slot& slot = table->slots_[i];
+        uint64_t value = slot.value_.load(std::memory_order_relaxed);
+        live += value != kAbsent && value != kMoved;
+        free += slot.key_.load(std::memory_order_relaxed) == kEmptyKey;
+      }
+      size_t capacity = std::max({live * 4, (live + free) * 2, kMinCapacity});
+      auto* new_table = new Table(std::bit_ceil(capacity));
+      if (table->next_.compare_exchange_strong(next, new_table,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+        next = new_table;
+      } else {
+        delete new_table;
+      }
+    }
+    help_migrate(table, true);
+    return next;
+  }
+
+  // Copies chunks of `table` to its successor: one chunk, or every chunk that
+  // no thread has claimed yet if `all` is set
+  auto help_migrate(Table* table, bool all) -> void {
+    Table* next = table->next_.load(std::memory_order_acquire);
+    size_t num_chunks = table->num_chunks();
+    do {
+      size_t chunk = table->next_chunk_.fetch_add(1, std::memory_order_relaxed);
+      if (chunk >= num_chunks) {
+        return;
+      }
+      size_t end = std::min((chunk + 1) * kChunkSize, table->capacity());
+      for (size_t i = chunk * kChunkSize; i < end; i++) {
+        migrate_slot(table->slots_[i], next);
+      }
+      if (table->chunks_done_.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+          num_chunks) {
+        // Every slot is sealed, so no operation needs `table` any more
+        root_.store(next, std::memory_order_release);
+        reclaimer_.sched_for_reclaim(table);
+        return;
+      }
+    } while (all);
+  }
+
+  /**
+   * Copies the value of `slot` into `next` and seals the slot. Only the thread
+   * that claimed the slot's chunk seals it, and until it does, operations on
+   * the slot's key stay in the old table, so the copy in `next` is only
+   * written here and may be redone if the value changes.
+   */
+  auto migrate_slot(Slot& slot, Table* next) -> void {
+    Slot* copy = nullptr;
+    uint64_t copied = kAbsent;
+    uint64_t value = slot.value_.load(std::memory_order_acquire);
+    while (true) {
+      if (value != copied) {
+        if (copy == nullptr) {
+          // A value is only installed after its key was claimed
+          uint64_t key = slot.key_.load(std::memory_order_relaxed);
+          bool forward;
+          copy = find_slot(next, key, hash_of(from_word<K>(key)), true,
+                           forward);
+          assert(copy != nullptr && "the table being migrated to is full");
+        }
+        copy->value_.store(value, std::memory_order_relaxed);
+        copied = value;
+      }
+      // Publishes the copy to operations that find the slot sealed
+      if (slot.value_.compare_exchange_weak(value, kMoved,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+        return;
+      }
+    }
+  }
+
+  std::atomic<Table*> root_;  // The oldest table still in use
+  [[no_unique_address]] Hash hash_;
+  Reclaimer reclaimer_;
+};
+
+#endif  // LOCK_FREE_HASH_MAP_H_
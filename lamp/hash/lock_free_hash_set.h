@@ -0,0 +1,230 @@
+#ifndef LOCK_FREE_HASH_SET_H_
+#define LOCK_FREE_HASH_SET_H_
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <limits>
+
+#include "list/lock_free_list.h"
+#include "memory/epoch_based_reclamation.h"
+
+/**
+ * LockFreeHashSet - A lock-free, resizable hash set based on split-ordered
+ * lists [Sha06]
+ *
+ * All items live in a single LockFreeList, sorted by the bit-reversal of their
+ * hash. Each bucket is a sentinel node inside that list that marks where the
+ * items of the bucket begin, so an operation jumps to its bucket's sentinel
+ * and then only traverses the few items of its bucket. Doubling the number of
+ * buckets never moves items: bucket `b + size` splits bucket `b`, and its
+ * sentinel is inserted lazily, in the middle of bucket `b`, the first time it
+ * is used.
+ *
+ * The bucket directory is a table of segments of geometrically growing size,
+ * allocated on demand, so it grows without copying and without a capacity
+ * limit chosen up front.
+ *
+ * As with the lists, two items with the same hash are considered equal. The
+ * most significant bit of the hash is used to tell items from sentinels, so
+ * it is ignored.
+ */
+template<typename T, typename Hash = std::hash<T>,
+         typename Reclaimer = EpochBasedReclamation>
+class LockFreeHashSet {
+  using List = LockFreeList<T, Hash, Reclaimer>;
+  using Node = typename List::Node;
+  using Key = typename List::Key;
+  using Bucket = std::atomic<Node*>;
+
+ public:
+  LockFreeHashSet() {
+    // Bucket 0 starts at the head of the list, whose key is the split-order
+    // key of the sentinel of bucket 0
+    bucket_slot(0).store(list_.head_, std::memory_order_relaxed);
+  }
+
+  LockFreeHashSet(const LockFreeHashSet&) = delete;
+  auto operator=(const LockFreeHashSet&) -> LockFreeHashSet& = delete;
+
+  /**
+   * Destructor - Frees the bucket directory. The nodes, including the bucket
+   * sentinels, are freed by the underlying list.
+   */
+  ~LockFreeHashSet() {
+    for (auto& segment : segments_) {
+      delete[] segment.load(std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Adds an item to the set if it's not already present
+   *
+   * @param item The item to add
+   * @return true if the item was added, false if it already exists
+   */
+  auto add(const T& item) -> bool {
+    size_t hash = hash_fn_(item);
+    Node* sentinel = get_bucket_sentinel(hash);
+    if (!list_.add_from(sentinel, Key{make_regular_key(hash), &item}, item)) {
+      return false;
+    }
+
+    // Double the number of buckets once the average bucket holds more than
+    // kMaxLoadFactor items
+    size_t size = size_.fetch_add(1, std::memory_order_relaxed) + 1;
+    size_t bucket_count = bucket_count_.load(std::memory_order_relaxed);
+    if (size / bucket_count > kMaxLoadFactor && bucket_count < kMaxBuckets) {
+      bucket_count_.compare_exchange_strong(bucket_count, 2 * bucket_count,
+                                            std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  /**
+   * Removes an item from the set
+   *
+   * @param item The item to remove
+   * @return true if the item was found and removed, false otherwise
+   */
+  auto remove(const T& item) -> bool {
+    size_t hash = hash_fn_(item);
+    Node* sentinel = get_bucket_sentinel(hash);
+    if (!list_.remove_from(sentinel, Key{make_regular_key(hash), &item})) {
+      return false;
+    }
+    size_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * Checks if an item exists in the set
+   *
+   * @param item The item to check for
+   * @return true if the item exists
+   */
+  auto contains(const T& item) -> bool {
+    size_t hash = hash_fn_(item);
+    Node* sentinel = get_bucket_sentinel(hash);
+    return list_.contains_from(sentinel, Key{make_regular_key(hash), &item});
+  }
+
+  /**
+   * The number of items in the set; only exact when there are no concurrent
+   * updates
+   */
+  auto size() const -> size_t { return size_.load(std::memory_order_relaxed); }
+
+  /**
+   * The current number of buckets (for testing and debugging)
+   */
+  auto bucket_count() const -> size_t {
+    return bucket_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr size_t kWordBits = std::numeric_limits<size_t>::digits;
+  static constexpr size_t kRegularBit = size_t{1} << (kWordBits - 1);
+  // Segment 0 holds buckets [0, 2) and segment s > 0 holds [2^s, 2^(s+1)).
+  static constexpr size_t kNumSegments = kWordBits - 1;
+  static constexpr size_t kMaxBuckets = kRegularBit;
+  static constexpr size_t kInitialBuckets = 2;
+  static constexpr size_t kMaxLoadFactor = 2;
+
+  /**
+   * Reverses the bits of a word, so that the items of a bucket, whose hashes
+   * share their low-order bits, are contiguous in the list
+   */
+  static auto reverse_bits(size_t value) -> size_t {
+    // Swap the two halves, then the halves of each half, and so on
+    size_t mask = ~size_t{0};
+    for (size_t shift = kWordBits / 2; shift > 0; shift /= 2) {
+      mask ^= mask << shift;
+      value = ((value >> shift) & mask) | ((value << shift) & ~mask);
+    }
+    return value;
+  }
+
+  // Regular keys have their least significant bit set, so that every item
+  // sorts after the sentinel of its bucket, whose key has it cleared.
+  static auto make_regular_key(size_t hash) -> size_t {
+    return reverse_bits(hash | kRegularBit);
+  }
+
+  static auto make_sentinel_key(size_t bucket) -> size_t {
+    return reverse_bits(bucket & ~kRegularBit);
+  }
+
+  /**
+   * Returns the sentinel of the bucket `hash` belongs to, initializing the
+   * bucket if this is its first use
+   */
+  auto get_bucket_sentinel(size_t hash) -> Node* {
+    size_t bucket = hash & (bucket_count_.load(std::memory_order_relaxed) - 1);
+    Node* sentinel = bucket_slot(bucket).load(std::memory_order_acquire);
+    if (sentinel == nullptr) [[unlikely]] {
+      sentinel = initialize_bucket(bucket);
+    }
+    return sentinel;
+  }
+
+  /**
+   * Inserts the sentinel of a bucket, starting from its parent bucket (the
+   * bucket it splits from). The parent is initialized first if needed.
+   */
+  auto initialize_bucket(size_t bucket) -> Node* {
+    // The parent is the bucket index with the most significant set bit
+    // cleared
+    size_t parent = bucket & ~(std::bit_floor(bucket));
+    Node* parent_sentinel = bucket_slot(parent).load(std::memory_order_acquire);
+    if (parent_sentinel == nullptr) {
+      parent_sentinel = initialize_bucket(parent);
+    }
+
+    // Every thread that races to initialize the bucket gets the same sentinel
+    // back, so publishing it needs no synchronization beyond the store
+    Node* sentinel =
+        list_.add_sentinel(parent_sentinel, make_sentinel_key(bucket));
+    bucket_slot(bucket).store(sentinel, std::memory_order_release);
+    return sentinel;
+  }
+
+  /**
+   * Returns the directory slot of a bucket, allocating its segment on first
+   * use
+   */
+  auto bucket_slot(size_t bucket) -> Bucket& {
+    size_t segment_index =
+        bucket < kInitialBuckets ? 0 : std::bit_width(bucket) - 1;
+    size_t segment_size =
+        segment_index == 0 ? kInitialBuckets : size_t{1} << segment_index;
+    size_t offset = segment_index == 0 ? bucket : bucket - segment_size;
+
+    Bucket* segment = segments_[segment_index].load(std::memory_order_acquire);
+    if (segment == nullptr) [[unlikely]] {
+      auto new_segment = new Bucket[segment_size];
+      for (size_t i = 0; i < segment_size; i++) {
+        new_segment[i].store(nullptr, std::memory_order_relaxed);
+      }
+      if (segments_[segment_index].compare_exchange_strong(
+              segment, new_segment, std::memory_order_acq_rel,
+              std::memory_order_acquire)) {
+        segment = new_segment;
+      } else {
+        // Another thread installed the segment first
+        delete[] new_segment;
+      }
+    }
+    return segment[offset];
+  }
+
+  List list_;
+  Hash hash_fn_{};
+  std::array<std::atomic<Bucket*>, kNumSegments> segments_{};
+  std::atomic<size_t> bucket_count_{kInitialBuckets};
+  std::atomic<size_t> size_{0};
+};
+
+#endif  // LOCK_FREE_HASH_SET_H_
@@ -0,0 +1,207 @@
+#ifndef REFINABLE_HASH_SET_H_
+#define REFINABLE_HASH_SET_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "synchronization/lock.h"
+#include "synchronization/ttas_lock.h"
+
+/**
+ * RefinableHashSet - A closed-addressing hash set whose array of locks grows
+ * together with the table
+ *
+ * Like StripedHashSet, but every time the table doubles the lock array is
+ * replaced by one with a lock per bucket, so the lock granularity keeps up
+ * with the number of items. A resizing thread sets a flag that stops new
+ * operations, then waits for the operations in progress to finish by
+ * acquiring and releasing each lock in turn; it never holds two locks at
+ * once, so any `Lock` with `lock()` and `unlock()` can be used.
+ *
+ * Threads that read the lock array just before it was replaced may still lock
+ * one of its locks, so previous arrays are kept until the set is destroyed.
+ * Since the array doubles every time, they take less space than the current
+ * one.
+ *
+ * Items are compared with `operator==`.
+ */
+template<typename T, BasicLockable Lock = TTASLock<>,
+         typename Hash = std::hash<T>>
+class RefinableHashSet {
+  struct LockArray {
+    explicit LockArray(size_t size) : locks_(size) {}
+
+    std::vector<Lock> locks_;
+  };
+
+ public:
+  /**
+   * @param capacity the initial number of buckets and locks
+   */
+  explicit RefinableHashSet(size_t capacity = kDefaultCapacity)
+      : table_(std::max<size_t>(capacity, 1)) {
+    lock_arrays_.push_back(std::make_unique<LockArray>(table_.size()));
+    locks_.store(lock_arrays_.back().get(), std::memory_order_release);
+  }
+
+  RefinableHashSet(const RefinableHashSet&) = delete;
+  auto operator=(const RefinableHashSet&) -> RefinableHashSet& = delete;
+
+  /**
+   * Adds an item to the set if it's not already present
+   *
+   * @param item The item to add
+   * @return true if the item was added, false if it already exists
+   */
+  auto add(const T& item) -> bool {
+    size_t hash = hash_fn_(item);
+    Lock& lock = acquire(hash);
+    size_t capacity = table_.size();
+    auto& bucket = table_[hash % capacity];
+    if (std::find(bucket.begin(), bucket.end(), item) != bucket.end()) {
+      lock.unlock();
+      return false;
+    }
+    bucket.push_back(item);
+    lock.unlock();
+
+    if (size_.fetch_add(1, std::memory_order_relaxed) + 1 >
+        kMaxLoadFactor * capacity) {
+      resize(capacity);
+    }
+    return true;
+  }
+
+  /**
+   * Removes an item from the set
+   *
+   * @param item The item to remove
+   * @return true if the item was found and removed, false otherwise
+   */
+  auto remove(const T& item) -> bool {
+    size_t hash = hash_fn_(item);
+    Lock& lock = acquire(hash);
+    auto& bucket = table_[hash % table_.size()];
+    auto it = std::find(bucket.begin(), bucket.end(), item);
+    bool found = it != bucket.end();
+    if (found) {
+      // Order within a bucket does not matter
+      std::iter_swap(it, bucket.end() - 1);
+      bucket.pop_back();
+      size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    lock.unlock();
+    return found;
+  }
+
+  /**
+   * Checks if an item exists in the set
+   *
+   * @param item The item to check for
+   * @return true if the item exists
+   */
+  auto contains(const T& item) -> bool {
+    size_t hash = hash_fn_(item);
+    Lock& lock = acquire(hash);
+    const auto& bucket = table_[hash % table_.size()];
+    bool found = std::find(bucket.begin(), bucket.end(), item) != bucket.end();
+    lock.unlock();
+    return found;
+  }
+
+  /**
+   * The number of items in the set; only exact when there are no concurrent
+   * updates
+   */
+  auto size() const -> size_t { return size_.load(std::memory_order_relaxed); }
+
+  /**
+   * The current number of buckets (and locks); only exact when there are no
+   * concurrent updates
+   */
+  auto capacity() -> size_t {
+    Lock& lock = acquire(0);
+    size_t capacity = table_.size();
+    lock.unlock();
+    return capacity;
+  }
+
+ private:
+  static constexpr size_t kDefaultCapacity = 16;
+  static constexpr size_t kMaxLoadFactor = 4;
+
+  /**
+   * Acquires the lock guarding the bucket of `hash`
+   *
+   * @return The acquired lock, which stays valid until the set is destroyed
+   */
+  auto acquire(size_t hash) -> Lock& {
+    while (true) {
+      while (resizing_.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+
+      LockArray* locks = locks_.load(std::memory_order_acquire);
+      Lock& lock = locks->locks_[hash % locks->locks_.size()];
+      lock.lock();
+      // Either this check observes a resize that started before it, or the
+      // resizer waits on this lock before touching the table
+      if (!resizing_.load(std::memory_order_seq_cst) &&
+          locks == locks_.load(std::memory_order_acquire)) {
+        return lock;
+      }
+      lock.unlock();
+    }
+  }
+
+  /**
+   * Doubles the number of buckets and locks, unless another thread is
+   * resizing or already resized the table since the caller observed
+   * `old_capacity`
+   */
+  auto resize(size_t old_capacity) -> void {
+    bool expected = false;
+    if (!resizing_.compare_exchange_strong(expected, true,
+                                           std::memory_order_seq_cst)) {
+      return;
+    }
+
+    if (table_.size() == old_capacity) {
+      // Wait for the operations that acquired a lock before the flag was set
+      for (auto& lock : locks_.load(std::memory_order_relaxed)->locks_) {
+        lock.lock();
+        lock.unlock();
+      }
+
+      std::vector<std::vector<T>> new_table(2 * old_capacity);
+      for (auto& bucket : table_) {
+        for (auto& item : bucket) {
+          new_table[hash_fn_(item) % new_table.size()].push_back(
+              std::move(item));
+        }
+      }
+      table_.swap(new_table);
+
+      lock_arrays_.push_back(std::make_unique<LockArray>(table_.size()));
+      locks_.store(lock_arrays_.back().get(), std::memory_order_release);
+    }
+
+    resizing_.store(false, std::memory_order_release);
+  }
+
+  std::vector<std::vector<T>> table_;
+  std::atomic<LockArray*> locks_{nullptr};
+  // Owns the current and all previous lock arrays; only the resizer touches it
+  std::vector<std::unique_ptr<LockArray>> lock_arrays_;
+  std::atomic<bool> resizing_{false};
+  std::atomic<size_t> size_{0};
+  Hash hash_fn_{};
+};
+
+#endif  // REFINABLE_HASH_SET_H_
@@ -0,0 +1,162 @@
+#ifndef STRIPED_HASH_SET_H_
+#define STRIPED_HASH_SET_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "synchronization/lock.h"
+#include "synchronization/ttas_lock.h"
+
+/**
+ * StripedHashSet - A closed-addressing hash set guarded by a fixed array of
+ * locks (lock striping)
+ *
+ * Bucket `i` is guarded by lock `i % L`, where L is the number of locks chosen
+ * at construction. Since the table only ever doubles, an item's lock never
+ * changes, so operations on different stripes proceed in parallel. Resizing
+ * acquires every lock in ascending order.
+ *
+ * `Lock` is any lock with `lock()` and `unlock()`. The resize holds all of them
+ * at once, which the queue locks support by keeping a node per lock instance.
+ *
+ * Items are compared with `operator==`.
+ */
+template<typename T, BasicLockable Lock = TTASLock<>,
+         typename Hash = std::hash<T>>
+class StripedHashSet {
+ public:
+  /**
+   * @param capacity the initial number of buckets, which is also the number
+   * of locks
+   */
+  explicit StripedHashSet(size_t capacity = kDefaultCapacity)
+      : table_(std::max<size_t>(capacity, 1)), locks_(table_.size()) {}
+
+  StripedHashSet(const StripedHashSet&) = delete;
+  auto operator=(const StripedHashSet&) -> StripedHashSet& = delete;
+
+  /**
+   * Adds an item to the set if it's not already present
+   *
+   * @param item The item to add
+   * @return true if the item was added, false if it already exists
+   */
+  auto add(const T& item) -> bool {
+    size_t hash = hash_fn_(item);
+    Lock& lock = locks_[hash % locks_.size()];
+    lock.lock();
+    size_t capacity = table_.size();
+    auto& bucket = table_[hash % capacity];
+    if (std::find(bucket.begin(), bucket.end(), item) != bucket.end()) {
+      lock.unlock();
+      return false;
+    }
+    bucket.push_back(item);
+    lock.unlock();
+
+    if (size_.fetch_add(1, std::memory_order_relaxed) + 1 >
+        kMaxLoadFactor * capacity) {
+      resize(capacity);
+    }
+    return true;
+  }
+
+  /**
+   * Removes an item from the set
+   *
+   * @param item The item to remove
+   * @return true if the item was found and removed, false otherwise
+   */
+  auto remove(const T& item) -> bool {
+    size_t hash = hash_fn_(item);
+    Lock& lock = locks_[hash % locks_.size()];
+    lock.lock();
+    auto& bucket = table_[hash % table_.size()];
+    auto it = std::find(bucket.begin(), bucket.end(), item);
+    bool found = it != bucket.end();
+    if (found) {
+      // Order within a bucket does not matter
+      std::iter_swap(it, bucket.end() - 1);
+      bucket.pop_back();
+      size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    lock.unlock();
+    return found;
+  }
+
+  /**
+   * Checks if an item exists in the set
+   *
+   * @param item The item to check for
+   * @return true if the item exists
+   */
+  auto contains(const T& item) -> bool {
+    size_t hash = hash_fn_(item);
+    Lock& lock = locks_[hash % locks_.size()];
+    lock.lock();
+    const auto& bucket = table_[hash % table_.size()];
+    bool found = std::find(bucket.begin(), bucket.end(), item) != bucket.end();
+    lock.unlock();
+    return found;
+  }
+
+  /**
+   * The number of items in the set; only exact when there are no concurrent
+   * updates
+   */
+  auto size() const -> size_t { return size_.load(std::memory_order_relaxed); }
+
+  /**
+   * The current number of buckets; only exact when there are no concurrent
+   * updates
+   */
+  auto capacity() -> size_t {
+    Lock& lock = locks_[0];
+    lock.lock();
+    size_t capacity = table_.size();
+    lock.unlock();
+    return capacity;
+  }
+
+ private:
+  static constexpr size_t kDefaultCapacity = 16;
+  static constexpr size_t kMaxLoadFactor = 4;
+
+  /**
+   * Doubles the number of buckets, unless another thread already resized the
+   * table since the caller observed `old_capacity`
+   */
+  auto resize(size_t old_capacity) -> void {
+    // Acquire the locks in ascending order to avoid deadlock with concurrent
+    // resizes
+    for (auto& lock : locks_) {
+      lock.lock();
+    }
+
+    if (table_.size() == old_capacity) {
+      std::vector<std::vector<T>> new_table(2 * old_capacity);
+      for (auto& bucket : table_) {
+        for (auto& item : bucket) {
+          new_table[hash_fn_(item) % new_table.size()].push_back(
+              std::move(item));
+        }
+      }
+      table_.swap(new_table);
+    }
+
+    for (auto& lock : locks_) {
+      lock.unlock();
+    }
+  }
+
+  std::vector<std::vector<T>> table_;
+  std::vector<Lock> locks_;
+  std::atomic<size_t> size_{0};
+  Hash hash_fn_{};
+};
+
+#endif  // STRIPED_HASH_SET_H_
@@ -4,20 +4,35 @@
 #include <cstddef>
 #include <limits>
 #include <optional>
+#include <utility>
 
+#include "list/list_order.h"
+#include "memory/pool_allocator.h"
+#include "synchronization/lock.h"
 #include "synchronization/scoped_lock.h"
 #include "synchronization/ttas_lock.h"
 
-template<typename T, typename Hash = std::hash<T>>
+/**
+ * CoarseList - A sorted linked list guarded by a single lock
+ *
+ * Nodes are ordered as described in ListOrder: by hash, or by item when a
+ * `Compare` is given, and allocated by `Allocator` (see pool_allocator.h).
+ */
+template<typename T, typename Hash = std::hash<T>, typename Compare = void,
+         typename Allocator = DefaultAllocator,
+         BasicLockable Lock = TTASLock<>>
 class CoarseList {
-  struct Node {
+  using Order = ListOrder<T, Hash, Compare>;
+  using Key = typename Order::Key;
+
+  struct Node : AllocatedBy<Allocator> {
     size_t key_{};
     std::optional<T> item_;
     Node* next_{nullptr};
 
     Node(size_t key) : key_(key) {}
 
-    Node(size_t key, const T& item) : key_(key), item_(item) {}
+    Node(size_t key, T item) : key_(key), item_(std::move(item)) {}
   };
 
  public:
@@ -27,8 +42,8 @@ class CoarseList {
     head_->next_ = tail_;
   }
 
-  CoarseList(const CoarseList<T, Hash>&) = delete;
-  auto operator=(const CoarseList<T, Hash>&) -> CoarseList<T, Hash>& = delete;
+  CoarseList(const CoarseList&) = delete;
+  auto operator=(const CoarseList&) -> CoarseList& = delete;
 
   ~CoarseList() {
     // Note that the destructor is not thread-safe (i.e., it does not acquire a
@@ -42,9 +57,9 @@ class CoarseList {
     }
   }
 
-  auto add(const T& item) -> bool {
-    size_t key = get_hash_value(item);
-    ScopedLock<TTASLock> lk(mutex_);
+  auto add(T item) -> bool {
+    Key key = order_.make_key(item);
+    ScopedLock<Lock> lk(mutex_);
 
     Node* pred;
     bool key_exists = search(key, pred);
@@ -53,7 +68,7 @@ class CoarseList {
       return false;
     }
 
-    auto node = new Node(key, item);
+    auto node = new Node(key.hash_, std::move(item));
     node->next_ = pred->next_;
     pred->next_ = node;
 
@@ -61,8 +76,8 @@ class CoarseList {
   }
 
   auto remove(const T& item) -> bool {
-    size_t key = get_hash_value(item);
-    ScopedLock<TTASLock> lk(mutex_);
+    Key key = order_.make_key(item);
+    ScopedLock<Lock> lk(mutex_);
 
     Node* pred;
     bool key_exists = search(key, pred);
@@ -79,8 +94,8 @@ class CoarseList {
   }
 
   auto contains(const T& item) -> bool {
-    size_t key = get_hash_value(item);
-    ScopedLock<TTASLock> lk(mutex_);
+    Key key = order_.make_key(item);
+    ScopedLock<Lock> lk(mutex_);
     Node* pred;
     return search(key, pred);
   }
@@ -93,26 +108,22 @@ class CoarseList {
    * @param[out] pred a pointer to the predecessor the node that contains `key`.
    * @return true if the key exists; otherwise, false.
    */
-  auto search(size_t key, Node*& pred) -> bool {
+  auto search(const Key& key, Node*& pred) -> bool {
     pred = head_;
     Node* curr = pred->next_;
 
-    while (curr->key_ < key) {
+    while (order_.precedes(curr, key)) {
       pred = curr;
       curr = curr->next_;
     }
 
-    return curr != tail_ && curr->key_ == key;
-  }
-
-  auto get_hash_value(const T& item) const noexcept -> size_t {
-    return hash_fn_(item);
+    return curr != tail_ && order_.matches(curr, key);
   }
 
-  TTASLock mutex_;
+  Lock mutex_;
   Node* head_{nullptr};
   Node* tail_{nullptr};
-  Hash hash_fn_{};
+  Order order_{};
 };
 
 #endif  // COARSE_LIST_H_
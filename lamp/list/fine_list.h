@@ -3,7 +3,11 @@
 
 #include <limits>
 #include <optional>
+#include <utility>
 
+#include "list/list_order.h"
+#include "memory/pool_allocator.h"
+#include "synchronization/lock.h"
 #include "synchronization/ttas_lock.h"
 
 /**
@@ -14,28 +18,48 @@
  * concurrently. Each node has its own lock, enabling higher concurrency
  * compared to a coarse-grained locking approach.
  *
+ * add() and remove() lock the nodes they pass exclusively, hand over hand.
+ * If `Lock` is SharedLockable, such as SharedTTASLock, contains() couples the
+ * locks in shared mode instead, so readers do not exclude each other; they
+ * still exclude writers from the two nodes they hold, which keeps a node from
+ * being unlinked and freed under a reader. A shared hop costs more than an
+ * exclusive one, so this pays off only when many threads read at once.
+ *
  * @tparam T The type of elements stored in the list
  * @tparam Hash A hash functor type used to compute hash values for elements
+ * @tparam Compare If not void, a strict weak ordering on T; nodes are then
+ * ordered by item instead of by hash (see ListOrder)
+ * @tparam Allocator The allocation policy of the nodes (see pool_allocator.h)
+ * @tparam Lock The per-node lock; any BasicLockable, TTASLock by default
  */
-template<typename T, typename Hash = std::hash<T>>
+template<typename T, typename Hash = std::hash<T>, typename Compare = void,
+         typename Allocator = DefaultAllocator,
+         BasicLockable Lock = TTASLock<>>
 class FineList {
+  using Order = ListOrder<T, Hash, Compare>;
+  using Key = typename Order::Key;
+
   /**
    * @brief Node structure with its own lock for fine-grained synchronization
    */
-  struct Node {
+  struct Node : AllocatedBy<Allocator> {
     size_t key_{};           // Hash key for the item
     std::optional<T> item_;  // The actual data stored (optional because
                              // sentinel nodes don't store data)
     Node* next_{nullptr};    // Pointer to next node in list
-    TTASLock mutex_;  // Per-node lock for fine-grained concurrency control
+    Lock mutex_;  // Per-node lock for fine-grained concurrency control
 
     Node(size_t key) : key_(key) {}
 
-    Node(size_t key, const T& item) : key_(key), item_(item) {}
+    Node(size_t key, T item) : key_(key), item_(std::move(item)) {}
 
     auto lock() -> void { mutex_.lock(); }
 
     auto unlock() -> void { mutex_.unlock(); }
+
+    auto lock_shared() -> void { mutex_.lock_shared(); }
+
+    auto unlock_shared() -> void { mutex_.unlock_shared(); }
   };
 
  public:
@@ -56,12 +80,12 @@ class FineList {
   /**
    * @brief Copy constructor deleted to prevent copying
    */
-  FineList(const FineList<T, Hash>&) = delete;
+  FineList(const FineList&) = delete;
 
   /**
    * @brief Assignment operator deleted to prevent copying
    */
-  auto operator=(const FineList<T, Hash>&) -> FineList<T, Hash>& = delete;
+  auto operator=(const FineList&) -> FineList& = delete;
 
   /**
    * @brief Destructor that safely deletes all nodes with proper locking
@@ -93,15 +117,15 @@ class FineList {
    * @param item The item to add
    * @return true if the item was added, false if it already exists
    */
-  auto add(const T& item) -> bool {
-    size_t key = get_hash_value(item);
+  auto add(T item) -> bool {
+    Key key = order_.make_key(item);
     Node* pred;
     bool key_exists =
         search(key, pred);  // After this call, pred and pred->next_ are locked
     Node* curr = pred->next_;
 
     if (!key_exists) {
-      Node* node = new Node(key, item);
+      Node* node = new Node(key.hash_, std::move(item));
       node->next_ = curr;
       pred->next_ = node;
     }
@@ -125,7 +149,7 @@ class FineList {
    * @return true if the item was removed, false if it wasn't found
    */
   auto remove(const T& item) -> bool {
-    size_t key = get_hash_value(item);
+    Key key = order_.make_key(item);
     Node* pred;
     bool key_exists =
         search(key, pred);  // After this call, pred and pred->next_ are locked
@@ -148,16 +172,17 @@ class FineList {
   /**
    * @brief Checks if an item exists in the list
    *
-   * This method acquires locks in ascending key order (hand-over-hand locking)
-   * through the search method, then releases them after checking.
-   * The search method will lock both the predecessor and current node when it
-   * returns.
+   * This method acquires locks in ascending key order (hand-over-hand locking),
+   * in shared mode if the lock has one, then releases them after checking.
    *
    * @param item The item to check for
    * @return true if the item exists, false otherwise
    */
   auto contains(const T& item) -> bool {
-    size_t key = get_hash_value(item);
+    Key key = order_.make_key(item);
+    if constexpr (SharedLockable<Lock>) {
+      return search_shared(key);
+    }
     Node* pred;
     bool key_exists = search(key, pred);
 
@@ -184,35 +209,48 @@ class FineList {
    * node
    * @return true if the key was found, false otherwise
    */
-  auto search(size_t key, Node*& pred) -> bool {
+  auto search(const Key& key, Node*& pred) -> bool {
     head_->lock();
     pred = head_;
     Node* curr = pred->next_;
     curr->lock();
 
-    while (curr->key_ < key) {
+    while (order_.precedes(curr, key)) {
       pred->unlock();
       pred = curr;
       curr = curr->next_;
       curr->lock();
     }
 
-    return curr != tail_ && curr->key_ == key;
+    return curr != tail_ && order_.matches(curr, key);
   }
 
   /**
-   * @brief Computes the hash value for an item
-   *
-   * @param item The item to hash
-   * @return size_t Hash value for the item
+   * @brief search(), with the locks coupled in shared mode and released
+   * before returning
    */
-  auto get_hash_value(const T& item) const noexcept -> size_t {
-    return hash_fn_(item);
+  auto search_shared(const Key& key) -> bool {
+    head_->lock_shared();
+    Node* pred = head_;
+    Node* curr = pred->next_;
+    curr->lock_shared();
+
+    while (order_.precedes(curr, key)) {
+      pred->unlock_shared();
+      pred = curr;
+      curr = curr->next_;
+      curr->lock_shared();
+    }
+
+    bool found = curr != tail_ && order_.matches(curr, key);
+    curr->unlock_shared();
+    pred->unlock_shared();
+    return found;
   }
 
   Node* head_{nullptr};  // Pointer to the sentinel head node
   Node* tail_{nullptr};  // Pointer to the tail head node
-  Hash hash_fn_{};       // Hash function object
+  Order order_{};        // Hash function and node order
 };
 
 #endif  // FINE_LIST_H_
@@ -1,11 +1,25 @@
 #ifndef LAZY_LIST_H_
 #define LAZY_LIST_H_
 
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <limits>
 #include <optional>
-
+#include <utility>
+#include <vector>
+
+#include "counting/sharded_counter.h"
+#include "list/list_order.h"
+#include "memory/epoch_based_reclamation.h"
+#include "memory/operation_guard.h"
+#include "memory/pool_allocator.h"
+#include "memory/rcu.h"
+#include "synchronization/lock.h"
 #include "synchronization/ttas_lock.h"
+#include "util/atomic_markable_ptr.h"
 
 /**
  * LazyList - A concurrent linked list implementation using lazy synchronization
@@ -14,29 +28,46 @@
  * for thread safety. The key features are:
  * 1. Logical deletion (marking) before physical removal
  * 2. Lock coupling during traversal for thread safety
- * 3. Lock-free garbage management for deleted nodes
+ * 3. Removed nodes are freed by the `Reclaimer` once no concurrent traversal
+ * can reach them
  *
  * The list maintains sentinel nodes with min and max keys to simplify boundary
- * conditions.
+ * conditions. Nodes are ordered by hash, or by item when a `Compare` is given
+ * (see ListOrder), and allocated by `Allocator` (see pool_allocator.h).
  */
-template<typename T, typename Hash = std::hash<T>>
+template<typename T, typename Hash = std::hash<T>,
+         typename Reclaimer = EpochBasedReclamation, typename Compare = void,
+         typename Allocator = DefaultAllocator,
+         BasicLockable Lock = TTASLock<>>
 class LazyList {
+  static_assert(!Reclaimer::kRequiresReservation,
+                "LazyList traverses the list without validating each hop, so "
+                "it needs a reclaimer that protects whole operations");
+
+  using Order = ListOrder<T, Hash, Compare>;
+  using Key = typename Order::Key;
+
   /**
    * Node structure for the linked list
    * Contains a key, optional item, next pointer, marked flag for logical
    * deletion, and a mutex for concurrency control
+   *
+   * The next pointer and the marked flag share one atomic word, so the
+   * wait-free traversals read both with a single acquire load. Both are only
+   * written with the node's lock held, by release stores that publish the
+   * fields of the node they point to.
    */
-  struct Node {
+  struct Node : AllocatedBy<Allocator> {
     size_t key_;             // Hash key for ordering in the list
     std::optional<T> item_;  // Optional value stored in the node
-    Node* next_{nullptr};    // Pointer to the next node
-    bool marked_{false};     // Logical deletion flag
-    TTASLock mutex_;  // Test-and-test-and-set lock for concurrency control
+    // Pointer to the next node, marked once the node is logically deleted
+    AtomicMarkablePtr<Node> next_{nullptr, false};
+    Lock mutex_;  // Per-node lock for concurrency control
 
     Node(size_t key) : key_(key) {}  // Constructor for sentinel nodes
 
-    Node(size_t key, const T& item)
-        : key_(key), item_(item) {}  // Constructor for data nodes
+    Node(size_t key, T item)
+        : key_(key), item_(std::move(item)) {}  // Constructor for data nodes
 
     auto lock() -> void { mutex_.lock(); }  // Acquire the node's lock
 
@@ -50,43 +81,30 @@ class LazyList {
    * Initializes the list with two sentinel nodes:
    * - head with minimum key value
    * - tail with maximum key value
-   * Also initializes the garbage list with a sentinel node
    */
   LazyList() {
     size_t min_key = std::numeric_limits<size_t>::min();
     size_t max_key = std::numeric_limits<size_t>::max();
     head_ = new Node(min_key);  // Create head sentinel node
     tail_ = new Node(max_key);  // Create tail sentinel node
-    head_->next_ = tail_;
-    garbage_list_.store(
-        new Node(max_key),
-        std::memory_order_relaxed);  // Initialize garbage list with sentinel
+    head_->next_.set(tail_, false, std::memory_order_relaxed);
   }
 
   // Prevent copying to avoid complex ownership issues
-  LazyList(const LazyList<T, Hash>&) = delete;
-  auto operator=(const LazyList<T, Hash>&) -> LazyList<T, Hash>& = delete;
+  LazyList(const LazyList&) = delete;
+  auto operator=(const LazyList&) -> LazyList& = delete;
 
   /**
-   * Destructor - Cleans up all nodes including those in the garbage list
+   * Destructor - Frees all nodes still in the list. Removed nodes are owned by
+   * the reclaimer and freed by its destructor.
    *
    * NOT thread-safe - caller must ensure no other threads are accessing the
    * list
    */
   ~LazyList() {
-    // First, free all nodes in the garbage_list_ (logically deleted nodes)
-    // This ensures no memory is leaked from removed nodes
-    Node* curr = garbage_list_.load(std::memory_order_relaxed);
+    Node* curr = head_;
     while (curr != nullptr) {
-      Node* next = curr->next_;
-      delete curr;
-      curr = next;
-    }
-
-    // Then free all nodes still in the main list
-    curr = head_;
-    while (curr != nullptr) {
-      Node* next = curr->next_;
+      Node* next = curr->next_.get_ptr(std::memory_order_relaxed);
       delete curr;
       curr = next;
     }
@@ -101,37 +119,30 @@ class LazyList {
    * Thread safety: Uses the search method for lock acquisition before
    * modification
    */
-  auto add(const T& item) -> bool {
-    size_t key = get_hash_value(item);
+  auto add(T item) -> bool {
+    Key key = order_.make_key(item);
+    OperationGuard guard(reclaimer_);
     Node* pred;
     bool key_exists = search(key, pred);
-    Node* curr = pred->next_;
+    Node* curr = pred->next_.get_ptr(std::memory_order_relaxed);
 
     if (!key_exists) {
-      Node* node = new Node(key, item);
-      node->next_ = curr;
-
-      // Without this fence, the processor or compiler might reorder operations
-      // so that pred->next_ = node executes BEFORE node->next_ = curr is
-      // complete. This would make our new node visible to other threads while
-      // its next pointer is still null, breaking the list integrity.
-      //
-      // The release fence ensures that all memory operations before this point
-      // (including node->next_ = curr) are completed before any memory
-      // operations after this point (specifically pred->next_ = node) become
-      // visible to other threads.
-      std::atomic_thread_fence(std::memory_order_release);
+      Node* node = new Node(key.hash_, std::move(item));
+      node->next_.set(curr, false, std::memory_order_relaxed);
 
       // This is the linearization point - the moment when the node becomes
-      // visible to other threads. After the fence, we can safely make our node
-      // visible.
-      pred->next_ = node;
+      // visible to other threads. The release store makes sure that a thread
+      // that finds the node also sees its key, item and next pointer.
+      pred->next_.set(node, false, std::memory_order_release);
     }
 
     // Release locks held by search
     curr->unlock();
     pred->unlock();
 
+    if (!key_exists) {
+      size_counter_.add(1);
+    }
     return !key_exists;
   }
 
@@ -142,30 +153,30 @@ class LazyList {
    * @return true if the item was removed, false if not found
    *
    * Thread safety: Uses two-phase locking - mark for logical deletion first,
-   * then physically remove from list. Moves deleted node to garbage list.
+   * then physically remove from list. Hands the removed node to the reclaimer.
    */
   auto remove(const T& item) -> bool {
-    size_t key = get_hash_value(item);
+    Key key = order_.make_key(item);
+    OperationGuard guard(reclaimer_);
     Node* pred;
     bool key_exists = search(key, pred);  // Find position and lock nodes
-    Node* curr = pred->next_;
+    Node* curr = pred->next_.get_ptr(std::memory_order_relaxed);
 
     if (key_exists) {
-      curr->marked_ = true;       // Logical deletion
-      pred->next_ = curr->next_;  // Physical removal
-
-      // Add node to garbage list using lock-free algorithm
-      // This defers actual deletion to avoid ABA problems and memory issues
-      curr->next_ = garbage_list_.load(std::memory_order_relaxed);
-      // Loop until successful CAS operation to insert at head of garbage list
-      while (!garbage_list_.compare_exchange_weak(curr->next_, curr,
-                                                  std::memory_order_relaxed)) {}
+      unlink(pred, curr);
     }
 
     // Release locks held by search
     curr->unlock();
     pred->unlock();
 
+    if (key_exists) {
+      // Wait-free readers may still be traversing curr, so its next pointer
+      // is left intact and the node is freed only when that is safe
+      reclaimer_.sched_for_reclaim(curr);
+      size_counter_.add(-1);
+    }
+
     return key_exists;
   }
 
@@ -179,40 +190,326 @@ class LazyList {
    * Note: May return false negatives due to concurrent modifications
    */
   auto contains(const T& item) -> bool {
-    size_t key = get_hash_value(item);
+    Key key = order_.make_key(item);
+    OperationGuard guard(reclaimer_);
     // Skip the head sentinel node since the key may be 0, which collides with
     // the key of the head sentinel
-    Node* curr = head_->next_;
+    Node* curr = head_->next_.get_ptr(std::memory_order_acquire);
     // Traverse list until we find a key >= target
-    while (curr->key_ < key) {
-      curr = curr->next_;
+    while (order_.precedes(curr, key)) {
+      curr = curr->next_.get_ptr(std::memory_order_acquire);
     }
 
     // Check if key matches and node is not marked as deleted
-    return curr != tail_ && curr->key_ == key && !curr->marked_;
+    return curr != tail_ && order_.matches(curr, key) &&
+           !curr->next_.is_marked(std::memory_order_acquire);
+  }
+
+  /**
+   * Adds the items in [first, last) that are not in the list yet
+   *
+   * The items are sorted by key and inserted in a single pass: each search
+   * resumes from the predecessor of the previous item instead of the head, so
+   * loading m items into a list of n costs O(n + m log m) rather than O(n m).
+   * Only the window of each insertion is locked. Of equal items in the batch,
+   * only the first is added.
+   *
+   * Thread safety: every item is added as by add(); the batch is not atomic.
+   *
+   * @return The number of items added
+   */
+  template<typename InputIt>
+  auto add_bulk(InputIt first, InputIt last) -> size_t {
+    std::vector<T> items(first, last);
+    std::vector<Key> keys = order_.sorted_keys(items);
+    OperationGuard guard(reclaimer_);
+    Node* from = head_;
+    size_t num_added = 0;
+    for (const Key& key : keys) {
+      Node* pred;
+      bool key_exists = search(key, pred, from);
+      Node* curr = pred->next_.get_ptr(std::memory_order_relaxed);
+      if (!key_exists) {
+        Node* node =
+            new Node(key.hash_, std::move(items[key.item_ - items.data()]));
+        node->next_.set(curr, false, std::memory_order_relaxed);
+        // Publishes the node's fields with the node, as in add()
+        pred->next_.set(node, false, std::memory_order_release);
+        num_added++;
+      }
+      curr->unlock();
+      pred->unlock();
+      from = pred;
+    }
+    size_counter_.add(static_cast<int64_t>(num_added));
+    return num_added;
+  }
+
+  /**
+   * Removes the items in [first, last) that are in the list
+   *
+   * Sorts the items by key and removes them in a single pass, like
+   * add_bulk(). Removed nodes are handed to the reclaimer as by remove().
+   *
+   * @return The number of items removed
+   */
+  template<typename InputIt>
+  auto remove_bulk(InputIt first, InputIt last) -> size_t {
+    std::vector<T> items(first, last);
+    std::vector<Key> keys = order_.sorted_keys(items);
+    OperationGuard guard(reclaimer_);
+    Node* from = head_;
+    size_t num_removed = 0;
+    for (const Key& key : keys) {
+      Node* pred;
+      bool key_exists = search(key, pred, from);
+      Node* curr = pred->next_.get_ptr(std::memory_order_relaxed);
+      if (key_exists) {
+        unlink(pred, curr);
+      }
+      curr->unlock();
+      pred->unlock();
+      if (key_exists) {
+        reclaimer_.sched_for_reclaim(curr);
+        num_removed++;
+      }
+      from = pred;
+    }
+    size_counter_.add(-static_cast<int64_t>(num_removed));
+    return num_removed;
+  }
+
+  /**
+   * Looks up the items in [first, last) in a single wait-free pass over the
+   * list, in key order
+   *
+   * Each lookup is linearizable as by contains().
+   *
+   * @return For each item, in input order, whether it is in the list
+   */
+  template<typename InputIt>
+  auto contains_bulk(InputIt first, InputIt last) -> std::vector<bool> {
+    std::vector<T> items(first, last);
+    std::vector<Key> keys = order_.sorted_keys(items);
+    std::vector<bool> found(items.size());
+    OperationGuard guard(reclaimer_);
+    Node* curr = head_->next_.get_ptr(std::memory_order_acquire);
+    for (const Key& key : keys) {
+      // Removed nodes keep their next pointer, so the pass can go on from
+      // curr even if it has been removed since
+      while (order_.precedes(curr, key)) {
+        curr = curr->next_.get_ptr(std::memory_order_acquire);
+      }
+      found[key.item_ - items.data()] =
+          curr != tail_ && order_.matches(curr, key) &&
+          !curr->next_.is_marked(std::memory_order_acquire);
+    }
+    return found;
+  }
+
+  /**
+   * Calls `fn(item)` for every item between `lo` and `hi` (inclusive), in list
+   * order. In hash order, these are the items whose hash is in
+   * [hash(lo), hash(hi)].
+   *
+   * Thread safety: Lock-free traversal that skips marked nodes, like
+   * contains(). Weakly consistent: every item that is in the list for the
+   * whole call is visited exactly once, items added or removed concurrently
+   * may or may not be visited.
+   *
+   * @param lo The item with the smallest key to visit
+   * @param hi The item with the largest key to visit
+   * @param fn A callable taking `const T&`
+   */
+  template<typename Fn>
+  auto for_each_in_range(const T& lo, const T& hi, Fn&& fn) -> void {
+    Key lo_key = order_.make_key(lo);
+    Key hi_key = order_.make_key(hi);
+    OperationGuard guard(reclaimer_);
+    Node* curr = head_->next_.get_ptr(std::memory_order_acquire);
+    while (order_.precedes(curr, lo_key)) {
+      curr = curr->next_.get_ptr(std::memory_order_acquire);
+    }
+    while (curr != tail_ && !order_.follows(curr, hi_key)) {
+      auto [next, marked] = curr->next_.get(std::memory_order_acquire);
+      if (!marked) {
+        fn(*curr->item_);
+      }
+      curr = next;
+    }
+  }
+
+  /**
+   * Returns the items of the list, in key order, as of a single point in time
+   *
+   * Thread safety: Linearizable. Locks every node in list order, the same
+   * order in which add() and remove() lock their window, so once the tail is
+   * locked no update can be in progress and the list can be read as a whole.
+   * Updates wait until the snapshot releases their nodes, while contains() and
+   * the weakly consistent traversals are not blocked.
+   */
+  auto snapshot() -> std::vector<T> {
+    // The successor of a locked node can not be removed, since its remover
+    // would need the lock of the predecessor
+    Node* curr = head_;
+    curr->lock();
+    while (curr != tail_) {
+      curr = curr->next_.get_ptr(std::memory_order_relaxed);
+      curr->lock();
+    }
+
+    std::vector<T> items;
+    curr = head_;
+    while (curr != tail_) {
+      Node* next = curr->next_.get_ptr(std::memory_order_relaxed);
+      if (curr != head_) {
+        items.push_back(*curr->item_);
+      }
+      curr->unlock();
+      curr = next;
+    }
+    tail_->unlock();
+    return items;
   }
 
+  /**
+   * Iterator - A weakly consistent forward iterator over the items of the list,
+   * in key order
+   *
+   * Gives the same guarantees as for_each_in_range(). An iterator keeps the
+   * calling thread inside a reclamation operation until it is destroyed, so it
+   * must be destroyed by the thread that created it, and long-lived iterators
+   * delay the reclamation of removed nodes.
+   */
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    Iterator() = default;
+
+    Iterator(const Iterator& other) : list_(other.list_), curr_(other.curr_) {
+      if (list_ != nullptr) {
+        list_->reclaimer_.op_begin();
+      }
+    }
+
+    auto operator=(const Iterator& other) -> Iterator& {
+      if (other.list_ != nullptr) {
+        other.list_->reclaimer_.op_begin();
+      }
+      if (list_ != nullptr) {
+        list_->reclaimer_.op_end();
+      }
+      list_ = other.list_;
+      curr_ = other.curr_;
+      return *this;
+    }
+
+    ~Iterator() {
+      if (list_ != nullptr) {
+        list_->reclaimer_.op_end();
+      }
+    }
+
+    auto operator*() const -> reference { return *curr_->item_; }
+
+    auto operator->() const -> pointer { return &*curr_->item_; }
+
+    auto operator++() -> Iterator& {
+      curr_ = curr_->next_.get_ptr(std::memory_order_acquire);
+      skip_removed();
+      return *this;
+    }
+
+    auto operator++(int) -> Iterator {
+      Iterator copy(*this);
+      ++*this;
+      return copy;
+    }
+
+    auto operator==(const Iterator& other) const -> bool {
+      return curr_ == other.curr_;
+    }
+
+   private:
+    friend class LazyList;
+
+    // Begin iterator: pins the reclaimer before reading the first node
+    explicit Iterator(LazyList* list) : list_(list) {
+      list_->reclaimer_.op_begin();
+      curr_ = list_->head_->next_.get_ptr(std::memory_order_acquire);
+      skip_removed();
+    }
+
+    // End iterator: the tail is never removed, so it needs no protection
+    explicit Iterator(Node* tail) : curr_(tail) {}
+
+    auto skip_removed() -> void {
+      while (curr_ != list_->tail_) {
+        auto [next, marked] = curr_->next_.get(std::memory_order_acquire);
+        if (!marked) {
+          break;
+        }
+        curr_ = next;
+      }
+    }
+
+    LazyList* list_{};
+    Node* curr_{};
+  };
+
+  /**
+   * Returns a weakly consistent iterator to the first item of the list
+   */
+  auto begin() -> Iterator { return Iterator(this); }
+
+  auto end() -> Iterator { return Iterator(tail_); }
+
+  /**
+   * Returns the number of items in the list
+   *
+   * Adds and removes count themselves in per-thread shards, which are only
+   * summed up here, so tracking the size adds no shared write to the
+   * operations. The answer is approximate: it may miss operations in progress.
+   */
+  auto approx_size() const -> size_t {
+    return static_cast<size_t>(std::max<int64_t>(size_counter_.get(), 0));
+  }
+
+  /**
+   * Returns the reclamation domain of the list, e.g. to report quiescent
+   * states to a QsbrRcu domain between operations
+   */
+  auto reclaimer() -> Reclaimer& { return reclaimer_; }
+
  private:
   /**
    * Locates the position for a key and locks the relevant nodes
    *
    * @param key The key to search for
    * @param pred Reference to store the predecessor node
+   * @param from The node to start from: the head, or a node that precedes
+   * `key`. Searches fall back to the head once `from` has been removed.
    * @return true if key exists, false otherwise
    *
    * Thread safety: Uses optimistic validation with retries and hand-over-hand
    * locking Critical for both add and remove operations to maintain list
    * integrity
    */
-  auto search(size_t key, Node*& pred) -> bool {
+  auto search(const Key& key, Node*& pred, Node* from = nullptr) -> bool {
+    Node* start = from != nullptr ? from : head_;
     while (true) {
-      pred = head_;
-      Node* curr = pred->next_;
+      pred = start;
+      Node* curr = pred->next_.get_ptr(std::memory_order_acquire);
 
       // Optimistic traversal without locks
-      while (curr->key_ < key) {
+      while (order_.precedes(curr, key)) {
         pred = curr;
-        curr = curr->next_;
+        curr = curr->next_.get_ptr(std::memory_order_acquire);
       }
 
       // Lock nodes in order of traversal to prevent deadlock
@@ -222,11 +519,14 @@ class LazyList {
       // Validate that nodes are still valid and connected
       // If validation fails, release locks and retry
       if (validate(pred, curr)) {
-        return curr != tail_ && curr->key_ == key;
+        return curr != tail_ && order_.matches(curr, key);
       }
 
       pred->unlock();
       curr->unlock();
+      if (start->next_.is_marked(std::memory_order_acquire)) {
+        start = head_;
+      }
     }
   }
 
@@ -243,28 +543,46 @@ class LazyList {
    * 3. pred still points to curr (no concurrent modification)
    */
   auto validate(Node* pred, Node* curr) const noexcept -> bool {
-    return !pred->marked_ && !curr->marked_ && pred->next_ == curr;
+    // Both nodes are locked, and their words are only written under their
+    // locks, so relaxed loads see the latest values
+    auto [pred_next, pred_marked] = pred->next_.get(std::memory_order_relaxed);
+    return !pred_marked && !curr->next_.is_marked(std::memory_order_relaxed) &&
+           pred_next == curr;
   }
 
   /**
-   * Computes hash value for an item
-   *
-   * @param item The item to hash
-   * @return A size_t hash value, offset by 1 to avoid potential hash of 0
+   * Removes curr, the successor of pred, with both nodes locked: marks curr
+   * (logical deletion), then links pred past it (physical removal)
    *
-   * Adding 1 ensures keys are strictly positive, preserving sentinel node
-   * ordering
+   * curr keeps its next pointer, so wait-free readers that are on it can go
+   * on. Both stores release, since a reader may follow either word to the
+   * successor without ever having synchronized with its insertion.
    */
-  auto get_hash_value(const T& item) const noexcept -> size_t {
-    return hash_fn_(item);
+  auto unlink(Node* pred, Node* curr) noexcept -> void {
+    Node* succ = curr->next_.get_ptr(std::memory_order_relaxed);
+    curr->next_.set(succ, true, std::memory_order_release);
+    pred->next_.set(succ, false, std::memory_order_release);
   }
 
   Node* head_;      // Pointer to the head sentinel node
   Node* tail_;      // Pointer to the tail sentinel node
-  Hash hash_fn_{};  // Hash function for generating keys
-  std::atomic<Node*>
-      garbage_list_;  // Lock-free list of logically deleted nodes
-                      // Uses atomic operations for thread safety
+  Order order_{};   // Hash function and node order
+  Reclaimer reclaimer_;  // Frees removed nodes once they are unreachable
+  ShardedCounter size_counter_;  // Adds minus removes, per thread
 };
 
+/**
+ * RcuLazyList - A LazyList whose removed nodes are freed by QSBR RCU
+ *
+ * contains() and the traversals execute no atomic read-modify-write, no fence
+ * and no store, so readers scale with the number of cores however often they
+ * read. In exchange, every thread that uses the list must call
+ * `list.reclaimer().quiescent_state()` between operations, e.g. once per
+ * request it serves, or `thread_offline()` before it idles; removed nodes are
+ * only freed once all threads have done so. Meant for tables that are read
+ * far more often than they are updated.
+ */
+template<typename T, typename Hash = std::hash<T>>
+using RcuLazyList = LazyList<T, Hash, QsbrRcu>;
+
 #endif  // LAZY_LIST_H_
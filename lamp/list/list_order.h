@@ -0,0 +1,113 @@
+#ifndef LIST_ORDER_H_
+#define LIST_ORDER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+/**
+ * ListOrder - The order in which the list-based sets keep their nodes
+ *
+ * With `Compare = void`, nodes are ordered by the hash of their item and two
+ * items with the same hash are considered equal. This is the cheapest order,
+ * but items with colliding hashes can not be stored together and the order is
+ * meaningless to callers.
+ *
+ * With a `Compare` that is a strict weak ordering on `T`, nodes are ordered by
+ * their items, and two items are equal when neither compares less than the
+ * other. Every node still stores the hash of its item, which serves as a cheap
+ * prefilter for equality, so equal items must have equal hashes.
+ *
+ * The predicates take any node with a `key_` (the hash) and an optional
+ * `item_`. Sentinel nodes hold no item: in item order, a sentinel always
+ * follows the searched key, so it must be the tail (traversals never compare
+ * the head). In hash order, sentinels are compared by their key like any other
+ * node, and the caller tells the tail apart.
+ */
+template<typename T, typename Hash, typename Compare>
+class ListOrder {
+  using ItemCompare =
+      std::conditional_t<std::is_void_v<Compare>, std::less<T>, Compare>;
+
+ public:
+  static constexpr bool kByItem = !std::is_void_v<Compare>;
+
+  /**
+   * A searched position: the hash of an item and, in item order, the item
+   * itself, which must outlive the search
+   */
+  struct Key {
+    size_t hash_;
+    const T* item_;
+  };
+
+  auto make_key(const T& item) const -> Key { return {hash_fn_(item), &item}; }
+
+  /**
+   * @return true if `node` sorts strictly before `key`
+   */
+  template<typename Node>
+  auto precedes(const Node* node, const Key& key) const -> bool {
+    if constexpr (kByItem) {
+      return node->item_.has_value() && compare_(*node->item_, *key.item_);
+    } else {
+      return node->key_ < key.hash_;
+    }
+  }
+
+  /**
+   * @return true if `node` sorts strictly after `key`
+   */
+  template<typename Node>
+  auto follows(const Node* node, const Key& key) const -> bool {
+    if constexpr (kByItem) {
+      return !node->item_.has_value() || compare_(*key.item_, *node->item_);
+    } else {
+      return node->key_ > key.hash_;
+    }
+  }
+
+  /**
+   * Returns the keys of `items` in list order, for the bulk operations; equal
+   * items keep their order in `items`. Each key points into `items`, so
+   * `key.item_ - items.data()` is the position of its item.
+   */
+  auto sorted_keys(const std::vector<T>& items) const -> std::vector<Key> {
+    std::vector<Key> keys;
+    keys.reserve(items.size());
+    for (const T& item : items) {
+      keys.push_back(make_key(item));
+    }
+    std::stable_sort(keys.begin(), keys.end(),
+                     [this](const Key& lhs, const Key& rhs) {
+                       if constexpr (kByItem) {
+                         return compare_(*lhs.item_, *rhs.item_);
+                       } else {
+                         return lhs.hash_ < rhs.hash_;
+                       }
+                     });
+    return keys;
+  }
+
+  /**
+   * @return true if `node`, which does not precede `key`, holds an item equal
+   * to it
+   */
+  template<typename Node>
+  auto matches(const Node* node, const Key& key) const -> bool {
+    if constexpr (kByItem) {
+      return node->key_ == key.hash_ && node->item_.has_value() &&
+             !compare_(*key.item_, *node->item_);
+    } else {
+      return node->key_ == key.hash_;
+    }
+  }
+
+ private:
+  [[no_unique_address]] Hash hash_fn_{};
+  [[no_unique_address]] ItemCompare compare_{};
+};
+
+#endif  // LIST_ORDER_H_
@@ -1,11 +1,27 @@
 #ifndef LOCK_FREE_LIST_H_
 #define LOCK_FREE_LIST_H_
 
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <limits>
 #include <optional>
-
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "counting/sharded_counter.h"
+#include "list/list_order.h"
+#include "memory/epoch_based_reclamation.h"
+#include "memory/operation_guard.h"
+#include "memory/pool_allocator.h"
 #include "util/atomic_markable_ptr.h"
+#include "util/backoff.h"
+#include "util/intrusive_hook.h"
+#include "util/stats.h"
 
 /**
  * LockFreeList - A concurrent linked list that supports lock-free add, remove,
@@ -16,9 +32,28 @@
  * physical removal. The list maintains sorted nodes based on hash values of
  * items, with sentinel nodes at min and max values to simplify boundary
  * conditions.
+ *
+ * Unlinked nodes are handed to the `Reclaimer` (EpochBasedReclamation,
+ * HazardPtr, or GarbageList) and freed while the list is in use. With hazard
+ * pointers, traversals hold at most three reservations (pred, curr, succ) and
+ * validate every hop as in [Mic04]; with epoch-based schemes they are free.
+ *
+ * Nodes are ordered by hash, or by item when a `Compare` is given (see
+ * ListOrder), and allocated by `Allocator` (see pool_allocator.h). With
+ * PoolAllocator, nodes are recycled only once the `Reclaimer` frees them.
+ *
+ * A traversal or update that loses a CAS resumes from its predecessor if that
+ * node is still in the list, rather than from the head, and waits according
+ * to `RetryBackoff` (NoBackoff or PauseBackoff, see backoff.h) first.
  */
-template<typename T, typename Hash = std::hash<T>>
+template<typename T, typename Hash = std::hash<T>,
+         typename Reclaimer = EpochBasedReclamation, typename Compare = void,
+         typename Allocator = DefaultAllocator,
+         typename RetryBackoff = NoBackoff>
 class LockFreeList {
+  using Order = ListOrder<T, Hash, Compare>;
+  using Key = typename Order::Key;
+
   /**
    * Node structure for the linked list
    *
@@ -27,18 +62,23 @@ class LockFreeList {
    * - The optional item value
    * - An atomic markable pointer to the next node (mark bit indicates logical
    * deletion)
-   * - A pointer to the next logically deleted node (for garbage collection)
    */
-  struct Node {
+  struct Node : AllocatedBy<Allocator> {
     size_t key_{};
     std::optional<T> item_{};
     AtomicMarkablePtr<Node> next_;
-    Node* next_deleted_{nullptr};
 
     Node(size_t key) : key_(key), next_(nullptr, false) {}
 
-    Node(size_t key, const T& item)
-        : key_(key), item_(item), next_(nullptr, false) {}
+    Node(size_t key, T item)
+        : key_(key), item_(std::move(item)), next_(nullptr, false) {}
+
+    // Constructs the item in place, for items that can not be copied
+    template<typename... Args>
+    Node(size_t key, std::in_place_t, Args&&... args)
+        : key_(key),
+          item_(std::in_place, std::forward<Args>(args)...),
+          next_(nullptr, false) {}
   };
 
  public:
@@ -59,25 +99,15 @@ class LockFreeList {
   }
 
   // Prevent copying to avoid complex ownership issues
-  LockFreeList(const LockFreeList<T, Hash>&) = delete;
-  auto operator=(const LockFreeList<T, Hash>&)
-      -> LockFreeList<T, Hash>& = delete;
+  LockFreeList(const LockFreeList&) = delete;
+  auto operator=(const LockFreeList&) -> LockFreeList& = delete;
 
   /**
-   * Destructor - Cleans up all nodes including those in the garbage list
+   * Destructor - Frees all nodes still in the list. Unlinked nodes are owned
+   * by the reclaimer and freed by its destructor.
    */
   ~LockFreeList() {
-    // First, free all nodes in the garbage_list_ (logically deleted nodes)
-    // This ensures no memory is leaked from removed nodes
-    Node* curr = garbage_list_.load(std::memory_order_acquire);
-    while (curr != nullptr) {
-      Node* next = curr->next_deleted_;
-      delete curr;
-      curr = next;
-    }
-
-    // Then free all nodes still in the main list
-    curr = head_;
+    Node* curr = head_;
     while (curr != nullptr) {
       Node* next = curr->next_.get_ptr(std::memory_order_acquire);
       delete curr;
@@ -93,16 +123,408 @@ class LockFreeList {
    * @param item The item to add
    * @return true if the item was added, false if it already exists
    */
-  auto add(const T& item) -> bool {
-    size_t key = get_hash_value(item);
-    auto node = new Node(key, item);
+  auto add(T item) -> bool {
+    Key key = order_.make_key(item);
+    if (!add_from(head_, key, std::move(item))) {
+      return false;
+    }
+    size_counter_.add(1);
+    return true;
+  }
+
+  /**
+   * Removes an item from the list
+   *
+   * Thread-safe and lock-free. Uses a two-phase removal approach:
+   * 1. Logical removal: Mark the next pointer of the node (doesn't change
+   * structure)
+   * 2. Physical removal: Update predecessor to skip the removed node
+   *
+   * @param item The item to remove
+   * @return true if the item was found and removed, false otherwise
+   */
+  auto remove(const T& item) -> bool {
+    if (!remove_from(head_, order_.make_key(item))) {
+      return false;
+    }
+    size_counter_.add(-1);
+    return true;
+  }
+
+  /**
+   * Checks if an item exists in the list
+   *
+   * Thread-safe and wait-free (bounded number of steps) with epoch-based
+   * reclamation. Only returns true for nodes that are not marked for deletion.
+   *
+   * Hazard pointers can not protect a traversal through unlinked nodes, so
+   * with them contains() uses find(), which is lock-free and helps unlink
+   * marked nodes along the way.
+   *
+   * @param item The item to check for
+   * @return true if the item exists and is not logically deleted
+   */
+  auto contains(const T& item) -> bool {
+    return contains_from(head_, order_.make_key(item));
+  }
+
+  /**
+   * Adds the items in [first, last) that are not in the list yet
+   *
+   * The items are sorted by key and inserted in a single pass: each find()
+   * resumes from the predecessor of the previous item instead of the head, so
+   * loading m items into a list of n costs O(n + m log m) rather than O(n m).
+   * Of equal items in the batch, only the first is added.
+   *
+   * Thread safety: every item is added as by add(); the batch is not atomic.
+   *
+   * @return The number of items added
+   */
+  template<typename InputIt>
+  auto add_bulk(InputIt first, InputIt last) -> size_t {
+    std::vector<T> items(first, last);
+    std::vector<Key> keys = order_.sorted_keys(items);
+    OperationGuard guard(reclaimer_);
+    RetryBackoff backoff;
+    Node* from = head_;
+    size_t num_added = 0;
+    for (const Key& key : keys) {
+      Node* node = nullptr;
+      while (true) {
+        auto [pred, curr] = find(head_, key, from);
+        if (curr != tail_ && order_.matches(curr, key)) {
+          delete node;
+          reclaimer_.unreserve(curr);
+          from = pred;
+          break;
+        }
+        if (node == nullptr) {
+          node = new Node(key.hash_,
+                          std::move(items[key.item_ - items.data()]));
+        }
+        node->next_ = AtomicMarkablePtr<Node>(curr, false);
+        bool linked = pred->next_.compare_and_swap(
+            curr, node, false, false, std::memory_order_release,
+            std::memory_order_relaxed);
+        reclaimer_.unreserve(curr);
+        if (linked) {
+          num_added++;
+          from = pred;
+          break;
+        }
+        LAMP_STAT_INC(Stat::kCasFailures);
+        backoff.backoff();
+        from = resume_point(head_, pred);
+      }
+    }
+    reclaimer_.unreserve(from);
+    size_counter_.add(static_cast<int64_t>(num_added));
+    return num_added;
+  }
+
+  /**
+   * Removes the items in [first, last) that are in the list
+   *
+   * Sorts the items by key and removes them in a single pass, like
+   * add_bulk().
+   *
+   * @return The number of items removed
+   */
+  template<typename InputIt>
+  auto remove_bulk(InputIt first, InputIt last) -> size_t {
+    std::vector<T> items(first, last);
+    std::vector<Key> keys = order_.sorted_keys(items);
+    OperationGuard guard(reclaimer_);
+    RetryBackoff backoff;
+    Node* from = head_;
+    size_t num_removed = 0;
+    for (const Key& key : keys) {
+      while (true) {
+        auto [pred, curr] = find(head_, key, from);
+        if (curr == tail_ || !order_.matches(curr, key)) {
+          reclaimer_.unreserve(curr);
+          from = pred;
+          break;
+        }
+        Node* succ = curr->next_.get_ptr(std::memory_order_acquire);
+        if (!curr->next_.compare_and_swap(succ, succ, false, true,
+                                          std::memory_order_relaxed)) {
+          LAMP_STAT_INC(Stat::kCasFailures);
+          reclaimer_.unreserve(curr);
+          backoff.backoff();
+          from = resume_point(head_, pred);
+          continue;
+        }
+        bool unlinked = pred->next_.compare_and_swap(
+            curr, succ, false, false, std::memory_order_release,
+            std::memory_order_relaxed);
+        reclaimer_.unreserve(curr);
+        if (unlinked) {
+          reclaimer_.sched_for_reclaim(curr);
+        }
+        num_removed++;
+        from = pred;
+        break;
+      }
+    }
+    reclaimer_.unreserve(from);
+    size_counter_.add(-static_cast<int64_t>(num_removed));
+    return num_removed;
+  }
+
+  /**
+   * Looks up the items in [first, last) in a single pass over the list, in
+   * key order
+   *
+   * Each lookup is linearizable as by contains(). With hazard pointers, the
+   * pass goes through find() and resumes each lookup from the predecessor of
+   * the previous one.
+   *
+   * @return For each item, in input order, whether it is in the list
+   */
+  template<typename InputIt>
+  auto contains_bulk(InputIt first, InputIt last) -> std::vector<bool> {
+    std::vector<T> items(first, last);
+    std::vector<Key> keys = order_.sorted_keys(items);
+    std::vector<bool> found(items.size());
+    OperationGuard guard(reclaimer_);
+    if constexpr (Reclaimer::kRequiresReservation) {
+      Node* from = head_;
+      for (const Key& key : keys) {
+        auto [pred, curr] = find(head_, key, from);
+        found[key.item_ - items.data()] =
+            curr != tail_ && order_.matches(curr, key);
+        reclaimer_.unreserve(curr);
+        from = pred;
+      }
+      reclaimer_.unreserve(from);
+    } else {
+      Node* curr = head_->next_.get_ptr(std::memory_order_acquire);
+      for (const Key& key : keys) {
+        // Marked nodes keep their next pointer, so the pass can go on from
+        // curr even if it has been removed since
+        while (order_.precedes(curr, key)) {
+          curr = curr->next_.get_ptr(std::memory_order_acquire);
+        }
+        found[key.item_ - items.data()] =
+            curr != tail_ && order_.matches(curr, key) &&
+            !curr->next_.is_marked(std::memory_order_acquire);
+      }
+    }
+    return found;
+  }
+
+  /**
+   * Returns the number of items added and removed through add(), remove() and
+   * their bulk forms
+   *
+   * These count themselves in per-thread shards, which are only summed up
+   * here, so tracking the size adds no shared write to the operations. The
+   * answer is approximate: it may miss operations in progress.
+   */
+  auto approx_size() const -> size_t {
+    return static_cast<size_t>(std::max<int64_t>(size_counter_.get(), 0));
+  }
+
+  /**
+   * Calls `fn(item)` for every item between `lo` and `hi` (inclusive), in list
+   * order, without modifying the list. In hash order, these are the items
+   * whose hash is in [hash(lo), hash(hi)].
+   *
+   * Weakly consistent: every item that is in the list for the whole call is
+   * visited exactly once, items added or removed concurrently may or may not
+   * be visited. A single traversal is much cheaper than looking up each item
+   * with contains(), which restarts from the head every time.
+   *
+   * With hazard pointers, a traversal can not continue past a node that was
+   * removed under it, so it resumes from the head, at the position of the last
+   * node it reached.
+   *
+   * @param lo The item with the smallest key to visit
+   * @param hi The item with the largest key to visit
+   * @param fn A callable taking `const T&`
+   */
+  template<typename Fn>
+  auto for_each_in_range(const T& lo, const T& hi, Fn&& fn) -> void {
+    Key lo_key = order_.make_key(lo);
+    Key hi_key = order_.make_key(hi);
+    OperationGuard guard(reclaimer_);
+    if constexpr (Reclaimer::kRequiresReservation) {
+      Node* pred;
+      Node* curr;
+      std::tie(pred, curr) = find(head_, lo_key);
+      // Set when curr is the node visited last before a restart
+      bool visited = false;
+      // In item order, the position to resume from outlives the node
+      std::optional<T> resume_item;
+      while (curr != tail_ && !order_.follows(curr, hi_key)) {
+        auto [succ, marked] = curr->next_.get(std::memory_order_acquire);
+        if (!marked && !visited) {
+          fn(*curr->item_);
+        }
+        if (marked || !protect(succ, curr->next_, false)) {
+          // A removed node was not visited, so its item may still be in the
+          // list under a newer node
+          if constexpr (Order::kByItem) {
+            resume_item.emplace(*curr->item_);
+          }
+          Key resume{curr->key_, resume_item ? &*resume_item : nullptr};
+          release(pred, curr);
+          std::tie(pred, curr) = find(head_, resume);
+          visited = !marked && curr != tail_ && order_.matches(curr, resume);
+          continue;
+        }
+        visited = false;
+        reclaimer_.unreserve(pred);
+        pred = curr;
+        curr = succ;
+      }
+      release(pred, curr);
+    } else {
+      Node* curr = head_->next_.get_ptr(std::memory_order_acquire);
+      while (order_.precedes(curr, lo_key)) {
+        curr = curr->next_.get_ptr(std::memory_order_acquire);
+      }
+      while (curr != tail_ && !order_.follows(curr, hi_key)) {
+        auto [succ, marked] = curr->next_.get(std::memory_order_acquire);
+        if (!marked) {
+          fn(*curr->item_);
+        }
+        curr = succ;
+      }
+    }
+  }
+
+  /**
+   * Iterator - A weakly consistent forward iterator over the items of the list,
+   * in key order
+   *
+   * Gives the same guarantees as for_each_in_range(). An iterator keeps the
+   * calling thread inside a reclamation operation until it is destroyed, so it
+   * must be destroyed by the thread that created it, and long-lived iterators
+   * delay the reclamation of removed nodes.
+   */
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    Iterator() = default;
+
+    Iterator(const Iterator& other) : list_(other.list_), curr_(other.curr_) {
+      if (list_ != nullptr) {
+        list_->reclaimer_.op_begin();
+      }
+    }
+
+    auto operator=(const Iterator& other) -> Iterator& {
+      if (other.list_ != nullptr) {
+        other.list_->reclaimer_.op_begin();
+      }
+      if (list_ != nullptr) {
+        list_->reclaimer_.op_end();
+      }
+      list_ = other.list_;
+      curr_ = other.curr_;
+      return *this;
+    }
+
+    ~Iterator() {
+      if (list_ != nullptr) {
+        list_->reclaimer_.op_end();
+      }
+    }
+
+    auto operator*() const -> reference { return *curr_->item_; }
+
+    auto operator->() const -> pointer { return &*curr_->item_; }
+
+    auto operator++() -> Iterator& {
+      curr_ = curr_->next_.get_ptr(std::memory_order_acquire);
+      skip_removed();
+      return *this;
+    }
+
+    auto operator++(int) -> Iterator {
+      Iterator copy(*this);
+      ++*this;
+      return copy;
+    }
+
+    auto operator==(const Iterator& other) const -> bool {
+      return curr_ == other.curr_;
+    }
+
+   private:
+    friend class LockFreeList;
+
+    // Begin iterator: pins the reclaimer before reading the first node
+    explicit Iterator(LockFreeList* list) : list_(list) {
+      list_->reclaimer_.op_begin();
+      curr_ = list_->head_->next_.get_ptr(std::memory_order_acquire);
+      skip_removed();
+    }
+
+    // End iterator: the tail is never removed, so it needs no protection
+    explicit Iterator(Node* tail) : curr_(tail) {}
+
+    auto skip_removed() -> void {
+      while (curr_ != list_->tail_ &&
+             curr_->next_.is_marked(std::memory_order_acquire)) {
+        curr_ = curr_->next_.get_ptr(std::memory_order_acquire);
+      }
+    }
+
+    LockFreeList* list_{};
+    Node* curr_{};
+  };
+
+  /**
+   * Returns a weakly consistent iterator to the first item of the list. Only
+   * available with reclaimers that protect whole operations; with hazard
+   * pointers, use for_each_in_range().
+   */
+  auto begin() -> Iterator
+    requires(!Reclaimer::kRequiresReservation)
+  {
+    return Iterator(this);
+  }
+
+  auto end() -> Iterator
+    requires(!Reclaimer::kRequiresReservation)
+  {
+    return Iterator(tail_);
+  }
+
+ private:
+  template<typename, typename, typename>
+  friend class LockFreeHashSet;
+
+  template<typename, typename, typename, typename, typename>
+  friend class LockFreeMap;
+
+  // The following operations start from an arbitrary node that is never
+  // removed, such as the head or a bucket sentinel of LockFreeHashSet, and take
+  // the key instead of computing it from the item.
+
+  auto add_from(Node* start, Key key, T item) -> bool {
+    auto node = new Node(key.hash_, std::move(item));
+    // The caller's item has been moved into the node
+    key.item_ = &*node->item_;
+    OperationGuard guard(reclaimer_);
+    RetryBackoff backoff;
+    Node* from = start;
     while (true) {
       // Find insertion point - returns a pair of nodes (pred, curr) where
       // pred->key < key <= curr->key and neither is logically deleted
-      auto [pred, curr] = find(head_, key);
+      auto [pred, curr] = find(start, key, from);
 
       // If key already exists, return false
-      if (curr != tail_ && curr->key_ == key) {
+      if (curr != tail_ && order_.matches(curr, key)) {
+        delete node;
         return false;
       }
 
@@ -117,28 +539,23 @@ class LockFreeList {
         // Succeed only if pred is unmarked and still points to curr
         return true;
       }
+      LAMP_STAT_INC(Stat::kCasFailures);
+      reclaimer_.unreserve(curr);
+      backoff.backoff();
+      from = resume_point(start, pred);
     }
   }
 
-  /**
-   * Removes an item from the list
-   *
-   * Thread-safe and lock-free. Uses a two-phase removal approach:
-   * 1. Logical removal: Mark the next pointer of the node (doesn't change
-   * structure)
-   * 2. Physical removal: Update predecessor to skip the removed node
-   *
-   * @param item The item to remove
-   * @return true if the item was found and removed, false otherwise
-   */
-  auto remove(const T& item) -> bool {
-    size_t key = get_hash_value(item);
+  auto remove_from(Node* start, const Key& key) -> bool {
+    OperationGuard guard(reclaimer_);
+    RetryBackoff backoff;
+    Node* from = start;
     while (true) {
       // Find the node and its predecessor
-      auto [pred, curr] = find(head_, key);
+      auto [pred, curr] = find(start, key, from);
 
       // If key not found, return false
-      if (curr == tail_ || curr->key_ != key) {
+      if (curr == tail_ || !order_.matches(curr, key)) {
         return false;
       }
 
@@ -149,6 +566,10 @@ class LockFreeList {
       if (!curr->next_.compare_and_swap(succ, succ, false, true,
                                         std::memory_order_relaxed)) {
         // Someone else modified curr's next pointer or curr's mark bit - retry
+        LAMP_STAT_INC(Stat::kCasFailures);
+        reclaimer_.unreserve(curr);
+        backoff.backoff();
+        from = resume_point(start, pred);
         continue;
       }
 
@@ -158,9 +579,9 @@ class LockFreeList {
       if (pred->next_.compare_and_swap(curr, succ, false, false,
                                        std::memory_order_release,
                                        std::memory_order_relaxed)) {
-        // Successfully (physically) remove curr from the list, so we insert
-        // curr into the garbage list to clean up its memory later
-        add_to_garbage(curr);
+        // Successfully (physically) remove curr from the list, so we hand
+        // it to the reclaimer to free once no thread can still reference it
+        reclaimer_.sched_for_reclaim(curr);
       }
 
       // Return true because node was at least logically removed
@@ -168,30 +589,53 @@ class LockFreeList {
     }
   }
 
+  auto contains_from(Node* start, const Key& key) -> bool {
+    OperationGuard guard(reclaimer_);
+    if constexpr (Reclaimer::kRequiresReservation) {
+      Node* curr = find(start, key).second;
+      return curr != tail_ && order_.matches(curr, key);
+    } else {
+      Node* curr = start->next_.get_ptr(std::memory_order_acquire);
+
+      // Traverse until we find a node with a key >= our target
+      while (order_.precedes(curr, key)) {
+        curr = curr->next_.get_ptr(std::memory_order_acquire);
+      }
+
+      // Check if we found the exact key and it's not marked for deletion
+      return (curr != tail_ && order_.matches(curr, key) &&
+              !curr->next_.is_marked(std::memory_order_acquire));
+    }
+  }
+
   /**
-   * Checks if an item exists in the list
-   *
-   * Thread-safe and wait-free (bounded number of steps).
-   * Only returns true for nodes that are not marked for deletion.
+   * Inserts a sentinel node (without item) with the given key, unless one
+   * already exists. Sentinels are never removed, and only exist in hash order.
    *
-   * @param item The item to check for
-   * @return true if the item exists and is not logically deleted
+   * @return The sentinel with the given key
    */
-  auto contains(const T& item) -> bool {
-    size_t key = get_hash_value(item);
-    Node* curr = head_->next_.get_ptr(std::memory_order_acquire);
+  auto add_sentinel(Node* start, size_t hash) -> Node* {
+    static_assert(!Order::kByItem, "sentinels are ordered by hash only");
+    Key key{hash, nullptr};
+    auto node = new Node(hash);
+    OperationGuard guard(reclaimer_);
+    while (true) {
+      auto [pred, curr] = find(start, key);
+      if (curr != tail_ && order_.matches(curr, key)) {
+        delete node;
+        return curr;
+      }
 
-    // Traverse until we find a node with a key >= our target
-    while (curr->key_ < key) {
-      curr = curr->next_.get_ptr(std::memory_order_acquire);
+      node->next_ = AtomicMarkablePtr<Node>(curr, false);
+      if (pred->next_.compare_and_swap(curr, node, false, false,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+        return node;
+      }
+      release(pred, curr);
     }
-
-    // Check if we found the exact key and it's not marked for deletion
-    return (curr != tail_ && curr->key_ == key &&
-            !curr->next_.is_marked(std::memory_order_acquire));
   }
 
- private:
   /**
    * Traverses the list to find a key, cleaning up logically deleted nodes along
    * the way
@@ -202,90 +646,307 @@ class LockFreeList {
    * 2. Physically removes any logically deleted nodes encountered during
    * traversal
    *
-   * @param head The starting node for traversal
+   * When a CAS or a hazard pointer validation fails, the traversal resumes
+   * from its predecessor if that node is still in the list, so contention
+   * costs a few hops instead of a walk from `head`.
+   *
+   * @param head The node to restart from when no better node is known
    * @param key The key to find
+   * @param from The node to start the traversal from: `head`, or a node that
+   * precedes `key` and is protected by the caller (see resume_point())
    * @return A pair of adjacent nodes (pred, curr) where pred->key < key <=
    * curr->key and neither node is logically deleted
    */
-  auto find(Node* head, size_t key) -> std::pair<Node*, Node*> {
+  auto find(Node* head, const Key& key, Node* from = nullptr)
+      -> std::pair<Node*, Node*> {
+    RetryBackoff backoff;
+    Node* pred = from != nullptr ? from : head;
   retry:
-    Node* pred = head;
-    Node* curr = pred->next_.get_ptr(std::memory_order_relaxed);
+    Node* curr = pred->next_.get_ptr(std::memory_order_acquire);
+    if (!protect(curr, pred->next_, false)) {
+      pred = resume_point(head, pred);
+      goto retry;
+    }
 
     // Traverse the list indefinitely until we find the right spot
     while (true) {
       // Get the successor node and curr's marked status from curr's next ptr
       auto [succ, marked] = curr->next_.get(std::memory_order_acquire);
+      if (!protect(succ, curr->next_, marked)) {
+        reclaimer_.unreserve(curr);
+        pred = resume_point(head, pred);
+        goto retry;
+      }
 
       // If curr is marked, it's logically removed; clean it up
       while (marked) {
         // Attempt to physically remove curr by updating pred->next to succ
         // - Expected: pred->next points to curr and pred is unmarked
         // - Desired: pred->next points to succ and pred remains unmarked
+        // Since curr->next is frozen once marked, the success of this CAS is
+        // also what guarantees that succ was still reachable when reserved.
         if (pred->next_.compare_and_swap(curr, succ, false, false,
                                          std::memory_order_release,
                                          std::memory_order_relaxed)) {
-          // Successfully (physically) remove curr from the list, so we insert
-          // curr into the garbage list to clean up its memory later
-          add_to_garbage(curr);
+          // Successfully (physically) remove curr from the list, so we hand
+          // it to the reclaimer to free once no thread can still reference it
+          reclaimer_.unreserve(curr);
+          reclaimer_.sched_for_reclaim(curr);
         } else {
           // CAS failed because:
           // 1. Another thread logically removed pred by setting marked bit in
           // pred->next
           // 2. Another thread physically removed curr by changing pred->next
-          // Restart traversal from head to ensure we're working with a
-          // consistent state
+          // In the second case pred is still in the list, and the traversal
+          // resumes from it; only in the first does it restart from head
+          reclaimer_.unreserve(curr);
+          reclaimer_.unreserve(succ);
+          LAMP_STAT_INC(Stat::kCasFailures);
+          backoff.backoff();
+          pred = resume_point(head, pred);
           goto retry;
         }
 
         // Successfully removed curr; advance to succ and check its next
         curr = succ;
         std::tie(succ, marked) = curr->next_.get(std::memory_order_acquire);
+        if (!protect(succ, curr->next_, marked)) {
+          reclaimer_.unreserve(curr);
+          pred = resume_point(head, pred);
+          goto retry;
+        }
       }
 
       // At this point, curr is unmarked (not logically removed).
       // Check if we've reached or passed the target key
-      if (curr->key_ >= key) {
+      if (!order_.precedes(curr, key)) {
         // Found the spot: pred->key_ < key <= curr->key_
         // Both pred and curr are unmarked, safe for add/remove
+        reclaimer_.unreserve(succ);
         return {pred, curr};
       }
 
       // Key not found yet; move forward in the list
+      reclaimer_.unreserve(pred);
       pred = curr;
       curr = succ;
     }
   }
 
   /**
-   * Adds a node to the garbage list for deferred deletion
+   * Returns the node to resume a failed traversal from: `pred` while it is
+   * still in the list, since it still precedes every key it preceded, and
+   * `head` otherwise
    *
-   * Uses a lock-free approach to add to the garbage list, continuously
-   * retrying if the head of the garbage list changes during the operation.
-   *
-   * @param node The node to add to the garbage list
+   * A node is unlinked only after it is marked, and marks are never cleared,
+   * so an unmarked node is reachable. The caller must hold the protection of
+   * `pred`, which is kept if `pred` is returned and dropped otherwise.
    */
-  void add_to_garbage(Node* node) {
-    node->next_deleted_ = garbage_list_.load(std::memory_order_relaxed);
-    while (!garbage_list_.compare_exchange_weak(node->next_deleted_, node,
-                                                std::memory_order_relaxed)) {}
+  auto resume_point(Node* head, Node* pred) -> Node* {
+    if (pred == head || !pred->next_.is_marked(std::memory_order_acquire)) {
+      return pred;
+    }
+    reclaimer_.unreserve(pred);
+    LAMP_STAT_INC(Stat::kFindRestarts);
+    return head;
   }
 
   /**
-   * Computes the hash value for an item
+   * Protects a node from reclamation before it is dereferenced
    *
-   * @param item The item to hash
-   * @return The hash value as a size_t
+   * With hazard pointers, reserves the node and then checks that `src` still
+   * points to it with the expected mark, which proves that the node was still
+   * reachable when the reservation was published. Compiles to nothing for
+   * reclaimers that protect whole operations.
+   *
+   * @param node The node about to be dereferenced
+   * @param src The next pointer `node` was read from
+   * @param marked The mark `src` was read with
+   * @return true if the node is protected, false if the caller must restart
+   */
+  auto protect(Node* node, const AtomicMarkablePtr<Node>& src, bool marked)
+      -> bool {
+    if constexpr (Reclaimer::kRequiresReservation) {
+      reclaimer_.try_reserve(node);
+      if (src.get(std::memory_order_seq_cst) != std::pair{node, marked}) {
+        reclaimer_.unreserve(node);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Drops the protection of a (pred, curr) window before restarting
    */
-  auto get_hash_value(const T& item) const noexcept -> size_t {
-    return hash_fn_(item);
+  auto release(Node* pred, Node* curr) -> void {
+    reclaimer_.unreserve(pred);
+    reclaimer_.unreserve(curr);
   }
 
   Node* head_{};    // Pointer to the head sentinel node
   Node* tail_{};    // Pointer to the tail sentinel node
-  Hash hash_fn_{};  // Hash function to generate keys from items
-  std::atomic<Node*> garbage_list_{
-      nullptr};  // List of logically deleted nodes for deferred deletion
+  Order order_{};   // Hash function and node order
+  Reclaimer reclaimer_;  // Frees unlinked nodes once they are unreachable
+  // Adds minus removes through the public interface, per thread. The hash
+  // set and map call add_from() and remove_from() directly and keep no count.
+  ShardedCounter size_counter_;
+};
+
+/**
+ * IntrusiveLockFreeList - A Harris-Michael lock-free list of caller-allocated
+ * nodes, kept sorted by `Compare`
+ *
+ * `T` must derive from IntrusiveHook, whose mark flags logically removed nodes
+ * as the mark of LockFreeList's nodes does. The list never allocates: adding
+ * links the caller's node, and items are compared directly, so no key is
+ * stored. The head is an embedded hook and the end of the list is nullptr.
+ *
+ * A removed node may still be traversed by other threads, so it can not be
+ * reused right away. Once it is unlinked, it is handed to the `Reclaimer`,
+ * which passes it to `Disposer` when no thread can reference it any more;
+ * until then it must not be added again or freed. The default NoDisposer
+ * suits nodes whose memory outlives the list. Nodes still in the list are
+ * disposed of by its destructor.
+ *
+ * Only reclaimers that protect whole operations (EpochBasedReclamation,
+ * GarbageList) are supported.
+ */
+template<typename T, typename Compare = std::less<T>,
+         typename Disposer = NoDisposer,
+         typename Reclaimer = EpochBasedReclamation>
+class IntrusiveLockFreeList {
+  static_assert(!Reclaimer::kRequiresReservation,
+                "IntrusiveLockFreeList does not reserve individual nodes");
+
+ public:
+  IntrusiveLockFreeList() = default;
+
+  IntrusiveLockFreeList(const IntrusiveLockFreeList&) = delete;
+  auto operator=(const IntrusiveLockFreeList&)
+      -> IntrusiveLockFreeList& = delete;
+
+  ~IntrusiveLockFreeList() {
+    IntrusiveHook* curr = head_.next_.get_ptr(std::memory_order_acquire);
+    while (curr != nullptr) {
+      IntrusiveHook* next = curr->next_.get_ptr(std::memory_order_relaxed);
+      dispose(curr);
+      curr = next;
+    }
+  }
+
+  /**
+   * Links a node into the list, unless an equal item is already present
+   *
+   * @return true if the node was added, false if it was left to the caller
+   */
+  auto add(T* node) -> bool {
+    OperationGuard guard(reclaimer_);
+    while (true) {
+      auto [pred, curr] = find(*node);
+      if (curr != nullptr && !compare_(*node, item_of(curr))) {
+        return false;
+      }
+      node->next_.set(curr, false, std::memory_order_relaxed);
+      // Release publishes the node's item with its link
+      if (pred->next_.compare_and_swap(curr, node, false, false,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+  }
+
+  /**
+   * Removes the node equal to `item`, if any, and hands it to the reclaimer
+   *
+   * @return true if a node was removed
+   */
+  auto remove(const T& item) -> bool {
+    OperationGuard guard(reclaimer_);
+    while (true) {
+      auto [pred, curr] = find(item);
+      if (curr == nullptr || compare_(item, item_of(curr))) {
+        return false;
+      }
+      IntrusiveHook* succ = curr->next_.get_ptr(std::memory_order_acquire);
+      // Logical removal; whoever unlinks the node retires it
+      if (!curr->next_.compare_and_swap(succ, succ, false, true,
+                                        std::memory_order_relaxed)) {
+        continue;
+      }
+      if (pred->next_.compare_and_swap(curr, succ, false, false,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+        retire(curr);
+      }
+      return true;
+    }
+  }
+
+  /**
+   * Checks if an item equal to `item` is in the list
+   *
+   * Wait-free: never helps unlink removed nodes.
+   */
+  auto contains(const T& item) -> bool {
+    OperationGuard guard(reclaimer_);
+    IntrusiveHook* curr = head_.next_.get_ptr(std::memory_order_acquire);
+    while (curr != nullptr && compare_(item_of(curr), item)) {
+      curr = curr->next_.get_ptr(std::memory_order_acquire);
+    }
+    return curr != nullptr && !compare_(item, item_of(curr)) &&
+           !curr->next_.is_marked(std::memory_order_acquire);
+  }
+
+ private:
+  static auto item_of(IntrusiveHook* hook) -> const T& {
+    return *static_cast<T*>(hook);
+  }
+
+  static auto dispose(void* hook) -> void {
+    Disposer{}(static_cast<T*>(static_cast<IntrusiveHook*>(hook)));
+  }
+
+  auto retire(IntrusiveHook* hook) -> void {
+    reclaimer_.sched_for_reclaim(hook, &dispose);
+  }
+
+  /**
+   * Returns the adjacent unmarked nodes (pred, curr) with pred < item <= curr,
+   * where curr is nullptr past the end, unlinking marked nodes on the way.
+   * `pred` is the head hook if no node precedes `item`.
+   */
+  auto find(const T& item) -> std::pair<IntrusiveHook*, IntrusiveHook*> {
+  retry:
+    IntrusiveHook* pred = &head_;
+    IntrusiveHook* curr = pred->next_.get_ptr(std::memory_order_acquire);
+    while (curr != nullptr) {
+      auto [succ, marked] = curr->next_.get(std::memory_order_acquire);
+      if (marked) {
+        if (!pred->next_.compare_and_swap(curr, succ, false, false,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+          // pred was removed, or curr was unlinked by another thread
+          LAMP_STAT_INC(Stat::kFindRestarts);
+          goto retry;
+        }
+        retire(curr);
+        curr = succ;
+        continue;
+      }
+      if (!compare_(item_of(curr), item)) {
+        break;
+      }
+      pred = curr;
+      curr = succ;
+    }
+    return {pred, curr};
+  }
+
+  IntrusiveHook head_;
+  [[no_unique_address]] Compare compare_{};
+  Reclaimer reclaimer_;  // Disposes of unlinked nodes once they are unreachable
 };
 
 #endif  // LOCK_FREE_LIST_H_
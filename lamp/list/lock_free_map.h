@@ -0,0 +1,181 @@
+#ifndef LOCK_FREE_MAP_H_
+#define LOCK_FREE_MAP_H_
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "list/lock_free_list.h"
+#include "memory/epoch_based_reclamation.h"
+#include "memory/operation_guard.h"
+
+/**
+ * LockFreeMap - A lock-free ordered map built on LockFreeList
+ *
+ * Each node of the underlying list holds an entry with the key and a pointer
+ * to the current value. Inserting a new key links a new node exactly like
+ * LockFreeList::add(), and assigning to an existing key swaps the value
+ * pointer in place, so a map never needs a side table next to a set. Replaced
+ * values are retired through the list's `Reclaimer`.
+ *
+ * Entries are ordered by `Compare` on the keys, or by the hash of the keys
+ * when `Compare` is void (see ListOrder). Equal keys must have equal hashes.
+ *
+ * Readers copy values out while they may be concurrently replaced, so the
+ * `Reclaimer` must protect whole operations.
+ */
+template<typename K, typename V, typename Hash = std::hash<K>,
+         typename Compare = std::less<K>,
+         typename Reclaimer = EpochBasedReclamation>
+class LockFreeMap {
+  static_assert(!Reclaimer::kRequiresReservation,
+                "LockFreeMap reads values without reserving them, so it needs "
+                "a reclaimer that protects whole operations");
+
+  /**
+   * An entry owns its current value. Probes used for searching have no value.
+   */
+  struct Entry {
+    K key_;
+    std::atomic<V*> value_;
+
+    explicit Entry(const K& key, V* value = nullptr)
+        : key_(key), value_(value) {}
+
+    Entry(const Entry&) = delete;
+    auto operator=(const Entry&) -> Entry& = delete;
+
+    ~Entry() { delete value_.load(std::memory_order_relaxed); }
+  };
+
+  struct EntryHash {
+    auto operator()(const Entry& entry) const -> size_t {
+      return hash_fn_(entry.key_);
+    }
+
+    [[no_unique_address]] Hash hash_fn_{};
+  };
+
+  struct EntryCompare {
+    auto operator()(const Entry& lhs, const Entry& rhs) const -> bool {
+      return compare_(lhs.key_, rhs.key_);
+    }
+
+    [[no_unique_address]] Compare compare_{};
+  };
+
+  using List = LockFreeList<
+      Entry, EntryHash, Reclaimer,
+      std::conditional_t<std::is_void_v<Compare>, void, EntryCompare>>;
+  using Node = typename List::Node;
+
+ public:
+  LockFreeMap() = default;
+
+  LockFreeMap(const LockFreeMap&) = delete;
+  auto operator=(const LockFreeMap&) -> LockFreeMap& = delete;
+
+  /**
+   * Maps `key` to `value`, inserting the key if needed
+   *
+   * Lock-free. Assigning to an existing key swaps its value pointer; if the
+   * key is erased concurrently, the assignment is retried as an insertion.
+   *
+   * @return true if the key was inserted, false if an existing value was
+   * replaced
+   */
+  auto insert_or_assign(const K& key, const V& value) -> bool {
+    Entry probe(key);
+    auto search_key = list_.order_.make_key(probe);
+    auto new_value = new V(value);
+    Node* node = nullptr;
+    OperationGuard guard(list_.reclaimer_);
+
+    while (true) {
+      auto [pred, curr] = list_.find(list_.head_, search_key);
+
+      if (curr != list_.tail_ && list_.order_.matches(curr, search_key)) {
+        V* old_value =
+            curr->item_->value_.exchange(new_value, std::memory_order_acq_rel);
+        list_.reclaimer_.sched_for_reclaim(old_value);
+        bool erased = curr->next_.is_marked(std::memory_order_seq_cst);
+        list_.release(pred, curr);
+        if (!erased) {
+          // The entry was still in the map after the exchange
+          if (node != nullptr) {
+            node->item_->value_.store(nullptr, std::memory_order_relaxed);
+            delete node;
+          }
+          return false;
+        }
+        // The erased entry now owns `new_value` and frees it together with
+        // the node, so retry with a fresh copy
+        new_value = new V(value);
+        if (node != nullptr) {
+          node->item_->value_.store(new_value, std::memory_order_relaxed);
+        }
+        continue;
+      }
+
+      if (node == nullptr) {
+        node = new Node(search_key.hash_, std::in_place, key, new_value);
+      }
+      node->next_ = AtomicMarkablePtr<Node>(curr, false);
+      if (pred->next_.compare_and_swap(curr, node, false, false,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+        return true;
+      }
+      list_.release(pred, curr);
+    }
+  }
+
+  /**
+   * Looks up the value of a key
+   *
+   * Wait-free, like LockFreeList::contains().
+   *
+   * @return a copy of the value, or std::nullopt if the key is not in the map
+   */
+  auto find(const K& key) -> std::optional<V> {
+    Entry probe(key);
+    auto search_key = list_.order_.make_key(probe);
+    OperationGuard guard(list_.reclaimer_);
+
+    Node* curr = list_.head_->next_.get_ptr(std::memory_order_acquire);
+    while (list_.order_.precedes(curr, search_key)) {
+      curr = curr->next_.get_ptr(std::memory_order_acquire);
+    }
+    if (curr == list_.tail_ || !list_.order_.matches(curr, search_key) ||
+        curr->next_.is_marked(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+    return *curr->item_->value_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Checks if a key is in the map
+   */
+  auto contains(const K& key) -> bool {
+    Entry probe(key);
+    return list_.contains_from(list_.head_, list_.order_.make_key(probe));
+  }
+
+  /**
+   * Removes a key and its value from the map
+   *
+   * @return true if the key was found and removed, false otherwise
+   */
+  auto erase(const K& key) -> bool {
+    Entry probe(key);
+    return list_.remove_from(list_.head_, list_.order_.make_key(probe));
+  }
+
+ private:
+  List list_;
+};
+
+#endif  // LOCK_FREE_MAP_H_
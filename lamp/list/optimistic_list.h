@@ -4,20 +4,52 @@
 #include <atomic>
 #include <limits>
 #include <optional>
+#include <utility>
 
+#include "list/list_order.h"
+#include "memory/epoch_based_reclamation.h"
+#include "memory/operation_guard.h"
+#include "memory/pool_allocator.h"
+#include "synchronization/lock.h"
 #include "synchronization/ttas_lock.h"
 
-template<typename T, typename Hash = std::hash<T>>
+/**
+ * OptimisticList - A concurrent linked list that traverses without locks and
+ * validates, after locking, that the window it found is still reachable
+ *
+ * Unlinked nodes are flagged as removed while both window locks are held, so
+ * a locked predecessor is reachable exactly when it is not flagged and
+ * validation takes O(1) instead of a second walk from the head. contains()
+ * takes no locks at all.
+ *
+ * Removed nodes are handed to the `Reclaimer`, which frees them once no
+ * concurrent traversal can still reach them. Nodes are ordered by hash, or by
+ * item when a `Compare` is given (see ListOrder). Nodes are allocated by
+ * `Allocator` (see pool_allocator.h).
+ */
+template<typename T, typename Hash = std::hash<T>,
+         typename Reclaimer = EpochBasedReclamation, typename Compare = void,
+         typename Allocator = DefaultAllocator,
+         BasicLockable Lock = TTASLock<>>
 class OptimisticList {
-  struct Node {
+  using Order = ListOrder<T, Hash, Compare>;
+  using Key = typename Order::Key;
+
+  static_assert(!Reclaimer::kRequiresReservation,
+                "OptimisticList traverses the list without validating each "
+                "hop, so it needs a reclaimer that protects whole operations");
+
+  struct Node : AllocatedBy<Allocator> {
     size_t key_{};
     std::optional<T> item_;
-    Node* next_{nullptr};
-    TTASLock mutex_;
+    std::atomic<Node*> next_{nullptr};
+    // Set, under the window locks, when unlinked
+    std::atomic<bool> removed_{false};
+    Lock mutex_;
 
     Node(size_t key) : key_(key) {}
 
-    Node(size_t key, const T& item) : key_(key), item_(item) {}
+    Node(size_t key, T item) : key_(key), item_(std::move(item)) {}
 
     auto lock() -> void { mutex_.lock(); }
 
@@ -31,62 +63,40 @@ class OptimisticList {
     size_t min_key = std::numeric_limits<size_t>::min();
     size_t max_key = std::numeric_limits<size_t>::max();
     head_ = new Node(min_key);
-    head_->next_ = new Node(max_key);
-    garbage_list_.store(new Node(max_key), std::memory_order_relaxed);
+    head_->next_.store(new Node(max_key), std::memory_order_relaxed);
   }
 
-  OptimisticList(const OptimisticList<T, Hash>&) = delete;
-  auto operator=(const OptimisticList<T, Hash>&)
-      -> OptimisticList<T, Hash>& = delete;
+  OptimisticList(const OptimisticList&) = delete;
+  auto operator=(const OptimisticList&) -> OptimisticList& = delete;
 
   ~OptimisticList() {
     // Note that the destructor is not thread-safe (i.e., it does not acquire a
     // mutex), so the caller should guarantee that no threads can access the
-    // data structure at the time the destructor is invoked.
-
-    // First, free all nodes in the garbage_list_ (logically deleted nodes)
-    // This ensures no memory is leaked from removed nodes
-    Node* node = garbage_list_.load(std::memory_order_relaxed);
-    while (node != nullptr) {
-      Node* next = node->next_;
-      delete node;
-      node = next;
-    }
-
-    // Then free all nodes still in the main list
-    node = head_;
+    // data structure at the time the destructor is invoked. Removed nodes are
+    // freed by the reclaimer.
+    Node* node = head_;
     while (node != nullptr) {
-      Node* next = node->next_;
+      Node* next = node->next_.load(std::memory_order_relaxed);
       delete node;
       node = next;
     }
   }
 
-  auto add(const T& item) -> bool {
-    size_t key = get_hash_value(item);
+  auto add(T item) -> bool {
+    Key key = order_.make_key(item);
+    OperationGuard guard(reclaimer_);
     Node* pred;
     bool key_exists = search(key, pred);
-    Node* curr = pred->next_;
+    Node* curr = pred->next_.load(std::memory_order_relaxed);
 
     if (!key_exists) {
-      Node* node = new Node(key, item);
-      node->next_ = curr;
-
-      // Without this fence, the processor or compiler might reorder operations
-      // so that pred->next_ = node executes BEFORE node->next_ = curr is
-      // complete. This would make our new node visible to other threads while
-      // its next pointer is still null, breaking the list integrity.
-      //
-      // The release fence ensures that all memory operations before this point
-      // (including node->next_ = curr) are completed before any memory
-      // operations after this point (specifically pred->next_ = node) become
-      // visible to other threads.
-      std::atomic_thread_fence(std::memory_order_release);
+      Node* node = new Node(key.hash_, std::move(item));
+      node->next_.store(curr, std::memory_order_relaxed);
 
       // This is the linearization point - the moment when the node becomes
-      // visible to other threads. After the fence, we can safely make our node
-      // visible.
-      pred->next_ = node;
+      // visible to other threads. The release store makes sure that a thread
+      // that finds the node also sees its key, item and next pointer.
+      pred->next_.store(node, std::memory_order_release);
     }
 
     curr->unlock();
@@ -96,54 +106,50 @@ class OptimisticList {
   }
 
   auto remove(const T& item) -> bool {
-    size_t key = get_hash_value(item);
+    Key key = order_.make_key(item);
+    OperationGuard guard(reclaimer_);
     Node* pred;
     bool key_exists = search(key, pred);
-    Node* curr = pred->next_;
+    Node* curr = pred->next_.load(std::memory_order_relaxed);
 
     if (key_exists) {
-      // This is the linearization point - the moment when the node is
-      // physically removed
-      pred->next_ = curr->next_;
-
-      // Without this fence, the processor might reorder operations so that
-      // we start reusing curr->next_ for the garbage list before the node
-      // is completely removed from the main list.
-      //
-      // The acquire fence ensures that all memory operations after this point
-      // (including manipulating curr->next_ for the garbage list)
-      // don't execute until all memory operations before this point
-      // (specifically pred->next_ = curr->next_) are complete.
-      std::atomic_thread_fence(std::memory_order_acquire);
-
-      // Add the node to the garbage list using lock-free approach
-      // Reuse the next_ pointer since the node is no longer in the main list
-      // The compare_exchange_weak loop ensures thread safety when multiple
-      // threads try to add nodes to the garbage list concurrently.
-      curr->next_ = garbage_list_.load(std::memory_order_relaxed);
-      while (!garbage_list_.compare_exchange_weak(curr->next_, curr,
-                                                  std::memory_order_relaxed)) {
-        // If CAS fails, curr->next_ is updated with the latest value of
-        // garbage_list_, and we retry with the updated value.
-      }
+      // Flag the node before unlinking it, so that a thread that locks it
+      // after this point fails validation instead of linking behind it. This
+      // is the linearization point: contains() no longer finds the item.
+      curr->removed_.store(true, std::memory_order_release);
+      // Release publishes the successor's fields to traversals that reach it
+      // through pred
+      pred->next_.store(curr->next_.load(std::memory_order_relaxed),
+                        std::memory_order_release);
     }
 
     // Important: unlock the nodes after all operations are complete
     curr->unlock();
     pred->unlock();
 
+    if (key_exists) {
+      // Concurrent traversals may still be reading curr (and its next_
+      // pointer), so it is freed only when the reclaimer deems it safe
+      reclaimer_.sched_for_reclaim(curr);
+    }
+
     return key_exists;
   }
 
+  /**
+   * Lock-free: walks the list once and reports a matching node unless it has
+   * already been unlinked
+   */
   auto contains(const T& item) -> bool {
-    size_t key = get_hash_value(item);
-    Node* pred;
-    bool key_exists = search(key, pred);
-
-    pred->next_->unlock();
-    pred->unlock();
-
-    return key_exists;
+    Key key = order_.make_key(item);
+    OperationGuard guard(reclaimer_);
+    // Traversals never compare the head, whose key may collide with the item
+    Node* curr = head_->next_.load(std::memory_order_acquire);
+    while (order_.precedes(curr, key)) {
+      curr = curr->next_.load(std::memory_order_acquire);
+    }
+    return order_.matches(curr, key) &&
+           !curr->removed_.load(std::memory_order_acquire);
   }
 
  private:
@@ -159,15 +165,15 @@ class OptimisticList {
    * Note: This method leaves both pred and pred->next_ locked when it returns.
    * Callers are responsible for unlocking these nodes.
    */
-  auto search(size_t key, Node*& pred) -> bool {
+  auto search(const Key& key, Node*& pred) -> bool {
     while (true) {
       pred = head_;
-      Node* curr = pred->next_;
+      Node* curr = pred->next_.load(std::memory_order_acquire);
 
       // Traverse the list without locking until we find the right position
-      while (curr->key_ < key) {
+      while (order_.precedes(curr, key)) {
         pred = curr;
-        curr = curr->next_;
+        curr = curr->next_.load(std::memory_order_acquire);
       }
 
       // Lock the nodes in order to prevent race conditions
@@ -178,7 +184,7 @@ class OptimisticList {
       // This is what makes the algorithm "optimistic" - we assume no changes
       // and verify after locking
       if (validate(pred, curr)) {
-        return curr->key_ == key;
+        return order_.matches(curr, key);
       }
 
       // If validation fails, unlock and try again
@@ -193,29 +199,21 @@ class OptimisticList {
    * This is necessary because nodes may have been removed between our traversal
    * and acquiring the locks.
    *
+   * A node is only unlinked while it and its predecessor are locked, and is
+   * flagged first, so a locked node that is not flagged is still reachable.
+   *
    * @param pred The predecessor node
    * @param curr The current node
-   * @return true if pred still points to curr, false otherwise
+   * @return true if pred is still in the list and points to curr
    */
-  auto validate(Node* pred, Node* curr) -> bool {
-    Node* node = head_;
-    while (node->key_ <= pred->key_) {
-      if (node == pred) {
-        return pred->next_ == curr;
-      }
-      node = node->next_;
-    }
-    return false;
-  }
-
-  auto get_hash_value(const T& item) const noexcept -> size_t {
-    return hash_fn_(item);
+  auto validate(Node* pred, Node* curr) const noexcept -> bool {
+    return !pred->removed_.load(std::memory_order_relaxed) &&
+           pred->next_.load(std::memory_order_relaxed) == curr;
   }
 
   Node* head_;      // Pointer to the first (sentinel) node
-  Hash hash_fn_{};  // Hash function for items
-  std::atomic<Node*>
-      garbage_list_{};  // Lock-free list of logically deleted nodes
+  Order order_{};   // Hash function and node order
+  Reclaimer reclaimer_;  // Frees removed nodes once they are unreachable
 };
 
 #endif  // OPTIMISTIC_LIST_H_
@@ -0,0 +1,368 @@
+#ifndef UNROLLED_LAZY_LIST_H_
+#define UNROLLED_LAZY_LIST_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "memory/epoch_based_reclamation.h"
+#include "memory/operation_guard.h"
+#include "synchronization/lock.h"
+#include "synchronization/ttas_lock.h"
+#include "util/backoff.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/**
+ * UnrolledLazyList - A lock-based set in an unrolled linked list, whose nodes
+ * are blocks of up to `BlockSize` sorted keys
+ *
+ * A traversal misses the cache once per block instead of once per item, and
+ * contains() compares the target with a whole block at a time using SIMD
+ * (AVX2 or SSE2 on x86, NEON on ARM). Like LazyList, it orders items by hash
+ * and treats items with equal hashes as equal; it stores only the hashes.
+ *
+ * Each block holds the keys in [low, next->low), where `low` is fixed when the
+ * block is created. Traversals take no locks. add() and remove() lock the
+ * block that holds the key and validate it as LazyList validates a window:
+ * the block must not be marked and must still cover the key. A full block is
+ * split by moving its upper half into a new successor; a block that falls
+ * below a quarter full after a removal absorbs its successor, if their keys
+ * fit into three quarters of a block, and the absorbed block is marked and
+ * freed by the `Reclaimer`. Blocks are locked left to right, so updates do not
+ * deadlock.
+ *
+ * contains() reads a block without locking it, so every block has a version
+ * that writers make odd while they change it, as in SeqLock; a reader retries
+ * if the version changed, the block was marked, or the block no longer covers
+ * the key. Keys are relaxed atomic words [Boe12]. The vectorized comparison
+ * loads them as plain words, which is what a relaxed load of a word compiles
+ * to on these targets; a torn or stale block is discarded by the version
+ * check.
+ */
+template<typename T, typename Hash = std::hash<T>,
+         typename Reclaimer = EpochBasedReclamation, size_t BlockSize = 16,
+         BasicLockable Lock = TTASLock<>>
+class UnrolledLazyList {
+  static_assert(!Reclaimer::kRequiresReservation,
+                "UnrolledLazyList traverses the list without validating each "
+                "hop, so it needs a reclaimer that protects whole operations");
+  static_assert(BlockSize >= 4 && BlockSize <= 64 && BlockSize % 4 == 0,
+                "blocks are compared four keys at a time, with a 64-bit mask");
+  static_assert(sizeof(std::atomic<size_t>) == sizeof(uint64_t));
+
+  struct Node {
+    // Sorted; only the first count_ are in the set
+    alignas(64) std::array<std::atomic<size_t>, BlockSize> keys_{};
+    std::atomic<uint64_t> version_{0};  // Odd while a writer changes the block
+    std::atomic<uint32_t> count_{0};
+    std::atomic<bool> marked_{false};  // Absorbed by its predecessor
+    std::atomic<Node*> next_{nullptr};
+    const size_t low_;  // The smallest key the block may hold
+    Lock mutex_;
+
+    explicit Node(size_t low) : low_(low) {}
+
+    auto lock() -> void { mutex_.lock(); }
+
+    auto unlock() -> void { mutex_.unlock(); }
+
+    // Brackets a change to the block, with its lock held
+    auto begin_write() -> void {
+      version_.store(version_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+      // Orders the odd version before the writes to the block
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    auto end_write() -> void {
+      version_.store(version_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+    }
+
+    auto count() const -> size_t {
+      return count_.load(std::memory_order_relaxed);
+    }
+
+    auto key(size_t i) const -> size_t {
+      return keys_[i].load(std::memory_order_relaxed);
+    }
+
+    auto set_key(size_t i, size_t key) -> void {
+      keys_[i].store(key, std::memory_order_relaxed);
+    }
+
+    // Whether the block is in the list and holds `key` if it is in the set.
+    // The successor, if any, is not freed while the caller is inside an
+    // operation.
+    auto covers(size_t key) const -> bool {
+      Node* next = next_.load(std::memory_order_acquire);
+      return !marked_.load(std::memory_order_relaxed) &&
+             (next == nullptr || key < next->low_);
+    }
+  };
+
+ public:
+  UnrolledLazyList() : head_(new Node(0)) {}
+
+  UnrolledLazyList(const UnrolledLazyList&) = delete;
+  auto operator=(const UnrolledLazyList&) -> UnrolledLazyList& = delete;
+
+  /**
+   * Destructor - Frees all blocks still in the list. Absorbed blocks are owned
+   * by the reclaimer and freed by its destructor.
+   *
+   * NOT thread-safe - caller must ensure no other threads are accessing the
+   * list
+   */
+  ~UnrolledLazyList() {
+    Node* curr = head_;
+    while (curr != nullptr) {
+      Node* next = curr->next_.load(std::memory_order_relaxed);
+      delete curr;
+      curr = next;
+    }
+  }
+
+  /**
+   * Adds an item to the set if its key doesn't already exist
+   *
+   * @param item The item to add
+   * @return true if the item was added, false if the key already exists
+   */
+  auto add(const T& item) -> bool {
+    size_t key = hash_(item);
+    OperationGuard guard(reclaimer_);
+    Node* node = lock_block(key);
+    size_t count = node->count();
+    size_t pos = lower_bound(node, count, key);
+    if (pos < count && node->key(pos) == key) {
+      node->unlock();
+      return false;
+    }
+
+    node->begin_write();
+    if (count < BlockSize) {
+      for (size_t i = count; i > pos; i--) {
+        node->set_key(i, node->key(i - 1));
+      }
+      node->set_key(pos, key);
+      node->count_.store(count + 1, std::memory_order_relaxed);
+    } else {
+      split(node, pos, key);
+    }
+    node->end_write();
+    node->unlock();
+    return true;
+  }
+
+  /**
+   * Removes an item from the set if present
+   *
+   * @param item The item to remove
+   * @return true if the item was removed, false if not found
+   */
+  auto remove(const T& item) -> bool {
+    size_t key = hash_(item);
+    OperationGuard guard(reclaimer_);
+    Node* node = lock_block(key);
+    size_t count = node->count();
+    size_t pos = lower_bound(node, count, key);
+    if (pos == count || node->key(pos) != key) {
+      node->unlock();
+      return false;
+    }
+
+    node->begin_write();
+    for (size_t i = pos; i + 1 < count; i++) {
+      node->set_key(i, node->key(i + 1));
+    }
+    node->count_.store(count - 1, std::memory_order_relaxed);
+    node->end_write();
+
+    Node* absorbed = nullptr;
+    if (count - 1 < BlockSize / 4) {
+      absorbed = try_absorb_next(node);
+    }
+    node->unlock();
+    if (absorbed != nullptr) {
+      // Readers may still be inside the absorbed block
+      reclaimer_.sched_for_reclaim(absorbed);
+    }
+    return true;
+  }
+
+  /**
+   * Checks if an item exists in the set
+   *
+   * Thread safety: Takes no locks, but retries a block that a writer changed
+   * while it was being read
+   */
+  auto contains(const T& item) -> bool {
+    size_t key = hash_(item);
+    OperationGuard guard(reclaimer_);
+    while (true) {
+      Node* node = find(key);
+      uint64_t version = node->version_.load(std::memory_order_acquire);
+      if (version % 2 == 1) {
+        cpu_relax();
+        continue;
+      }
+      bool covers = node->covers(key);
+      size_t count = std::min(node->count(), BlockSize);
+      bool found = covers && block_contains(node, count, key);
+      // Orders the reads of the block before the second read of the version
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (covers &&
+          node->version_.load(std::memory_order_relaxed) == version) {
+        return found;
+      }
+    }
+  }
+
+ private:
+  // The last block whose low key is at most `key`
+  auto find(size_t key) const -> Node* {
+    Node* node = head_;
+    Node* next = node->next_.load(std::memory_order_acquire);
+    while (next != nullptr && next->low_ <= key) {
+      node = next;
+      next = node->next_.load(std::memory_order_acquire);
+    }
+    return node;
+  }
+
+  // Finds and locks the block that holds `key` if it is in the set
+  auto lock_block(size_t key) -> Node* {
+    while (true) {
+      Node* node = find(key);
+      node->lock();
+      if (node->covers(key)) {
+        return node;
+      }
+      // Split or absorbed since find() passed it
+      node->unlock();
+    }
+  }
+
+  // The position of `key` among the first `count` keys of a locked block
+  static auto lower_bound(const Node* node, size_t count, size_t key)
+      -> size_t {
+    size_t pos = 0;
+    while (pos < count && node->key(pos) < key) {
+      pos++;
+    }
+    return pos;
+  }
+
+  // Moves the upper half of the full, locked `node`, with `key` inserted at
+  // `pos`, into a new successor
+  auto split(Node* node, size_t pos, size_t key) -> void {
+    std::array<size_t, BlockSize + 1> keys;
+    for (size_t i = 0, j = 0; i <= BlockSize; i++) {
+      keys[i] = i == pos ? key : node->key(j++);
+    }
+    size_t left_count = (BlockSize + 1) / 2;
+    auto* right = new Node(keys[left_count]);
+    for (size_t i = left_count; i <= BlockSize; i++) {
+      right->set_key(i - left_count, keys[i]);
+    }
+    right->count_.store(BlockSize + 1 - left_count, std::memory_order_relaxed);
+    right->next_.store(node->next_.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    for (size_t i = 0; i < left_count; i++) {
+      node->set_key(i, keys[i]);
+    }
+    node->count_.store(left_count, std::memory_order_relaxed);
+    // Publishes the initialized block to traversals
+    node->next_.store(right, std::memory_order_release);
+  }
+
+  // Moves the keys of the successor of the locked `node` into it, if they fit,
+  // and returns the unlinked successor
+  auto try_absorb_next(Node* node) -> Node* {
+    Node* next = node->next_.load(std::memory_order_relaxed);
+    if (next == nullptr) {
+      return nullptr;
+    }
+    // Only the locked predecessor unlinks a block, so `next` stays linked
+    next->lock();
+    size_t count = node->count();
+    size_t next_count = next->count();
+    if (count + next_count > BlockSize * 3 / 4) {
+      next->unlock();
+      return nullptr;
+    }
+    node->begin_write();
+    next->begin_write();
+    for (size_t i = 0; i < next_count; i++) {
+      node->set_key(count + i, next->key(i));
+    }
+    node->count_.store(count + next_count, std::memory_order_relaxed);
+    next->marked_.store(true, std::memory_order_relaxed);
+    node->next_.store(next->next_.load(std::memory_order_relaxed),
+                      std::memory_order_release);
+    next->end_write();
+    node->end_write();
+    next->unlock();
+    return next;
+  }
+
+  // Whether `key` is among the first `count` keys of `node`, comparing four
+  // keys at a time; the result is only meaningful once the block's version is
+  // validated
+  static auto block_contains(const Node* node, size_t count, size_t key)
+      -> bool {
+    uint64_t matches = 0;
+#if defined(__AVX2__)
+    const auto* keys = reinterpret_cast<const __m256i*>(node->keys_.data());
+    __m256i target = _mm256_set1_epi64x(static_cast<int64_t>(key));
+    for (size_t i = 0; i < BlockSize / 4; i++) {
+      __m256i equal = _mm256_cmpeq_epi64(_mm256_load_si256(keys + i), target);
+      auto lanes = static_cast<uint64_t>(
+          _mm256_movemask_pd(_mm256_castsi256_pd(equal)));
+      matches |= lanes << (4 * i);
+    }
+#elif defined(__SSE2__)
+    // SSE2 compares 32-bit halves; a key matches if both of its halves do
+    const auto* keys = reinterpret_cast<const __m128i*>(node->keys_.data());
+    __m128i target = _mm_set1_epi64x(static_cast<int64_t>(key));
+    for (size_t i = 0; i < BlockSize / 2; i++) {
+      __m128i halves = _mm_cmpeq_epi32(_mm_load_si128(keys + i), target);
+      __m128i swapped = _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1));
+      __m128i equal = _mm_and_si128(halves, swapped);
+      auto lanes = static_cast<uint64_t>(
+          _mm_movemask_pd(_mm_castsi128_pd(equal)));
+      matches |= lanes << (2 * i);
+    }
+#elif defined(__ARM_NEON)
+    const auto* keys = reinterpret_cast<const uint64_t*>(node->keys_.data());
+    uint64x2_t target = vdupq_n_u64(key);
+    for (size_t i = 0; i < BlockSize / 2; i++) {
+      uint64x2_t equal = vceqq_u64(vld1q_u64(keys + 2 * i), target);
+      uint64_t lanes = (vgetq_lane_u64(equal, 0) & 1) |
+                       (vgetq_lane_u64(equal, 1) & 2);
+      matches |= lanes << (2 * i);
+    }
+#else
+    for (size_t i = 0; i < BlockSize; i++) {
+      matches |= static_cast<uint64_t>(node->key(i) == key) << i;
+    }
+#endif
+    uint64_t valid = count >= 64 ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+    return (matches & valid) != 0;
+  }
+
+  Node* const head_;  // Never absorbed; holds the keys below the second block
+  Hash hash_;
+  Reclaimer reclaimer_;
+};
+
+#endif  // UNROLLED_LAZY_LIST_H_
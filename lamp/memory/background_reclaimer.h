@@ -0,0 +1,184 @@
+#ifndef BACKGROUND_RECLAIMER_H_
+#define BACKGROUND_RECLAIMER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "queue/mpsc_queue.h"
+
+template<typename T>
+void do_delete(void* ptr) {
+  delete static_cast<T*>(ptr);
+}
+
+/**
+ * A retired pointer together with the type-erased function that frees it. It
+ * is stored by value in the per-thread retire list, so retiring a pointer does
+ * not allocate (beyond the amortized growth of the list itself).
+ */
+struct data_to_reclaim {
+  void* data_;
+  void (*deleter_)(void*);
+
+  template<typename T>
+  data_to_reclaim(T* ptr) : data_(ptr), deleter_(&do_delete<T>) {}
+
+  data_to_reclaim(void* ptr, void (*deleter)(void*))
+      : data_(ptr), deleter_(deleter) {}
+
+  auto reclaim() const -> void { deleter_(data_); }
+};
+
+/**
+ * BackgroundReclaimer - A thread that frees retired pointers on behalf of the
+ * reclamation domains
+ *
+ * Once a domain has decided that a batch of retired pointers is safe to free,
+ * it normally calls every deleter itself, in whichever operation happened to
+ * trigger the reclamation. While a BackgroundReclaimer is installed, domains
+ * hand such batches to it instead: a batch is moved into a node of an
+ * IntrusiveMPSCQueue with one allocation and one exchange, and the
+ * reclaimer's thread runs the deleters. Destructor and `delete` costs thus
+ * leave the operations of the worker threads, which smooths their tail
+ * latency. Nodes of a pool (see pool_allocator.h) are returned to the
+ * reclaimer thread's cache, which passes full batches back to the other
+ * threads through the pool's depot.
+ *
+ * At most one reclaimer is installed at a time, process-wide; install() and
+ * uninstall() must not race with operations of data structures that use it.
+ * The destructor uninstalls the reclaimer and frees everything it was handed.
+ */
+class BackgroundReclaimer {
+  struct Batch : MPSCHook {
+    std::vector<data_to_reclaim> items_;
+  };
+
+ public:
+  BackgroundReclaimer() : thread_([this]() { run(); }) {}
+
+  BackgroundReclaimer(const BackgroundReclaimer&) = delete;
+  auto operator=(const BackgroundReclaimer&) -> BackgroundReclaimer& = delete;
+
+  ~BackgroundReclaimer() {
+    uninstall();
+    stopping_.store(true, std::memory_order_release);
+    // Wakes the thread up without a batch
+    submitted_.fetch_add(1, std::memory_order_release);
+    submitted_.notify_one();
+    thread_.join();
+  }
+
+  /**
+   * @brief Make the domains hand their batches to this reclaimer
+   */
+  auto install() -> void { installed_.store(this, std::memory_order_release); }
+
+  /**
+   * @brief Make the domains free their batches themselves again. Batches that
+   * were already handed over are still freed by this reclaimer.
+   */
+  auto uninstall() -> void {
+    BackgroundReclaimer* self = this;
+    installed_.compare_exchange_strong(self, nullptr,
+                                       std::memory_order_acq_rel);
+  }
+
+  /**
+   * @brief The installed reclaimer, or nullptr
+   */
+  static auto installed() -> BackgroundReclaimer* {
+    return installed_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Take over `items` to free them later, leaving `items` empty
+   *
+   * Wait-free, apart from allocating the batch.
+   */
+  auto submit(std::vector<data_to_reclaim>& items) -> void {
+    auto batch = new Batch();
+    batch->items_.swap(items);
+    queue_.enqueue(batch);
+    submitted_.fetch_add(1, std::memory_order_release);
+    // Only a system call if the reclaimer thread is asleep
+    submitted_.notify_one();
+  }
+
+  /**
+   * @brief Wait until every batch submitted before the call has been freed
+   */
+  auto drain() -> void {
+    uint64_t target = submitted_.load(std::memory_order_acquire);
+    uint64_t done = freed_.load(std::memory_order_acquire);
+    while (done < target) {
+      freed_.wait(done, std::memory_order_acquire);
+      done = freed_.load(std::memory_order_acquire);
+    }
+  }
+
+  /**
+   * @brief The number of pointers this reclaimer has freed so far
+   */
+  auto num_freed() const -> uint64_t {
+    return num_freed_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  auto run() -> void {
+    while (true) {
+      uint64_t seen = submitted_.load(std::memory_order_acquire);
+      uint64_t batches = 0;
+      while (Batch* batch = queue_.try_dequeue()) {
+        for (const auto& reclaim_obj : batch->items_) {
+          reclaim_obj.reclaim();
+        }
+        num_freed_.fetch_add(batch->items_.size(), std::memory_order_relaxed);
+        delete batch;
+        batches++;
+      }
+      if (batches > 0) {
+        freed_.fetch_add(batches, std::memory_order_release);
+        freed_.notify_all();
+      }
+      if (stopping_.load(std::memory_order_acquire)) {
+        // Nothing is submitted once the destructor runs
+        return;
+      }
+      // A producer that enqueued after the drain above has also incremented
+      // `submitted_` past `seen`
+      submitted_.wait(seen, std::memory_order_acquire);
+    }
+  }
+
+  IntrusiveMPSCQueue<Batch> queue_;
+  // The number of batches submitted and freed; both only grow
+  std::atomic<uint64_t> submitted_{0};
+  std::atomic<uint64_t> freed_{0};
+  std::atomic<uint64_t> num_freed_{0};
+  std::atomic<bool> stopping_{false};
+  std::thread thread_;
+
+  static inline std::atomic<BackgroundReclaimer*> installed_{nullptr};
+};
+
+/**
+ * Frees `items` on the installed BackgroundReclaimer, or right away if there
+ * is none, and leaves `items` empty
+ */
+inline auto reclaim_all(std::vector<data_to_reclaim>& items) -> void {
+  if (items.empty()) {
+    return;
+  }
+  if (BackgroundReclaimer* reclaimer = BackgroundReclaimer::installed()) {
+    reclaimer->submit(items);
+    return;
+  }
+  for (const auto& reclaim_obj : items) {
+    reclaim_obj.reclaim();
+  }
+  items.clear();
+}
+
+#endif  // BACKGROUND_RECLAIMER_H_
@@ -0,0 +1,229 @@
+#ifndef EPOCH_BASED_RECLAMATION_H_
+#define EPOCH_BASED_RECLAMATION_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "memory/background_reclaimer.h"
+#include "memory/thread_registry.h"
+
+/**
+ * EpochBasedReclamation - Epoch-based safe memory reclamation [Fra04]
+ *
+ * A global epoch counter is advanced once every thread that is inside an
+ * operation has announced the current epoch. A pointer retired while the
+ * global epoch is `e` can no longer be referenced once the global epoch
+ * reaches `e + 2`, since every operation that could have observed it has
+ * finished by then. Each thread keeps three limbo lists, one per epoch modulo
+ * three, and frees a list as soon as it becomes two epochs old.
+ *
+ * Compared to HazardPtr, readers pay a single announcement per operation
+ * instead of a store and a fence per dereferenced node, at the cost of
+ * unbounded garbage if a thread stalls inside an operation.
+ *
+ * The class exposes the same interface as HazardPtr, so data structures can
+ * be templated on the reclamation policy. `try_reserve()` and `unreserve()`
+ * are no-ops: everything read between `op_begin()` and `op_end()` is
+ * protected. Operations may be nested; only the outermost pair announces.
+ * Expired limbo lists go to the installed BackgroundReclaimer, if any.
+ */
+class EpochBasedReclamation {
+  static constexpr size_t kNumLimboLists = 3;
+
+  struct ThreadContext : RegistryNode<ThreadContext> {
+    // (epoch << 1) | 1 while the thread is inside an operation, 0 otherwise.
+    std::atomic<uint64_t> announced_{0};
+    size_t nesting_{0};
+    size_t retired_since_advance_{0};
+    std::array<std::vector<data_to_reclaim>, kNumLimboLists> limbo_;
+    // The epoch in which the pointers of each limbo list were retired.
+    std::array<uint64_t, kNumLimboLists> limbo_epoch_{};
+  };
+
+ public:
+  // Everything read inside an operation is protected, so data structures need
+  // not reserve individual nodes.
+  static constexpr bool kRequiresReservation = false;
+
+  EpochBasedReclamation() = default;
+
+  EpochBasedReclamation(const EpochBasedReclamation&) = delete;
+  auto operator=(const EpochBasedReclamation&)
+      -> EpochBasedReclamation& = delete;
+
+  ~EpochBasedReclamation() {
+    // Note that the destructor is not thread-safe, so the caller should
+    // guarantee that no threads can access the domain at this point.
+    for (ThreadContext* curr = registry_.head(); curr != nullptr;
+         curr = curr->next_) {
+      for (auto& limbo : curr->limbo_) {
+        free_all(limbo);
+      }
+    }
+  }
+
+  /**
+   * @brief Register the calling thread. Optional: threads are registered on
+   * their first operation.
+   * @param num ignored; kept for interface compatibility with HazardPtr
+   */
+  auto register_thread(size_t = 0) -> void { self(); }
+
+  /**
+   * @brief Called once, after the last call to op_end(). Releases the calling
+   * thread's context so that another thread can adopt it (together with any
+   * retired pointers that could not be reclaimed yet).
+   */
+  auto unregister_thread() -> void {
+    ThreadContext* context = registry_.find();
+    if (context != nullptr) {
+      reclaim_expired(context, global_epoch_.load(std::memory_order_acquire));
+      registry_.release(context);
+    }
+  }
+
+  /**
+   * @brief Indicate the beginning of a concurrent operation by announcing the
+   * current global epoch
+   */
+  auto op_begin() -> void {
+    ThreadContext* context = self();
+    if (context->nesting_++ > 0) {
+      return;
+    }
+    uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+    context->announced_.store((epoch << 1) | 1, std::memory_order_relaxed);
+    // The announcement must be visible before any shared node is read; pairs
+    // with the fence in `try_advance()`.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    reclaim_expired(context, epoch);
+  }
+
+  /**
+   * @brief Retire a pointer that has already been unlinked from the data
+   * structure. It is freed two epochs later.
+   * @tparam T the type of the data pointed by the pointer; need to know the
+   * data type for deallocation
+   * @param ptr the pointer to reclaim
+   * @param deleter frees the pointer; `delete` by default
+   */
+  template<typename T>
+  auto sched_for_reclaim(T* ptr, void (*deleter)(void*) = &do_delete<T>)
+      -> void {
+    ThreadContext* context = self();
+    // The epoch is read after the unlink, so it is an upper bound of the
+    // epoch in which the pointer was still reachable.
+    uint64_t epoch = global_epoch_.load(std::memory_order_seq_cst);
+    size_t index = epoch % kNumLimboLists;
+    if (context->limbo_epoch_[index] != epoch) {
+      // The list holds pointers retired at least three epochs ago.
+      reclaim_all(context->limbo_[index]);
+      context->limbo_epoch_[index] = epoch;
+    }
+    context->limbo_[index].emplace_back(ptr, deleter);
+
+    if (++context->retired_since_advance_ >= kAdvanceInterval) {
+      context->retired_since_advance_ = 0;
+      try_advance();
+      reclaim_expired(context, global_epoch_.load(std::memory_order_acquire));
+    }
+  }
+
+  /**
+   * @brief No-op: pointers read inside an operation are always protected
+   */
+  auto try_reserve(void*) -> bool { return true; }
+
+  /**
+   * @brief No-op: pointers read inside an operation are always protected
+   */
+  auto unreserve(void*) -> void {}
+
+  /**
+   * @brief Indicate the end of a concurrent operation
+   */
+  auto op_end() -> void {
+    ThreadContext* context = self();
+    if (--context->nesting_ == 0) {
+      context->announced_.store(0, std::memory_order_release);
+    }
+  }
+
+  /**
+   * @brief Try to advance the epoch far enough to reclaim every pointer the
+   * calling thread has retired. Only succeeds if no other thread is lagging
+   * behind inside an operation.
+   */
+  auto flush() -> void {
+    ThreadContext* context = self();
+    for (size_t i = 0; i < kNumLimboLists; i++) {
+      try_advance();
+    }
+    reclaim_expired(context, global_epoch_.load(std::memory_order_acquire));
+  }
+
+  /**
+   * @brief The number of retired pointers of the calling thread that are
+   * waiting to be reclaimed (for testing and debugging)
+   */
+  auto num_pending() -> size_t {
+    size_t count = 0;
+    for (const auto& limbo : self()->limbo_) {
+      count += limbo.size();
+    }
+    return count;
+  }
+
+ private:
+  auto self() -> ThreadContext* {
+    return registry_.self([]() { return new ThreadContext(); });
+  }
+
+  /**
+   * @brief Advance the global epoch if every active thread has announced it
+   * @return true if the epoch was advanced (by this or another thread)
+   */
+  auto try_advance() -> bool {
+    uint64_t epoch = global_epoch_.load(std::memory_order_seq_cst);
+    for (ThreadContext* curr = registry_.head(); curr != nullptr;
+         curr = curr->next_) {
+      uint64_t announced = curr->announced_.load(std::memory_order_seq_cst);
+      if ((announced & 1) != 0 && (announced >> 1) != epoch) {
+        return false;
+      }
+    }
+    // If the exchange fails, another thread has already advanced the epoch.
+    global_epoch_.compare_exchange_strong(epoch, epoch + 1,
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_relaxed);
+    return true;
+  }
+
+  // Free the limbo lists that are at least two epochs older than `epoch`.
+  static auto reclaim_expired(ThreadContext* context, uint64_t epoch) -> void {
+    for (size_t i = 0; i < kNumLimboLists; i++) {
+      if (!context->limbo_[i].empty() &&
+          context->limbo_epoch_[i] + 2 <= epoch) {
+        reclaim_all(context->limbo_[i]);
+      }
+    }
+  }
+
+  static auto free_all(std::vector<data_to_reclaim>& limbo) -> void {
+    for (const auto& reclaim_obj : limbo) {
+      reclaim_obj.reclaim();
+    }
+    limbo.clear();
+  }
+
+  // The number of retirements between two attempts to advance the epoch.
+  static constexpr size_t kAdvanceInterval = 64;
+
+  std::atomic<uint64_t> global_epoch_{0};
+  ThreadRegistry<ThreadContext> registry_;
+};
+
+#endif  // EPOCH_BASED_RECLAMATION_H_
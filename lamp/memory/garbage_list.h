@@ -0,0 +1,81 @@
+#ifndef GARBAGE_LIST_H_
+#define GARBAGE_LIST_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "memory/background_reclaimer.h"
+#include "memory/thread_registry.h"
+
+/**
+ * GarbageList - Defers every reclamation until the domain is destroyed
+ *
+ * Retired pointers are appended to a per-thread list and only freed by the
+ * destructor. It never frees memory that is still in use and costs nothing on
+ * the read path, but memory grows with the number of removals. Useful as a
+ * baseline, and for short-lived data structures.
+ *
+ * The class exposes the same interface as HazardPtr and EpochBasedReclamation.
+ */
+class GarbageList {
+  struct ThreadContext : RegistryNode<ThreadContext> {
+    std::vector<data_to_reclaim> garbage_;
+  };
+
+ public:
+  // Nothing is freed before the destructor, so data structures need not
+  // reserve individual nodes.
+  static constexpr bool kRequiresReservation = false;
+
+  GarbageList() = default;
+
+  GarbageList(const GarbageList&) = delete;
+  auto operator=(const GarbageList&) -> GarbageList& = delete;
+
+  ~GarbageList() {
+    // Note that the destructor is not thread-safe, so the caller should
+    // guarantee that no threads can access the domain at this point.
+    for (ThreadContext* curr = registry_.head(); curr != nullptr;
+         curr = curr->next_) {
+      for (const auto& reclaim_obj : curr->garbage_) {
+        reclaim_obj.reclaim();
+      }
+    }
+  }
+
+  auto register_thread(size_t = 0) -> void { self(); }
+
+  auto unregister_thread() -> void {
+    ThreadContext* context = registry_.find();
+    if (context != nullptr) {
+      registry_.release(context);
+    }
+  }
+
+  auto op_begin() -> void {}
+
+  template<typename T>
+  auto sched_for_reclaim(T* ptr, void (*deleter)(void*) = &do_delete<T>)
+      -> void {
+    self()->garbage_.emplace_back(ptr, deleter);
+  }
+
+  auto try_reserve(void*) -> bool { return true; }
+
+  auto unreserve(void*) -> void {}
+
+  auto op_end() -> void {}
+
+  auto flush() -> void {}
+
+  auto num_pending() -> size_t { return self()->garbage_.size(); }
+
+ private:
+  auto self() -> ThreadContext* {
+    return registry_.self([]() { return new ThreadContext(); });
+  }
+
+  ThreadRegistry<ThreadContext> registry_;
+};
+
+#endif  // GARBAGE_LIST_H_
@@ -1,90 +1,129 @@
 #ifndef HAZARD_PTR_
 #define HAZARD_PTR_
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
-#include <functional>
 #include <stdexcept>
 #include <vector>
 
-template<typename T>
-void do_delete(void* ptr) {
-  delete static_cast<T*>(ptr);
-}
-
-struct data_to_reclaim {
-  void* data_;
-  std::function<void(void*)> deleter_;
-
-  template<typename T>
-  data_to_reclaim(T* ptr) : data_(ptr), deleter_(&do_delete<T>) {}
-
-  ~data_to_reclaim() { deleter_(data_); }
-};
-
+#include "memory/background_reclaimer.h"
+#include "memory/thread_registry.h"
+
+/**
+ * HazardPtr - Hazard pointer based safe memory reclamation [Mic04]
+ *
+ * Every thread owns a small, fixed number of reservation slots in which it
+ * publishes the pointers it is about to dereference. Retired pointers are
+ * buffered in a per-thread list, and only when that list grows past a
+ * threshold proportional to the total number of reservation slots H does the
+ * thread take a single snapshot of all reservations, sort it, and free every
+ * retired pointer that is not in the snapshot. Since at most H pointers can be
+ * reserved, each scan frees at least half of the batch, which makes the cost
+ * of reclamation amortized O(log H) per retired pointer instead of
+ * O(threads x slots).
+ *
+ * Threads are registered lazily on first use (with the number of reservations
+ * given to the constructor), or explicitly via `register_thread()`. A thread
+ * can use several HazardPtr instances at the same time.
+ */
 class HazardPtr {
-  struct ThreadContext {
-    std::vector<data_to_reclaim*> pending_reclaims_;
+  struct ThreadContext : RegistryNode<ThreadContext> {
+    std::vector<data_to_reclaim> pending_reclaims_;
     std::vector<std::atomic<void*>> reservations_;
-    ThreadContext* next_{};
+    std::vector<void*> snapshot_;  // Scratch buffer reused across scans
+    std::vector<data_to_reclaim> expired_;  // The pointers a scan frees
 
-    ThreadContext(size_t num, HazardPtr* hazard_ptr) : reservations_(num) {
+    explicit ThreadContext(size_t num) : reservations_(num) {
       for (auto& reservation : reservations_) {
         reservation.store(nullptr, std::memory_order_relaxed);
       }
-
-      // Add this thread context to the list of thread contexts managed by the
-      // hazard pointer object
-      next_ = hazard_ptr->head_.load(std::memory_order_acquire);
-      while (!hazard_ptr->head_.compare_exchange_weak(
-          next_, this, std::memory_order_release, std::memory_order_acquire)) {}
     }
   };
 
  public:
+  explicit HazardPtr(size_t num_reservations = kDefaultReservations)
+      : kNumReservations(num_reservations) {}
+
+  HazardPtr(const HazardPtr&) = delete;
+  auto operator=(const HazardPtr&) -> HazardPtr& = delete;
+
+  ~HazardPtr() {
+    // Note that the destructor is not thread-safe, so the caller should
+    // guarantee that no threads can access the domain at this point. The
+    // contexts themselves are freed by the registry.
+    for (ThreadContext* curr = registry_.head(); curr != nullptr;
+         curr = curr->next_) {
+      for (const auto& reclaim_obj : curr->pending_reclaims_) {
+        reclaim_obj.reclaim();
+      }
+    }
+  }
+
   /**
-   * @brief Called once, before any call to op_begin()
+   * @brief Register the calling thread. Optional: threads are registered with
+   * the default number of reservations on their first operation.
    * @param num the maximum number of locations the caller can reserve
    */
   auto register_thread(size_t num) -> void {
-    self_ = new ThreadContext(num, this);
+    ThreadContext* context = registry_.find();
+    if (context != nullptr) {
+      if (context->reservations_.size() >= num) {
+        return;
+      }
+      release_context(context);
+    }
+    acquire_context(num);
   }
 
   /**
-   * @brief Called once, after the last call to op_end()
+   * @brief Called once, after the last call to op_end(). Releases the calling
+   * thread's context so that another thread can adopt it (together with any
+   * retired pointers that could not be reclaimed yet).
    */
   auto unregister_thread() -> void {
-    // no-op
+    ThreadContext* context = registry_.find();
+    if (context != nullptr) {
+      release_context(context);
+    }
   }
 
   /**
    * @brief Indicate the beginning of a concurrent operation
    */
-  auto op_begin() -> void {
-    // no-op
-  }
+  auto op_begin() -> void { self(); }
 
   /**
-   * @brief Try to reclaim a pointer
+   * @brief Retire a pointer. It is freed once no thread reserves it, the
+   * next time the calling thread's retire list crosses the scan threshold.
    * @tparam T the type of the data pointed by the pointer; need to know the
    * data type for deallocation
    * @param ptr the pointer to reclaim
+   * @param deleter frees the pointer; `delete` by default
    */
   template<typename T>
-  auto sched_for_reclaim(T* ptr) -> void {
-    self_->pending_reclaims_.push_back(new data_to_reclaim(ptr));
+  auto sched_for_reclaim(T* ptr, void (*deleter)(void*) = &do_delete<T>)
+      -> void {
+    ThreadContext* context = self();
+    context->pending_reclaims_.emplace_back(ptr, deleter);
+    if (context->pending_reclaims_.size() >= scan_threshold()) {
+      scan(context);
+    }
   }
 
   /**
-   * @brief Try to protect a pointer from reclamation
+   * @brief Try to protect a pointer from reclamation. The caller must
+   * re-validate that `ptr` is still reachable after this call returns.
    * @param ptr the pointer to protect
    * @return return true if we can reserve a spot to protect the pointer;
    * otherwise, throw an exception
    */
   auto try_reserve(void* ptr) -> bool {
-    for (auto& reservation : self_->reservations_) {
+    for (auto& reservation : self()->reservations_) {
       if (reservation.load(std::memory_order_relaxed) == nullptr) {
-        reservation.store(ptr, std::memory_order_release);
+        // The store must be ordered before the caller's validating load;
+        // pairs with the fence in `scan()`.
+        reservation.store(ptr, std::memory_order_seq_cst);
         return true;
       }
     }
@@ -96,7 +135,7 @@ class HazardPtr {
    * @param ptr the pointer to stop protecting
    */
   auto unreserve(void* ptr) -> void {
-    for (auto& reservation : self_->reservations_) {
+    for (auto& reservation : self()->reservations_) {
       if (reservation.load(std::memory_order_relaxed) == ptr) {
         reservation.store(nullptr, std::memory_order_release);
       }
@@ -106,49 +145,109 @@ class HazardPtr {
   /**
    * @brief Indicate the end of a concurrent operation
    */
-  auto op_end() -> void {
-    for (auto& reservation : self_->reservations_) {
-      reservation.store(nullptr, std::memory_order_release);
-    }
+  auto op_end() -> void { clear_reservations(self()); }
 
-    auto it = self_->pending_reclaims_.begin();
-    while (it != self_->pending_reclaims_.end()) {
-      data_to_reclaim* reclaim_obj = *it;
-      if (is_unreserved(reclaim_obj->data_)) {
-        it = self_->pending_reclaims_.erase(it);
-        delete reclaim_obj;
-      } else {
-        ++it;
-      }
+  /**
+   * @brief Reclaim every retired pointer of the calling thread that is not
+   * currently reserved, regardless of the scan threshold.
+   */
+  auto flush() -> void { scan(self()); }
+
+  /**
+   * @brief The number of retired pointers of the calling thread that are
+   * waiting to be reclaimed (for testing and debugging)
+   */
+  auto num_pending() -> size_t { return self()->pending_reclaims_.size(); }
+
+  static constexpr size_t kDefaultReservations = 4;
+
+  // Data structures must reserve, and validate, every node before dereferencing
+  // it.
+  static constexpr bool kRequiresReservation = true;
+
+ private:
+  auto self() -> ThreadContext* {
+    return registry_.self([this]() { return make_context(kNumReservations); });
+  }
+
+  auto make_context(size_t num) -> ThreadContext* {
+    num_reservations_.fetch_add(num, std::memory_order_relaxed);
+    return new ThreadContext(num);
+  }
+
+  // Adopt a context released by an exited thread, or add a new one.
+  auto acquire_context(size_t num) -> ThreadContext* {
+    return registry_.acquire(
+        [num](ThreadContext* context) {
+          return context->reservations_.size() >= num;
+        },
+        [this, num]() { return make_context(num); });
+  }
+
+  auto release_context(ThreadContext* context) -> void {
+    clear_reservations(context);
+    scan(context);
+    registry_.release(context);
+  }
+
+  auto scan_threshold() const -> size_t {
+    return std::max(kMinScanThreshold,
+                    kScanFactor *
+                        num_reservations_.load(std::memory_order_relaxed));
+  }
+
+  static auto clear_reservations(ThreadContext* context) -> void {
+    for (auto& reservation : context->reservations_) {
+      reservation.store(nullptr, std::memory_order_release);
     }
   }
 
- private:
   /**
-   * @brief Checks whether the pointer is currently reserved by any threads
-   * @param ptr the pointer to check
-   * @return true if the pointer is not reserved by any threads; otherwise,
-   * return false
+   * @brief Take one snapshot of all reservations and free every pending
+   * reclaim of `context` that does not appear in it
    */
-  auto is_unreserved(void* ptr) -> bool {
-    ThreadContext* curr = head_.load(std::memory_order_acquire);
-    while (curr != nullptr) {
+  auto scan(ThreadContext* context) -> void {
+    // Pairs with the seq_cst store in `try_reserve()`: either the reserving
+    // thread's validation observes the unlink that preceded the retirement,
+    // or this snapshot observes its reservation.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::vector<void*>& snapshot = context->snapshot_;
+    snapshot.clear();
+    for (ThreadContext* curr = registry_.head(); curr != nullptr;
+         curr = curr->next_) {
       for (const auto& reservation : curr->reservations_) {
-        if (reservation.load(std::memory_order_acquire) == ptr) {
-          return false;
+        void* ptr = reservation.load(std::memory_order_acquire);
+        if (ptr != nullptr) {
+          snapshot.push_back(ptr);
         }
       }
-      curr = curr->next_;
     }
-
-    return true;
+    std::sort(snapshot.begin(), snapshot.end());
+
+    auto& pending = context->pending_reclaims_;
+    auto& expired = context->expired_;
+    auto end = std::remove_if(pending.begin(), pending.end(),
+                              [&](const data_to_reclaim& reclaim_obj) {
+                                if (std::binary_search(snapshot.begin(),
+                                                       snapshot.end(),
+                                                       reclaim_obj.data_)) {
+                                  return false;
+                                }
+                                expired.push_back(reclaim_obj);
+                                return true;
+                              });
+    pending.erase(end, pending.end());
+    // Freed here, or by the installed BackgroundReclaimer
+    reclaim_all(expired);
   }
 
-  static thread_local ThreadContext* self_;
-  std::atomic<ThreadContext*> head_{nullptr};
-};
+  static constexpr size_t kScanFactor = 2;
+  static constexpr size_t kMinScanThreshold = 64;
 
-// Define the thread_local static member
-thread_local HazardPtr::ThreadContext* HazardPtr::self_ = nullptr;
+  const size_t kNumReservations;
+  std::atomic<size_t> num_reservations_{0};  // H: total reservation slots
+  ThreadRegistry<ThreadContext> registry_;
+};
 
 #endif  // HAZARD_PTR_
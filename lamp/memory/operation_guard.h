@@ -0,0 +1,26 @@
+#ifndef OPERATION_GUARD_H_
+#define OPERATION_GUARD_H_
+
+/**
+ * OperationGuard - Brackets a data structure operation with the reclaimer's
+ * `op_begin()` and `op_end()`, so that every exit path ends the operation
+ */
+template<typename Reclaimer>
+class OperationGuard {
+ public:
+  explicit OperationGuard(Reclaimer& reclaimer) : reclaimer_(reclaimer) {
+    reclaimer_.op_begin();
+  }
+
+  OperationGuard(const OperationGuard<Reclaimer>&) = delete;
+
+  auto operator=(const OperationGuard<Reclaimer>&)
+      -> OperationGuard<Reclaimer>& = delete;
+
+  ~OperationGuard() { reclaimer_.op_end(); }
+
+ private:
+  Reclaimer& reclaimer_;
+};
+
+#endif  // OPERATION_GUARD_H_
@@ -0,0 +1,267 @@
+#ifndef POOL_ALLOCATOR_H_
+#define POOL_ALLOCATOR_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "util/cache_aligned.h"
+
+/**
+ * Node allocation policies
+ *
+ * The data structures allocate their nodes with plain `new` and `delete`, and
+ * reclaimers free retired nodes with `delete` as well. A node type picks its
+ * allocation policy by deriving from `AllocatedBy<Allocator>`, which routes
+ * both to `Allocator::allocate()` and `Allocator::deallocate()`. Since a
+ * reclaimer only deletes a node once no thread can reference it, a pooled node
+ * is never recycled while it is still in use.
+ */
+
+/**
+ * DefaultAllocator - Allocates nodes with the global operator new
+ */
+struct DefaultAllocator {
+  static auto allocate(size_t size) -> void* { return ::operator new(size); }
+
+  static auto deallocate(void* ptr, size_t size) -> void {
+    ::operator delete(ptr, size);
+  }
+};
+
+/**
+ * NodePool - A pool of fixed-size blocks shared by all threads
+ *
+ * Each thread allocates from and frees to its own cache of free blocks, so
+ * the common path touches no shared memory. Caches exchange blocks with a
+ * central lock-free depot in batches of kBatchSize: a thread that runs out
+ * takes a whole batch, and a thread that frees more than it allocates (e.g.,
+ * the thread that reclaims the nodes removed by others) gives one back. Only
+ * when the depot is empty does the pool allocate a new cache-line-aligned slab
+ * from the system.
+ *
+ * Slabs are never returned to the system: the pool grows to the peak number of
+ * blocks in use, and blocks keep being recycled among threads afterwards.
+ */
+class NodePool {
+  // A free block. Blocks are at least two pointers large, and the link to the
+  // next batch is only valid in the first block of a batch in the depot.
+  struct FreeBlock {
+    FreeBlock* next_;
+    FreeBlock* next_batch_;
+  };
+
+  struct Cache {
+    FreeBlock* head_{nullptr};
+    size_t size_{0};
+    NodePool* pool_{nullptr};
+
+    ~Cache() {
+      // Hand the blocks of an exiting thread to the other threads
+      if (head_ != nullptr) {
+        pool_->push_batch(head_);
+      }
+    }
+  };
+
+ public:
+  static constexpr size_t kBatchSize = 64;
+  static constexpr size_t kSlabAlignment = kCacheLineSize;
+
+  explicit NodePool(size_t block_size) : block_size_(block_size) {}
+
+  NodePool(const NodePool&) = delete;
+  auto operator=(const NodePool&) -> NodePool& = delete;
+
+  /**
+   * @brief Take a block from the calling thread's cache
+   * @param cache the calling thread's cache of this pool
+   */
+  auto allocate(Cache& cache) -> void* {
+    if (cache.head_ == nullptr) [[unlikely]] {
+      refill(cache);
+    }
+    FreeBlock* block = cache.head_;
+    cache.head_ = block->next_;
+    cache.size_--;
+    return block;
+  }
+
+  /**
+   * @brief Return a block to the calling thread's cache, and give a batch
+   * back to the depot if the cache has grown too large
+   * @param cache the calling thread's cache of this pool
+   */
+  auto deallocate(Cache& cache, void* ptr) -> void {
+    auto block = static_cast<FreeBlock*>(ptr);
+    // A thread may free blocks of a pool it never allocated from
+    cache.pool_ = this;
+    block->next_ = cache.head_;
+    cache.head_ = block;
+    if (++cache.size_ >= 2 * kBatchSize) [[unlikely]] {
+      FreeBlock* batch = cache.head_;
+      FreeBlock* last = batch;
+      for (size_t i = 1; i < kBatchSize; i++) {
+        last = last->next_;
+      }
+      cache.head_ = last->next_;
+      cache.size_ -= kBatchSize;
+      last->next_ = nullptr;
+      push_batch(batch);
+    }
+  }
+
+ private:
+  friend class PoolAllocator;
+
+  auto refill(Cache& cache) -> void {
+    cache.pool_ = this;
+    FreeBlock* batch = pop_batch();
+    if (batch == nullptr) {
+      batch = allocate_slab();
+    }
+    cache.head_ = batch;
+    cache.size_ = 0;
+    for (FreeBlock* block = batch; block != nullptr; block = block->next_) {
+      cache.size_++;
+    }
+  }
+
+  // Carve a new slab into a batch of kBatchSize blocks
+  auto allocate_slab() -> FreeBlock* {
+    auto slab = static_cast<std::byte*>(::operator new(
+        block_size_ * kBatchSize, std::align_val_t{kSlabAlignment}));
+    FreeBlock* next = nullptr;
+    for (size_t i = kBatchSize; i-- > 0;) {
+      auto block = reinterpret_cast<FreeBlock*>(slab + i * block_size_);
+      block->next_ = next;
+      next = block;
+    }
+    return next;
+  }
+
+  auto push_batch(FreeBlock* batch) -> void {
+    uint64_t head = depot_.load(std::memory_order_relaxed);
+    do {
+      batch->next_batch_ = unpack(head);
+      // Release publishes the links of the batch to the thread that pops it
+    } while (!depot_.compare_exchange_weak(head, pack(batch, head),
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+  }
+
+  auto pop_batch() -> FreeBlock* {
+    uint64_t head = depot_.load(std::memory_order_acquire);
+    while (unpack(head) != nullptr) {
+      // Blocks are never returned to the system, so the read is safe even if
+      // the batch was popped concurrently, and the tag makes the CAS fail in
+      // that case
+      FreeBlock* next = unpack(head)->next_batch_;
+      if (depot_.compare_exchange_weak(head, pack(next, head),
+                                       std::memory_order_acquire,
+                                       std::memory_order_acquire)) {
+        return unpack(head);
+      }
+    }
+    return nullptr;
+  }
+
+  // The depot head packs a pointer and a tag that is bumped on every update to
+  // prevent ABA, so that it fits in a single word. User-space addresses use
+  // the lower kAddressBits bits.
+  static constexpr int kAddressBits = 48;
+  static constexpr uint64_t kAddressMask = (uint64_t{1} << kAddressBits) - 1;
+
+  static auto pack(FreeBlock* block, uint64_t prev) -> uint64_t {
+    uint64_t tag = (prev >> kAddressBits) + 1;
+    return (tag << kAddressBits) | reinterpret_cast<uintptr_t>(block);
+  }
+
+  static auto unpack(uint64_t word) -> FreeBlock* {
+    return reinterpret_cast<FreeBlock*>(word & kAddressMask);
+  }
+
+  const size_t block_size_;
+  std::atomic<uint64_t> depot_{0};  // Lock-free stack of batches
+};
+
+/**
+ * PoolAllocator - Allocates nodes from per-thread caches of NodePools
+ *
+ * Sizes are rounded up to a multiple of kGranularity, and each size class has
+ * its own pool. Since every type's size is a multiple of its alignment and
+ * slabs are cache-line-aligned, blocks are suitably aligned for any type whose
+ * alignment is at most kSlabAlignment. Larger objects are allocated with the
+ * global operator new.
+ */
+class PoolAllocator {
+ public:
+  static constexpr size_t kGranularity = 16;
+  static constexpr size_t kMaxPooledSize = 512;
+
+  static auto allocate(size_t size) -> void* {
+    if (size > kMaxPooledSize) [[unlikely]] {
+      return ::operator new(size);
+    }
+    size_t index = size_class(size);
+    return pools()[index].allocate(caches()[index]);
+  }
+
+  static auto deallocate(void* ptr, size_t size) -> void {
+    if (size > kMaxPooledSize) [[unlikely]] {
+      ::operator delete(ptr, size);
+      return;
+    }
+    size_t index = size_class(size);
+    pools()[index].deallocate(caches()[index], ptr);
+  }
+
+ private:
+  static constexpr size_t kNumSizeClasses = kMaxPooledSize / kGranularity;
+
+  static_assert(kGranularity >= sizeof(NodePool::FreeBlock));
+  static_assert(sizeof(void*) == sizeof(uint64_t));
+  static_assert(NodePool::kSlabAlignment % kGranularity == 0);
+
+  static auto size_class(size_t size) -> size_t {
+    return size == 0 ? 0 : (size - 1) / kGranularity;
+  }
+
+  template<size_t... I>
+  static auto make_pools(std::index_sequence<I...>)
+      -> std::array<NodePool, kNumSizeClasses>* {
+    return new std::array<NodePool, kNumSizeClasses>{
+        NodePool((I + 1) * kGranularity)...};
+  }
+
+  static auto pools() -> std::array<NodePool, kNumSizeClasses>& {
+    // Never destroyed, so that nodes freed by static destructors still have a
+    // pool to return to
+    static auto pools = make_pools(std::make_index_sequence<kNumSizeClasses>{});
+    return *pools;
+  }
+
+  static auto caches() -> std::array<NodePool::Cache, kNumSizeClasses>& {
+    thread_local std::array<NodePool::Cache, kNumSizeClasses> caches{};
+    return caches;
+  }
+};
+
+/**
+ * AllocatedBy - Base of a node type that is allocated by `Allocator`
+ */
+template<typename Allocator>
+struct AllocatedBy {
+  static auto operator new(size_t size) -> void* {
+    return Allocator::allocate(size);
+  }
+
+  static auto operator delete(void* ptr, size_t size) -> void {
+    Allocator::deallocate(ptr, size);
+  }
+};
+
+#endif  // POOL_ALLOCATOR_H_
@@ -0,0 +1,426 @@
+#ifndef RCU_H_
+#define RCU_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "memory/background_reclaimer.h"
+#include "memory/thread_registry.h"
+#include "util/backoff.h"
+
+#ifdef __linux__
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * How the readers of an RcuDomain tell writers that they are done
+ *
+ * - kQsbr: quiescent-state-based. Read-side critical sections cost nothing;
+ *   instead every registered thread periodically calls `quiescent_state()`,
+ *   at a point where it holds no references into protected data, or goes
+ *   offline while it is idle.
+ * - kMemb: read_lock() and read_unlock() each store to a word owned by the
+ *   calling thread. Writers force the memory barriers that readers would
+ *   otherwise need with the membarrier system call, so readers execute no
+ *   fence and no atomic read-modify-write. Where membarrier is unavailable,
+ *   read_lock() falls back to a fence.
+ */
+enum class RcuFlavor {
+  kQsbr,
+  kMemb,
+};
+
+/**
+ * RcuDomain - Userspace read-copy-update [Des12]
+ *
+ * Writers unlink data from a shared structure and then either wait for a grace
+ * period with `synchronize_rcu()`, after which no reader can still reference
+ * it, or hand it to `call_rcu()` to be freed after some later grace period.
+ *
+ * A global grace-period counter only ever grows. Each thread holds a
+ * snapshot of it while it may reference protected data and 0 while it does
+ * not: the snapshot is taken by read_lock() in the memb flavor, and by every
+ * quiescent state in the QSBR flavor, where threads are treated as readers
+ * for as long as they are online. A grace period starts by incrementing the
+ * counter to `g`, and is over once every thread's word is 0 or at least `g`,
+ * since such a thread has started reading after the increment. The counter
+ * has 64 bits and never wraps, so unlike in liburcu a single increment
+ * suffices.
+ *
+ * `call_rcu()` collects retired pointers in a per-thread batch. A full batch
+ * starts a grace period and waits on a per-thread queue; every time a batch
+ * is queued, all the queued batches whose grace period is over are freed, or
+ * handed to the installed BackgroundReclaimer. No thread ever waits in
+ * `call_rcu()`.
+ *
+ * The class also exposes the interface of HazardPtr and EpochBasedReclamation
+ * (`op_begin()` is read_lock(), `sched_for_reclaim()` is call_rcu()), so data
+ * structures can be templated on it, e.g. RcuLazyList. In the QSBR flavor, the
+ * threads that use such a data structure must call `quiescent_state()`
+ * between operations, otherwise nothing is reclaimed, and a registered thread
+ * that exits without `unregister_thread()` stalls reclamation for good.
+ */
+template<RcuFlavor Flavor>
+class RcuDomain {
+  // Sealed batches, oldest first
+  struct Batch {
+    uint64_t grace_period_;
+    std::vector<data_to_reclaim> items_;
+  };
+
+  struct ThreadContext : RegistryNode<ThreadContext> {
+    // The grace period this thread may still be reading in, or 0. On its own
+    // cache line, since readers store to it in the memb flavor.
+    alignas(64) std::atomic<uint64_t> reading_since_{0};
+    size_t nesting_{0};
+    alignas(64) std::vector<data_to_reclaim> batch_;
+    std::deque<Batch> queued_;
+  };
+
+ public:
+  // Everything read inside a read-side critical section is protected, so data
+  // structures need not reserve individual nodes.
+  static constexpr bool kRequiresReservation = false;
+
+  RcuDomain() = default;
+
+  RcuDomain(const RcuDomain&) = delete;
+  auto operator=(const RcuDomain&) -> RcuDomain& = delete;
+
+  ~RcuDomain() {
+    // Note that the destructor is not thread-safe, so the caller should
+    // guarantee that no threads can access the domain at this point.
+    for (ThreadContext* curr = registry_.head(); curr != nullptr;
+         curr = curr->next_) {
+      free_all(curr->batch_);
+      for (Batch& batch : curr->queued_) {
+        free_all(batch.items_);
+      }
+    }
+  }
+
+  /**
+   * @brief Register the calling thread. Optional: threads are registered on
+   * their first read_lock() or call_rcu().
+   * @param num ignored; kept for interface compatibility with HazardPtr
+   */
+  auto register_thread(size_t = 0) -> void { self(); }
+
+  /**
+   * @brief Called once, outside any read-side critical section. Releases the
+   * calling thread's context, together with the batches that could not be
+   * freed yet, so that another thread can adopt it.
+   */
+  auto unregister_thread() -> void {
+    ThreadContext* context = registry_.find();
+    if (context != nullptr) {
+      context->reading_since_.store(0, std::memory_order_release);
+      reclaim_expired(context);
+      registry_.release(context);
+    }
+  }
+
+  /**
+   * @brief Enter a read-side critical section. Sections may be nested.
+   *
+   * QSBR: only brings an offline thread back online; an online thread stays
+   * protected until its next quiescent state anyway.
+   */
+  auto read_lock() -> void {
+    ThreadContext* context = self();
+    if constexpr (Flavor == RcuFlavor::kQsbr) {
+      if (context->reading_since_.load(std::memory_order_relaxed) == 0)
+          [[unlikely]] {
+        announce(context);
+      }
+    } else {
+      if (context->nesting_++ > 0) {
+        return;
+      }
+      context->reading_since_.store(
+          grace_period_.load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+      // The snapshot must be visible before any protected data is read; pairs
+      // with the heavy barriers of the writers
+      light_barrier();
+    }
+  }
+
+  /**
+   * @brief Leave a read-side critical section. A no-op for QSBR.
+   */
+  auto read_unlock() -> void {
+    if constexpr (Flavor == RcuFlavor::kMemb) {
+      ThreadContext* context = self();
+      if (--context->nesting_ == 0) {
+        context->reading_since_.store(0, std::memory_order_release);
+      }
+    }
+  }
+
+  /**
+   * @brief QSBR: report that the calling thread holds no references to
+   * protected data, and free the calling thread's batches whose grace period
+   * is over. Must not be called inside a read-side critical section.
+   */
+  auto quiescent_state() -> void
+    requires(Flavor == RcuFlavor::kQsbr)
+  {
+    ThreadContext* context = self();
+    announce(context);
+    if (!context->queued_.empty()) {
+      reclaim_expired(context);
+    }
+  }
+
+  /**
+   * @brief QSBR: stop holding back grace periods, e.g. before blocking or
+   * idling. The next read_lock() or quiescent_state() brings the thread back
+   * online.
+   */
+  auto thread_offline() -> void
+    requires(Flavor == RcuFlavor::kQsbr)
+  {
+    // Every read of the thread must be complete before writers see it offline
+    self()->reading_since_.store(0, std::memory_order_release);
+  }
+
+  /**
+   * @brief QSBR: come back online after thread_offline()
+   */
+  auto thread_online() -> void
+    requires(Flavor == RcuFlavor::kQsbr)
+  {
+    announce(self());
+  }
+
+  /**
+   * @brief Wait until every read-side critical section that was in progress
+   * when the call started has ended. Must be called outside any read-side
+   * critical section. Also frees every pointer the calling thread has
+   * retired.
+   */
+  auto synchronize_rcu() -> void {
+    ThreadContext* context = self();
+    assert(context->nesting_ == 0);
+    if constexpr (Flavor == RcuFlavor::kQsbr) {
+      // The calling thread would otherwise wait for itself
+      context->reading_since_.store(0, std::memory_order_release);
+    }
+
+    uint64_t grace_period = start_grace_period();
+    Backoff<std::chrono::microseconds> backoff(1, 1000);
+    while (oldest_reader() < grace_period) {
+      backoff.backoff();
+    }
+    heavy_barrier();
+
+    reclaim_all(context->batch_);
+    for (Batch& batch : context->queued_) {
+      reclaim_all(batch.items_);
+    }
+    context->queued_.clear();
+    if constexpr (Flavor == RcuFlavor::kQsbr) {
+      announce(context);
+    }
+  }
+
+  /**
+   * @brief Free `ptr`, which has already been unlinked from the data
+   * structure, after a grace period. Never waits.
+   * @tparam T the type of the data pointed by the pointer; need to know the
+   * data type for deallocation
+   * @param ptr the pointer to reclaim
+   * @param deleter frees the pointer; `delete` by default
+   */
+  template<typename T>
+  auto call_rcu(T* ptr, void (*deleter)(void*) = &do_delete<T>) -> void {
+    ThreadContext* context = self();
+    context->batch_.emplace_back(ptr, deleter);
+    if (context->batch_.size() >= kBatchSize) {
+      queue_batch(context);
+      reclaim_expired(context);
+    }
+  }
+
+  auto op_begin() -> void { read_lock(); }
+
+  template<typename T>
+  auto sched_for_reclaim(T* ptr, void (*deleter)(void*) = &do_delete<T>)
+      -> void {
+    call_rcu(ptr, deleter);
+  }
+
+  /**
+   * @brief No-op: pointers read inside a critical section are protected
+   */
+  auto try_reserve(void*) -> bool { return true; }
+
+  /**
+   * @brief No-op: pointers read inside a critical section are protected
+   */
+  auto unreserve(void*) -> void {}
+
+  auto op_end() -> void { read_unlock(); }
+
+  /**
+   * @brief Try to free every pointer the calling thread has retired, without
+   * waiting. Only succeeds if no reader is still in a critical section that
+   * started before the call; for QSBR, that includes the calling thread
+   * until its next quiescent state.
+   */
+  auto flush() -> void {
+    ThreadContext* context = self();
+    if (!context->batch_.empty()) {
+      queue_batch(context);
+    }
+    reclaim_expired(context);
+  }
+
+  /**
+   * @brief The number of retired pointers of the calling thread that are
+   * waiting to be reclaimed (for testing and debugging)
+   */
+  auto num_pending() -> size_t {
+    ThreadContext* context = self();
+    size_t count = context->batch_.size();
+    for (const Batch& batch : context->queued_) {
+      count += batch.items_.size();
+    }
+    return count;
+  }
+
+ private:
+  auto self() -> ThreadContext* {
+    return registry_.self([]() { return new ThreadContext(); });
+  }
+
+  // QSBR: take a snapshot of the grace-period counter. The fences order it
+  // after the thread's earlier reads and before its later ones.
+  auto announce(ThreadContext* context) -> void {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    context->reading_since_.store(
+        grace_period_.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  /**
+   * @brief Start a grace period
+   * @return the grace period; it is over once oldest_reader() reaches it
+   */
+  auto start_grace_period() -> uint64_t {
+    // A reader that sees the new counter must also see every unlink that
+    // preceded it
+    heavy_barrier();
+    uint64_t grace_period =
+        grace_period_.fetch_add(1, std::memory_order_seq_cst) + 1;
+    // Makes the snapshot of every reader that started before visible
+    heavy_barrier();
+    return grace_period;
+  }
+
+  // The oldest grace period a thread may still be reading in, or the current
+  // one if no thread is reading
+  auto oldest_reader() const -> uint64_t {
+    uint64_t oldest = grace_period_.load(std::memory_order_seq_cst);
+    for (ThreadContext* curr = registry_.head(); curr != nullptr;
+         curr = curr->next_) {
+      uint64_t since = curr->reading_since_.load(std::memory_order_seq_cst);
+      if (since != 0) {
+        oldest = std::min(oldest, since);
+      }
+    }
+    return oldest;
+  }
+
+  auto queue_batch(ThreadContext* context) -> void {
+    uint64_t grace_period = start_grace_period();
+    context->queued_.push_back({grace_period, std::move(context->batch_)});
+    context->batch_.clear();
+  }
+
+  // Free the queued batches of `context` whose grace period is over
+  auto reclaim_expired(ThreadContext* context) -> void {
+    if (context->queued_.empty()) {
+      return;
+    }
+    uint64_t oldest = oldest_reader();
+    if (context->queued_.front().grace_period_ > oldest) {
+      return;
+    }
+    // The reads of the readers that have left must be complete
+    heavy_barrier();
+    while (!context->queued_.empty() &&
+           context->queued_.front().grace_period_ <= oldest) {
+      reclaim_all(context->queued_.front().items_);
+      context->queued_.pop_front();
+    }
+  }
+
+  static auto free_all(std::vector<data_to_reclaim>& items) -> void {
+    for (const auto& reclaim_obj : items) {
+      reclaim_obj.reclaim();
+    }
+    items.clear();
+  }
+
+  // Orders the reader's snapshot before its reads. Memb readers rely on the
+  // writers' membarrier for that and only keep the compiler from reordering.
+  auto light_barrier() const -> void {
+    if (kUseMembarrier) {
+      std::atomic_signal_fence(std::memory_order_seq_cst);
+    } else {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  // A fence in the calling thread and, for memb, in every running thread of
+  // the process
+  auto heavy_barrier() const -> void {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+#ifdef __linux__
+    if (kUseMembarrier) {
+      syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+#endif
+  }
+
+  // Registers the process for expedited membarriers, once
+  static auto membarrier_available() -> bool {
+#ifdef __linux__
+    static const bool available = [] {
+      long commands = syscall(__NR_membarrier, MEMBARRIER_CMD_QUERY, 0, 0);
+      return commands >= 0 &&
+             (commands & MEMBARRIER_CMD_PRIVATE_EXPEDITED) != 0 &&
+             syscall(__NR_membarrier,
+                     MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0, 0) == 0;
+    }();
+    return available;
+#else
+    return false;
+#endif
+  }
+
+  // The number of retirements per batch, i.e. per grace period
+  static constexpr size_t kBatchSize = 128;
+
+  const bool kUseMembarrier =
+      Flavor == RcuFlavor::kMemb && membarrier_available();
+  alignas(64) std::atomic<uint64_t> grace_period_{1};
+  ThreadRegistry<ThreadContext> registry_;
+};
+
+using QsbrRcu = RcuDomain<RcuFlavor::kQsbr>;
+using MembRcu = RcuDomain<RcuFlavor::kMemb>;
+
+#endif  // RCU_H_
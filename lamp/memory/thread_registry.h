@@ -0,0 +1,153 @@
+#ifndef THREAD_REGISTRY_H_
+#define THREAD_REGISTRY_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+/**
+ * Intrusive link and ownership state of a per-thread context. Contexts managed
+ * by a ThreadRegistry must derive from this.
+ */
+template<typename Context>
+struct RegistryNode {
+  std::atomic<bool> in_use_{true};
+  std::atomic<std::thread::id> owner_{std::this_thread::get_id()};
+  Context* next_{nullptr};
+};
+
+/**
+ * ThreadRegistry - The set of per-thread contexts of one reclamation domain
+ *
+ * Contexts are kept in a lock-free, insert-only list and are only freed when
+ * the registry is destroyed. A thread looks up its context in a small
+ * direct-mapped, thread-local cache keyed by the registry's id, so the common
+ * case is a single load and compare, and a thread can participate in several
+ * domains at the same time. Ids are never reused, so a cache entry can not
+ * refer to a destroyed registry that happens to share an address.
+ *
+ * Released contexts (of threads that unregistered) are adopted by registering
+ * threads, together with whatever state they still hold.
+ */
+template<typename Context>
+class ThreadRegistry {
+ public:
+  ThreadRegistry() : kId(next_id_.fetch_add(1, std::memory_order_relaxed)) {}
+
+  ThreadRegistry(const ThreadRegistry&) = delete;
+  auto operator=(const ThreadRegistry&) -> ThreadRegistry& = delete;
+
+  ~ThreadRegistry() {
+    Context* curr = head_.load(std::memory_order_acquire);
+    while (curr != nullptr) {
+      Context* next = curr->next_;
+      delete curr;
+      curr = next;
+    }
+  }
+
+  /**
+   * @brief Get the calling thread's context, registering it on first use
+   * @param make creates a new context if no released one can be adopted
+   */
+  template<typename Make>
+  auto self(Make make) -> Context* {
+    CacheEntry& entry = cache_entry();
+    if (entry.registry_id_ == kId) [[likely]] {
+      return entry.context_;
+    }
+    Context* context = find();
+    if (context == nullptr) {
+      return acquire([](Context*) { return true; }, make);
+    }
+    entry = {kId, context};
+    return context;
+  }
+
+  /**
+   * @brief Find the context owned by the calling thread, if any
+   */
+  auto find() const -> Context* {
+    const CacheEntry& entry = cache_entry();
+    if (entry.registry_id_ == kId) {
+      return entry.context_;
+    }
+    auto me = std::this_thread::get_id();
+    for (Context* curr = head(); curr != nullptr; curr = curr->next_) {
+      if (curr->in_use_.load(std::memory_order_relaxed) &&
+          curr->owner_.load(std::memory_order_relaxed) == me) {
+        return curr;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief Adopt a released context accepted by `fits`, or register the one
+   * created by `make`, as the calling thread's context
+   */
+  template<typename Fits, typename Make>
+  auto acquire(Fits fits, Make make) -> Context* {
+    auto me = std::this_thread::get_id();
+    Context* context = nullptr;
+    for (Context* curr = head(); curr != nullptr; curr = curr->next_) {
+      bool in_use = false;
+      if (!curr->in_use_.load(std::memory_order_relaxed) && fits(curr) &&
+          curr->in_use_.compare_exchange_strong(in_use, true,
+                                                std::memory_order_acquire)) {
+        curr->owner_.store(me, std::memory_order_relaxed);
+        context = curr;
+        break;
+      }
+    }
+
+    if (context == nullptr) {
+      context = make();
+      context->next_ = head_.load(std::memory_order_relaxed);
+      while (!head_.compare_exchange_weak(context->next_, context,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {}
+    }
+
+    cache_entry() = {kId, context};
+    return context;
+  }
+
+  /**
+   * @brief Give up ownership of the calling thread's context
+   */
+  auto release(Context* context) -> void {
+    context->owner_.store(std::thread::id{}, std::memory_order_relaxed);
+    context->in_use_.store(false, std::memory_order_release);
+    cache_entry() = {};
+  }
+
+  /**
+   * @brief The first context, to iterate over all of them via `next_`
+   */
+  auto head() const -> Context* {
+    return head_.load(std::memory_order_acquire);
+  }
+
+ private:
+  static constexpr uint64_t kInvalidId = 0;
+  static constexpr size_t kCacheSize = 8;
+
+  struct CacheEntry {
+    uint64_t registry_id_{kInvalidId};
+    Context* context_{nullptr};
+  };
+
+  auto cache_entry() const -> CacheEntry& {
+    thread_local std::array<CacheEntry, kCacheSize> cache{};
+    return cache[kId % kCacheSize];
+  }
+
+  const uint64_t kId;
+  std::atomic<Context*> head_{nullptr};
+
+  static inline std::atomic<uint64_t> next_id_{kInvalidId + 1};
+};
+
+#endif  // THREAD_REGISTRY_H_
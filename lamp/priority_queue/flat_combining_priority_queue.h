@@ -0,0 +1,70 @@
+#ifndef FLAT_COMBINING_PRIORITY_QUEUE_H_
+#define FLAT_COMBINING_PRIORITY_QUEUE_H_
+
+#include <cstdint>
+#include <optional>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "synchronization/flat_combining.h"
+
+/**
+ * FlatCombiningPriorityQueue - A priority queue whose operations are applied
+ * to a sequential binary heap by a FlatCombining combiner
+ *
+ * Like SkipQueue, smaller priorities are removed first, and items of the same
+ * priority in the order they were added.
+ */
+template<typename T>
+class FlatCombiningPriorityQueue {
+  struct Entry {
+    uint32_t priority_;
+    uint64_t order_;  // Breaks ties in the order of addition
+    T item_;
+  };
+
+  // Orders the heap so that the top entry has the smallest priority and order
+  struct Later {
+    auto operator()(const Entry& a, const Entry& b) const -> bool {
+      return std::tie(a.priority_, a.order_) > std::tie(b.priority_, b.order_);
+    }
+  };
+
+  struct Heap {
+    std::priority_queue<Entry, std::vector<Entry>, Later> entries_;
+    uint64_t num_added_{0};
+  };
+
+ public:
+  /**
+   * Adds an item with the given priority
+   */
+  auto add(const T& item, uint32_t priority) -> void {
+    heap_.apply([&item, priority](Heap& heap) {
+      heap.entries_.push(Entry{priority, heap.num_added_++, item});
+    });
+  }
+
+  /**
+   * Removes an item with the smallest priority
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto remove_min() -> std::optional<T> {
+    return heap_.apply([](Heap& heap) -> std::optional<T> {
+      if (heap.entries_.empty()) {
+        return std::nullopt;
+      }
+      std::optional<T> item(heap.entries_.top().item_);
+      heap.entries_.pop();
+      return item;
+    });
+  }
+
+ private:
+  FlatCombining<Heap> heap_;
+};
+
+#endif  // FLAT_COMBINING_PRIORITY_QUEUE_H_
@@ -0,0 +1,106 @@
+#ifndef SIMPLE_TREE_H_
+#define SIMPLE_TREE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+
+#include "stack/lock_free_stack.h"
+
+/**
+ * SimpleTree - A bounded-range priority queue for priorities in [0, range)
+ * [Her08]
+ *
+ * Every priority has a bin (a LockFreeStack) at a leaf of a complete binary
+ * tree, and every inner node has a counter of the items in the bins of its
+ * left subtree. add() puts the item in its bin and increments the counters of
+ * the nodes of which the bin is in the left subtree, bottom up. remove_min()
+ * walks from the root to a leaf, going left when it can decrement a node's
+ * counter and right otherwise, and pops an item from the leaf's bin.
+ *
+ * Both operations take O(log range) steps and never lock. The queue is
+ * quiescently consistent rather than linearizable: remove_min() may miss an
+ * item whose add() is in progress, or return std::nullopt while another
+ * remover is on its way to the only item.
+ */
+template<typename T>
+class SimpleTree {
+ public:
+  /**
+   * @param range the number of priorities, rounded up to a power of two
+   */
+  explicit SimpleTree(size_t range)
+      : num_leaves_(std::bit_ceil(std::max<size_t>(range, 1))),
+        counters_(std::make_unique<std::atomic<int64_t>[]>(num_leaves_)),
+        bins_(std::make_unique<LockFreeStack<T>[]>(num_leaves_)) {}
+
+  SimpleTree(const SimpleTree&) = delete;
+  auto operator=(const SimpleTree&) -> SimpleTree& = delete;
+
+  /**
+   * Adds an item with the given priority
+   *
+   * @throws std::out_of_range if the priority is not below the range
+   */
+  auto add(const T& item, size_t priority) -> void {
+    if (priority >= num_leaves_) {
+      throw std::out_of_range("add: Priority out of range");
+    }
+    bins_[priority].push(item);
+    // Inner nodes are numbered from 1 at the root as in a binary heap, and
+    // leaf `i` is node num_leaves_ + i
+    size_t node = num_leaves_ + priority;
+    while (node > 1) {
+      size_t parent = node / 2;
+      if (node == 2 * parent) {
+        counters_[parent].fetch_add(1, std::memory_order_release);
+      }
+      node = parent;
+    }
+  }
+
+  /**
+   * Removes an item with the smallest priority
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto remove_min() -> std::optional<T> {
+    size_t node = 1;
+    while (node < num_leaves_) {
+      node = bounded_decrement(counters_[node]) ? 2 * node : 2 * node + 1;
+    }
+    T item;
+    if (!bins_[node - num_leaves_].try_pop(item)) {
+      return std::nullopt;
+    }
+    return item;
+  }
+
+  auto range() const -> size_t { return num_leaves_; }
+
+ private:
+  // Decrements the counter unless it is zero
+  static auto bounded_decrement(std::atomic<int64_t>& counter) -> bool {
+    int64_t value = counter.load(std::memory_order_acquire);
+    while (value > 0) {
+      if (counter.compare_exchange_weak(value, value - 1,
+                                        std::memory_order_acquire,
+                                        std::memory_order_acquire)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const size_t num_leaves_;
+  // The counters of the inner nodes 1 .. num_leaves_ - 1; slot 0 is unused
+  std::unique_ptr<std::atomic<int64_t>[]> counters_;
+  std::unique_ptr<LockFreeStack<T>[]> bins_;
+};
+
+#endif  // SIMPLE_TREE_H_
@@ -0,0 +1,86 @@
+#ifndef SKIP_QUEUE_H_
+#define SKIP_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "memory/epoch_based_reclamation.h"
+#include "skiplist/lock_free_skip_list.h"
+#include "util/cache_aligned.h"
+
+/**
+ * SkipQueue - An unbounded lock-free priority queue built on LockFreeSkipList
+ * [Her07]
+ *
+ * Items are kept in the skip list ordered by priority, and remove_min()
+ * logically deletes the first unmarked node of the bottom level, so it is
+ * linearizable with respect to add(). Smaller priorities are removed first,
+ * and items of the same priority in the order they were added.
+ *
+ * Every item is keyed by its priority in the upper 32 bits and a ticket from
+ * a shared counter in the lower ones, which makes keys unique. The counter
+ * wraps around after 2^32 - 2 adds, after which the order among items of the
+ * same priority is no longer FIFO.
+ */
+template<typename T, typename Reclaimer = EpochBasedReclamation>
+class SkipQueue {
+  static_assert(sizeof(size_t) == sizeof(uint64_t),
+                "SkipQueue packs the priority and a ticket into a 64-bit key");
+
+  struct Entry {
+    size_t key_;
+    T item_;
+  };
+
+  struct EntryKey {
+    auto operator()(const Entry& entry) const noexcept -> size_t {
+      return entry.key_;
+    }
+  };
+
+  // Tickets skip 0 and the all-ones value, which together with the smallest
+  // and largest priorities would collide with the skip list's sentinels
+  static constexpr uint64_t kNumTickets = (uint64_t(1) << 32) - 2;
+
+ public:
+  SkipQueue() = default;
+
+  SkipQueue(const SkipQueue&) = delete;
+  auto operator=(const SkipQueue&) -> SkipQueue& = delete;
+
+  /**
+   * Adds an item with the given priority
+   */
+  auto add(const T& item, uint32_t priority) -> void {
+    // Fails only if the ticket wrapped around onto an item still queued
+    while (!list_.add(Entry{next_key(priority), item})) {
+    }
+  }
+
+  /**
+   * Removes an item with the smallest priority
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto remove_min() -> std::optional<T> {
+    std::optional<Entry> entry = list_.remove_first();
+    if (!entry.has_value()) {
+      return std::nullopt;
+    }
+    return std::move(entry->item_);
+  }
+
+ private:
+  auto next_key(uint32_t priority) -> size_t {
+    uint64_t ticket = tickets_->fetch_add(1, std::memory_order_relaxed);
+    return (uint64_t(priority) << 32) | (ticket % kNumTickets + 1);
+  }
+
+  LockFreeSkipList<Entry, EntryKey, Reclaimer> list_;
+  CacheAligned<std::atomic<uint64_t>> tickets_{0};
+};
+
+#endif  // SKIP_QUEUE_H_
@@ -0,0 +1,103 @@
+#ifndef SPRAY_LIST_H_
+#define SPRAY_LIST_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "memory/epoch_based_reclamation.h"
+#include "skiplist/lock_free_skip_list.h"
+#include "util/cache_aligned.h"
+
+/**
+ * SprayList - A relaxed lock-free priority queue [Ali15]
+ *
+ * Same as SkipQueue, except that remove_min() does not always remove an item
+ * with the smallest priority. In a SkipQueue every remover races for the first
+ * node of the skip list, so removals serialize on it. Here every remover takes
+ * a random walk ("spray") down the skip list, starting at level log2(p) + 1
+ * for `p` threads and moving forward up to log2(p) + 1 nodes per level, and
+ * removes the node it lands on. With high probability the removed item is
+ * among the first O(p log^3 p) ones, and removers rarely collide.
+ *
+ * Use it where approximately ordered removal is good enough, e.g. to schedule
+ * tasks by priority.
+ */
+template<typename T, typename Reclaimer = EpochBasedReclamation>
+class SprayList {
+  static_assert(sizeof(size_t) == sizeof(uint64_t),
+                "SprayList packs the priority and a ticket into a 64-bit key");
+
+  struct Entry {
+    size_t key_;
+    T item_;
+  };
+
+  struct EntryKey {
+    auto operator()(const Entry& entry) const noexcept -> size_t {
+      return entry.key_;
+    }
+  };
+
+  // See SkipQueue
+  static constexpr uint64_t kNumTickets = (uint64_t(1) << 32) - 2;
+
+ public:
+  /**
+   * @param num_threads the number of threads expected to call remove_min()
+   * concurrently, which sets the width of the spray
+   */
+  explicit SprayList(size_t num_threads)
+      : spray_height_(static_cast<int>(
+            std::bit_width(std::max<size_t>(num_threads, 1)))) {}
+
+  SprayList(const SprayList&) = delete;
+  auto operator=(const SprayList&) -> SprayList& = delete;
+
+  /**
+   * Adds an item with the given priority
+   */
+  auto add(const T& item, uint32_t priority) -> void {
+    // Fails only if the ticket wrapped around onto an item still queued
+    while (!list_.add(Entry{next_key(priority), item})) {
+    }
+  }
+
+  /**
+   * Removes an item whose priority is likely among the smallest ones
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto remove_min() -> std::optional<T> {
+    std::optional<Entry> entry =
+        list_.spray_remove(spray_height_, spray_height_);
+    if (!entry.has_value()) {
+      return std::nullopt;
+    }
+    return std::move(entry->item_);
+  }
+
+  /**
+   * Reseeds the calling thread's generator of sprays and node levels, which
+   * is otherwise seeded at random, e.g. to make a test reproducible
+   */
+  static auto seed_random(uint32_t seed) -> void { List::seed_random(seed); }
+
+ private:
+  using List = LockFreeSkipList<Entry, EntryKey, Reclaimer>;
+
+  auto next_key(uint32_t priority) -> size_t {
+    uint64_t ticket = tickets_->fetch_add(1, std::memory_order_relaxed);
+    return (uint64_t(priority) << 32) | (ticket % kNumTickets + 1);
+  }
+
+  const int spray_height_;  // log2(num_threads) + 1
+  List list_;
+  CacheAligned<std::atomic<uint64_t>> tickets_{0};
+};
+
+#endif  // SPRAY_LIST_H_
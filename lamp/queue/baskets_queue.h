@@ -0,0 +1,263 @@
+#ifndef BASKETS_QUEUE_H_
+#define BASKETS_QUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#include "counting/sharded_counter.h"
+#include "util/atomic_markable_ptr.h"
+#include "util/backoff.h"
+#include "util/cache_aligned.h"
+#include "util/common.h"
+#include "util/node_value.h"
+#include "util/stats.h"
+
+/**
+ * BasketsQueue - An unbounded lock-free queue in which enqueuers that lose
+ * the race for the tail insert into a basket instead of retrying on the tail
+ * [Hof07]
+ *
+ * As in LockFreeQueue, an enqueuer links its node after the last node with a
+ * CAS. When that CAS fails, its operation overlapped with the enqueue that
+ * won, so the two items may be queued in either order. Rather than rereading
+ * the tail, the loser inserts its node right after the node it found last, in
+ * front of the winner's: the nodes that share a predecessor this way form a
+ * basket. Under contention, enqueuers thus spread over the links of a basket
+ * instead of all failing on the same one, and the tail is moved once per
+ * basket. `RetryBackoff` (see backoff.h) spaces out their attempts.
+ *
+ * A dequeuer removes an item by marking the link to its node, and only swings
+ * the head over the removed nodes once it is `kMaxHops` behind, so most
+ * dequeues make one CAS on a link rather than on the head. A basket is closed
+ * once the link to its first node is marked.
+ *
+ * As in LockFreeQueue, removed nodes are only freed with the queue, so
+ * pointers need no ABA tags.
+ */
+template<typename T, typename RetryBackoff = PauseBackoff<>>
+class BasketsQueue {
+  struct Node {
+    NodeValue<T> value_{};  // Empty in the sentinel
+    // Marked once the node it points to has been dequeued
+    AtomicMarkablePtr<Node> next_{nullptr, false};
+    Node* next_deleted_{nullptr};  // Non-atomic link for garbage list
+
+    Node() = default;
+
+    template<typename... Args>
+    explicit Node(std::in_place_t, Args&&... args)
+        : value_(std::in_place, std::forward<Args>(args)...) {}
+  };
+
+  // Dequeuers swing the head once they had to skip this many removed nodes
+  static constexpr size_t kMaxHops = 3;
+
+ public:
+  BasketsQueue() {
+    auto node = new Node();
+    head_->store(node, std::memory_order_release);
+    tail_->store(node, std::memory_order_release);
+  }
+
+  BasketsQueue(const BasketsQueue&) = delete;
+  auto operator=(const BasketsQueue&) -> BasketsQueue& = delete;
+
+  ~BasketsQueue() {
+    Node* curr = garbage_list_.load(std::memory_order_relaxed);
+    while (curr != nullptr) {
+      Node* next = curr->next_deleted_;
+      delete curr;
+      curr = next;
+    }
+
+    curr = head_->load(std::memory_order_relaxed);
+    while (curr != nullptr) {
+      Node* next = curr->next_.get_ptr(std::memory_order_relaxed);
+      delete curr;
+      curr = next;
+    }
+  }
+
+  auto enqueue(T value) -> void { emplace(std::move(value)); }
+
+  /**
+   * Constructs an item from `args` at the back of the queue
+   */
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    auto node = new Node(std::in_place, std::forward<Args>(args)...);
+    RetryBackoff backoff;
+    while (true) {
+      Node* last = tail_->load(std::memory_order_acquire);
+      auto [next, deleted] = last->next_.get(std::memory_order_acquire);
+      if (last != tail_->load(std::memory_order_acquire)) {
+        continue;
+      }
+      if (next != nullptr) {
+        // The tail lags behind; move it to the last node
+        fix_tail(last, next);
+        continue;
+      }
+
+      node->next_.set(nullptr, false, std::memory_order_relaxed);
+      if (last->next_.compare_and_swap(nullptr, node, false, false,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+        tail_->compare_exchange_strong(last, node, std::memory_order_release,
+                                       std::memory_order_relaxed);
+        size_counter_.add(1);
+        return;
+      }
+      LAMP_STAT_INC(Stat::kCasFailures);
+
+      // Join the basket after `last`, as long as no item of it has been
+      // dequeued. Its nodes stay ahead of the tail, which the winner moves.
+      std::tie(next, deleted) = last->next_.get(std::memory_order_acquire);
+      while (next != nullptr && !deleted) {
+        backoff.backoff();
+        node->next_.set(next, false, std::memory_order_relaxed);
+        if (last->next_.compare_and_swap(next, node, false, false,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+          size_counter_.add(1);
+          return;
+        }
+        LAMP_STAT_INC(Stat::kCasFailures);
+        std::tie(next, deleted) = last->next_.get(std::memory_order_acquire);
+      }
+    }
+  }
+
+  /**
+   * Removes the item at the front of the queue
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto try_dequeue() -> std::optional<T> {
+    RetryBackoff backoff;
+    while (true) {
+      Node* first = head_->load(std::memory_order_acquire);
+      Node* last = tail_->load(std::memory_order_acquire);
+      auto [next, deleted] = first->next_.get(std::memory_order_acquire);
+      if (first != head_->load(std::memory_order_acquire)) {
+        continue;
+      }
+      if (first == last) {
+        if (next == nullptr) {
+          return std::nullopt;
+        }
+        fix_tail(last, next);
+        continue;
+      }
+
+      // Skip the nodes that have been dequeued but are still ahead of the
+      // head. Every node before the tail has a successor.
+      Node* iter = first;
+      size_t hops = 0;
+      while (deleted && iter != last &&
+             head_->load(std::memory_order_acquire) == first) {
+        iter = next;
+        std::tie(next, deleted) = iter->next_.get(std::memory_order_acquire);
+        hops++;
+      }
+      if (head_->load(std::memory_order_acquire) != first) {
+        continue;
+      }
+      if (iter == last) {
+        // Every item up to the tail has been dequeued
+        free_chain(first, iter);
+        continue;
+      }
+
+      if (iter->next_.compare_and_swap(next, next, false, true,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_relaxed)) {
+        // Only the thread that marked the link reads the node's value
+        std::optional<T> value = next->value_.take();
+        if (hops >= kMaxHops) {
+          free_chain(first, next);
+        }
+        size_counter_.add(-1);
+        return value;
+      }
+      LAMP_STAT_INC(Stat::kCasFailures);
+      backoff.backoff();
+    }
+  }
+
+  /**
+   * Removes the item at the front of the queue
+   *
+   * @throws EmptyException if the queue was empty
+   */
+  auto dequeue() -> T {
+    std::optional<T> value = try_dequeue();
+    if (!value.has_value()) {
+      throw EmptyException("dequeue: Try to dequeue from an empty queue");
+    }
+    return std::move(*value);
+  }
+
+  /**
+   * Returns the number of items in the queue
+   *
+   * Counted in per-thread shards, as in LockFreeQueue. The answer is
+   * approximate: it may miss operations in progress.
+   */
+  auto approx_size() const -> size_t {
+    return static_cast<size_t>(std::max<int64_t>(size_counter_.get(), 0));
+  }
+
+ private:
+  // Moves the tail from `last` towards the last node, starting from `next`,
+  // the successor of `last`
+  auto fix_tail(Node* last, Node* next) -> void {
+    Node* succ = next->next_.get_ptr(std::memory_order_acquire);
+    while (succ != nullptr &&
+           tail_->load(std::memory_order_relaxed) == last) {
+      next = succ;
+      succ = next->next_.get_ptr(std::memory_order_acquire);
+    }
+    tail_->compare_exchange_strong(last, next, std::memory_order_release,
+                                   std::memory_order_relaxed);
+  }
+
+  // Swings the head from `first` to `new_head`, all of whose predecessors
+  // have been dequeued, and hands the nodes before it to the garbage list
+  auto free_chain(Node* first, Node* new_head) -> void {
+    if (!head_->compare_exchange_strong(first, new_head,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+      return;
+    }
+    Node* node = first;
+    Node* next = node->next_.get_ptr(std::memory_order_acquire);
+    while (next != new_head) {
+      node->next_deleted_ = next;
+      node = next;
+      next = node->next_.get_ptr(std::memory_order_acquire);
+    }
+    add_to_garbage(first, node);
+  }
+
+  // Adds a chain of nodes, already linked through `next_deleted_`, to the
+  // garbage list
+  auto add_to_garbage(Node* first, Node* last) -> void {
+    last->next_deleted_ = garbage_list_.load(std::memory_order_relaxed);
+    while (!garbage_list_.compare_exchange_weak(last->next_deleted_, first,
+                                                std::memory_order_relaxed)) {
+    }
+  }
+
+  CacheAligned<std::atomic<Node*>> head_;  // Sentinel; may lag behind
+  std::atomic<Node*> garbage_list_{nullptr};  // Deferred deletion list
+  CacheAligned<std::atomic<Node*>> tail_;  // Points to last node (might lag)
+  ShardedCounter size_counter_;  // Enqueues minus dequeues, per thread
+};
+
+#endif  // BASKETS_QUEUE_H_
@@ -0,0 +1,121 @@
+#ifndef BLOCKING_QUEUE_H_
+#define BLOCKING_QUEUE_H_
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "synchronization/event_count.h"
+
+/**
+ * BlockingQueue - Makes consumers of a non-blocking queue sleep while it is
+ * empty
+ *
+ * `Queue` is one of the queues with a non-waiting `try_dequeue()`, e.g.
+ * LockFreeQueue, UnboundedQueue or MPMCQueue. A consumer that finds the queue
+ * empty polls it kSpinCount more times, and then parks on an EventCount until
+ * a producer enqueues an item, so an idle consumer uses no CPU. A producer
+ * checks the EventCount only after enqueueing, and makes a wake-up system call
+ * only if some consumer is actually asleep.
+ *
+ * If `Queue` has a `try_enqueue()` (i.e., it is bounded), producers wait for
+ * room the same way on a second EventCount.
+ */
+template<typename Queue>
+class BlockingQueue {
+  using T = typename decltype(std::declval<Queue&>().try_dequeue())::value_type;
+
+  static constexpr bool kBounded =
+      requires(Queue& queue, const T& value) { queue.try_enqueue(value); };
+
+ public:
+  static constexpr int kSpinCount = 128;
+
+  /**
+   * Constructs the underlying queue from `args`
+   */
+  template<typename... Args>
+  explicit BlockingQueue(Args&&... args)
+      : queue_(std::forward<Args>(args)...) {}
+
+  BlockingQueue(const BlockingQueue&) = delete;
+  auto operator=(const BlockingQueue&) -> BlockingQueue& = delete;
+
+  /**
+   * Appends an item to the queue, waiting while a bounded queue is full
+   */
+  auto enqueue(T value) -> void { emplace(std::move(value)); }
+
+  /**
+   * Constructs an item from `args` at the back of the queue, waiting while a
+   * bounded queue is full
+   */
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    if constexpr (kBounded) {
+      // A failed attempt leaves `args` untouched
+      wait_until(not_full_, [&]() {
+        return queue_.try_emplace(std::forward<Args>(args)...);
+      });
+    } else {
+      queue_.emplace(std::forward<Args>(args)...);
+    }
+    not_empty_.notify_one();
+  }
+
+  /**
+   * Removes the item at the front of the queue, waiting while it is empty
+   */
+  auto dequeue() -> T {
+    std::optional<T> value;
+    wait_until(not_empty_, [&]() {
+      value = queue_.try_dequeue();
+      return value.has_value();
+    });
+    if constexpr (kBounded) {
+      not_full_.notify_one();
+    }
+    return std::move(*value);
+  }
+
+  /**
+   * Removes the item at the front of the queue without waiting
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto try_dequeue() -> std::optional<T> {
+    std::optional<T> value = queue_.try_dequeue();
+    if constexpr (kBounded) {
+      if (value.has_value()) {
+        not_full_.notify_one();
+      }
+    }
+    return value;
+  }
+
+ private:
+  // Retries `attempt` until it succeeds: first by spinning, then by parking on
+  // `event` between attempts
+  template<typename Attempt>
+  static auto wait_until(EventCount& event, Attempt attempt) -> void {
+    for (int i = 0; i <= kSpinCount; i++) {
+      if (attempt()) {
+        return;
+      }
+    }
+    while (true) {
+      uint32_t key = event.prepare_wait();
+      if (attempt()) {
+        event.cancel_wait();
+        return;
+      }
+      event.wait(key);
+    }
+  }
+
+  Queue queue_;
+  EventCount not_empty_;  // Notified after every enqueue
+  EventCount not_full_;   // Notified after every dequeue, if bounded
+};
+
+#endif  // BLOCKING_QUEUE_H_
@@ -1,22 +1,41 @@
 #ifndef BOUNDED_QUEUE_H_
 #define BOUNDED_QUEUE_H_
 
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
 #include <optional>
+#include <utility>
 
 #include "synchronization/condition_variable.h"
+#include "synchronization/lock.h"
 #include "synchronization/scoped_lock.h"
 #include "synchronization/ttas_lock.h"
+#include "util/cache_aligned.h"
+#include "util/node_value.h"
 
-template<typename T>
+/**
+ * BoundedQueue - A two-lock queue of at most `capacity` items, whose enqueuers
+ * wait while it is full and whose dequeuers wait while it is empty
+ *
+ * The size is split in two counters [Her08, 10.3]: enqueuers count their items
+ * in `enq_side_size_` and dequeuers count theirs in `deq_side_size_`, and
+ * enqueuers only read the dequeuers' counter, and move it over to theirs,
+ * once they believe the queue is full. So the two sides share no counter
+ * that both update on every operation. Each side tells the other that it
+ * waits with a flag, which the other side checks after each operation.
+ */
+template<typename T, BasicLockable Lock = TTASLock<>>
 class BoundedQueue {
   struct Node {
-    std::optional<T> value_{};
-    Node* next_{nullptr};
+    NodeValue<T> value_{};  // Empty in the sentinel
+    std::atomic<Node*> next_{nullptr};
 
     Node() = default;
 
-    Node(const T& value) : value_(value) {}
+    template<typename... Args>
+    explicit Node(std::in_place_t, Args&&... args)
+        : value_(std::in_place, std::forward<Args>(args)...) {}
   };
 
  public:
@@ -28,83 +47,297 @@ class BoundedQueue {
   ~BoundedQueue() {
     Node* curr = head_;
     while (curr != nullptr) {
-      Node* next = curr->next_;
+      Node* next = curr->next_.load(std::memory_order_relaxed);
       delete curr;
       curr = next;
     }
   }
 
-  auto enqueue(const T& value) -> void {
-    bool must_wake_dequeuers = false;
-    auto node = new Node(value);
+  auto enqueue(T value) -> void { emplace(std::move(value)); }
+
+  /**
+   * Constructs an item from `args` at the back of the queue, waiting while the
+   * queue is full
+   */
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    auto node = new Node(std::in_place, std::forward<Args>(args)...);
     {
-      ScopedLock<TTASLock> scoped_lock{enq_mutex_};
+      ScopedLock<Lock> scoped_lock{*enq_mutex_};
 
-      while (size_.load(std::memory_order_relaxed) == capacity_) {
-        not_full_condition_.wait(enq_mutex_);
-      }
+      wait_for_room(scoped_lock);
 
-      tail_->next_ = node;
+      // Release publishes the item to the dequeuer that finds the node
+      tail_->next_.store(node, std::memory_order_release);
       tail_ = node;
+      enq_side_size_.store(enq_side_size_.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+    }
+
+    wake_dequeuers();
+  }
 
-      if (size_.fetch_add(1, std::memory_order_relaxed) == 0) {
-        must_wake_dequeuers = true;
+  /**
+   * Appends the items in [first, last) to the queue, in order, waiting while
+   * the queue is full
+   *
+   * The nodes are allocated before any lock is taken, and the enqueuer lock is
+   * taken once for every run of items that fits in the free space, so a batch
+   * that fits takes it only once. Items of a batch larger than the free space
+   * may be interleaved with those of other enqueuers.
+   */
+  template<typename InputIt>
+  auto enqueue_bulk(InputIt first, InputIt last) -> void {
+    Node* chain_head = nullptr;
+    Node* chain_tail = nullptr;
+    size_t chain_size = 0;
+    for (; first != last; ++first) {
+      auto node = new Node(std::in_place, *first);
+      if (chain_tail == nullptr) {
+        chain_head = node;
+      } else {
+        chain_tail->next_.store(node, std::memory_order_relaxed);
       }
+      chain_tail = node;
+      chain_size++;
     }
 
-    if (must_wake_dequeuers) {
-      // Important: the thread must acquire a `deq_mutex_` to avoid lost wake up
-      // since if did not acquire the `deq_mutex_`, it may signal a dequeuer
-      // after they see the queue is empty, but before they go to sleep.
-      ScopedLock<TTASLock> scoped_lock{deq_mutex_};
-      not_empty_condition_.notify_all();
+    while (chain_size > 0) {
+      {
+        ScopedLock<Lock> scoped_lock{*enq_mutex_};
+
+        size_t room = wait_for_room(scoped_lock);
+
+        // Splice as many nodes as there is room for
+        size_t count = chain_size;
+        Node* splice_tail = chain_tail;
+        if (room < chain_size) {
+          count = room;
+          splice_tail = chain_head;
+          for (size_t i = 1; i < count; i++) {
+            splice_tail = splice_tail->next_.load(std::memory_order_relaxed);
+          }
+        }
+        Node* rest = splice_tail->next_.load(std::memory_order_relaxed);
+        splice_tail->next_.store(nullptr, std::memory_order_relaxed);
+        tail_->next_.store(chain_head, std::memory_order_release);
+        tail_ = splice_tail;
+        chain_head = rest;
+        chain_size -= count;
+        enq_side_size_.store(
+            enq_side_size_.load(std::memory_order_relaxed) + count,
+            std::memory_order_relaxed);
+      }
+
+      wake_dequeuers();
     }
   }
 
   auto dequeue() -> T {
-    bool must_wake_enqueuers = false;
-    T value;
+    std::optional<T> value;
+    {
+      ScopedLock<Lock> scoped_lock{*deq_mutex_};
+
+      Node* next = wait_for_item(scoped_lock);
+
+      value = next->value_.take();
+      Node* old_head = head_;
+      head_ = next;
+      delete old_head;
+
+      deq_side_size_->fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    wake_enqueuers();
+
+    return std::move(*value);
+  }
+
+  /**
+   * Removes the item at the front of the queue without waiting
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto try_dequeue() -> std::optional<T> {
+    std::optional<T> value;
     {
-      ScopedLock<TTASLock> scoped_lock{deq_mutex_};
+      ScopedLock<Lock> scoped_lock{*deq_mutex_};
 
-      while (head_->next_ == nullptr) {
-        not_empty_condition_.wait(deq_mutex_);
+      Node* next = head_->next_.load(std::memory_order_acquire);
+      if (next == nullptr) {
+        return std::nullopt;
       }
 
-      value = head_->next_->value_.value();
+      value = next->value_.take();
       Node* old_head = head_;
-      head_ = head_->next_;
+      head_ = next;
       delete old_head;
 
-      if (size_.fetch_sub(1, std::memory_order_relaxed) == capacity_) {
-        must_wake_enqueuers = true;
+      deq_side_size_->fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    wake_enqueuers();
+
+    return value;
+  }
+
+  /**
+   * Removes up to `max` items from the front of the queue, taking the dequeuer
+   * lock once, and waiting while the queue is empty
+   *
+   * @param out receives the removed items, in order
+   * @return the number of items removed, at least 1 unless `max` is 0
+   */
+  template<typename OutputIt>
+  auto dequeue_bulk(OutputIt out, size_t max) -> size_t {
+    if (max == 0) {
+      return 0;
+    }
+    Node* old_head;
+    Node* new_head;
+    size_t count = 0;
+    {
+      ScopedLock<Lock> scoped_lock{*deq_mutex_};
+
+      Node* next = wait_for_item(scoped_lock);
+
+      old_head = head_;
+      while (count < max && next != nullptr) {
+        head_ = next;
+        *out++ = head_->value_.take();
+        count++;
+        next = head_->next_.load(std::memory_order_acquire);
       }
+      new_head = head_;
+
+      deq_side_size_->fetch_add(count, std::memory_order_seq_cst);
     }
 
-    if (must_wake_enqueuers) {
-      // Important: the thread must acquire a `enq_mutex_` to avoid lost wakeup
-      // since if did not acquire the `enq_mutex_`, it may signal an enqueuer
-      // after they see the queue is full, but before they go to sleep.
-      ScopedLock<TTASLock> scoped_lock{enq_mutex_};
-      not_full_condition_.notify_all();
+    while (old_head != new_head) {
+      Node* next = old_head->next_.load(std::memory_order_relaxed);
+      delete old_head;
+      old_head = next;
     }
 
-    return value;
+    wake_enqueuers();
+
+    return count;
+  }
+
+  /**
+   * Returns the number of items in the queue, without taking a lock or
+   * writing to shared memory
+   *
+   * The answer is approximate: it may miss operations in progress, and
+   * momentarily over- or undercount while an enqueuer moves the dequeuers'
+   * count over. It is always within [0, capacity].
+   */
+  auto approx_size() const -> size_t {
+    size_t dequeued = deq_side_size_->load(std::memory_order_acquire);
+    size_t size = enq_side_size_.load(std::memory_order_relaxed);
+    return size > dequeued ? std::min(size - dequeued, capacity_) : 0;
   }
 
  private:
-  std::atomic<size_t> size_{};
-  Node* head_;
-  Node* tail_;
-  size_t capacity_;
+  /**
+   * Waits, holding `scoped_lock` on `enq_mutex_`, until the queue has room,
+   * and returns the number of free slots
+   *
+   * The dequeuers' count is read, and reset, only when the enqueuers' side
+   * believes the queue is full. Before waiting, an enqueuer raises
+   * `enqueuers_waiting_` and then checks the dequeuers' count once more, while
+   * dequeuers bump their count before checking the flag; both are seq_cst, so
+   * either the enqueuer sees the dequeue or the dequeuer sees the flag.
+   */
+  auto wait_for_room(ScopedLock<Lock>& scoped_lock) -> size_t {
+    size_t size = enq_side_size_.load(std::memory_order_relaxed);
+    while (size == capacity_) {
+      size -= deq_side_size_->exchange(0, std::memory_order_seq_cst);
+      if (size < capacity_) {
+        break;
+      }
+      enqueuers_waiting_->store(true, std::memory_order_seq_cst);
+      size -= deq_side_size_->exchange(0, std::memory_order_seq_cst);
+      if (size < capacity_) {
+        break;
+      }
+      not_full_condition_.wait(scoped_lock);
+    }
+    enq_side_size_.store(size, std::memory_order_relaxed);
+    return capacity_ - size;
+  }
+
+  /**
+   * Waits, holding `scoped_lock` on `deq_mutex_`, until the queue has an
+   * item, and returns the node that holds it
+   */
+  auto wait_for_item(ScopedLock<Lock>& scoped_lock) -> Node* {
+    Node* next = head_->next_.load(std::memory_order_acquire);
+    while (next == nullptr) {
+      dequeuers_waiting_->store(true, std::memory_order_seq_cst);
+      // Orders the flag before the check, as wake_dequeuers() orders the
+      // enqueued node before reading the flag
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      next = head_->next_.load(std::memory_order_acquire);
+      if (next != nullptr) {
+        break;
+      }
+      not_empty_condition_.wait(scoped_lock);
+      next = head_->next_.load(std::memory_order_acquire);
+    }
+    return next;
+  }
+
+  /**
+   * Wakes the dequeuers after an enqueue if any of them waits
+   *
+   * The waiters are notified under `deq_mutex_`, which a dequeuer holds from
+   * raising the flag until it waits, so that no notification is lost.
+   */
+  auto wake_dequeuers() -> void {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (dequeuers_waiting_->load(std::memory_order_relaxed)) {
+      ScopedLock<Lock> scoped_lock{*deq_mutex_};
+      dequeuers_waiting_->store(false, std::memory_order_relaxed);
+      not_empty_condition_.notify_all();
+    }
+  }
 
-  TTASLock enq_mutex_;  // Mutex to prevent concurrent enqueuers
+  /**
+   * Wakes the enqueuers after a dequeue if any of them waits, under
+   * `enq_mutex_` for the same reason as wake_dequeuers()
+   */
+  auto wake_enqueuers() -> void {
+    if (enqueuers_waiting_->load(std::memory_order_seq_cst)) {
+      ScopedLock<Lock> scoped_lock{*enq_mutex_};
+      enqueuers_waiting_->store(false, std::memory_order_relaxed);
+      not_full_condition_.notify_all();
+    }
+  }
+
+  // Every CacheAligned member starts a new cache line, so that the state of
+  // enqueuers (following `enq_mutex_`) and of dequeuers (following
+  // `deq_mutex_`) never share one. The waiting flags are read after every
+  // operation but rarely written, so each gets a line of its own.
+  const size_t capacity_;
+
+  CacheAligned<Lock> enq_mutex_;  // Mutex to prevent concurrent enqueuers
+  Node* tail_;
+  // Items enqueued minus the dequeues moved over from `deq_side_size_`, at
+  // least the size. Written under `enq_mutex_`, read by approx_size().
+  std::atomic<size_t> enq_side_size_{0};
   ConditionVariable not_full_condition_;  // Used to notify enqueuers when the
                                           // queue is no longer full
 
-  TTASLock deq_mutex_;  // Mutex to prevent concurrent dequeuers
+  CacheAligned<Lock> deq_mutex_;  // Mutex to prevent concurrent dequeuers
+  Node* head_;
   ConditionVariable not_empty_condition_;  // Used to notify dequeuers when the
                                            // queue is no longer empty
+
+  // Items dequeued since enqueuers last moved the count over
+  CacheAligned<std::atomic<size_t>> deq_side_size_{0};
+  CacheAligned<std::atomic<bool>> enqueuers_waiting_{false};
+  CacheAligned<std::atomic<bool>> dequeuers_waiting_{false};
 };
 
 #endif  // BOUNDED_QUEUE_H_
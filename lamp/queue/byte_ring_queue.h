@@ -0,0 +1,253 @@
+#ifndef BYTE_RING_QUEUE_H_
+#define BYTE_RING_QUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+
+#include "util/backoff.h"
+#include "util/cache_aligned.h"
+
+/**
+ * ByteRingQueue - A bounded multi-producer single-consumer queue of
+ * variable-sized byte records, written and read in place
+ *
+ * Records live back to back in a ring of bytes, each behind an 8-byte header
+ * that holds its size and its length in the ring. A producer reserves room
+ * for a record with a CAS on `reserve_tail_`, writes the payload straight into
+ * the ring, and commits it; the consumer peeks at the oldest record in the
+ * ring and releases it once done. So a record is never copied by the queue,
+ * unlike in the node-based queues, which copy or move every item in and out.
+ *
+ * A record never wraps around the end of the ring: one that does not fit in
+ * the bytes left before the end is preceded by a padding record, which the
+ * consumer skips. Records are committed in the order they were reserved: a
+ * commit waits for the commits of all earlier reservations and then moves
+ * `commit_tail_` past its record, so the consumer reads only whole records
+ * without the ring having to be cleared. A producer that stalls between
+ * reserve and commit holds up later commits, so reservations should be short.
+ *
+ * At most one thread may peek() and release() at a time. The capacity is in
+ * bytes and rounded up to a power of two.
+ */
+class ByteRingQueue {
+  struct RecordHeader {
+    uint32_t size_;    // The bytes written, or kPadding
+    uint32_t length_;  // The bytes up to the next record
+  };
+
+  static constexpr size_t kAlignment = sizeof(RecordHeader);
+  static constexpr uint32_t kPadding = UINT32_MAX;
+
+ public:
+  /**
+   * Room reserved for a record, to be written and then passed to commit()
+   */
+  class Reservation {
+   public:
+    auto bytes() const -> std::span<std::byte> { return bytes_; }
+
+   private:
+    friend class ByteRingQueue;
+
+    Reservation(std::span<std::byte> bytes, uint64_t start, uint64_t end)
+        : bytes_(bytes), start_(start), end_(end) {}
+
+    std::span<std::byte> bytes_;
+    uint64_t start_;  // The ring position of the first byte claimed
+    uint64_t end_;    // The ring position past the record
+  };
+
+  /**
+   * @param capacity the size of the ring in bytes, rounded up to a power of
+   * two; a record takes its size plus a header of 8 bytes, rounded up to a
+   * multiple of 8, and at most half the ring
+   */
+  explicit ByteRingQueue(size_t capacity)
+      : capacity_(std::bit_ceil(std::max<size_t>(capacity, 2 * kAlignment))),
+        mask_(capacity_ - 1),
+        ring_(std::make_unique<uint64_t[]>(capacity_ / sizeof(uint64_t))) {}
+
+  ByteRingQueue(const ByteRingQueue&) = delete;
+  auto operator=(const ByteRingQueue&) -> ByteRingQueue& = delete;
+
+  /**
+   * The size of the largest record the ring can hold
+   *
+   * A record takes at most half the ring, header included, so that it fits in
+   * the empty ring wherever the tail is: it then needs at most the bytes left
+   * before the end of the ring for padding and another half for itself.
+   */
+  auto max_record_size() const -> size_t {
+    return std::min<size_t>(capacity_ / 2 - kAlignment, kPadding - 1);
+  }
+
+  /**
+   * Reserves room for a record of `size` bytes if the ring has room for it
+   *
+   * Lock-free. The reservation must be committed, even if it ends up unused.
+   *
+   * @throws std::invalid_argument if `size` exceeds max_record_size()
+   * @return the reservation, or std::nullopt if the ring is too full
+   */
+  auto try_reserve(size_t size) -> std::optional<Reservation> {
+    if (size > max_record_size()) {
+      throw std::invalid_argument("ByteRingQueue: record larger than the ring");
+    }
+    size_t record_size = aligned_size(size);
+    uint64_t tail = reserve_tail_->load(std::memory_order_relaxed);
+    while (true) {
+      size_t offset = tail & mask_;
+      size_t padding =
+          capacity_ - offset < record_size ? capacity_ - offset : 0;
+      uint64_t end = tail + padding + record_size;
+      // Acquire makes sure the consumer is done with the bytes it released
+      if (end - head_->load(std::memory_order_acquire) > capacity_) {
+        return std::nullopt;
+      }
+      if (reserve_tail_->compare_exchange_weak(tail, end,
+                                               std::memory_order_relaxed)) {
+        if (padding > 0) {
+          *header_at(offset) = {kPadding, static_cast<uint32_t>(padding)};
+        }
+        uint64_t start = tail;
+        offset = (tail + padding) & mask_;
+        *header_at(offset) = {static_cast<uint32_t>(size),
+                              static_cast<uint32_t>(record_size)};
+        return Reservation({ring_bytes() + offset + kAlignment, size}, start,
+                           end);
+      }
+    }
+  }
+
+  /**
+   * Reserves room for a record of `size` bytes, yielding while the ring is
+   * too full
+   */
+  auto reserve(size_t size) -> Reservation {
+    while (true) {
+      if (std::optional<Reservation> reservation = try_reserve(size)) {
+        return *reservation;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * Publishes a reserved record to the consumer, once the records reserved
+   * before it are published
+   *
+   * @param size the number of bytes written, at most the reserved size; the
+   * rest of the reservation stays unused until the record is released
+   */
+  auto commit(const Reservation& reservation, size_t size) -> void {
+    size_t offset = reservation.bytes_.data() - ring_bytes() - kAlignment;
+    header_at(offset)->size_ =
+        static_cast<uint32_t>(std::min(size, reservation.bytes_.size()));
+    while (commit_tail_->load(std::memory_order_acquire) !=
+           reservation.start_) {
+      cpu_relax();
+    }
+    // Release publishes the headers and payload to the consumer
+    commit_tail_->store(reservation.end_, std::memory_order_release);
+  }
+
+  auto commit(const Reservation& reservation) -> void {
+    commit(reservation, reservation.bytes_.size());
+  }
+
+  /**
+   * Copies `bytes` into the ring as one record, if it has room for it
+   *
+   * @return true if the record was enqueued, false if the ring was too full
+   */
+  auto try_enqueue(std::span<const std::byte> bytes) -> bool {
+    std::optional<Reservation> reservation = try_reserve(bytes.size());
+    if (!reservation.has_value()) {
+      return false;
+    }
+    std::memcpy(reservation->bytes().data(), bytes.data(), bytes.size());
+    commit(*reservation);
+    return true;
+  }
+
+  /**
+   * Returns the oldest committed record, which stays in the ring until
+   * release(). Must only be called by the consumer.
+   *
+   * Wait-free.
+   *
+   * @return the record, or std::nullopt if no record is committed
+   */
+  auto peek() -> std::optional<std::span<const std::byte>> {
+    while (true) {
+      if (head_pos_ == commit_pos_) {
+        commit_pos_ = commit_tail_->load(std::memory_order_acquire);
+        if (head_pos_ == commit_pos_) {
+          return std::nullopt;
+        }
+      }
+      size_t offset = head_pos_ & mask_;
+      const RecordHeader* header = header_at(offset);
+      if (header->size_ == kPadding) {
+        // Nobody reads padding, so it is released right away
+        head_pos_ += header->length_;
+        head_->store(head_pos_, std::memory_order_release);
+        continue;
+      }
+      peeked_length_ = header->length_;
+      return std::span<const std::byte>(ring_bytes() + offset + kAlignment,
+                                        header->size_);
+    }
+  }
+
+  /**
+   * Frees the record returned by the last peek() for producers to reuse.
+   * Must only be called by the consumer, after a successful peek().
+   */
+  auto release() -> void {
+    head_pos_ += peeked_length_;
+    peeked_length_ = 0;
+    // Release makes sure the record is read before producers overwrite it
+    head_->store(head_pos_, std::memory_order_release);
+  }
+
+  auto capacity() const -> size_t { return capacity_; }
+
+ private:
+  static auto aligned_size(size_t size) -> size_t {
+    return (kAlignment + size + kAlignment - 1) & ~(kAlignment - 1);
+  }
+
+  auto ring_bytes() const -> std::byte* {
+    return reinterpret_cast<std::byte*>(ring_.get());
+  }
+
+  auto header_at(size_t offset) const -> RecordHeader* {
+    return reinterpret_cast<RecordHeader*>(ring_bytes() + offset);
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<uint64_t[]> ring_;  // 8-byte aligned for the headers
+
+  // Producers update the first two lines and the consumer the third
+  CacheAligned<std::atomic<uint64_t>> reserve_tail_{0};
+  CacheAligned<std::atomic<uint64_t>> commit_tail_{0};
+  CacheAligned<std::atomic<uint64_t>> head_{0};
+
+  // Private to the consumer
+  uint64_t head_pos_{0};
+  uint64_t commit_pos_{0};  // The last value read from `commit_tail_`
+  size_t peeked_length_{0};  // The length of the record of the last peek()
+};
+
+#endif  // BYTE_RING_QUEUE_H_
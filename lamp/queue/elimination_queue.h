@@ -0,0 +1,197 @@
+#ifndef ELIMINATION_QUEUE_H_
+#define ELIMINATION_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "memory/epoch_based_reclamation.h"
+#include "memory/operation_guard.h"
+#include "util/cache_aligned.h"
+#include "util/common.h"
+#include "util/elimination.h"
+#include "util/node_value.h"
+
+/**
+ * EliminationQueue - A Michael-Scott queue whose enqueues and dequeues cancel
+ * out in an elimination array once the enqueue has aged [Moi05]
+ *
+ * Every node carries its position in the queue, one more than that of its
+ * predecessor. An enqueuer that loses the race on the tail remembers the
+ * position of the last node it saw, and from then on it may hand its item to a
+ * dequeuer directly, through an EliminationArray, as soon as the head has
+ * reached that position: every item enqueued before it has then been dequeued,
+ * so the item could have been at the front of the queue, and the pair can be
+ * linearized as if the enqueue had linked it there. Until then the enqueuer
+ * keeps retrying on the tail. A dequeuer that loses the race on the head
+ * visits the array right away, and takes whatever enqueue it meets there.
+ *
+ * Under symmetric producer/consumer load the queue is usually short, so most
+ * of the operations that collide on the tail or the head can eliminate instead
+ * of retrying. Nodes are freed by the `Reclaimer` once no operation can still
+ * be reading them.
+ */
+template<typename T, typename Reclaimer = EpochBasedReclamation>
+class EliminationQueue {
+  static_assert(!Reclaimer::kRequiresReservation,
+                "EliminationQueue reads nodes without reserving them, so it "
+                "needs a reclaimer that protects whole operations");
+
+  struct Node {
+    NodeValue<T> value_{};  // Empty in the sentinel
+    std::atomic<Node*> next_{nullptr};
+    uint64_t position_{0};  // One more than the predecessor's
+
+    Node() = default;
+
+    template<typename... Args>
+    explicit Node(std::in_place_t, Args&&... args)
+        : value_(std::in_place, std::forward<Args>(args)...) {}
+  };
+
+ public:
+  // The number of exchangers in the elimination array by default
+  static constexpr size_t kDefaultCapacity = 4;
+
+  /**
+   * @param capacity the number of exchangers in the elimination array
+   * @param spin_budget how long, in spins, a thread that lost a race waits in
+   * the elimination array for a partner
+   */
+  explicit EliminationQueue(
+      size_t capacity = kDefaultCapacity,
+      size_t spin_budget = EliminationArray<Node>::kDefaultSpinBudget)
+      : elimination_array_(capacity < 1 ? 1 : capacity, spin_budget) {
+    auto node = new Node();
+    head_->store(node, std::memory_order_relaxed);
+    tail_->store(node, std::memory_order_relaxed);
+  }
+
+  EliminationQueue(const EliminationQueue&) = delete;
+  auto operator=(const EliminationQueue&) -> EliminationQueue& = delete;
+
+  ~EliminationQueue() {
+    Node* curr = head_->load(std::memory_order_relaxed);
+    while (curr != nullptr) {
+      Node* next = curr->next_.load(std::memory_order_relaxed);
+      delete curr;
+      curr = next;
+    }
+  }
+
+  /**
+   * Appends an item to the queue
+   */
+  auto enqueue(T value) -> void { emplace(std::move(value)); }
+
+  /**
+   * Constructs an item from `args` at the back of the queue
+   */
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    auto node = new Node(std::in_place, std::forward<Args>(args)...);
+    OperationGuard guard(reclaimer_);
+    // The position of the last node after the first lost race; the item may
+    // be eliminated once the head reaches it
+    std::optional<uint64_t> age;
+    while (true) {
+      Node* last = tail_->load(std::memory_order_acquire);
+      Node* next = last->next_.load(std::memory_order_acquire);
+      if (last != tail_->load(std::memory_order_acquire)) {
+        continue;
+      }
+      if (next != nullptr) {
+        tail_->compare_exchange_strong(last, next, std::memory_order_release,
+                                       std::memory_order_relaxed);
+        continue;
+      }
+      node->position_ = last->position_ + 1;
+      if (last->next_.compare_exchange_strong(next, node,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        tail_->compare_exchange_strong(last, node, std::memory_order_release,
+                                       std::memory_order_relaxed);
+        return;
+      }
+
+      if (!age.has_value()) {
+        age = last->position_;
+      }
+      if (head_->load(std::memory_order_acquire)->position_ >= *age) {
+        std::optional<Node*> other_node = elimination_array_.visit(node);
+        if (other_node.has_value() && *other_node == nullptr) {
+          return;  // exchanged with a dequeue
+        }
+      }
+    }
+  }
+
+  /**
+   * Removes the item at the front of the queue
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto try_dequeue() -> std::optional<T> {
+    OperationGuard guard(reclaimer_);
+    while (true) {
+      Node* first = head_->load(std::memory_order_acquire);
+      Node* last = tail_->load(std::memory_order_acquire);
+      Node* next = first->next_.load(std::memory_order_acquire);
+      if (first != head_->load(std::memory_order_acquire)) {
+        continue;
+      }
+      if (first == last) {
+        if (next == nullptr) {
+          return std::nullopt;
+        }
+        tail_->compare_exchange_strong(last, next, std::memory_order_release,
+                                       std::memory_order_relaxed);
+        continue;
+      }
+      // Release passes the position of `next` on to enqueuers that check
+      // their age against the head
+      if (head_->compare_exchange_strong(first, next,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_relaxed)) {
+        // `next` is the new sentinel, whose value no other thread reads, and
+        // the guard keeps it alive even if a later dequeuer retires it
+        std::optional<T> value = next->value_.take();
+        reclaimer_.sched_for_reclaim(first);
+        return value;
+      }
+
+      std::optional<Node*> other_node = elimination_array_.visit(nullptr);
+      if (other_node.has_value() && *other_node != nullptr) {
+        // The node was never linked, and its enqueuer has let go of it
+        Node* node = *other_node;
+        std::optional<T> value = node->value_.take();
+        delete node;
+        return value;
+      }
+    }
+  }
+
+  /**
+   * Removes the item at the front of the queue
+   *
+   * @throws EmptyException if the queue was empty
+   */
+  auto dequeue() -> T {
+    std::optional<T> value = try_dequeue();
+    if (!value.has_value()) {
+      throw EmptyException("dequeue: Try to dequeue from an empty queue");
+    }
+    return std::move(*value);
+  }
+
+ private:
+  // Dequeuers only touch the head and enqueuers the tail
+  CacheAligned<std::atomic<Node*>> head_;
+  CacheAligned<std::atomic<Node*>> tail_;
+  EliminationArray<Node> elimination_array_;
+  Reclaimer reclaimer_;  // Frees dequeued sentinels
+};
+
+#endif  // ELIMINATION_QUEUE_H_
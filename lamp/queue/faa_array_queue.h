@@ -0,0 +1,220 @@
+#ifndef FAA_ARRAY_QUEUE_H_
+#define FAA_ARRAY_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "memory/epoch_based_reclamation.h"
+#include "memory/operation_guard.h"
+#include "util/cache_aligned.h"
+#include "util/common.h"
+
+/**
+ * FAAArrayQueue - An unbounded lock-free queue whose operations claim slots
+ * with fetch-and-add instead of retrying a CAS [Cor16]
+ *
+ * The queue is a Michael-Scott list of nodes that each hold an array of
+ * kNodeCapacity slots, in the spirit of LCRQ's ring of rings [Mor13], but
+ * without its double-width CAS. An enqueuer takes the next slot of the tail
+ * node with a fetch-and-add on the node's enqueue index and publishes its item
+ * with a CAS on the slot's state; a dequeuer takes the next slot of the head
+ * node the same way and swaps the slot to kTaken. Each fetch-and-add succeeds,
+ * so contending threads spread over different slots instead of retrying on a
+ * single pointer, and the CAS on a slot only fails if a dequeuer overtook the
+ * enqueuer of that slot. The list pointers are only CASed once per
+ * kNodeCapacity operations, when a node fills up or is drained.
+ *
+ * Drained nodes are freed by the `Reclaimer` once no operation can still be
+ * reading them.
+ */
+template<typename T, typename Reclaimer = EpochBasedReclamation>
+class FAAArrayQueue {
+  static_assert(!Reclaimer::kRequiresReservation,
+                "FAAArrayQueue reads nodes without reserving them, so it "
+                "needs a reclaimer that protects whole operations");
+
+  static constexpr uint32_t kEmpty = 0;
+  static constexpr uint32_t kFull = 1;
+  static constexpr uint32_t kTaken = 2;  // Dequeued, or skipped by a dequeuer
+
+  struct Slot {
+    std::atomic<uint32_t> state_{kEmpty};
+    alignas(T) std::byte storage_[sizeof(T)];
+
+    auto item() -> T* { return std::launder(reinterpret_cast<T*>(storage_)); }
+  };
+
+ public:
+  static constexpr size_t kNodeCapacity = 1024;
+
+ private:
+  struct Node {
+    // Enqueuers and dequeuers each hammer their own index
+    CacheAligned<std::atomic<size_t>> enqueue_index_{0};
+    CacheAligned<std::atomic<size_t>> dequeue_index_{0};
+    std::atomic<Node*> next_{nullptr};
+    Slot slots_[kNodeCapacity];
+
+    Node() = default;
+
+    // A node created to hold `value` in its first slot
+    explicit Node(T&& value) {
+      new (slots_[0].storage_) T(std::move(value));
+      slots_[0].state_.store(kFull, std::memory_order_relaxed);
+      enqueue_index_->store(1, std::memory_order_relaxed);
+    }
+
+    ~Node() {
+      for (auto& slot : slots_) {
+        if (slot.state_.load(std::memory_order_relaxed) == kFull) {
+          slot.item()->~T();
+        }
+      }
+    }
+  };
+
+ public:
+  FAAArrayQueue() {
+    auto node = new Node();
+    head_->store(node, std::memory_order_relaxed);
+    tail_->store(node, std::memory_order_relaxed);
+  }
+
+  FAAArrayQueue(const FAAArrayQueue&) = delete;
+  auto operator=(const FAAArrayQueue&) -> FAAArrayQueue& = delete;
+
+  ~FAAArrayQueue() {
+    Node* curr = head_->load(std::memory_order_relaxed);
+    while (curr != nullptr) {
+      Node* next = curr->next_.load(std::memory_order_relaxed);
+      delete curr;
+      curr = next;
+    }
+  }
+
+  /**
+   * Appends an item to the queue
+   *
+   * The item is moved into a slot, and back out of it if a dequeuer gave up on
+   * the slot first, so it is never copied.
+   */
+  auto enqueue(T value) -> void {
+    OperationGuard guard(reclaimer_);
+    while (true) {
+      Node* tail = tail_->load(std::memory_order_acquire);
+      size_t index = tail->enqueue_index_->fetch_add(1,
+                                                    std::memory_order_relaxed);
+      if (index >= kNodeCapacity) {
+        // The node is full: append a new one that holds the item
+        if (tail != tail_->load(std::memory_order_acquire)) {
+          continue;
+        }
+        Node* next = tail->next_.load(std::memory_order_acquire);
+        if (next == nullptr) {
+          auto node = new Node(std::move(value));
+          if (tail->next_.compare_exchange_strong(next, node,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+            tail_->compare_exchange_strong(tail, node,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed);
+            return;
+          }
+          value = std::move(*node->slots_[0].item());
+          delete node;
+        } else {
+          tail_->compare_exchange_strong(tail, next, std::memory_order_release,
+                                         std::memory_order_relaxed);
+        }
+        continue;
+      }
+
+      Slot& slot = tail->slots_[index];
+      new (slot.storage_) T(std::move(value));
+      uint32_t expected = kEmpty;
+      // Release publishes the item to the dequeuer of this slot
+      if (slot.state_.compare_exchange_strong(expected, kFull,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        return;
+      }
+      // A dequeuer gave up on the slot before the item arrived
+      value = std::move(*slot.item());
+      slot.item()->~T();
+    }
+  }
+
+  /**
+   * Constructs an item from `args` and appends it to the queue
+   */
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    enqueue(T(std::forward<Args>(args)...));
+  }
+
+  /**
+   * Removes the item at the front of the queue
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto try_dequeue() -> std::optional<T> {
+    OperationGuard guard(reclaimer_);
+    while (true) {
+      Node* head = head_->load(std::memory_order_acquire);
+      // Do not burn slots while the queue is empty
+      if (head->dequeue_index_->load(std::memory_order_relaxed) >=
+              head->enqueue_index_->load(std::memory_order_relaxed) &&
+          head->next_.load(std::memory_order_acquire) == nullptr) {
+        return std::nullopt;
+      }
+      size_t index = head->dequeue_index_->fetch_add(1,
+                                                     std::memory_order_relaxed);
+      if (index >= kNodeCapacity) {
+        // The node is drained: move on to the next one
+        Node* next = head->next_.load(std::memory_order_acquire);
+        if (next == nullptr) {
+          return std::nullopt;
+        }
+        if (head_->compare_exchange_strong(head, next,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+          reclaimer_.sched_for_reclaim(head);
+        }
+        continue;
+      }
+
+      Slot& slot = head->slots_[index];
+      if (slot.state_.exchange(kTaken, std::memory_order_acquire) == kFull) {
+        std::optional<T> value(std::move(*slot.item()));
+        slot.item()->~T();
+        return value;
+      }
+      // The enqueuer of this slot has not finished; it will retry elsewhere
+    }
+  }
+
+  /**
+   * Removes the item at the front of the queue
+   *
+   * @throws EmptyException if the queue was empty
+   */
+  auto dequeue() -> T {
+    std::optional<T> value = try_dequeue();
+    if (!value.has_value()) {
+      throw EmptyException("dequeue: Try to dequeue from an empty queue");
+    }
+    return std::move(*value);
+  }
+
+ private:
+  // Dequeuers only touch the head and enqueuers the tail
+  CacheAligned<std::atomic<Node*>> head_;
+  CacheAligned<std::atomic<Node*>> tail_;
+  Reclaimer reclaimer_;  // Frees drained nodes
+};
+
+#endif  // FAA_ARRAY_QUEUE_H_
@@ -0,0 +1,67 @@
+#ifndef FLAT_COMBINING_QUEUE_H_
+#define FLAT_COMBINING_QUEUE_H_
+
+#include <optional>
+#include <queue>
+#include <utility>
+
+#include "synchronization/flat_combining.h"
+#include "util/common.h"
+
+/**
+ * FlatCombiningQueue - An unbounded FIFO queue whose operations are applied to
+ * a sequential std::queue by a FlatCombining combiner
+ */
+template<typename T>
+class FlatCombiningQueue {
+ public:
+  auto enqueue(T value) -> void {
+    queue_.apply(
+        [&value](std::queue<T>& queue) { queue.push(std::move(value)); });
+  }
+
+  /**
+   * Constructs an item from `args` at the back of the queue; the combiner
+   * constructs it in place from the caller's arguments
+   */
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    queue_.apply([&args...](std::queue<T>& queue) {
+      queue.emplace(std::forward<Args>(args)...);
+    });
+  }
+
+  /**
+   * Removes the item at the front of the queue
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto try_dequeue() -> std::optional<T> {
+    return queue_.apply([](std::queue<T>& queue) -> std::optional<T> {
+      if (queue.empty()) {
+        return std::nullopt;
+      }
+      std::optional<T> value(std::move(queue.front()));
+      queue.pop();
+      return value;
+    });
+  }
+
+  /**
+   * Removes the item at the front of the queue
+   *
+   * @throws EmptyException if the queue was empty
+   */
+  auto dequeue() -> T {
+    std::optional<T> value = try_dequeue();
+    if (!value.has_value()) {
+      throw EmptyException("dequeue: Try to dequeue from an empty queue");
+    }
+    return std::move(*value);
+  }
+
+ private:
+  FlatCombining<std::queue<T>> queue_;
+};
+
+#endif  // FLAT_COMBINING_QUEUE_H_
@@ -1,21 +1,43 @@
 #ifndef LOCK_FREE_QUEUE_H_
 #define LOCK_FREE_QUEUE_H_
 
+#include <algorithm>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <utility>
 
+#include "counting/sharded_counter.h"
+#include "util/atomic_stamped_ptr.h"
+#include "util/backoff.h"
+#include "util/cache_aligned.h"
 #include "util/common.h"
+#include "util/intrusive_hook.h"
+#include "util/node_value.h"
+#include "util/stats.h"
 
-template<typename T>
+/**
+ * LockFreeQueue - The unbounded lock-free queue of Michael and Scott
+ *
+ * Removed nodes are kept on a garbage list and freed with the queue. An
+ * operation whose CAS fails waits according to `RetryBackoff` (NoBackoff or
+ * PauseBackoff, see backoff.h) before it retries, which keeps many producers
+ * from collapsing onto the tail. BasketsQueue goes further and has them insert
+ * elsewhere.
+ */
+template<typename T, typename RetryBackoff = NoBackoff>
 class LockFreeQueue {
   struct Node {
-    std::optional<T> value_{};          // Optional to distinguish dummy nodes
+    NodeValue<T> value_{};              // Empty in the sentinel
     std::atomic<Node*> next_{nullptr};  // Atomic for thread-safe linking
     Node* next_deleted_{nullptr};       // Non-atomic link for garbage list
 
     Node() = default;
 
-    Node(const T& value) : value_(value) {}
+    template<typename... Args>
+    explicit Node(std::in_place_t, Args&&... args)
+        : value_(std::in_place, std::forward<Args>(args)...) {}
   };
 
  public:
@@ -23,8 +45,8 @@ class LockFreeQueue {
     // Create sentinel node that always remains in the queue
     auto node = new Node();
     std::atomic_thread_fence(std::memory_order_release);
-    head_.store(node, std::memory_order_relaxed);
-    tail_.store(node, std::memory_order_relaxed);
+    head_->store(node, std::memory_order_relaxed);
+    tail_->store(node, std::memory_order_relaxed);
   }
 
   ~LockFreeQueue() {
@@ -38,7 +60,7 @@ class LockFreeQueue {
     }
 
     // Phase 2: Clean remaining nodes in queue including sentinel
-    curr = head_.load(std::memory_order_relaxed);
+    curr = head_->load(std::memory_order_relaxed);
     while (curr != nullptr) {
       Node* next = curr->next_.load(std::memory_order_relaxed);
       delete curr;
@@ -46,17 +68,24 @@ class LockFreeQueue {
     }
   }
 
-  auto enqueue(const T& value) -> void {
-    auto node = new Node(value);
+  auto enqueue(T value) -> void { emplace(std::move(value)); }
+
+  /**
+   * Constructs an item from `args` at the back of the queue
+   */
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    auto node = new Node(std::in_place, std::forward<Args>(args)...);
+    RetryBackoff backoff;
     while (true) {
       // Load current tail and its next pointer
-      Node* last = tail_.load(std::memory_order_acquire);
+      Node* last = tail_->load(std::memory_order_acquire);
       Node* next = last->next_.load(std::memory_order_acquire);
 
       // Double-check tail hasn't changed. Note that this check may seem
       // vulnerable to ABA, but our deferred deletion scheme (nodes only
       // freed in destructor) prevents ABA problems
-      if (last == tail_.load(std::memory_order_acquire)) {
+      if (last == tail_->load(std::memory_order_acquire)) {
         if (next == nullptr) {
           // Attempt to link new node at the end
           // If successful, try to update tail (might fail if others help)
@@ -64,68 +93,321 @@ class LockFreeQueue {
                                                   std::memory_order_release,
                                                   std::memory_order_relaxed)) {
             // Tail update is best-effort; other threads might do it first
-            tail_.compare_exchange_strong(last, node, std::memory_order_release,
-                                          std::memory_order_relaxed);
+            tail_->compare_exchange_strong(last, node,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed);
+            size_counter_.add(1);
             return;
           }
         } else {
           // Tail is lagging behind; help advance it
           // This helps maintain queue consistency across threads
-          tail_.compare_exchange_strong(last, next, std::memory_order_release,
-                                        std::memory_order_relaxed);
+          tail_->compare_exchange_strong(last, next, std::memory_order_release,
+                                         std::memory_order_relaxed);
         }
       }
       // Loop continues if CAS fails or tail changed
+      LAMP_STAT_INC(Stat::kCasFailures);
+      backoff.backoff();
     }
   }
 
-  auto dequeue() -> T {
+  /**
+   * Appends the items in [first, last) to the queue, in order
+   *
+   * The nodes are linked into a private chain first, and the chain is spliced
+   * after the last node with a single CAS, so the batch costs about as much
+   * synchronization as one enqueue and its items are never interleaved with
+   * those of other enqueuers.
+   */
+  template<typename InputIt>
+  auto enqueue_bulk(InputIt first, InputIt last) -> void {
+    if (first == last) {
+      return;
+    }
+    auto chain_head = new Node(std::in_place, *first);
+    Node* chain_tail = chain_head;
+    int64_t chain_size = 1;
+    for (++first; first != last; ++first) {
+      auto node = new Node(std::in_place, *first);
+      chain_tail->next_.store(node, std::memory_order_relaxed);
+      chain_tail = node;
+      chain_size++;
+    }
+
+    RetryBackoff backoff;
     while (true) {
-      Node* first = head_.load(std::memory_order_acquire);
-      Node* last = tail_.load(std::memory_order_acquire);
+      Node* last_node = tail_->load(std::memory_order_acquire);
+      Node* next = last_node->next_.load(std::memory_order_acquire);
+      if (last_node == tail_->load(std::memory_order_acquire)) {
+        if (next == nullptr) {
+          // Release publishes the links of the whole chain
+          if (last_node->next_.compare_exchange_strong(
+                  next, chain_head, std::memory_order_release,
+                  std::memory_order_relaxed)) {
+            // If another thread swings the tail to `chain_head` first, later
+            // operations help it along the chain one node at a time
+            tail_->compare_exchange_strong(last_node, chain_tail,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed);
+            size_counter_.add(chain_size);
+            return;
+          }
+        } else {
+          tail_->compare_exchange_strong(last_node, next,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed);
+        }
+      }
+      LAMP_STAT_INC(Stat::kCasFailures);
+      backoff.backoff();
+    }
+  }
+
+  /**
+   * Removes the item at the front of the queue
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto try_dequeue() -> std::optional<T> {
+    RetryBackoff backoff;
+    while (true) {
+      Node* first = head_->load(std::memory_order_acquire);
+      Node* last = tail_->load(std::memory_order_acquire);
       Node* next = first->next_.load(std::memory_order_acquire);
 
       // Verify head hasn't changed. Note that this check may seem
       // vulnerable to ABA, but our deferred deletion scheme (nodes only
       // freed in destructor) prevents ABA problems
-      if (first == head_.load(std::memory_order_acquire)) {
+      if (first == head_->load(std::memory_order_acquire)) {
         if (first == last) {
           if (next == nullptr) {
             // Queue is empty (head=tail and no next node)
-            throw EmptyException("dequeue: Try to dequeue from an empty queue");
+            return std::nullopt;
           }
           // Special case: last node being enqueued, help finish it
-          tail_.compare_exchange_strong(last, next, std::memory_order_release,
-                                        std::memory_order_relaxed);
+          tail_->compare_exchange_strong(last, next, std::memory_order_release,
+                                         std::memory_order_relaxed);
         } else {
           // Normal case: remove head node
-          if (head_.compare_exchange_strong(first, next,
-                                            std::memory_order_release)) {
-            // Successfully dequeued, add old head to garbage list
-            T value = next->value_.value();
+          if (head_->compare_exchange_strong(first, next,
+                                             std::memory_order_release)) {
+            // `next` is the new sentinel, whose value no other thread reads
+            std::optional<T> value = next->value_.take();
             add_to_garbage(first);
+            size_counter_.add(-1);
             return value;
           }
         }
       }
       // Loop continues if CAS fails or head changed
+      LAMP_STAT_INC(Stat::kCasFailures);
+      backoff.backoff();
     }
   }
 
+  /**
+   * Removes the item at the front of the queue
+   *
+   * @throws EmptyException if the queue was empty
+   */
+  auto dequeue() -> T {
+    std::optional<T> value = try_dequeue();
+    if (!value.has_value()) {
+      throw EmptyException("dequeue: Try to dequeue from an empty queue");
+    }
+    return std::move(*value);
+  }
+
+  /**
+   * Removes up to `max` items from the front of the queue
+   *
+   * Swings the head over all the removed nodes with a single CAS. The head is
+   * never moved past the tail: on reaching a lagging tail, the dequeuer first
+   * helps advance it.
+   *
+   * @param out receives the removed items, in order
+   * @return the number of items removed; 0 if the queue was empty
+   */
+  template<typename OutputIt>
+  auto dequeue_bulk(OutputIt out, size_t max) -> size_t {
+    if (max == 0) {
+      return 0;
+    }
+    RetryBackoff backoff;
+    while (true) {
+      Node* first = head_->load(std::memory_order_acquire);
+      Node* last = tail_->load(std::memory_order_acquire);
+      Node* new_head = first;
+      size_t count = 0;
+      while (count < max) {
+        Node* next = new_head->next_.load(std::memory_order_acquire);
+        if (next == nullptr) {
+          break;
+        }
+        if (new_head == last) {
+          // Help the lagging tail, so the head stays behind it
+          tail_->compare_exchange_strong(last, next, std::memory_order_release,
+                                         std::memory_order_relaxed);
+          last = next;
+        }
+        new_head = next;
+        count++;
+      }
+      if (count == 0) {
+        return 0;
+      }
+      if (head_->compare_exchange_strong(first, new_head,
+                                         std::memory_order_release)) {
+        // The nodes are never freed before the queue is, so their values can
+        // be read after they are unlinked
+        Node* node = first;
+        Node* garbage_tail = first;
+        for (size_t i = 0; i < count; i++) {
+          garbage_tail = node;
+          node = node->next_.load(std::memory_order_relaxed);
+          garbage_tail->next_deleted_ = node;
+          *out++ = node->value_.take();
+        }
+        add_to_garbage(first, garbage_tail);
+        size_counter_.add(-static_cast<int64_t>(count));
+        return count;
+      }
+      LAMP_STAT_INC(Stat::kCasFailures);
+      backoff.backoff();
+    }
+  }
+
+  /**
+   * Returns the number of items in the queue
+   *
+   * Enqueues and dequeues count themselves in per-thread shards, which are
+   * only summed up here, so tracking the size adds no shared write to the
+   * operations. The answer is approximate: it may miss operations in progress.
+   */
+  auto approx_size() const -> size_t {
+    return static_cast<size_t>(std::max<int64_t>(size_counter_.get(), 0));
+  }
+
  private:
   // Add node to garbage list for deferred deletion
-  auto add_to_garbage(Node* node) -> void {
+  auto add_to_garbage(Node* node) -> void { add_to_garbage(node, node); }
+
+  // Add a chain of nodes, already linked through `next_deleted_`, to the
+  // garbage list
+  auto add_to_garbage(Node* first, Node* last) -> void {
     // Simple lock-free linked list insertion
-    node->next_deleted_ = garbage_list_.load(std::memory_order_relaxed);
-    while (!garbage_list_.compare_exchange_weak(node->next_deleted_, node,
+    last->next_deleted_ = garbage_list_.load(std::memory_order_relaxed);
+    while (!garbage_list_.compare_exchange_weak(last->next_deleted_, first,
                                                 std::memory_order_relaxed)) {
       // Retry if CAS fails due to concurrent modifications
     }
   }
 
-  std::atomic<Node*> head_;  // Points to sentinel or first real node
-  std::atomic<Node*> tail_;  // Points to last node (might lag)
+  // Dequeuers update the head and the garbage list, and enqueuers the tail, so
+  // each side gets its own cache line
+  CacheAligned<std::atomic<Node*>> head_;  // Points to sentinel or first node
   std::atomic<Node*> garbage_list_{nullptr};  // Deferred deletion list
+  CacheAligned<std::atomic<Node*>> tail_;  // Points to last node (might lag)
+  ShardedCounter size_counter_;  // Enqueues minus dequeues, per thread
+};
+
+/**
+ * IntrusiveLockFreeQueue - An unbounded multi-producer multi-consumer queue of
+ * caller-allocated nodes
+ *
+ * `T` must derive from IntrusiveHook. The queue never allocates: enqueueing
+ * links the caller's node, and dequeueing hands it back. As in
+ * IntrusiveMPSCQueue, a producer swaps itself into the tail with a single
+ * exchange and then links its predecessor to it, so enqueue is wait-free and
+ * no link is ever the target of a CAS. Consumers unlink the first node with a
+ * CAS on the stamped head, so a consumer that lost a race fails even if the
+ * node has since been dequeued and enqueued again.
+ *
+ * Unlike in LockFreeQueue, the head is the first node rather than a sentinel,
+ * so a node is out of the queue as soon as it is dequeued. A node can only be
+ * unlinked once a node is linked behind it, so the last node gets an embedded
+ * stub node enqueued behind it, which is skipped when it reaches the front. A
+ * stalled producer hides the nodes enqueued after its own until it links its
+ * node.
+ *
+ * A dequeued node may be enqueued again right away, but its memory must stay
+ * valid while other threads may be inside an operation on the queue, since a
+ * consumer that lost the race for it may still read its link. Nodes taken
+ * from an arena that outlives the queue satisfy this.
+ */
+template<typename T>
+class IntrusiveLockFreeQueue {
+ public:
+  IntrusiveLockFreeQueue() {
+    head_->set(&stub_, 0, std::memory_order_relaxed);
+  }
+
+  IntrusiveLockFreeQueue(const IntrusiveLockFreeQueue&) = delete;
+  auto operator=(const IntrusiveLockFreeQueue&)
+      -> IntrusiveLockFreeQueue& = delete;
+
+  /**
+   * Appends a node to the queue
+   *
+   * Wait-free.
+   */
+  auto enqueue(T* node) -> void { push(static_cast<IntrusiveHook*>(node)); }
+
+  /**
+   * Removes the node at the front of the queue
+   *
+   * @return the node, or nullptr if no node is ready to be dequeued
+   */
+  auto try_dequeue() -> T* {
+    while (true) {
+      auto [first, stamp] = head_->get(std::memory_order_acquire);
+      IntrusiveHook* next = first->next_.get_ptr(std::memory_order_acquire);
+      if (next == nullptr) {
+        IntrusiveHook* last = tail_->load(std::memory_order_acquire);
+        if (head_->get_stamp(std::memory_order_acquire) != stamp) {
+          // `first` was dequeued, and its link may belong to a newer enqueue
+          continue;
+        }
+        if (first == &stub_ || first != last) {
+          // Empty, or a producer has taken the tail but not linked its node
+          return nullptr;
+        }
+        // `first` is the last node; put the stub behind it so it can be
+        // removed, unless another consumer already does
+        if (!stub_queued_.exchange(true, std::memory_order_acq_rel)) {
+          push(&stub_);
+        }
+        continue;
+      }
+      if (head_->compare_and_swap(first, next, stamp, stamp + 1,
+                                  std::memory_order_acquire,
+                                  std::memory_order_relaxed)) {
+        if (first != &stub_) {
+          return static_cast<T*>(first);
+        }
+        // Skipped the stub, which may now be enqueued again
+        stub_queued_.store(false, std::memory_order_release);
+      }
+    }
+  }
+
+ private:
+  auto push(IntrusiveHook* node) -> void {
+    node->next_.set(nullptr, false, std::memory_order_relaxed);
+    IntrusiveHook* prev = tail_->exchange(node, std::memory_order_acq_rel);
+    // Release publishes the node to the consumers. `prev` can not be dequeued
+    // before this store, since it is the last node until then.
+    prev->next_.set(node, false, std::memory_order_release);
+  }
+
+  IntrusiveHook stub_;
+  std::atomic<bool> stub_queued_{true};
+
+  // Consumers update the head and producers the tail, so each side gets its
+  // own cache line
+  CacheAligned<AtomicStampedPtr<IntrusiveHook>> head_;
+  CacheAligned<std::atomic<IntrusiveHook*>> tail_{&stub_};
 };
 
 #endif  // LOCK_FREE_QUEUE_H_
@@ -0,0 +1,368 @@
+#ifndef MAPPED_QUEUE_H_
+#define MAPPED_QUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+/**
+ * MappedRecord - A length-prefixed record of up to `N` bytes, to pass
+ * variable-sized messages through a MappedQueue of fixed-size slots
+ */
+template<size_t N>
+struct MappedRecord {
+  uint32_t size_{0};
+  std::byte data_[N];
+
+  /**
+   * @return false, leaving the record alone, if `bytes` does not fit
+   */
+  auto assign(std::span<const std::byte> bytes) -> bool {
+    if (bytes.size() > N) {
+      return false;
+    }
+    std::memcpy(data_, bytes.data(), bytes.size());
+    size_ = static_cast<uint32_t>(bytes.size());
+    return true;
+  }
+
+  auto bytes() const -> std::span<const std::byte> { return {data_, size_}; }
+};
+
+/**
+ * MappedQueue - A bounded multi-producer multi-consumer queue whose ring
+ * buffer lives in a memory-mapped file, shared by every process that maps it
+ *
+ * The ring is that of MPMCQueue [Vyu10]: a slot's sequence number tells whose
+ * turn it is, and enqueuers and dequeuers claim positions with a CAS on their
+ * own counter. Everything lives in the mapping, including the counters, and
+ * is addressed by position rather than by pointer, so every process may map
+ * the file at a different address. An item is copied into its slot once by
+ * the producer and out of it once by the consumer, with no copy through the
+ * kernel in between.
+ *
+ * Items must be trivially copyable, since they are copied as bytes and may be
+ * read by another process; MappedRecord carries variable-sized payloads. The
+ * file outlives the processes, so a queue reopened after a restart still
+ * holds the items that were enqueued and not dequeued. enqueue() and
+ * dequeue() sleep on process-shared futexes in the mapping (elsewhere, they
+ * yield in a loop).
+ *
+ * Opening a file that is empty or new lays out an empty queue; opening an
+ * existing one checks that it was laid out for the same item size and
+ * capacity. A process that dies between claiming a position and publishing
+ * its slot leaves that slot unfinished, and the queue stops at it, as in
+ * MPMCQueue when a thread stalls; so does one that dies while laying out a
+ * new file, which must then be removed.
+ */
+template<typename T>
+  requires std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>
+class MappedQueue {
+  // The layout is shared by processes that may be built with different
+  // settings, so it is padded to a fixed line size rather than to
+  // kCacheLineSize
+  static constexpr size_t kLineSize = 64;
+  static constexpr uint64_t kMagic = 0x6c616d702d6d7171;  // "lamp-mqq"
+
+  static_assert(std::atomic<uint32_t>::is_always_lock_free &&
+                    std::atomic<uint64_t>::is_always_lock_free,
+                "MappedQueue needs address-free atomics");
+
+  // Lets threads of any process sleep until the other side makes progress,
+  // like EventCount
+  struct SharedEventCount {
+    std::atomic<uint32_t> epoch_;
+    std::atomic<uint32_t> waiters_;
+
+    auto prepare_wait() -> uint32_t {
+      waiters_.fetch_add(1, std::memory_order_seq_cst);
+      return epoch_.load(std::memory_order_seq_cst);
+    }
+
+    auto cancel_wait() -> void {
+      waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    auto wait(uint32_t key) -> void {
+      while (epoch_.load(std::memory_order_acquire) == key) {
+#ifdef __linux__
+        // Not FUTEX_WAIT_PRIVATE, so that wakeups cross processes
+        syscall(SYS_futex, &epoch_, FUTEX_WAIT, key, nullptr, nullptr, 0);
+#else
+        std::this_thread::yield();
+#endif
+      }
+      waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    auto notify_all() -> void {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiters_.load(std::memory_order_relaxed) != 0) {
+        epoch_.fetch_add(1, std::memory_order_release);
+#ifdef __linux__
+        syscall(SYS_futex, &epoch_, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+      }
+    }
+  };
+
+  struct Header {
+    std::atomic<uint32_t> state_;  // kFresh, kInitializing or kReady
+    uint32_t item_size_;
+    uint64_t magic_;
+    uint64_t capacity_;
+    uint64_t slot_size_;
+    alignas(kLineSize) std::atomic<uint64_t> enqueue_pos_;
+    alignas(kLineSize) std::atomic<uint64_t> dequeue_pos_;
+    alignas(kLineSize) SharedEventCount not_empty_;
+    alignas(kLineSize) SharedEventCount not_full_;
+  };
+
+  struct Slot {
+    std::atomic<uint64_t> sequence_;
+    alignas(T) std::byte storage_[sizeof(T)];
+  };
+
+  static constexpr uint32_t kFresh = 0;  // The file was zero-filled
+  static constexpr uint32_t kInitializing = 1;
+  static constexpr uint32_t kReady = 2;
+  // How long an opener waits for another one to lay out a fresh file
+  static constexpr std::chrono::seconds kInitTimeout{1};
+
+ public:
+  /**
+   * Maps the queue in the file at `path`, creating the file if needed
+   *
+   * @param path a regular file, or a file under /dev/shm to keep the queue in
+   * memory only
+   * @param capacity the number of slots, rounded up to a power of two
+   * @throws std::system_error if the file can not be opened or mapped
+   * @throws std::runtime_error if the file holds a queue of another layout,
+   * or something else of the same size, or if another opener started laying
+   * out the queue but did not finish within `kInitTimeout`, e.g. because it
+   * died
+   */
+  MappedQueue(const std::string& path, size_t capacity)
+      : capacity_(std::bit_ceil(std::max<size_t>(capacity, 2))),
+        mask_(capacity_ - 1),
+        mapping_size_(sizeof(Header) + capacity_ * sizeof(Slot)) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), path);
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 ||
+        (st.st_size == 0 &&
+         ::ftruncate(fd, static_cast<off_t>(mapping_size_)) != 0)) {
+      int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), path);
+    }
+    if (st.st_size != 0 && static_cast<size_t>(st.st_size) != mapping_size_) {
+      ::close(fd);
+      throw std::runtime_error("MappedQueue: " + path +
+                               " holds a queue of another size");
+    }
+    void* base = ::mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+    int error = errno;
+    // The mapping keeps the file open
+    ::close(fd);
+    if (base == MAP_FAILED) {
+      throw std::system_error(error, std::generic_category(), path);
+    }
+    header_ = static_cast<Header*>(base);
+    slots_ = reinterpret_cast<Slot*>(static_cast<std::byte*>(base) +
+                                     sizeof(Header));
+
+    uint32_t state = kFresh;
+    if (header_->state_.compare_exchange_strong(state, kInitializing,
+                                                std::memory_order_acquire)) {
+      initialize();
+      state = kReady;
+    } else {
+      auto deadline = std::chrono::steady_clock::now() + kInitTimeout;
+      while (state == kInitializing &&
+             std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+        state = header_->state_.load(std::memory_order_acquire);
+      }
+    }
+    if (state == kInitializing) {
+      ::munmap(base, mapping_size_);
+      throw std::runtime_error("MappedQueue: " + path +
+                               " was never fully initialized");
+    }
+    // Any other state than kReady means the file is not a MappedQueue
+    if (state != kReady || header_->magic_ != kMagic ||
+        header_->item_size_ != sizeof(T) ||
+        header_->slot_size_ != sizeof(Slot) ||
+        header_->capacity_ != capacity_) {
+      ::munmap(base, mapping_size_);
+      throw std::runtime_error("MappedQueue: " + path +
+                               " holds a queue of another layout");
+    }
+  }
+
+  MappedQueue(const MappedQueue&) = delete;
+  auto operator=(const MappedQueue&) -> MappedQueue& = delete;
+
+  /**
+   * Unmaps the queue; the items stay in the file
+   */
+  ~MappedQueue() { ::munmap(header_, mapping_size_); }
+
+  /**
+   * Copies an item into the queue if it is not full
+   *
+   * Lock-free.
+   *
+   * @return true if the item was enqueued, false if the queue was full
+   */
+  auto try_enqueue(const T& value) -> bool {
+    uint64_t pos = header_->enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[pos & mask_];
+      uint64_t sequence = slot.sequence_.load(std::memory_order_acquire);
+      auto diff = static_cast<int64_t>(sequence - pos);
+      if (diff == 0) {
+        if (header_->enqueue_pos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          std::memcpy(slot.storage_, &value, sizeof(T));
+          // Release publishes the item to the dequeuer of this position, in
+          // any process
+          slot.sequence_.store(pos + 1, std::memory_order_release);
+          header_->not_empty_.notify_all();
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = header_->enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Copies the item at the front of the queue out and frees its slot, if the
+   * queue is not empty
+   *
+   * Lock-free.
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto try_dequeue() -> std::optional<T> {
+    uint64_t pos = header_->dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[pos & mask_];
+      uint64_t sequence = slot.sequence_.load(std::memory_order_acquire);
+      auto diff = static_cast<int64_t>(sequence - (pos + 1));
+      if (diff == 0) {
+        if (header_->dequeue_pos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          T value;
+          std::memcpy(&value, slot.storage_, sizeof(T));
+          slot.sequence_.store(pos + capacity_, std::memory_order_release);
+          header_->not_full_.notify_all();
+          return value;
+        }
+      } else if (diff < 0) {
+        return std::nullopt;
+      } else {
+        pos = header_->dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Copies an item into the queue, sleeping while the queue is full
+   */
+  auto enqueue(const T& value) -> void {
+    while (!try_enqueue(value)) {
+      uint32_t key = header_->not_full_.prepare_wait();
+      if (try_enqueue(value)) {
+        header_->not_full_.cancel_wait();
+        return;
+      }
+      header_->not_full_.wait(key);
+    }
+  }
+
+  /**
+   * Removes the item at the front of the queue, sleeping while the queue is
+   * empty
+   */
+  auto dequeue() -> T {
+    while (true) {
+      if (std::optional<T> value = try_dequeue()) {
+        return *value;
+      }
+      uint32_t key = header_->not_empty_.prepare_wait();
+      if (std::optional<T> value = try_dequeue()) {
+        header_->not_empty_.cancel_wait();
+        return *value;
+      }
+      header_->not_empty_.wait(key);
+    }
+  }
+
+  auto capacity() const -> size_t { return capacity_; }
+
+  /**
+   * Returns the number of claimed enqueue positions minus the number of
+   * claimed dequeue positions, as MPMCQueue::approx_size()
+   */
+  auto approx_size() const -> size_t {
+    uint64_t dequeued = header_->dequeue_pos_.load(std::memory_order_relaxed);
+    uint64_t enqueued = header_->enqueue_pos_.load(std::memory_order_relaxed);
+    return enqueued > dequeued
+               ? static_cast<size_t>(std::min<uint64_t>(enqueued - dequeued,
+                                                        capacity_))
+               : 0;
+  }
+
+ private:
+  // Lays out an empty queue in a fresh file, and then lets other openers in
+  auto initialize() -> void {
+    header_->item_size_ = sizeof(T);
+    header_->slot_size_ = sizeof(Slot);
+    header_->magic_ = kMagic;
+    header_->capacity_ = capacity_;
+    header_->enqueue_pos_.store(0, std::memory_order_relaxed);
+    header_->dequeue_pos_.store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < capacity_; i++) {
+      slots_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+    header_->state_.store(kReady, std::memory_order_release);
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  const size_t mapping_size_;
+  Header* header_;
+  Slot* slots_;
+};
+
+#endif  // MAPPED_QUEUE_H_
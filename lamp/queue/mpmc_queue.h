@@ -0,0 +1,221 @@
+#ifndef MPMC_QUEUE_H_
+#define MPMC_QUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "util/cache_aligned.h"
+
+/**
+ * MPMCQueue - A bounded lock-free multi-producer multi-consumer queue
+ *
+ * Items are stored in a ring buffer of slots allocated once by the
+ * constructor, so enqueueing and dequeueing never allocate. Each slot has a
+ * sequence number that tells which lap of the ring it is in: a slot whose
+ * sequence equals an enqueuer's position is free for that enqueuer, and a
+ * slot whose sequence is one past a dequeuer's position holds the item that
+ * dequeuer is looking for. Enqueuers and dequeuers claim positions with a
+ * single CAS on their own counter, and then hand the slot over to the other
+ * side by publishing its next sequence number [Vyu10].
+ *
+ * The capacity is rounded up to a power of two, so that a position maps to a
+ * slot with a mask.
+ *
+ * If constructing an item throws, the enqueuer still publishes the slot it
+ * claimed, marked empty, and rethrows; the dequeuer of that position frees
+ * the slot and moves on, so the ring never waits for an item that will not
+ * come.
+ */
+template<typename T>
+class MPMCQueue {
+  struct Slot {
+    std::atomic<size_t> sequence_;
+    // Whether the enqueuer constructed an item; published with the sequence
+    bool full_;
+    alignas(T) std::byte storage_[sizeof(T)];
+
+    auto item() -> T* { return std::launder(reinterpret_cast<T*>(storage_)); }
+  };
+
+ public:
+  explicit MPMCQueue(size_t capacity)
+      : capacity_(std::bit_ceil(std::max<size_t>(capacity, 2))),
+        mask_(capacity_ - 1),
+        slots_(new Slot[capacity_]) {
+    for (size_t i = 0; i < capacity_; i++) {
+      slots_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MPMCQueue(const MPMCQueue&) = delete;
+  auto operator=(const MPMCQueue&) -> MPMCQueue& = delete;
+
+  ~MPMCQueue() {
+    // Destroy the items that were never dequeued
+    while (try_dequeue().has_value()) {}
+  }
+
+  /**
+   * Appends an item to the queue if it is not full
+   *
+   * Lock-free.
+   *
+   * @return true if the item was enqueued, false if the queue was full
+   */
+  auto try_enqueue(const T& value) -> bool { return try_emplace(value); }
+
+  /**
+   * Moves an item into the queue if it is not full, and leaves it alone
+   * otherwise
+   */
+  auto try_enqueue(T&& value) -> bool { return try_emplace(std::move(value)); }
+
+  /**
+   * Constructs an item from `args` at the back of the queue if it is not full,
+   * and leaves `args` untouched if it is.
+   *
+   * @return true if the item was enqueued, false if the queue was full
+   * @throws whatever the constructor of T throws, with no item enqueued
+   */
+  template<typename... Args>
+  auto try_emplace(Args&&... args) -> bool {
+    size_t pos = enqueue_pos_->load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[pos & mask_];
+      size_t sequence = slot.sequence_.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        // The slot is free in this lap; claim its position
+        if (enqueue_pos_->compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+          try {
+            new (slot.storage_) T(std::forward<Args>(args)...);
+          } catch (...) {
+            // Hand the empty slot over anyway, so that it does not block
+            // the ring
+            slot.full_ = false;
+            slot.sequence_.store(pos + 1, std::memory_order_release);
+            throw;
+          }
+          slot.full_ = true;
+          // Release publishes the item to the dequeuer of this position
+          slot.sequence_.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // The slot still holds the item of the previous lap
+        return false;
+      } else {
+        // Another enqueuer claimed the position; catch up
+        pos = enqueue_pos_->load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Removes the item at the front of the queue if it is not empty
+   *
+   * Lock-free.
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto try_dequeue() -> std::optional<T> {
+    size_t pos = dequeue_pos_->load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[pos & mask_];
+      size_t sequence = slot.sequence_.load(std::memory_order_acquire);
+      auto diff =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        // The slot holds the item of this lap; claim its position
+        if (dequeue_pos_->compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+          if (!slot.full_) {
+            // The enqueuer's constructor threw; free the slot and move on
+            slot.sequence_.store(pos + capacity_, std::memory_order_release);
+            pos++;
+            continue;
+          }
+          std::optional<T> value(std::move(*slot.item()));
+          std::destroy_at(slot.item());
+          // Free the slot for the enqueuer of the next lap
+          slot.sequence_.store(pos + capacity_, std::memory_order_release);
+          return value;
+        }
+      } else if (diff < 0) {
+        // No item has been enqueued at this position yet
+        return std::nullopt;
+      } else {
+        // Another dequeuer claimed the position; catch up
+        pos = dequeue_pos_->load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Appends an item to the queue, waiting while the queue is full
+   */
+  auto enqueue(T value) -> void { emplace(std::move(value)); }
+
+  /**
+   * Constructs an item from `args` at the back of the queue, waiting while the
+   * queue is full
+   */
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    // A failed attempt leaves `args` untouched
+    while (!try_emplace(std::forward<Args>(args)...)) {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * Removes the item at the front of the queue, waiting while the queue is
+   * empty
+   */
+  auto dequeue() -> T {
+    while (true) {
+      if (auto value = try_dequeue()) {
+        return std::move(*value);
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  auto capacity() const -> size_t { return capacity_; }
+
+  /**
+   * Returns the number of claimed enqueue positions minus the number of
+   * claimed dequeue positions, from the two counters the operations already
+   * maintain
+   *
+   * The answer is approximate: positions are claimed before their items are
+   * written or read, and the counters are not read at the same instant. It is
+   * always within [0, capacity].
+   */
+  auto approx_size() const -> size_t {
+    size_t dequeued = dequeue_pos_->load(std::memory_order_relaxed);
+    size_t enqueued = enqueue_pos_->load(std::memory_order_relaxed);
+    return enqueued > dequeued ? std::min(enqueued - dequeued, capacity_) : 0;
+  }
+
+ private:
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+  // Enqueuers and dequeuers each update their own counter, so each gets its
+  // own cache line
+  CacheAligned<std::atomic<size_t>> enqueue_pos_{0};
+  CacheAligned<std::atomic<size_t>> dequeue_pos_{0};
+};
+
+#endif  // MPMC_QUEUE_H_
@@ -0,0 +1,182 @@
+#ifndef MPSC_QUEUE_H_
+#define MPSC_QUEUE_H_
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+#include "util/cache_aligned.h"
+#include "util/common.h"
+
+/**
+ * MPSCHook - The link a type needs to be stored in an IntrusiveMPSCQueue
+ */
+struct MPSCHook {
+  std::atomic<MPSCHook*> next_{nullptr};
+};
+
+/**
+ * IntrusiveMPSCQueue - An unbounded multi-producer single-consumer queue of
+ * caller-allocated nodes (Vyukov)
+ *
+ * `T` must derive from MPSCHook. The queue never allocates: enqueueing links
+ * the caller's node, and dequeueing hands it back. A producer swaps itself into
+ * `tail_` with a single exchange and then links its predecessor to it, so
+ * enqueue is wait-free. Between these two steps the consumer cannot see the
+ * new node or any node behind it, and reports the queue as empty.
+ *
+ * An embedded stub node keeps the list non-empty, so that the last node can be
+ * dequeued while producers keep appending behind it. A node must not be
+ * destroyed or enqueued again before it is dequeued.
+ */
+template<typename T>
+class IntrusiveMPSCQueue {
+ public:
+  IntrusiveMPSCQueue() = default;
+
+  IntrusiveMPSCQueue(const IntrusiveMPSCQueue&) = delete;
+  auto operator=(const IntrusiveMPSCQueue&) -> IntrusiveMPSCQueue& = delete;
+
+  /**
+   * Appends a node to the queue
+   *
+   * Wait-free.
+   */
+  auto enqueue(T* node) -> void { push(static_cast<MPSCHook*>(node)); }
+
+  /**
+   * Removes the node at the front of the queue. Must only be called by the
+   * consumer.
+   *
+   * Lock-free for the consumer alone, but a stalled producer hides the nodes
+   * enqueued after its own until it finishes.
+   *
+   * @return the node, or nullptr if no node is ready to be dequeued
+   */
+  auto try_dequeue() -> T* {
+    MPSCHook* head = *head_;
+    MPSCHook* next = head->next_.load(std::memory_order_acquire);
+    if (head == &stub_) {
+      if (next == nullptr) {
+        return nullptr;
+      }
+      // Skip the stub
+      *head_ = next;
+      head = next;
+      next = next->next_.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+      *head_ = next;
+      return static_cast<T*>(head);
+    }
+    if (head != tail_->load(std::memory_order_acquire)) {
+      // A producer has taken the tail but not linked its node yet
+      return nullptr;
+    }
+    // `head` is the last node; put the stub behind it so it can be removed
+    push(&stub_);
+    next = head->next_.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      *head_ = next;
+      return static_cast<T*>(head);
+    }
+    return nullptr;
+  }
+
+ private:
+  auto push(MPSCHook* node) -> void {
+    node->next_.store(nullptr, std::memory_order_relaxed);
+    MPSCHook* prev = tail_->exchange(node, std::memory_order_acq_rel);
+    // Release publishes the node to the consumer
+    prev->next_.store(node, std::memory_order_release);
+  }
+
+  MPSCHook stub_;
+
+  // Producers only touch `tail_`, and the consumer mostly `head_`
+  CacheAligned<std::atomic<MPSCHook*>> tail_{&stub_};
+  CacheAligned<MPSCHook*> head_{&stub_};
+};
+
+/**
+ * MPSCQueue - An unbounded multi-producer single-consumer queue of values
+ *
+ * Allocates one node per item and queues it in an IntrusiveMPSCQueue, so
+ * enqueue is a single wait-free exchange and only the consumer frees nodes;
+ * unlike LockFreeQueue, no node has to outlive its removal. At most one thread
+ * may dequeue at a time.
+ */
+template<typename T>
+class MPSCQueue {
+  struct Node : MPSCHook {
+    T value_;
+
+    template<typename... Args>
+    explicit Node(std::in_place_t, Args&&... args)
+        : value_(std::forward<Args>(args)...) {}
+  };
+
+ public:
+  MPSCQueue() = default;
+
+  MPSCQueue(const MPSCQueue&) = delete;
+  auto operator=(const MPSCQueue&) -> MPSCQueue& = delete;
+
+  ~MPSCQueue() {
+    while (Node* node = queue_.try_dequeue()) {
+      delete node;
+    }
+  }
+
+  /**
+   * Appends an item to the queue
+   *
+   * Wait-free, apart from allocating the node.
+   */
+  auto enqueue(T value) -> void { emplace(std::move(value)); }
+
+  /**
+   * Constructs an item from `args` at the back of the queue
+   *
+   * Wait-free, apart from allocating the node.
+   */
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    queue_.enqueue(new Node(std::in_place, std::forward<Args>(args)...));
+  }
+
+  /**
+   * Removes the item at the front of the queue. Must only be called by the
+   * consumer.
+   *
+   * @return the item, or std::nullopt if no item is ready to be dequeued
+   */
+  auto try_dequeue() -> std::optional<T> {
+    Node* node = queue_.try_dequeue();
+    if (node == nullptr) {
+      return std::nullopt;
+    }
+    std::optional<T> value(std::move(node->value_));
+    delete node;
+    return value;
+  }
+
+  /**
+   * Removes the item at the front of the queue. Must only be called by the
+   * consumer.
+   *
+   * @throws EmptyException if no item is ready to be dequeued
+   */
+  auto dequeue() -> T {
+    auto value = try_dequeue();
+    if (!value.has_value()) {
+      throw EmptyException("dequeue: Try to dequeue from an empty queue");
+    }
+    return std::move(*value);
+  }
+
+ private:
+  IntrusiveMPSCQueue<Node> queue_;
+};
+
+#endif  // MPSC_QUEUE_H_
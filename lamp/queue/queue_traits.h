@@ -0,0 +1,60 @@
+#ifndef QUEUE_TRAITS_H_
+#define QUEUE_TRAITS_H_
+
+#include "queue/lock_free_queue.h"
+#include "queue/mpmc_queue.h"
+#include "queue/mpsc_queue.h"
+#include "queue/spsc_queue.h"
+
+/**
+ * How many threads may use one side of a queue at the same time
+ */
+enum class Concurrency {
+  kSingle,
+  kMulti,
+};
+
+/**
+ * QueueTraits - Picks the cheapest queue for a number of producers and
+ * consumers
+ *
+ * `Bounded<T>` is a fixed-capacity ring buffer whose `enqueue()` and
+ * `dequeue()` wait while the queue is full or empty, and `Unbounded<T>` a
+ * node-based queue whose `dequeue()` throws EmptyException on an empty queue. A
+ * queue chosen for a single producer or consumer must not be used by more than
+ * one thread on that side.
+ *
+ * | Producers | Consumers | Bounded      | Unbounded       |
+ * | --------- | --------- | ------------ | --------------- |
+ * | kSingle   | kSingle   | `SPSCQueue`  | `MPSCQueue`     |
+ * | kMulti    | kSingle   | `MPMCQueue`  | `MPSCQueue`     |
+ * | any       | kMulti    | `MPMCQueue`  | `LockFreeQueue` |
+ */
+template<Concurrency Producers, Concurrency Consumers>
+struct QueueTraits {
+  template<typename T>
+  using Bounded = MPMCQueue<T>;
+
+  template<typename T>
+  using Unbounded = LockFreeQueue<T>;
+};
+
+template<>
+struct QueueTraits<Concurrency::kSingle, Concurrency::kSingle> {
+  template<typename T>
+  using Bounded = SPSCQueue<T>;
+
+  template<typename T>
+  using Unbounded = MPSCQueue<T>;
+};
+
+template<>
+struct QueueTraits<Concurrency::kMulti, Concurrency::kSingle> {
+  template<typename T>
+  using Bounded = MPMCQueue<T>;
+
+  template<typename T>
+  using Unbounded = MPSCQueue<T>;
+};
+
+#endif  // QUEUE_TRAITS_H_
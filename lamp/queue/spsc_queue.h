@@ -0,0 +1,161 @@
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "util/cache_aligned.h"
+
+/**
+ * SPSCQueue - A bounded wait-free single-producer single-consumer queue
+ *
+ * A ring buffer indexed by two ever-increasing counters: the producer is the
+ * only thread that writes `tail_` and the consumer the only one that writes
+ * `head_`, so neither side needs a read-modify-write instruction. Each side
+ * also keeps a private copy of the other side's counter and re-reads the
+ * shared one only when the copy says the queue is full (for the producer) or
+ * empty (for the consumer), so in the common case an operation touches no
+ * cache line written by the other thread.
+ *
+ * At most one thread may enqueue and at most one thread may dequeue at a time.
+ * The capacity is rounded up to a power of two.
+ */
+template<typename T>
+class SPSCQueue {
+  struct Slot {
+    alignas(T) std::byte storage_[sizeof(T)];
+
+    auto item() -> T* { return std::launder(reinterpret_cast<T*>(storage_)); }
+  };
+
+ public:
+  explicit SPSCQueue(size_t capacity)
+      : capacity_(std::bit_ceil(std::max<size_t>(capacity, 1))),
+        mask_(capacity_ - 1),
+        slots_(new Slot[capacity_]) {}
+
+  SPSCQueue(const SPSCQueue&) = delete;
+  auto operator=(const SPSCQueue&) -> SPSCQueue& = delete;
+
+  ~SPSCQueue() {
+    // Destroy the items that were never dequeued
+    while (try_dequeue().has_value()) {}
+  }
+
+  /**
+   * Appends an item to the queue if it is not full. Must only be called by the
+   * producer.
+   *
+   * Wait-free.
+   *
+   * @return true if the item was enqueued, false if the queue was full
+   */
+  auto try_enqueue(const T& value) -> bool { return try_emplace(value); }
+
+  /**
+   * Moves an item into the queue if it is not full, and leaves it alone
+   * otherwise
+   */
+  auto try_enqueue(T&& value) -> bool { return try_emplace(std::move(value)); }
+
+  /**
+   * Constructs an item from `args` at the back of the queue if it is not full,
+   * and leaves `args` untouched if it is. Must only be called by the producer.
+   *
+   * @return true if the item was enqueued, false if the queue was full
+   */
+  template<typename... Args>
+  auto try_emplace(Args&&... args) -> bool {
+    size_t tail = tail_->load(std::memory_order_relaxed);
+    if (tail - cached_head_ == capacity_) {
+      // Acquire makes sure the consumer has moved the item out of the slot
+      cached_head_ = head_->load(std::memory_order_acquire);
+      if (tail - cached_head_ == capacity_) {
+        return false;
+      }
+    }
+    new (slots_[tail & mask_].storage_) T(std::forward<Args>(args)...);
+    // Release publishes the item to the consumer
+    tail_->store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Removes the item at the front of the queue if it is not empty. Must only
+   * be called by the consumer.
+   *
+   * Wait-free.
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto try_dequeue() -> std::optional<T> {
+    size_t head = head_->load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_->load(std::memory_order_acquire);
+      if (head == cached_tail_) {
+        return std::nullopt;
+      }
+    }
+    Slot& slot = slots_[head & mask_];
+    std::optional<T> value(std::move(*slot.item()));
+    std::destroy_at(slot.item());
+    // Release hands the slot back to the producer
+    head_->store(head + 1, std::memory_order_release);
+    return value;
+  }
+
+  /**
+   * Appends an item to the queue, waiting while the queue is full
+   */
+  auto enqueue(T value) -> void { emplace(std::move(value)); }
+
+  /**
+   * Constructs an item from `args` at the back of the queue, waiting while the
+   * queue is full
+   */
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    // A failed attempt leaves `args` untouched
+    while (!try_emplace(std::forward<Args>(args)...)) {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * Removes the item at the front of the queue, waiting while the queue is
+   * empty
+   */
+  auto dequeue() -> T {
+    while (true) {
+      if (auto value = try_dequeue()) {
+        return std::move(*value);
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  auto capacity() const -> size_t { return capacity_; }
+
+ private:
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+  // Every CacheAligned member starts a new cache line, so the producer's state
+  // (following `tail_`) and the consumer's state (following `head_`) never
+  // share one
+  CacheAligned<std::atomic<size_t>> tail_{0};
+  size_t cached_head_{0};  // The producer's copy of `head_`
+
+  CacheAligned<std::atomic<size_t>> head_{0};
+  size_t cached_tail_{0};  // The consumer's copy of `tail_`
+};
+
+#endif  // SPSC_QUEUE_H_
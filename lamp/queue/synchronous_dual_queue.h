@@ -0,0 +1,298 @@
+#ifndef SYNCHRONOUS_DUAL_QUEUE_H_
+#define SYNCHRONOUS_DUAL_QUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "memory/epoch_based_reclamation.h"
+#include "memory/operation_guard.h"
+#include "util/cache_aligned.h"
+
+/**
+ * SynchronousDualQueue - A lock-free synchronous queue in which every enqueuer
+ * waits for a dequeuer to take its item, and vice versa [Sch04]
+ *
+ * The queue is a Michael-Scott list whose nodes are either all items offered
+ * by waiting enqueuers or all reservations of waiting dequeuers. A thread that
+ * finds waiters of its own type (or none) appends its node and waits on it; a
+ * thread that finds waiters of the other type fulfils the oldest one directly
+ * and returns, so each transfer touches only the two threads involved. Waiters
+ * spin on their own node for kSpinCount iterations and then park on it with
+ * std::atomic::wait.
+ *
+ * `offer()` and `poll()` give up after a timeout, and leave a cancelled node
+ * behind that later operations skip. Since std::atomic::wait has no timeout,
+ * timed waiters yield instead of parking.
+ *
+ * A node is freed by the `Reclaimer` once it has left the list and its waiter
+ * has returned.
+ */
+template<typename T, typename Reclaimer = EpochBasedReclamation>
+class SynchronousDualQueue {
+  static_assert(!Reclaimer::kRequiresReservation,
+                "SynchronousDualQueue traverses the list without validating "
+                "each hop, so it needs a reclaimer that protects whole "
+                "operations");
+
+  using Clock = std::chrono::steady_clock;
+
+  enum class NodeType {
+    kItem,
+    kReservation,
+  };
+
+  // The states of a node; only a waiter cancels its node, and only the thread
+  // that claimed it fulfils it
+  static constexpr uint32_t kWaiting = 0;
+  static constexpr uint32_t kClaimed = 1;  // A partner is transferring the item
+  static constexpr uint32_t kFulfilled = 2;
+  static constexpr uint32_t kCancelled = 3;
+
+  struct Node {
+    NodeType type_;
+    std::optional<T> value_;
+    std::atomic<uint32_t> state_{kWaiting};
+    std::atomic<Node*> next_{nullptr};
+    // The list and the waiter each own a reference, so that the node is
+    // retired only when both are done with it
+    std::atomic<int> owners_;
+
+    Node(NodeType type, std::optional<T> value, int owners)
+        : type_(type), value_(std::move(value)), owners_(owners) {}
+  };
+
+ public:
+  static constexpr int kSpinCount = 128;
+
+  SynchronousDualQueue() {
+    auto sentinel = new Node(NodeType::kItem, std::nullopt, 1);
+    head_->store(sentinel, std::memory_order_relaxed);
+    tail_->store(sentinel, std::memory_order_relaxed);
+  }
+
+  SynchronousDualQueue(const SynchronousDualQueue&) = delete;
+  auto operator=(const SynchronousDualQueue&)
+      -> SynchronousDualQueue& = delete;
+
+  ~SynchronousDualQueue() {
+    // Nodes that have left the list are owned by the reclaimer
+    Node* curr = head_->load(std::memory_order_relaxed);
+    while (curr != nullptr) {
+      Node* next = curr->next_.load(std::memory_order_relaxed);
+      delete curr;
+      curr = next;
+    }
+  }
+
+  /**
+   * Hands an item to a dequeuer, waiting until one takes it
+   */
+  auto enqueue(T value) -> void {
+    std::optional<T> item(std::move(value));
+    transfer(item, NodeType::kItem, std::nullopt);
+  }
+
+  /**
+   * Takes an item from an enqueuer, waiting until one offers it
+   */
+  auto dequeue() -> T {
+    std::optional<T> item;
+    transfer(item, NodeType::kReservation, std::nullopt);
+    return std::move(*item);
+  }
+
+  /**
+   * Takes the item of an enqueuer that is already waiting, if any, without
+   * waiting for one to arrive
+   */
+  auto try_dequeue() -> std::optional<T> {
+    std::optional<T> item;
+    transfer(item, NodeType::kReservation, Clock::now());
+    return item;
+  }
+
+  /**
+   * Hands an item to a dequeuer, waiting at most `timeout` for one to take it
+   *
+   * @return true if a dequeuer took the item
+   */
+  template<typename Rep, typename Period>
+  auto offer(T value, const std::chrono::duration<Rep, Period>& timeout)
+      -> bool {
+    std::optional<T> item(std::move(value));
+    return transfer(item, NodeType::kItem, deadline_after(timeout));
+  }
+
+  /**
+   * Takes an item from an enqueuer, waiting at most `timeout` for one to
+   * offer it
+   *
+   * @return the item, or std::nullopt on timeout
+   */
+  template<typename Rep, typename Period>
+  auto poll(const std::chrono::duration<Rep, Period>& timeout)
+      -> std::optional<T> {
+    std::optional<T> item;
+    transfer(item, NodeType::kReservation, deadline_after(timeout));
+    return item;
+  }
+
+ private:
+  template<typename Rep, typename Period>
+  static auto deadline_after(const std::chrono::duration<Rep, Period>& timeout)
+      -> Clock::time_point {
+    return Clock::now() + std::chrono::ceil<Clock::duration>(timeout);
+  }
+
+  /**
+   * Hands `item` over to a dequeuer (kItem), or receives an enqueuer's item
+   * into `item` (kReservation). Fulfils the oldest waiter of the other type if
+   * there is one, and otherwise waits in line until `deadline`, if any.
+   *
+   * @return true if the transfer took place
+   */
+  auto transfer(std::optional<T>& item, NodeType type,
+                std::optional<Clock::time_point> deadline) -> bool {
+    Node* node = nullptr;
+    {
+      OperationGuard guard(reclaimer_);
+      while (true) {
+        Node* tail = tail_->load(std::memory_order_acquire);
+        Node* head = head_->load(std::memory_order_acquire);
+        if (head == tail || tail->type_ == type) {
+          // Empty, or only waiters of the same type: wait behind them
+          Node* next = tail->next_.load(std::memory_order_acquire);
+          if (tail != tail_->load(std::memory_order_acquire)) {
+            continue;
+          }
+          if (next != nullptr) {
+            tail_->compare_exchange_strong(tail, next,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed);
+            continue;
+          }
+          if (node == nullptr) {
+            if (deadline.has_value() && Clock::now() >= *deadline) {
+              return false;
+            }
+            node = new Node(type, std::move(item), 2);
+          }
+          if (tail->next_.compare_exchange_strong(next, node,
+                                                  std::memory_order_release,
+                                                  std::memory_order_relaxed)) {
+            tail_->compare_exchange_strong(tail, node,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed);
+            break;
+          }
+        } else {
+          // Only waiters of the other type: fulfil the oldest one
+          Node* next = head->next_.load(std::memory_order_acquire);
+          if (tail != tail_->load(std::memory_order_acquire) ||
+              head != head_->load(std::memory_order_acquire) ||
+              next == nullptr) {
+            continue;
+          }
+          if (node != nullptr) {
+            // An earlier attempt to append failed; take the item back
+            item = std::move(node->value_);
+            delete node;
+            node = nullptr;
+          }
+          uint32_t expected = kWaiting;
+          bool claimed = next->state_.compare_exchange_strong(
+              expected, kClaimed, std::memory_order_acquire,
+              std::memory_order_relaxed);
+          if (claimed) {
+            if (type == NodeType::kItem) {
+              next->value_ = std::move(item);
+            } else {
+              item = std::move(next->value_);
+            }
+            // The reclaimer keeps the node alive until the guard is released,
+            // even if its waiter returns right after the store
+            next->state_.store(kFulfilled, std::memory_order_release);
+            next->state_.notify_one();
+          }
+          // Either way, the waiter at the front is no longer waiting
+          advance_head(head, next);
+          if (claimed) {
+            return true;
+          }
+        }
+      }
+    }
+
+    // Wait outside the guard, so that parked threads do not hold up
+    // reclamation; the node's own reference keeps it alive
+    bool fulfilled = await(node, deadline);
+
+    OperationGuard guard(reclaimer_);
+    // Help remove the node if it is still at the front
+    Node* head = head_->load(std::memory_order_acquire);
+    if (head->next_.load(std::memory_order_acquire) == node) {
+      advance_head(head, node);
+    }
+    if (fulfilled && type == NodeType::kReservation) {
+      item = std::move(node->value_);
+    }
+    release(node);
+    return fulfilled;
+  }
+
+  /**
+   * Waits for a partner to fulfil `node`, or cancels it at `deadline`
+   *
+   * @return true if the node was fulfilled
+   */
+  static auto await(Node* node,
+                    const std::optional<Clock::time_point>& deadline) -> bool {
+    uint32_t state = node->state_.load(std::memory_order_acquire);
+    for (int i = 0; i < kSpinCount && state == kWaiting; i++) {
+      state = node->state_.load(std::memory_order_acquire);
+    }
+    if (deadline.has_value()) {
+      while (state == kWaiting && Clock::now() < *deadline) {
+        std::this_thread::yield();
+        state = node->state_.load(std::memory_order_acquire);
+      }
+      // Fails if a partner has claimed the node in the meantime
+      if (state == kWaiting &&
+          node->state_.compare_exchange_strong(state, kCancelled,
+                                               std::memory_order_acquire)) {
+        return false;
+      }
+    }
+    while (state != kFulfilled) {
+      node->state_.wait(state, std::memory_order_acquire);
+      state = node->state_.load(std::memory_order_acquire);
+    }
+    return true;
+  }
+
+  // Moves the head from `head` to `next`, and drops the list's reference to
+  // the old sentinel if it succeeds
+  auto advance_head(Node* head, Node* next) -> void {
+    if (head_->compare_exchange_strong(head, next, std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+      release(head);
+    }
+  }
+
+  auto release(Node* node) -> void {
+    if (node->owners_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      reclaimer_.sched_for_reclaim(node);
+    }
+  }
+
+  // Waiters of either type are appended at the tail and fulfilled at the head
+  CacheAligned<std::atomic<Node*>> head_;
+  CacheAligned<std::atomic<Node*>> tail_;
+  Reclaimer reclaimer_;
+};
+
+#endif  // SYNCHRONOUS_DUAL_QUEUE_H_
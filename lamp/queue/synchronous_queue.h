@@ -3,31 +3,32 @@
 
 #include <optional>
 #include "synchronization/condition_variable.h"
+#include "synchronization/lock.h"
 #include "synchronization/scoped_lock.h"
 #include "synchronization/ttas_lock.h"
 
-template<typename T>
+template<typename T, BasicLockable Lock = TTASLock<>>
 class SynchronousQueue {
  public:
   auto enqueue(T value) -> void {
-    ScopedLock<TTASLock> lock(mutex_);
+    ScopedLock<Lock> lock(mutex_);
     while (enqueuing_) {
-      cv_.wait(mutex_);
+      cv_.wait(lock);
     }
     enqueuing_ = true;
     item_ = value;
     cv_.notify_all();
     while (item_.has_value()) {
-      cv_.wait(mutex_);
+      cv_.wait(lock);
     }
     enqueuing_ = false;
     cv_.notify_all();
   }
 
   auto dequeue() -> T {
-    ScopedLock<TTASLock> lock(mutex_);
+    ScopedLock<Lock> lock(mutex_);
     while (!item_.has_value()) {
-      cv_.wait(mutex_);
+      cv_.wait(lock);
     }
     T t = std::move(item_.value());
     item_ = std::nullopt;
@@ -35,10 +36,23 @@ class SynchronousQueue {
     return t;
   };
 
+  // Takes the item of an enqueuer that is waiting for a dequeuer, if any,
+  // without waiting for one to arrive.
+  auto try_dequeue() -> std::optional<T> {
+    ScopedLock<Lock> lock(mutex_);
+    if (!item_.has_value()) {
+      return std::nullopt;
+    }
+    std::optional<T> t = std::move(item_);
+    item_ = std::nullopt;
+    cv_.notify_all();
+    return t;
+  }
+
 private:
   std::optional<T> item_;
   bool enqueuing_{false};
-  TTASLock mutex_;
+  Lock mutex_;
   ConditionVariable cv_;
 };
 
@@ -1,21 +1,31 @@
 #ifndef UNBOUNDED_QUEUE_H_
 #define UNBOUNDED_QUEUE_H_
 
+#include <atomic>
+#include <cstddef>
 #include <optional>
+#include <utility>
 
+#include "synchronization/lock.h"
 #include "synchronization/scoped_lock.h"
 #include "synchronization/ttas_lock.h"
+#include "util/cache_aligned.h"
 #include "util/common.h"
+#include "util/node_value.h"
 
-template<typename T>
+template<typename T, BasicLockable Lock = TTASLock<>>
 class UnboundedQueue {
   struct Node {
-    std::optional<T> value_{};
-    Node* next_{nullptr};
+    NodeValue<T> value_{};  // Empty in the sentinel
+    // Written under the enqueue lock and read under the dequeue lock, so the
+    // link must be atomic for a dequeuer to see the item of the last node
+    std::atomic<Node*> next_{nullptr};
 
     Node() = default;
 
-    Node(const T& value) : value_(value) {}
+    template<typename... Args>
+    explicit Node(std::in_place_t, Args&&... args)
+        : value_(std::in_place, std::forward<Args>(args)...) {}
   };
 
  public:
@@ -27,38 +37,154 @@ class UnboundedQueue {
   ~UnboundedQueue() {
     Node* curr = head_;
     while (curr != nullptr) {
-      Node* next = curr->next_;
+      Node* next = curr->next_.load(std::memory_order_relaxed);
       delete curr;
       curr = next;
     }
   }
 
-  auto enqueue(const T& value) -> void {
-    ScopedLock<TTASLock> scoped_lock{enq_mutex_};
-    auto node = new Node(value);
-    tail_->next_ = node;
+  auto enqueue(T value) -> void { emplace(std::move(value)); }
+
+  /**
+   * Constructs an item from `args` at the back of the queue. The node is
+   * allocated before the lock is taken.
+   */
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    auto node = new Node(std::in_place, std::forward<Args>(args)...);
+    ScopedLock<Lock> scoped_lock{*enq_mutex_};
+    tail_->next_.store(node, std::memory_order_release);
     tail_ = node;
+    num_enqueued_.store(num_enqueued_.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
   }
 
-  auto dequeue() -> T {
-    ScopedLock<TTASLock> scoped_lock{deq_mutex_};
-    if (head_->next_ == nullptr) {
-      throw EmptyException("dequeue: Try to dequeue from an empty queue");
+  /**
+   * Appends the items in [first, last) to the queue, in order, taking the lock
+   * once for the whole batch. The nodes are allocated before the lock is
+   * taken.
+   */
+  template<typename InputIt>
+  auto enqueue_bulk(InputIt first, InputIt last) -> void {
+    if (first == last) {
+      return;
     }
+    auto chain_head = new Node(std::in_place, *first);
+    Node* chain_tail = chain_head;
+    size_t chain_size = 1;
+    for (++first; first != last; ++first) {
+      auto node = new Node(std::in_place, *first);
+      chain_tail->next_.store(node, std::memory_order_relaxed);
+      chain_tail = node;
+      chain_size++;
+    }
+
+    ScopedLock<Lock> scoped_lock{*enq_mutex_};
+    // Release publishes the links of the whole chain
+    tail_->next_.store(chain_head, std::memory_order_release);
+    tail_ = chain_tail;
+    num_enqueued_.store(
+        num_enqueued_.load(std::memory_order_relaxed) + chain_size,
+        std::memory_order_relaxed);
+  }
 
-    T value = head_->next_->value_.value();
-    Node* old_head = head_;
-    head_ = head_->next_;
+  /**
+   * Removes the item at the front of the queue
+   *
+   * @return the item, or std::nullopt if the queue was empty
+   */
+  auto try_dequeue() -> std::optional<T> {
+    Node* old_head;
+    std::optional<T> value;
+    {
+      ScopedLock<Lock> scoped_lock{*deq_mutex_};
+      Node* next = head_->next_.load(std::memory_order_acquire);
+      if (next == nullptr) {
+        return std::nullopt;
+      }
+
+      value = next->value_.take();
+      old_head = head_;
+      head_ = next;
+      num_dequeued_.store(num_dequeued_.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+    }
     delete old_head;
 
     return value;
   }
 
+  /**
+   * Removes the item at the front of the queue
+   *
+   * @throws EmptyException if the queue was empty
+   */
+  auto dequeue() -> T {
+    std::optional<T> value = try_dequeue();
+    if (!value.has_value()) {
+      throw EmptyException("dequeue: Try to dequeue from an empty queue");
+    }
+    return std::move(*value);
+  }
+
+  /**
+   * Removes up to `max` items from the front of the queue, taking the lock
+   * once for the whole batch. The removed nodes are freed after the lock is
+   * released.
+   *
+   * @param out receives the removed items, in order
+   * @return the number of items removed; 0 if the queue was empty
+   */
+  template<typename OutputIt>
+  auto dequeue_bulk(OutputIt out, size_t max) -> size_t {
+    Node* old_head;
+    Node* new_head;
+    size_t count = 0;
+    {
+      ScopedLock<Lock> scoped_lock{*deq_mutex_};
+      old_head = head_;
+      Node* next;
+      while (count < max &&
+             (next = head_->next_.load(std::memory_order_acquire)) != nullptr) {
+        head_ = next;
+        *out++ = head_->value_.take();
+        count++;
+      }
+      new_head = head_;
+      num_dequeued_.store(num_dequeued_.load(std::memory_order_relaxed) + count,
+                          std::memory_order_relaxed);
+    }
+
+    while (old_head != new_head) {
+      Node* next = old_head->next_.load(std::memory_order_relaxed);
+      delete old_head;
+      old_head = next;
+    }
+    return count;
+  }
+
+  /**
+   * Returns the number of items in the queue, without taking a lock
+   *
+   * Each side counts its own operations under its lock, so tracking the size
+   * adds no shared write. The answer is approximate: it may miss operations in
+   * progress.
+   */
+  auto approx_size() const -> size_t {
+    size_t dequeued = num_dequeued_.load(std::memory_order_relaxed);
+    size_t enqueued = num_enqueued_.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+  }
+
  private:
-  Node* head_;
+  // Enqueuers only touch the first line and dequeuers the second, so the two
+  // locks do not slow each other down
+  CacheAligned<Lock> enq_mutex_;
   Node* tail_;
-  TTASLock enq_mutex_;
-  TTASLock deq_mutex_;
+  std::atomic<size_t> num_enqueued_{0};  // Written under `enq_mutex_`
+  CacheAligned<Lock> deq_mutex_;
+  Node* head_;
+  std::atomic<size_t> num_dequeued_{0};  // Written under `deq_mutex_`
 };
 
 #endif  // UNBOUNDED_QUEUE_H_
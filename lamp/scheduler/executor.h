@@ -0,0 +1,327 @@
+#ifndef SCHEDULER_EXECUTOR_H_
+#define SCHEDULER_EXECUTOR_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "deque/work_stealing_deque.h"
+#include "queue/faa_array_queue.h"
+#include "synchronization/event_count.h"
+#include "util/backoff.h"
+#include "util/cache_aligned.h"
+#include "util/numa.h"
+#include "util/thread_index.h"
+
+/**
+ * The Scheduling policies of Executor decide where submitted tasks wait and
+ * where workers look for them. Each provides a `Queues<Task>` class with:
+ *
+ *   explicit Queues(size_t num_workers);
+ *   auto push(Task* task, size_t worker) -> void;
+ *   auto push_bulk(Task** first, Task** last, size_t worker) -> void;
+ *   auto pop(size_t worker) -> Task*;  // nullptr if no task was found
+ *
+ * `worker` is the index of the calling worker, or kNotAWorker for a thread
+ * outside the executor.
+ */
+inline constexpr size_t kNotAWorker = std::numeric_limits<size_t>::max();
+
+/**
+ * CentralQueue - Every task goes through one shared FAAArrayQueue, so tasks
+ * start roughly in submission order, at the price of all threads contending
+ * on its head and tail
+ */
+struct CentralQueue {
+  template<typename Task>
+  class Queues {
+   public:
+    explicit Queues(size_t /*num_workers*/) {}
+
+    auto push(Task* task, size_t /*worker*/) -> void { queue_.enqueue(task); }
+
+    auto push_bulk(Task** first, Task** last, size_t /*worker*/) -> void {
+      for (; first != last; ++first) {
+        queue_.enqueue(*first);
+      }
+    }
+
+    auto pop(size_t /*worker*/) -> Task* {
+      return queue_.try_dequeue().value_or(nullptr);
+    }
+
+   private:
+    FAAArrayQueue<Task*> queue_;
+  };
+};
+
+/**
+ * WorkStealing - As in WorkStealingPool: every worker owns a
+ * WorkStealingDeque and runs the tasks it submits itself newest first, tasks
+ * from outside go to a shared injection queue, and an idle worker steals the
+ * oldest task of a random victim
+ */
+struct WorkStealing {
+  template<typename Task>
+  class Queues {
+   public:
+    explicit Queues(size_t num_workers)
+        : num_workers_(num_workers),
+          deques_(std::make_unique<CacheAligned<WorkStealingDeque<Task*>>[]>(
+              num_workers)) {}
+
+    auto push(Task* task, size_t worker) -> void {
+      if (worker == kNotAWorker) {
+        injection_queue_.enqueue(task);
+      } else {
+        deques_[worker]->push(task);
+      }
+    }
+
+    auto push_bulk(Task** first, Task** last, size_t worker) -> void {
+      for (; first != last; ++first) {
+        push(*first, worker);
+      }
+    }
+
+    auto pop(size_t worker) -> Task* {
+      if (std::optional<Task*> task = deques_[worker]->pop()) {
+        return *task;
+      }
+      if (std::optional<Task*> task = injection_queue_.try_dequeue()) {
+        return *task;
+      }
+      size_t start = get_random_int<size_t>(0, num_workers_ - 1);
+      for (size_t i = 0; i < num_workers_; i++) {
+        size_t victim = (start + i) % num_workers_;
+        if (victim == worker) {
+          continue;
+        }
+        if (std::optional<Task*> task = deques_[victim]->steal()) {
+          return *task;
+        }
+      }
+      return nullptr;
+    }
+
+   private:
+    const size_t num_workers_;
+    std::unique_ptr<CacheAligned<WorkStealingDeque<Task*>>[]> deques_;
+    FAAArrayQueue<Task*> injection_queue_;
+  };
+};
+
+/**
+ * ShardedQueues - One FAAArrayQueue per worker, as in Sharded. A worker
+ * submits to its own queue and any other thread to the queue picked by its
+ * thread index, so threads that submit from different shards do not contend;
+ * a worker drains its own queue first and then takes from the others in turn.
+ * Unlike a deque, each shard keeps its tasks in FIFO order.
+ */
+struct ShardedQueues {
+  template<typename Task>
+  class Queues {
+   public:
+    explicit Queues(size_t num_workers)
+        : num_workers_(num_workers),
+          shards_(std::make_unique<CacheAligned<FAAArrayQueue<Task*>>[]>(
+              num_workers)) {}
+
+    auto push(Task* task, size_t worker) -> void {
+      shards_[shard_of(worker)]->enqueue(task);
+    }
+
+    auto push_bulk(Task** first, Task** last, size_t worker) -> void {
+      FAAArrayQueue<Task*>& shard = *shards_[shard_of(worker)];
+      for (; first != last; ++first) {
+        shard.enqueue(*first);
+      }
+    }
+
+    auto pop(size_t worker) -> Task* {
+      for (size_t i = 0; i < num_workers_; i++) {
+        size_t shard = (worker + i) % num_workers_;
+        if (std::optional<Task*> task = shards_[shard]->try_dequeue()) {
+          return *task;
+        }
+      }
+      return nullptr;
+    }
+
+   private:
+    auto shard_of(size_t worker) const -> size_t {
+      return worker == kNotAWorker ? this_thread_index() % num_workers_
+                                   : worker;
+    }
+
+    const size_t num_workers_;
+    std::unique_ptr<CacheAligned<FAAArrayQueue<Task*>>[]> shards_;
+  };
+};
+
+/**
+ * Executor - A fixed-size thread pool whose task queues are chosen by the
+ * `Scheduling` policy: CentralQueue, WorkStealing or ShardedQueues
+ *
+ * A worker that finds no task spins for a while, re-checking the queues
+ * between cpu_relax() pauses, and then parks on an EventCount, which sleeps on
+ * a futex. Submitting costs a single load of the waiter count unless a worker
+ * is parked, so a busy executor makes no system calls; submit_bulk() wakes at
+ * most one worker per task of the batch. Workers may be pinned to CPUs, one
+ * per CPU in order.
+ *
+ * The destructor runs all submitted tasks before it returns.
+ */
+template<typename Scheduling = WorkStealing>
+class Executor {
+ public:
+  using Task = std::function<void()>;
+
+  // How many times an idle worker re-checks the queues before parking
+  static constexpr int kSpinRounds = 64;
+
+  /**
+   * @param num_workers the number of worker threads, at least one
+   * @param pin_workers whether to pin worker `i` to CPU `i` modulo the number
+   * of CPUs
+   */
+  explicit Executor(
+      size_t num_workers = std::max(1U, std::thread::hardware_concurrency()),
+      bool pin_workers = false)
+      : num_workers_(std::max<size_t>(num_workers, 1)), queues_(num_workers_) {
+    size_t num_cpus = std::max(1U, std::thread::hardware_concurrency());
+    workers_.reserve(num_workers_);
+    for (size_t i = 0; i < num_workers_; i++) {
+      workers_.emplace_back([this, i, pin_workers, num_cpus]() {
+        if (pin_workers) {
+          pin_this_thread_to_cpu(static_cast<int>(i % num_cpus));
+        }
+        run(i);
+      });
+    }
+  }
+
+  Executor(const Executor&) = delete;
+  auto operator=(const Executor&) -> Executor& = delete;
+
+  ~Executor() {
+    wait_idle();
+    stop_.store(true, std::memory_order_release);
+    idle_workers_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /**
+   * Schedules a task
+   */
+  auto submit(Task task) -> void {
+    auto pending = new Task(std::move(task));
+    pending_->fetch_add(1, std::memory_order_relaxed);
+    queues_.push(pending, current_worker());
+    idle_workers_.notify_one();
+  }
+
+  /**
+   * Schedules the tasks in [first, last), counting them as pending and waking
+   * idle workers once for the whole batch
+   */
+  template<typename InputIt>
+  auto submit_bulk(InputIt first, InputIt last) -> void {
+    std::vector<Task*> batch;
+    if constexpr (std::forward_iterator<InputIt>) {
+      batch.reserve(std::distance(first, last));
+    }
+    for (; first != last; ++first) {
+      batch.push_back(new Task(*first));
+    }
+    if (batch.empty()) {
+      return;
+    }
+    pending_->fetch_add(batch.size(), std::memory_order_relaxed);
+    queues_.push_bulk(batch.data(), batch.data() + batch.size(),
+                      current_worker());
+    idle_workers_.notify(static_cast<uint32_t>(
+        std::min<size_t>(batch.size(), std::numeric_limits<uint32_t>::max())));
+  }
+
+  /**
+   * Waits until every submitted task, including the ones submitted by tasks,
+   * has finished. Must not be called from a task.
+   */
+  auto wait_idle() -> void {
+    while (pending_->load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  auto num_workers() const -> size_t { return num_workers_; }
+
+ private:
+  struct Context {
+    Executor* executor_;
+    size_t index_;
+  };
+
+  auto current_worker() const -> size_t {
+    return current_.executor_ == this ? current_.index_ : kNotAWorker;
+  }
+
+  auto run(size_t index) -> void {
+    current_ = {this, index};
+    while (Task* task = next_task(index)) {
+      (*task)();
+      delete task;
+      pending_->fetch_sub(1, std::memory_order_release);
+    }
+    current_ = {nullptr, 0};
+  }
+
+  // Spins, then parks until a task is found, or returns nullptr once the
+  // executor stops
+  auto next_task(size_t index) -> Task* {
+    for (int i = 0; i < kSpinRounds; i++) {
+      if (Task* task = queues_.pop(index)) {
+        return task;
+      }
+      cpu_relax();
+    }
+    while (true) {
+      uint32_t key = idle_workers_.prepare_wait();
+      if (Task* task = queues_.pop(index)) {
+        idle_workers_.cancel_wait();
+        return task;
+      }
+      if (stop_.load(std::memory_order_acquire)) {
+        idle_workers_.cancel_wait();
+        return nullptr;
+      }
+      idle_workers_.wait(key);
+      if (Task* task = queues_.pop(index)) {
+        return task;
+      }
+    }
+  }
+
+  // The executor and worker the calling thread belongs to, if any
+  inline static thread_local Context current_{nullptr, 0};
+
+  const size_t num_workers_;
+  typename Scheduling::template Queues<Task> queues_;
+  std::vector<std::thread> workers_;
+  EventCount idle_workers_;
+  CacheAligned<std::atomic<size_t>> pending_{0};  // Submitted but not finished
+  std::atomic<bool> stop_{false};
+};
+
+#endif  // SCHEDULER_EXECUTOR_H_
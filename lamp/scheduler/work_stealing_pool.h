@@ -0,0 +1,155 @@
+#ifndef WORK_STEALING_POOL_H_
+#define WORK_STEALING_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "deque/work_stealing_deque.h"
+#include "queue/unbounded_queue.h"
+#include "util/backoff.h"
+
+/**
+ * WorkStealingPool - A fixed-size thread pool in which every worker owns a
+ * WorkStealingDeque
+ *
+ * A task submitted from inside another task goes to the bottom of the current
+ * worker's deque, and the worker runs its own tasks newest first, so a task
+ * that forks subtasks keeps working on data that is still in its cache and
+ * never touches shared state. Tasks submitted from other threads go to a
+ * shared injection queue. A worker that runs out of tasks takes one from the
+ * injection queue, or steals the oldest task of a randomly chosen worker; the
+ * oldest task is usually the largest piece of the remaining work. Idle workers
+ * sleep with an exponential Backoff between attempts.
+ *
+ * The destructor runs all submitted tasks before it returns.
+ */
+class WorkStealingPool {
+  using Task = std::function<void()>;
+
+  struct Worker {
+    WorkStealingDeque<Task*> deque_;
+    std::thread thread_;
+  };
+
+  struct Context {
+    WorkStealingPool* pool_;
+    size_t index_;
+  };
+
+ public:
+  // The bounds of the idle backoff, in microseconds
+  static constexpr int64_t kMinIdleDelay = 1;
+  static constexpr int64_t kMaxIdleDelay = 1000;
+
+  /**
+   * @param num_workers the number of worker threads, at least one
+   */
+  explicit WorkStealingPool(
+      size_t num_workers = std::max(1U, std::thread::hardware_concurrency()))
+      : workers_(std::max<size_t>(num_workers, 1)) {
+    for (size_t i = 0; i < workers_.size(); i++) {
+      workers_[i].thread_ = std::thread([this, i]() { run(i); });
+    }
+  }
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  auto operator=(const WorkStealingPool&) -> WorkStealingPool& = delete;
+
+  ~WorkStealingPool() {
+    wait_idle();
+    stop_.store(true, std::memory_order_release);
+    for (auto& worker : workers_) {
+      worker.thread_.join();
+    }
+  }
+
+  /**
+   * Schedules a task. Tasks submitted by a task of this pool are run before
+   * older ones of the same worker, and may be stolen by other workers.
+   */
+  auto submit(Task task) -> void {
+    auto pending = new Task(std::move(task));
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    if (current_.pool_ == this) {
+      workers_[current_.index_].deque_.push(pending);
+    } else {
+      injection_queue_.enqueue(pending);
+    }
+  }
+
+  /**
+   * Waits until every submitted task, including the ones submitted by tasks,
+   * has finished. Must not be called from a task.
+   */
+  auto wait_idle() -> void {
+    while (pending_.load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  auto num_workers() const -> size_t { return workers_.size(); }
+
+ private:
+  auto run(size_t index) -> void {
+    current_ = {this, index};
+    while (true) {
+      Task* task = find_task(index);
+      if (task == nullptr) {
+        Backoff<std::chrono::microseconds> backoff(kMinIdleDelay,
+                                                   kMaxIdleDelay);
+        while (!stop_.load(std::memory_order_acquire) &&
+               (task = find_task(index)) == nullptr) {
+          backoff.backoff();
+        }
+        if (task == nullptr) {
+          break;
+        }
+      }
+      (*task)();
+      delete task;
+      pending_.fetch_sub(1, std::memory_order_release);
+    }
+    current_ = {nullptr, 0};
+  }
+
+  // Looks for a task in the worker's own deque, then in the injection queue,
+  // and then in the deques of the other workers, starting at a random one
+  auto find_task(size_t index) -> Task* {
+    if (std::optional<Task*> task = workers_[index].deque_.pop()) {
+      return *task;
+    }
+    if (std::optional<Task*> task = injection_queue_.try_dequeue()) {
+      return *task;
+    }
+    size_t num_workers = workers_.size();
+    size_t start = get_random_int<size_t>(0, num_workers - 1);
+    for (size_t i = 0; i < num_workers; i++) {
+      size_t victim = (start + i) % num_workers;
+      if (victim == index) {
+        continue;
+      }
+      if (std::optional<Task*> task = workers_[victim].deque_.steal()) {
+        return *task;
+      }
+    }
+    return nullptr;
+  }
+
+  // The pool and worker the calling thread belongs to, if any
+  inline static thread_local Context current_{nullptr, 0};
+
+  std::vector<Worker> workers_;
+  UnboundedQueue<Task*> injection_queue_;  // Tasks submitted from outside
+  std::atomic<size_t> pending_{0};         // Submitted but not finished
+  std::atomic<bool> stop_{false};
+};
+
+#endif  // WORK_STEALING_POOL_H_
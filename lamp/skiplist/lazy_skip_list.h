@@ -0,0 +1,311 @@
+#ifndef LAZY_SKIP_LIST_H_
+#define LAZY_SKIP_LIST_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "memory/epoch_based_reclamation.h"
+#include "memory/operation_guard.h"
+#include "synchronization/lock.h"
+#include "synchronization/ttas_lock.h"
+
+/**
+ * LazySkipList - A lock-based skip list set using lazy synchronization
+ * (Herlihy, Lev, Luchangco, Shavit) with expected O(log n) add, remove, and
+ * contains
+ *
+ * The skip list counterpart of LazyList: find() traverses without locks, and
+ * add() and remove() then lock only the predecessors of the affected node and
+ * validate that they are unmarked and still point to the expected successors.
+ * A node is in the set once it is fully linked at every level and until it is
+ * marked, so contains() takes no locks and is wait-free.
+ *
+ * As in the lists, nodes are ordered by the hash of their item, and two items
+ * with the same hash are considered equal. Removed nodes are freed by the
+ * `Reclaimer` once no concurrent traversal can reach them.
+ */
+template<typename T, typename Hash = std::hash<T>,
+         typename Reclaimer = EpochBasedReclamation,
+         BasicLockable Lock = TTASLock<>>
+class LazySkipList {
+  static_assert(!Reclaimer::kRequiresReservation,
+                "LazySkipList traverses the list without validating each hop, "
+                "so it needs a reclaimer that protects whole operations");
+
+  static constexpr int kMaxLevel = 24;
+
+  struct Node {
+    size_t key_;
+    std::optional<T> item_;
+    int top_level_;
+    std::vector<std::atomic<Node*>> next_;
+    std::atomic<bool> marked_{false};        // Logical deletion flag
+    std::atomic<bool> fully_linked_{false};  // Linked at every level
+    Lock mutex_;
+
+    Node(size_t key, int top_level)
+        : key_(key), top_level_(top_level), next_(top_level + 1) {}
+
+    Node(size_t key, const T& item, int top_level)
+        : key_(key), item_(item), top_level_(top_level), next_(top_level + 1) {}
+
+    auto lock() -> void { mutex_.lock(); }
+
+    auto unlock() -> void { mutex_.unlock(); }
+  };
+
+  using Window = std::array<Node*, kMaxLevel + 1>;
+
+ public:
+  LazySkipList() {
+    head_ = new Node(std::numeric_limits<size_t>::min(), kMaxLevel);
+    tail_ = new Node(std::numeric_limits<size_t>::max(), kMaxLevel);
+    for (int level = 0; level <= kMaxLevel; level++) {
+      head_->next_[level].store(tail_, std::memory_order_relaxed);
+    }
+    head_->fully_linked_.store(true, std::memory_order_relaxed);
+    tail_->fully_linked_.store(true, std::memory_order_relaxed);
+  }
+
+  LazySkipList(const LazySkipList&) = delete;
+  auto operator=(const LazySkipList&) -> LazySkipList& = delete;
+
+  /**
+   * Destructor - Frees all nodes still in the list. Removed nodes are owned by
+   * the reclaimer and freed by its destructor.
+   *
+   * NOT thread-safe - caller must ensure no other threads are accessing the
+   * list
+   */
+  ~LazySkipList() {
+    Node* curr = head_;
+    while (curr != nullptr) {
+      Node* next = curr->next_[0].load(std::memory_order_relaxed);
+      delete curr;
+      curr = next;
+    }
+  }
+
+  /**
+   * Adds an item to the set if it's not already present
+   *
+   * @param item The item to add
+   * @return true if the item was added, false if it already exists
+   */
+  auto add(const T& item) -> bool {
+    size_t key = get_hash_value(item);
+    int top_level = random_level();
+    Window preds;
+    Window succs;
+    OperationGuard guard(reclaimer_);
+
+    while (true) {
+      int found_level = find(key, preds, succs);
+      if (found_level != -1) {
+        Node* found = succs[found_level];
+        if (!found->marked_.load(std::memory_order_acquire)) {
+          // The item is being added by another thread; wait until it is in
+          // the set so that the failed add linearizes after the successful one
+          while (!found->fully_linked_.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+          }
+          return false;
+        }
+        // The node is being removed; retry once it has been unlinked
+        continue;
+      }
+
+      int highest_locked = -1;
+      bool valid = true;
+      for (int level = 0; valid && level <= top_level; level++) {
+        Node* pred = preds[level];
+        Node* succ = succs[level];
+        // The same node may be the predecessor at several levels
+        if (level == 0 || pred != preds[level - 1]) {
+          pred->lock();
+        }
+        highest_locked = level;
+        valid = !pred->marked_.load(std::memory_order_relaxed) &&
+                !succ->marked_.load(std::memory_order_relaxed) &&
+                pred->next_[level].load(std::memory_order_relaxed) == succ;
+      }
+
+      if (valid) {
+        auto node = new Node(key, item, top_level);
+        for (int level = 0; level <= top_level; level++) {
+          node->next_[level].store(succs[level], std::memory_order_relaxed);
+        }
+        for (int level = 0; level <= top_level; level++) {
+          preds[level]->next_[level].store(node, std::memory_order_release);
+        }
+        // Linearization point of a successful add
+        node->fully_linked_.store(true, std::memory_order_release);
+      }
+
+      unlock(preds, highest_locked);
+      if (valid) {
+        return true;
+      }
+    }
+  }
+
+  /**
+   * Removes an item from the set
+   *
+   * @param item The item to remove
+   * @return true if the item was found and removed, false otherwise
+   */
+  auto remove(const T& item) -> bool {
+    size_t key = get_hash_value(item);
+    Window preds;
+    Window succs;
+    OperationGuard guard(reclaimer_);
+
+    Node* victim = nullptr;
+    bool is_marked = false;
+    int top_level = -1;
+    while (true) {
+      int found_level = find(key, preds, succs);
+      if (!is_marked) {
+        if (found_level != -1) {
+          victim = succs[found_level];
+        }
+        // Only a fully linked, unmarked node that was found at its top level
+        // can be removed; otherwise it is being added or removed by another
+        // thread
+        if (found_level == -1 ||
+            !victim->fully_linked_.load(std::memory_order_acquire) ||
+            victim->top_level_ != found_level ||
+            victim->marked_.load(std::memory_order_acquire)) {
+          return false;
+        }
+        top_level = victim->top_level_;
+        victim->lock();
+        if (victim->marked_.load(std::memory_order_relaxed)) {
+          victim->unlock();
+          return false;
+        }
+        // Linearization point of a successful remove
+        victim->marked_.store(true, std::memory_order_release);
+        is_marked = true;
+      }
+
+      int highest_locked = -1;
+      bool valid = true;
+      for (int level = 0; valid && level <= top_level; level++) {
+        Node* pred = preds[level];
+        if (level == 0 || pred != preds[level - 1]) {
+          pred->lock();
+        }
+        highest_locked = level;
+        valid = !pred->marked_.load(std::memory_order_relaxed) &&
+                pred->next_[level].load(std::memory_order_relaxed) == victim;
+      }
+
+      if (valid) {
+        for (int level = top_level; level >= 0; level--) {
+          preds[level]->next_[level].store(
+              victim->next_[level].load(std::memory_order_relaxed),
+              std::memory_order_release);
+        }
+      }
+
+      unlock(preds, highest_locked);
+      if (valid) {
+        victim->unlock();
+        // Wait-free readers may still be traversing the victim, so its next
+        // pointers are left intact and the node is freed only when that is
+        // safe
+        reclaimer_.sched_for_reclaim(victim);
+        return true;
+      }
+    }
+  }
+
+  /**
+   * Checks if an item exists in the set
+   *
+   * Wait-free: no locks are acquired.
+   *
+   * @param item The item to check for
+   * @return true if the item exists, is fully linked, and is not logically
+   * deleted
+   */
+  auto contains(const T& item) -> bool {
+    size_t key = get_hash_value(item);
+    Window preds;
+    Window succs;
+    OperationGuard guard(reclaimer_);
+
+    int found_level = find(key, preds, succs);
+    return found_level != -1 &&
+           succs[found_level]->fully_linked_.load(std::memory_order_acquire) &&
+           !succs[found_level]->marked_.load(std::memory_order_acquire);
+  }
+
+ private:
+  /**
+   * Finds, at every level, the window (pred, succ) with pred->key < key <=
+   * succ->key, without taking any locks
+   *
+   * @return the highest level at which a node holding the key was found, or
+   * -1 if there is none
+   */
+  auto find(size_t key, Window& preds, Window& succs) -> int {
+    int found_level = -1;
+    Node* pred = head_;
+    for (int level = kMaxLevel; level >= 0; level--) {
+      Node* curr = pred->next_[level].load(std::memory_order_acquire);
+      while (curr->key_ < key) {
+        pred = curr;
+        curr = pred->next_[level].load(std::memory_order_acquire);
+      }
+      if (found_level == -1 && curr != tail_ && curr->key_ == key) {
+        found_level = level;
+      }
+      preds[level] = pred;
+      succs[level] = curr;
+    }
+    return found_level;
+  }
+
+  /**
+   * Unlocks the distinct predecessors locked at levels [0, highest_locked]
+   */
+  static auto unlock(Window& preds, int highest_locked) -> void {
+    for (int level = 0; level <= highest_locked; level++) {
+      if (level == 0 || preds[level] != preds[level - 1]) {
+        preds[level]->unlock();
+      }
+    }
+  }
+
+  /**
+   * Draws the top level of a new node from a geometric distribution with
+   * p = 1/2, capped at kMaxLevel
+   */
+  static auto random_level() -> int {
+    thread_local std::minstd_rand gen{std::random_device{}()};
+    return std::min(std::countr_one(static_cast<uint32_t>(gen())), kMaxLevel);
+  }
+
+  auto get_hash_value(const T& item) const noexcept -> size_t {
+    return hash_fn_(item);
+  }
+
+  Node* head_{};    // Sentinel with the minimum key, linked at every level
+  Node* tail_{};    // Sentinel with the maximum key, linked at every level
+  Hash hash_fn_{};  // Hash function to generate keys from items
+  Reclaimer reclaimer_;  // Frees removed nodes once they are unreachable
+};
+
+#endif  // LAZY_SKIP_LIST_H_
@@ -0,0 +1,420 @@
+#ifndef LOCK_FREE_SKIP_LIST_H_
+#define LOCK_FREE_SKIP_LIST_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "memory/epoch_based_reclamation.h"
+#include "memory/operation_guard.h"
+#include "util/atomic_markable_ptr.h"
+
+/**
+ * LockFreeSkipList - A lock-free skip list based set (Herlihy, Lev, Luchangco,
+ * Shavit) with expected O(log n) add, remove, and contains
+ *
+ * Each level is a Harris-Michael list whose next pointers carry a mark bit.
+ * The bottom level defines membership: an item is in the set if it is in the
+ * bottom-level list and unmarked, and the upper levels are only shortcuts.
+ * Removal marks a node's next pointers from the top level down, and find()
+ * physically unlinks marked nodes at every level it traverses. contains()
+ * never modifies the list and is wait-free.
+ *
+ * As in the lists, nodes are ordered by the hash of their item, and two items
+ * with the same hash are considered equal.
+ *
+ * A node may still be linked into upper levels by its inserter after it has
+ * been removed, so it is retired by whichever of the inserter and the remover
+ * finishes last, after it has unlinked the node from every level. The
+ * contains() traversal passes through unlinked nodes, so the `Reclaimer` must
+ * protect whole operations.
+ */
+template<typename T, typename Hash = std::hash<T>,
+         typename Reclaimer = EpochBasedReclamation>
+class LockFreeSkipList {
+  static_assert(!Reclaimer::kRequiresReservation,
+                "LockFreeSkipList traverses the list without validating each "
+                "hop, so it needs a reclaimer that protects whole operations");
+
+  static constexpr int kMaxLevel = 24;
+
+  struct Node {
+    size_t key_{};
+    std::optional<T> item_{};
+    int top_level_;
+    std::vector<AtomicMarkablePtr<Node>> next_;
+    // The inserter and the remover each give up one reference once they are
+    // done linking and unlinking the node; the last one retires it
+    std::atomic<int> refs_{2};
+
+    Node(size_t key, int top_level)
+        : key_(key),
+          top_level_(top_level),
+          next_(top_level + 1, AtomicMarkablePtr<Node>(nullptr, false)) {}
+
+    Node(size_t key, const T& item, int top_level)
+        : key_(key),
+          item_(item),
+          top_level_(top_level),
+          next_(top_level + 1, AtomicMarkablePtr<Node>(nullptr, false)) {}
+  };
+
+  using Window = std::array<Node*, kMaxLevel + 1>;
+
+ public:
+  LockFreeSkipList() {
+    head_ = new Node(std::numeric_limits<size_t>::min(), kMaxLevel);
+    tail_ = new Node(std::numeric_limits<size_t>::max(), kMaxLevel);
+    for (int level = 0; level <= kMaxLevel; level++) {
+      head_->next_[level] = AtomicMarkablePtr<Node>(tail_, false);
+    }
+  }
+
+  LockFreeSkipList(const LockFreeSkipList&) = delete;
+  auto operator=(const LockFreeSkipList&) -> LockFreeSkipList& = delete;
+
+  /**
+   * Destructor - Frees all nodes still in the bottom-level list. Removed nodes
+   * are owned by the reclaimer and freed by its destructor.
+   */
+  ~LockFreeSkipList() {
+    Node* curr = head_;
+    while (curr != nullptr) {
+      Node* next = curr->next_[0].get_ptr(std::memory_order_relaxed);
+      delete curr;
+      curr = next;
+    }
+  }
+
+  /**
+   * Adds an item to the set if it's not already present
+   *
+   * The item is added once it is linked into the bottom level; the upper
+   * levels are linked afterwards, one at a time.
+   *
+   * @param item The item to add
+   * @return true if the item was added, false if it already exists
+   */
+  auto add(const T& item) -> bool {
+    size_t key = get_hash_value(item);
+    int top_level = random_level();
+    auto node = new Node(key, item, top_level);
+    Window preds;
+    Window succs;
+    OperationGuard guard(reclaimer_);
+
+    while (true) {
+      if (find(key, preds, succs)) {
+        delete node;
+        return false;
+      }
+
+      for (int level = 0; level <= top_level; level++) {
+        node->next_[level] = AtomicMarkablePtr<Node>(succs[level], false);
+      }
+      // Linearization point of a successful add
+      if (preds[0]->next_[0].compare_and_swap(succs[0], node, false, false,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+        break;
+      }
+    }
+
+    for (int level = 1; level <= top_level; level++) {
+      while (true) {
+        // Point the node at its successor, unless a concurrent remove has
+        // already marked this level, in which case we stop linking
+        auto [succ, marked] = node->next_[level].get(std::memory_order_acquire);
+        if (marked || (succ != succs[level] &&
+                       !node->next_[level].compare_and_swap(
+                           succ, succs[level], false, false))) {
+          goto linked;
+        }
+        if (preds[level]->next_[level].compare_and_swap(
+                succs[level], node, false, false, std::memory_order_release,
+                std::memory_order_relaxed)) {
+          break;
+        }
+        find(key, preds, succs);
+        if (node->next_[0].is_marked(std::memory_order_acquire)) {
+          goto linked;
+        }
+      }
+    }
+
+  linked:
+    release(node);
+    return true;
+  }
+
+  /**
+   * Removes an item from the set
+   *
+   * @param item The item to remove
+   * @return true if the item was found and removed, false otherwise
+   */
+  auto remove(const T& item) -> bool {
+    size_t key = get_hash_value(item);
+    Window preds;
+    Window succs;
+    OperationGuard guard(reclaimer_);
+
+    if (!find(key, preds, succs)) {
+      return false;
+    }
+    return try_remove(succs[0]);
+  }
+
+  /**
+   * Removes the item with the smallest key
+   *
+   * Walks the bottom level from the head and removes the first unmarked node
+   * it wins the race for, so concurrent calls remove consecutive items.
+   *
+   * @return the item, or std::nullopt if the list was empty
+   */
+  auto remove_first() -> std::optional<T> {
+    OperationGuard guard(reclaimer_);
+    return remove_from(head_->next_[0].get_ptr(std::memory_order_acquire));
+  }
+
+  /**
+   * Removes an item close to the front of the list, chosen at random
+   * (SprayList [Ali15])
+   *
+   * Starts at level `height` of the head and, on every level down to the
+   * bottom, moves forward a random number of nodes between 0 and `max_jump`.
+   * The walk lands on one of roughly the first 2^height * max_jump nodes, so
+   * threads that would all contend for the first node in remove_first()
+   * spread over different ones, at the cost of not always removing the
+   * smallest key.
+   *
+   * @return the item, or std::nullopt if the walk found no unmarked node
+   * before the tail and the list was empty
+   */
+  auto spray_remove(int height, int max_jump) -> std::optional<T> {
+    OperationGuard guard(reclaimer_);
+
+    Node* curr = head_;
+    for (int level = std::min(height, kMaxLevel); level >= 0; level--) {
+      auto jump = static_cast<int>(random_() % (max_jump + 1));
+      for (int i = 0; i < jump; i++) {
+        Node* next = curr->next_[level].get_ptr(std::memory_order_acquire);
+        if (next == tail_) {
+          break;
+        }
+        curr = next;
+      }
+    }
+    if (curr == head_) {
+      curr = head_->next_[0].get_ptr(std::memory_order_acquire);
+    }
+    if (std::optional<T> item = remove_from(curr)) {
+      return item;
+    }
+    // Every node behind the landing point is taken; fall back to the front
+    return remove_from(head_->next_[0].get_ptr(std::memory_order_acquire));
+  }
+
+  /**
+   * Checks if an item exists in the set
+   *
+   * Wait-free: traverses past marked nodes without unlinking them.
+   *
+   * @param item The item to check for
+   * @return true if the item exists and is not logically deleted
+   */
+  auto contains(const T& item) -> bool {
+    size_t key = get_hash_value(item);
+    OperationGuard guard(reclaimer_);
+
+    Node* pred = head_;
+    Node* curr = nullptr;
+    for (int level = kMaxLevel; level >= 0; level--) {
+      curr = pred->next_[level].get_ptr(std::memory_order_acquire);
+      while (true) {
+        auto [succ, marked] = curr->next_[level].get(std::memory_order_acquire);
+        while (marked) {
+          curr = succ;
+          std::tie(succ, marked) =
+              curr->next_[level].get(std::memory_order_acquire);
+        }
+        if (curr->key_ < key) {
+          pred = curr;
+          curr = succ;
+        } else {
+          break;
+        }
+      }
+    }
+    return curr != tail_ && curr->key_ == key;
+  }
+
+  /**
+   * Reseeds the calling thread's generator of node levels and spray jumps,
+   * which is otherwise seeded at random, e.g. to make a test reproducible
+   */
+  static auto seed_random(uint32_t seed) -> void { random_.seed(seed); }
+
+ private:
+  /**
+   * Finds, at every level, the window (pred, succ) with pred->key < key <=
+   * succ->key, unlinking every marked node it traverses
+   *
+   * @return true if the bottom-level successor holds the key
+   */
+  auto find(size_t key, Window& preds, Window& succs) -> bool {
+  retry:
+    Node* pred = head_;
+    for (int level = kMaxLevel; level >= 0; level--) {
+      Node* curr = pred->next_[level].get_ptr(std::memory_order_acquire);
+      while (true) {
+        auto [succ, marked] = curr->next_[level].get(std::memory_order_acquire);
+        while (marked) {
+          if (!pred->next_[level].compare_and_swap(curr, succ, false, false,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed)) {
+            goto retry;
+          }
+          curr = pred->next_[level].get_ptr(std::memory_order_acquire);
+          std::tie(succ, marked) =
+              curr->next_[level].get(std::memory_order_acquire);
+        }
+        if (curr->key_ < key) {
+          pred = curr;
+          curr = succ;
+        } else {
+          break;
+        }
+      }
+      preds[level] = pred;
+      succs[level] = curr;
+    }
+    return succs[0] != tail_ && succs[0]->key_ == key;
+  }
+
+  /**
+   * Removes `victim`, which was found in the list
+   *
+   * Marks the node's upper levels from the top down, then the bottom level,
+   * which is the linearization point of a successful remove.
+   *
+   * @return true if this thread removed the node, false if another did
+   */
+  auto try_remove(Node* victim) -> bool {
+    for (int level = victim->top_level_; level >= 1; level--) {
+      auto [succ, marked] = victim->next_[level].get(std::memory_order_acquire);
+      while (!marked) {
+        victim->next_[level].compare_and_swap(succ, succ, false, true);
+        std::tie(succ, marked) =
+            victim->next_[level].get(std::memory_order_acquire);
+      }
+    }
+
+    auto [succ, marked] = victim->next_[0].get(std::memory_order_acquire);
+    while (true) {
+      if (victim->next_[0].compare_and_swap(succ, succ, false, true)) {
+        release(victim);
+        return true;
+      }
+      std::tie(succ, marked) = victim->next_[0].get(std::memory_order_acquire);
+      if (marked) {
+        // Another thread removed it first
+        return false;
+      }
+    }
+  }
+
+  /**
+   * Removes the first unmarked node at or after `curr` on the bottom level;
+   * must be called inside an operation
+   *
+   * @return the item of the removed node, or std::nullopt if it reached the
+   * tail
+   */
+  auto remove_from(Node* curr) -> std::optional<T> {
+    while (curr != tail_) {
+      if (!curr->next_[0].is_marked(std::memory_order_acquire) &&
+          try_remove(curr)) {
+        // The node is retired, but the operation keeps it alive
+        return curr->item_;
+      }
+      curr = curr->next_[0].get_ptr(std::memory_order_acquire);
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * Gives up the caller's reference to `node`. The last of the inserter and
+   * the remover unlinks the node from every level and retires it: by then the
+   * inserter has made all the links it will ever make, and the node is marked
+   * at every level.
+   */
+  auto release(Node* node) -> void {
+    if (node->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      unlink(node);
+      reclaimer_.sched_for_reclaim(node);
+    }
+  }
+
+  /**
+   * Unlinks a marked node from every level it may be linked into
+   *
+   * find() stops at the first unmarked node holding the key, but at an upper
+   * level the victim may be linked behind a newer node with the same key, so
+   * the whole run of nodes with that key is scanned at each level.
+   */
+  auto unlink(Node* victim) -> void {
+    size_t key = victim->key_;
+    Window preds;
+    Window succs;
+
+  retry:
+    find(key, preds, succs);
+    for (int level = 0; level <= victim->top_level_; level++) {
+      Node* pred = preds[level];
+      Node* curr = succs[level];
+      while (curr != tail_ && curr->key_ == key) {
+        auto [succ, marked] = curr->next_[level].get(std::memory_order_acquire);
+        if (!marked) {
+          pred = curr;
+        } else if (!pred->next_[level].compare_and_swap(
+                       curr, succ, false, false, std::memory_order_release,
+                       std::memory_order_relaxed)) {
+          goto retry;
+        }
+        curr = succ;
+      }
+    }
+  }
+
+  /**
+   * Draws the top level of a new node from a geometric distribution with
+   * p = 1/2, capped at kMaxLevel
+   */
+  static auto random_level() -> int {
+    return std::min(std::countr_one(static_cast<uint32_t>(random_())),
+                    kMaxLevel);
+  }
+
+  auto get_hash_value(const T& item) const noexcept -> size_t {
+    return hash_fn_(item);
+  }
+
+  Node* head_{};    // Sentinel with the minimum key, linked at every level
+  Node* tail_{};    // Sentinel with the maximum key, linked at every level
+  Hash hash_fn_{};  // Hash function to generate keys from items
+  Reclaimer reclaimer_;  // Frees removed nodes once they are unreachable
+  // Draws node levels and spray jumps
+  static inline thread_local std::minstd_rand random_{std::random_device{}()};
+};
+
+#endif  // LOCK_FREE_SKIP_LIST_H_
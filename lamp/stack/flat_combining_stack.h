@@ -0,0 +1,55 @@
+#ifndef FLAT_COMBINING_STACK_H_
+#define FLAT_COMBINING_STACK_H_
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "synchronization/flat_combining.h"
+#include "util/common.h"
+
+/**
+ * FlatCombiningStack - A LIFO stack whose operations are applied to a
+ * sequential std::vector by a FlatCombining combiner
+ */
+template<typename T>
+class FlatCombiningStack {
+ public:
+  auto push(T value) -> void {
+    stack_.apply([&value](std::vector<T>& stack) {
+      stack.push_back(std::move(value));
+    });
+  }
+
+  /**
+   * @throws EmptyException if the stack was empty
+   */
+  auto pop() -> T {
+    T value;
+    if (!try_pop(value)) {
+      throw EmptyException("Try to pop from an empty stack");
+    }
+    return value;
+  }
+
+  /**
+   * Pops the top item into `value`, unless the stack is empty
+   *
+   * @return true if an item was popped, false if the stack was empty
+   */
+  auto try_pop(T& value) -> bool {
+    return stack_.apply([&value](std::vector<T>& stack) {
+      if (stack.empty()) {
+        return false;
+      }
+      value = std::move(stack.back());
+      stack.pop_back();
+      return true;
+    });
+  }
+
+ private:
+  FlatCombining<std::vector<T>> stack_;
+};
+
+#endif  // FLAT_COMBINING_STACK_H_
@@ -1,17 +1,48 @@
 #ifndef LOCK_FREE_STACK_H_
 #define LOCK_FREE_STACK_H_
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#include "counting/sharded_counter.h"
+#include "memory/pool_allocator.h"
+#include "util/atomic_stamped_ptr.h"
 #include "util/backoff.h"
+#include "util/cache_aligned.h"
 #include "util/common.h"
+#include "util/elimination.h"
+#include "util/intrusive_hook.h"
+#include "util/stats.h"
 
-template<typename T, typename Duration = std::chrono::microseconds>
+/**
+ * LockFreeStack - Treiber's lock-free stack
+ *
+ * Operations that lose the race on the top back off by default. With the
+ * WithElimination policy they visit an elimination array instead, where a push
+ * and a pop that meet cancel out without touching the top [Hen04].
+ *
+ * Popped nodes are not freed but recycled by later pushes, through a second
+ * Treiber stack of free nodes, so the stack holds at most as many nodes as it
+ * once held items, plus one per thread in the middle of a push. A thread that
+ * lost a race may still read the link of a node that has since been popped
+ * and recycled; the top and the free list are stamped pointers, so its CAS
+ * then fails instead of installing a stale link (the ABA problem), and since
+ * nodes are only freed with the stack, the read itself is safe.
+ */
+template<typename T, typename Duration = std::chrono::microseconds,
+         typename Allocator = DefaultAllocator,
+         typename Elimination = NoElimination>
 class LockFreeStack {
-  struct Node {
+  struct Node : AllocatedBy<Allocator> {
     T value_;
-    Node* next_{nullptr};
-    Node* next_deleted_{nullptr};
+    // Read by pops that may lose the race for this node
+    std::atomic<Node*> next_{nullptr};
 
     Node(T value) : value_(std::move(value)) {}
   };
@@ -23,83 +54,226 @@ class LockFreeStack {
       : kMinDelay(min_delay), kMaxDelay(max_delay) {}
 
   ~LockFreeStack() {
-    // Clean up in two phases to avoid memory leaks
-    // Phase 1: Clean garbage list (nodes already removed from main queue)
-    Node* curr = garbage_list_.load(std::memory_order_relaxed);
-    while (curr != nullptr) {
-      Node* next = curr->next_deleted_;
-      delete curr;
-      curr = next;
-    }
-
-    // Phase 2: Clean remaining nodes in queue including sentinel
-    curr = top_.load(std::memory_order_relaxed);
-    while (curr != nullptr) {
-      Node* next = curr->next_;
-      delete curr;
-      curr = next;
-    }
+    delete_all(top_->get_ptr(std::memory_order_relaxed));
+    delete_all(free_nodes_->get_ptr(std::memory_order_relaxed));
   }
 
   auto push(T value) -> void {
     Backoff<Duration> backoff{kMinDelay, kMaxDelay};
-    auto node = new Node(std::move(value));
+    Node* node = allocate(std::move(value));
+    size_counter_.add(1);
     while (true) {
       if (try_push(node)) {
         return;
       }
-      backoff.backoff();
+      LAMP_STAT_INC(Stat::kCasFailures);
+      if constexpr (Elimination::kEnabled) {
+        std::optional<Node*> other_node = elimination_array_.visit(node);
+        if (other_node.has_value() && *other_node == nullptr) {
+          LAMP_STAT_INC(Stat::kEliminations);
+          return;  // exchanged with pop
+        }
+      } else {
+        backoff.backoff();
+      }
     }
   }
 
   auto pop() -> T {
-    Backoff<Duration> backoff{kMinDelay, kMaxDelay};
-    while (true) {
-      Node* return_node = try_pop();
-      if (return_node != nullptr) {
-        T value = std::move(return_node->value_);
-
-        // Chain the node into garbage list to clean up
-        return_node->next_deleted_ =
-            garbage_list_.load(std::memory_order_relaxed);
-        while (!garbage_list_.compare_exchange_weak(
-            return_node->next_deleted_, return_node,
-            std::memory_order_relaxed)) {}
-
-        return value;
-      }
-      backoff.backoff();
+    Node* return_node = pop_node();
+    if (return_node == nullptr) {
+      throw EmptyException("Try to pop from an empty stack");
     }
+    size_counter_.add(-1);
+    T value = std::move(return_node->value_);
+    recycle(return_node);
+    return value;
+  }
+
+  /**
+   * Pops the top item into `value`, unless the stack is empty
+   *
+   * @return true if an item was popped, false if the stack was empty
+   */
+  auto try_pop(T& value) -> bool {
+    Node* return_node = pop_node();
+    if (return_node == nullptr) {
+      return false;
+    }
+    size_counter_.add(-1);
+    value = std::move(return_node->value_);
+    recycle(return_node);
+    return true;
+  }
+
+  /**
+   * Returns the number of items on the stack
+   *
+   * Pushes and pops count themselves in per-thread shards, which are only
+   * summed up here. The answer is approximate: it may miss operations in
+   * progress.
+   */
+  auto approx_size() const -> size_t {
+    return static_cast<size_t>(std::max<int64_t>(size_counter_.get(), 0));
   }
 
  private:
   auto try_push(Node* node) -> bool {
-    Node* old_top = top_.load(std::memory_order_acquire);
-    node->next_ = old_top;
-    return top_.compare_exchange_strong(
-        old_top, node, std::memory_order_release, std::memory_order_relaxed);
+    auto [old_top, stamp] = top_->get(std::memory_order_acquire);
+    node->next_.store(old_top, std::memory_order_relaxed);
+    return top_->compare_and_swap(old_top, node, stamp, stamp + 1,
+                                  std::memory_order_release,
+                                  std::memory_order_relaxed);
   }
 
-  auto try_pop() -> Node* {
-    Node* old_top = top_.load(std::memory_order_acquire);
+  // Unlinks the top node or takes one from a concurrent push, retrying while
+  // the CAS on the top loses races, or returns nullptr as soon as the stack is
+  // found empty
+  auto pop_node() -> Node* {
+    Backoff<Duration> backoff{kMinDelay, kMaxDelay};
+    while (true) {
+      Node* old_top;
+      if (try_unlink_top(old_top)) {
+        return old_top;
+      }
+      LAMP_STAT_INC(Stat::kCasFailures);
+      if constexpr (Elimination::kEnabled) {
+        std::optional<Node*> other_node = elimination_array_.visit(nullptr);
+        if (other_node.has_value() && *other_node != nullptr) {
+          LAMP_STAT_INC(Stat::kEliminations);
+          return *other_node;
+        }
+      } else {
+        backoff.backoff();
+      }
+    }
+  }
+
+  // Makes one attempt to unlink the top node. Returns false if the attempt
+  // lost a race; otherwise `old_top` is the unlinked node, or nullptr if the
+  // stack was empty.
+  auto try_unlink_top(Node*& old_top) -> bool {
+    uint64_t stamp;
+    std::tie(old_top, stamp) = top_->get(std::memory_order_acquire);
     if (old_top == nullptr) {
-      throw EmptyException("Try to pop from an empty stack");
+      return true;
     }
-    Node* new_top = old_top->next_;
-    if (top_.compare_exchange_strong(old_top, new_top,
-                                     std::memory_order_acquire,
-                                     std::memory_order_relaxed)) {
-      return old_top;
+    Node* new_top = old_top->next_.load(std::memory_order_relaxed);
+    return top_->compare_and_swap(old_top, new_top, stamp, stamp + 1,
+                                  std::memory_order_acquire,
+                                  std::memory_order_relaxed);
+  }
+
+  // Takes a node from the free list, or allocates one if it is empty
+  auto allocate(T value) -> Node* {
+    while (true) {
+      auto [node, stamp] = free_nodes_->get(std::memory_order_acquire);
+      if (node == nullptr) {
+        return new Node(std::move(value));
+      }
+      Node* next = node->next_.load(std::memory_order_relaxed);
+      if (free_nodes_->compare_and_swap(node, next, stamp, stamp + 1,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+        node->value_ = std::move(value);
+        return node;
+      }
     }
-    return nullptr;
   }
 
-  std::atomic<Node*> top_{nullptr};
-  std::atomic<Node*> garbage_list_;
+  auto recycle(Node* node) -> void {
+    while (true) {
+      auto [head, stamp] = free_nodes_->get(std::memory_order_relaxed);
+      node->next_.store(head, std::memory_order_relaxed);
+      if (free_nodes_->compare_and_swap(head, node, stamp, stamp + 1,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  static auto delete_all(Node* node) -> void {
+    while (node != nullptr) {
+      Node* next = node->next_.load(std::memory_order_relaxed);
+      delete node;
+      node = next;
+    }
+  }
+
+  // Padded so that pushes and pops contending on the top do not also contend
+  // with recycling on the free list, or with the neighbors of the stack
+  CacheAligned<AtomicStampedPtr<Node>> top_;
+  CacheAligned<AtomicStampedPtr<Node>> free_nodes_;
+  // Empty unless the Elimination policy is enabled
+  [[no_unique_address]] typename Elimination::template Array<Node>
+      elimination_array_;
+
+  ShardedCounter size_counter_;  // Pushes minus pops, per thread
 
   // Default backoff duration ranges from 5ms - 25ms
   const int64_t kMinDelay{5};
   const int64_t kMaxDelay{25};
 };
 
+/**
+ * IntrusiveLockFreeStack - Treiber's lock-free stack of caller-allocated nodes
+ *
+ * `T` must derive from IntrusiveHook. The stack never allocates: pushing links
+ * the caller's node, and popping hands it back. As in LockFreeStack, the top is
+ * a stamped pointer, so a pop that read the link of a node that has since been
+ * popped and pushed again fails its CAS instead of installing a stale link.
+ *
+ * A popped node may be pushed again right away, but its memory must stay valid
+ * while other threads may be inside an operation on the stack, since a pop
+ * that lost the race for it may still read its link. Nodes taken from an arena
+ * that outlives the stack satisfy this.
+ */
+template<typename T>
+class IntrusiveLockFreeStack {
+ public:
+  IntrusiveLockFreeStack() = default;
+
+  IntrusiveLockFreeStack(const IntrusiveLockFreeStack&) = delete;
+  auto operator=(const IntrusiveLockFreeStack&)
+      -> IntrusiveLockFreeStack& = delete;
+
+  auto push(T* node) -> void {
+    IntrusiveHook* hook = node;
+    while (true) {
+      auto [old_top, stamp] = top_->get(std::memory_order_relaxed);
+      hook->next_.set(old_top, false, std::memory_order_relaxed);
+      if (top_->compare_and_swap(old_top, hook, stamp, stamp + 1,
+                                 std::memory_order_release,
+                                 std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  /**
+   * Pops the top node
+   *
+   * @return the node, or nullptr if the stack was empty
+   */
+  auto try_pop() -> T* {
+    while (true) {
+      auto [old_top, stamp] = top_->get(std::memory_order_acquire);
+      if (old_top == nullptr) {
+        return nullptr;
+      }
+      IntrusiveHook* new_top =
+          old_top->next_.get_ptr(std::memory_order_relaxed);
+      if (top_->compare_and_swap(old_top, new_top, stamp, stamp + 1,
+                                 std::memory_order_acquire,
+                                 std::memory_order_relaxed)) {
+        return static_cast<T*>(old_top);
+      }
+    }
+  }
+
+ private:
+  CacheAligned<AtomicStampedPtr<IntrusiveHook>> top_;
+};
+
 #endif  // LOCK_FREE_STACK_H_
@@ -0,0 +1,398 @@
+#ifndef STM_H_
+#define STM_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "memory/epoch_based_reclamation.h"
+#include "util/backoff.h"
+#include "util/cache_aligned.h"
+#include "util/stats.h"
+
+/**
+ * A value that a TVar can hold: anything that fits in a machine word and is
+ * copied with memcpy, such as integers, enums and pointers
+ */
+template<typename T>
+concept TVarValue = std::is_trivially_copyable_v<T> &&
+                    std::default_initializable<T> &&
+                    sizeof(T) <= sizeof(uint64_t);
+
+template<TVarValue T>
+class TVar;
+
+/**
+ * Thrown out of a TVar access whose transaction can no longer commit, and
+ * caught by atomically(), which runs the transaction again. It derives from
+ * no standard exception so that handlers for those do not swallow it; code
+ * inside a transaction must not catch it with `catch (...)` either.
+ */
+class TransactionConflict {};
+
+/**
+ * Transaction - The software transaction of a thread, in the style of
+ * Transactional Locking II [Dic06]
+ *
+ * Memory is divided into words, each guarded by one of `kNumStripes`
+ * versioned locks, chosen by the word's address. A versioned lock holds the
+ * global clock value of the last commit that wrote one of its words, shifted
+ * left by one, and a locked bit. A transaction
+ *
+ * - samples the global clock when it begins (its read version);
+ * - reads a word between two loads of its lock, and aborts unless the lock
+ *   was free and not newer than the read version, so every transaction sees
+ *   a consistent snapshot, even one that will abort;
+ * - buffers its writes, and reads its own writes back from the buffer;
+ * - commits by locking the stripes it writes, incrementing the clock,
+ *   validating its read set (unless no other transaction committed since it
+ *   began), writing its buffer back and releasing the locks with the new
+ *   clock value.
+ *
+ * Read-only transactions commit without any validation or shared write.
+ * Lock acquisition never waits, so there is no deadlock; a transaction that
+ * finds a lock taken aborts and retries after a randomized backoff.
+ *
+ * Transactions run in an EpochBasedReclamation domain, so that memory freed
+ * with tm_delete() stays readable by the transactions that may still reach
+ * it. Memory allocated with tm_new() is freed again if the transaction
+ * aborts.
+ */
+class Transaction {
+ public:
+  static constexpr size_t kNumStripes = size_t{1} << 16;
+
+  /**
+   * @brief The calling thread's transaction
+   */
+  static auto self() -> Transaction& {
+    thread_local Transaction tx;
+    return tx;
+  }
+
+  auto active() const -> bool { return active_; }
+
+  auto begin() -> void {
+    domain().op_begin();
+    active_ = true;
+    read_version_ = clock_->load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Try to commit; a transaction that fails must be aborted
+   * @return whether the transaction committed
+   */
+  auto commit() -> bool {
+    if (write_set_.empty()) {
+      finish_commit();
+      return true;
+    }
+    // Sorted, so that validation finds the stripes locked by this transaction
+    // with a binary search
+    for (const WriteEntry& entry : write_set_) {
+      locked_.push_back(entry.stripe_);
+    }
+    std::sort(locked_.begin(), locked_.end());
+    locked_.erase(std::unique(locked_.begin(), locked_.end()), locked_.end());
+    for (size_t i = 0; i < locked_.size(); i++) {
+      uint64_t version = locked_[i]->load(std::memory_order_relaxed);
+      if ((version & kLocked) != 0 ||
+          !locked_[i]->compare_exchange_strong(version, version | kLocked,
+                                               std::memory_order_acquire)) {
+        unlock_first(i);
+        return false;
+      }
+    }
+
+    uint64_t write_version =
+        clock_->fetch_add(1, std::memory_order_acq_rel) + 1;
+    // Otherwise no transaction committed in between, so the reads are still
+    // valid
+    if (write_version != read_version_ + 1 && !validate()) {
+      unlock_first(locked_.size());
+      return false;
+    }
+
+    for (const WriteEntry& entry : write_set_) {
+      entry.word_->store(entry.value_, std::memory_order_release);
+    }
+    for (std::atomic<uint64_t>* stripe : locked_) {
+      stripe->store(write_version << 1, std::memory_order_release);
+    }
+    finish_commit();
+    return true;
+  }
+
+  /**
+   * @brief Discard the writes and the allocations of the transaction
+   */
+  auto abort() -> void {
+    LAMP_STAT_INC(Stat::kTransactionAborts);
+    for (const auto& allocated : allocated_) {
+      allocated.reclaim();
+    }
+    allocated_.clear();
+    retired_.clear();
+    finish();
+  }
+
+  /**
+   * @brief The value of `word` in this transaction's snapshot
+   * @throws TransactionConflict if the word changed since the snapshot
+   */
+  auto read(const std::atomic<uint64_t>& word) -> uint64_t {
+    if ((write_filter_ & filter_bit(&word)) != 0) {
+      for (auto it = write_set_.rbegin(); it != write_set_.rend(); ++it) {
+        if (it->word_ == &word) {
+          return it->value_;
+        }
+      }
+    }
+    std::atomic<uint64_t>& stripe = stripe_of(&word);
+    uint64_t before = stripe.load(std::memory_order_acquire);
+    uint64_t value = word.load(std::memory_order_acquire);
+    uint64_t after = stripe.load(std::memory_order_acquire);
+    if ((before & kLocked) != 0 || before != after ||
+        (before >> 1) > read_version_) {
+      throw TransactionConflict();
+    }
+    read_set_.push_back(&stripe);
+    return value;
+  }
+
+  /**
+   * @brief Buffer a write of `value` to `word` until the commit
+   */
+  auto write(std::atomic<uint64_t>& word, uint64_t value) -> void {
+    if ((write_filter_ & filter_bit(&word)) != 0) {
+      for (WriteEntry& entry : write_set_) {
+        if (entry.word_ == &word) {
+          entry.value_ = value;
+          return;
+        }
+      }
+    }
+    write_filter_ |= filter_bit(&word);
+    write_set_.push_back({&word, &stripe_of(&word), value});
+  }
+
+  template<typename T>
+  auto on_allocate(T* ptr) -> void {
+    allocated_.emplace_back(ptr);
+  }
+
+  template<typename T>
+  auto on_delete(T* ptr) -> void {
+    retired_.emplace_back(ptr);
+  }
+
+  /**
+   * @brief The domain that reclaims the memory freed by transactions
+   */
+  static auto domain() -> EpochBasedReclamation& {
+    static EpochBasedReclamation domain;
+    return domain;
+  }
+
+ private:
+  static constexpr uint64_t kLocked = 1;
+
+  struct WriteEntry {
+    std::atomic<uint64_t>* word_;
+    std::atomic<uint64_t>* stripe_;
+    uint64_t value_;
+  };
+
+  Transaction() = default;
+
+  static auto stripe_of(const std::atomic<uint64_t>* word)
+      -> std::atomic<uint64_t>& {
+    return stripes_[(reinterpret_cast<uintptr_t>(word) >> 3) &
+                    (kNumStripes - 1)];
+  }
+
+  // A one-word Bloom filter of the written words, so that most reads skip
+  // the search of the write set
+  static auto filter_bit(const std::atomic<uint64_t>* word) -> uint64_t {
+    return uint64_t{1} << ((reinterpret_cast<uintptr_t>(word) >> 3) & 63);
+  }
+
+  auto validate() const -> bool {
+    for (const std::atomic<uint64_t>* stripe : read_set_) {
+      uint64_t version = stripe->load(std::memory_order_acquire);
+      if ((version >> 1) > read_version_) {
+        return false;
+      }
+      if ((version & kLocked) != 0 &&
+          !std::binary_search(locked_.begin(), locked_.end(), stripe)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Releases the first `n` locked stripes with their versions unchanged
+  auto unlock_first(size_t n) -> void {
+    for (size_t i = 0; i < n; i++) {
+      locked_[i]->fetch_and(~kLocked, std::memory_order_release);
+    }
+  }
+
+  auto finish_commit() -> void {
+    allocated_.clear();
+    for (const auto& retired : retired_) {
+      domain().sched_for_reclaim(retired.data_, retired.deleter_);
+    }
+    retired_.clear();
+    finish();
+  }
+
+  auto finish() -> void {
+    read_set_.clear();
+    write_set_.clear();
+    locked_.clear();
+    write_filter_ = 0;
+    active_ = false;
+    domain().op_end();
+  }
+
+  bool active_{false};
+  uint64_t read_version_{0};
+  uint64_t write_filter_{0};
+  std::vector<const std::atomic<uint64_t>*> read_set_;
+  std::vector<WriteEntry> write_set_;
+  std::vector<std::atomic<uint64_t>*> locked_;
+  std::vector<data_to_reclaim> allocated_;
+  std::vector<data_to_reclaim> retired_;
+
+  static inline CacheAligned<std::atomic<uint64_t>> clock_{uint64_t{0}};
+  static inline std::array<std::atomic<uint64_t>, kNumStripes> stripes_{};
+};
+
+/**
+ * Runs `f` as a transaction and returns its result
+ *
+ * `f` reads and writes shared state through TVars, and may run several
+ * times: whenever a TVar access or the commit detects a conflict, the
+ * transaction's writes are discarded and `f` runs again after a backoff. It
+ * should therefore have no side effects beyond TVars, tm_new() and
+ * tm_delete(). If `f` throws anything else, the transaction is aborted and
+ * the exception propagates.
+ *
+ * A call inside a running transaction joins it, so the operations of the
+ * TM-aware containers (see tm_list.h and tm_queue.h) compose: their calls
+ * inside one atomically() commit together or not at all.
+ */
+template<typename F>
+auto atomically(F&& f) -> std::invoke_result_t<F&> {
+  using Result = std::invoke_result_t<F&>;
+  Transaction& tx = Transaction::self();
+  if (tx.active()) {
+    return f();
+  }
+  Backoff<std::chrono::nanoseconds> backoff(100, 100000);
+  while (true) {
+    tx.begin();
+    try {
+      if constexpr (std::is_void_v<Result>) {
+        f();
+        if (tx.commit()) {
+          return;
+        }
+      } else {
+        Result result = f();
+        if (tx.commit()) {
+          return result;
+        }
+      }
+    } catch (const TransactionConflict&) {
+    } catch (...) {
+      tx.abort();
+      throw;
+    }
+    tx.abort();
+    backoff.backoff();
+  }
+}
+
+/**
+ * Allocates a `T` that is freed again if the calling transaction aborts
+ */
+template<typename T, typename... Args>
+auto tm_new(Args&&... args) -> T* {
+  auto ptr = new T(std::forward<Args>(args)...);
+  Transaction& tx = Transaction::self();
+  if (tx.active()) {
+    tx.on_allocate(ptr);
+  }
+  return ptr;
+}
+
+/**
+ * Frees `ptr` once the calling transaction has committed and no transaction
+ * can still read it. Outside a transaction, `ptr` is freed right away, so it
+ * must no longer be shared.
+ */
+template<typename T>
+auto tm_delete(T* ptr) -> void {
+  Transaction& tx = Transaction::self();
+  if (tx.active()) {
+    tx.on_delete(ptr);
+  } else {
+    delete ptr;
+  }
+}
+
+/**
+ * TVar - A word of shared memory that is accessed in transactions
+ *
+ * get() and set() join the calling thread's transaction; outside atomically()
+ * each runs as a transaction of its own.
+ */
+template<TVarValue T>
+class TVar {
+ public:
+  TVar() : TVar(T{}) {}
+
+  explicit TVar(T value) : word_(to_word(value)) {}
+
+  TVar(const TVar&) = delete;
+  auto operator=(const TVar&) -> TVar& = delete;
+
+  auto get() const -> T {
+    return atomically([this]() {
+      return from_word(Transaction::self().read(word_));
+    });
+  }
+
+  auto set(T value) -> void {
+    atomically([this, value]() {
+      Transaction::self().write(word_, to_word(value));
+    });
+  }
+
+ private:
+  static auto to_word(T value) -> uint64_t {
+    uint64_t word = 0;
+    std::memcpy(&word, &value, sizeof(T));
+    return word;
+  }
+
+  static auto from_word(uint64_t word) -> T {
+    T value;
+    std::memcpy(&value, &word, sizeof(T));
+    return value;
+  }
+
+  // Only written by commits, under the word's versioned lock
+  std::atomic<uint64_t> word_;
+};
+
+#endif  // STM_H_
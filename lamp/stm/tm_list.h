@@ -0,0 +1,119 @@
+#ifndef TM_LIST_H_
+#define TM_LIST_H_
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include "list/list_order.h"
+#include "stm/stm.h"
+
+/**
+ * TMList - A sorted linked list whose links are TVars
+ *
+ * Every operation is a transaction (see stm.h), so operations on several
+ * TMLists and TMQueues inside one atomically() take effect together, e.g.
+ * moving an item from one list to another. Items are immutable once linked;
+ * only the `next_` pointers are transactional. Nodes are ordered as described
+ * in ListOrder.
+ *
+ * A traversal reads every link up to the searched position, so an update
+ * conflicts with any concurrent transaction that traversed the link it
+ * changes. The list suits short lists and the composition of operations,
+ * not raw throughput.
+ */
+template<typename T, typename Hash = std::hash<T>, typename Compare = void>
+class TMList {
+  using Order = ListOrder<T, Hash, Compare>;
+  using Key = typename Order::Key;
+
+  struct Node {
+    size_t key_{};
+    std::optional<T> item_;
+    TVar<Node*> next_;
+
+    Node(size_t key) : key_(key) {}
+
+    Node(size_t key, const T& item) : key_(key), item_(item) {}
+  };
+
+ public:
+  TMList() {
+    head_ = new Node(std::numeric_limits<size_t>::min());
+    tail_ = new Node(std::numeric_limits<size_t>::max());
+    head_->next_.set(tail_);
+  }
+
+  TMList(const TMList&) = delete;
+  auto operator=(const TMList&) -> TMList& = delete;
+
+  ~TMList() {
+    // Note that the destructor is not thread-safe, so the caller should
+    // guarantee that no transaction can access the list at this point.
+    Node* node = head_;
+    while (node != nullptr) {
+      Node* next = node->next_.get();
+      delete node;
+      node = next;
+    }
+  }
+
+  /**
+   * @brief Add `item` unless an equal item is present. Each attempt of the
+   * transaction copies `item` into a new node.
+   */
+  auto add(const T& item) -> bool {
+    Key key = order_.make_key(item);
+    return atomically([&]() {
+      auto [pred, curr] = search(key);
+      if (curr != tail_ && order_.matches(curr, key)) {
+        return false;
+      }
+      Node* node = tm_new<Node>(key.hash_, item);
+      node->next_.set(curr);
+      pred->next_.set(node);
+      return true;
+    });
+  }
+
+  auto remove(const T& item) -> bool {
+    Key key = order_.make_key(item);
+    return atomically([&]() {
+      auto [pred, curr] = search(key);
+      if (curr == tail_ || !order_.matches(curr, key)) {
+        return false;
+      }
+      pred->next_.set(curr->next_.get());
+      tm_delete(curr);
+      return true;
+    });
+  }
+
+  auto contains(const T& item) -> bool {
+    Key key = order_.make_key(item);
+    return atomically([&]() {
+      Node* curr = search(key).second;
+      return curr != tail_ && order_.matches(curr, key);
+    });
+  }
+
+ private:
+  // The last node that precedes `key` and the node after it
+  auto search(const Key& key) const -> std::pair<Node*, Node*> {
+    Node* pred = head_;
+    Node* curr = pred->next_.get();
+    while (order_.precedes(curr, key)) {
+      pred = curr;
+      curr = curr->next_.get();
+    }
+    return {pred, curr};
+  }
+
+  Node* head_{nullptr};
+  Node* tail_{nullptr};
+  Order order_{};
+};
+
+#endif  // TM_LIST_H_
@@ -0,0 +1,90 @@
+#ifndef TM_QUEUE_H_
+#define TM_QUEUE_H_
+
+#include <optional>
+#include <utility>
+
+#include "stm/stm.h"
+#include "util/cache_aligned.h"
+
+/**
+ * TMQueue - An unbounded FIFO queue whose links are TVars
+ *
+ * A linked list with a sentinel head, as in UnboundedQueue, where every
+ * operation is a transaction (see stm.h), so that queue operations compose
+ * with those on other TMQueues and TMLists inside one atomically().
+ * Enqueuers conflict on `tail_` and dequeuers on `head_`, which lie on
+ * separate cache lines, as do their versioned locks; the two only conflict
+ * with each other when the queue is empty.
+ */
+template<typename T>
+class TMQueue {
+  struct Node {
+    std::optional<T> value_;
+    TVar<Node*> next_;
+
+    Node() = default;
+
+    explicit Node(const T& value) : value_(value) {}
+  };
+
+ public:
+  TMQueue() {
+    auto sentinel = new Node();
+    head_->set(sentinel);
+    tail_->set(sentinel);
+  }
+
+  TMQueue(const TMQueue&) = delete;
+  auto operator=(const TMQueue&) -> TMQueue& = delete;
+
+  ~TMQueue() {
+    // Note that the destructor is not thread-safe, so the caller should
+    // guarantee that no transaction can access the queue at this point.
+    Node* node = head_->get();
+    while (node != nullptr) {
+      Node* next = node->next_.get();
+      delete node;
+      node = next;
+    }
+  }
+
+  /**
+   * @brief Append `value`. Each attempt of the transaction copies `value`
+   * into a new node.
+   */
+  auto enqueue(const T& value) -> void {
+    atomically([&]() {
+      Node* node = tm_new<Node>(value);
+      tail_->get()->next_.set(node);
+      tail_->set(node);
+    });
+  }
+
+  /**
+   * @brief Remove the value at the front, if any
+   */
+  auto try_dequeue() -> std::optional<T> {
+    return atomically([&]() -> std::optional<T> {
+      Node* sentinel = head_->get();
+      Node* first = sentinel->next_.get();
+      if (first == nullptr) {
+        return std::nullopt;
+      }
+      // `first` becomes the sentinel; its value stays until it is freed
+      head_->set(first);
+      tm_delete(sentinel);
+      return first->value_;
+    });
+  }
+
+  auto empty() const -> bool {
+    return atomically([&]() { return head_->get()->next_.get() == nullptr; });
+  }
+
+ private:
+  CacheAligned<TVar<Node*>> head_;
+  CacheAligned<TVar<Node*>> tail_;
+};
+
+#endif  // TM_QUEUE_H_
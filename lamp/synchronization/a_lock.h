@@ -5,38 +5,106 @@
 #include <vector>
 
 #include "synchronization/lock.h"
-
-struct Flag {
-  std::atomic<bool> flag_{false};
-  // Force each flag to be on a new cache line
-  char padding[127];
-};
+#include "synchronization/lock_node_table.h"
+#include "synchronization/wait_policy.h"
+#include "util/cache_aligned.h"
 
 /**
- * @brief A simple array-based queue lock.
+ * @brief A simple array-based queue lock. `WaitPolicy` decides how a waiter
+ * spins on its slot.
+ *
+ * A thread that gives up waiting cannot hand back its slot, and slots left
+ * behind by timed-out threads would eat into the capacity without bound. So
+ * try_lock() and try_lock_for() only take a slot that is already granted: a
+ * thread that times out has never joined the queue.
+ *
+ * The caller may keep the slot it holds in a `Node`, e.g. on its stack with
+ * ScopedLock; plain lock() and unlock() keep it in a LockNodeTable entry for
+ * this lock. Either way a thread can hold several array locks at once.
  */
-class ALock : public Lock {
+template<typename WaitPolicy = DefaultWaitPolicy>
+class ALock : public LockBase<ALock<WaitPolicy>> {
  public:
   ALock(uint64_t capacity) : flags_(capacity), kSize(capacity) {
-    flags_[0].flag_.store(true, std::memory_order_relaxed);
+    flags_[0]->store(true, std::memory_order_relaxed);
+  }
+
+  // The slot in which the caller holds or waits for the lock
+  struct Node {
+    uint64_t slot_{0};
+  };
+
+  auto lock(Node& node) -> void {
+    node.slot_ = tail_.fetch_add(1, std::memory_order_relaxed) % kSize;
+    WaitPolicy::wait_until(*flags_[node.slot_], [](bool flag) { return flag; });
+  }
+
+  auto unlock(Node& node) -> void {
+    uint64_t slot = node.slot_;
+    uint64_t next_slot = (slot + 1) % kSize;
+    flags_[slot]->store(false, std::memory_order_relaxed);
+    flags_[next_slot]->store(true, std::memory_order_release);
+    WaitPolicy::notify_one(*flags_[next_slot]);
   }
 
-  auto lock() -> void override {
-    uint64_t slot = tail_.fetch_add(1, std::memory_order_relaxed) % kSize;
-    my_slot_index = slot;
-    while (!flags_[slot].flag_.load(std::memory_order_acquire)) {}
+  auto try_lock(Node& node) -> bool {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    // The slot that the next thread would take is granted only while the lock
+    // is free
+    if (!flags_[tail % kSize]->load(std::memory_order_acquire) ||
+        !tail_.compare_exchange_strong(tail, tail + 1,
+                                       std::memory_order_relaxed)) {
+      return false;
+    }
+    node.slot_ = tail % kSize;
+    return true;
   }
 
-  auto unlock() -> void override {
-    uint64_t slot = my_slot_index;
-    flags_[slot].flag_.store(false, std::memory_order_relaxed);
-    flags_[(slot + 1) % kSize].flag_.store(true, std::memory_order_release);
+  auto try_lock_until(Node& node, LockClock::time_point deadline) -> bool {
+    while (!try_lock(node)) {
+      if (LockClock::now() >= deadline) {
+        return false;
+      }
+      cpu_relax();
+    }
+    return true;
   }
 
-  static thread_local uint64_t my_slot_index;
+  auto lock() -> void {
+    Node node;
+    lock(node);
+    Slots::insert(this, node.slot_);
+  }
+
+  auto unlock() -> void {
+    Node node{Slots::erase(this)};
+    unlock(node);
+  }
+
+  auto try_lock() -> bool {
+    Node node;
+    if (!try_lock(node)) {
+      return false;
+    }
+    Slots::insert(this, node.slot_);
+    return true;
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    Node node;
+    if (!try_lock_until(node, deadline)) {
+      return false;
+    }
+    Slots::insert(this, node.slot_);
+    return true;
+  }
 
  private:
-  std::vector<Flag> flags_;
+  using Slots = LockNodeTable<uint64_t>;
+
+  // Each flag is on its own cache line, so a thread spins on a line that only
+  // its predecessor writes
+  std::vector<CacheAligned<std::atomic<bool>>> flags_;
   std::atomic<uint64_t> tail_{0};
   const uint64_t kSize;
 };
@@ -9,19 +9,27 @@
 
 /**
  * @brief A test-and-test-and-set lock with an exponential backoff mechanism.
+ * Backoff delays below `spin_threshold` are spun rather than slept.
+ * try_lock_for() may overrun its timeout by up to one backoff delay.
  */
 template<typename Duration = std::chrono::microseconds>
-class BackoffLock : public Lock {
+class BackoffLock : public LockBase<BackoffLock<Duration>> {
  public:
   BackoffLock() = default;
 
-  BackoffLock(int64_t min_delay, int64_t max_delay)
-      : kMinDelay(min_delay), kMaxDelay(max_delay) {}
+  BackoffLock(int64_t min_delay, int64_t max_delay,
+              Duration spin_threshold = std::chrono::duration_cast<Duration>(
+                  Backoff<Duration>::kDefaultSpinThreshold))
+      : kMinDelay(min_delay),
+        kMaxDelay(max_delay),
+        kSpinThreshold(spin_threshold) {}
 
-  auto lock() -> void override {
-    Backoff<Duration> backoff{kMinDelay, kMaxDelay};
+  auto lock() -> void {
+    Backoff<Duration> backoff{kMinDelay, kMaxDelay, kSpinThreshold};
     while (true) {
-      while (state_.test(std::memory_order_relaxed)) {}
+      while (state_.test(std::memory_order_relaxed)) {
+        cpu_relax();
+      }
       if (!state_.test_and_set(std::memory_order_acquire)) {
         return;
       }
@@ -29,13 +37,39 @@ class BackoffLock : public Lock {
     }
   }
 
-  auto unlock() -> void override { state_.clear(std::memory_order_release); }
+  auto unlock() -> void { state_.clear(std::memory_order_release); }
+
+  auto try_lock() -> bool {
+    return !state_.test(std::memory_order_relaxed) &&
+           !state_.test_and_set(std::memory_order_acquire);
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    Backoff<Duration> backoff{kMinDelay, kMaxDelay, kSpinThreshold};
+    while (true) {
+      while (state_.test(std::memory_order_relaxed)) {
+        if (LockClock::now() >= deadline) {
+          return false;
+        }
+        cpu_relax();
+      }
+      if (!state_.test_and_set(std::memory_order_acquire)) {
+        return true;
+      }
+      if (LockClock::now() >= deadline) {
+        return false;
+      }
+      backoff.backoff();
+    }
+  }
 
  private:
   std::atomic_flag state_{false};
   // Default backoff duration ranges from 5ms - 25ms
   const int64_t kMinDelay{5};
   const int64_t kMaxDelay{25};
+  const Duration kSpinThreshold{std::chrono::duration_cast<Duration>(
+      Backoff<Duration>::kDefaultSpinThreshold)};
 };
 
 #endif  // BACKOFF_LOCK_H_
\ No newline at end of file
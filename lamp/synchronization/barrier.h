@@ -0,0 +1,262 @@
+#ifndef BARRIER_H_
+#define BARRIER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "synchronization/wait_policy.h"
+#include "util/cache_aligned.h"
+
+/**
+ * Barriers - Make a fixed number of threads wait for each other at the end of
+ * every phase [Mel91]
+ *
+ * All four barriers can be reused for any number of phases. Waiting threads
+ * wait according to `WaitPolicy`, by default spinning briefly and then
+ * parking, and the thread that completes a phase notifies them.
+ *
+ * SenseReversingBarrier needs no thread ids and can replace std::barrier
+ * directly, but every arrival decrements one shared counter. The other three
+ * spread arrivals over several words and take the caller's id, from 0 to
+ * `num_threads - 1`, where each thread must use its own id.
+ */
+
+/**
+ * SenseReversingBarrier - A shared counter and a sense flag that the last
+ * thread to arrive flips
+ *
+ * A thread reads the sense before it arrives: the sense cannot flip until it
+ * has arrived, so the thread waits for the sense to differ from what it read,
+ * which needs no thread-local sense.
+ */
+template<typename WaitPolicy = SpinThenPark<>>
+class SenseReversingBarrier {
+ public:
+  explicit SenseReversingBarrier(size_t num_threads)
+      : kNumThreads(num_threads), count_(num_threads) {}
+
+  SenseReversingBarrier(const SenseReversingBarrier&) = delete;
+  auto operator=(const SenseReversingBarrier&)
+      -> SenseReversingBarrier& = delete;
+
+  auto arrive_and_wait() -> void {
+    bool sense = sense_->load(std::memory_order_acquire);
+    if (count_->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      // Reset before the flip, which lets threads into the next phase
+      count_->store(kNumThreads, std::memory_order_relaxed);
+      sense_->store(!sense, std::memory_order_release);
+      WaitPolicy::notify_all(*sense_);
+      return;
+    }
+    WaitPolicy::wait_until(*sense_,
+                           [sense](bool current) { return current != sense; });
+  }
+
+ private:
+  const size_t kNumThreads;
+  CacheAligned<std::atomic<size_t>> count_;
+  CacheAligned<std::atomic<bool>> sense_{false};
+};
+
+/**
+ * CombiningTreeBarrier - A tree of sense-reversing barriers, each shared by
+ * at most `radix` threads or subtrees
+ *
+ * Threads arrive at the leaf for their id. The last thread to arrive at a
+ * node goes on to its parent, and the last one at the root completes the
+ * phase; on the way back, each of these threads flips the sense of the node
+ * it completed. So at most `radix` threads contend for any one counter.
+ */
+template<typename WaitPolicy = SpinThenPark<>>
+class CombiningTreeBarrier {
+  struct Node {
+    std::atomic<size_t> count_{0};
+    std::atomic<bool> sense_{false};
+    size_t size_{0};  // The number of threads or children that arrive here
+    size_t parent_{0};
+  };
+
+  static constexpr size_t kNoParent = SIZE_MAX;
+
+ public:
+  explicit CombiningTreeBarrier(size_t num_threads, size_t radix = 4)
+      : kRadix(radix), nodes_(num_nodes(num_threads, radix)) {
+    // The leaves come first, then each level above them, up to the root
+    size_t level_begin = 0;
+    size_t arrivals = num_threads;
+    while (true) {
+      size_t level_size = (arrivals + kRadix - 1) / kRadix;
+      for (size_t i = 0; i < level_size; i++) {
+        Node& node = *nodes_[level_begin + i];
+        node.size_ = std::min(kRadix, arrivals - i * kRadix);
+        node.count_.store(node.size_, std::memory_order_relaxed);
+        node.parent_ = level_size == 1 ? kNoParent
+                                       : level_begin + level_size + i / kRadix;
+      }
+      if (level_size == 1) {
+        break;
+      }
+      level_begin += level_size;
+      arrivals = level_size;
+    }
+  }
+
+  CombiningTreeBarrier(const CombiningTreeBarrier&) = delete;
+  auto operator=(const CombiningTreeBarrier&)
+      -> CombiningTreeBarrier& = delete;
+
+  auto arrive_and_wait(size_t thread_id) -> void {
+    arrive(thread_id / kRadix);
+  }
+
+ private:
+  static auto num_nodes(size_t num_threads, size_t radix) -> size_t {
+    size_t total = 0;
+    size_t arrivals = num_threads;
+    do {
+      arrivals = (arrivals + radix - 1) / radix;
+      total += arrivals;
+    } while (arrivals > 1);
+    return total;
+  }
+
+  auto arrive(size_t index) -> void {
+    Node& node = *nodes_[index];
+    bool sense = node.sense_.load(std::memory_order_acquire);
+    if (node.count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      if (node.parent_ != kNoParent) {
+        arrive(node.parent_);
+      }
+      node.count_.store(node.size_, std::memory_order_relaxed);
+      node.sense_.store(!sense, std::memory_order_release);
+      WaitPolicy::notify_all(node.sense_);
+      return;
+    }
+    WaitPolicy::wait_until(node.sense_,
+                           [sense](bool current) { return current != sense; });
+  }
+
+  const size_t kRadix;
+  std::vector<CacheAligned<Node>> nodes_;
+};
+
+/**
+ * StaticTreeBarrier - Threads form a tree of the given radix, in which each
+ * thread waits for its children to arrive before it signals its parent
+ *
+ * Thread `i` has threads `radix * i + 1` to `radix * i + radix` as children.
+ * Each thread waits on its own node's counter, which only its children
+ * decrement, and all threads then wait for the root to flip the sense. A
+ * phase takes `num_threads - 1` decrements in total and no thread contends
+ * for a counter with more than `radix - 1` others.
+ */
+template<typename WaitPolicy = SpinThenPark<>>
+class StaticTreeBarrier {
+  struct Node {
+    std::atomic<size_t> pending_{0};  // The children yet to arrive
+    size_t num_children_{0};
+  };
+
+ public:
+  explicit StaticTreeBarrier(size_t num_threads, size_t radix = 4)
+      : kRadix(radix), nodes_(num_threads) {
+    for (size_t i = 0; i < num_threads; i++) {
+      size_t first_child = kRadix * i + 1;
+      size_t num_children =
+          first_child >= num_threads
+              ? 0
+              : std::min(kRadix, num_threads - first_child);
+      nodes_[i]->num_children_ = num_children;
+      nodes_[i]->pending_.store(num_children, std::memory_order_relaxed);
+    }
+  }
+
+  StaticTreeBarrier(const StaticTreeBarrier&) = delete;
+  auto operator=(const StaticTreeBarrier&) -> StaticTreeBarrier& = delete;
+
+  auto arrive_and_wait(size_t thread_id) -> void {
+    // The root flips the sense only once this thread has arrived
+    bool sense = sense_->load(std::memory_order_acquire);
+    Node& node = *nodes_[thread_id];
+    WaitPolicy::wait_until(node.pending_,
+                           [](size_t pending) { return pending == 0; });
+    node.pending_.store(node.num_children_, std::memory_order_relaxed);
+
+    if (thread_id == 0) {
+      sense_->store(!sense, std::memory_order_release);
+      WaitPolicy::notify_all(*sense_);
+      return;
+    }
+    Node& parent = *nodes_[(thread_id - 1) / kRadix];
+    parent.pending_.fetch_sub(1, std::memory_order_acq_rel);
+    WaitPolicy::notify_one(parent.pending_);
+    WaitPolicy::wait_until(*sense_,
+                           [sense](bool current) { return current != sense; });
+  }
+
+ private:
+  const size_t kRadix;
+  std::vector<CacheAligned<Node>> nodes_;
+  CacheAligned<std::atomic<bool>> sense_{false};
+};
+
+/**
+ * DisseminationBarrier - The dissemination barrier of Hensgen, Finkel and
+ * Manber [Hen88]
+ *
+ * In round `k` of `ceil(log2(num_threads))`, thread `i` signals thread
+ * `(i + 2^k) % num_threads` and waits for the signal of thread
+ * `(i - 2^k) % num_threads`. After the last round every thread has heard,
+ * directly or not, from every other thread. There is no root and no shared
+ * counter: each flag has one writer and one reader.
+ *
+ * The flags count signals rather than flip, since a partner may run a whole
+ * phase ahead and signal again before its flag has been read. Each thread
+ * keeps the number of phases it has completed, which only it uses.
+ */
+template<typename WaitPolicy = SpinThenPark<>>
+class DisseminationBarrier {
+  static constexpr size_t kMaxRounds = 64;
+
+  struct Flags {
+    std::atomic<uint32_t> signals_[kMaxRounds] = {};
+    uint32_t phase_{0};
+  };
+
+ public:
+  explicit DisseminationBarrier(size_t num_threads)
+      : kNumThreads(num_threads), flags_(num_threads) {
+    while ((size_t{1} << num_rounds_) < kNumThreads) {
+      num_rounds_++;
+    }
+  }
+
+  DisseminationBarrier(const DisseminationBarrier&) = delete;
+  auto operator=(const DisseminationBarrier&)
+      -> DisseminationBarrier& = delete;
+
+  auto arrive_and_wait(size_t thread_id) -> void {
+    Flags& mine = *flags_[thread_id];
+    uint32_t phase = ++mine.phase_;
+    for (size_t round = 0; round < num_rounds_; round++) {
+      size_t partner = (thread_id + (size_t{1} << round)) % kNumThreads;
+      std::atomic<uint32_t>& signal = flags_[partner]->signals_[round];
+      signal.fetch_add(1, std::memory_order_release);
+      WaitPolicy::notify_one(signal);
+      // Counts wrap around, so compare their distance
+      WaitPolicy::wait_until(mine.signals_[round], [phase](uint32_t count) {
+        return static_cast<int32_t>(count - phase) >= 0;
+      });
+    }
+  }
+
+ private:
+  const size_t kNumThreads;
+  size_t num_rounds_{0};
+  std::vector<CacheAligned<Flags>> flags_;
+};
+
+#endif  // BARRIER_H_
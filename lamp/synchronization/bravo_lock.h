@@ -0,0 +1,139 @@
+#ifndef BRAVO_LOCK_H_
+#define BRAVO_LOCK_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "synchronization/phase_fair_read_write_lock.h"
+#include "synchronization/wait_policy.h"
+#include "util/cache_aligned.h"
+#include "util/thread_index.h"
+
+/**
+ * BravoLock - Biased reader-writer locking (BRAVO) [Dic19] on top of any
+ * read-write lock
+ *
+ * While the lock is read-biased, a reader publishes itself in a slot of a
+ * table of visible readers, chosen by its thread index, and never touches the
+ * underlying lock, so readers that do not share a slot scale perfectly. A
+ * reader whose slot is taken, or that finds the bias off, acquires the
+ * underlying lock for reading.
+ *
+ * A writer acquires the underlying lock for writing, and then revokes the bias
+ * by clearing it and waiting for every visible reader to leave. Since that
+ * scan is expensive, the bias is only re-enabled by a slow-path reader once
+ * `kInhibitMultiplier` times the duration of the last revocation has passed,
+ * which bounds the overhead of revocation for write-heavy workloads.
+ *
+ * Unlike the paper's table, which is shared by all locks, each lock owns its
+ * slots and a slot holds the index of the reader that took it, so that
+ * read_unlock() can tell a fast-path reader from a slow-path one without the
+ * caller passing a token around.
+ */
+template<typename ReadWriteLock = PhaseFairReadWriteLock<>,
+         typename WaitPolicy = DefaultWaitPolicy>
+class BravoLock {
+  static constexpr size_t kEmpty = 0;
+
+ public:
+  static constexpr int64_t kInhibitMultiplier = 9;
+
+  /**
+   * @param num_slots the number of visible reader slots, typically the number
+   * of threads
+   */
+  explicit BravoLock(
+      size_t num_slots = std::max(1U, std::thread::hardware_concurrency()))
+      : num_slots_(std::max<size_t>(num_slots, 1)),
+        slots_(std::make_unique<CacheAligned<std::atomic<size_t>>[]>(
+            num_slots_)) {}
+
+  BravoLock(const BravoLock&) = delete;
+  auto operator=(const BravoLock&) -> BravoLock& = delete;
+
+  auto read_lock() -> void {
+    if (read_bias_->load(std::memory_order_acquire)) {
+      std::atomic<size_t>& slot = *slots_[slot_index()];
+      size_t expected = kEmpty;
+      if (slot.compare_exchange_strong(expected, reader_id(),
+                                       std::memory_order_seq_cst)) {
+        // Publish first and check the bias second; a revoking writer does the
+        // opposite, so that at least one of them sees the other
+        if (read_bias_->load(std::memory_order_seq_cst)) {
+          return;
+        }
+        slot.store(kEmpty, std::memory_order_release);
+        WaitPolicy::notify_all(slot);
+      }
+    }
+    lock_.read_lock();
+    // No writer can revoke the bias while we hold the lock for reading
+    if (!read_bias_->load(std::memory_order_relaxed) &&
+        now() >= inhibit_until_) {
+      read_bias_->store(true, std::memory_order_release);
+    }
+  }
+
+  auto read_unlock() -> void {
+    std::atomic<size_t>& slot = *slots_[slot_index()];
+    // Only this thread writes its own id into a slot
+    if (slot.load(std::memory_order_relaxed) == reader_id()) {
+      slot.store(kEmpty, std::memory_order_release);
+      WaitPolicy::notify_all(slot);
+    } else {
+      lock_.read_unlock();
+    }
+  }
+
+  auto write_lock() -> void {
+    lock_.write_lock();
+    if (read_bias_->load(std::memory_order_relaxed)) {
+      read_bias_->store(false, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t start = now();
+      for (size_t i = 0; i < num_slots_; i++) {
+        WaitPolicy::wait_until(*slots_[i],
+                               [](size_t id) { return id == kEmpty; });
+      }
+      int64_t end = now();
+      inhibit_until_ = end + (end - start) * kInhibitMultiplier;
+    }
+  }
+
+  auto write_unlock() -> void { lock_.write_unlock(); }
+
+  /**
+   * Optimistic reads, if the underlying lock supports them. Every writer takes
+   * the underlying lock, so its stamps cover all writes.
+   */
+  auto try_optimistic_read() const -> uint64_t {
+    return lock_.try_optimistic_read();
+  }
+
+  auto validate(uint64_t stamp) const -> bool { return lock_.validate(stamp); }
+
+ private:
+  static auto now() -> int64_t {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+  }
+
+  auto slot_index() const -> size_t { return this_thread_index() % num_slots_; }
+
+  static auto reader_id() -> size_t { return this_thread_index() + 1; }
+
+  const size_t num_slots_;
+  // The id of the fast-path reader in each slot, or kEmpty
+  std::unique_ptr<CacheAligned<std::atomic<size_t>>[]> slots_;
+  CacheAligned<std::atomic<bool>> read_bias_{false};
+  // When the bias may be turned on again; guarded by the underlying lock, as
+  // it is written by writers and read by readers holding the lock
+  int64_t inhibit_until_{0};
+  ReadWriteLock lock_;
+};
+
+#endif  // BRAVO_LOCK_H_
@@ -2,59 +2,183 @@
 #define CLH_LOCK_H_
 
 #include <atomic>
-#include <chrono>
 
 #include "synchronization/lock.h"
-#include "util/backoff.h"
+#include "synchronization/lock_node_table.h"
+#include "synchronization/wait_policy.h"
+#include "util/cache_aligned.h"
+#include "util/stats.h"
 
-class CLHLock : public Lock {
+/**
+ * @brief A queue lock in which each waiter spins on its predecessor's node.
+ * `WaitPolicy` decides how the waiter spins.
+ *
+ * Waiters may give up, as in the timeout lock of Scott and Scherer [Sco01]: a
+ * thread that times out leaves its node in the queue, pointing to its own
+ * predecessor, and its successor skips the node and waits on that predecessor
+ * instead. Each node is referenced by exactly one thread or by the tail, so
+ * the thread that skips a node, or that sees it released, recycles it.
+ * Recycled nodes go to a per-thread cache, so acquisitions do not allocate
+ * once the caches are warm.
+ *
+ * Since nodes move between threads, the caller does not supply a queue node
+ * but a `Node` handle that records which node it queued up with, e.g. on its
+ * stack with ScopedLock. Plain lock() and unlock() keep that node in a
+ * LockNodeTable entry for this lock instead. Either way a thread can hold
+ * several CLH locks at once.
+ */
+template<typename WaitPolicy = DefaultWaitPolicy>
+class CLHLock : public LockBase<CLHLock<WaitPolicy>> {
  private:
   struct QNode {
-    // Record the status of a thread:
-    // - If true, the corresponding thread has either acquired the lock or is
-    // waiting for the lock.
-    // - If false, the thread has released the lock.
-    std::atomic<bool> locked_{false};
+    // The state of the node's thread:
+    // - nullptr: it holds or waits for the lock.
+    // - &released_: it has released the lock.
+    // - another node: it has given up, and that node is its predecessor.
+    std::atomic<QNode*> pred_{nullptr};
+    QNode* next_free_{nullptr};  // The next node of a thread's node cache
   };
 
  public:
-  CLHLock() {
-    auto qnode = new QNode();
-    tail_.store(qnode, std::memory_order_relaxed);
+  ~CLHLock() {
+    // Once the lock is free, the tail may still lead through abandoned nodes
+    // to a released one
+    QNode* qnode = tail_->load(std::memory_order_relaxed);
+    while (qnode != nullptr) {
+      QNode* pred = qnode->pred_.load(std::memory_order_relaxed);
+      delete qnode;
+      qnode = pred == &released_ ? nullptr : pred;
+    }
   }
 
-  ~CLHLock() { delete tail_.load(std::memory_order_relaxed); }
+  // The queue node under which the caller holds or waits for the lock
+  struct Node {
+    QNode* qnode_{nullptr};
+  };
 
-  auto lock() -> void override {
-    // Load the pointer to our node from the thread-local variable.
-    QNode* qnode = my_node_;
-    // Indicate our intention to acquire the lock.
-    qnode->locked_.store(true, std::memory_order_release);
+  auto lock(Node& node) -> void {
+    try_lock_until(node, LockClock::time_point::max());
+  }
 
-    // Get the node that represents the state of the predecessor thread.
-    QNode* pred = tail_.exchange(qnode, std::memory_order_relaxed);
+  auto unlock(Node& node) -> void {
+    QNode* qnode = node.qnode_;
+    QNode* expected = qnode;
+    // Without a successor the queue becomes empty, and no one else references
+    // our node
+    if (tail_->compare_exchange_strong(expected, nullptr,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+      node_cache_.put(qnode);
+      return;
+    }
+    qnode->pred_.store(&released_, std::memory_order_release);
+    WaitPolicy::notify_one(qnode->pred_);
+  }
 
-    // Save the pointer to the predecessor node.
-    my_pred_ = pred;
+  // Joins the queue only if the predecessor has released the lock
+  auto try_lock(Node& node) -> bool {
+    return try_lock_until(node, LockClock::time_point::min());
+  }
 
-    // Check if the predecessor thread has acquired the lock or is waiting for
-    // the lock.
-    Backoff<std::chrono::microseconds> backoff{5, 25};
-    while (pred->locked_.load(std::memory_order_acquire)) {
-      backoff.backoff();
+  auto try_lock_until(Node& node, LockClock::time_point deadline) -> bool {
+    QNode* qnode = node_cache_.get();
+    QNode* pred = tail_->exchange(qnode, std::memory_order_acq_rel);
+    // Only lock() waits without a deadline
+    LAMP_STAT_ADD(Stat::kAcquisitions,
+                  deadline == LockClock::time_point::max());
+    LAMP_STAT_ADD(Stat::kContendedAcquisitions,
+                  deadline == LockClock::time_point::max() && pred != nullptr);
+    while (pred != nullptr) {
+      auto ready = [](QNode* state) { return state != nullptr; };
+      bool changed = deadline == LockClock::time_point::max()
+                         ? (WaitPolicy::wait_until(pred->pred_, ready), true)
+                         : wait_until_deadline(pred->pred_, ready, deadline);
+      if (!changed) {
+        abandon(qnode, pred);
+        return false;
+      }
+      QNode* state = pred->pred_.load(std::memory_order_acquire);
+      // We were the only thread referencing the predecessor's node
+      node_cache_.put(pred);
+      if (state == &released_) {
+        break;
+      }
+      // The predecessor has given up, so wait for its predecessor instead
+      pred = state;
     }
+    node.qnode_ = qnode;
+    return true;
   }
 
-  auto unlock() -> void override {
-    my_node_->locked_.store(false, std::memory_order_release);
-    // We can reuse the predecessor node as our own node.
-    my_node_ = my_pred_;
+  auto lock() -> void { try_lock_until(LockClock::time_point::max()); }
+
+  auto unlock() -> void {
+    Node node{Nodes::erase(this)};
+    unlock(node);
+  }
+
+  auto try_lock() -> bool {
+    return try_lock_until(LockClock::time_point::min());
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    Node node;
+    if (!try_lock_until(node, deadline)) {
+      return false;
+    }
+    Nodes::insert(this, node.qnode_);
+    return true;
   }
 
  private:
-  std::atomic<QNode*> tail_;
-  static thread_local QNode* my_pred_;
-  static thread_local QNode* my_node_;
+  // Leaves the queue, which `pred` still holds or waits for
+  auto abandon(QNode* qnode, QNode* pred) -> void {
+    QNode* expected = qnode;
+    if (tail_->compare_exchange_strong(expected, pred,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_relaxed)) {
+      // No successor has seen our node
+      node_cache_.put(qnode);
+      return;
+    }
+    // Our successor now references `pred` through our node
+    qnode->pred_.store(pred, std::memory_order_release);
+    WaitPolicy::notify_one(qnode->pred_);
+  }
+
+  // The recycled nodes of a thread, freed when the thread exits
+  struct NodeCache {
+    QNode* head_{nullptr};
+
+    ~NodeCache() {
+      while (head_ != nullptr) {
+        QNode* next = head_->next_free_;
+        delete head_;
+        head_ = next;
+      }
+    }
+
+    auto get() -> QNode* {
+      if (head_ == nullptr) {
+        return new QNode();
+      }
+      QNode* qnode = head_;
+      head_ = qnode->next_free_;
+      qnode->pred_.store(nullptr, std::memory_order_relaxed);
+      return qnode;
+    }
+
+    auto put(QNode* qnode) -> void {
+      qnode->next_free_ = head_;
+      head_ = qnode;
+    }
+  };
+
+  using Nodes = LockNodeTable<QNode*>;
+
+  CacheAligned<std::atomic<QNode*>> tail_{nullptr};
+  static inline QNode released_;
+  static inline thread_local NodeCache node_cache_;
 };
 
 #endif  // CLH_LOCK_H_
@@ -0,0 +1,127 @@
+#ifndef COHORT_LOCK_H_
+#define COHORT_LOCK_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "synchronization/lock.h"
+#include "synchronization/mcs_lock.h"
+#include "synchronization/ticket_lock.h"
+#include "util/backoff.h"
+#include "util/cache_aligned.h"
+#include "util/numa.h"
+
+/**
+ * CohortLock - A NUMA-aware lock built from a global lock and one local lock
+ * per NUMA node [Dic12]
+ *
+ * A thread first takes the local lock of its node; the first thread of a
+ * cohort then also takes the global lock. On release, a thread whose local
+ * lock has waiters passes the global lock on to them by releasing only the
+ * local lock, so the lock and the data it protects stay on one node for a
+ * batch of critical sections. After `kMaxLocalHandoffs` consecutive handoffs
+ * the cohort releases the global lock, so that other nodes are not starved.
+ *
+ * The global lock is often released by another thread than the one that took
+ * it, so it must be thread-oblivious (e.g. TicketLock or TTASLock, but not
+ * MCSLock or CLHLock). The local lock must provide has_waiters() to its
+ * holder. `Topology` maps the calling thread to its node.
+ *
+ * try_lock_for() polls the local lock with try_lock() rather than queueing on
+ * it: a local waiter that gave up would still count as a waiter in
+ * has_waiters(), and the cohort could keep the global lock with no thread left
+ * to use it.
+ */
+template<TimedLockable GlobalLock = TicketLock<>,
+         Lockable LocalLock = MCSLock<>, typename Topology = NumaTopology>
+class CohortLock
+    : public LockBase<CohortLock<GlobalLock, LocalLock, Topology>> {
+  struct Cohort {
+    LocalLock lock_;
+    // Whether a thread of the cohort holds the global lock; guarded by `lock_`
+    bool owns_global_{false};
+    // The number of consecutive handoffs within the cohort; guarded by `lock_`
+    int handoffs_{0};
+  };
+
+ public:
+  static constexpr int kMaxLocalHandoffs = 64;
+
+  /**
+   * @param num_cohorts the number of local locks; threads of node `n` share
+   * local lock `n % num_cohorts`
+   */
+  explicit CohortLock(size_t num_cohorts = Topology::node_count())
+      : cohorts_(std::max<size_t>(num_cohorts, 1)) {}
+
+  auto lock() -> void {
+    size_t index = Topology::this_thread_node() % cohorts_.size();
+    Cohort& cohort = *cohorts_[index];
+    cohort.lock_.lock();
+    if (!cohort.owns_global_) {
+      global_.lock();
+      cohort.owns_global_ = true;
+    }
+    // The thread may migrate to another node before unlock()
+    owner_ = index;
+  }
+
+  auto try_lock() -> bool {
+    size_t index = Topology::this_thread_node() % cohorts_.size();
+    Cohort& cohort = *cohorts_[index];
+    if (!cohort.lock_.try_lock()) {
+      return false;
+    }
+    if (!cohort.owns_global_) {
+      if (!global_.try_lock()) {
+        cohort.lock_.unlock();
+        return false;
+      }
+      cohort.owns_global_ = true;
+    }
+    owner_ = index;
+    return true;
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    size_t index = Topology::this_thread_node() % cohorts_.size();
+    Cohort& cohort = *cohorts_[index];
+    while (!cohort.lock_.try_lock()) {
+      if (LockClock::now() >= deadline) {
+        return false;
+      }
+      cpu_relax();
+    }
+    if (!cohort.owns_global_) {
+      if (!global_.try_lock_until(deadline)) {
+        cohort.lock_.unlock();
+        return false;
+      }
+      cohort.owns_global_ = true;
+    }
+    owner_ = index;
+    return true;
+  }
+
+  auto unlock() -> void {
+    Cohort& cohort = *cohorts_[owner_];
+    if (cohort.handoffs_ < kMaxLocalHandoffs && cohort.lock_.has_waiters()) {
+      cohort.handoffs_++;
+    } else {
+      cohort.handoffs_ = 0;
+      cohort.owns_global_ = false;
+      global_.unlock();
+    }
+    cohort.lock_.unlock();
+  }
+
+ private:
+  // Each local lock is on its own cache line(s), so that the waiters of one
+  // node do not disturb those of another
+  std::vector<CacheAligned<Cohort>> cohorts_;
+  GlobalLock global_;
+  size_t owner_{0};  // The cohort of the holder; guarded by the lock
+};
+
+#endif  // COHORT_LOCK_H_
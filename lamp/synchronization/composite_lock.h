@@ -5,14 +5,28 @@
 #include <chrono>
 #include <vector>
 
+#include "synchronization/lock.h"
+#include "synchronization/lock_node_table.h"
 #include "util/atomic_stamped_ptr.h"
 #include "util/backoff.h"
+#include "util/cache_aligned.h"
 #include "util/common.h"
+#include "util/cpu.h"
 
-template<typename Duration>
-using TimePoint = std::chrono::time_point<std::chrono::steady_clock, Duration>;
-
-class CompositeLock {
+/**
+ * @brief The composite lock of Herlihy and Shavit, with their fast path: a
+ * thread that finds the queue empty (the tail null, released, or left behind
+ * by threads that timed out) takes the lock with a single CAS on the tail,
+ * setting a flag bit in its stamp, and skips the waiting array altogether. A
+ * thread that reaches the head of the queue waits for the flag to clear, so
+ * the fast path does not change the behavior under contention.
+ *
+ * Backoff delays are in units of `Duration`. Spinning threads check their
+ * deadline against the cycle counter rather than the clock, so the check is
+ * cheap enough for every iteration.
+ */
+template<typename Duration = std::chrono::microseconds>
+class CompositeLock : public LockBase<CompositeLock<Duration>> {
   // - FREE: the node is available for threads to acquire.
   // - WAITING: a WAITING node is linked into the queue, and the owning thread
   // is either in the critical section or waiting to enter.
@@ -27,7 +41,17 @@ class CompositeLock {
     std::atomic<QNode*> pred_{nullptr};
   };
 
+  using Tail = AtomicStampedPtr<QNode>;
+
+  // The top bit of the tail's stamp, set while a thread holds the lock
+  // through the fast path; the bits below it count updates
+  static constexpr uint64_t kFastPath = (Tail::kMaxStamp >> 1) + 1;
+  static constexpr uint64_t kCounter = kFastPath - 1;
+
  public:
+  // Default: 16 nodes and delays of 1-16 units
+  CompositeLock() : CompositeLock(16, 1, 16) {}
+
   CompositeLock(size_t size, int64_t min_delay, int64_t max_delay)
       : kSize(size),
         kMinDelay(min_delay),
@@ -35,17 +59,34 @@ class CompositeLock {
         tail_(nullptr, 0),
         waiting_(kSize) {}
 
-  template<typename Duration>
-  auto try_lock(const Duration& timeout_duration) -> bool {
+  auto lock() -> void { try_lock_until(LockClock::time_point::max()); }
+
+  auto try_lock() -> bool {
+    return try_lock_until(LockClock::time_point::min());
+  }
+
+  template<typename Rep, typename Period>
+  auto try_lock(const std::chrono::duration<Rep, Period>& timeout_duration)
+      -> bool {
+    return this->try_lock_for(timeout_duration);
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    if (fast_path_lock()) {
+      // No node: `unlock` takes the fast path too
+      Nodes::insert(this, nullptr);
+      return true;
+    }
     try {
-      auto start = std::chrono::time_point_cast<Duration>(
-          std::chrono::steady_clock::now());
+      Deadline spin_deadline(deadline);
       // Acquires a node in the waiting array.
-      QNode* node = acquire_qnode(start, timeout_duration);
+      QNode* node = acquire_qnode(spin_deadline);
       // Enqueues that node in the queue.
-      QNode* pred = splice_qnode(node, start, timeout_duration);
+      QNode* pred = splice_qnode(node, spin_deadline);
       // Waits until that node is at the head of the queue.
-      wait_for_predecessor(pred, node, start, timeout_duration);
+      wait_for_predecessor(pred, node, spin_deadline);
+      // Remembers the node for `unlock` to use
+      Nodes::insert(this, node);
       return true;
     } catch (const TimeoutException&) {
       return false;
@@ -53,22 +94,84 @@ class CompositeLock {
   }
 
   auto unlock() -> void {
-    if (my_node_ != nullptr) {
-      my_node_->state_.store(RELEASED, std::memory_order_release);
-      my_node_ = nullptr;
+    QNode* node = Nodes::erase(this);
+    if (node == nullptr) {
+      fast_path_unlock();
+      return;
     }
+    node->state_.store(RELEASED, std::memory_order_release);
   }
 
  private:
-  template<typename Duration>
-  static auto timeout(const TimePoint<Duration>& start,
-                      const Duration& timeout_duration) -> bool {
-    return std::chrono::steady_clock::now() - start > timeout_duration;
+  // The node under which the calling thread holds each lock
+  using Nodes = LockNodeTable<QNode*>;
+
+  using Deadline = CycleDeadline;
+
+  // Takes the lock if no thread holds or waits for it, i.e. if the tail is
+  // null, a released node, or a chain of nodes abandoned by threads that
+  // timed out, which ends at null or at a released node. The stamp guarantees
+  // that no thread has spliced in behind the tail, so the nodes of the chain
+  // are ours to free.
+  auto fast_path_lock() -> bool {
+    auto [cur_tail, stamp] = tail_->get(std::memory_order_acquire);
+    if ((stamp & kFastPath) != 0) {
+      return false;
+    }
+    // Nodes may be freed and reused under the walk if the tail moves, so it
+    // gives up after more hops than there are nodes
+    QNode* last = cur_tail;
+    for (size_t hops = 0; last != nullptr; hops++) {
+      State state = last->state_.load(std::memory_order_acquire);
+      if (state == RELEASED) {
+        break;
+      }
+      if (state != ABORTED || hops == kSize) {
+        return false;
+      }
+      last = last->pred_.load(std::memory_order_relaxed);
+    }
+    if (!tail_->compare_and_swap(cur_tail, nullptr, stamp,
+                                 next_stamp(stamp) | kFastPath,
+                                 std::memory_order_acquire,
+                                 std::memory_order_relaxed)) {
+      return false;
+    }
+    QNode* node = cur_tail;
+    while (node != last) {
+      QNode* pred = node->pred_.load(std::memory_order_relaxed);
+      node->state_.store(FREE, std::memory_order_release);
+      node = pred;
+    }
+    if (last != nullptr) {
+      last->state_.store(FREE, std::memory_order_release);
+    }
+    return true;
+  }
+
+  // Clears the fast-path flag, while other threads may splice nodes in
+  auto fast_path_unlock() -> void {
+    while (true) {
+      auto [cur_tail, stamp] = tail_->get(std::memory_order_relaxed);
+      if (tail_->compare_and_swap(cur_tail, cur_tail, stamp,
+                                  stamp & ~kFastPath,
+                                  std::memory_order_release,
+                                  std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  // Counts an update of the tail, keeping the fast-path flag as it is
+  static auto next_stamp(uint64_t stamp) -> uint64_t {
+    return ((stamp + 1) & kCounter) | (stamp & kFastPath);
+  }
+
+  static auto timeout(const Deadline& deadline) -> bool {
+    return deadline.expired();
   }
 
-  template<typename Duration>
-  auto acquire_qnode(const TimePoint<Duration>& start,
-                     const Duration& timeout_duration) -> QNode* {
+  auto acquire_qnode(const Deadline& deadline) -> QNode* {
     size_t index = get_random_int<size_t>(0, kSize - 1);
     QNode* node = &waiting_[index];
     Backoff<Duration> backoff{kMinDelay, kMaxDelay};
@@ -84,74 +187,79 @@ class CompositeLock {
 
       // Backoff and retries if the allocated node is WAITING.
       backoff.backoff();
-      if (timeout(start, timeout_duration)) {
+      if (timeout(deadline)) {
         throw TimeoutException(
             "Thread times out while trying to acquire a node");
       }
     }
   }
 
-  template<typename Duration>
-  auto splice_qnode(QNode* node, const TimePoint<Duration>& start,
-                    const Duration& timeout_duration) -> QNode* {
-    QNode* cur_tail;
-    uint64_t stamp;
-    // Repeatedly trying to enqueue a node into the waiting queue.
-    do {
-      std::tie(cur_tail, stamp) = tail_.get(std::memory_order_acquire);
-      if (timeout(start, timeout_duration)) {
+  auto splice_qnode(QNode* node, const Deadline& deadline) -> QNode* {
+    // Repeatedly trying to enqueue a node into the waiting queue. The
+    // deadline is checked only after a failed attempt, so that try_lock(),
+    // whose deadline has always passed, still makes one attempt.
+    while (true) {
+      auto [cur_tail, stamp] = tail_->get(std::memory_order_acquire);
+      if (tail_->compare_and_swap(cur_tail, node, stamp, next_stamp(stamp),
+                                  std::memory_order_release,
+                                  std::memory_order_relaxed)) {
+        return cur_tail;
+      }
+      if (timeout(deadline)) {
         node->state_.store(FREE, std::memory_order_release);
         throw TimeoutException(
             "Thread times out while trying to splice the acquired node into "
             "the waiting queue");
       }
-    } while (!tail_.compare_and_swap(cur_tail, node, stamp, stamp + 1,
-                                     std::memory_order_release,
-                                     std::memory_order_relaxed));
-    return cur_tail;
+    }
   }
 
-  template<typename Duration>
   auto wait_for_predecessor(QNode* pred, QNode* node,
-                            const TimePoint<Duration>& start,
-                            const Duration& timeout_duration) -> void {
-    if (pred == nullptr) {
-      // The thread's node is first in the queue, so it can enter the critical
-      // section. Saves the node in the thread-local `my_node_` variable for the
-      // `unlock` method to use.
-      my_node_ = node;
-      return;
-    }
+                            const Deadline& deadline) -> void {
+    while (pred != nullptr) {
+      State pred_state = pred->state_.load(std::memory_order_acquire);
+      if (pred_state == RELEASED) {
+        pred->state_.store(FREE, std::memory_order_release);
+        break;
+      }
 
-    State pred_state = pred->state_.load(std::memory_order_acquire);
-    while (pred_state != RELEASED) {
       if (pred_state == ABORTED) {
         QNode* next_pred = pred->pred_.load(std::memory_order_relaxed);
         pred->state_.store(FREE, std::memory_order_release);
         pred = next_pred;
+        continue;
       }
 
-      if (timeout(start, timeout_duration)) {
-        node->pred_.store(pred, std::memory_order_relaxed);
-        node->state_.store(ABORTED, std::memory_order_release);
-        throw TimeoutException("Thread timed out waiting for predecessor");
+      if (timeout(deadline)) {
+        abort_qnode(node, pred);
       }
+      cpu_relax();
+    }
 
-      pred_state = pred->state_.load(std::memory_order_acquire);
+    // The thread's node is first in the queue, but a thread that took the
+    // fast path before it was spliced in may still hold the lock.
+    while ((tail_->get_stamp(std::memory_order_acquire) & kFastPath) != 0) {
+      if (timeout(deadline)) {
+        abort_qnode(node, nullptr);
+      }
+      cpu_relax();
     }
+  }
 
-    pred->state_.store(FREE, std::memory_order_release);
-    my_node_ = node;
-    return;
+  // Leaves the node in the queue for the successor to skip to `pred`, which
+  // null makes the successor the first in the queue
+  [[noreturn]] static auto abort_qnode(QNode* node, QNode* pred) -> void {
+    node->pred_.store(pred, std::memory_order_relaxed);
+    node->state_.store(ABORTED, std::memory_order_release);
+    throw TimeoutException("Thread timed out waiting for predecessor");
   }
 
   const size_t kSize;
   const int64_t kMinDelay;
   const int64_t kMaxDelay;
 
-  AtomicStampedPtr<QNode> tail_;
+  CacheAligned<Tail> tail_;
   std::vector<QNode> waiting_;
-  static thread_local QNode* my_node_;
 };
 
 #endif  // COMPOSITE_LOCK_H_
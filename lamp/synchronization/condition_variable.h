@@ -3,9 +3,11 @@
 
 #include <atomic>
 #include <chrono>
-#include <list>
+#include <cstdint>
 #include <thread>
+#include <utility>
 
+#include "synchronization/lock.h"
 #include "synchronization/ttas_lock.h"
 
 enum class CVStatus {
@@ -13,88 +15,98 @@ enum class CVStatus {
   kTimeout,
 };
 
+/**
+ * ConditionVariable - A condition variable that works with any lock
+ *
+ * Each waiting thread links a node allocated on its own stack into a FIFO
+ * list guarded by `waiters_lock_`, so waiting never allocates. A waiter spins
+ * on its node for kSpinCount iterations and then parks on it with
+ * std::atomic::wait, so idle waiters use no CPU. notify_one() unlinks and
+ * wakes exactly the oldest waiter, and notify_all() detaches the whole list at
+ * once.
+ *
+ * std::atomic::wait has no timeout, so the timed waits keep yielding until
+ * they are notified or their deadline passes.
+ */
 class ConditionVariable {
+  struct Waiter {
+    // kWaiting while the node is in the list, kNotified once a notifier has
+    // removed it, and kReleased once the notifier no longer touches it, after
+    // which the waiter may return and free its stack frame
+    std::atomic<uint32_t> state_{kWaiting};
+    Waiter* prev_{nullptr};
+    Waiter* next_{nullptr};
+  };
+
+  static constexpr uint32_t kWaiting = 0;
+  static constexpr uint32_t kNotified = 1;
+  static constexpr uint32_t kReleased = 2;
+
  public:
+  static constexpr int kSpinCount = 128;
+
   ConditionVariable() = default;
 
   // Delete copy constructor and assignment operator
   ConditionVariable(const ConditionVariable&) = delete;
   ConditionVariable& operator=(const ConditionVariable&) = delete;
 
-  ~ConditionVariable() {
-    // Clean up any remaining waiters (should be rare/none in proper usage)
-    waiters_lock_.lock();
-    for (const auto* signal : waiters_) {
-      delete signal;
-    }
-    waiters_lock_.unlock();
-  }
-
   // Notify one waiting thread
   auto notify_one() -> void {
-    std::atomic<bool>* signal_to_set = nullptr;
-
-    // Get one waiter to notify
     waiters_lock_.lock();
-    if (!waiters_.empty()) {
-      signal_to_set = waiters_.front();
-      waiters_.erase(waiters_.begin());
+    Waiter* waiter = head_;
+    if (waiter != nullptr) {
+      unlink(waiter);
     }
     waiters_lock_.unlock();
 
-    // Signal the waiter
-    if (signal_to_set) {
-      signal_to_set->store(true, std::memory_order_release);
+    if (waiter != nullptr) {
+      wake(waiter);
     }
   }
 
   // Notify all waiting threads
   auto notify_all() -> void {
-    std::vector<std::atomic<bool>*> to_notify;
-
-    // Get all waiters to notify
     waiters_lock_.lock();
-    to_notify.reserve(waiters_.size());
-    while (!waiters_.empty()) {
-      to_notify.push_back(waiters_.front());
-      waiters_.erase(waiters_.begin());
+    Waiter* waiter = head_;
+    for (Waiter* curr = head_; curr != nullptr; curr = curr->next_) {
+      curr->state_.store(kNotified, std::memory_order_relaxed);
     }
+    head_ = nullptr;
+    tail_ = nullptr;
     waiters_lock_.unlock();
 
-    // Signal all waiters
-    for (auto* signal : to_notify) {
-      signal->store(true, std::memory_order_release);
+    while (waiter != nullptr) {
+      // Read the link first, since the waiter may return once it is released
+      Waiter* next = waiter->next_;
+      wake(waiter);
+      waiter = next;
     }
   }
 
   // Wait for a notification
-  template<typename Lock>
+  template<BasicLockable Lock>
   auto wait(Lock& lock) -> void {
-    // Create a signal for this waiter
-    auto signal = new std::atomic<bool>(false);
-
-    // Register this waiter
-    waiters_lock_.lock();
-    waiters_.push_back(signal);
-    waiters_lock_.unlock();
+    Waiter waiter;
+    link(&waiter);
 
     // Release the external lock before waiting
     lock.unlock();
 
-    // Wait for the signal to be set
-    while (!signal->load(std::memory_order_acquire)) {
-      std::this_thread::yield();
+    // Spin briefly, then park until notified
+    uint32_t state = spin(waiter);
+    while (state == kWaiting) {
+      waiter.state_.wait(kWaiting, std::memory_order_acquire);
+      state = waiter.state_.load(std::memory_order_acquire);
     }
-
-    // Clean up
-    delete signal;
+    await_release(waiter);
 
     // Reacquire the lock before returning
     lock.lock();
   }
 
   // Wait for a notification with predicate
-  template<typename Lock, typename Predicate>
+  template<BasicLockable Lock, typename Predicate>
   auto wait(Lock& lock, Predicate pred) -> void {
     while (!pred()) {
       wait(lock);
@@ -102,43 +114,36 @@ class ConditionVariable {
   }
 
   // Wait for a notification with timeout
-  template<typename Lock, typename Clock, typename Duration>
+  template<BasicLockable Lock, typename Clock, typename Duration>
   auto wait_until(Lock& lock,
                   const std::chrono::time_point<Clock, Duration>& abs_time)
       -> CVStatus {
-
-    // Create a signal for this waiter
-    auto signal = new std::atomic<bool>(false);
-
-    // Register this waiter
-    waiters_lock_.lock();
-    waiters_.push_back(signal);
-    waiters_lock_.unlock();
+    Waiter waiter;
+    link(&waiter);
 
     // Release the external lock before waiting
     lock.unlock();
 
     // Wait for the signal to be set or timeout
-    bool signaled = false;
-    while (!signaled && Clock::now() < abs_time) {
-      signaled = signal->load(std::memory_order_acquire);
-      if (!signaled) {
-        std::this_thread::yield();
-      }
+    uint32_t state = spin(waiter);
+    while (state == kWaiting && Clock::now() < abs_time) {
+      std::this_thread::yield();
+      state = waiter.state_.load(std::memory_order_acquire);
     }
 
-    // If not signaled, we need to unregister ourselves
-    if (!signaled) {
+    bool signaled = true;
+    if (state == kWaiting) {
+      // Unregister, unless a notifier has unlinked the node in the meantime
       waiters_lock_.lock();
-      auto it = std::find(waiters_.begin(), waiters_.end(), signal);
-      if (it != waiters_.end()) {
-        waiters_.erase(it);
+      if (waiter.state_.load(std::memory_order_relaxed) == kWaiting) {
+        unlink(&waiter);
+        signaled = false;
       }
       waiters_lock_.unlock();
     }
-
-    // Clean up
-    delete signal;
+    if (signaled) {
+      await_release(waiter);
+    }
 
     // Reacquire the lock before returning
     lock.lock();
@@ -147,7 +152,8 @@ class ConditionVariable {
   }
 
   // Wait for a notification with timeout and predicate
-  template<typename Lock, typename Clock, typename Duration, typename Predicate>
+  template<BasicLockable Lock, typename Clock, typename Duration,
+           typename Predicate>
   auto wait_until(Lock& lock,
                   const std::chrono::time_point<Clock, Duration>& abs_time,
                   Predicate pred) -> bool {
@@ -161,14 +167,15 @@ class ConditionVariable {
   }
 
   // Wait for a notification with timeout
-  template<typename Lock, typename Rep, typename Period>
+  template<BasicLockable Lock, typename Rep, typename Period>
   auto wait_for(Lock& lock, const std::chrono::duration<Rep, Period>& rel_time)
       -> CVStatus {
     return wait_until(lock, std::chrono::steady_clock::now() + rel_time);
   }
 
   // Wait for a notification with timeout and predicate
-  template<typename Lock, typename Rep, typename Period, typename Predicate>
+  template<BasicLockable Lock, typename Rep, typename Period,
+           typename Predicate>
   auto wait_for(Lock& lock, const std::chrono::duration<Rep, Period>& rel_time,
                 Predicate pred) -> bool {
     return wait_until(lock, std::chrono::steady_clock::now() + rel_time,
@@ -176,8 +183,54 @@ class ConditionVariable {
   }
 
  private:
-  std::list<std::atomic<bool>*> waiters_;
-  TTASLock waiters_lock_;
+  // Append a waiter to the list
+  auto link(Waiter* waiter) -> void {
+    waiters_lock_.lock();
+    waiter->prev_ = tail_;
+    if (tail_ != nullptr) {
+      tail_->next_ = waiter;
+    } else {
+      head_ = waiter;
+    }
+    tail_ = waiter;
+    waiters_lock_.unlock();
+  }
+
+  // Remove a waiter from the list; `waiters_lock_` must be held
+  auto unlink(Waiter* waiter) -> void {
+    (waiter->prev_ != nullptr ? waiter->prev_->next_ : head_) = waiter->next_;
+    (waiter->next_ != nullptr ? waiter->next_->prev_ : tail_) = waiter->prev_;
+    // Tell the waiter, which may be parked or about to time out, that the node
+    // is no longer in the list
+    waiter->state_.store(kNotified, std::memory_order_relaxed);
+  }
+
+  // Wake a waiter that has been removed from the list
+  static auto wake(Waiter* waiter) -> void {
+    waiter->state_.notify_one();
+    // The waiter returns as soon as it sees kReleased, so this must be the
+    // last access to the node
+    waiter->state_.store(kReleased, std::memory_order_release);
+  }
+
+  static auto spin(Waiter& waiter) -> uint32_t {
+    uint32_t state = waiter.state_.load(std::memory_order_acquire);
+    for (int i = 0; i < kSpinCount && state == kWaiting; i++) {
+      state = waiter.state_.load(std::memory_order_acquire);
+    }
+    return state;
+  }
+
+  // Wait until the notifier is done with the node
+  static auto await_release(Waiter& waiter) -> void {
+    while (waiter.state_.load(std::memory_order_acquire) != kReleased) {
+      std::this_thread::yield();
+    }
+  }
+
+  Waiter* head_{nullptr};
+  Waiter* tail_{nullptr};
+  TTASLock<> waiters_lock_;
 };
 
 #endif  // CONDITION_VARIABLE_H_
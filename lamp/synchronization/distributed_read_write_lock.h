@@ -0,0 +1,128 @@
+#ifndef DISTRIBUTED_READ_WRITE_LOCK_H_
+#define DISTRIBUTED_READ_WRITE_LOCK_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "synchronization/wait_policy.h"
+#include "util/cache_aligned.h"
+#include "util/thread_index.h"
+
+/**
+ * DistributedReadWriteLock - A read-write lock whose reader indicator is split
+ * into per-thread slots, with writer preference
+ *
+ * A reader announces itself by incrementing the slot chosen by its thread
+ * index and then checks that no writer is present, so readers that do not
+ * share a slot never write a common cache line and read-mostly workloads scale
+ * with the number of cores. A writer raises a single flag and then waits for
+ * every slot to drain, so writes cost O(number of slots).
+ *
+ * Arriving writers take precedence: readers that see the flag step back and
+ * wait until it is cleared, so a steady stream of writers can starve readers.
+ * `WaitPolicy` decides how threads wait for the flag and the slots.
+ *
+ * Readers may also read optimistically, without acquiring the lock: see
+ * try_optimistic_read() and validate().
+ */
+template<typename WaitPolicy = DefaultWaitPolicy>
+class DistributedReadWriteLock {
+ public:
+  /**
+   * @param num_slots the number of reader slots, typically the number of
+   * threads
+   */
+  explicit DistributedReadWriteLock(
+      size_t num_slots = std::max(1U, std::thread::hardware_concurrency()))
+      : num_slots_(std::max<size_t>(num_slots, 1)),
+        slots_(std::make_unique<CacheAligned<std::atomic<int64_t>>[]>(
+            num_slots_)) {}
+
+  DistributedReadWriteLock(const DistributedReadWriteLock&) = delete;
+  auto operator=(const DistributedReadWriteLock&)
+      -> DistributedReadWriteLock& = delete;
+
+  auto read_lock() -> void {
+    std::atomic<int64_t>& slot = *slots_[slot_index()];
+    while (true) {
+      // Announce first and check for a writer second; the writer does the
+      // opposite, so that at least one of them sees the other
+      slot.fetch_add(1, std::memory_order_seq_cst);
+      if (!writer_->load(std::memory_order_seq_cst)) {
+        return;
+      }
+      // Step aside so that the writer can proceed
+      slot.fetch_sub(1, std::memory_order_release);
+      WaitPolicy::notify_all(slot);
+      WaitPolicy::wait_until(*writer_, [](bool writer) { return !writer; });
+    }
+  }
+
+  auto read_unlock() -> void {
+    std::atomic<int64_t>& slot = *slots_[slot_index()];
+    slot.fetch_sub(1, std::memory_order_release);
+    WaitPolicy::notify_all(slot);
+  }
+
+  auto write_lock() -> void {
+    while (true) {
+      WaitPolicy::wait_until(*writer_, [](bool writer) { return !writer; });
+      if (!writer_->exchange(true, std::memory_order_seq_cst)) {
+        break;
+      }
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (size_t i = 0; i < num_slots_; i++) {
+      WaitPolicy::wait_until(*slots_[i],
+                             [](int64_t readers) { return readers == 0; });
+    }
+  }
+
+  auto write_unlock() -> void {
+    version_->store(version_->load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+    writer_->store(false, std::memory_order_release);
+    WaitPolicy::notify_all(*writer_);
+  }
+
+  /**
+   * Starts an optimistic read, which writes nothing to shared memory. Data
+   * read before validate() succeeds may be inconsistent, so it should be read
+   * with relaxed atomic loads and used only after validation.
+   *
+   * @return a stamp to pass to validate(), or 0 if a writer holds or waits
+   * for the lock
+   */
+  auto try_optimistic_read() const -> uint64_t {
+    uint64_t version = version_->load(std::memory_order_acquire);
+    return writer_->load(std::memory_order_acquire) ? 0 : version + 1;
+  }
+
+  /**
+   * Returns whether no writer has acquired the lock since
+   * try_optimistic_read() returned `stamp`
+   */
+  auto validate(uint64_t stamp) const -> bool {
+    // Orders the caller's reads before the reads of the writer's state
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return stamp != 0 && !writer_->load(std::memory_order_acquire) &&
+           version_->load(std::memory_order_relaxed) + 1 == stamp;
+  }
+
+ private:
+  auto slot_index() const -> size_t { return this_thread_index() % num_slots_; }
+
+  const size_t num_slots_;
+  // The number of readers in or entering the lock, per slot
+  std::unique_ptr<CacheAligned<std::atomic<int64_t>>[]> slots_;
+  // Set while a writer holds or waits for the lock
+  CacheAligned<std::atomic<bool>> writer_{false};
+  // The number of completed write critical sections, for optimistic readers
+  CacheAligned<std::atomic<uint64_t>> version_{0};
+};
+
+#endif  // DISTRIBUTED_READ_WRITE_LOCK_H_
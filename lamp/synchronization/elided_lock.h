@@ -0,0 +1,221 @@
+#ifndef ELIDED_LOCK_H_
+#define ELIDED_LOCK_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "synchronization/lock.h"
+#include "synchronization/ttas_lock.h"
+#include "util/backoff.h"
+#include "util/cache_aligned.h"
+#include "util/stats.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define LAMP_HAS_RTM 1
+#else
+#define LAMP_HAS_RTM 0
+#endif
+
+/**
+ * ElisionLockable - A lock whose state can be read without acquiring it, so
+ * that a transaction can subscribe to it
+ */
+template<typename L>
+concept ElisionLockable = BasicLockable<L> && requires(const L& lock) {
+  { lock.is_locked() } -> std::convertible_to<bool>;
+};
+
+/**
+ * ElisionAdaptation - Decides which acquisitions of an ElidedLock try a
+ * transaction
+ *
+ * Each acquisition that has to fall back to the lock doubles a penalty, up to
+ * `kMaxPenalty`, and that many following acquisitions skip elision. A
+ * successful elision clears the penalty, writing it only if it is not 0
+ * already, since the write happens inside the transaction and would abort
+ * the other transactions that read the penalty's line.
+ */
+class ElisionAdaptation {
+ public:
+  static constexpr uint32_t kMaxPenalty = 64;
+
+  // Whether the acquisition should try a transaction; counts down the
+  // acquisitions that skip elision
+  auto should_elide() -> bool {
+    uint32_t skip = skip_.load(std::memory_order_relaxed);
+    if (skip > 0) {
+      skip_.store(skip - 1, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  auto on_elided() -> void {
+    if (penalty_.load(std::memory_order_relaxed) != 0) {
+      penalty_.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  auto on_fallback() -> void {
+    uint32_t penalty = penalty_.load(std::memory_order_relaxed);
+    penalty = std::min(std::max(2 * penalty, 1u), kMaxPenalty);
+    penalty_.store(penalty, std::memory_order_relaxed);
+    skip_.store(penalty, std::memory_order_relaxed);
+  }
+
+  auto penalty() const -> uint32_t {
+    return penalty_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Acquisitions left that skip elision
+  std::atomic<uint32_t> skip_{0};
+  // Doubled by every failed elision and cleared by a successful one
+  std::atomic<uint32_t> penalty_{0};
+};
+
+/**
+ * ElidedLock - Speculative lock elision [Raj01] on top of any lock with
+ * is_locked()
+ *
+ * lock() first runs the critical section as a hardware transaction (Intel
+ * RTM) that only reads the lock word, so threads whose critical sections
+ * touch disjoint data run them in parallel; a conflict aborts the
+ * transaction, and so does any thread that acquires `L` for real, since it
+ * writes the word every transaction has read. A transaction that aborts is
+ * retried up to `kMaxAttempts` times, unless the processor reports that a
+ * retry cannot succeed (e.g. the critical section overflowed the cache or made
+ * a system call). The thread then takes `L` as usual.
+ *
+ * Elision adapts to the critical sections it protects (see
+ * ElisionAdaptation): each acquisition that has to fall back to `L` doubles a
+ * penalty, up to `kMaxPenalty`, and that many following acquisitions take `L`
+ * without trying a transaction. A successful transaction clears the penalty.
+ * The adaptive state lives on its own cache line, since writing it from
+ * inside the lock word's line would abort every running transaction.
+ *
+ * Support for RTM is checked once, at run time; without it (or off x86), the
+ * lock behaves exactly as `L`. try_lock() and try_lock_until() never elide.
+ * Critical sections must not tell elided executions apart from real ones,
+ * e.g. by calling is_locked().
+ */
+template<ElisionLockable L = TTASLock<>>
+class ElidedLock : public LockBase<ElidedLock<L>> {
+ public:
+  static constexpr int kMaxAttempts = 3;
+  static constexpr uint32_t kMaxPenalty = ElisionAdaptation::kMaxPenalty;
+
+  auto lock() -> void {
+    if (!htm_available()) {
+      lock_.lock();
+      return;
+    }
+    if (adaptation_->should_elide()) {
+      if (try_elide()) {
+        adaptation_->on_elided();
+        return;
+      }
+      adaptation_->on_fallback();
+    }
+    lock_.lock();
+  }
+
+  auto unlock() -> void {
+    if (htm_available() && in_transaction()) {
+      commit();
+      return;
+    }
+    lock_.unlock();
+  }
+
+  auto try_lock() -> bool
+    requires Lockable<L>
+  {
+    return lock_.try_lock();
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool
+    requires TimedLockable<L>
+  {
+    return lock_.try_lock_until(deadline);
+  }
+
+  // Whether some thread holds the underlying lock; elided holders do not
+  auto is_locked() const -> bool { return lock_.is_locked(); }
+
+  /**
+   * @brief Whether this processor supports restricted transactional memory
+   */
+  static auto htm_available() -> bool {
+    static const bool available = detect_rtm();
+    return available;
+  }
+
+ private:
+  // The abort code of a transaction that found the lock held
+  static constexpr unsigned kLockBusy = 0xff;
+
+  static auto detect_rtm() -> bool {
+#if LAMP_HAS_RTM
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+      return false;
+    }
+    // RTM is bit 11 of EBX; processors whose microcode disables TSX instead
+    // set RTM_ALWAYS_ABORT, bit 11 of EDX
+    return (ebx & (1u << 11)) != 0 && (edx & (1u << 11)) == 0;
+#else
+    return false;
+#endif
+  }
+
+#if LAMP_HAS_RTM
+  // Returns with a running transaction when elision succeeds. The RTM
+  // intrinsics need the "rtm" target, and functions compiled for it are not
+  // inlined into the rest of the program, which may run on any x86.
+  [[gnu::target("rtm"), gnu::noinline]] auto try_elide() -> bool {
+    for (int attempt = 0; attempt < kMaxAttempts; attempt++) {
+      // A transaction started while the lock is held would abort right away
+      while (lock_.is_locked()) {
+        cpu_relax();
+      }
+      unsigned status = _xbegin();
+      if (status == _XBEGIN_STARTED) {
+        if (!lock_.is_locked()) {
+          return true;
+        }
+        _xabort(kLockBusy);
+      }
+      LAMP_STAT_INC(Stat::kTransactionAborts);
+      bool busy = (status & _XABORT_EXPLICIT) != 0 &&
+                  _XABORT_CODE(status) == kLockBusy;
+      if (!busy && (status & _XABORT_RETRY) == 0) {
+        break;
+      }
+    }
+    return false;
+  }
+
+  [[gnu::target("rtm"), gnu::noinline]] static auto in_transaction() -> bool {
+    return _xtest() != 0;
+  }
+
+  [[gnu::target("rtm"), gnu::noinline]] static auto commit() -> void {
+    _xend();
+  }
+#else
+  auto try_elide() -> bool { return false; }
+
+  static auto in_transaction() -> bool { return false; }
+
+  static auto commit() -> void {}
+#endif
+
+  L lock_;
+  CacheAligned<ElisionAdaptation> adaptation_;
+};
+
+#endif  // ELIDED_LOCK_H_
@@ -0,0 +1,106 @@
+#ifndef EVENT_COUNT_H_
+#define EVENT_COUNT_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * EventCount - Lets threads sleep until a lock-free condition may have changed
+ *
+ * A waiter announces itself with prepare_wait(), re-checks its condition
+ * (e.g., tries to dequeue again), and then either calls cancel_wait() if the
+ * condition now holds or wait() to park until the next notification. A
+ * notifier first makes the condition true and then calls notify_one() or
+ * notify_all(), which cost a single load when no thread is waiting, so only
+ * notifications that race with a waiter pay for a wake-up system call.
+ *
+ * No notification is lost: a notifier either sees the waiter's announcement
+ * and bumps the epoch the waiter parks on, or its update to the condition is
+ * visible to the waiter's re-check.
+ */
+class EventCount {
+ public:
+  EventCount() = default;
+
+  EventCount(const EventCount&) = delete;
+  auto operator=(const EventCount&) -> EventCount& = delete;
+
+  /**
+   * Announces that the calling thread is about to wait
+   *
+   * @return the key to pass to wait()
+   */
+  auto prepare_wait() -> uint32_t {
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    return epoch_.load(std::memory_order_seq_cst);
+  }
+
+  /**
+   * Withdraws the announcement of prepare_wait() without waiting
+   */
+  auto cancel_wait() -> void {
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Parks the calling thread until a notification that follows the
+   * prepare_wait() call that returned `key`
+   */
+  auto wait(uint32_t key) -> void {
+    while (epoch_.load(std::memory_order_acquire) == key) {
+      epoch_.wait(key, std::memory_order_acquire);
+    }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Wakes one waiting thread, if any
+   */
+  auto notify_one() -> void {
+    if (has_waiters()) {
+      epoch_.fetch_add(1, std::memory_order_release);
+      epoch_.notify_one();
+    }
+  }
+
+  /**
+   * Wakes up to `count` waiting threads, e.g. one per unit of a resource that
+   * has just been made available
+   */
+  auto notify(uint32_t count) -> void {
+    if (count == 0 || !has_waiters()) {
+      return;
+    }
+    epoch_.fetch_add(1, std::memory_order_release);
+    count = std::min(count, waiters_.load(std::memory_order_relaxed));
+    for (uint32_t i = 0; i < count; i++) {
+      epoch_.notify_one();
+    }
+  }
+
+  /**
+   * Wakes all waiting threads, if any
+   */
+  auto notify_all() -> void {
+    if (has_waiters()) {
+      epoch_.fetch_add(1, std::memory_order_release);
+      epoch_.notify_all();
+    }
+  }
+
+ private:
+  auto has_waiters() -> bool {
+    // Orders the notifier's update of the condition before its check for
+    // waiters, pairing with the read-modify-write in prepare_wait()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return waiters_.load(std::memory_order_relaxed) != 0;
+  }
+
+  // Waiters park on the epoch, which is bumped by every notification that
+  // finds a waiter
+  std::atomic<uint32_t> epoch_{0};
+  std::atomic<uint32_t> waiters_{0};
+};
+
+#endif  // EVENT_COUNT_H_
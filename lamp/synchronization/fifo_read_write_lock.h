@@ -2,21 +2,23 @@
 #define FIFO_READ_WRITE_LOCK_H_
 
 #include "synchronization/condition_variable.h"
+#include "synchronization/lock.h"
 #include "synchronization/scoped_lock.h"
 #include "synchronization/ttas_lock.h"
 
+template<BasicLockable Lock = TTASLock<>>
 class FIFOReadWriteLock {
  public:
   auto read_lock() -> void {
-    ScopedLock<TTASLock> lk(mutex_);
+    ScopedLock<Lock> lk(mutex_);
     while (has_writer_) {
-      cv_.wait(mutex_);
+      cv_.wait(lk);
     }
     num_readers_++;
   }
 
   auto read_unlock() -> void {
-    ScopedLock<TTASLock> lk(mutex_);
+    ScopedLock<Lock> lk(mutex_);
     num_readers_--;
     if (num_readers_ == 0) {
       cv_.notify_all();
@@ -24,18 +26,18 @@ class FIFOReadWriteLock {
   }
 
   auto write_lock() -> void {
-    ScopedLock<TTASLock> lk(mutex_);
+    ScopedLock<Lock> lk(mutex_);
     while (has_writer_) {
-      cv_.wait(mutex_);
+      cv_.wait(lk);
     }
     has_writer_ = true;
     while (num_readers_ > 0) {
-      cv_.wait(mutex_);
+      cv_.wait(lk);
     }
   }
 
   auto write_unlock() -> void {
-    ScopedLock<TTASLock> lk(mutex_);
+    ScopedLock<Lock> lk(mutex_);
     has_writer_ = false;
     cv_.notify_all();
   }
@@ -44,7 +46,7 @@ class FIFOReadWriteLock {
   uint64_t num_readers_{0};  // number of readers that have acquired the lock
   bool has_writer_{false};  // true if there is writer that tries to acquire the
                             // lock or has already acquired the lock
-  TTASLock mutex_;
+  Lock mutex_;
   ConditionVariable cv_;
 };
 
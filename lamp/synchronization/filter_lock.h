@@ -4,6 +4,8 @@
 #include <atomic>
 #include <vector>
 
+#include "util/cpu.h"
+
 class FilterLock {
  public:
   FilterLock(uint32_t n) : kNumThreads(n), level_(n), victim_(n) {}
@@ -24,6 +26,9 @@ class FilterLock {
             break;
           }
         }
+        if (conflict) {
+          cpu_relax();
+        }
       } while (conflict);
     }
   }
@@ -0,0 +1,151 @@
+#ifndef FLAT_COMBINING_H_
+#define FLAT_COMBINING_H_
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "memory/thread_registry.h"
+#include "util/cache_aligned.h"
+
+/**
+ * FlatCombining - Makes a sequential data structure concurrent with flat
+ * combining [Hen10]
+ *
+ * Every thread publishes its operation in its own request record, which stays
+ * in the publication list across operations, and then either waits for its
+ * record to be served or acquires the combiner lock. The combiner runs the
+ * pending operations of all threads on the sequential structure, and hands
+ * each result back through its record. A batch of operations thus costs a
+ * single lock acquisition, and the structure stays in the combiner's cache
+ * instead of moving from core to core with the lock; the other threads only
+ * spin on their own record.
+ *
+ * Operations are callables that take a `Seq&`. An exception thrown by an
+ * operation is rethrown to the thread that requested it. An operation must not
+ * call apply() on the same FlatCombining, since the combiner would wait for
+ * itself.
+ */
+template<typename Seq>
+class FlatCombining {
+  // The states of a request record
+  static constexpr uint32_t kIdle = 0;
+  static constexpr uint32_t kPending = 1;
+
+  struct Record : RegistryNode<Record> {
+    std::atomic<uint32_t> state_{kIdle};
+    auto (*run_)(void* call, Seq& seq) -> void {nullptr};
+    void* call_{nullptr};
+  };
+
+  // The operation and the result of one request, on the requester's stack
+  template<typename Op>
+  struct Call {
+    using Result = std::invoke_result_t<Op&, Seq&>;
+
+    Op& op_;
+    std::conditional_t<std::is_void_v<Result>, bool, std::optional<Result>>
+        result_{};
+    std::exception_ptr error_{};
+
+    static auto run(void* call, Seq& seq) -> void {
+      auto self = static_cast<Call*>(call);
+      try {
+        if constexpr (std::is_void_v<Result>) {
+          std::invoke(self->op_, seq);
+        } else {
+          self->result_.emplace(std::invoke(self->op_, seq));
+        }
+      } catch (...) {
+        self->error_ = std::current_exception();
+      }
+    }
+  };
+
+ public:
+  // Spins on the record before each yield while another thread combines
+  static constexpr int kSpinCount = 128;
+  // Scans of the publication list per combining round; later scans pick up
+  // requests published during the earlier ones
+  static constexpr int kCombinePasses = 2;
+
+  template<typename... Args>
+  explicit FlatCombining(Args&&... args) : seq_(std::forward<Args>(args)...) {}
+
+  FlatCombining(const FlatCombining&) = delete;
+  auto operator=(const FlatCombining&) -> FlatCombining& = delete;
+
+  /**
+   * Runs `op` on the sequential structure, atomically with respect to every
+   * other operation
+   *
+   * @return what `op` returns
+   */
+  template<typename Op>
+  auto apply(Op&& op) -> std::invoke_result_t<Op&, Seq&> {
+    using OpCall = Call<std::remove_reference_t<Op>>;
+    OpCall call{op};
+    Record* record = records_.self([]() { return new Record(); });
+    record->run_ = &OpCall::run;
+    record->call_ = &call;
+    record->state_.store(kPending, std::memory_order_release);
+
+    int spins = 0;
+    while (record->state_.load(std::memory_order_acquire) == kPending) {
+      if (!lock_->load(std::memory_order_relaxed) &&
+          !lock_->exchange(true, std::memory_order_acquire)) {
+        // The combiner serves its own record in the first pass
+        combine();
+        lock_->store(false, std::memory_order_release);
+        break;
+      }
+      if (++spins == kSpinCount) {
+        spins = 0;
+        std::this_thread::yield();
+      }
+    }
+
+    if (call.error_) {
+      std::rethrow_exception(call.error_);
+    }
+    if constexpr (!std::is_void_v<typename OpCall::Result>) {
+      return std::move(*call.result_);
+    }
+  }
+
+  /**
+   * Releases the calling thread's request record so that a thread that
+   * arrives later can adopt it. Optional, but keeps the publication list from
+   * growing with every thread that ever used the structure.
+   */
+  auto unregister_thread() -> void {
+    if (Record* record = records_.find()) {
+      records_.release(record);
+    }
+  }
+
+ private:
+  auto combine() -> void {
+    for (int pass = 0; pass < kCombinePasses; pass++) {
+      for (Record* curr = records_.head(); curr != nullptr;
+           curr = curr->next_) {
+        if (curr->state_.load(std::memory_order_acquire) == kPending) {
+          curr->run_(curr->call_, *seq_);
+          // The last access to the request; its thread may return right away
+          curr->state_.store(kIdle, std::memory_order_release);
+        }
+      }
+    }
+  }
+
+  CacheAligned<std::atomic<bool>> lock_{false};  // Held by the combiner
+  CacheAligned<Seq> seq_;
+  ThreadRegistry<Record> records_;  // The publication list
+};
+
+#endif  // FLAT_COMBINING_H_
@@ -0,0 +1,82 @@
+#ifndef HBO_LOCK_H_
+#define HBO_LOCK_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "synchronization/lock.h"
+#include "util/backoff.h"
+#include "util/numa.h"
+
+/**
+ * @brief A hierarchical backoff lock [Rad03]: a test-and-test-and-set lock
+ * whose state is the NUMA node of its holder. Waiters on the holder's node
+ * back off for short delays and waiters on other nodes for long ones, so the
+ * lock tends to pass between threads of the same node. `Topology` maps the
+ * calling thread to its node. try_lock_for() may overrun its timeout by up to
+ * one backoff delay.
+ */
+template<typename Duration = std::chrono::microseconds,
+         typename Topology = NumaTopology>
+class HBOLock : public LockBase<HBOLock<Duration, Topology>> {
+  static constexpr int64_t kFree = -1;
+
+ public:
+  HBOLock() = default;
+
+  HBOLock(int64_t local_min_delay, int64_t local_max_delay,
+          int64_t remote_min_delay, int64_t remote_max_delay)
+      : kLocalMinDelay(local_min_delay),
+        kLocalMaxDelay(local_max_delay),
+        kRemoteMinDelay(remote_min_delay),
+        kRemoteMaxDelay(remote_max_delay) {}
+
+  auto lock() -> void { try_lock_until(LockClock::time_point::max()); }
+
+  auto unlock() -> void {
+    state_.store(kFree, std::memory_order_release);
+  }
+
+  auto try_lock() -> bool {
+    int64_t holder = kFree;
+    return state_.load(std::memory_order_relaxed) == kFree &&
+           state_.compare_exchange_strong(
+               holder, static_cast<int64_t>(Topology::this_thread_node()),
+               std::memory_order_acquire, std::memory_order_relaxed);
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    auto node = static_cast<int64_t>(Topology::this_thread_node());
+    Backoff<Duration> local_backoff{kLocalMinDelay, kLocalMaxDelay};
+    Backoff<Duration> remote_backoff{kRemoteMinDelay, kRemoteMaxDelay};
+    while (true) {
+      int64_t holder = state_.load(std::memory_order_relaxed);
+      if (holder == kFree &&
+          state_.compare_exchange_strong(holder, node,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+        return true;
+      }
+      if (deadline != LockClock::time_point::max() &&
+          LockClock::now() >= deadline) {
+        return false;
+      }
+      if (holder == node) {
+        local_backoff.backoff();
+      } else {
+        remote_backoff.backoff();
+      }
+    }
+  }
+
+ private:
+  std::atomic<int64_t> state_{kFree};
+  // Default delays: 1-16 units on the holder's node, 16-512 units elsewhere
+  const int64_t kLocalMinDelay{1};
+  const int64_t kLocalMaxDelay{16};
+  const int64_t kRemoteMinDelay{16};
+  const int64_t kRemoteMaxDelay{512};
+};
+
+#endif  // HBO_LOCK_H_
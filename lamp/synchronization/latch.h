@@ -0,0 +1,51 @@
+#ifndef LATCH_H_
+#define LATCH_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include "synchronization/wait_policy.h"
+
+/**
+ * Latch - A single-use countdown: threads wait until the counter reaches zero
+ *
+ * Unlike the barriers in barrier.h, a latch cannot be reused, and the
+ * threads that count down need not be the ones that wait. Waiters wait
+ * according to `WaitPolicy`, by default spinning briefly and then parking,
+ * and are notified by the count_down() that reaches zero.
+ */
+template<typename WaitPolicy = SpinThenPark<>>
+class Latch {
+ public:
+  explicit Latch(size_t count) : count_(count) {}
+
+  Latch(const Latch&) = delete;
+  auto operator=(const Latch&) -> Latch& = delete;
+
+  auto count_down(size_t n = 1) -> void {
+    if (count_.fetch_sub(n, std::memory_order_acq_rel) == n) {
+      WaitPolicy::notify_all(count_);
+    }
+  }
+
+  /**
+   * Returns whether the counter has reached zero, without waiting
+   */
+  auto try_wait() const -> bool {
+    return count_.load(std::memory_order_acquire) == 0;
+  }
+
+  auto wait() const -> void {
+    WaitPolicy::wait_until(count_, [](size_t count) { return count == 0; });
+  }
+
+  auto arrive_and_wait(size_t n = 1) -> void {
+    count_down(n);
+    wait();
+  }
+
+ private:
+  std::atomic<size_t> count_;
+};
+
+#endif  // LATCH_H_
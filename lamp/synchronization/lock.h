@@ -3,11 +3,138 @@
 
 #include <stddef.h>
 
-class Lock {
+#include <chrono>
+#include <concepts>
+#include <utility>
+
+// The clock of the timed lock operations
+using LockClock = std::chrono::steady_clock;
+
+/**
+ * BasicLockable - A type with lock() and unlock()
+ */
+template<typename L>
+concept BasicLockable = requires(L& lock) {
+  lock.lock();
+  lock.unlock();
+};
+
+/**
+ * Lockable - A BasicLockable type that can also be acquired without waiting
+ */
+template<typename L>
+concept Lockable = BasicLockable<L> && requires(L& lock) {
+  { lock.try_lock() } -> std::convertible_to<bool>;
+};
+
+/**
+ * TimedLockable - A Lockable type that can also be waited for with a timeout
+ */
+template<typename L>
+concept TimedLockable =
+    Lockable<L> && requires(L& lock, LockClock::time_point deadline,
+                            std::chrono::microseconds timeout) {
+      { lock.try_lock_until(deadline) } -> std::convertible_to<bool>;
+      { lock.try_lock_for(timeout) } -> std::convertible_to<bool>;
+    };
+
+/**
+ * SharedLockable - A BasicLockable type that can also be held in shared mode,
+ * by any number of threads at once but never together with the exclusive
+ * mode, as std::shared_mutex
+ */
+template<typename L>
+concept SharedLockable = BasicLockable<L> && requires(L& lock) {
+  lock.lock_shared();
+  lock.unlock_shared();
+};
+
+/**
+ * NodeLockable - A queue lock whose caller may supply the node under which it
+ * queues up and holds the lock
+ *
+ * The node lives from lock(node) to unlock(node), typically on the caller's
+ * stack, so a thread can hold any number of such locks at once without a
+ * lookup. Nodes are not interchangeable between the two APIs: a lock taken
+ * with lock(node) must be released with unlock(node).
+ */
+template<typename L>
+concept NodeLockable =
+    BasicLockable<L> && requires(L& lock, typename L::Node& node) {
+      lock.lock(node);
+      lock.unlock(node);
+    };
+
+/**
+ * LockBase - The base of the locks, which derives try_lock_for() from the
+ * lock's own try_lock_until()
+ *
+ * The locks are plain classes without virtual functions, so that code that
+ * knows the lock type inlines the fast path of lock() and unlock(). Code that
+ * must choose a lock at run time can use Lock and LockAdapter instead.
+ */
+template<typename Derived>
+class LockBase {
  public:
-  ~Lock() = default;  // Ensure proper cleanup for derived classes
+  /**
+   * Waits for the lock for at most `timeout`
+   *
+   * @return whether the lock was acquired
+   */
+  template<typename Rep, typename Period>
+  auto try_lock_for(const std::chrono::duration<Rep, Period>& timeout)
+      -> bool {
+    return static_cast<Derived&>(*this).try_lock_until(
+        LockClock::now() + std::chrono::ceil<LockClock::duration>(timeout));
+  }
+};
+
+/**
+ * Lock - A type-erased lock, for code that picks its lock at run time
+ */
+class Lock : public LockBase<Lock> {
+ public:
+  virtual ~Lock() = default;
   virtual auto lock() -> void = 0;
   virtual auto unlock() -> void = 0;
+
+  /**
+   * Acquires the lock if it is free, without waiting
+   *
+   * @return whether the lock was acquired
+   */
+  virtual auto try_lock() -> bool = 0;
+
+  /**
+   * Waits for the lock until `deadline`. A thread that gives up leaves
+   * nothing behind that later threads have to wait for.
+   *
+   * @return whether the lock was acquired
+   */
+  virtual auto try_lock_until(LockClock::time_point deadline) -> bool = 0;
+};
+
+/**
+ * LockAdapter - Makes any of the locks a Lock
+ */
+template<TimedLockable L>
+class LockAdapter : public Lock {
+ public:
+  template<typename... Args>
+  explicit LockAdapter(Args&&... args) : lock_(std::forward<Args>(args)...) {}
+
+  auto lock() -> void override { lock_.lock(); }
+
+  auto unlock() -> void override { lock_.unlock(); }
+
+  auto try_lock() -> bool override { return lock_.try_lock(); }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool override {
+    return lock_.try_lock_until(deadline);
+  }
+
+ private:
+  L lock_;
 };
 
 #endif  // LOCK_H_
@@ -0,0 +1,125 @@
+#ifndef LOCK_FREE_SEMAPHORE_H_
+#define LOCK_FREE_SEMAPHORE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "synchronization/event_count.h"
+#include "synchronization/lock.h"
+#include "synchronization/wait_policy.h"
+
+/**
+ * LockFreeSemaphore - A counting semaphore whose permits are an atomic count
+ *
+ * try_acquire(n) is a CAS on the count and release(n) an atomic add, so
+ * neither takes a lock. A thread that finds too few permits parks on an
+ * EventCount, which release(n) notifies only if a thread waits, and then
+ * wakes at most n threads rather than all of them, so a pool with many
+ * waiters has no thundering herd. A woken thread that loses the permit to a
+ * thread that has not waited parks again; the permit it lost is woken for on
+ * the next release.
+ *
+ * A waiter for several permits could be woken by a release too small for it
+ * while a waiter for one permit sleeps on, so while any thread waits for
+ * several permits, releases wake every waiter. Timed waits poll, since the
+ * EventCount cannot time out.
+ */
+class LockFreeSemaphore {
+ public:
+  explicit LockFreeSemaphore(int value) : value_(value) {}
+
+  LockFreeSemaphore(const LockFreeSemaphore&) = delete;
+  auto operator=(const LockFreeSemaphore&) -> LockFreeSemaphore& = delete;
+
+  auto acquire(int count = 1) -> void {
+    if (count <= 0 || try_acquire(count)) {
+      return;
+    }
+    if (count > 1) {
+      // Ordered before the releases that do not see this thread wait, as is
+      // the announcement in prepare_wait()
+      batch_waiters_.fetch_add(1, std::memory_order_seq_cst);
+    }
+    while (true) {
+      uint32_t key = event_count_.prepare_wait();
+      // Re-checks after announcing itself, so no release is missed
+      if (try_acquire(count)) {
+        event_count_.cancel_wait();
+        break;
+      }
+      event_count_.wait(key);
+      if (try_acquire(count)) {
+        break;
+      }
+    }
+    if (count > 1) {
+      batch_waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Takes `count` permits if that many are available, without waiting
+   */
+  auto try_acquire(int count = 1) -> bool {
+    if (count <= 0) {
+      return true;
+    }
+    int value = value_.load(std::memory_order_relaxed);
+    while (value >= count) {
+      if (value_.compare_exchange_weak(value, value - count,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template<typename Rep, typename Period>
+  auto try_acquire_for(const std::chrono::duration<Rep, Period>& timeout)
+      -> bool {
+    return try_acquire_until(
+        LockClock::now() + std::chrono::ceil<LockClock::duration>(timeout));
+  }
+
+  auto try_acquire_until(LockClock::time_point deadline) -> bool {
+    return try_acquire_until(1, deadline);
+  }
+
+  auto try_acquire_until(int count, LockClock::time_point deadline) -> bool {
+    while (!try_acquire(count)) {
+      if (!wait_until_deadline(
+              value_, [count](int value) { return value >= count; },
+              deadline)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  auto release(int count = 1) -> void {
+    if (count <= 0) {
+      return;
+    }
+    value_.fetch_add(count, std::memory_order_seq_cst);
+    if (batch_waiters_.load(std::memory_order_seq_cst) > 0) {
+      event_count_.notify_all();
+    } else {
+      event_count_.notify(static_cast<uint32_t>(count));
+    }
+  }
+
+  // Get current value (for testing and debugging)
+  auto get_value() const -> int {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<int> value_;
+  // The threads that wait for more than one permit
+  std::atomic<uint32_t> batch_waiters_{0};
+  EventCount event_count_;
+};
+
+#endif  // LOCK_FREE_SEMAPHORE_H_
@@ -0,0 +1,83 @@
+#ifndef LOCK_NODE_TABLE_H_
+#define LOCK_NODE_TABLE_H_
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/**
+ * LockNodeTable - The nodes under which the calling thread holds queue locks
+ * that it acquired with plain lock() rather than with a node of its own,
+ * keyed by lock
+ *
+ * Each lock instance gets its own entry, so a thread may hold several locks of
+ * the same type at once, e.g. hand over hand. A thread rarely holds more than
+ * a few locks, so the table is a short per-thread array that is searched from
+ * the most recently acquired lock and does not allocate once it has grown.
+ */
+template<typename Node>
+class LockNodeTable {
+ public:
+  static auto insert(const void* lock, Node node) -> void {
+    entries().push_back({lock, node});
+  }
+
+  /**
+   * Returns the node under which the calling thread holds `lock`, which it
+   * must hold
+   */
+  static auto find(const void* lock) -> Node& {
+    return entries()[index_of(lock)].node_;
+  }
+
+  /**
+   * Returns the node under which the calling thread holds `lock`, or null if
+   * it has no entry for `lock`
+   */
+  static auto try_find(const void* lock) -> Node* {
+    std::vector<Entry>& table = entries();
+    for (size_t i = table.size(); i > 0; i--) {
+      if (table[i - 1].lock_ == lock) {
+        return &table[i - 1].node_;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * Removes and returns the node under which the calling thread holds `lock`
+   */
+  static auto erase(const void* lock) -> Node {
+    std::vector<Entry>& table = entries();
+    size_t i = index_of(lock);
+    Node node = table[i].node_;
+    // Locks are usually released in the reverse order of acquisition, so this
+    // is usually the last entry already
+    table[i] = table.back();
+    table.pop_back();
+    return node;
+  }
+
+ private:
+  struct Entry {
+    const void* lock_;
+    Node node_;
+  };
+
+  static auto index_of(const void* lock) -> size_t {
+    const std::vector<Entry>& table = entries();
+    size_t i = table.size();
+    do {
+      assert(i > 0 && "the calling thread does not hold the lock");
+      i--;
+    } while (table[i].lock_ != lock);
+    return i;
+  }
+
+  static auto entries() -> std::vector<Entry>& {
+    thread_local std::vector<Entry> table;
+    return table;
+  }
+};
+
+#endif  // LOCK_NODE_TABLE_H_
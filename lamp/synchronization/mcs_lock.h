@@ -2,58 +2,204 @@
 #define MCS_LOCK_H_
 
 #include <atomic>
-#include <chrono>
+#include <cstdint>
+#include <vector>
 
 #include "synchronization/lock.h"
-#include "util/backoff.h"
+#include "synchronization/lock_node_table.h"
+#include "synchronization/wait_policy.h"
+#include "util/cache_aligned.h"
+#include "util/cpu.h"
+#include "util/stats.h"
 
-class MCSLock : public Lock {
+/**
+ * @brief A queue lock in which each waiter spins on a flag in its own node,
+ * which its predecessor clears on release. `WaitPolicy` decides how the waiter
+ * spins.
+ *
+ * The caller may supply the node, e.g. on its stack with ScopedLock:
+ * lock(node) and unlock(node) then need no per-thread state, and a thread can
+ * hold any number of MCS locks at once. Plain lock() and unlock() take a node
+ * from a per-thread pool and remember it in a LockNodeTable entry for this
+ * lock, which works for several locks at once as well.
+ *
+ * A thread whose try_lock_for() times out marks its node as aborted and
+ * leaves it in the queue; the releasing thread skips aborted nodes, hands the
+ * lock to the first waiter behind them and frees them. Since a node supplied
+ * by the caller must not outlive its scope, only the plain API has timed
+ * acquisition.
+ */
+template<typename WaitPolicy = DefaultWaitPolicy>
+class MCSLock : public LockBase<MCSLock<WaitPolicy>> {
  public:
+  enum class State : uint8_t {
+    kGranted,  // The node's thread holds the lock, or has not queued up
+    kWaiting,  // The node's thread waits for the lock
+    kAborted,  // The node's thread has given up waiting
+  };
+
   struct QNode {
-    std::atomic<bool> locked_{false};
+    std::atomic<State> state_{State::kGranted};
     std::atomic<QNode*> next_{nullptr};
   };
 
-  auto lock() -> void override {
-    QNode* qnode = &my_node_;
-    QNode* pred = tail_.exchange(qnode, std::memory_order_acq_rel);
+  using Node = QNode;
+
+  auto lock(QNode& qnode) -> void {
+    QNode* pred = enqueue(&qnode);
+    LAMP_STAT_INC(Stat::kAcquisitions);
     if (pred != nullptr) {
-      qnode->locked_.store(true, std::memory_order_relaxed);
-      // Use `memory_order_release` to ensure that when the next thread sees a
-      // fully initialized `qnode`.
-      pred->next_.store(qnode, std::memory_order_release);
+      LAMP_STAT_INC(Stat::kContendedAcquisitions);
       // wait until predecessor gives up the lock
-      Backoff<std::chrono::microseconds> backoff{5, 25};
-      while (qnode->locked_.load(std::memory_order_acquire)) {
-        backoff.backoff();
-      }
+      WaitPolicy::wait_until(
+          qnode.state_, [](State state) { return state != State::kWaiting; });
     }
   }
 
-  auto unlock() -> void override {
-    QNode* qnode = &my_node_;
-    QNode* succ = qnode->next_.load();
-    if (succ == nullptr) {
-      QNode* expected = qnode;
-      // need to have a separate variable `expected` so that failed
-      // `compare_exchange_strong` does not modify the `qnode` variable.
-      if (tail_.compare_exchange_strong(expected, nullptr,
-                                        std::memory_order_acq_rel,
-                                        std::memory_order_relaxed)) {
-        return;
+  auto unlock(QNode& qnode) -> void {
+    // Hand the lock to the first successor that still waits, freeing the
+    // nodes of those that gave up on the way
+    QNode* node = &qnode;
+    while (true) {
+      QNode* succ = node->next_.load(std::memory_order_acquire);
+      if (succ == nullptr) {
+        QNode* expected = node;
+        // need to have a separate variable `expected` so that failed
+        // `compare_exchange_strong` does not modify the `node` variable.
+        if (!tail_->compare_exchange_strong(expected, nullptr,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed)) {
+          // wait until successor fills in its next field
+          while (succ == nullptr) {
+            cpu_relax();
+            succ = node->next_.load(std::memory_order_acquire);
+          }
+        }
+      }
+      if (node != &qnode) {
+        delete node;
+      }
+      if (succ == nullptr) {
+        break;
       }
-      // wait until successor fills in its next field
-      while (succ == nullptr) {
-        succ = qnode->next_.load(std::memory_order_acquire);
+      State expected = State::kWaiting;
+      if (succ->state_.compare_exchange_strong(expected, State::kGranted,
+                                               std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+        WaitPolicy::notify_one(succ->state_);
+        break;
+      }
+      // The successor has given up, so we now own its node
+      node = succ;
+    }
+    qnode.next_.store(nullptr, std::memory_order_relaxed);
+  }
+
+  auto try_lock(QNode& qnode) -> bool {
+    QNode* expected = nullptr;
+    return tail_->compare_exchange_strong(expected, &qnode,
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns whether other threads have queued up behind `qnode`, under which
+   * the calling thread holds the lock. Threads that gave up count until the
+   * lock is released.
+   */
+  auto has_waiters(const QNode& qnode) const -> bool {
+    return tail_->load(std::memory_order_acquire) != &qnode;
+  }
+
+  auto lock() -> void {
+    QNode* qnode = node_pool_.get();
+    lock(*qnode);
+    Nodes::insert(this, qnode);
+  }
+
+  auto unlock() -> void {
+    QNode* qnode = Nodes::erase(this);
+    unlock(*qnode);
+    node_pool_.put(qnode);
+  }
+
+  auto try_lock() -> bool {
+    QNode* qnode = node_pool_.get();
+    if (!try_lock(*qnode)) {
+      node_pool_.put(qnode);
+      return false;
+    }
+    Nodes::insert(this, qnode);
+    return true;
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    QNode* qnode = node_pool_.get();
+    QNode* pred = enqueue(qnode);
+    if (pred != nullptr &&
+        !wait_until_deadline(
+            qnode->state_,
+            [](State state) { return state != State::kWaiting; }, deadline)) {
+      State expected = State::kWaiting;
+      if (qnode->state_.compare_exchange_strong(expected, State::kAborted,
+                                                std::memory_order_acquire,
+                                                std::memory_order_acquire)) {
+        // Our node stays in the queue until a releasing thread frees it
+        return false;
       }
+      // The lock was handed to us in the meantime
     }
-    succ->locked_.store(false, std::memory_order_release);
-    qnode->next_.store(nullptr, std::memory_order_relaxed);
+    Nodes::insert(this, qnode);
+    return true;
   }
 
+  /**
+   * Returns whether other threads have queued up behind the calling thread,
+   * which must hold the lock through lock() or try_lock().
+   */
+  auto has_waiters() const -> bool { return has_waiters(*Nodes::find(this)); }
+
  private:
-  std::atomic<QNode*> tail_{nullptr};
-  static thread_local QNode my_node_;
+  using Nodes = LockNodeTable<QNode*>;
+
+  // Appends `qnode` to the queue and returns its predecessor
+  auto enqueue(QNode* qnode) -> QNode* {
+    QNode* pred = tail_->exchange(qnode, std::memory_order_acq_rel);
+    if (pred != nullptr) {
+      qnode->state_.store(State::kWaiting, std::memory_order_relaxed);
+      // Use `memory_order_release` to ensure that when the next thread sees a
+      // fully initialized `qnode`.
+      pred->next_.store(qnode, std::memory_order_release);
+    }
+    return pred;
+  }
+
+  // The spare nodes of a thread for the plain API, freed when the thread
+  // exits. A thread needs one node per MCS lock it holds at once.
+  struct NodePool {
+    std::vector<QNode*> nodes_;
+
+    ~NodePool() {
+      for (QNode* qnode : nodes_) {
+        delete qnode;
+      }
+    }
+
+    auto get() -> QNode* {
+      if (nodes_.empty()) {
+        return new QNode();
+      }
+      QNode* qnode = nodes_.back();
+      nodes_.pop_back();
+      qnode->state_.store(State::kGranted, std::memory_order_relaxed);
+      return qnode;
+    }
+
+    auto put(QNode* qnode) -> void { nodes_.push_back(qnode); }
+  };
+
+  CacheAligned<std::atomic<QNode*>> tail_{nullptr};
+  static inline thread_local NodePool node_pool_;
 };
 
-#endif  // MCS_LOCK_H_
\ No newline at end of file
+#endif  // MCS_LOCK_H_
@@ -0,0 +1,246 @@
+#ifndef MCS_READ_WRITE_LOCK_H_
+#define MCS_READ_WRITE_LOCK_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "synchronization/lock_node_table.h"
+#include "synchronization/wait_policy.h"
+#include "util/cache_aligned.h"
+#include "util/cpu.h"
+
+/**
+ * MCSReadWriteLock - The fair queue-based read-write lock of Mellor-Crummey
+ * and Scott [Mel91b]
+ *
+ * Readers and writers line up in one MCS queue and each waits on a flag in its
+ * own node, so a release invalidates the line of one waiter only. Threads are
+ * admitted in FIFO order, except that a reader that reaches the head of the
+ * queue admits the readers queued right behind it, one after the other, so
+ * consecutive readers hold the lock together. Neither side can starve.
+ *
+ * Active readers are counted in `reader_count_`. A writer behind a group of
+ * readers waits until the last of them leaves, which hands it the lock through
+ * `next_writer_`.
+ *
+ * As in MCSLock, the caller may supply the node, e.g. on its stack, or use the
+ * plain API, which takes one from a per-thread pool and remembers it per lock
+ * in a LockNodeTable. A waiter cannot leave the queue, so there is no timed
+ * acquisition.
+ */
+template<typename WaitPolicy = DefaultWaitPolicy>
+class MCSReadWriteLock {
+  // Bits of QNode::state_. The successor bits tell a reader that reaches the
+  // head of the queue what kind of thread waits behind it.
+  static constexpr uint32_t kBlocked = 1;
+  static constexpr uint32_t kSuccessorReader = 2;
+  static constexpr uint32_t kSuccessorWriter = 4;
+
+ public:
+  enum class Role : uint8_t { kReader, kWriter };
+
+  struct alignas(kCacheLineSize) QNode {
+    Role role_{Role::kReader};
+    std::atomic<uint32_t> state_{0};
+    std::atomic<QNode*> next_{nullptr};
+  };
+
+  using Node = QNode;
+
+  MCSReadWriteLock() = default;
+
+  MCSReadWriteLock(const MCSReadWriteLock&) = delete;
+  auto operator=(const MCSReadWriteLock&) -> MCSReadWriteLock& = delete;
+
+  auto read_lock(QNode& qnode) -> void {
+    QNode* pred = enqueue(&qnode, Role::kReader);
+    if (pred == nullptr) {
+      reader_count_->fetch_add(1, std::memory_order_seq_cst);
+      unblock(&qnode);
+    } else {
+      uint32_t expected = kBlocked;
+      if (pred->role_ == Role::kWriter ||
+          pred->state_.compare_exchange_strong(
+              expected, kBlocked | kSuccessorReader, std::memory_order_acq_rel,
+              std::memory_order_relaxed)) {
+        // The predecessor has yet to get the lock, and will admit this thread
+        // once it has
+        pred->next_.store(&qnode, std::memory_order_release);
+        wait_unblocked(qnode);
+      } else {
+        // The predecessor is an active reader. Counting this thread before
+        // linking in keeps the count above 0 until the predecessor leaves.
+        reader_count_->fetch_add(1, std::memory_order_seq_cst);
+        pred->next_.store(&qnode, std::memory_order_release);
+        unblock(&qnode);
+      }
+    }
+
+    // Admit the reader queued behind, which in turn admits its own
+    if ((qnode.state_.load(std::memory_order_acquire) & kSuccessorReader) !=
+        0) {
+      QNode* succ = wait_for_successor(qnode);
+      reader_count_->fetch_add(1, std::memory_order_seq_cst);
+      unblock(succ);
+    }
+  }
+
+  auto read_unlock(QNode& qnode) -> void {
+    if (!leave_queue(qnode) &&
+        (qnode.state_.load(std::memory_order_relaxed) & kSuccessorWriter) !=
+            0) {
+      // The writer behind waits for the last active reader, which may not be
+      // this one
+      next_writer_->store(qnode.next_.load(std::memory_order_relaxed),
+                          std::memory_order_seq_cst);
+    }
+    if (reader_count_->fetch_sub(1, std::memory_order_seq_cst) == 1) {
+      QNode* writer = next_writer_->load(std::memory_order_seq_cst);
+      if (writer != nullptr &&
+          reader_count_->load(std::memory_order_seq_cst) == 0 &&
+          next_writer_->compare_exchange_strong(writer, nullptr,
+                                                std::memory_order_seq_cst)) {
+        unblock(writer);
+      }
+    }
+  }
+
+  auto write_lock(QNode& qnode) -> void {
+    QNode* pred = enqueue(&qnode, Role::kWriter);
+    if (pred == nullptr) {
+      // The queue was empty, but readers that have left it may still be
+      // active. Whichever of them leaves last hands over the lock, unless
+      // there are none.
+      next_writer_->store(&qnode, std::memory_order_seq_cst);
+      QNode* expected = &qnode;
+      if (reader_count_->load(std::memory_order_seq_cst) == 0 &&
+          next_writer_->compare_exchange_strong(expected, nullptr,
+                                                std::memory_order_seq_cst)) {
+        return;
+      }
+    } else {
+      pred->state_.fetch_or(kSuccessorWriter, std::memory_order_relaxed);
+      pred->next_.store(&qnode, std::memory_order_release);
+    }
+    wait_unblocked(qnode);
+  }
+
+  auto write_unlock(QNode& qnode) -> void {
+    if (leave_queue(qnode)) {
+      return;
+    }
+    QNode* succ = qnode.next_.load(std::memory_order_relaxed);
+    if (succ->role_ == Role::kReader) {
+      reader_count_->fetch_add(1, std::memory_order_seq_cst);
+    }
+    unblock(succ);
+  }
+
+  auto read_lock() -> void {
+    QNode* qnode = node_pool_.get();
+    read_lock(*qnode);
+    Nodes::insert(this, qnode);
+  }
+
+  auto read_unlock() -> void {
+    QNode* qnode = Nodes::erase(this);
+    read_unlock(*qnode);
+    node_pool_.put(qnode);
+  }
+
+  auto write_lock() -> void {
+    QNode* qnode = node_pool_.get();
+    write_lock(*qnode);
+    Nodes::insert(this, qnode);
+  }
+
+  auto write_unlock() -> void {
+    QNode* qnode = Nodes::erase(this);
+    write_unlock(*qnode);
+    node_pool_.put(qnode);
+  }
+
+ private:
+  using Nodes = LockNodeTable<QNode*>;
+
+  // Appends `qnode` to the queue, blocked, and returns its predecessor
+  auto enqueue(QNode* qnode, Role role) -> QNode* {
+    qnode->role_ = role;
+    qnode->next_.store(nullptr, std::memory_order_relaxed);
+    qnode->state_.store(kBlocked, std::memory_order_relaxed);
+    // Release publishes the node's reset to the successor that finds it
+    // through the tail
+    return tail_->exchange(qnode, std::memory_order_acq_rel);
+  }
+
+  /**
+   * Removes `qnode` from the queue if it is the tail
+   *
+   * @return whether it was; if not, waits until its successor has linked in
+   */
+  auto leave_queue(QNode& qnode) -> bool {
+    if (qnode.next_.load(std::memory_order_acquire) == nullptr) {
+      QNode* expected = &qnode;
+      if (tail_->compare_exchange_strong(expected, nullptr,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    wait_for_successor(qnode);
+    return false;
+  }
+
+  auto wait_for_successor(QNode& qnode) -> QNode* {
+    QNode* succ = qnode.next_.load(std::memory_order_acquire);
+    while (succ == nullptr) {
+      cpu_relax();
+      succ = qnode.next_.load(std::memory_order_acquire);
+    }
+    return succ;
+  }
+
+  // Lets the thread of `qnode` in. An atomic AND, since a reader queued behind
+  // may set a successor bit at the same time.
+  static auto unblock(QNode* qnode) -> void {
+    qnode->state_.fetch_and(~kBlocked, std::memory_order_release);
+    WaitPolicy::notify_one(qnode->state_);
+  }
+
+  static auto wait_unblocked(QNode& qnode) -> void {
+    WaitPolicy::wait_until(
+        qnode.state_, [](uint32_t state) { return (state & kBlocked) == 0; });
+  }
+
+  // The spare nodes of a thread for the plain API, freed when the thread
+  // exits. A thread needs one node per MCS read-write lock it holds at once.
+  struct NodePool {
+    std::vector<QNode*> nodes_;
+
+    ~NodePool() {
+      for (QNode* qnode : nodes_) {
+        delete qnode;
+      }
+    }
+
+    auto get() -> QNode* {
+      if (nodes_.empty()) {
+        return new QNode();
+      }
+      QNode* qnode = nodes_.back();
+      nodes_.pop_back();
+      return qnode;
+    }
+
+    auto put(QNode* qnode) -> void { nodes_.push_back(qnode); }
+  };
+
+  CacheAligned<std::atomic<QNode*>> tail_{nullptr};
+  CacheAligned<std::atomic<uint64_t>> reader_count_{0};
+  // The writer that waits for the active readers to leave, if any
+  CacheAligned<std::atomic<QNode*>> next_writer_{nullptr};
+  static inline thread_local NodePool node_pool_;
+};
+
+#endif  // MCS_READ_WRITE_LOCK_H_
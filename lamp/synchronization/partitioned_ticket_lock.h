@@ -0,0 +1,115 @@
+#ifndef PARTITIONED_TICKET_LOCK_H_
+#define PARTITIONED_TICKET_LOCK_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "synchronization/lock.h"
+#include "synchronization/wait_policy.h"
+#include "util/cache_aligned.h"
+#include "util/stats.h"
+
+/**
+ * @brief A ticket lock whose grants are spread over `NumSlots` cache lines,
+ * after Dice's partitioned ticket lock. A thread with ticket `t` waits on slot
+ * `t % NumSlots` until it holds `t`, and the holder of ticket `t` grants the
+ * next one by storing `t + 1` into its slot.
+ *
+ * In TicketLock every waiter spins on one `now_serving` word, so a release
+ * invalidates the line in every waiting core. Here a release touches only the
+ * slot of the next ticket, which at most one in `NumSlots` waiters reads, so
+ * the lock keeps FIFO order and scales like a queue lock as long as fewer than
+ * `NumSlots` threads wait at once. It costs `NumSlots` cache lines, but no
+ * per-thread nodes.
+ *
+ * As in TicketLock, try_lock() and try_lock_for() take a ticket only when it
+ * would be granted at once.
+ */
+template<size_t NumSlots = 16, typename WaitPolicy = DefaultWaitPolicy>
+class PartitionedTicketLock
+    : public LockBase<PartitionedTicketLock<NumSlots, WaitPolicy>> {
+  static_assert(NumSlots > 0);
+
+ public:
+  PartitionedTicketLock() = default;
+
+  PartitionedTicketLock(const PartitionedTicketLock&) = delete;
+  auto operator=(const PartitionedTicketLock&)
+      -> PartitionedTicketLock& = delete;
+
+  auto lock() -> void {
+    uint64_t my_ticket = next_ticket_->fetch_add(1, std::memory_order_relaxed);
+    LAMP_STAT_INC(Stat::kAcquisitions);
+    std::atomic<uint64_t>& grant = *grants_[my_ticket % NumSlots];
+    LAMP_STAT_ADD(Stat::kContendedAcquisitions,
+                  grant.load(std::memory_order_relaxed) != my_ticket);
+    WaitPolicy::wait_until(
+        grant, [my_ticket](uint64_t granted) { return granted == my_ticket; });
+    owner_ticket_ = my_ticket;
+  }
+
+  auto unlock() -> void {
+    uint64_t next = owner_ticket_ + 1;
+    std::atomic<uint64_t>& grant = *grants_[next % NumSlots];
+    grant.store(next, std::memory_order_release);
+    // Tickets `NumSlots` apart share a slot, so the next one may not be its
+    // only waiter
+    WaitPolicy::notify_all(grant);
+  }
+
+  auto try_lock() -> bool {
+    uint64_t ticket = next_ticket_->load(std::memory_order_relaxed);
+    // The next ticket is granted only while no thread holds or waits for the
+    // lock
+    if (grants_[ticket % NumSlots]->load(std::memory_order_acquire) != ticket ||
+        !next_ticket_->compare_exchange_strong(ticket, ticket + 1,
+                                               std::memory_order_relaxed)) {
+      return false;
+    }
+    owner_ticket_ = ticket;
+    return true;
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    while (!try_lock()) {
+      // Wait until the next ticket is granted or taken
+      uint64_t ticket = next_ticket_->load(std::memory_order_relaxed);
+      if (!wait_until_deadline(
+              *grants_[ticket % NumSlots],
+              [this, ticket](uint64_t granted) {
+                return granted == ticket ||
+                       next_ticket_->load(std::memory_order_relaxed) != ticket;
+              },
+              deadline)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Returns whether other threads have taken a ticket after the calling
+   * thread, which must hold the lock
+   */
+  auto has_waiters() const -> bool {
+    return next_ticket_->load(std::memory_order_relaxed) - owner_ticket_ > 1;
+  }
+
+  // Whether some thread holds or waits for the lock
+  auto is_locked() const -> bool {
+    uint64_t ticket = next_ticket_->load(std::memory_order_relaxed);
+    return grants_[ticket % NumSlots]->load(std::memory_order_relaxed) !=
+           ticket;
+  }
+
+ private:
+  CacheAligned<std::atomic<uint64_t>> next_ticket_{0};
+  // Slot `i` holds the last ticket granted among those equal to `i` modulo
+  // `NumSlots`; all start at 0, which grants ticket 0 and no other
+  std::array<CacheAligned<std::atomic<uint64_t>>, NumSlots> grants_{};
+  uint64_t owner_ticket_{0};  // Written and read only by the holder
+};
+
+#endif  // PARTITIONED_TICKET_LOCK_H_
@@ -4,13 +4,17 @@
 #include <array>
 #include <atomic>
 
+#include "util/cpu.h"
+
 class PetersonLock {
  public:
   auto lock(uint32_t id) -> void {
     uint32_t j = 1 - id;
     flag_[id] = true;                    // I'm interested.
     victim_ = id;                        // you go first.
-    while (flag_[j] && victim_ == id) {}  // wait
+    while (flag_[j] && victim_ == id) {  // wait
+      cpu_relax();
+    }
   }
 
   auto unlock(uint32_t id) -> void {
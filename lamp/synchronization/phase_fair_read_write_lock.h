@@ -0,0 +1,108 @@
+#ifndef PHASE_FAIR_READ_WRITE_LOCK_H_
+#define PHASE_FAIR_READ_WRITE_LOCK_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "synchronization/wait_policy.h"
+#include "util/cache_aligned.h"
+
+/**
+ * PhaseFairReadWriteLock - The phase-fair ticket read-write lock (PF-T) of
+ * Brandenburg and Anderson [Bra10]
+ *
+ * Read and write phases alternate: a writer waits for at most one read phase,
+ * and a reader for at most one write phase, so neither side can starve the
+ * other. Writers are served in FIFO order by a pair of ticket counters.
+ * Readers take and return a ticket on two other counters; the two lowest bits
+ * of the readers' entry counter tell arriving readers whether a writer is
+ * present and which write phase they have to wait out.
+ *
+ * Neither read_lock() nor read_unlock() takes an internal lock, but both do an
+ * atomic increment on a counter shared by all readers. `WaitPolicy` decides
+ * how threads wait for their turn. Readers that must not write to shared
+ * memory can read optimistically instead: see try_optimistic_read().
+ */
+template<typename WaitPolicy = DefaultWaitPolicy>
+class PhaseFairReadWriteLock {
+  // Readers count in units of kReaderIncrement, above the writer bits
+  static constexpr uint64_t kReaderIncrement = 0x100;
+  static constexpr uint64_t kWriterBits = 0x3;
+  static constexpr uint64_t kWriterPresent = 0x2;
+  static constexpr uint64_t kPhaseId = 0x1;
+
+ public:
+  auto read_lock() -> void {
+    uint64_t writer =
+        read_in_->fetch_add(kReaderIncrement, std::memory_order_acquire) &
+        kWriterBits;
+    if (writer != 0) {
+      // Wait out the current write phase only, even if another writer has
+      // arrived in the meantime
+      WaitPolicy::wait_until(*read_in_, [writer](uint64_t read_in) {
+        return (read_in & kWriterBits) != writer;
+      });
+    }
+  }
+
+  auto read_unlock() -> void {
+    read_out_->fetch_add(kReaderIncrement, std::memory_order_release);
+    WaitPolicy::notify_all(*read_out_);
+  }
+
+  auto write_lock() -> void {
+    uint64_t ticket = write_in_->fetch_add(1, std::memory_order_relaxed);
+    // Orders the ticket before the writes of the critical section, for
+    // optimistic readers
+    std::atomic_thread_fence(std::memory_order_release);
+    WaitPolicy::wait_until(*write_out_, [ticket](uint64_t serving) {
+      return serving == ticket;
+    });
+    // Block arriving readers, and wait for those that have already entered
+    uint64_t readers = read_in_->fetch_add(kWriterPresent | (ticket & kPhaseId),
+                                           std::memory_order_acq_rel);
+    WaitPolicy::wait_until(*read_out_, [readers](uint64_t read_out) {
+      return read_out == readers;
+    });
+  }
+
+  auto write_unlock() -> void {
+    read_in_->fetch_and(~kWriterBits, std::memory_order_release);
+    WaitPolicy::notify_all(*read_in_);
+    write_out_->fetch_add(1, std::memory_order_release);
+    WaitPolicy::notify_all(*write_out_);
+  }
+
+  /**
+   * Starts an optimistic read, which writes nothing to shared memory. Data
+   * read before validate() succeeds may be inconsistent, so it should be read
+   * with relaxed atomic loads and used only after validation.
+   *
+   * @return a stamp to pass to validate(), or 0 if a writer holds or waits
+   * for the lock
+   */
+  auto try_optimistic_read() const -> uint64_t {
+    uint64_t tickets = write_in_->load(std::memory_order_acquire);
+    bool has_writer = write_out_->load(std::memory_order_acquire) != tickets;
+    return has_writer ? 0 : tickets + 1;
+  }
+
+  /**
+   * Returns whether no writer has arrived since try_optimistic_read() returned
+   * `stamp`. Any writer that entered the lock in the meantime took a ticket.
+   */
+  auto validate(uint64_t stamp) const -> bool {
+    // Orders the caller's reads before the read of the ticket counter
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return stamp != 0 &&
+           write_in_->load(std::memory_order_relaxed) + 1 == stamp;
+  }
+
+ private:
+  CacheAligned<std::atomic<uint64_t>> read_in_{0};
+  CacheAligned<std::atomic<uint64_t>> read_out_{0};
+  CacheAligned<std::atomic<uint64_t>> write_in_{0};
+  CacheAligned<std::atomic<uint64_t>> write_out_{0};
+};
+
+#endif  // PHASE_FAIR_READ_WRITE_LOCK_H_
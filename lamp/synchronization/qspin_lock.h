@@ -0,0 +1,265 @@
+#ifndef QSPIN_LOCK_H_
+#define QSPIN_LOCK_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "synchronization/lock.h"
+#include "synchronization/wait_policy.h"
+#include "util/cache_aligned.h"
+#include "util/cpu.h"
+#include "util/stats.h"
+
+/**
+ * QSpinNodes - The MCS nodes of QSpinLock, one per live thread, named by a
+ * 16-bit id so that a lock word can hold the id of its queue's tail
+ *
+ * A thread waits in at most one queue at a time, and leaves it as soon as it
+ * has the lock, so one node per thread serves every QSpinLock. Ids are claimed
+ * on a thread's first contended acquisition and handed back when it exits;
+ * nodes are allocated in chunks and never freed.
+ */
+class QSpinNodes {
+ public:
+  struct alignas(kCacheLineSize) Node {
+    std::atomic<Node*> next_{nullptr};
+    std::atomic<bool> head_{false};  // Set when the node reaches the head
+  };
+
+  // Ids run from 1; 0 means no node
+  static constexpr uint32_t kMaxNodes = (1 << 16) - 1;
+
+  static auto node(uint32_t id) -> Node& {
+    uint32_t index = id - 1;
+    Node* chunk = chunks_[index / kChunkSize].load(std::memory_order_acquire);
+    return chunk[index % kChunkSize];
+  }
+
+  /**
+   * The id of the calling thread's node
+   *
+   * @throws std::runtime_error if kMaxNodes threads already hold one
+   */
+  static auto this_thread_id() -> uint32_t {
+    thread_local Claim claim;
+    return claim.id_;
+  }
+
+ private:
+  static constexpr uint32_t kChunkSize = 256;
+
+  // Holds a node id for the lifetime of its thread
+  struct Claim {
+    Claim() : id_(claim_id()) {}
+    ~Claim() { release_id(id_); }
+
+    const uint32_t id_;
+  };
+
+  static auto claim_id() -> uint32_t {
+    uint32_t id;
+    {
+      std::scoped_lock guard(registry_mutex_);
+      if (!free_ids_.empty()) {
+        id = free_ids_.back();
+        free_ids_.pop_back();
+        return id;
+      }
+      if (next_id_ > kMaxNodes) {
+        throw std::runtime_error("QSpinLock: too many threads");
+      }
+      id = next_id_++;
+    }
+    std::atomic<Node*>& chunk = chunks_[(id - 1) / kChunkSize];
+    if (chunk.load(std::memory_order_acquire) == nullptr) {
+      Node* fresh = new Node[kChunkSize];
+      Node* expected = nullptr;
+      if (!chunk.compare_exchange_strong(expected, fresh,
+                                         std::memory_order_acq_rel)) {
+        delete[] fresh;
+      }
+    }
+    return id;
+  }
+
+  static auto release_id(uint32_t id) -> void {
+    std::scoped_lock guard(registry_mutex_);
+    free_ids_.push_back(id);
+  }
+
+  inline static std::array<std::atomic<Node*>,
+                           (kMaxNodes + kChunkSize - 1) / kChunkSize>
+      chunks_{};
+  inline static std::mutex registry_mutex_;
+  inline static std::vector<uint32_t> free_ids_;
+  inline static uint32_t next_id_{1};
+};
+
+/**
+ * @brief A 4-byte lock that is a test-and-set lock while uncontended and
+ * becomes an MCS queue lock under contention, after the Linux kernel's
+ * qspinlock.
+ *
+ * The lock word holds a locked byte, a pending bit and the node id of the
+ * tail of a queue of waiters. An uncontended thread takes the lock with one
+ * CAS from 0, as in TASLock. The first thread to find it held sets the pending
+ * bit and spins on the word; any further thread joins an MCS queue of
+ * per-thread nodes, waits on its own node until it is at the head, and only
+ * then spins on the word. So at most two threads ever read the lock word while
+ * it is held, however many wait. Once the last queued thread takes the lock it
+ * clears the tail, and the word is a plain test-and-set word again.
+ *
+ * The lock fits in the word itself, so it can be embedded in every node of
+ * FineList or LazyList. Its unlock() is an atomic subtraction rather than a
+ * store, since waiters may set bits of the word at the same time.
+ *
+ * A thread that is queued cannot leave the queue, so try_lock_for() never
+ * joins it: it waits like try_lock() retried until the word is 0, and gets
+ * the lock only when no thread holds or waits for it.
+ */
+template<typename WaitPolicy = DefaultWaitPolicy>
+class QSpinLock : public LockBase<QSpinLock<WaitPolicy>> {
+  static constexpr uint32_t kLocked = 1;
+  static constexpr uint32_t kLockedMask = 0xff;
+  static constexpr uint32_t kPending = 1 << 8;
+  static constexpr uint32_t kLockedPendingMask = kLockedMask | kPending;
+  static constexpr uint32_t kTailShift = 16;
+  static constexpr uint32_t kTailMask = ~((1U << kTailShift) - 1);
+
+  using Node = QSpinNodes::Node;
+
+ public:
+  QSpinLock() = default;
+
+  QSpinLock(const QSpinLock&) = delete;
+  auto operator=(const QSpinLock&) -> QSpinLock& = delete;
+
+  auto lock() -> void {
+    LAMP_STAT_INC(Stat::kAcquisitions);
+    uint32_t word = 0;
+    if (word_.compare_exchange_strong(word, kLocked,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+      return;
+    }
+    LAMP_STAT_INC(Stat::kContendedAcquisitions);
+    if (!lock_pending(word)) {
+      lock_queued();
+    }
+  }
+
+  auto unlock() -> void {
+    word_.fetch_sub(kLocked, std::memory_order_release);
+    // The pending thread or the head of the queue may wait on the word
+    WaitPolicy::notify_all(word_);
+  }
+
+  auto try_lock() -> bool {
+    uint32_t word = word_.load(std::memory_order_relaxed);
+    return word == 0 &&
+           word_.compare_exchange_strong(word, kLocked,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed);
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    while (!try_lock()) {
+      if (!wait_until_deadline(
+              word_, [](uint32_t word) { return word == 0; }, deadline)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Whether some thread holds the lock
+  auto is_locked() const -> bool {
+    return (word_.load(std::memory_order_relaxed) & kLockedMask) != 0;
+  }
+
+ private:
+  /**
+   * Takes the lock as the pending thread if the lock is held but no other
+   * thread waits, i.e. `word` is just the locked byte
+   *
+   * @return whether the lock was taken; if not, the caller must queue up
+   */
+  auto lock_pending(uint32_t word) -> bool {
+    if ((word & ~kLockedMask) != 0) {
+      return false;
+    }
+    word = word_.fetch_or(kPending, std::memory_order_acquire);
+    if ((word & ~kLockedMask) != 0) {
+      // Another thread is pending or queued; take back the bit if it was ours.
+      // The head of the queue may have parked while the bit was set, after
+      // the holder's notification, and waits for it to clear.
+      if ((word & kPending) == 0) {
+        word_.fetch_and(~kPending, std::memory_order_relaxed);
+        WaitPolicy::notify_all(word_);
+      }
+      return false;
+    }
+    if ((word & kLockedMask) != 0) {
+      WaitPolicy::wait_until(
+          word_, [](uint32_t word) { return (word & kLockedMask) == 0; });
+    }
+    // Turn the pending bit into the locked byte. Only the pending thread sets
+    // the lock while the pending bit is set, so no CAS is needed.
+    word_.fetch_add(kLocked - kPending, std::memory_order_acquire);
+    return true;
+  }
+
+  auto lock_queued() -> void {
+    uint32_t id = QSpinNodes::this_thread_id();
+    Node& node = QSpinNodes::node(id);
+    node.next_.store(nullptr, std::memory_order_relaxed);
+    node.head_.store(false, std::memory_order_relaxed);
+
+    // Become the tail. Release publishes the node's reset to the successor
+    // that will find it through the tail.
+    uint32_t my_tail = id << kTailShift;
+    uint32_t word = word_.load(std::memory_order_relaxed);
+    while (!word_.compare_exchange_weak(word, (word & ~kTailMask) | my_tail,
+                                        std::memory_order_acq_rel,
+                                        std::memory_order_relaxed)) {}
+
+    if ((word & kTailMask) != 0) {
+      Node& pred = QSpinNodes::node(word >> kTailShift);
+      pred.next_.store(&node, std::memory_order_release);
+      WaitPolicy::wait_until(node.head_, [](bool head) { return head; });
+    }
+
+    // At the head of the queue, wait for the holder and the pending thread
+    word = WaitPolicy::wait_until(word_, [](uint32_t word) {
+      return (word & kLockedPendingMask) == 0;
+    });
+
+    // Threads that arrive now queue up behind this one, so only the tail can
+    // change. If this thread is the tail, the queue empties.
+    while ((word & kTailMask) == my_tail) {
+      if (word_.compare_exchange_weak(word, kLocked, std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+        return;
+      }
+    }
+    word_.fetch_or(kLocked, std::memory_order_acquire);
+
+    // Make the successor the head, once it has linked itself in
+    Node* next = node.next_.load(std::memory_order_acquire);
+    while (next == nullptr) {
+      cpu_relax();
+      next = node.next_.load(std::memory_order_acquire);
+    }
+    next->head_.store(true, std::memory_order_release);
+    WaitPolicy::notify_one(next->head_);
+  }
+
+  std::atomic<uint32_t> word_{0};
+};
+
+#endif  // QSPIN_LOCK_H_
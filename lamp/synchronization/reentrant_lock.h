@@ -1,46 +1,100 @@
 #ifndef REENTRANT_LOCK_H_
 #define REENTRANT_LOCK_H_
 
-#include "synchronization/condition_variable.h"
-#include "synchronization/ttas_lock.h"
-#include "synchronization/scoped_lock.h"
-
+#include <atomic>
+#include <cstdint>
 #include <stdexcept>
-#include <thread>
 
-class ReentrantLock {
+#include "synchronization/lock.h"
+#include "synchronization/wait_policy.h"
+#include "util/thread_index.h"
+
+/**
+ * ReentrantLock - A lock that its owner may acquire again without blocking,
+ * and must then release as many times
+ *
+ * The owner's id is kept in an atomic word, so the owner re-enters with a
+ * single relaxed load and an increment of its private hold count: no other
+ * thread writes its id there. Other threads take the lock with a CAS on that
+ * word and wait for it to become free according to `WaitPolicy`, by default
+ * spinning briefly and then parking with std::atomic::wait.
+ */
+template<typename WaitPolicy = SpinThenPark<>>
+class ReentrantLock : public LockBase<ReentrantLock<WaitPolicy>> {
+  static constexpr uint64_t kFree = 0;
+
  public:
   auto lock() -> void {
-    auto me = std::this_thread::get_id();
-    ScopedLock<TTASLock> lk(mutex_);
-    if (owner_ == me) {
-      hold_count_++;
+    if (reenter()) {
       return;
     }
-    while (hold_count_ != 0) {
-      cv_.wait(mutex_);
+    uint64_t me = this_thread_id();
+    uint64_t owner = kFree;
+    while (!owner_.compare_exchange_weak(owner, me, std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+      owner = WaitPolicy::wait_until(
+          owner_, [](uint64_t value) { return value == kFree; });
     }
-    owner_ = me;
     hold_count_ = 1;
   }
 
   auto unlock() -> void {
-    ScopedLock<TTASLock> lk(mutex_);
-    if (hold_count_ == 0 || owner_ != std::this_thread::get_id()) {
+    if (owner_.load(std::memory_order_relaxed) != this_thread_id()) {
       throw std::runtime_error("The caller does not hold the lock");
     }
     hold_count_--;
     if (hold_count_ == 0) {
-      cv_.notify_all();
+      owner_.store(kFree, std::memory_order_release);
+      WaitPolicy::notify_one(owner_);
+    }
+  }
+
+  auto try_lock() -> bool {
+    if (reenter()) {
+      return true;
+    }
+    uint64_t owner = kFree;
+    if (!owner_.compare_exchange_strong(owner, this_thread_id(),
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+      return false;
+    }
+    hold_count_ = 1;
+    return true;
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    while (!try_lock()) {
+      if (!wait_until_deadline(
+              owner_, [](uint64_t value) { return value == kFree; },
+              deadline)) {
+        return false;
+      }
     }
+    return true;
+  }
+
+  /**
+   * Returns whether the calling thread holds the lock
+   */
+  auto is_held_by_current_thread() const -> bool {
+    return owner_.load(std::memory_order_relaxed) == this_thread_id();
   }
 
  private:
-  std::thread::id owner_{};
-  uint64_t hold_count_{};
+  // Ids start at 1, so that no thread has the id of a free lock
+  static auto this_thread_id() -> uint64_t { return this_thread_index() + 1; }
+
+  auto reenter() -> bool {
+    if (!is_held_by_current_thread()) {
+      return false;
+    }
+    hold_count_++;
+    return true;
+  }
 
-  TTASLock mutex_;
-  ConditionVariable cv_;
+  std::atomic<uint64_t> owner_{kFree};
+  uint64_t hold_count_{0};  // Only read and written by the owner
 };
 
 #endif  // REENTRANT_LOCK_H_
@@ -0,0 +1,253 @@
+#ifndef REENTRANT_READ_WRITE_LOCK_H_
+#define REENTRANT_READ_WRITE_LOCK_H_
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+#include "synchronization/lock_node_table.h"
+#include "synchronization/wait_policy.h"
+#include "util/thread_index.h"
+
+/**
+ * ReentrantReadWriteLock - A read-write lock whose holders may acquire it
+ * again, with an upgradeable read mode
+ *
+ * A thread may hold the lock in three modes, each any number of times:
+ * - read: shared with other readers and with the upgradeable holder.
+ * - upgradeable: a read lock that one thread at a time may hold. Its holder
+ *   upgrades it by taking the write lock, which waits for the other readers
+ *   to leave but cannot deadlock, since no other thread can be upgrading.
+ * - write: exclusive.
+ *
+ * A thread that holds the write or upgradeable lock may also take the read
+ * lock, and one that holds the write lock may take the upgradeable lock.
+ * Releasing a stronger mode while still holding a weaker one downgrades the
+ * lock without letting any writer in between: e.g. write_lock(), read_lock(),
+ * write_unlock() leaves the thread a reader. A thread that holds only the read
+ * lock cannot take the write or upgradeable lock, since two such readers would
+ * wait for each other forever; these calls throw std::logic_error.
+ *
+ * Re-entering any mode only touches the calling thread's own counts: a write
+ * or upgradeable holder is recognized by an owner id, and a thread's read and
+ * upgradeable holds are kept in a LockNodeTable entry for this lock. So a
+ * reader re-enters even while a writer waits, whereas arriving readers and
+ * upgraders wait for waiting writers, which therefore do not starve. Blocked
+ * threads wait according to `WaitPolicy`, by default spinning briefly and
+ * then parking.
+ */
+template<typename WaitPolicy = SpinThenPark<>>
+class ReentrantReadWriteLock {
+  // The state word: the writer and upgrader bits, the number of waiting
+  // writers, which hold off new readers and upgraders, and the number of
+  // threads that hold the read lock only
+  static constexpr uint64_t kWriter = uint64_t{1} << 63;
+  static constexpr uint64_t kUpgrader = uint64_t{1} << 62;
+  static constexpr uint64_t kWaitingWriter = uint64_t{1} << 32;
+  static constexpr uint64_t kWaitingWriters = kUpgrader - kWaitingWriter;
+  static constexpr uint64_t kReaders = kWaitingWriter - 1;
+
+  static constexpr uint64_t kNoOwner = 0;
+
+  // The calling thread's read and upgradeable holds of a lock
+  struct Holds {
+    uint64_t reads_{0};
+    uint64_t upgrades_{0};
+  };
+
+ public:
+  auto read_lock() -> void {
+    Holds& holds = holds_of_this_thread();
+    if (holds.reads_ == 0 && holds.upgrades_ == 0 && !holds_write_lock()) {
+      acquire([](uint64_t state) {
+        return (state & (kWriter | kWaitingWriters)) == 0;
+      }, 1);
+    }
+    holds.reads_++;
+  }
+
+  auto read_unlock() -> void {
+    Holds* holds = Table::try_find(this);
+    if (holds == nullptr || holds->reads_ == 0) {
+      throw std::runtime_error("The caller does not hold the read lock");
+    }
+    holds->reads_--;
+    if (holds->reads_ == 0 && holds->upgrades_ == 0) {
+      Table::erase(this);
+      if (!holds_write_lock()) {
+        release(1, 0);
+      }
+    }
+  }
+
+  auto upgradeable_lock() -> void {
+    Holds& holds = holds_of_this_thread();
+    if (holds.upgrades_ == 0 && !holds_write_lock()) {
+      if (holds.reads_ > 0) {
+        throw std::logic_error(
+            "A reader cannot take the upgradeable lock; take it first");
+      }
+      acquire([](uint64_t state) {
+        return (state & (kWriter | kUpgrader | kWaitingWriters)) == 0;
+      }, kUpgrader);
+      owner_.store(this_thread_id(), std::memory_order_relaxed);
+    }
+    holds.upgrades_++;
+  }
+
+  auto upgradeable_unlock() -> void {
+    Holds* holds = Table::try_find(this);
+    if (holds == nullptr || holds->upgrades_ == 0) {
+      throw std::runtime_error("The caller does not hold the upgradeable lock");
+    }
+    holds->upgrades_--;
+    if (holds->upgrades_ > 0 || holds_write_lock()) {
+      forget_if_empty(*holds);
+      return;
+    }
+    // Stays a plain reader if it still holds the read lock
+    uint64_t reads = holds->reads_;
+    forget_if_empty(*holds);
+    owner_.store(kNoOwner, std::memory_order_relaxed);
+    release(kUpgrader, reads > 0 ? 1 : 0);
+  }
+
+  auto write_lock() -> void {
+    if (holds_write_lock()) {
+      write_count_++;
+      return;
+    }
+    Holds* holds = Table::try_find(this);
+    if (holds != nullptr && holds->upgrades_ > 0) {
+      upgrade();
+    } else if (holds != nullptr && holds->reads_ > 0) {
+      throw std::logic_error(
+          "A reader cannot take the write lock; take the upgradeable lock "
+          "instead");
+    } else {
+      acquire_write_lock();
+      owner_.store(this_thread_id(), std::memory_order_relaxed);
+    }
+    write_count_ = 1;
+    // The owner id now stands for the write lock
+    is_writer_ = true;
+  }
+
+  auto write_unlock() -> void {
+    if (!holds_write_lock()) {
+      throw std::runtime_error("The caller does not hold the write lock");
+    }
+    write_count_--;
+    if (write_count_ > 0) {
+      return;
+    }
+    is_writer_ = false;
+    // Stays the upgradeable holder or a reader if it still holds either
+    Holds* holds = Table::try_find(this);
+    if (holds != nullptr && holds->upgrades_ > 0) {
+      release(kWriter, kUpgrader);
+      return;
+    }
+    owner_.store(kNoOwner, std::memory_order_relaxed);
+    release(kWriter, holds != nullptr && holds->reads_ > 0 ? 1 : 0);
+  }
+
+ private:
+  using Table = LockNodeTable<Holds>;
+
+  // Ids start at 1, so that no thread has the id of an unowned lock
+  static auto this_thread_id() -> uint64_t { return this_thread_index() + 1; }
+
+  // Only the owner writes its own id to `owner_`, so a relaxed load tells
+  // exactly whether the calling thread is the owner
+  auto holds_write_lock() const -> bool {
+    return owner_.load(std::memory_order_relaxed) == this_thread_id() &&
+           is_writer_;
+  }
+
+  auto holds_of_this_thread() -> Holds& {
+    Holds* holds = Table::try_find(this);
+    if (holds == nullptr) {
+      Table::insert(this, Holds{});
+      holds = &Table::find(this);
+    }
+    return *holds;
+  }
+
+  auto forget_if_empty(const Holds& holds) -> void {
+    if (holds.reads_ == 0 && holds.upgrades_ == 0) {
+      Table::erase(this);
+    }
+  }
+
+  // Adds `bits` to the state once `may_enter` holds for it
+  template<typename Predicate>
+  auto acquire(Predicate may_enter, uint64_t bits) -> void {
+    uint64_t state = state_.load(std::memory_order_relaxed);
+    while (true) {
+      if (!may_enter(state)) {
+        state = WaitPolicy::wait_until(state_, may_enter);
+      }
+      if (state_.compare_exchange_weak(state, state + bits,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  auto acquire_write_lock() -> void {
+    auto is_free = [](uint64_t state) {
+      return (state & (kWriter | kUpgrader | kReaders)) == 0;
+    };
+    uint64_t state = state_.load(std::memory_order_relaxed);
+    if (is_free(state) &&
+        state_.compare_exchange_strong(state, state + kWriter,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+      return;
+    }
+    state = state_.fetch_add(kWaitingWriter, std::memory_order_relaxed) +
+            kWaitingWriter;
+    while (true) {
+      if (!is_free(state)) {
+        state = WaitPolicy::wait_until(state_, is_free);
+      }
+      if (state_.compare_exchange_weak(state, state - kWaitingWriter + kWriter,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  // Turns the calling thread's upgradeable lock into the write lock. Holding
+  // off new readers as a waiting writer, it waits for the current ones to
+  // leave; no other thread can take the lock in the meantime.
+  auto upgrade() -> void {
+    state_.fetch_add(kWaitingWriter, std::memory_order_relaxed);
+    uint64_t state = WaitPolicy::wait_until(
+        state_, [](uint64_t state) { return (state & kReaders) == 0; });
+    // Only other writers may change the state now, by arriving
+    while (!state_.compare_exchange_weak(
+        state, state - kWaitingWriter - kUpgrader + kWriter,
+        std::memory_order_acquire, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Replaces `held` by `kept` in the state, and wakes the threads that may
+  // enter now
+  auto release(uint64_t held, uint64_t kept) -> void {
+    state_.fetch_add(kept - held, std::memory_order_release);
+    WaitPolicy::notify_all(state_);
+  }
+
+  std::atomic<uint64_t> state_{0};
+  // The id of the thread that holds the write or upgradeable lock
+  std::atomic<uint64_t> owner_{kNoOwner};
+  // Only read and written by the owner
+  uint64_t write_count_{0};
+  bool is_writer_{false};
+};
+
+#endif  // REENTRANT_READ_WRITE_LOCK_H_
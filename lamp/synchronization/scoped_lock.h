@@ -1,19 +1,67 @@
 #ifndef SCOPED_LOCK_H_
 #define SCOPED_LOCK_H_
 
-template<typename Lock>
+#include "synchronization/lock.h"
+
+/**
+ * ScopedLock - Holds a lock for the lifetime of the guard
+ *
+ * For a queue lock that accepts a caller-supplied node (NodeLockable), the
+ * guard owns the node, so the lock needs no per-thread bookkeeping and a
+ * thread may hold any number of such locks, e.g. hand over hand. A lock held
+ * this way must be released by the guard, not by a plain unlock(), so code
+ * that waits on a ConditionVariable while holding the guard passes the guard
+ * to wait(): it is itself BasicLockable.
+ */
+template<BasicLockable Lock>
 class ScopedLock {
+  struct NoNode {};
+
+  template<typename L>
+  struct NodeOf {
+    using type = NoNode;
+  };
+
+  template<NodeLockable L>
+  struct NodeOf<L> {
+    using type = typename L::Node;
+  };
+
  public:
-  explicit ScopedLock(Lock& lock) : lock_(lock) { lock_.lock(); }
+  explicit ScopedLock(Lock& lock) : lock_(lock) { this->lock(); }
 
   ScopedLock(const ScopedLock<Lock>&) = delete;
 
   auto operator=(const ScopedLock<Lock>&) -> ScopedLock<Lock>& = delete;
 
-  ~ScopedLock() { lock_.unlock(); }
+  ~ScopedLock() { unlock(); }
+
+  /**
+   * Reacquires the lock after unlock(); the guard must not hold it
+   */
+  auto lock() -> void {
+    if constexpr (NodeLockable<Lock>) {
+      lock_.lock(node_);
+    } else {
+      lock_.lock();
+    }
+  }
+
+  /**
+   * Releases the lock early; the guard must reacquire it before it is
+   * destroyed
+   */
+  auto unlock() -> void {
+    if constexpr (NodeLockable<Lock>) {
+      lock_.unlock(node_);
+    } else {
+      lock_.unlock();
+    }
+  }
 
  private:
   Lock& lock_;
+  [[no_unique_address]] typename NodeOf<Lock>::type node_;
 };
 
 #endif  // SCOPED_LOCK_H_
@@ -4,30 +4,32 @@
 #include <chrono>
 
 #include "synchronization/condition_variable.h"
+#include "synchronization/lock.h"
 #include "synchronization/scoped_lock.h"
 #include "synchronization/ttas_lock.h"
 
+template<BasicLockable Lock = TTASLock<>>
 class Semaphore {
  public:
   Semaphore(int value) : value_(value) {}
 
   auto acquire() -> void {
-    ScopedLock<TTASLock> lk(mutex_);
+    ScopedLock<Lock> lk(mutex_);
     while (value_ == 0) {
-      cv_.wait(mutex_);
+      cv_.wait(lk);
     }
     value_--;
   }
 
   auto release() -> void {
-    ScopedLock<TTASLock> lk(mutex_);
+    ScopedLock<Lock> lk(mutex_);
     value_++;
-    cv_.notify_all();
+    cv_.notify_one();
   }
 
   // Try to acquire without blocking, returns true if successful
   auto try_acquire() -> bool {
-    ScopedLock<TTASLock> lk(mutex_);
+    ScopedLock<Lock> lk(mutex_);
     if (value_ > 0) {
       value_--;
       return true;
@@ -40,7 +42,7 @@ class Semaphore {
   auto try_acquire_for(const std::chrono::duration<Rep, Period>& timeout)
       -> bool {
     auto end_time = std::chrono::steady_clock::now() + timeout;
-    ScopedLock<TTASLock> lk(mutex_);
+    ScopedLock<Lock> lk(mutex_);
 
     while (value_ == 0) {
       auto now = std::chrono::steady_clock::now();
@@ -49,7 +51,7 @@ class Semaphore {
       }
 
       auto remaining_time = end_time - now;
-      if (cv_.wait_for(mutex_, remaining_time) == CVStatus::kTimeout) {
+      if (cv_.wait_for(lk, remaining_time) == CVStatus::kTimeout) {
         return false;  // Timeout
       }
     }
@@ -60,7 +62,7 @@ class Semaphore {
 
   // Get current value (for testing and debugging)
   auto get_value() const -> int {
-    ScopedLock<TTASLock> lk(mutex_);
+    ScopedLock<Lock> lk(mutex_);
     return value_;
   }
 
@@ -70,7 +72,7 @@ class Semaphore {
       return;
     }
 
-    ScopedLock<TTASLock> lk(mutex_);
+    ScopedLock<Lock> lk(mutex_);
     value_ += count;
     cv_.notify_all();
   }
@@ -80,7 +82,7 @@ class Semaphore {
     if (count <= 0)
       return true;
 
-    ScopedLock<TTASLock> lk(mutex_);
+    ScopedLock<Lock> lk(mutex_);
     if (value_ >= count) {
       value_ -= count;
       return true;
@@ -90,7 +92,7 @@ class Semaphore {
 
  private:
   int value_;
-  mutable TTASLock mutex_;
+  mutable Lock mutex_;
   ConditionVariable cv_;
 };
 
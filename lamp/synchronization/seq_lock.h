@@ -0,0 +1,131 @@
+#ifndef SEQ_LOCK_H_
+#define SEQ_LOCK_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "synchronization/lock.h"
+#include "synchronization/scoped_lock.h"
+#include "synchronization/ttas_lock.h"
+#include "util/backoff.h"
+
+/**
+ * SeqLock - A sequence lock guarding a small value that is read often and
+ * written rarely
+ *
+ * Writers serialize on `Lock` and make the sequence number odd while they
+ * write. Readers never write to shared memory: they read the sequence number,
+ * copy the value, and retry if the sequence number was odd or has changed in
+ * the meantime. A reader therefore costs a few loads while no writer is
+ * active, but may retry indefinitely under a steady stream of writers.
+ *
+ * The value is stored as an array of words that are read and written with
+ * relaxed atomic operations [Boe12], so that a reader racing with a writer
+ * copies garbage rather than causing undefined behavior; the copy is only
+ * returned once the sequence number proves it consistent. `T` must therefore
+ * be trivially copyable, and default constructible to be copied into.
+ */
+template<typename T, BasicLockable Lock = TTASLock<>>
+class SeqLock {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "SeqLock copies its value word by word");
+  static_assert(std::is_default_constructible_v<T>);
+
+  static constexpr size_t kNumWords =
+      (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+ public:
+  SeqLock() : SeqLock(T{}) {}
+
+  explicit SeqLock(const T& value) { write_words(value); }
+
+  SeqLock(const SeqLock&) = delete;
+  auto operator=(const SeqLock&) -> SeqLock& = delete;
+
+  /**
+   * Returns a consistent copy of the value
+   */
+  auto load() const -> T {
+    while (true) {
+      uint64_t stamp = try_optimistic_read();
+      if (stamp == 0) {
+        cpu_relax();
+        continue;
+      }
+      T value = read_words();
+      if (validate(stamp)) {
+        return value;
+      }
+    }
+  }
+
+  auto store(const T& value) -> void {
+    update([&value](T& current) { current = value; });
+  }
+
+  /**
+   * Applies `fn` to the value under the writer lock, e.g. to change one field
+   */
+  template<typename Function>
+  auto update(Function fn) -> void {
+    ScopedLock<Lock> lk(writer_lock_);
+    T value = read_words();
+    fn(value);
+    uint64_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    // Orders the odd sequence number before the writes to the value
+    std::atomic_thread_fence(std::memory_order_release);
+    write_words(value);
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  /**
+   * Starts an optimistic read
+   *
+   * @return a stamp to pass to validate(), or 0 if a writer is active
+   */
+  auto try_optimistic_read() const -> uint64_t {
+    uint64_t seq = seq_.load(std::memory_order_acquire);
+    return seq % 2 == 0 ? seq + 1 : 0;
+  }
+
+  /**
+   * Returns whether no writer has been active since try_optimistic_read()
+   * returned `stamp`, i.e. whether what was read in between is consistent
+   */
+  auto validate(uint64_t stamp) const -> bool {
+    // Orders the reads of the value before the second read of the sequence
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return stamp != 0 && seq_.load(std::memory_order_relaxed) + 1 == stamp;
+  }
+
+ private:
+  auto read_words() const -> T {
+    std::array<uint64_t, kNumWords> words;
+    for (size_t i = 0; i < kNumWords; i++) {
+      words[i] = words_[i].load(std::memory_order_relaxed);
+    }
+    T value;
+    std::memcpy(&value, words.data(), sizeof(T));
+    return value;
+  }
+
+  auto write_words(const T& value) -> void {
+    std::array<uint64_t, kNumWords> words{};
+    std::memcpy(words.data(), &value, sizeof(T));
+    for (size_t i = 0; i < kNumWords; i++) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+  }
+
+  // Even while no writer is active; readers only ever load it
+  std::atomic<uint64_t> seq_{0};
+  std::array<std::atomic<uint64_t>, kNumWords> words_;
+  Lock writer_lock_;
+};
+
+#endif  // SEQ_LOCK_H_
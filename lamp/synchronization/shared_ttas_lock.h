@@ -0,0 +1,103 @@
+#ifndef SHARED_TTAS_LOCK_H_
+#define SHARED_TTAS_LOCK_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "synchronization/lock.h"
+#include "synchronization/wait_policy.h"
+#include "util/stats.h"
+
+/**
+ * SharedTTASLock - A reader-writer spin lock in one word, small enough to be
+ * embedded in every node of a list
+ *
+ * The low bit of the word marks a writer and the rest counts the readers. A
+ * writer first sets its bit, which turns arriving readers away, and then
+ * waits for the readers inside to leave, so a steady stream of readers cannot
+ * starve it. A reader adds itself to the count and backs out if it finds the
+ * writer bit set. lock() and unlock() are the exclusive mode, so the lock is
+ * a drop-in replacement for TTASLock; lock_shared() and unlock_shared() are
+ * the shared mode. `WaitPolicy` decides how threads wait.
+ */
+template<typename WaitPolicy = DefaultWaitPolicy>
+class SharedTTASLock : public LockBase<SharedTTASLock<WaitPolicy>> {
+  static constexpr uint32_t kWriter = 1;
+  static constexpr uint32_t kReader = 2;
+
+ public:
+  auto lock() -> void {
+    LAMP_STAT_INC(Stat::kAcquisitions);
+    LAMP_STAT_ADD(Stat::kContendedAcquisitions,
+                  state_.load(std::memory_order_relaxed) != 0);
+    while (true) {
+      uint32_t state = WaitPolicy::wait_until(
+          state_, [](uint32_t state) { return (state & kWriter) == 0; });
+      if (state_.compare_exchange_weak(state, state | kWriter,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    WaitPolicy::wait_until(state_,
+                           [](uint32_t state) { return state == kWriter; });
+  }
+
+  auto unlock() -> void {
+    state_.fetch_sub(kWriter, std::memory_order_release);
+    WaitPolicy::notify_all(state_);
+  }
+
+  auto try_lock() -> bool {
+    uint32_t state = 0;
+    return state_.compare_exchange_strong(state, kWriter,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed);
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    while (true) {
+      if (!wait_until_deadline(
+              state_, [](uint32_t state) { return state == 0; }, deadline)) {
+        return false;
+      }
+      if (try_lock()) {
+        return true;
+      }
+    }
+  }
+
+  auto lock_shared() -> void {
+    while (!try_lock_shared()) {
+      WaitPolicy::wait_until(
+          state_, [](uint32_t state) { return (state & kWriter) == 0; });
+    }
+  }
+
+  auto unlock_shared() -> void {
+    uint32_t state = state_.fetch_sub(kReader, std::memory_order_release);
+    if (state == kWriter + kReader) {
+      // The last reader out lets the waiting writer in
+      WaitPolicy::notify_all(state_);
+    }
+  }
+
+  auto try_lock_shared() -> bool {
+    uint32_t state = state_.fetch_add(kReader, std::memory_order_acquire);
+    if ((state & kWriter) == 0) {
+      return true;
+    }
+    unlock_shared();
+    return false;
+  }
+
+  // Whether some thread holds the lock exclusively, or is about to
+  auto is_locked() const -> bool {
+    return (state_.load(std::memory_order_relaxed) & kWriter) != 0;
+  }
+
+ private:
+  std::atomic<uint32_t> state_{0};
+};
+
+#endif  // SHARED_TTAS_LOCK_H_
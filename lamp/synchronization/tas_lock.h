@@ -4,18 +4,46 @@
 #include <atomic>
 
 #include "synchronization/lock.h"
+#include "util/cpu.h"
+#include "util/stats.h"
 
 /**
  * @brief Test-and-set lock
  *
  */
-class TASLock : public Lock {
+class TASLock : public LockBase<TASLock> {
  public:
-  auto lock() -> void override {
-    while (state_.test_and_set(std::memory_order_acquire)) {}
+  auto lock() -> void {
+    LAMP_STAT_INC(Stat::kAcquisitions);
+    if (state_.test_and_set(std::memory_order_acquire)) {
+      LAMP_STAT_INC(Stat::kContendedAcquisitions);
+      while (state_.test_and_set(std::memory_order_acquire)) {
+        LAMP_STAT_INC(Stat::kSpins);
+        cpu_relax();
+      }
+    }
   }
 
-  auto unlock() -> void override { state_.clear(std::memory_order_release); }
+  auto unlock() -> void { state_.clear(std::memory_order_release); }
+
+  auto try_lock() -> bool {
+    return !state_.test_and_set(std::memory_order_acquire);
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    while (state_.test_and_set(std::memory_order_acquire)) {
+      if (LockClock::now() >= deadline) {
+        return false;
+      }
+      cpu_relax();
+    }
+    return true;
+  }
+
+  // Whether some thread holds the lock
+  auto is_locked() const -> bool {
+    return state_.test(std::memory_order_relaxed);
+  }
 
  private:
   std::atomic_flag state_{false};
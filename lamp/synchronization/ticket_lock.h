@@ -2,31 +2,92 @@
 #define TICKET_LOCK_H_
 
 #include <atomic>
-#include <thread>
 
 #include "synchronization/lock.h"
+#include "synchronization/wait_policy.h"
+#include "util/cache_aligned.h"
+#include "util/stats.h"
 
-class TicketLock : public Lock {
+/**
+ * @brief A FIFO lock in which threads take a ticket and wait until it is
+ * served. `WaitPolicy` decides how a thread waits for its turn.
+ *
+ * A ticket cannot be handed back, so try_lock() and try_lock_for() take one
+ * only when it would be served at once: a thread that times out has never
+ * joined the queue, but it also gets the lock only once no thread holds or
+ * waits for it.
+ */
+template<typename WaitPolicy = DefaultWaitPolicy>
+class TicketLock : public LockBase<TicketLock<WaitPolicy>> {
  public:
-  auto lock() -> void override {
+  auto lock() -> void {
     // Take a ticket - atomic increment guarantees unique, monotonically
     // increasing numbers
-    uint64_t my_ticket = next_ticket_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t my_ticket = next_ticket_->fetch_add(1, std::memory_order_relaxed);
+    LAMP_STAT_INC(Stat::kAcquisitions);
+    LAMP_STAT_ADD(Stat::kContendedAcquisitions,
+                  now_serving_->load(std::memory_order_relaxed) != my_ticket);
 
     // Wait until it's our turn
-    while (now_serving_.load(std::memory_order_acquire) != my_ticket) {
-      std::this_thread::yield();
+    WaitPolicy::wait_until(*now_serving_, [my_ticket](uint64_t serving) {
+      return serving == my_ticket;
+    });
+  }
+
+  auto unlock() -> void {
+    // Move to next ticket. Only the holder writes `now_serving_`, so a plain
+    // store suffices
+    now_serving_->store(now_serving_->load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+    // All waiters park on the same counter, and only one of them is next
+    WaitPolicy::notify_all(*now_serving_);
+  }
+
+  auto try_lock() -> bool {
+    uint64_t serving = now_serving_->load(std::memory_order_acquire);
+    uint64_t ticket = serving;
+    return next_ticket_->compare_exchange_strong(ticket, serving + 1,
+                                                 std::memory_order_relaxed,
+                                                 std::memory_order_relaxed);
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    while (!try_lock()) {
+      // Wait until the lock looks free
+      if (!wait_until_deadline(
+              *now_serving_,
+              [this](uint64_t serving) {
+                return serving ==
+                       next_ticket_->load(std::memory_order_relaxed);
+              },
+              deadline)) {
+        return false;
+      }
     }
+    return true;
+  }
+
+  /**
+   * Returns whether other threads have taken a ticket after the calling
+   * thread, which must hold the lock
+   */
+  auto has_waiters() const -> bool {
+    return next_ticket_->load(std::memory_order_relaxed) -
+               now_serving_->load(std::memory_order_relaxed) >
+           1;
   }
 
-  auto unlock() -> void override {
-    // Move to next ticket
-    now_serving_.fetch_add(1, std::memory_order_release);
+  // Whether some thread holds or waits for the lock
+  auto is_locked() const -> bool {
+    return next_ticket_->load(std::memory_order_relaxed) !=
+           now_serving_->load(std::memory_order_relaxed);
   }
 
  private:
-  std::atomic<uint64_t> next_ticket_{0};
-  std::atomic<uint64_t> now_serving_{0};
+  // Waiters spin on `now_serving_`, so arriving threads taking tickets must
+  // not invalidate its cache line
+  CacheAligned<std::atomic<uint64_t>> next_ticket_{0};
+  CacheAligned<std::atomic<uint64_t>> now_serving_{0};
 };
 
 #endif  // TICKET_LOCK_H_
\ No newline at end of file
@@ -3,89 +3,210 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstddef>
+
+#include "synchronization/lock.h"
+#include "synchronization/lock_node_table.h"
+#include "util/backoff.h"
+#include "util/cache_aligned.h"
+#include "util/cpu.h"
 
 /**
  * @brief A queue lock based on the CLHLock class that supports wait-free
  * timeout even for threads in the middle of the list of nodes waiting for the
  * lock.
+ *
+ * Nodes are recycled rather than leaked. Each node is referenced by exactly one
+ * thread or by the tail: a thread that finds its predecessor released, or that
+ * skips an abandoned predecessor, is the last one to reference that node and
+ * takes it for reuse. A thread that leaves the queue empty on release, or that
+ * gives up as the last waiter, reuses its own node. Recycled nodes go to a
+ * small per-thread cache, so acquisitions do not allocate once it is warm.
+ *
+ * As in CLHLock, the caller may keep the node it queued up with in a `Node`
+ * handle, e.g. on its stack with ScopedLock, while plain lock() and unlock()
+ * keep it in a LockNodeTable entry for this lock. Either way a thread can hold
+ * several timeout locks at once.
  */
-class TOLock {
+class TOLock : public LockBase<TOLock> {
  private:
   struct QNode {
     // Pointer to the predecessor node in the queue:
     // - null: waiting for the lock.
-    // - &AVAILABLE: release the lock.
-    // - non-null: abandoned.
+    // - &available_: released the lock.
+    // - another node: abandoned, and that node is its predecessor.
     std::atomic<QNode*> pred_{nullptr};
+    QNode* next_free_{nullptr};  // The next node of a thread's node cache
   };
 
  public:
-  template<typename Rep, typename Period>
-  auto try_lock(const std::chrono::duration<Rep, Period>& timeout_duration)
-      -> bool {
-
-    auto start = std::chrono::steady_clock::now();
-    QNode* qnode = new QNode();
-    // Save a reference to the node we created so that we can use it in
-    // `unlock()`.
-    my_node_ = qnode;
-    QNode* my_pred = tail_.exchange(qnode, std::memory_order_acq_rel);
-
-    if (my_pred == nullptr ||
-        my_pred->pred_.load(std::memory_order_acquire) == &AVAILABLE) {
-      // We are the only thread in the queue, or the predecessor thread has
-      // already released the lock.
-      return true;
+  ~TOLock() {
+    // Once the lock is free, the tail may still lead through abandoned nodes
+    // to a released one
+    QNode* qnode = tail_->load(std::memory_order_relaxed);
+    while (qnode != nullptr) {
+      QNode* pred = qnode->pred_.load(std::memory_order_relaxed);
+      delete qnode;
+      qnode = pred == &available_ ? nullptr : pred;
     }
+  }
 
-    // Spin while waiting for the lock, but stop if the timeout is reached.
-    while (std::chrono::steady_clock::now() - start < timeout_duration) {
-      QNode* pred_pred = my_pred->pred_.load(std::memory_order_acquire);
-      if (pred_pred == &AVAILABLE) {
-        // The predecessor thread has released the lock, so we can proceed.
-        return true;
-      } else if (pred_pred != nullptr) {
-        // The predecessor thread has aborted, so we update our predecessor to
-        // the predecessor's predecessor, effectively skipping the abandoned
-        // node.
-        my_pred = pred_pred;
-      }
-    }
+  // The queue node under which the caller holds or waits for the lock
+  struct Node {
+    QNode* qnode_{nullptr};
+  };
 
+  auto lock(Node& node) -> void {
+    try_lock_until(node, LockClock::time_point::max());
+  }
+
+  auto unlock(Node& node) -> void {
+    QNode* qnode = node.qnode_;
     QNode* expected = qnode;
-    // We stop trying to acquire the lock. If we are the last thread in the
-    // queue, remove ourselves from the queue by setting the tail to our
-    // predecessor (which could be null if no one else is waiting). Otherwise,
-    // we must stay in the queue but in an abandoned state, allowing subsequent
-    // threads to skip over us.
-    if (!tail_.compare_exchange_strong(expected, my_pred,
-                                       std::memory_order_acquire,
+    // If this thread has no successor, set the tail to null and reuse the
+    // node. Otherwise, set its predecessor to available_ to signal the
+    // successor thread that we have released the lock.
+    if (tail_->compare_exchange_strong(expected, nullptr,
+                                       std::memory_order_release,
                                        std::memory_order_relaxed)) {
-      qnode->pred_.store(
-          my_pred, std::memory_order_relaxed);  // Mark ourselves as abandoned
+      node_cache().put(qnode);
+      return;
     }
+    qnode->pred_.store(&available_, std::memory_order_release);
+  }
 
-    return false;
+  auto try_lock(Node& node) -> bool {
+    return try_lock_until(node, LockClock::time_point::min());
   }
 
+  auto try_lock_until(Node& node, LockClock::time_point deadline) -> bool {
+    QNode* qnode = node_cache().get();
+    QNode* my_pred = tail_->exchange(qnode, std::memory_order_acq_rel);
+    // Checked on every spin, so a cycle counter stands in for the clock
+    CycleDeadline spin_deadline(deadline);
+
+    // Spin while waiting for the lock, but stop if the deadline is reached
+    while (my_pred != nullptr) {
+      QNode* pred_pred = my_pred->pred_.load(std::memory_order_acquire);
+      if (pred_pred == nullptr) {
+        if (spin_deadline.expired()) {
+          abandon(qnode, my_pred);
+          return false;
+        }
+        cpu_relax();
+        continue;
+      }
+      // No one else references the predecessor's node any more
+      node_cache().put(my_pred);
+      if (pred_pred == &available_) {
+        // The predecessor thread has released the lock
+        break;
+      }
+      // The predecessor thread has aborted, so skip its node and wait for its
+      // predecessor instead
+      my_pred = pred_pred;
+    }
+
+    // Save a reference to our node so that we can use it in `unlock()`
+    node.qnode_ = qnode;
+    return true;
+  }
+
+  auto lock() -> void { try_lock_until(LockClock::time_point::max()); }
+
   auto unlock() -> void {
-    QNode* qnode = my_node_;
+    Node node{Nodes::erase(this)};
+    unlock(node);
+  }
+
+  auto try_lock() -> bool {
+    return try_lock_until(LockClock::time_point::min());
+  }
+
+  template<typename Rep, typename Period>
+  auto try_lock(const std::chrono::duration<Rep, Period>& timeout_duration)
+      -> bool {
+    return try_lock_until(
+        LockClock::now() +
+        std::chrono::ceil<LockClock::duration>(timeout_duration));
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    Node node;
+    if (!try_lock_until(node, deadline)) {
+      return false;
+    }
+    Nodes::insert(this, node.qnode_);
+    return true;
+  }
+
+ private:
+  // We stop trying to acquire the lock. If we are the last thread in the
+  // queue, remove ourselves from the queue by setting the tail to our
+  // predecessor. Otherwise, we must stay in the queue but in an abandoned
+  // state, allowing the successor thread to skip over us and reclaim our node.
+  auto abandon(QNode* qnode, QNode* my_pred) -> void {
     QNode* expected = qnode;
-    // If this thread has no successor, set the tail to null. Otherwise, set its
-    // predecessor to AVAILABLE to signal successor thread that we have released
-    // the lock.
-    if (!tail_.compare_exchange_strong(expected, nullptr,
-                                       std::memory_order_release,
+    if (tail_->compare_exchange_strong(expected, my_pred,
+                                       std::memory_order_acq_rel,
                                        std::memory_order_relaxed)) {
-      qnode->pred_.store(const_cast<QNode*>(&AVAILABLE),
-                        std::memory_order_release);
+      node_cache().put(qnode);
+      return;
     }
+    qnode->pred_.store(my_pred, std::memory_order_release);
   }
 
- private:
-  std::atomic<QNode*> tail_{nullptr};
-  static thread_local QNode* my_node_;
-  static const QNode AVAILABLE;
+  // The recycled nodes of a thread, freed when the thread exits. A thread
+  // that keeps skipping nodes abandoned by others would collect them without
+  // bound, so nodes beyond `kMaxCachedNodes` are freed instead.
+  struct NodeCache {
+    static constexpr size_t kMaxCachedNodes = 8;
+
+    QNode* head_{nullptr};
+    size_t size_{0};
+
+    ~NodeCache() {
+      while (head_ != nullptr) {
+        QNode* next = head_->next_free_;
+        delete head_;
+        head_ = next;
+      }
+    }
+
+    auto get() -> QNode* {
+      if (head_ == nullptr) {
+        return new QNode();
+      }
+      QNode* qnode = head_;
+      head_ = qnode->next_free_;
+      size_--;
+      qnode->pred_.store(nullptr, std::memory_order_relaxed);
+      return qnode;
+    }
+
+    auto put(QNode* qnode) -> void {
+      if (size_ == kMaxCachedNodes) {
+        delete qnode;
+        return;
+      }
+      qnode->next_free_ = head_;
+      head_ = qnode;
+      size_++;
+    }
+  };
+
+  using Nodes = LockNodeTable<QNode*>;
+
+  CacheAligned<std::atomic<QNode*>> tail_{nullptr};
+  static QNode available_;
+
+  static auto node_cache() -> NodeCache& {
+    thread_local NodeCache cache;
+    return cache;
+  }
 };
 
-#endif  // TIMEOUT_LOCK_H_
\ No newline at end of file
+// Defined out of the class, where QNode is complete
+inline TOLock::QNode TOLock::available_;
+
+#endif  // TIMEOUT_LOCK_H_
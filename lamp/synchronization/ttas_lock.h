@@ -4,28 +4,62 @@
 #include <atomic>
 
 #include "synchronization/lock.h"
+#include "synchronization/wait_policy.h"
+#include "util/stats.h"
 
 /**
  * @brief Test-and-test-and-set lock improves the performance of test-and-set
  * lock by only setting the flag when the thread notices the flag to be false.
  * This lock reduces load on memory bus and avoid cache ping pong.
+ * `WaitPolicy` decides how a thread waits for the flag to be false.
  *
  */
-class TTASLock : public Lock {
+template<typename WaitPolicy = DefaultWaitPolicy>
+class TTASLock : public LockBase<TTASLock<WaitPolicy>> {
  public:
-  auto lock() -> void override {
+  auto lock() -> void {
+    LAMP_STAT_INC(Stat::kAcquisitions);
+    LAMP_STAT_ADD(Stat::kContendedAcquisitions,
+                  state_.load(std::memory_order_relaxed));
     while (true) {
-      while (state_.test(std::memory_order_relaxed)) {}
-      if (!state_.test_and_set(std::memory_order_acquire)) {
+      WaitPolicy::wait_until(state_, [](bool locked) { return !locked; });
+      if (!state_.exchange(true, std::memory_order_acquire)) {
         return;
       }
     }
   }
 
-  auto unlock() -> void override { state_.clear(std::memory_order_release); }
+  auto unlock() -> void {
+    state_.store(false, std::memory_order_release);
+    // Each release wakes one waiter, which either takes the lock or waits
+    // again for the thread that beat it to release
+    WaitPolicy::notify_one(state_);
+  }
+
+  auto try_lock() -> bool {
+    return !state_.load(std::memory_order_relaxed) &&
+           !state_.exchange(true, std::memory_order_acquire);
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    while (true) {
+      if (!wait_until_deadline(
+              state_, [](bool locked) { return !locked; }, deadline)) {
+        return false;
+      }
+      if (!state_.exchange(true, std::memory_order_acquire)) {
+        return true;
+      }
+    }
+  }
+
+  // Whether some thread holds the lock
+  auto is_locked() const -> bool {
+    return state_.load(std::memory_order_relaxed);
+  }
 
  private:
-  std::atomic_flag state_{false};
+  std::atomic<bool> state_{false};
 };
 
 #endif  // TTAS_LOCK_H_
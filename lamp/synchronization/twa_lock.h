@@ -0,0 +1,147 @@
+#ifndef TWA_LOCK_H_
+#define TWA_LOCK_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "synchronization/lock.h"
+#include "synchronization/wait_policy.h"
+#include "util/cache_aligned.h"
+#include "util/stats.h"
+
+/**
+ * @brief A ticket lock augmented with a waiting array (TWA), after Dice and
+ * Kogan. The lock is two words, like TicketLock, but only the thread whose
+ * ticket is next waits on `now_serving_`. Threads further back wait on a slot
+ * of a waiting array shared by all TWA locks, picked by hashing the lock's
+ * address with their ticket.
+ *
+ * Every release advances `now_serving_` and then bumps the slot of the ticket
+ * that has just become next in line, which moves that thread over to
+ * `now_serving_`. So a release invalidates the lines of at most two waiters,
+ * whatever the queue length, and the lock keeps TicketLock's FIFO order.
+ * Distant waiters sharing a slot through a hash collision only wake up early
+ * and go back to waiting.
+ *
+ * As in TicketLock, try_lock() and try_lock_for() take a ticket only when it
+ * would be served at once.
+ */
+template<typename WaitPolicy = DefaultWaitPolicy>
+class TWALock : public LockBase<TWALock<WaitPolicy>> {
+  // A thread waits on `now_serving_` once at most this many tickets are ahead
+  // of it
+  static constexpr uint64_t kLongTermThreshold = 1;
+
+  static constexpr size_t kWaitingArraySize = 4096;
+
+ public:
+  TWALock() = default;
+
+  TWALock(const TWALock&) = delete;
+  auto operator=(const TWALock&) -> TWALock& = delete;
+
+  auto lock() -> void {
+    uint64_t my_ticket = next_ticket_->fetch_add(1, std::memory_order_relaxed);
+    LAMP_STAT_INC(Stat::kAcquisitions);
+    uint64_t serving = now_serving_->load(std::memory_order_acquire);
+    if (serving == my_ticket) {
+      return;
+    }
+    LAMP_STAT_INC(Stat::kContendedAcquisitions);
+
+    if (my_ticket - serving > kLongTermThreshold) {
+      // Long-term waiting, on the waiting array. Reading the slot before
+      // `now_serving_` makes sure that a release that moves this thread up
+      // either shows in `now_serving_` or changes the slot afterwards.
+      std::atomic<uint64_t>& slot = waiting_slot(my_ticket);
+      while (true) {
+        uint64_t epoch = slot.load(std::memory_order_acquire);
+        if (my_ticket - now_serving_->load(std::memory_order_acquire) <=
+            kLongTermThreshold) {
+          break;
+        }
+        WaitPolicy::wait_until(
+            slot, [epoch](uint64_t value) { return value != epoch; });
+      }
+    }
+
+    // Short-term waiting, on `now_serving_`
+    WaitPolicy::wait_until(*now_serving_, [my_ticket](uint64_t serving) {
+      return serving == my_ticket;
+    });
+  }
+
+  auto unlock() -> void {
+    // Only the holder writes `now_serving_`, so a plain store suffices
+    uint64_t next = now_serving_->load(std::memory_order_relaxed) + 1;
+    now_serving_->store(next, std::memory_order_release);
+    WaitPolicy::notify_all(*now_serving_);
+    // Move the thread that is now within the threshold over to `now_serving_`.
+    // Release orders the store above before the bump it wakes up to.
+    std::atomic<uint64_t>& slot = waiting_slot(next + kLongTermThreshold);
+    slot.fetch_add(1, std::memory_order_release);
+    WaitPolicy::notify_all(slot);
+  }
+
+  auto try_lock() -> bool {
+    uint64_t serving = now_serving_->load(std::memory_order_acquire);
+    uint64_t ticket = serving;
+    return next_ticket_->compare_exchange_strong(ticket, serving + 1,
+                                                 std::memory_order_relaxed,
+                                                 std::memory_order_relaxed);
+  }
+
+  auto try_lock_until(LockClock::time_point deadline) -> bool {
+    while (!try_lock()) {
+      // Wait until the lock looks free
+      if (!wait_until_deadline(
+              *now_serving_,
+              [this](uint64_t serving) {
+                return serving ==
+                       next_ticket_->load(std::memory_order_relaxed);
+              },
+              deadline)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Returns whether other threads have taken a ticket after the calling
+   * thread, which must hold the lock
+   */
+  auto has_waiters() const -> bool {
+    return next_ticket_->load(std::memory_order_relaxed) -
+               now_serving_->load(std::memory_order_relaxed) >
+           1;
+  }
+
+  // Whether some thread holds or waits for the lock
+  auto is_locked() const -> bool {
+    return next_ticket_->load(std::memory_order_relaxed) !=
+           now_serving_->load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Consecutive tickets of a lock map to slots on different cache lines, so a
+  // bump wakes one waiter rather than the neighbours sharing its line
+  auto waiting_slot(uint64_t ticket) const -> std::atomic<uint64_t>& {
+    constexpr uint64_t kStride = kCacheLineSize / sizeof(uint64_t) + 1;
+    uint64_t lock_hash =
+        (reinterpret_cast<uintptr_t>(this) >> 6) * 0x9e3779b97f4a7c15;
+    return waiting_array_[(lock_hash + ticket * kStride) %
+                          kWaitingArraySize];
+  }
+
+  // Shared by every TWA lock with the same wait policy
+  alignas(kCacheLineSize) inline static std::array<
+      std::atomic<uint64_t>, kWaitingArraySize> waiting_array_{};
+
+  CacheAligned<std::atomic<uint64_t>> next_ticket_{0};
+  CacheAligned<std::atomic<uint64_t>> now_serving_{0};
+};
+
+#endif  // TWA_LOCK_H_
@@ -0,0 +1,175 @@
+#ifndef WAIT_POLICY_H_
+#define WAIT_POLICY_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "util/backoff.h"
+#include "util/stats.h"
+
+/**
+ * Wait policies - How a lock's waiter waits for its flag to change
+ *
+ * A policy provides:
+ * - wait_until(flag, ready): returns the first value of `flag` for which
+ *   `ready(value)` holds, reading it with acquire ordering.
+ * - notify_one(flag) / notify_all(flag): called by the releasing thread after
+ *   it stores the new value, to wake one or all threads waiting on `flag`.
+ *
+ * The spinning policies pause the core between reads of the flag and their
+ * notify calls are no-ops, so a handoff costs a single cache miss. Only
+ * SpinThenPark puts waiters to sleep, and its releasers pay for a notify call.
+ */
+
+/**
+ * SpinWait - Spins on the flag, with a pause instruction between reads
+ */
+struct SpinWait {
+  template<typename T, typename Predicate>
+  static auto wait_until(const std::atomic<T>& flag, Predicate ready) -> T {
+    T value = flag.load(std::memory_order_acquire);
+    while (!ready(value)) {
+      LAMP_STAT_INC(Stat::kSpins);
+      cpu_relax();
+      value = flag.load(std::memory_order_acquire);
+    }
+    return value;
+  }
+
+  template<typename T>
+  static auto notify_one(std::atomic<T>&) -> void {}
+
+  template<typename T>
+  static auto notify_all(std::atomic<T>&) -> void {}
+};
+
+/**
+ * PauseBackoffWait - Spins on the flag, doubling the number of pause
+ * instructions between reads up to `MaxPauses`
+ *
+ * Suits flags shared by many waiters (e.g. a TTAS lock's state), where fewer
+ * reads mean less traffic on the flag's cache line.
+ */
+template<int MaxPauses = 1024>
+struct PauseBackoffWait {
+  template<typename T, typename Predicate>
+  static auto wait_until(const std::atomic<T>& flag, Predicate ready) -> T {
+    int pauses = 1;
+    T value = flag.load(std::memory_order_acquire);
+    while (!ready(value)) {
+      LAMP_STAT_INC(Stat::kSpins);
+      for (int i = 0; i < pauses; i++) {
+        cpu_relax();
+      }
+      pauses = std::min(pauses * 2, MaxPauses);
+      value = flag.load(std::memory_order_acquire);
+    }
+    return value;
+  }
+
+  template<typename T>
+  static auto notify_one(std::atomic<T>&) -> void {}
+
+  template<typename T>
+  static auto notify_all(std::atomic<T>&) -> void {}
+};
+
+/**
+ * SpinThenYield - Spins on the flag for `SpinCount` reads and then yields the
+ * processor between reads
+ *
+ * Waiters stay runnable, so a handoff never waits for a wake-up, but
+ * oversubscribed threads let the lock holder run.
+ */
+template<int SpinCount = 128>
+struct SpinThenYield {
+  template<typename T, typename Predicate>
+  static auto wait_until(const std::atomic<T>& flag, Predicate ready) -> T {
+    T value = flag.load(std::memory_order_acquire);
+    for (int spins = 0; !ready(value); spins++) {
+      if (spins < SpinCount) {
+        LAMP_STAT_INC(Stat::kSpins);
+        cpu_relax();
+      } else {
+        std::this_thread::yield();
+      }
+      value = flag.load(std::memory_order_acquire);
+    }
+    return value;
+  }
+
+  template<typename T>
+  static auto notify_one(std::atomic<T>&) -> void {}
+
+  template<typename T>
+  static auto notify_all(std::atomic<T>&) -> void {}
+};
+
+/**
+ * SpinThenPark - Spins on the flag for `SpinCount` reads and then parks on it
+ * with std::atomic::wait until the releaser notifies it
+ *
+ * Idle waiters use no CPU, at the price of a notify call on every release and
+ * a wake-up on handoffs to a parked waiter.
+ */
+template<int SpinCount = 128>
+struct SpinThenPark {
+  template<typename T, typename Predicate>
+  static auto wait_until(const std::atomic<T>& flag, Predicate ready) -> T {
+    T value = flag.load(std::memory_order_acquire);
+    for (int spins = 0; !ready(value); spins++) {
+      if (spins < SpinCount) {
+        LAMP_STAT_INC(Stat::kSpins);
+        cpu_relax();
+      } else {
+        LAMP_STAT_INC(Stat::kParks);
+        // Returns at once if the flag no longer holds `value`
+        flag.wait(value, std::memory_order_acquire);
+      }
+      value = flag.load(std::memory_order_acquire);
+    }
+    return value;
+  }
+
+  template<typename T>
+  static auto notify_one(std::atomic<T>& flag) -> void {
+    flag.notify_one();
+  }
+
+  template<typename T>
+  static auto notify_all(std::atomic<T>& flag) -> void {
+    flag.notify_all();
+  }
+};
+
+// Used by the locks that take a WaitPolicy when none is given
+using DefaultWaitPolicy = SpinThenYield<>;
+
+/**
+ * Waits like SpinThenYield until `ready(value)` holds for the value of `flag`
+ * or `deadline` passes, for the timed acquisitions of the locks. Timed waiters
+ * never park, since std::atomic::wait has no timeout.
+ *
+ * @return whether `ready` held before the deadline
+ */
+template<typename T, typename Predicate, int SpinCount = 128>
+auto wait_until_deadline(const std::atomic<T>& flag, Predicate ready,
+                         std::chrono::steady_clock::time_point deadline)
+    -> bool {
+  for (int spins = 0; !ready(flag.load(std::memory_order_acquire)); spins++) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return false;
+    }
+    if (spins < SpinCount) {
+      LAMP_STAT_INC(Stat::kSpins);
+      cpu_relax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  return true;
+}
+
+#endif  // WAIT_POLICY_H_
@@ -0,0 +1,497 @@
+#ifndef OPTIMISTIC_BTREE_H_
+#define OPTIMISTIC_BTREE_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <type_traits>
+
+#include "util/backoff.h"
+
+/**
+ * OptimisticBTree - An ordered set in a B+-tree with optimistic lock coupling
+ * [Lei16]
+ *
+ * Every node carries a version that is odd while a writer holds the node.
+ * Readers take no locks: they read a node's version, read the node, and then
+ * validate that the version is unchanged, restarting from the root otherwise.
+ * On the way down, a child's version is read before its parent is validated,
+ * so a child that was split in between is never mistaken for the right one.
+ * Writers lock only the nodes they change, by turning the version they read
+ * odd with a CAS: add() locks one leaf, or a node and its parent to split the
+ * node; remove() locks one leaf. Full nodes are split on the way down, so a
+ * split never has to propagate upwards.
+ *
+ * A node spans a few cache lines (`NodeSize` bytes), and keys are found with
+ * a branch-free scan that counts the smaller keys, which touches the node's
+ * lines in order and has no mispredicted branches, unlike a binary search.
+ * As in SeqLock, keys and links are relaxed atomic words [Boe12], so a reader
+ * racing with a writer reads garbage rather than causing undefined behavior,
+ * and discards it when validation fails; `T` must therefore be trivially
+ * copyable and lock-free as an atomic, e.g. an integer.
+ *
+ * Leaves are linked to their right siblings, so range scans move from leaf to
+ * leaf without going back to the root. Removal does not merge nodes, and
+ * nodes are only freed with the tree, so an optimistic reader can always
+ * dereference the node it read a link to. A tree that shrinks keeps its
+ * nodes.
+ */
+template<typename T, typename Compare = std::less<T>, size_t NodeSize = 256>
+class OptimisticBTree {
+  static_assert(std::is_trivially_copyable_v<T> &&
+                    std::atomic<T>::is_always_lock_free,
+                "OptimisticBTree reads keys that writers may be changing");
+
+  struct Node {
+    // Odd while a writer holds the node
+    std::atomic<uint64_t> version_{0};
+    std::atomic<uint32_t> count_{0};
+    const bool is_leaf_;
+
+    explicit Node(bool is_leaf) : is_leaf_(is_leaf) {}
+
+    // Waits until no writer holds the node, and returns its version
+    auto read_lock() const -> uint64_t {
+      uint64_t version = version_.load(std::memory_order_acquire);
+      while (version % 2 == 1) {
+        cpu_relax();
+        version = version_.load(std::memory_order_acquire);
+      }
+      return version;
+    }
+
+    // Whether the node is unchanged since read_lock() returned `version`
+    auto validate(uint64_t version) const -> bool {
+      // Orders the reads of the node before the second read of the version
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return version_.load(std::memory_order_relaxed) == version;
+    }
+
+    // Locks the node if it is unchanged since read_lock() returned `version`
+    auto try_upgrade(uint64_t version) -> bool {
+      if (!version_.compare_exchange_strong(version, version + 1,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+        return false;
+      }
+      // Orders the odd version before the writes to the node
+      std::atomic_thread_fence(std::memory_order_release);
+      return true;
+    }
+
+    auto write_unlock() -> void {
+      version_.store(version_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+    }
+
+    // The number of keys, which a racing read may find out of range
+    auto count() const -> size_t {
+      return count_.load(std::memory_order_relaxed);
+    }
+  };
+
+  static constexpr size_t kLeafCapacity =
+      (NodeSize - sizeof(Node) - sizeof(void*)) / sizeof(T);
+  static constexpr size_t kInnerCapacity =
+      (NodeSize - sizeof(Node) - sizeof(void*)) / (sizeof(T) + sizeof(void*));
+
+  static_assert(kInnerCapacity >= 3, "NodeSize is too small for a B+-tree");
+
+  struct alignas(64) Leaf : Node {
+    std::array<std::atomic<T>, kLeafCapacity> keys_;
+    std::atomic<Leaf*> next_{nullptr};
+
+    Leaf() : Node(true) {}
+  };
+
+  // Child i holds the keys k with keys_[i - 1] < k <= keys_[i]
+  struct alignas(64) Inner : Node {
+    std::array<std::atomic<T>, kInnerCapacity> keys_;
+    std::array<std::atomic<Node*>, kInnerCapacity + 1> children_{};
+
+    Inner() : Node(false) {}
+  };
+
+ public:
+  OptimisticBTree() : root_(new Leaf()) {}
+
+  OptimisticBTree(const OptimisticBTree&) = delete;
+  auto operator=(const OptimisticBTree&) -> OptimisticBTree& = delete;
+
+  /**
+   * Destructor - Frees all nodes
+   *
+   * NOT thread-safe - caller must ensure no other threads are accessing the
+   * tree
+   */
+  ~OptimisticBTree() { delete_subtree(root_.load(std::memory_order_relaxed)); }
+
+  /**
+   * Adds an item to the set if it's not already present
+   *
+   * @param item The item to add
+   * @return true if the item was added, false if it already exists
+   */
+  auto add(const T& item) -> bool {
+    while (true) {
+      if (std::optional<bool> added = try_add(item)) {
+        return *added;
+      }
+    }
+  }
+
+  /**
+   * Removes an item from the set if present
+   *
+   * @param item The item to remove
+   * @return true if the item was removed, false if not found
+   */
+  auto remove(const T& item) -> bool {
+    while (true) {
+      if (std::optional<bool> removed = try_remove(item)) {
+        return *removed;
+      }
+    }
+  }
+
+  /**
+   * Checks if an item exists in the set
+   *
+   * Thread safety: Takes no locks and writes no shared memory, but restarts
+   * when a writer changed a node it read
+   */
+  auto contains(const T& item) const -> bool {
+    while (true) {
+      auto [leaf, version] = find_leaf(item);
+      if (leaf == nullptr) {
+        continue;
+      }
+      size_t count = std::min(leaf->count(), kLeafCapacity);
+      size_t pos = lower_bound(leaf->keys_, count, item);
+      bool found = pos < count && equals(leaf->keys_[pos], item);
+      if (leaf->validate(version)) {
+        return found;
+      }
+    }
+  }
+
+  /**
+   * Calls `fn(item)` for every item between `lo` and `hi` (inclusive), in
+   * ascending order
+   *
+   * Thread safety: Reads each leaf optimistically and calls `fn` only with
+   * items of a validated read, moving to the right sibling without locks.
+   * Weakly consistent: every item that is in the set for the whole call is
+   * visited exactly once, items added or removed concurrently may or may not
+   * be visited.
+   *
+   * @param lo The smallest item to visit
+   * @param hi The largest item to visit
+   * @param fn A callable taking `const T&`
+   */
+  template<typename Fn>
+  auto for_each_in_range(const T& lo, const T& hi, Fn&& fn) const -> void {
+    // After a restart, the scan resumes after the last item it visited
+    T from = lo;
+    bool visited_any = false;
+    std::array<T, kLeafCapacity> items;
+    while (true) {
+      auto [leaf, version] = find_leaf(from);
+      if (leaf == nullptr) {
+        continue;
+      }
+      while (true) {
+        size_t count = std::min(leaf->count(), kLeafCapacity);
+        size_t num_items = 0;
+        bool past_hi = false;
+        for (size_t i = 0; i < count; i++) {
+          T key = leaf->keys_[i].load(std::memory_order_relaxed);
+          if (compare_(hi, key)) {
+            past_hi = true;
+            break;
+          }
+          if (compare_(from, key) || (!visited_any && !compare_(key, from))) {
+            items[num_items++] = key;
+          }
+        }
+        Leaf* next = leaf->next_.load(std::memory_order_relaxed);
+        if (!leaf->validate(version)) {
+          break;  // restart from the root at `from`
+        }
+        for (size_t i = 0; i < num_items; i++) {
+          fn(static_cast<const T&>(items[i]));
+        }
+        if (num_items > 0) {
+          from = items[num_items - 1];
+          visited_any = true;
+        }
+        if (past_hi || next == nullptr) {
+          return;
+        }
+        leaf = next;
+        version = leaf->read_lock();
+      }
+    }
+  }
+
+ private:
+  // The number of keys among the first `count` that are less than `item`,
+  // i.e. the position of `item` in sorted keys
+  template<size_t N>
+  auto lower_bound(const std::array<std::atomic<T>, N>& keys, size_t count,
+                   const T& item) const -> size_t {
+    size_t pos = 0;
+    for (size_t i = 0; i < count; i++) {
+      pos += compare_(keys[i].load(std::memory_order_relaxed), item);
+    }
+    return pos;
+  }
+
+  auto equals(const std::atomic<T>& key, const T& item) const -> bool {
+    T value = key.load(std::memory_order_relaxed);
+    return !compare_(value, item) && !compare_(item, value);
+  }
+
+  // The child to descend into for `item`, or nullptr if a racing read found
+  // an empty slot
+  auto child_for(const Inner* inner, const T& item) const -> Node* {
+    size_t count = std::min(inner->count(), kInnerCapacity);
+    size_t pos = lower_bound(inner->keys_, count, item);
+    return inner->children_[pos].load(std::memory_order_relaxed);
+  }
+
+  struct LeafVersion {
+    Leaf* leaf_;
+    uint64_t version_;
+  };
+
+  // Descends to the leaf that holds `item` and returns it with the version it
+  // was read at, or a null leaf if the descent must restart
+  auto find_leaf(const T& item) const -> LeafVersion {
+    Node* node = root_.load(std::memory_order_acquire);
+    uint64_t version = node->read_lock();
+    if (node != root_.load(std::memory_order_acquire)) {
+      return {nullptr, 0};
+    }
+    while (!node->is_leaf_) {
+      auto* inner = static_cast<Inner*>(node);
+      Node* child = child_for(inner, item);
+      if (child == nullptr) {
+        return {nullptr, 0};
+      }
+      uint64_t child_version = child->read_lock();
+      if (!inner->validate(version)) {
+        return {nullptr, 0};
+      }
+      node = child;
+      version = child_version;
+    }
+    return {static_cast<Leaf*>(node), version};
+  }
+
+  // One attempt at add(), or nullopt if it must restart
+  auto try_add(const T& item) -> std::optional<bool> {
+    Node* node = root_.load(std::memory_order_acquire);
+    uint64_t version = node->read_lock();
+    if (node != root_.load(std::memory_order_acquire)) {
+      return std::nullopt;
+    }
+    Inner* parent = nullptr;
+    uint64_t parent_version = 0;
+    while (!node->is_leaf_) {
+      auto* inner = static_cast<Inner*>(node);
+      if (inner->count() == kInnerCapacity) {
+        // Split on the way down, so that the parent of any node that is split
+        // later has room for the new separator
+        split(inner, version, parent, parent_version);
+        return std::nullopt;
+      }
+      Node* child = child_for(inner, item);
+      if (child == nullptr) {
+        return std::nullopt;
+      }
+      uint64_t child_version = child->read_lock();
+      if (!inner->validate(version)) {
+        return std::nullopt;
+      }
+      parent = inner;
+      parent_version = version;
+      node = child;
+      version = child_version;
+    }
+
+    auto* leaf = static_cast<Leaf*>(node);
+    size_t count = std::min(leaf->count(), kLeafCapacity);
+    size_t pos = lower_bound(leaf->keys_, count, item);
+    if (pos < count && equals(leaf->keys_[pos], item)) {
+      if (!leaf->validate(version)) {
+        return std::nullopt;
+      }
+      return false;
+    }
+    if (count == kLeafCapacity) {
+      split(leaf, version, parent, parent_version);
+      return std::nullopt;
+    }
+    if (!leaf->try_upgrade(version)) {
+      return std::nullopt;
+    }
+    // The leaf is unchanged since `count` and `pos` were read
+    for (size_t i = count; i > pos; i--) {
+      store(leaf->keys_[i], load(leaf->keys_[i - 1]));
+    }
+    store(leaf->keys_[pos], item);
+    leaf->count_.store(count + 1, std::memory_order_relaxed);
+    leaf->write_unlock();
+    return true;
+  }
+
+  // One attempt at remove(), or nullopt if it must restart
+  auto try_remove(const T& item) -> std::optional<bool> {
+    auto [leaf, version] = find_leaf(item);
+    if (leaf == nullptr) {
+      return std::nullopt;
+    }
+    size_t count = std::min(leaf->count(), kLeafCapacity);
+    size_t pos = lower_bound(leaf->keys_, count, item);
+    if (pos == count || !equals(leaf->keys_[pos], item)) {
+      if (!leaf->validate(version)) {
+        return std::nullopt;
+      }
+      return false;
+    }
+    if (!leaf->try_upgrade(version)) {
+      return std::nullopt;
+    }
+    for (size_t i = pos; i + 1 < count; i++) {
+      store(leaf->keys_[i], load(leaf->keys_[i + 1]));
+    }
+    leaf->count_.store(count - 1, std::memory_order_relaxed);
+    leaf->write_unlock();
+    return true;
+  }
+
+  /**
+   * Splits the full `node` in two and adds the separator to `parent`, or to a
+   * new root if `node` is the root. Returns without splitting if either node
+   * changed since it was read; the caller restarts either way.
+   */
+  template<typename NodeType>
+  auto split(NodeType* node, uint64_t version, Inner* parent,
+             uint64_t parent_version) -> void {
+    if (parent != nullptr && !parent->try_upgrade(parent_version)) {
+      return;
+    }
+    if (!node->try_upgrade(version)) {
+      if (parent != nullptr) {
+        parent->write_unlock();
+      }
+      return;
+    }
+    if (parent == nullptr && node != root_.load(std::memory_order_relaxed)) {
+      // Another thread split the root in the meantime
+      node->write_unlock();
+      return;
+    }
+
+    auto [right, separator] = split_node(node);
+    if (parent != nullptr) {
+      insert_child(parent, separator, right);
+    } else {
+      auto* root = new Inner();
+      store(root->keys_[0], separator);
+      root->children_[0].store(node, std::memory_order_relaxed);
+      root->children_[1].store(right, std::memory_order_relaxed);
+      root->count_.store(1, std::memory_order_relaxed);
+      root_.store(root, std::memory_order_release);
+    }
+    node->write_unlock();
+    if (parent != nullptr) {
+      parent->write_unlock();
+    }
+  }
+
+  template<typename NodeType>
+  struct SplitResult {
+    NodeType* right_;
+    T separator_;
+  };
+
+  // Moves the upper half of the locked `leaf` into a new right sibling
+  auto split_node(Leaf* leaf) -> SplitResult<Leaf> {
+    auto* right = new Leaf();
+    size_t mid = kLeafCapacity / 2;
+    for (size_t i = mid; i < kLeafCapacity; i++) {
+      store(right->keys_[i - mid], load(leaf->keys_[i]));
+    }
+    right->count_.store(kLeafCapacity - mid, std::memory_order_relaxed);
+    right->next_.store(leaf->next_.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    leaf->next_.store(right, std::memory_order_relaxed);
+    leaf->count_.store(mid, std::memory_order_relaxed);
+    return {right, load(leaf->keys_[mid - 1])};
+  }
+
+  // Moves the keys and children above the middle key of the locked `inner`
+  // into a new node; the middle key moves up to the parent
+  auto split_node(Inner* inner) -> SplitResult<Inner> {
+    auto* right = new Inner();
+    size_t mid = kInnerCapacity / 2;
+    for (size_t i = mid + 1; i < kInnerCapacity; i++) {
+      store(right->keys_[i - mid - 1], load(inner->keys_[i]));
+    }
+    for (size_t i = mid + 1; i <= kInnerCapacity; i++) {
+      right->children_[i - mid - 1].store(
+          inner->children_[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    right->count_.store(kInnerCapacity - mid - 1, std::memory_order_relaxed);
+    inner->count_.store(mid, std::memory_order_relaxed);
+    return {right, load(inner->keys_[mid])};
+  }
+
+  // Adds `separator` and the new node to its right to the locked `parent`,
+  // which is not full
+  auto insert_child(Inner* parent, const T& separator, Node* right) -> void {
+    size_t count = parent->count();
+    size_t pos = lower_bound(parent->keys_, count, separator);
+    for (size_t i = count; i > pos; i--) {
+      store(parent->keys_[i], load(parent->keys_[i - 1]));
+      parent->children_[i + 1].store(
+          parent->children_[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+    store(parent->keys_[pos], separator);
+    parent->children_[pos + 1].store(right, std::memory_order_relaxed);
+    parent->count_.store(count + 1, std::memory_order_relaxed);
+  }
+
+  static auto load(const std::atomic<T>& key) -> T {
+    return key.load(std::memory_order_relaxed);
+  }
+
+  static auto store(std::atomic<T>& key, const T& value) -> void {
+    key.store(value, std::memory_order_relaxed);
+  }
+
+  static auto delete_subtree(Node* node) -> void {
+    if (node->is_leaf_) {
+      delete static_cast<Leaf*>(node);
+      return;
+    }
+    auto* inner = static_cast<Inner*>(node);
+    for (size_t i = 0; i <= inner->count(); i++) {
+      delete_subtree(inner->children_[i].load(std::memory_order_relaxed));
+    }
+    delete inner;
+  }
+
+  std::atomic<Node*> root_;
+  [[no_unique_address]] Compare compare_;
+};
+
+#endif  // OPTIMISTIC_BTREE_H_
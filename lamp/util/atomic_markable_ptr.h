@@ -81,6 +81,12 @@ class AtomicMarkablePtr {
     return ptr_and_mark_.load(order);
   }
 
+  auto set(T* ptr, bool marked,
+           std::memory_order order = std::memory_order_seq_cst) noexcept
+      -> void {
+    ptr_and_mark_.store(pack(ptr, marked), order);
+  }
+
  private:
   static constexpr uintptr_t MARK_BIT = 1;
 
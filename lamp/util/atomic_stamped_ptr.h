@@ -2,69 +2,167 @@
 #define ATOMIC_STAMPED_PTR_H_
 
 #include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 
-template<typename T>
+/**
+ * Stamp representations - How an AtomicStampedPtr lays out its pointer and
+ * stamp
+ *
+ * WideStamp keeps a full pointer and a 64-bit stamp in a 16-byte word, which
+ * only a double-width CAS (cmpxchg16b, casp) updates without a lock. Where the
+ * compiler cannot promise one, std::atomic falls back to libatomic, which may
+ * guard the word with a lock from a global table.
+ *
+ * PackedStamp keeps a 16-bit stamp in the upper bits of the pointer, which are
+ * zero for user-space addresses on x86-64 and AArch64 (whose virtual addresses
+ * have at most 48 bits), so that a plain 64-bit CAS suffices. Its stamps wrap
+ * around after 65536 updates: a thread that stalls between reading a stamped
+ * pointer and CASing it for exactly a multiple of that many updates still
+ * suffers from ABA. It must not be used with pointer tagging, such as AArch64
+ * memory tagging, that sets these bits.
+ */
+struct WideStamp {
+  static constexpr uint64_t kMaxStamp = UINT64_MAX;
+  static constexpr const char* kName = "wide";
+
+  template<typename T>
+  struct Word {
+    T* ptr_{nullptr};
+    uint64_t stamp_{0};
+  };
+
+  template<typename T>
+  static auto pack(T* ptr, uint64_t stamp) noexcept -> Word<T> {
+    return {ptr, stamp};
+  }
+
+  template<typename T>
+  static auto ptr_of(Word<T> word) noexcept -> T* {
+    return word.ptr_;
+  }
+
+  template<typename T>
+  static auto stamp_of(Word<T> word) noexcept -> uint64_t {
+    return word.stamp_;
+  }
+};
+
+struct PackedStamp {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__) || \
+    defined(_M_ARM64)
+  static constexpr bool kAvailable = true;
+#else
+  static constexpr bool kAvailable = false;
+#endif
+  static constexpr int kPtrBits = 48;
+  static constexpr uint64_t kMaxStamp = 0xffff;
+  static constexpr const char* kName = "packed";
+
+  template<typename T>
+  using Word = uint64_t;
+
+  template<typename T>
+  static auto pack(T* ptr, uint64_t stamp) noexcept -> uint64_t {
+    auto address = reinterpret_cast<uint64_t>(ptr);
+    assert(address >> kPtrBits == 0 && "the pointer has no free upper bits");
+    return address | (stamp & kMaxStamp) << kPtrBits;
+  }
+
+  template<typename T>
+  static auto ptr_of(uint64_t word) noexcept -> T* {
+    return reinterpret_cast<T*>(word & ((uint64_t{1} << kPtrBits) - 1));
+  }
+
+  template<typename T>
+  static auto stamp_of(uint64_t word) noexcept -> uint64_t {
+    return word >> kPtrBits;
+  }
+};
+
+/**
+ * DefaultStamp - WideStamp if a double-width CAS is always lock-free, and
+ * PackedStamp otherwise, where the platform allows it
+ *
+ * GCC never promises a lock-free 16-byte atomic, even with -mcx16, so with
+ * GCC this is PackedStamp on x86-64 and AArch64.
+ */
+using DefaultStamp = std::conditional_t<
+    std::atomic<WideStamp::Word<void>>::is_always_lock_free ||
+        !PackedStamp::kAvailable,
+    WideStamp, PackedStamp>;
+
+/**
+ * AtomicStampedPtr - A pointer and a stamp that are read and updated together
+ * atomically
+ *
+ * Algorithms increment the stamp on every update, so a CAS with a stale stamp
+ * fails even if the pointer has been changed and changed back (the ABA
+ * problem). Stamps are taken modulo `kMaxStamp + 1`. `Stamp` selects the
+ * representation, see WideStamp and PackedStamp.
+ */
+template<typename T, typename Stamp = DefaultStamp>
 class AtomicStampedPtr {
+  using Word = typename Stamp::template Word<T>;
+
+  static_assert(!std::is_same_v<Stamp, PackedStamp> || PackedStamp::kAvailable,
+                "Pointers on this platform have no free bits for a stamp");
+
  public:
-  AtomicStampedPtr() : atomic_stamped_ptr_(StampedPtr{}) {}
+  static constexpr uint64_t kMaxStamp = Stamp::kMaxStamp;
+  // Whether operations compile to plain atomic instructions, without a lock
+  static constexpr bool kIsLockFree = std::atomic<Word>::is_always_lock_free;
+  static constexpr const char* kRepresentation = Stamp::kName;
+
+  AtomicStampedPtr() : AtomicStampedPtr(nullptr, 0) {}
 
   AtomicStampedPtr(T* ptr, uint64_t stamp)
-      : atomic_stamped_ptr_(StampedPtr(ptr, stamp)) {}
+      : atomic_stamped_ptr_(Stamp::pack(ptr, stamp)) {}
 
   auto compare_and_swap(
       T* expected_ptr, T* desired_ptr, uint64_t expected_stamp,
       uint64_t desired_stamp,
       std::memory_order order = std::memory_order_seq_cst) noexcept -> bool {
-    StampedPtr expected{expected_ptr, expected_stamp};
-    StampedPtr desired{desired_ptr, desired_stamp};
-    return atomic_stamped_ptr_.compare_exchange_strong(expected, desired,
-                                                       order);
+    Word expected = Stamp::pack(expected_ptr, expected_stamp);
+    return atomic_stamped_ptr_.compare_exchange_strong(
+        expected, Stamp::pack(desired_ptr, desired_stamp), order);
   }
 
   auto compare_and_swap(T* expected_ptr, T* desired_ptr,
                         uint64_t expected_stamp, uint64_t desired_stamp,
                         std::memory_order success,
                         std::memory_order failure) noexcept -> bool {
-    StampedPtr expected{expected_ptr, expected_stamp};
-    StampedPtr desired{desired_ptr, desired_stamp};
-    return atomic_stamped_ptr_.compare_exchange_strong(expected, desired,
-                                                       success, failure);
+    Word expected = Stamp::pack(expected_ptr, expected_stamp);
+    return atomic_stamped_ptr_.compare_exchange_strong(
+        expected, Stamp::pack(desired_ptr, desired_stamp), success, failure);
   }
 
   auto get(std::memory_order order = std::memory_order_seq_cst) const noexcept
       -> std::pair<T*, uint64_t> {
-    StampedPtr stamped_ptr = atomic_stamped_ptr_.load(order);
-    return {stamped_ptr.ptr_, stamped_ptr.stamp_};
+    Word word = atomic_stamped_ptr_.load(order);
+    return {Stamp::template ptr_of<T>(word), Stamp::template stamp_of<T>(word)};
   }
 
   auto get_ptr(std::memory_order order =
                    std::memory_order_seq_cst) const noexcept -> T* {
-    return atomic_stamped_ptr_.load(order).ptr_;
+    return Stamp::template ptr_of<T>(atomic_stamped_ptr_.load(order));
   }
 
   auto get_stamp(std::memory_order order =
                      std::memory_order_seq_cst) const noexcept -> uint64_t {
-    return atomic_stamped_ptr_.load(order).stamp_;
+    return Stamp::template stamp_of<T>(atomic_stamped_ptr_.load(order));
   }
 
   auto set(T* ptr, uint64_t stamp,
            std::memory_order order = std::memory_order_seq_cst) noexcept
       -> void {
-    StampedPtr stamped_ptr{ptr, stamp};
-    atomic_stamped_ptr_.store(stamped_ptr, order);
+    atomic_stamped_ptr_.store(Stamp::pack(ptr, stamp), order);
   }
 
  private:
-  struct StampedPtr {
-    T* ptr_{nullptr};
-    uint64_t stamp_{};
-
-    StampedPtr() = default;
-
-    StampedPtr(T* ptr, uint64_t stamp) noexcept : ptr_(ptr), stamp_(stamp) {}
-  };
-
-  std::atomic<StampedPtr> atomic_stamped_ptr_;
+  std::atomic<Word> atomic_stamped_ptr_;
 };
 
 #endif  // ATOMIC_STAMPED_PTR_H_
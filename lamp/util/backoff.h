@@ -1,11 +1,16 @@
 #ifndef BACKOFF_H_
 #define BACKOFF_H_
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <concepts>
-#include <random>
+#include <cstdint>
 #include <thread>
 #include <type_traits>
 
+#include "util/cpu.h"
+
 template<typename T>
 concept IntType = std::integral<T> &&
                   (std::is_same_v<T, short> || std::is_same_v<T, int> ||
@@ -15,32 +20,124 @@ concept IntType = std::integral<T> &&
                    std::is_same_v<T, unsigned long> ||
                    std::is_same_v<T, unsigned long long>);
 
+/**
+ * Returns a 64-bit pseudo-random number from the calling thread's wyrand
+ * generator
+ *
+ * The generator is a single thread-local word, seeded from a global counter
+ * on the thread's first call, so drawing a number costs an add and a multiply.
+ * It is meant for picking backoff delays and slots, not for statistics.
+ */
+inline auto random_uint64() noexcept -> uint64_t {
+  static std::atomic<uint64_t> next_seed{0x9e3779b97f4a7c15};
+  thread_local uint64_t state =
+      next_seed.fetch_add(0x9e3779b97f4a7c15, std::memory_order_relaxed) ^
+      reinterpret_cast<uintptr_t>(&state);
+
+  state += 0xa0761d6478bd642f;
+  unsigned __int128 product =
+      static_cast<unsigned __int128>(state) * (state ^ 0xe7037ed1a0b428db);
+  return static_cast<uint64_t>(product >> 64) ^ static_cast<uint64_t>(product);
+}
+
+/**
+ * Returns a pseudo-random integer in [lower_limit, upper_limit]
+ *
+ * Maps a random word onto the range with a multiply-shift instead of a
+ * division; the bias is below range / 2^64.
+ */
 template<typename T>
   requires IntType<T>
 auto get_random_int(T lower_limit, T upper_limit) -> T {
-  thread_local std::random_device rd;
-  thread_local std::mt19937_64 gen(rd());  // Each thread gets its own generator
-
-  std::uniform_int_distribution<T> dist(lower_limit, upper_limit);
-  return dist(gen);
+  using U = std::make_unsigned_t<T>;
+  // Zero if the range covers all 2^64 values
+  uint64_t range = static_cast<uint64_t>(static_cast<U>(
+                       static_cast<U>(upper_limit) -
+                       static_cast<U>(lower_limit))) +
+                   1;
+  uint64_t random = random_uint64();
+  uint64_t offset =
+      range == 0 ? random
+                 : static_cast<uint64_t>(
+                       (static_cast<unsigned __int128>(random) * range) >> 64);
+  return static_cast<T>(static_cast<U>(lower_limit) + static_cast<U>(offset));
 }
 
+/**
+ * Backoff - Randomized exponential backoff
+ *
+ * Each call waits for a random delay of up to the current limit, which
+ * doubles from `min_delay` to `max_delay`. Delays shorter than
+ * `spin_threshold` are spun with cpu_relax(), since sleep_for costs a system
+ * call and oversleeps by tens of microseconds; only longer delays sleep. A
+ * zero threshold makes every delay sleep.
+ */
 template<typename Duration>
 class Backoff {
  public:
-  Backoff(int64_t min_delay, int64_t max_delay)
-      : kMinDelay(min_delay), kMaxDelay(max_delay), current_limit_(kMinDelay) {}
+  // Delays below this are spun by default
+  static constexpr std::chrono::microseconds kDefaultSpinThreshold{50};
+
+  Backoff(int64_t min_delay, int64_t max_delay,
+          Duration spin_threshold =
+              std::chrono::duration_cast<Duration>(kDefaultSpinThreshold))
+      : kMinDelay(min_delay),
+        kMaxDelay(max_delay),
+        kSpinThreshold(spin_threshold),
+        current_limit_(kMinDelay) {}
 
   auto backoff() -> void {
-    int64_t delay = get_random_int<int64_t>(0, current_limit_);
+    Duration delay{get_random_int<int64_t>(0, current_limit_)};
     current_limit_ = std::min(kMaxDelay, current_limit_ * 2);
-    std::this_thread::sleep_for(Duration(delay));
+    if (delay >= kSpinThreshold) {
+      std::this_thread::sleep_for(delay);
+      return;
+    }
+    int64_t pauses =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count() *
+        pauses_per_microsecond() / 1000;
+    for (int64_t i = 0; i < pauses; i++) {
+      cpu_relax();
+    }
   }
 
  private:
   const int64_t kMinDelay;
   const int64_t kMaxDelay;
+  const Duration kSpinThreshold;
   int64_t current_limit_;
 };
 
+/**
+ * NoBackoff - Retry policy of lock-free operations that retries right away
+ */
+struct NoBackoff {
+  auto backoff() noexcept -> void {}
+};
+
+/**
+ * PauseBackoff - Retry policy of lock-free operations that spins for a random
+ * number of cpu_relax() calls, up to a limit that doubles from `MinPauses` to
+ * `MaxPauses` with every failed attempt
+ *
+ * Cheap enough to construct once per operation: it never reads the clock or
+ * sleeps, so it suits retries after a failed CAS, which are short-lived.
+ */
+template<int64_t MinPauses = 4, int64_t MaxPauses = 1024>
+class PauseBackoff {
+  static_assert(0 < MinPauses && MinPauses <= MaxPauses);
+
+ public:
+  auto backoff() noexcept -> void {
+    int64_t pauses = get_random_int<int64_t>(0, limit_);
+    limit_ = std::min(MaxPauses, limit_ * 2);
+    for (int64_t i = 0; i < pauses; i++) {
+      cpu_relax();
+    }
+  }
+
+ private:
+  int64_t limit_{MinPauses};
+};
+
 #endif  // BACKOFF_H_
\ No newline at end of file
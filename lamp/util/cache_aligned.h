@@ -0,0 +1,68 @@
+#ifndef CACHE_ALIGNED_H_
+#define CACHE_ALIGNED_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+/**
+ * The minimum distance between two objects written by different threads that
+ * avoids false sharing
+ */
+#ifdef __cpp_lib_hardware_interference_size
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC warns that the value depends on -mtune; it is only used for padding
+// within this library, never in an ABI shared with other code.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif
+inline constexpr size_t kCacheLineSize =
+    std::hardware_destructive_interference_size;
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#else
+inline constexpr size_t kCacheLineSize = 64;
+#endif
+
+/**
+ * The alignment of CacheAligned. Defining LAMP_NO_CACHE_PADDING turns the
+ * padding off, so that benchmarks can measure what it gains.
+ */
+#ifdef LAMP_NO_CACHE_PADDING
+inline constexpr size_t kCachePadding = 1;
+#else
+inline constexpr size_t kCachePadding = kCacheLineSize;
+#endif
+
+/**
+ * CacheAligned - A value that occupies its own cache line(s)
+ *
+ * The value starts at a cache line boundary, and the wrapper is padded to a
+ * whole number of cache lines, so that no other object shares a line with it.
+ * A member that follows a CacheAligned member starts on a new line as well, so
+ * a CacheAligned member can separate the fields written by one group of
+ * threads from those written by another.
+ *
+ * The value is accessed with `*` and `->`, like through a pointer.
+ */
+template<typename T>
+class alignas(std::max(kCachePadding, alignof(T))) CacheAligned {
+ public:
+  template<typename... Args>
+  CacheAligned(Args&&... args) : value_(std::forward<Args>(args)...) {}
+
+  auto operator*() -> T& { return value_; }
+
+  auto operator*() const -> const T& { return value_; }
+
+  auto operator->() -> T* { return &value_; }
+
+  auto operator->() const -> const T* { return &value_; }
+
+ private:
+  T value_;
+};
+
+#endif  // CACHE_ALIGNED_H_
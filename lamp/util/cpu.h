@@ -0,0 +1,176 @@
+#ifndef CPU_H_
+#define CPU_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#include <x86intrin.h>
+#endif
+
+/**
+ * Tells the core that the calling thread is spinning, which frees execution
+ * resources for a sibling hyperthread and avoids the memory-order violation
+ * that ends a spin loop on x86
+ *
+ * Compiles to `pause` on x86, `isb` on AArch64, whose `yield` is a no-op on
+ * most cores while `isb` stalls for tens of cycles, and `yield` on 32-bit Arm.
+ */
+inline auto cpu_relax() noexcept -> void {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("isb" ::: "memory");
+#elif defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#else
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+/**
+ * Returns how many cpu_relax() calls take about a microsecond on this machine
+ *
+ * Measured once per process; the cost of a pause instruction varies from a
+ * few to over a hundred cycles between CPU generations.
+ */
+inline auto pauses_per_microsecond() -> int64_t {
+  static const int64_t pauses = [] {
+    constexpr int64_t kSamplePauses = 1 << 14;
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < kSamplePauses; i++) {
+      cpu_relax();
+    }
+    int64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    elapsed_ns = std::max<int64_t>(elapsed_ns, 1);
+    return std::clamp<int64_t>(kSamplePauses * 1000 / elapsed_ns, 1,
+                               kSamplePauses);
+  }();
+  return pauses;
+}
+
+/**
+ * Reads a counter that ticks at a constant rate: the time-stamp counter on
+ * x86, the virtual timer on AArch64, and steady_clock in nanoseconds
+ * elsewhere
+ *
+ * Costs a few nanoseconds, against tens for steady_clock::now(), but is not
+ * ordered with the memory accesses around it, so it suits deadlines of spin
+ * loops rather than measurements.
+ */
+inline auto read_cycle_counter() noexcept -> uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+/**
+ * Returns how many read_cycle_counter() ticks make a nanosecond
+ *
+ * AArch64 reports the timer frequency; elsewhere the counter is timed against
+ * steady_clock for about 100 microseconds, once per process.
+ */
+inline auto cycles_per_nanosecond() -> double {
+  static const double cycles = [] {
+#if defined(__aarch64__)
+    uint64_t frequency;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+    return static_cast<double>(frequency) / 1e9;
+#elif defined(__x86_64__) || defined(__i386__)
+    constexpr std::chrono::microseconds kSamplePeriod{100};
+    auto start = std::chrono::steady_clock::now();
+    uint64_t start_cycles = read_cycle_counter();
+    std::chrono::steady_clock::time_point now;
+    do {
+      cpu_relax();
+      now = std::chrono::steady_clock::now();
+    } while (now - start < kSamplePeriod);
+    uint64_t cycles = read_cycle_counter() - start_cycles;
+    auto elapsed_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - start);
+    return std::max(static_cast<double>(cycles) /
+                        static_cast<double>(elapsed_ns.count()),
+                    1e-3);
+#else
+    return 1.0;
+#endif
+  }();
+  return cycles;
+}
+
+/**
+ * CycleDeadline - A steady_clock deadline turned into a read_cycle_counter()
+ * value, so that a spin loop can check it on every iteration
+ *
+ * time_point::max() never expires and a deadline in the past has already
+ * expired, as with the clock. Constructing one reads the clock once, unless
+ * the deadline is time_point::max() or time_point::min().
+ */
+class CycleDeadline {
+ public:
+  explicit CycleDeadline(std::chrono::steady_clock::time_point deadline) {
+    if (deadline == std::chrono::steady_clock::time_point::max()) {
+      end_cycles_ = std::numeric_limits<uint64_t>::max();
+      return;
+    }
+    if (deadline == std::chrono::steady_clock::time_point::min()) {
+      end_cycles_ = 0;
+      return;
+    }
+    uint64_t now_cycles = read_cycle_counter();
+    auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::steady_clock::duration::zero()) {
+      end_cycles_ = 0;
+      return;
+    }
+    double cycles =
+        static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(remaining)
+                .count()) *
+        cycles_per_nanosecond();
+    uint64_t max_cycles = std::numeric_limits<uint64_t>::max() - now_cycles;
+    end_cycles_ = cycles >= static_cast<double>(max_cycles)
+                      ? std::numeric_limits<uint64_t>::max()
+                      : now_cycles + static_cast<uint64_t>(cycles);
+  }
+
+  auto expired() const noexcept -> bool {
+    return end_cycles_ != std::numeric_limits<uint64_t>::max() &&
+           read_cycle_counter() >= end_cycles_;
+  }
+
+ private:
+  uint64_t end_cycles_;
+};
+
+/**
+ * Hints the core to fetch the cache line of `address` for a read, e.g. the
+ * next node of a traversal, before it is needed
+ */
+inline auto prefetch_read(const void* address) noexcept -> void {
+  __builtin_prefetch(address, 0, 3);
+}
+
+/**
+ * Hints the core to fetch the cache line of `address` in exclusive state, for
+ * a store or CAS that follows, which saves the upgrade of a shared line
+ */
+inline auto prefetch_write(const void* address) noexcept -> void {
+  __builtin_prefetch(address, 1, 3);
+}
+
+#endif  // CPU_H_
@@ -0,0 +1,206 @@
+#ifndef ELIMINATION_H_
+#define ELIMINATION_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "util/atomic_stamped_ptr.h"
+#include "util/backoff.h"
+#include "util/cache_aligned.h"
+#include "util/common.h"
+
+/**
+ * LockFreeExchanger - A slot in which two threads swap items [Her08]
+ *
+ * The first thread to arrive parks its item in the slot and waits; the second
+ * takes it and leaves its own item in return. Either thread gives up if the
+ * other does not show up within its budget.
+ */
+template<typename T>
+class LockFreeExchanger {
+  enum State : uint64_t { EMPTY, WAITING, BUSY };
+
+ public:
+  LockFreeExchanger() : slot_(nullptr, EMPTY) {}
+
+  /**
+   * Offers `my_item` to a partner thread, giving up after `spin_budget` spins
+   *
+   * Counts spins instead of reading the clock, so that a failed rendezvous
+   * costs no more than the spinning itself.
+   *
+   * @param collided set to true if the exchanger was in use by other threads,
+   * i.e., if the attempt failed because of contention rather than for lack of a
+   * partner
+   * @return the partner's item, or std::nullopt if no partner arrived in time
+   */
+  auto try_exchange(T* my_item, size_t spin_budget, bool& collided)
+      -> std::optional<T*> {
+    collided = false;
+    for (size_t spins = 0; spins < spin_budget; spins++) {
+      auto [your_item, stamp] = slot_.get(std::memory_order_acquire);
+      switch (stamp) {
+        case EMPTY:
+          if (slot_.compare_and_swap(your_item, my_item, EMPTY, WAITING,
+                                     std::memory_order_release,
+                                     std::memory_order_relaxed)) {
+            return await_partner(my_item, spin_budget - spins);
+          }
+          collided = true;
+          break;
+        case WAITING:
+          if (slot_.compare_and_swap(your_item, my_item, WAITING, BUSY,
+                                     std::memory_order_release,
+                                     std::memory_order_relaxed)) {
+            return your_item;
+          }
+          collided = true;
+          break;
+        case BUSY:
+          collided = true;
+          break;
+        default:
+          // Impossible
+          break;
+      }
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * Offers `my_item` to a partner thread, waiting at most `timeout_duration`
+   *
+   * @return the partner's item
+   * @throws TimeoutException if no partner arrived in time
+   */
+  template<typename Rep, typename Period>
+  auto exchange(T* my_item,
+                const std::chrono::duration<Rep, Period>& timeout_duration)
+      -> T* {
+    auto time_bound = std::chrono::steady_clock::now() + timeout_duration;
+    bool collided = false;
+    do {
+      if (std::optional<T*> your_item =
+              try_exchange(my_item, kClockCheckInterval, collided)) {
+        return *your_item;
+      }
+    } while (std::chrono::steady_clock::now() < time_bound);
+    throw TimeoutException("Thread waits too long to exchange value");
+  }
+
+ private:
+  // Spins between two reads of the clock in exchange()
+  static constexpr size_t kClockCheckInterval = 256;
+
+  // Waits in the slot for up to `spin_budget` spins after publishing `my_item`
+  auto await_partner(T* my_item, size_t spin_budget) -> std::optional<T*> {
+    for (size_t spins = 0; spins < spin_budget; spins++) {
+      auto [your_item, stamp] = slot_.get(std::memory_order_acquire);
+      if (stamp == BUSY) {
+        // Consume the item and reset the state to EMPTY. Resetting to EMPTY can
+        // be done using a simple write because the waiting thread is the only
+        // one that can change the state from BUSY to EMPTY
+        slot_.set(nullptr, EMPTY, std::memory_order_release);
+        return your_item;
+      }
+      cpu_relax();
+    }
+    if (slot_.compare_and_swap(my_item, nullptr, WAITING, EMPTY,
+                               std::memory_order_release,
+                               std::memory_order_relaxed)) {
+      return std::nullopt;
+    }
+    // A partner arrived after all
+    auto your_item = slot_.get_ptr(std::memory_order_acquire);
+    slot_.set(nullptr, EMPTY, std::memory_order_release);
+    return your_item;
+  }
+
+  AtomicStampedPtr<T> slot_;
+};
+
+/**
+ * EliminationArray - An array of exchangers in which concurrent pushes and pops
+ * meet to cancel out
+ *
+ * Every thread visits a random exchanger among the first `range` ones, where
+ * `range` adapts to the load the thread observes [Hen04]: it doubles when the
+ * thread finds its exchanger in use by others, and halves when the thread
+ * waits in an exchanger without a partner showing up. Under low contention
+ * threads thus concentrate on a few exchangers and meet quickly, and under high
+ * contention they spread out over the whole array.
+ */
+template<typename T>
+class EliminationArray {
+ public:
+  // The number of spins a visit waits for a partner by default
+  static constexpr size_t kDefaultSpinBudget = 1024;
+
+  explicit EliminationArray(size_t capacity,
+                            size_t spin_budget = kDefaultSpinBudget)
+      : exchanger_(capacity), spin_budget_(spin_budget) {}
+
+  /**
+   * Exchanges `value` with a thread that visits the same exchanger
+   *
+   * @return the partner's value, or std::nullopt if no partner arrived
+   */
+  auto visit(T* value) -> std::optional<T*> {
+    // Shared by all arrays of the same type; it only steers the next visit
+    thread_local size_t range = 1;
+    range = std::clamp<size_t>(range, 1, exchanger_.size());
+
+    size_t slot = get_random_int<size_t>(0, range - 1);
+    bool collided = false;
+    std::optional<T*> other =
+        exchanger_[slot]->try_exchange(value, spin_budget_, collided);
+    if (!other.has_value()) {
+      range = collided ? std::min(range * 2, exchanger_.size())
+                       : std::max<size_t>(range / 2, 1);
+    }
+    return other;
+  }
+
+  auto size() const noexcept -> size_t { return exchanger_.size(); }
+
+ private:
+  // Each exchanger is on its own cache line, so that threads meeting in
+  // different slots do not interfere
+  std::vector<CacheAligned<LockFreeExchanger<T>>> exchanger_;
+  const size_t spin_budget_;
+};
+
+/**
+ * NoElimination - The elimination policy of a structure whose operations only
+ * retry on its central CAS point, backing off after each lost race
+ */
+struct NoElimination {
+  static constexpr bool kEnabled = false;
+
+  template<typename T>
+  struct Array {};
+};
+
+/**
+ * WithElimination - The elimination policy of a structure whose operations
+ * visit an EliminationArray of `Capacity` exchangers after each lost race,
+ * waiting up to `SpinBudget` spins for a partner
+ */
+template<size_t Capacity = 4,
+         size_t SpinBudget = EliminationArray<std::byte>::kDefaultSpinBudget>
+struct WithElimination {
+  static constexpr bool kEnabled = true;
+
+  template<typename T>
+  class Array : public EliminationArray<T> {
+   public:
+    Array() : EliminationArray<T>(Capacity, SpinBudget) {}
+  };
+};
+
+#endif  // ELIMINATION_H_
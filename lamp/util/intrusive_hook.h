@@ -0,0 +1,35 @@
+#ifndef INTRUSIVE_HOOK_H_
+#define INTRUSIVE_HOOK_H_
+
+#include "util/atomic_markable_ptr.h"
+
+/**
+ * IntrusiveHook - The link a type needs to be stored in the intrusive
+ * containers (IntrusiveLockFreeQueue, IntrusiveLockFreeStack and
+ * IntrusiveLockFreeList)
+ *
+ * A type derives from the hook, and the containers link its objects through
+ * `next_` instead of allocating a node per item. The mark is only used by
+ * IntrusiveLockFreeList, to flag logically removed nodes. A hook can be linked
+ * into at most one container at a time.
+ */
+struct IntrusiveHook {
+  AtomicMarkablePtr<IntrusiveHook> next_{nullptr, false};
+
+  IntrusiveHook() = default;
+
+  // A copy of a linked object is not linked anywhere
+  IntrusiveHook(const IntrusiveHook&) : IntrusiveHook() {}
+
+  auto operator=(const IntrusiveHook&) -> IntrusiveHook& { return *this; }
+};
+
+/**
+ * NoDisposer - Leaves the nodes an intrusive container is done with to their
+ * owner, for nodes whose memory outlives the container, such as an arena
+ */
+struct NoDisposer {
+  auto operator()(IntrusiveHook*) const -> void {}
+};
+
+#endif  // INTRUSIVE_HOOK_H_
@@ -0,0 +1,74 @@
+#ifndef NODE_VALUE_H_
+#define NODE_VALUE_H_
+
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Items that containers keep in their nodes as a plain value rather than in a
+ * std::optional: trivially copyable types of at most 8 bytes, such as
+ * integers, pointers and handles, which cost nothing to default-construct
+ */
+template<typename T>
+concept InlineValue = std::is_trivially_copyable_v<T> &&
+                      std::is_trivially_default_constructible_v<T> &&
+                      sizeof(T) <= sizeof(uint64_t);
+
+/**
+ * NodeValue - The item of a queue node, which the sentinel node leaves empty
+ *
+ * Holds a std::optional<T> in general, so that `T` need not be
+ * default-constructible. An InlineValue is held as a plain `T` instead, zero in
+ * sentinels, which saves the engaged flag and its padding in every node, and
+ * take() moves it out without checking the flag. Whether a node holds an item
+ * is known from its place in the queue, never from its NodeValue.
+ */
+template<typename T>
+class NodeValue {
+ public:
+  NodeValue() = default;
+
+  template<typename... Args>
+  explicit NodeValue(std::in_place_t, Args&&... args)
+      : value_(std::in_place, std::forward<Args>(args)...) {}
+
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    value_.emplace(std::forward<Args>(args)...);
+  }
+
+  // Destroys the item, if any
+  auto reset() -> void { value_.reset(); }
+
+  // Moves the item out of a node that holds one
+  auto take() -> T { return std::move(*value_); }
+
+ private:
+  std::optional<T> value_{};
+};
+
+template<InlineValue T>
+class NodeValue<T> {
+ public:
+  NodeValue() = default;
+
+  template<typename... Args>
+  explicit NodeValue(std::in_place_t, Args&&... args)
+      : value_(std::forward<Args>(args)...) {}
+
+  template<typename... Args>
+  auto emplace(Args&&... args) -> void {
+    value_ = T(std::forward<Args>(args)...);
+  }
+
+  auto reset() -> void {}
+
+  auto take() -> T { return value_; }
+
+ private:
+  T value_{};
+};
+
+#endif  // NODE_VALUE_H_
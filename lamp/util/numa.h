@@ -0,0 +1,171 @@
+#ifndef NUMA_H_
+#define NUMA_H_
+
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+/**
+ * Parses a Linux CPU or node list such as "0-3,8-11" into its numbers
+ */
+inline auto parse_cpu_list(const std::string& list) -> std::vector<int> {
+  std::vector<int> numbers;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t end = list.find(',', pos);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    std::string range = list.substr(pos, end - pos);
+    size_t dash = range.find('-');
+    try {
+      int first = std::stoi(range.substr(0, dash));
+      int last =
+          dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int n = first; n <= last; n++) {
+        numbers.push_back(n);
+      }
+    } catch (const std::exception&) {
+      // Skip malformed entries, e.g. the trailing newline
+    }
+    pos = end + 1;
+  }
+  return numbers;
+}
+
+/**
+ * NumaMap - The CPUs of each NUMA node, read once from /sys
+ *
+ * Nodes are numbered densely from 0 in the order the kernel lists them. On
+ * systems without /sys/devices/system/node, every CPU is on node 0.
+ */
+class NumaMap {
+ public:
+  static auto instance() -> const NumaMap& {
+    static const NumaMap map;
+    return map;
+  }
+
+  auto node_count() const -> size_t { return node_cpus_.size(); }
+
+  // The CPUs of `node`
+  auto cpus(size_t node) const -> const std::vector<int>& {
+    return node_cpus_[node];
+  }
+
+  // The node of `cpu`, or 0 if it is unknown
+  auto node_of(int cpu) const -> size_t {
+    return cpu >= 0 && static_cast<size_t>(cpu) < cpu_node_.size()
+               ? cpu_node_[cpu]
+               : 0;
+  }
+
+ private:
+  NumaMap() {
+    const std::string kNodeDir = "/sys/devices/system/node/";
+    for (int node : parse_cpu_list(read_line(kNodeDir + "online"))) {
+      std::vector<int> cpus = parse_cpu_list(
+          read_line(kNodeDir + "node" + std::to_string(node) + "/cpulist"));
+      if (cpus.empty()) {
+        continue;  // A memory-only node
+      }
+      for (int cpu : cpus) {
+        if (static_cast<size_t>(cpu) >= cpu_node_.size()) {
+          cpu_node_.resize(cpu + 1, 0);
+        }
+        cpu_node_[cpu] = node_cpus_.size();
+      }
+      node_cpus_.push_back(std::move(cpus));
+    }
+    if (node_cpus_.empty()) {
+      node_cpus_.emplace_back();
+    }
+  }
+
+  static auto read_line(const std::string& path) -> std::string {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+  }
+
+  std::vector<std::vector<int>> node_cpus_;
+  std::vector<size_t> cpu_node_;
+};
+
+/**
+ * Returns the number of NUMA nodes with CPUs, at least 1
+ */
+inline auto numa_node_count() -> size_t {
+  return NumaMap::instance().node_count();
+}
+
+/**
+ * Returns the NUMA node of the CPU the calling thread runs on
+ *
+ * Threads that are not pinned may migrate right after the call, so the
+ * answer is a hint for placement, never a basis for correctness.
+ */
+inline auto this_thread_numa_node() -> size_t {
+#ifdef __linux__
+  return NumaMap::instance().node_of(sched_getcpu());
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Returns the CPU the calling thread runs on, or -1 where it is unknown
+ *
+ * On Linux, sched_getcpu() reads the CPU from the vDSO without a system call.
+ * As with this_thread_numa_node(), the answer is only a placement hint.
+ */
+inline auto this_thread_cpu() -> int {
+#ifdef __linux__
+  return sched_getcpu();
+#else
+  return -1;
+#endif
+}
+
+/**
+ * Restricts the calling thread to run on `cpu` only, so that structures that
+ * place data by CPU (e.g. Sharded with CpuPlacement) keep serving it from the
+ * same shard
+ *
+ * @return true if the thread was pinned, false if the CPU is not available or
+ * the platform does not support affinity
+ */
+inline auto pin_this_thread_to_cpu(int cpu) -> bool {
+#ifdef __linux__
+  if (cpu < 0 || cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+/**
+ * NumaTopology - The Topology policy of the NUMA-aware locks, which groups
+ * threads by the NUMA node they run on
+ */
+struct NumaTopology {
+  static auto node_count() -> size_t { return numa_node_count(); }
+
+  static auto this_thread_node() -> size_t { return this_thread_numa_node(); }
+};
+
+#endif  // NUMA_H_
@@ -0,0 +1,237 @@
+#ifndef SHARDED_H_
+#define SHARDED_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+
+#include "util/cache_aligned.h"
+#include "util/numa.h"
+#include "util/thread_index.h"
+
+/**
+ * ThreadPlacement - The Placement policy of Sharded that gives every thread a
+ * fixed shard, by thread index
+ *
+ * Threads that run at the same time use different shards as long as there are
+ * no more of them than shards.
+ */
+struct ThreadPlacement {
+  static auto this_thread_shard(size_t num_shards) -> size_t {
+    return this_thread_index() % num_shards;
+  }
+};
+
+/**
+ * CpuPlacement - The Placement policy of Sharded that picks the shard of the
+ * CPU the calling thread runs on
+ *
+ * Threads on the same core share a shard and its cache lines, however many
+ * threads there are. A thread that migrates moves to another shard, which is
+ * correct but costs cache misses; pin_this_thread_to_cpu() avoids that.
+ */
+struct CpuPlacement {
+  static auto this_thread_shard(size_t num_shards) -> size_t {
+    int cpu = this_thread_cpu();
+    return cpu >= 0 ? static_cast<size_t>(cpu) % num_shards
+                    : this_thread_index() % num_shards;
+  }
+};
+
+/**
+ * ShardHash - The default Hash of Sharded, std::hash of whatever item the
+ * operation is given
+ */
+struct ShardHash {
+  template<typename U>
+  auto operator()(const U& item) const -> size_t {
+    return std::hash<U>{}(item);
+  }
+};
+
+/**
+ * Sharded - `N` independent instances of the container `C`, for workloads that
+ * need no order or atomicity across all items
+ *
+ * Every shard occupies its own cache lines. Operations on an item (add(),
+ * remove(), contains()) go to the shard chosen by the item's hash, so that
+ * every item lives in exactly one shard and sets stay sets. Operations without
+ * an item (enqueue(), push()) go to the calling thread's shard, chosen by
+ * `Placement` (ThreadPlacement or CpuPlacement), and removals (try_dequeue(),
+ * try_pop()) try that shard first and then steal from the others. Threads
+ * that stay on their own shard never contend, so throughput scales with the
+ * number of shards, at the price of FIFO or LIFO order holding only within a
+ * shard.
+ *
+ * Every operation is available when `C` provides it. size(), approx_size()
+ * and for_each() combine the shards one after the other, so they are not a
+ * snapshot: items added or removed concurrently may or may not be counted or
+ * visited.
+ */
+template<typename C, size_t N, typename Placement = CpuPlacement,
+         typename Hash = ShardHash>
+class Sharded {
+  static_assert(N > 0, "Sharded needs at least one shard");
+
+ public:
+  static constexpr size_t kNumShards = N;
+
+  Sharded() = default;
+
+  Sharded(const Sharded&) = delete;
+  auto operator=(const Sharded&) -> Sharded& = delete;
+
+  auto shard(size_t index) -> C& { return *shards_[index]; }
+
+  /**
+   * Returns the shard that holds `item`
+   */
+  template<typename U>
+  auto shard_for(const U& item) -> C& {
+    // Multiplicative mixing, so that the shard does not depend on the same
+    // low bits by which a hash-ordered shard sorts its items
+    uint64_t hash = static_cast<uint64_t>(hash_(item)) * 0x9e3779b97f4a7c15;
+    return *shards_[(hash >> 32) % N];
+  }
+
+  /**
+   * Returns the calling thread's shard
+   */
+  auto local() -> C& { return *shards_[Placement::this_thread_shard(N)]; }
+
+  template<typename U>
+  auto add(U&& item) -> bool
+    requires requires(C& c) { c.add(std::forward<U>(item)); }
+  {
+    return shard_for(item).add(std::forward<U>(item));
+  }
+
+  template<typename U>
+  auto remove(const U& item) -> bool
+    requires requires(C& c) { c.remove(item); }
+  {
+    return shard_for(item).remove(item);
+  }
+
+  template<typename U>
+  auto contains(const U& item) -> bool
+    requires requires(C& c) { c.contains(item); }
+  {
+    return shard_for(item).contains(item);
+  }
+
+  template<typename U>
+  auto enqueue(U&& item) -> void
+    requires requires(C& c) { c.enqueue(std::forward<U>(item)); }
+  {
+    local().enqueue(std::forward<U>(item));
+  }
+
+  /**
+   * Dequeues from the calling thread's shard, or else from the first other
+   * shard that is not empty
+   *
+   * @return the item, or std::nullopt if every shard was empty when visited
+   */
+  auto try_dequeue()
+    requires requires(C& c) { c.try_dequeue(); }
+  {
+    return steal([](C& c) { return c.try_dequeue(); });
+  }
+
+  template<typename U>
+  auto push(U&& item) -> void
+    requires requires(C& c) { c.push(std::forward<U>(item)); }
+  {
+    local().push(std::forward<U>(item));
+  }
+
+  /**
+   * Pops from the calling thread's shard, or else from the first other shard
+   * that is not empty
+   *
+   * @return true if `value` received an item
+   */
+  template<typename U>
+  auto try_pop(U& value) -> bool
+    requires requires(C& c) { c.try_pop(value); }
+  {
+    return steal([&value](C& c) -> std::optional<bool> {
+             return c.try_pop(value) ? std::optional<bool>(true)
+                                     : std::nullopt;
+           })
+        .has_value();
+  }
+
+  /**
+   * Calls `fn(item)` for every item of every shard, shard by shard
+   */
+  template<typename Fn>
+  auto for_each(Fn&& fn) -> void
+    requires requires(C& c) { c.begin() != c.end(); }
+  {
+    for (auto& shard : shards_) {
+      for (const auto& item : *shard) {
+        fn(item);
+      }
+    }
+  }
+
+  /**
+   * The number of items in all shards, from their size() or else by counting
+   * the items of each shard
+   */
+  auto size() -> size_t
+    requires requires(C& c) { c.size(); } ||
+             requires(C& c) { c.begin() != c.end(); }
+  {
+    size_t total = 0;
+    for (auto& shard : shards_) {
+      if constexpr (requires(C& c) { c.size(); }) {
+        total += shard->size();
+      } else {
+        for (auto it = shard->begin(); it != shard->end(); ++it) {
+          total++;
+        }
+      }
+    }
+    return total;
+  }
+
+  /**
+   * The sum of the approx_size() of the shards, which reads their counters
+   * without traversing them
+   */
+  auto approx_size() const -> size_t
+    requires requires(const C& c) { c.approx_size(); }
+  {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+      total += shard->approx_size();
+    }
+    return total;
+  }
+
+ private:
+  // Applies `try_remove` to the local shard and then to the others in turn,
+  // until it returns an item
+  template<typename TryRemove>
+  auto steal(TryRemove try_remove) {
+    size_t first = Placement::this_thread_shard(N);
+    for (size_t i = 0; i < N; i++) {
+      auto item = try_remove(*shards_[(first + i) % N]);
+      if (item.has_value()) {
+        return item;
+      }
+    }
+    return decltype(try_remove(*shards_[0])){};
+  }
+
+  std::array<CacheAligned<C>, N> shards_{};
+  [[no_unique_address]] Hash hash_{};
+};
+
+#endif  // SHARDED_H_
@@ -0,0 +1,142 @@
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * Contention statistics, compiled in with -DLAMP_STATS
+ *
+ * The locks, wait policies and lock-free structures count the events below
+ * with LAMP_STAT_INC / LAMP_STAT_ADD. Without LAMP_STATS the macros expand to
+ * nothing, so the instrumented code is the same as without them. The macro
+ * must be defined for the whole program, since the instrumented headers
+ * compile differently with and without it.
+ *
+ * Every thread counts into its own counters, which only it writes, so the hot
+ * path touches no shared cache line. Stats::snapshot() sums the counters of
+ * all live threads and of the threads that have exited; the difference of two
+ * snapshots covers the work in between.
+ */
+enum class Stat : size_t {
+  kAcquisitions,           // locks acquired with lock()
+  kContendedAcquisitions,  // acquisitions that found the lock taken
+  kSpins,                  // repeated reads of a flag by a waiting thread
+  kParks,                  // waits that put the thread to sleep
+  kCasFailures,            // lock-free operations retried after a failed CAS
+  kEliminations,           // pushes and pops done in an elimination array
+  kFindRestarts,           // list traversals restarted from the head
+  kTransactionAborts,      // aborted lock elisions and STM transactions
+  kCount,
+};
+
+/**
+ * StatsSnapshot - The totals of every Stat at one point in time
+ */
+class StatsSnapshot {
+ public:
+  auto operator[](Stat stat) const noexcept -> uint64_t {
+    return counts_[static_cast<size_t>(stat)];
+  }
+
+  auto operator[](Stat stat) noexcept -> uint64_t& {
+    return counts_[static_cast<size_t>(stat)];
+  }
+
+  // The events between `earlier` and this snapshot
+  auto operator-(const StatsSnapshot& earlier) const noexcept
+      -> StatsSnapshot {
+    StatsSnapshot delta;
+    for (size_t i = 0; i < kNumStats; i++) {
+      delta.counts_[i] = counts_[i] - earlier.counts_[i];
+    }
+    return delta;
+  }
+
+ private:
+  static constexpr size_t kNumStats = static_cast<size_t>(Stat::kCount);
+
+  std::array<uint64_t, kNumStats> counts_{};
+};
+
+/**
+ * Stats - The per-thread counters behind the LAMP_STAT macros
+ */
+class Stats {
+  static constexpr size_t kNumStats = static_cast<size_t>(Stat::kCount);
+
+  // Written by its thread only, with relaxed atomics so that snapshot() may
+  // read them at any time
+  struct ThreadCounters {
+    std::array<std::atomic<uint64_t>, kNumStats> counts_{};
+
+    ThreadCounters() { registry().add(this); }
+
+    ~ThreadCounters() { registry().remove(this); }
+  };
+
+  struct Registry {
+    std::mutex mutex_;
+    std::vector<ThreadCounters*> threads_;
+    // The counts of the threads that have exited
+    StatsSnapshot retired_;
+
+    auto add(ThreadCounters* counters) -> void {
+      std::lock_guard<std::mutex> guard(mutex_);
+      threads_.push_back(counters);
+    }
+
+    auto remove(ThreadCounters* counters) -> void {
+      std::lock_guard<std::mutex> guard(mutex_);
+      for (size_t i = 0; i < kNumStats; i++) {
+        retired_[static_cast<Stat>(i)] +=
+            counters->counts_[i].load(std::memory_order_relaxed);
+      }
+      std::erase(threads_, counters);
+    }
+  };
+
+  static auto registry() -> Registry& {
+    static Registry registry;
+    return registry;
+  }
+
+  static auto local() -> ThreadCounters& {
+    thread_local ThreadCounters counters;
+    return counters;
+  }
+
+ public:
+  static auto add(Stat stat, uint64_t n) noexcept -> void {
+    std::atomic<uint64_t>& count = local().counts_[static_cast<size_t>(stat)];
+    count.store(count.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+  }
+
+  static auto snapshot() -> StatsSnapshot {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.mutex_);
+    StatsSnapshot totals = reg.retired_;
+    for (ThreadCounters* counters : reg.threads_) {
+      for (size_t i = 0; i < kNumStats; i++) {
+        totals[static_cast<Stat>(i)] +=
+            counters->counts_[i].load(std::memory_order_relaxed);
+      }
+    }
+    return totals;
+  }
+};
+
+#ifdef LAMP_STATS
+#define LAMP_STAT_ADD(stat, n) Stats::add(stat, n)
+#else
+#define LAMP_STAT_ADD(stat, n) ((void)0)
+#endif
+
+#define LAMP_STAT_INC(stat) LAMP_STAT_ADD(stat, 1)
+
+#endif  // STATS_H_
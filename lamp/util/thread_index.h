@@ -0,0 +1,20 @@
+#ifndef THREAD_INDEX_H_
+#define THREAD_INDEX_H_
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * A small index of the calling thread, assigned on first use. Indices are
+ * handed out in order and never reused, so threads that run at the same time
+ * have distinct indices, and structures can spread threads over `n` slots
+ * with `this_thread_index() % n`.
+ */
+inline auto this_thread_index() -> size_t {
+  static std::atomic<size_t> next_index{0};
+  thread_local size_t index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+#endif  // THREAD_INDEX_H_
@@ -0,0 +1,102 @@
+#include "coroutine/async_mutex.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "coroutine/executor.h"
+#include "gtest/gtest.h"
+#include "scheduler/executor.h"
+#include "scheduler/work_stealing_pool.h"
+
+TEST(AsyncMutexTest, TryLock) {
+  AsyncMutex mutex;
+  EXPECT_TRUE(mutex.try_lock());
+  EXPECT_FALSE(mutex.try_lock());
+  mutex.unlock();
+  EXPECT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+// With the inline executor, unlock() runs the waiters itself, oldest first
+TEST(AsyncMutexTest, WaitersResumeInFifoOrder) {
+  AsyncMutex mutex;
+  std::vector<int> order;
+  auto waiter = [&](int id) -> DetachedTask {
+    co_await mutex.lock();
+    order.push_back(id);
+    mutex.unlock();
+  };
+
+  ASSERT_TRUE(mutex.try_lock());
+  for (int i = 0; i < 5; i++) {
+    waiter(i);
+  }
+  EXPECT_TRUE(order.empty());
+  mutex.unlock();
+  EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3, 4}));
+  EXPECT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+// Thousands of coroutines contend for the mutex on a pool of two threads
+TEST(AsyncMutexTest, ManyCoroutinesOnFewThreads) {
+  constexpr int kNumCoroutines = 2000;
+  constexpr int kNumIterations = 20;
+  WorkStealingPool pool(2);
+  AsyncMutex mutex(pool);
+  int counter = 0;
+  std::atomic<int> num_done{0};
+
+  auto worker = [&]() -> DetachedTask {
+    co_await resume_on(pool);
+    for (int i = 0; i < kNumIterations; i++) {
+      co_await mutex.lock();
+      int prev = counter;
+      co_await resume_on(pool);
+      counter = prev + 1;
+      mutex.unlock();
+    }
+    num_done.fetch_add(1);
+  };
+  for (int i = 0; i < kNumCoroutines; i++) {
+    worker();
+  }
+  while (num_done.load() < kNumCoroutines) {
+    std::this_thread::yield();
+  }
+  pool.wait_idle();
+
+  EXPECT_EQ(counter, kNumCoroutines * kNumIterations);
+}
+
+// The primitives resume coroutines on an Executor as on any TaskExecutor
+TEST(AsyncMutexTest, ResumesOnExecutor) {
+  constexpr int kNumCoroutines = 500;
+  constexpr int kNumIterations = 20;
+  Executor<> executor(2);
+  AsyncMutex mutex(executor);
+  int counter = 0;
+  std::atomic<int> num_done{0};
+
+  auto worker = [&]() -> DetachedTask {
+    co_await resume_on(executor);
+    for (int i = 0; i < kNumIterations; i++) {
+      co_await mutex.lock();
+      int prev = counter;
+      co_await resume_on(executor);
+      counter = prev + 1;
+      mutex.unlock();
+    }
+    num_done.fetch_add(1);
+  };
+  for (int i = 0; i < kNumCoroutines; i++) {
+    worker();
+  }
+  while (num_done.load() < kNumCoroutines) {
+    std::this_thread::yield();
+  }
+  executor.wait_idle();
+
+  EXPECT_EQ(counter, kNumCoroutines * kNumIterations);
+}
@@ -0,0 +1,92 @@
+#include "coroutine/async_queue.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "coroutine/executor.h"
+#include "gtest/gtest.h"
+#include "scheduler/work_stealing_pool.h"
+
+TEST(AsyncQueueTest, TryOperations) {
+  AsyncQueue<int> queue(2);
+  EXPECT_EQ(queue.try_dequeue(), std::nullopt);
+  EXPECT_TRUE(queue.try_enqueue(1));
+  EXPECT_TRUE(queue.try_enqueue(2));
+  EXPECT_FALSE(queue.try_enqueue(3));
+  EXPECT_EQ(queue.try_dequeue(), 1);
+  EXPECT_EQ(queue.try_dequeue(), 2);
+  EXPECT_EQ(queue.try_dequeue(), std::nullopt);
+}
+
+TEST(AsyncQueueTest, DequeueWaitsForAnItem) {
+  AsyncQueue<int> queue;
+  std::vector<int> received;
+  auto consumer = [&]() -> DetachedTask {
+    for (int i = 0; i < 3; i++) {
+      received.push_back(co_await queue.async_dequeue());
+    }
+  };
+
+  consumer();
+  EXPECT_TRUE(received.empty());
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(queue.try_enqueue(i));
+  }
+  EXPECT_EQ(received, (std::vector<int>{0, 1, 2}));
+}
+
+TEST(AsyncQueueTest, EnqueueWaitsForASlot) {
+  AsyncQueue<int> queue(1);
+  bool enqueued = false;
+  auto producer = [&]() -> DetachedTask {
+    co_await queue.async_enqueue(1);
+    co_await queue.async_enqueue(2);
+    enqueued = true;
+  };
+
+  producer();
+  EXPECT_FALSE(enqueued);
+  EXPECT_EQ(queue.try_dequeue(), 1);
+  EXPECT_TRUE(enqueued);
+  EXPECT_EQ(queue.try_dequeue(), 2);
+}
+
+// Many producer and consumer coroutines share a small pool through a queue
+// with little room
+TEST(AsyncQueueTest, ProducersAndConsumersOnAPool) {
+  constexpr int kNumProducers = 200;
+  constexpr int kNumConsumers = 200;
+  constexpr int kItemsPerProducer = 50;
+  WorkStealingPool pool(2);
+  AsyncQueue<int> queue(8, pool);
+  std::atomic<long> sum{0};
+  std::atomic<int> num_done{0};
+
+  auto producer = [&](int id) -> DetachedTask {
+    co_await resume_on(pool);
+    for (int i = 0; i < kItemsPerProducer; i++) {
+      co_await queue.async_enqueue(id * kItemsPerProducer + i);
+    }
+    num_done.fetch_add(1);
+  };
+  auto consumer = [&]() -> DetachedTask {
+    co_await resume_on(pool);
+    for (int i = 0; i < kItemsPerProducer; i++) {
+      sum.fetch_add(co_await queue.async_dequeue());
+    }
+    num_done.fetch_add(1);
+  };
+  for (int i = 0; i < kNumProducers; i++) {
+    producer(i);
+    consumer();
+  }
+  while (num_done.load() < kNumProducers + kNumConsumers) {
+    std::this_thread::yield();
+  }
+  pool.wait_idle();
+
+  constexpr long kNumItems = kNumProducers * kItemsPerProducer;
+  EXPECT_EQ(sum.load(), kNumItems * (kNumItems - 1) / 2);
+  EXPECT_EQ(queue.try_dequeue(), std::nullopt);
+}
@@ -0,0 +1,73 @@
+#include "coroutine/async_semaphore.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "coroutine/executor.h"
+#include "gtest/gtest.h"
+#include "scheduler/work_stealing_pool.h"
+
+TEST(AsyncSemaphoreTest, TryAcquire) {
+  AsyncSemaphore semaphore(2);
+  EXPECT_TRUE(semaphore.try_acquire());
+  EXPECT_TRUE(semaphore.try_acquire());
+  EXPECT_FALSE(semaphore.try_acquire());
+  semaphore.release();
+  EXPECT_TRUE(semaphore.try_acquire());
+}
+
+TEST(AsyncSemaphoreTest, ReleaseResumesWaiters) {
+  AsyncSemaphore semaphore(0);
+  int num_acquired = 0;
+  auto waiter = [&]() -> DetachedTask {
+    co_await semaphore.async_acquire();
+    num_acquired++;
+  };
+
+  for (int i = 0; i < 3; i++) {
+    waiter();
+  }
+  EXPECT_EQ(num_acquired, 0);
+  EXPECT_EQ(semaphore.get_value(), -3);
+
+  semaphore.release(2);
+  EXPECT_EQ(num_acquired, 2);
+  semaphore.release(2);
+  EXPECT_EQ(num_acquired, 3);
+  EXPECT_EQ(semaphore.get_value(), 1);
+}
+
+// At most `kPermits` of many coroutines on a small pool hold a permit at once
+TEST(AsyncSemaphoreTest, BoundsConcurrency) {
+  constexpr int kPermits = 3;
+  constexpr int kNumCoroutines = 2000;
+  WorkStealingPool pool(2);
+  AsyncSemaphore semaphore(kPermits, pool);
+  std::atomic<int> holders{0};
+  std::atomic<int> max_holders{0};
+  std::atomic<int> num_done{0};
+
+  auto worker = [&]() -> DetachedTask {
+    co_await resume_on(pool);
+    co_await semaphore.async_acquire();
+    int now = holders.fetch_add(1) + 1;
+    int max = max_holders.load();
+    while (now > max && !max_holders.compare_exchange_weak(max, now)) {
+    }
+    co_await resume_on(pool);
+    holders.fetch_sub(1);
+    semaphore.release();
+    num_done.fetch_add(1);
+  };
+  for (int i = 0; i < kNumCoroutines; i++) {
+    worker();
+  }
+  while (num_done.load() < kNumCoroutines) {
+    std::this_thread::yield();
+  }
+  pool.wait_idle();
+
+  EXPECT_LE(max_holders.load(), kPermits);
+  EXPECT_EQ(semaphore.get_value(), kPermits);
+}
@@ -0,0 +1,65 @@
+#include "counting/combining_tree.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// Normal Cases
+
+// Test that a single thread counts up from zero.
+TEST(CombiningTreeTest, SequentialIncrements) {
+  CombiningTree tree(8);
+  for (int64_t i = 0; i < 100; i++) {
+    EXPECT_EQ(tree.get_and_increment(), i);
+  }
+  EXPECT_EQ(tree.get(), 100);
+}
+
+// Edge Cases
+
+// Test that the smallest tree, a single root, still counts.
+TEST(CombiningTreeTest, SingleNodeTree) {
+  CombiningTree tree(1);
+  EXPECT_EQ(tree.get_and_increment(), 0);
+  EXPECT_EQ(tree.get_and_increment(), 1);
+}
+
+// Concurrent Operations
+
+// Test that concurrent threads get exactly the values 0 .. n - 1, also when
+// more threads than the width share the leaves.
+TEST(CombiningTreeTest, ConcurrentIncrementsAreDistinct) {
+  for (size_t width : {4, 8}) {
+    constexpr int kNumThreads = 8;
+    constexpr int kNumOps = 5000;
+    CombiningTree tree(width);
+
+    std::vector<std::vector<int64_t>> values(kNumThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&tree, &values, t]() {
+        for (int i = 0; i < kNumOps; i++) {
+          values[t].push_back(tree.get_and_increment());
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    std::vector<int64_t> all;
+    for (auto& thread_values : values) {
+      // Linearizable: each thread sees increasing values
+      EXPECT_TRUE(std::is_sorted(thread_values.begin(), thread_values.end()));
+      all.insert(all.end(), thread_values.begin(), thread_values.end());
+    }
+    std::sort(all.begin(), all.end());
+    for (int64_t i = 0; i < kNumThreads * kNumOps; i++) {
+      ASSERT_EQ(all[i], i);
+    }
+    EXPECT_EQ(tree.get(), kNumThreads * kNumOps);
+  }
+}
@@ -0,0 +1,72 @@
+#include "counting/counting_network.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+template<typename Network>
+class CountingNetworkTest : public ::testing::Test {};
+
+using Networks = ::testing::Types<Bitonic, Periodic>;
+TYPED_TEST_SUITE(CountingNetworkTest, Networks);
+
+// Normal Cases
+
+// Test the step property: tokens entering on arbitrary wires leave evenly
+// spread over the output wires, top wires first.
+TYPED_TEST(CountingNetworkTest, StepProperty) {
+  for (size_t width : {2, 4, 8, 16}) {
+    TypeParam network(width);
+    std::vector<int> outputs(width, 0);
+    for (size_t i = 0; i < 5 * width + 3; i++) {
+      outputs[network.traverse((i * 7) % width)]++;
+      for (size_t j = 1; j < width; j++) {
+        EXPECT_LE(outputs[j], outputs[j - 1]);
+        EXPECT_LE(outputs[0] - outputs[j], 1);
+      }
+    }
+  }
+}
+
+// Test that a single thread counts up from zero.
+TYPED_TEST(CountingNetworkTest, SequentialIncrements) {
+  CountingNetwork<TypeParam> counter(8);
+  EXPECT_EQ(counter.width(), 8U);
+  for (int64_t i = 0; i < 100; i++) {
+    EXPECT_EQ(counter.get_and_increment(), i);
+  }
+}
+
+// Concurrent Operations
+
+// Test that once quiescent, concurrent threads got exactly 0 .. n - 1.
+TYPED_TEST(CountingNetworkTest, ConcurrentIncrementsAreDistinct) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumOps = 5000;
+  CountingNetwork<TypeParam> counter(4);
+
+  std::vector<std::vector<int64_t>> values(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&counter, &values, t]() {
+      for (int i = 0; i < kNumOps; i++) {
+        values[t].push_back(counter.get_and_increment());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<int64_t> all;
+  for (auto& thread_values : values) {
+    all.insert(all.end(), thread_values.begin(), thread_values.end());
+  }
+  std::sort(all.begin(), all.end());
+  for (int64_t i = 0; i < kNumThreads * kNumOps; i++) {
+    ASSERT_EQ(all[i], i);
+  }
+}
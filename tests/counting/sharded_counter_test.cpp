@@ -0,0 +1,95 @@
+#include "counting/sharded_counter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// Normal Cases
+
+// Test that the total adds up the increments of every thread.
+TEST(ShardedCounterTest, TotalOfConcurrentIncrements) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumOps = 10000;
+  ShardedCounter counter(4);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&counter]() {
+      for (int i = 0; i < kNumOps; i++) {
+        counter.increment();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(counter.get(), kNumThreads * kNumOps);
+}
+
+// Test that deltas of either sign from many threads add up, as when the
+// counter tracks the size of a container.
+TEST(ShardedCounterTest, AddDeltas) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumOps = 10000;
+  ShardedCounter counter(4);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&counter]() {
+      for (int i = 0; i < kNumOps; i++) {
+        counter.add(3);
+        counter.add(-1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(counter.get(), 2 * kNumThreads * kNumOps);
+}
+
+// Edge Cases
+
+// Test that a single shard behaves like a plain counter.
+TEST(ShardedCounterTest, SingleShard) {
+  ShardedCounter counter(1);
+  for (int64_t i = 0; i < 10; i++) {
+    EXPECT_EQ(counter.get_and_increment(), i);
+  }
+  EXPECT_EQ(counter.get(), 10);
+}
+
+// Concurrent Operations
+
+// Test that concurrent get_and_increment() calls return distinct values.
+TEST(ShardedCounterTest, ConcurrentValuesAreDistinct) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumOps = 5000;
+  ShardedCounter counter(4);
+
+  std::vector<std::vector<int64_t>> values(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&counter, &values, t]() {
+      for (int i = 0; i < kNumOps; i++) {
+        values[t].push_back(counter.get_and_increment());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<int64_t> all;
+  for (auto& thread_values : values) {
+    all.insert(all.end(), thread_values.begin(), thread_values.end());
+  }
+  std::sort(all.begin(), all.end());
+  EXPECT_EQ(std::adjacent_find(all.begin(), all.end()), all.end());
+  EXPECT_EQ(counter.get(), kNumThreads * kNumOps);
+}
@@ -0,0 +1,123 @@
+#include "deque/work_stealing_deque.h"
+
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "memory/garbage_list.h"
+
+class WorkStealingDequeTest : public ::testing::Test {
+ protected:
+  void SetUp() override { deque_ = std::make_unique<WorkStealingDeque<int>>(); }
+
+  std::unique_ptr<WorkStealingDeque<int>> deque_;
+};
+
+// Test that the owner pops the items in LIFO order
+TEST_F(WorkStealingDequeTest, PopIsLifo) {
+  EXPECT_FALSE(deque_->pop().has_value());
+  for (int i = 0; i < 10; i++) {
+    deque_->push(i);
+  }
+  EXPECT_EQ(deque_->size(), 10);
+  for (int i = 9; i >= 0; i--) {
+    EXPECT_EQ(deque_->pop(), i);
+  }
+  EXPECT_FALSE(deque_->pop().has_value());
+  EXPECT_TRUE(deque_->empty());
+}
+
+// Test that thieves steal the items in FIFO order
+TEST_F(WorkStealingDequeTest, StealIsFifo) {
+  EXPECT_FALSE(deque_->steal().has_value());
+  for (int i = 0; i < 10; i++) {
+    deque_->push(i);
+  }
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(deque_->steal(), i);
+  }
+  EXPECT_FALSE(deque_->steal().has_value());
+}
+
+// Test that popping and stealing meet in the middle
+TEST_F(WorkStealingDequeTest, PopAndStealFromBothEnds) {
+  for (int i = 0; i < 4; i++) {
+    deque_->push(i);
+  }
+  EXPECT_EQ(deque_->steal(), 0);
+  EXPECT_EQ(deque_->pop(), 3);
+  EXPECT_EQ(deque_->steal(), 1);
+  EXPECT_EQ(deque_->pop(), 2);
+  EXPECT_FALSE(deque_->pop().has_value());
+  EXPECT_FALSE(deque_->steal().has_value());
+}
+
+// Test that the array grows and keeps the items in order
+TEST_F(WorkStealingDequeTest, GrowsWhenFull) {
+  WorkStealingDeque<int> deque(2);
+  EXPECT_EQ(deque.capacity(), 2);
+
+  // Move the top, so the items wrap around the array when it grows
+  deque.push(-1);
+  EXPECT_EQ(deque.steal(), -1);
+  for (int i = 0; i < 100; i++) {
+    deque.push(i);
+  }
+  EXPECT_GE(deque.capacity(), 100);
+  EXPECT_EQ(deque.steal(), 0);
+  for (int i = 99; i >= 1; i--) {
+    EXPECT_EQ(deque.pop(), i);
+  }
+}
+
+// Test that the deque works with another reclaimer
+TEST_F(WorkStealingDequeTest, GarbageListReclaimer) {
+  WorkStealingDeque<int, GarbageList> deque(2);
+  for (int i = 0; i < 100; i++) {
+    deque.push(i);
+  }
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(deque.steal(), i);
+  }
+}
+
+// Test that every item is taken exactly once while thieves race the owner,
+// including while the array grows
+TEST_F(WorkStealingDequeTest, ConcurrentPopAndSteal) {
+  constexpr int kNumThieves = 3;
+  constexpr int kNumItems = 100000;
+  WorkStealingDeque<int> deque(2);
+
+  std::vector<std::atomic<int>> taken(kNumItems);
+  std::atomic<bool> done{false};
+  std::vector<std::thread> thieves;
+  for (int t = 0; t < kNumThieves; t++) {
+    thieves.emplace_back([&deque, &taken, &done]() {
+      while (!done.load() || !deque.empty()) {
+        if (std::optional<int> item = deque.steal()) {
+          taken[*item]++;
+        }
+      }
+    });
+  }
+
+  // The owner pops one item for every two it pushes
+  for (int i = 0; i < kNumItems; i++) {
+    deque.push(i);
+    if (i % 2 == 1) {
+      if (std::optional<int> item = deque.pop()) {
+        taken[*item]++;
+      }
+    }
+  }
+  done = true;
+  for (auto& thief : thieves) {
+    thief.join();
+  }
+
+  for (const auto& count : taken) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
@@ -0,0 +1,226 @@
+#include "hash/lock_free_hash_map.h"
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// Sends every key to the same probe sequence, so claims probe far
+struct ConstantHash {
+  auto operator()(int) const -> size_t { return 0; }
+};
+
+TEST(LockFreeHashMapTest, EmptyMapFindReturnsNothing) {
+  LockFreeHashMap<int, int> map;
+  EXPECT_FALSE(map.find(1).has_value());
+  EXPECT_FALSE(map.contains(1));
+  EXPECT_FALSE(map.erase(1));
+}
+
+TEST(LockFreeHashMapTest, InsertOrAssign) {
+  LockFreeHashMap<int, int> map;
+  EXPECT_TRUE(map.insert_or_assign(1, 10));
+  EXPECT_EQ(map.find(1), 10);
+  EXPECT_FALSE(map.insert_or_assign(1, 11));
+  EXPECT_EQ(map.find(1), 11);
+  // Values that are reserved for 8-byte types are fine for 4-byte ones
+  EXPECT_TRUE(map.insert_or_assign(-1, -1));
+  EXPECT_EQ(map.find(-1), -1);
+}
+
+TEST(LockFreeHashMapTest, InsertKeepsExistingValue) {
+  LockFreeHashMap<int, int> map;
+  EXPECT_TRUE(map.insert(1, 10));
+  EXPECT_FALSE(map.insert(1, 11));
+  EXPECT_EQ(map.find(1), 10);
+}
+
+TEST(LockFreeHashMapTest, Erase) {
+  LockFreeHashMap<int, int> map;
+  EXPECT_TRUE(map.insert_or_assign(1, 10));
+  EXPECT_TRUE(map.erase(1));
+  EXPECT_FALSE(map.erase(1));
+  EXPECT_FALSE(map.contains(1));
+  // The key reuses its slot
+  EXPECT_TRUE(map.insert(1, 12));
+  EXPECT_EQ(map.find(1), 12);
+}
+
+TEST(LockFreeHashMapTest, PointerValues) {
+  LockFreeHashMap<uint64_t, const int*> map;
+  int value = 7;
+  EXPECT_TRUE(map.insert(UINT64_MAX - 1, &value));
+  EXPECT_EQ(*map.find(UINT64_MAX - 1).value(), 7);
+}
+
+TEST(LockFreeHashMapTest, GrowsAndKeepsAllEntries) {
+  constexpr int kNumKeys = 100000;
+  LockFreeHashMap<int, int> map;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_TRUE(map.insert_or_assign(i, i * 2));
+  }
+  EXPECT_GE(map.capacity(), 2u * kNumKeys);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(map.find(i), i * 2);
+  }
+  for (int i = 0; i < kNumKeys; i += 2) {
+    ASSERT_TRUE(map.erase(i));
+  }
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(map.contains(i), i % 2 == 1);
+  }
+}
+
+TEST(LockFreeHashMapTest, TombstonesAreDroppedByResizes) {
+  // Inserting and erasing ever new keys fills the table with tombstones, which
+  // resizes must clear without growing the table
+  LockFreeHashMap<int, int> map;
+  for (int i = 0; i < 100000; i++) {
+    ASSERT_TRUE(map.insert(i, i));
+    ASSERT_TRUE(map.erase(i));
+  }
+  EXPECT_LE(map.capacity(), 64u);
+}
+
+TEST(LockFreeHashMapTest, CollidingKeysKeepAllEntries) {
+  LockFreeHashMap<int, int, ConstantHash> map;
+  for (int i = 0; i < 500; i++) {
+    ASSERT_TRUE(map.insert(i, i));
+  }
+  for (int i = 0; i < 500; i++) {
+    ASSERT_EQ(map.find(i), i);
+  }
+}
+
+TEST(LockFreeHashMapTest, ConcurrentInsertsOfDistinctKeys) {
+  // Threads insert interleaved keys from an empty map, so they resize it many
+  // times while others are inserting
+  constexpr int kNumThreads = 4;
+  constexpr int kKeysPerThread = 50000;
+  LockFreeHashMap<int, int> map;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&map, t]() {
+      for (int i = 0; i < kKeysPerThread; i++) {
+        int key = i * kNumThreads + t;
+        EXPECT_TRUE(map.insert(key, key + 1));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int key = 0; key < kNumThreads * kKeysPerThread; key++) {
+    ASSERT_EQ(map.find(key), key + 1);
+  }
+}
+
+TEST(LockFreeHashMapTest, ConcurrentUpdatesDuringResizes) {
+  // Each thread owns a set of keys and tracks what it last wrote to each,
+  // while the other threads grow the map underneath it; no update may be lost
+  // or resurrected by a migration
+  constexpr int kNumThreads = 4;
+  constexpr int kKeysPerThread = 1000;
+  constexpr int kOpsPerThread = 100000;
+  LockFreeHashMap<int, int> map;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&map, t]() {
+      std::mt19937 gen(t);
+      std::vector<int> expected(kKeysPerThread, -1);
+      int next_filler = (t + 1) * 1000000;
+      for (int i = 0; i < kOpsPerThread; i++) {
+        int index = static_cast<int>(gen() % kKeysPerThread);
+        int key = index * kNumThreads + t;
+        switch (gen() % 4) {
+          case 0:
+            EXPECT_EQ(map.insert_or_assign(key, i), expected[index] == -1);
+            expected[index] = i;
+            break;
+          case 1:
+            EXPECT_EQ(map.erase(key), expected[index] != -1);
+            expected[index] = -1;
+            break;
+          case 2: {
+            std::optional<int> value = map.find(key);
+            EXPECT_EQ(value.value_or(-1), expected[index]);
+            break;
+          }
+          case 3:
+            // Keys nobody erases, to keep the map growing
+            map.insert(next_filler++, 0);
+            break;
+        }
+      }
+      for (int index = 0; index < kKeysPerThread; index++) {
+        EXPECT_EQ(map.find(index * kNumThreads + t).value_or(-1),
+                  expected[index]);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(LockFreeHashMapTest, ConcurrentInsertsOfSameKeys) {
+  // For every key exactly one insert wins, and its value is the one found
+  constexpr int kNumThreads = 4;
+  constexpr int kNumKeys = 20000;
+  LockFreeHashMap<int, int> map;
+  std::vector<std::atomic<int>> winners(kNumKeys);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int key = 0; key < kNumKeys; key++) {
+        if (map.insert(key, t)) {
+          winners[key]++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int key = 0; key < kNumKeys; key++) {
+    ASSERT_EQ(winners[key], 1);
+    ASSERT_TRUE(map.contains(key));
+  }
+}
+
+TEST(LockFreeHashMapTest, ManyRoundsOfConcurrentInsertsIntoFreshMaps) {
+  // Small maps resize several times in quick succession, so a thread that
+  // found a table full may only start its migration after other threads have
+  // already replaced that table and moved on to its successor
+  constexpr int kNumRounds = 200;
+  constexpr int kNumThreads = 8;
+  constexpr int kKeysPerThread = 400;
+
+  for (int round = 0; round < kNumRounds; round++) {
+    LockFreeHashMap<int, int> map;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&map, t]() {
+        for (int i = 0; i < kKeysPerThread; i++) {
+          int key = i * kNumThreads + t;
+          EXPECT_TRUE(map.insert(key, key + 1));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (int key = 0; key < kNumThreads * kKeysPerThread; key++) {
+      ASSERT_EQ(map.find(key), key + 1);
+    }
+  }
+}
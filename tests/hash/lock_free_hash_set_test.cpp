@@ -0,0 +1,224 @@
+#include "hash/lock_free_hash_set.h"
+
+#include <atomic>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "memory/hazard_ptr.h"
+
+class LockFreeHashSetTest : public ::testing::Test {
+ protected:
+  void SetUp() override { set_ = new LockFreeHashSet<int>(); }
+
+  void TearDown() override { delete set_; }
+
+  LockFreeHashSet<int>* set_;
+};
+
+TEST_F(LockFreeHashSetTest, EmptySetContains) {
+  EXPECT_FALSE(set_->contains(42));
+  EXPECT_EQ(set_->size(), 0);
+}
+
+TEST_F(LockFreeHashSetTest, AddRemoveContains) {
+  EXPECT_TRUE(set_->add(42));
+  EXPECT_TRUE(set_->contains(42));
+  EXPECT_FALSE(set_->contains(43));
+  EXPECT_FALSE(set_->add(42));
+  EXPECT_EQ(set_->size(), 1);
+
+  EXPECT_TRUE(set_->remove(42));
+  EXPECT_FALSE(set_->contains(42));
+  EXPECT_FALSE(set_->remove(42));
+  EXPECT_EQ(set_->size(), 0);
+
+  // Verify item can be re-added after removal
+  EXPECT_TRUE(set_->add(42));
+  EXPECT_TRUE(set_->contains(42));
+}
+
+TEST_F(LockFreeHashSetTest, BoundaryCheck) {
+  // Items whose hashes collide with the keys of the list's head and tail
+  // sentinels, or with the key of a bucket sentinel, are ordinary items
+  LockFreeHashSet<size_t> s_set;
+
+  size_t min_val = std::numeric_limits<size_t>::min();
+  size_t max_val = std::numeric_limits<size_t>::max() >> 1;
+
+  EXPECT_FALSE(s_set.contains(min_val));
+  EXPECT_FALSE(s_set.contains(max_val));
+  EXPECT_FALSE(s_set.remove(min_val));
+  EXPECT_FALSE(s_set.remove(max_val));
+
+  EXPECT_TRUE(s_set.add(min_val));
+  EXPECT_TRUE(s_set.add(max_val));
+  EXPECT_TRUE(s_set.add(1));
+  EXPECT_TRUE(s_set.contains(min_val));
+  EXPECT_TRUE(s_set.contains(max_val));
+  EXPECT_TRUE(s_set.contains(1));
+
+  EXPECT_TRUE(s_set.remove(min_val));
+  EXPECT_TRUE(s_set.remove(max_val));
+  EXPECT_TRUE(s_set.contains(1));
+}
+
+TEST_F(LockFreeHashSetTest, GrowsWithoutLosingItems) {
+  constexpr int kNumItems = 100000;
+
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_TRUE(set_->add(i));
+  }
+  EXPECT_EQ(set_->size(), kNumItems);
+  // The directory grows as the set fills up
+  EXPECT_GE(set_->bucket_count(), kNumItems / 4);
+
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_TRUE(set_->contains(i));
+  }
+  EXPECT_FALSE(set_->contains(kNumItems));
+
+  // Remove even-numbered items
+  for (int i = 0; i < kNumItems; i += 2) {
+    EXPECT_TRUE(set_->remove(i));
+  }
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_EQ(set_->contains(i), i % 2 != 0);
+  }
+}
+
+TEST_F(LockFreeHashSetTest, ConcurrentAdd) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 5000;
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+
+  // Each thread adds a distinct range of items, which makes the threads race
+  // to split buckets
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        EXPECT_TRUE(set_->add(i * kNumThreads + t));
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(set_->size(), kNumThreads * kItemsPerThread);
+  for (int i = 0; i < kNumThreads * kItemsPerThread; i++) {
+    EXPECT_TRUE(set_->contains(i));
+  }
+}
+
+TEST_F(LockFreeHashSetTest, ConcurrentRemove) {
+  constexpr int kNumItems = 10000;
+  constexpr int kNumThreads = 4;
+
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_TRUE(set_->add(i));
+  }
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+
+  // Each thread removes a distinct range of items
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t]() {
+      for (int i = t; i < kNumItems; i += kNumThreads) {
+        EXPECT_TRUE(set_->remove(i));
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(set_->size(), 0);
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_FALSE(set_->contains(i));
+  }
+}
+
+// Each thread owns the keys congruent to its id and knows exactly which of
+// them must be present, while the other threads concurrently grow the set
+template<typename SetType>
+void RunOwnedKeysStressTest(SetType& set) {
+  constexpr int kNumThreads = 8;
+  constexpr int kOperationsPerThread = 20000;
+  constexpr int kKeysPerThread = 1000;
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&set, t]() {
+      std::mt19937 gen(static_cast<unsigned int>(t + 100));
+      std::uniform_int_distribution<> op_dist(0, 2);
+      std::uniform_int_distribution<> key_dist(0, kKeysPerThread - 1);
+      std::vector<bool> present(kKeysPerThread, false);
+
+      for (int i = 0; i < kOperationsPerThread; i++) {
+        int index = key_dist(gen);
+        int key = index * kNumThreads + t;
+        switch (op_dist(gen)) {
+          case 0:
+            EXPECT_EQ(set.add(key), !present[index]);
+            present[index] = true;
+            break;
+          case 1:
+            EXPECT_EQ(set.remove(key), present[index]);
+            present[index] = false;
+            break;
+          case 2:
+            EXPECT_EQ(set.contains(key), present[index]);
+            break;
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST_F(LockFreeHashSetTest, OwnedKeysStressTest) {
+  RunOwnedKeysStressTest(*set_);
+}
+
+TEST_F(LockFreeHashSetTest, OwnedKeysStressTestWithHazardPointers) {
+  LockFreeHashSet<int, std::hash<int>, HazardPtr> hp_set;
+  RunOwnedKeysStressTest(hp_set);
+}
+
+TEST_F(LockFreeHashSetTest, TestWithCustomType) {
+  struct TestItem {
+    int id;
+    std::string name;
+  };
+
+  struct TestItemHash {
+    size_t operator()(const TestItem& item) const {
+      return std::hash<int>{}(item.id) ^ std::hash<std::string>{}(item.name);
+    }
+  };
+
+  LockFreeHashSet<TestItem, TestItemHash> custom_set;
+
+  EXPECT_TRUE(custom_set.add({1, "one"}));
+  EXPECT_TRUE(custom_set.add({2, "two"}));
+  EXPECT_TRUE(custom_set.add({3, "three"}));
+  EXPECT_FALSE(custom_set.add({1, "one"}));
+
+  EXPECT_TRUE(custom_set.remove({2, "two"}));
+  EXPECT_FALSE(custom_set.contains({2, "two"}));
+  EXPECT_TRUE(custom_set.contains({1, "one"}));
+  EXPECT_TRUE(custom_set.contains({3, "three"}));
+}
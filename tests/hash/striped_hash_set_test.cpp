@@ -0,0 +1,174 @@
+#include "hash/striped_hash_set.h"
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "synchronization/backoff_lock.h"
+#include "synchronization/mcs_lock.h"
+
+class StripedHashSetTest : public ::testing::Test {
+ protected:
+  void SetUp() override { set_ = new StripedHashSet<int>(); }
+
+  void TearDown() override { delete set_; }
+
+  StripedHashSet<int>* set_;
+};
+
+TEST_F(StripedHashSetTest, EmptySetContains) {
+  EXPECT_FALSE(set_->contains(42));
+  EXPECT_EQ(set_->size(), 0);
+}
+
+TEST_F(StripedHashSetTest, AddRemoveContains) {
+  EXPECT_TRUE(set_->add(42));
+  EXPECT_TRUE(set_->contains(42));
+  EXPECT_FALSE(set_->contains(43));
+  EXPECT_FALSE(set_->add(42));
+  EXPECT_EQ(set_->size(), 1);
+
+  EXPECT_TRUE(set_->remove(42));
+  EXPECT_FALSE(set_->contains(42));
+  EXPECT_FALSE(set_->remove(42));
+  EXPECT_EQ(set_->size(), 0);
+
+  // Verify item can be re-added after removal
+  EXPECT_TRUE(set_->add(42));
+  EXPECT_TRUE(set_->contains(42));
+}
+
+TEST_F(StripedHashSetTest, ResizeKeepsItems) {
+  constexpr int kNumItems = 10000;
+  StripedHashSet<int> small_set(1);
+
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_TRUE(small_set.add(i));
+  }
+  EXPECT_EQ(small_set.size(), kNumItems);
+  EXPECT_GE(small_set.capacity(), kNumItems / 8);
+
+  for (int i = 0; i < kNumItems; i += 2) {
+    EXPECT_TRUE(small_set.remove(i));
+  }
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_EQ(small_set.contains(i), i % 2 != 0);
+  }
+}
+
+TEST_F(StripedHashSetTest, ConcurrentAddWithResize) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 5000;
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+
+  // Each thread adds a distinct range of items, so the table is resized many
+  // times while other threads are inserting
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        EXPECT_TRUE(set_->add(i * kNumThreads + t));
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(set_->size(), kNumThreads * kItemsPerThread);
+  for (int i = 0; i < kNumThreads * kItemsPerThread; i++) {
+    EXPECT_TRUE(set_->contains(i));
+  }
+}
+
+// Each thread owns the keys congruent to its id and knows exactly which of
+// them must be present, while the other threads concurrently grow the set
+template<typename SetType>
+void RunOwnedKeysStressTest(SetType& set) {
+  constexpr int kNumThreads = 8;
+  constexpr int kOperationsPerThread = 20000;
+  constexpr int kKeysPerThread = 1000;
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&set, t]() {
+      std::mt19937 gen(static_cast<unsigned int>(t + 100));
+      std::uniform_int_distribution<> op_dist(0, 2);
+      std::uniform_int_distribution<> key_dist(0, kKeysPerThread - 1);
+      std::vector<bool> present(kKeysPerThread, false);
+
+      for (int i = 0; i < kOperationsPerThread; i++) {
+        int index = key_dist(gen);
+        int key = index * kNumThreads + t;
+        switch (op_dist(gen)) {
+          case 0:
+            EXPECT_EQ(set.add(key), !present[index]);
+            present[index] = true;
+            break;
+          case 1:
+            EXPECT_EQ(set.remove(key), present[index]);
+            present[index] = false;
+            break;
+          case 2:
+            EXPECT_EQ(set.contains(key), present[index]);
+            break;
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST_F(StripedHashSetTest, OwnedKeysStressTest) {
+  RunOwnedKeysStressTest(*set_);
+}
+
+TEST_F(StripedHashSetTest, OwnedKeysStressTestWithBackoffLock) {
+  StripedHashSet<int, BackoffLock<std::chrono::microseconds>> backoff_set;
+  RunOwnedKeysStressTest(backoff_set);
+}
+
+// The resize holds every lock at once, which queue locks support with a node
+// per lock instance
+TEST_F(StripedHashSetTest, OwnedKeysStressTestWithMCSLock) {
+  StripedHashSet<int, MCSLock<>> mcs_set;
+  RunOwnedKeysStressTest(mcs_set);
+}
+
+TEST_F(StripedHashSetTest, TestWithCustomType) {
+  struct TestItem {
+    int id;
+    std::string name;
+
+    bool operator==(const TestItem& other) const {
+      return id == other.id && name == other.name;
+    }
+  };
+
+  struct TestItemHash {
+    size_t operator()(const TestItem& item) const {
+      return std::hash<int>{}(item.id) ^ std::hash<std::string>{}(item.name);
+    }
+  };
+
+  StripedHashSet<TestItem, TTASLock<>, TestItemHash> custom_set;
+
+  EXPECT_TRUE(custom_set.add({1, "one"}));
+  EXPECT_TRUE(custom_set.add({2, "two"}));
+  EXPECT_TRUE(custom_set.add({3, "three"}));
+  EXPECT_FALSE(custom_set.add({1, "one"}));
+
+  EXPECT_TRUE(custom_set.remove({2, "two"}));
+  EXPECT_FALSE(custom_set.contains({2, "two"}));
+  EXPECT_TRUE(custom_set.contains({1, "one"}));
+  EXPECT_TRUE(custom_set.contains({3, "three"}));
+}
@@ -1,5 +1,6 @@
 #include "list/coarse_list.h"
 
+#include <functional>
 #include <random>
 #include <thread>
 #include <vector>
@@ -270,3 +271,48 @@ TEST_F(CoarseListTest, StressTest) {
   // All operations should have completed
   EXPECT_EQ(completed_operations, kNumThreads * kOperationsPerThread);
 }
+
+// Maps every item to the same hash, so only the comparator tells items apart
+struct ConstantHash {
+  auto operator()(int) const -> size_t { return 42; }
+};
+
+TEST(CoarseListComparatorTest, CollidingHashesAreDistinctItems) {
+  CoarseList<int, ConstantHash, std::less<int>> list;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(list.add(i));
+  }
+  EXPECT_FALSE(list.add(7));
+  EXPECT_TRUE(list.contains(99));
+  EXPECT_FALSE(list.contains(100));
+
+  for (int i = 0; i < 100; i += 2) {
+    EXPECT_TRUE(list.remove(i));
+  }
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(list.contains(i), i % 2 == 1);
+  }
+}
+
+TEST(CoarseListComparatorTest, ConcurrentAddWithCollidingHashes) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 200;
+  CoarseList<int, ConstantHash, std::less<int>> list;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      // Interleave the items of different threads in the list
+      for (int i = 0; i < kItemsPerThread; i++) {
+        EXPECT_TRUE(list.add(i * kNumThreads + t));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumThreads * kItemsPerThread; i++) {
+    EXPECT_TRUE(list.contains(i));
+  }
+}
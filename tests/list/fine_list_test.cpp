@@ -1,11 +1,15 @@
 #include "list/fine_list.h"
 
 #include <atomic>
+#include <functional>
 #include <random>
 #include <thread>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "synchronization/mcs_lock.h"
+#include "synchronization/shared_ttas_lock.h"
+#include "synchronization/ttas_lock.h"
 
 class FineListTest : public ::testing::Test {
  protected:
@@ -359,3 +363,123 @@ TEST_F(FineListTest, HighContentionTest) {
 
   EXPECT_EQ(completed_operations, kNumThreads * kOperationsPerThread);
 }
+
+// Maps every item to the same hash, so only the comparator tells items apart
+struct ConstantHash {
+  auto operator()(int) const -> size_t { return 42; }
+};
+
+TEST(FineListComparatorTest, CollidingHashesAreDistinctItems) {
+  FineList<int, ConstantHash, std::less<int>> list;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(list.add(i));
+  }
+  EXPECT_FALSE(list.add(7));
+  EXPECT_TRUE(list.contains(99));
+  EXPECT_FALSE(list.contains(100));
+
+  for (int i = 0; i < 100; i += 2) {
+    EXPECT_TRUE(list.remove(i));
+  }
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(list.contains(i), i % 2 == 1);
+  }
+}
+
+TEST(FineListComparatorTest, ConcurrentAddWithCollidingHashes) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 200;
+  FineList<int, ConstantHash, std::less<int>> list;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      // Interleave the items of different threads in the list
+      for (int i = 0; i < kItemsPerThread; i++) {
+        EXPECT_TRUE(list.add(i * kNumThreads + t));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumThreads * kItemsPerThread; i++) {
+    EXPECT_TRUE(list.contains(i));
+  }
+}
+
+// Hand-over-hand locking holds two per-node locks at once, which queue locks
+// support with a node per lock instance
+TEST(FineListLockTest, MCSNodeLocks) {
+  constexpr size_t kNumThreads = 4;
+  constexpr int kItemsPerThread = 500;
+
+  FineList<int, std::hash<int>, void, DefaultAllocator, MCSLock<>> list;
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (size_t t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      int base = static_cast<int>(t) * kItemsPerThread;
+      for (int i = 0; i < kItemsPerThread; i++) {
+        EXPECT_TRUE(list.add(base + i));
+      }
+      for (int i = 0; i < kItemsPerThread; i += 2) {
+        EXPECT_TRUE(list.remove(base + i));
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < static_cast<int>(kNumThreads) * kItemsPerThread; i++) {
+    EXPECT_EQ(list.contains(i), i % 2 == 1);
+  }
+}
+
+// Readers traverse in shared mode while writers keep adding and removing the
+// items between the ones they look up, which stay in the list throughout
+TEST(FineListLockTest, SharedReadersWithWriters) {
+  constexpr int kNumItems = 200;
+  constexpr int kNumReaders = 3;
+  constexpr int kNumWriters = 2;
+  constexpr int kOpsPerThread = 3000;
+  FineList<int, std::hash<int>, void, DefaultAllocator, SharedTTASLock<>> list;
+  for (int i = 0; i < kNumItems; i += 2) {
+    EXPECT_TRUE(list.add(i));
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumWriters; t++) {
+    threads.emplace_back([&list, t]() {
+      for (int i = 0; i < kOpsPerThread; i++) {
+        int item = 2 * ((i * kNumWriters + t) % (kNumItems / 2)) + 1;
+        if (!list.add(item)) {
+          list.remove(item);
+        }
+      }
+    });
+  }
+  for (int t = 0; t < kNumReaders; t++) {
+    threads.emplace_back([&list, t]() {
+      for (int i = 0; i < kOpsPerThread; i++) {
+        EXPECT_TRUE(list.contains(2 * ((i + t) % (kNumItems / 2))));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// A lock without a shared mode makes contains() lock exclusively
+TEST(FineListLockTest, ExclusiveOnlyLock) {
+  FineList<int, std::hash<int>, void, DefaultAllocator, TTASLock<>> list;
+  EXPECT_TRUE(list.add(1));
+  EXPECT_TRUE(list.contains(1));
+  EXPECT_TRUE(list.remove(1));
+  EXPECT_FALSE(list.contains(1));
+}
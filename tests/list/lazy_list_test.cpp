@@ -1,12 +1,36 @@
 #include "list/lazy_list.h"
 
+#include <algorithm>
 #include <atomic>
+#include <functional>
 #include <random>
 #include <thread>
 #include <vector>
 
 #include "gtest/gtest.h"
 
+// An item that counts how many instances are alive, to observe when the list
+// frees the nodes holding them
+struct CountedItem {
+  static inline std::atomic<int> num_alive{0};
+
+  CountedItem(int value) : value_(value) { num_alive++; }
+  CountedItem(const CountedItem& other) : value_(other.value_) { num_alive++; }
+  ~CountedItem() { num_alive--; }
+
+  auto operator==(const CountedItem& other) const -> bool {
+    return value_ == other.value_;
+  }
+
+  int value_;
+};
+
+struct CountedItemHash {
+  auto operator()(const CountedItem& item) const -> size_t {
+    return std::hash<int>{}(item.value_);
+  }
+};
+
 class LazyListTest : public ::testing::Test {
  protected:
   void SetUp() override { list_ = new LazyList<int>(); }
@@ -394,3 +418,343 @@ TEST_F(LazyListTest, MemoryLeakTest) {
     EXPECT_TRUE(list_->contains(static_cast<int>(i)));
   }
 }
+
+TEST_F(LazyListTest, RemovedNodesAreReclaimed) {
+  constexpr int kNumItems = 10000;
+  {
+    LazyList<CountedItem, CountedItemHash> counted_list;
+    for (int i = 0; i < kNumItems; i++) {
+      EXPECT_TRUE(counted_list.add(CountedItem(i)));
+      EXPECT_TRUE(counted_list.remove(CountedItem(i)));
+    }
+
+    // Memory is proportional to the live elements (none), plus a bounded
+    // number of removed nodes that have not been reclaimed yet
+    EXPECT_LT(CountedItem::num_alive.load(), kNumItems / 10);
+  }
+  EXPECT_EQ(CountedItem::num_alive.load(), 0);
+}
+
+// Orders integers by value, so that ranges of keys are ranges of values
+struct IdentityHash {
+  auto operator()(int value) const -> size_t {
+    return static_cast<size_t>(value);
+  }
+};
+
+TEST_F(LazyListTest, ForEachInRange) {
+  LazyList<int, IdentityHash> list;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(list.add(i));
+  }
+  EXPECT_TRUE(list.remove(15));
+
+  std::vector<int> visited;
+  list.for_each_in_range(10, 19, [&](int item) { visited.push_back(item); });
+  EXPECT_EQ(visited, (std::vector<int>{10, 11, 12, 13, 14, 16, 17, 18, 19}));
+
+  visited.clear();
+  list.for_each_in_range(200, 300, [&](int item) { visited.push_back(item); });
+  EXPECT_TRUE(visited.empty());
+}
+
+TEST_F(LazyListTest, IteratorSkipsRemovedItems) {
+  LazyList<int, IdentityHash> list;
+  EXPECT_EQ(list.begin(), list.end());
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(list.add(i));
+  }
+  for (int i = 0; i < 100; i += 2) {
+    EXPECT_TRUE(list.remove(i));
+  }
+
+  std::vector<int> visited(list.begin(), list.end());
+  std::vector<int> expected;
+  for (int i = 1; i < 100; i += 2) {
+    expected.push_back(i);
+  }
+  EXPECT_EQ(visited, expected);
+}
+
+TEST_F(LazyListTest, ConcurrentIterationVisitsStableItems) {
+  // Even items stay in the list while other threads add and remove odd ones,
+  // so every traversal must visit each even item exactly once, in order
+  constexpr int kNumItems = 512;
+  constexpr int kNumWriters = 3;
+  constexpr int kNumScans = 200;
+
+  LazyList<int, IdentityHash> list;
+  for (int i = 0; i < kNumItems; i += 2) {
+    EXPECT_TRUE(list.add(i));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kNumWriters; t++) {
+    writers.emplace_back([&list, &done]() {
+      std::mt19937 gen(std::random_device{}());
+      std::uniform_int_distribution<> dist(0, kNumItems / 2 - 1);
+      while (!done.load()) {
+        int value = 2 * dist(gen) + 1;
+        list.add(value);
+        list.remove(value);
+      }
+    });
+  }
+
+  for (int scan = 0; scan < kNumScans; scan++) {
+    std::vector<int> evens;
+    if (scan % 2 == 0) {
+      for (int item : list) {
+        if (item % 2 == 0) {
+          evens.push_back(item);
+        }
+      }
+    } else {
+      list.for_each_in_range(0, kNumItems, [&](int item) {
+        if (item % 2 == 0) {
+          evens.push_back(item);
+        }
+      });
+    }
+    ASSERT_EQ(evens.size(), static_cast<size_t>(kNumItems / 2));
+    for (int i = 0; i < kNumItems / 2; i++) {
+      ASSERT_EQ(evens[i], 2 * i);
+    }
+  }
+
+  done.store(true);
+  for (auto& writer : writers) {
+    writer.join();
+  }
+}
+
+TEST_F(LazyListTest, SnapshotIsLinearizable) {
+  // Each writer owns a pair of items {2k, 2k + 1} and moves the value between
+  // them by adding the new item before removing the old one, so at any point
+  // in time at least one item of every pair is in the list
+  constexpr int kNumWriters = 4;
+  constexpr int kNumSnapshots = 200;
+
+  LazyList<int, IdentityHash> list;
+  for (int k = 0; k < kNumWriters; k++) {
+    EXPECT_TRUE(list.add(2 * k));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (int k = 0; k < kNumWriters; k++) {
+    writers.emplace_back([&list, &done, k]() {
+      int curr = 2 * k;
+      while (!done.load()) {
+        int next = curr ^ 1;
+        EXPECT_TRUE(list.add(next));
+        EXPECT_TRUE(list.remove(curr));
+        curr = next;
+      }
+    });
+  }
+
+  for (int i = 0; i < kNumSnapshots; i++) {
+    std::vector<int> items = list.snapshot();
+    EXPECT_TRUE(std::is_sorted(items.begin(), items.end()));
+    for (int k = 0; k < kNumWriters; k++) {
+      EXPECT_TRUE(std::binary_search(items.begin(), items.end(), 2 * k) ||
+                  std::binary_search(items.begin(), items.end(), 2 * k + 1));
+    }
+  }
+
+  done.store(true);
+  for (auto& writer : writers) {
+    writer.join();
+  }
+}
+
+TEST_F(LazyListTest, BulkOperations) {
+  EXPECT_TRUE(list_->add(5));
+  std::vector<int> batch{9, 3, 5, 7, 3, 1};
+  // 5 is already in the list and the second 3 repeats the first
+  EXPECT_EQ(list_->add_bulk(batch.begin(), batch.end()), 4U);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(list_->contains(i), i % 2 == 1);
+  }
+
+  std::vector<int> lookups{4, 9, 0, 1, 7};
+  EXPECT_EQ(list_->contains_bulk(lookups.begin(), lookups.end()),
+            (std::vector<bool>{false, true, false, true, true}));
+
+  std::vector<int> removals{7, 2, 1, 7};
+  EXPECT_EQ(list_->remove_bulk(removals.begin(), removals.end()), 2U);
+  EXPECT_EQ(std::vector<int>(list_->begin(), list_->end()).size(), 3U);
+  EXPECT_EQ(list_->approx_size(), 3U);
+  EXPECT_TRUE(list_->contains(3));
+  EXPECT_FALSE(list_->contains(7));
+}
+
+TEST_F(LazyListTest, ConcurrentBulkLoads) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 2000;
+
+  // Every thread loads its interleaved keys in random order, then removes
+  // the even ones and looks the whole batch up again
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t]() {
+      std::vector<int> batch;
+      for (int i = 0; i < kItemsPerThread; i++) {
+        batch.push_back(i * kNumThreads + t);
+      }
+      std::shuffle(batch.begin(), batch.end(), std::mt19937(t));
+      EXPECT_EQ(list_->add_bulk(batch.begin(), batch.end()),
+                static_cast<size_t>(kItemsPerThread));
+
+      std::vector<int> evens;
+      for (int item : batch) {
+        if (item % 2 == 0) {
+          evens.push_back(item);
+        }
+      }
+      EXPECT_EQ(list_->remove_bulk(evens.begin(), evens.end()), evens.size());
+
+      std::vector<bool> found =
+          list_->contains_bulk(batch.begin(), batch.end());
+      for (size_t i = 0; i < batch.size(); i++) {
+        EXPECT_EQ(found[i], batch[i] % 2 == 1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Half of every batch was removed again
+  EXPECT_EQ(list_->approx_size(),
+            static_cast<size_t>(kNumThreads * kItemsPerThread / 2));
+}
+
+// Maps every item to the same hash, so only the comparator tells items apart
+struct ConstantHash {
+  auto operator()(int) const -> size_t { return 42; }
+};
+
+TEST(LazyListComparatorTest, CollidingHashesAreDistinctItems) {
+  LazyList<int, ConstantHash, EpochBasedReclamation, std::less<int>> list;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(list.add(i));
+  }
+  EXPECT_FALSE(list.add(7));
+  EXPECT_TRUE(list.contains(99));
+  EXPECT_FALSE(list.contains(100));
+
+  for (int i = 0; i < 100; i += 2) {
+    EXPECT_TRUE(list.remove(i));
+  }
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(list.contains(i), i % 2 == 1);
+  }
+}
+
+TEST(LazyListComparatorTest, ConcurrentAddWithCollidingHashes) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 200;
+  LazyList<int, ConstantHash, EpochBasedReclamation, std::less<int>> list;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      // Interleave the items of different threads in the list
+      for (int i = 0; i < kItemsPerThread; i++) {
+        EXPECT_TRUE(list.add(i * kNumThreads + t));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumThreads * kItemsPerThread; i++) {
+    EXPECT_TRUE(list.contains(i));
+  }
+}
+
+TEST(LazyListComparatorTest, RangeScanFollowsComparator) {
+  LazyList<int, ConstantHash, EpochBasedReclamation, std::greater<int>> list;
+  for (int i = 0; i < 20; i++) {
+    EXPECT_TRUE(list.add(i));
+  }
+
+  std::vector<int> visited;
+  list.for_each_in_range(15, 5, [&](int item) { visited.push_back(item); });
+  EXPECT_EQ(visited,
+            (std::vector<int>{15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5}));
+  EXPECT_EQ(std::vector<int>(list.begin(), list.end()).front(), 19);
+}
+
+TEST(LazyListComparatorTest, BulkOperationsFollowComparator) {
+  LazyList<int, ConstantHash, EpochBasedReclamation, std::less<int>> list;
+  std::vector<int> batch{4, 2, 8, 6, 2};
+  EXPECT_EQ(list.add_bulk(batch.begin(), batch.end()), 4U);
+  EXPECT_EQ(std::vector<int>(list.begin(), list.end()),
+            (std::vector<int>{2, 4, 6, 8}));
+
+  std::vector<int> removals{8, 3, 2};
+  EXPECT_EQ(list.remove_bulk(removals.begin(), removals.end()), 2U);
+  std::vector<int> lookups{8, 6, 4, 2};
+  EXPECT_EQ(list.contains_bulk(lookups.begin(), lookups.end()),
+            (std::vector<bool>{false, true, true, false}));
+}
+
+TEST(RcuLazyListTest, RemovedNodesAreReclaimedAfterGracePeriod) {
+  constexpr int kNumItems = 1000;
+  {
+    RcuLazyList<CountedItem, CountedItemHash> list;
+    for (int i = 0; i < kNumItems; i++) {
+      EXPECT_TRUE(list.add(CountedItem(i)));
+      EXPECT_TRUE(list.remove(CountedItem(i)));
+    }
+    // The only thread has not been quiescent since it removed the items
+    EXPECT_GT(CountedItem::num_alive.load(), 0);
+
+    list.reclaimer().synchronize_rcu();
+    EXPECT_EQ(CountedItem::num_alive.load(), 0);
+  }
+  EXPECT_EQ(CountedItem::num_alive.load(), 0);
+}
+
+TEST(RcuLazyListTest, ReadersSeeStableItemsDuringUpdates) {
+  // Even items stay in the list while a writer adds and removes odd ones, and
+  // readers report a quiescent state after every lookup
+  constexpr int kNumItems = 1000;
+  constexpr int kNumReaders = 3;
+  constexpr int kNumRounds = 20;
+  RcuLazyList<int> list;
+  for (int i = 0; i < kNumItems; i += 2) {
+    EXPECT_TRUE(list.add(i));
+  }
+
+  std::atomic<int> readers_done{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < kNumReaders; t++) {
+    readers.emplace_back([&list, &readers_done]() {
+      for (int round = 0; round < kNumRounds; round++) {
+        for (int i = 0; i < kNumItems; i += 2) {
+          EXPECT_TRUE(list.contains(i));
+          list.reclaimer().quiescent_state();
+        }
+      }
+      list.reclaimer().unregister_thread();
+      readers_done++;
+    });
+  }
+
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<> dist(0, kNumItems / 2 - 1);
+  while (readers_done.load() < kNumReaders) {
+    int value = 2 * dist(gen) + 1;
+    list.add(value);
+    list.remove(value);
+    list.reclaimer().quiescent_state();
+  }
+  for (auto& reader : readers) {
+    reader.join();
+  }
+}
@@ -1,12 +1,37 @@
 #include "list/lock_free_list.h"
 
+#include <algorithm>
 #include <atomic>
+#include <functional>
 #include <limits>
 #include <random>
 #include <thread>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "memory/hazard_ptr.h"
+
+// An item that counts how many instances are alive, to observe when the list
+// frees the nodes holding them
+struct CountedItem {
+  static inline std::atomic<int> num_alive{0};
+
+  CountedItem(int value) : value_(value) { num_alive++; }
+  CountedItem(const CountedItem& other) : value_(other.value_) { num_alive++; }
+  ~CountedItem() { num_alive--; }
+
+  auto operator==(const CountedItem& other) const -> bool {
+    return value_ == other.value_;
+  }
+
+  int value_;
+};
+
+struct CountedItemHash {
+  auto operator()(const CountedItem& item) const -> size_t {
+    return std::hash<int>{}(item.value_);
+  }
+};
 
 class LockFreeListTest : public ::testing::Test {
  protected:
@@ -431,3 +456,503 @@ TEST_F(LockFreeListTest, LogicalThenPhysicalDeletion) {
   EXPECT_TRUE(list_->add(42));
   EXPECT_TRUE(list_->contains(42));
 }
+
+TEST_F(LockFreeListTest, RemovedNodesAreReclaimed) {
+  constexpr int kNumItems = 10000;
+  {
+    LockFreeList<CountedItem, CountedItemHash> counted_list;
+    for (int i = 0; i < kNumItems; i++) {
+      EXPECT_TRUE(counted_list.add(CountedItem(i)));
+      EXPECT_TRUE(counted_list.remove(CountedItem(i)));
+    }
+
+    // Memory is proportional to the live elements (none), plus a bounded
+    // number of removed nodes that have not been reclaimed yet
+    EXPECT_LT(CountedItem::num_alive.load(), kNumItems / 10);
+  }
+  EXPECT_EQ(CountedItem::num_alive.load(), 0);
+}
+
+TEST_F(LockFreeListTest, RemovedNodesAreReclaimedWithHazardPointers) {
+  constexpr int kNumItems = 10000;
+  {
+    LockFreeList<CountedItem, CountedItemHash, HazardPtr> counted_list;
+    for (int i = 0; i < kNumItems; i++) {
+      EXPECT_TRUE(counted_list.add(CountedItem(i)));
+      EXPECT_TRUE(counted_list.remove(CountedItem(i)));
+    }
+
+    // Memory is proportional to the live elements (none), plus a bounded
+    // number of removed nodes that have not been reclaimed yet
+    EXPECT_LT(CountedItem::num_alive.load(), kNumItems / 10);
+  }
+  EXPECT_EQ(CountedItem::num_alive.load(), 0);
+}
+
+TEST_F(LockFreeListTest, ConcurrentOperationsWithHazardPointers) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 500;
+  constexpr int kNumRounds = 4;
+  LockFreeList<int, std::hash<int>, HazardPtr> hp_list;
+
+  // Each thread owns the keys congruent to its id, repeatedly adding them and
+  // removing the even ones, while reading the keys of the other threads
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&hp_list, t]() {
+      for (int round = 0; round < kNumRounds; round++) {
+        for (int i = 0; i < kItemsPerThread; i++) {
+          hp_list.add(i * kNumThreads + t);
+          hp_list.contains(i * kNumThreads + (t + 1) % kNumThreads);
+        }
+        for (int i = 0; i < kItemsPerThread; i += 2) {
+          EXPECT_TRUE(hp_list.remove(i * kNumThreads + t));
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int key = 0; key < kNumThreads * kItemsPerThread; key++) {
+    bool is_even_item = (key / kNumThreads) % 2 == 0;
+    EXPECT_EQ(hp_list.contains(key), !is_even_item);
+  }
+}
+
+TEST_F(LockFreeListTest, BulkOperations) {
+  EXPECT_TRUE(list_->add(5));
+  std::vector<int> batch{9, 3, 5, 7, 3, 1};
+  // 5 is already in the list and the second 3 repeats the first
+  EXPECT_EQ(list_->add_bulk(batch.begin(), batch.end()), 4U);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(list_->contains(i), i % 2 == 1);
+  }
+
+  std::vector<int> lookups{4, 9, 0, 1, 7};
+  EXPECT_EQ(list_->contains_bulk(lookups.begin(), lookups.end()),
+            (std::vector<bool>{false, true, false, true, true}));
+
+  std::vector<int> removals{7, 2, 1, 7};
+  EXPECT_EQ(list_->remove_bulk(removals.begin(), removals.end()), 2U);
+  EXPECT_EQ(std::vector<int>(list_->begin(), list_->end()).size(), 3U);
+  EXPECT_EQ(list_->approx_size(), 3U);
+  EXPECT_TRUE(list_->contains(3));
+  EXPECT_FALSE(list_->contains(7));
+}
+
+TEST_F(LockFreeListTest, ConcurrentBulkLoads) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 2000;
+
+  // Every thread loads its interleaved keys in random order, then removes
+  // the even ones and looks the whole batch up again
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t]() {
+      std::vector<int> batch;
+      for (int i = 0; i < kItemsPerThread; i++) {
+        batch.push_back(i * kNumThreads + t);
+      }
+      std::shuffle(batch.begin(), batch.end(), std::mt19937(t));
+      EXPECT_EQ(list_->add_bulk(batch.begin(), batch.end()),
+                static_cast<size_t>(kItemsPerThread));
+
+      std::vector<int> evens;
+      for (int item : batch) {
+        if (item % 2 == 0) {
+          evens.push_back(item);
+        }
+      }
+      EXPECT_EQ(list_->remove_bulk(evens.begin(), evens.end()), evens.size());
+
+      std::vector<bool> found =
+          list_->contains_bulk(batch.begin(), batch.end());
+      for (size_t i = 0; i < batch.size(); i++) {
+        EXPECT_EQ(found[i], batch[i] % 2 == 1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Half of every batch was removed again
+  EXPECT_EQ(list_->approx_size(),
+            static_cast<size_t>(kNumThreads * kItemsPerThread / 2));
+}
+
+TEST_F(LockFreeListTest, BulkOperationsWithHazardPointers) {
+  LockFreeList<int, std::hash<int>, HazardPtr> hp_list;
+  std::vector<int> batch;
+  for (int i = 0; i < 1000; i++) {
+    batch.push_back((i * 7919) % 1000);
+  }
+  EXPECT_EQ(hp_list.add_bulk(batch.begin(), batch.end()), 1000U);
+
+  std::vector<int> odds;
+  for (int i = 1; i < 1000; i += 2) {
+    odds.push_back(i);
+  }
+  EXPECT_EQ(hp_list.remove_bulk(odds.begin(), odds.end()), odds.size());
+
+  std::vector<bool> found = hp_list.contains_bulk(batch.begin(), batch.end());
+  for (size_t i = 0; i < batch.size(); i++) {
+    EXPECT_EQ(found[i], batch[i] % 2 == 0);
+  }
+}
+
+// Orders integers by value, so that ranges of keys are ranges of values
+struct IdentityHash {
+  auto operator()(int value) const -> size_t {
+    return static_cast<size_t>(value);
+  }
+};
+
+// Threads add and remove interleaved keys, so that every update races with
+// its neighbours and traversals keep resuming from their predecessors
+template<typename List>
+void RunInterleavedUpdates(List& list) {
+  constexpr int kNumThreads = 8;
+  constexpr int kItemsPerThread = 200;
+  constexpr int kNumRounds = 20;
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      for (int round = 0; round < kNumRounds; round++) {
+        for (int i = 0; i < kItemsPerThread; i++) {
+          EXPECT_TRUE(list.add(i * kNumThreads + t));
+        }
+        for (int i = round % 2; i < kItemsPerThread; i += 2) {
+          EXPECT_TRUE(list.remove(i * kNumThreads + t));
+        }
+        for (int i = 1 - round % 2; i < kItemsPerThread; i += 2) {
+          EXPECT_TRUE(list.remove(i * kNumThreads + t));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int key = 0; key < kNumThreads * kItemsPerThread; key++) {
+    EXPECT_FALSE(list.contains(key));
+  }
+}
+
+TEST_F(LockFreeListTest, InterleavedUpdatesWithBackoff) {
+  LockFreeList<int, IdentityHash, EpochBasedReclamation, void,
+               DefaultAllocator, PauseBackoff<>>
+      backoff_list;
+  RunInterleavedUpdates(backoff_list);
+}
+
+TEST_F(LockFreeListTest, InterleavedUpdatesWithHazardPointers) {
+  LockFreeList<int, IdentityHash, HazardPtr, void, DefaultAllocator,
+               PauseBackoff<>>
+      hp_list;
+  RunInterleavedUpdates(hp_list);
+}
+
+TEST_F(LockFreeListTest, ForEachInRange) {
+  LockFreeList<int, IdentityHash> list;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(list.add(i));
+  }
+  EXPECT_TRUE(list.remove(15));
+
+  std::vector<int> visited;
+  list.for_each_in_range(10, 19, [&](int item) { visited.push_back(item); });
+  EXPECT_EQ(visited, (std::vector<int>{10, 11, 12, 13, 14, 16, 17, 18, 19}));
+
+  visited.clear();
+  list.for_each_in_range(200, 300, [&](int item) { visited.push_back(item); });
+  EXPECT_TRUE(visited.empty());
+}
+
+TEST_F(LockFreeListTest, IteratorSkipsRemovedItems) {
+  LockFreeList<int, IdentityHash> list;
+  EXPECT_EQ(list.begin(), list.end());
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(list.add(i));
+  }
+  for (int i = 0; i < 100; i += 2) {
+    EXPECT_TRUE(list.remove(i));
+  }
+
+  std::vector<int> visited(list.begin(), list.end());
+  std::vector<int> expected;
+  for (int i = 1; i < 100; i += 2) {
+    expected.push_back(i);
+  }
+  EXPECT_EQ(visited, expected);
+}
+
+TEST_F(LockFreeListTest, ConcurrentIterationVisitsStableItems) {
+  // Even items stay in the list while other threads add and remove odd ones,
+  // so every traversal must visit each even item exactly once, in order
+  constexpr int kNumItems = 512;
+  constexpr int kNumWriters = 3;
+  constexpr int kNumScans = 200;
+
+  LockFreeList<int, IdentityHash> list;
+  for (int i = 0; i < kNumItems; i += 2) {
+    EXPECT_TRUE(list.add(i));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kNumWriters; t++) {
+    writers.emplace_back([&list, &done]() {
+      std::mt19937 gen(std::random_device{}());
+      std::uniform_int_distribution<> dist(0, kNumItems / 2 - 1);
+      while (!done.load()) {
+        int value = 2 * dist(gen) + 1;
+        list.add(value);
+        list.remove(value);
+      }
+    });
+  }
+
+  for (int scan = 0; scan < kNumScans; scan++) {
+    std::vector<int> evens;
+    if (scan % 2 == 0) {
+      for (int item : list) {
+        if (item % 2 == 0) {
+          evens.push_back(item);
+        }
+      }
+    } else {
+      list.for_each_in_range(0, kNumItems, [&](int item) {
+        if (item % 2 == 0) {
+          evens.push_back(item);
+        }
+      });
+    }
+    ASSERT_EQ(evens.size(), static_cast<size_t>(kNumItems / 2));
+    for (int i = 0; i < kNumItems / 2; i++) {
+      ASSERT_EQ(evens[i], 2 * i);
+    }
+  }
+
+  done.store(true);
+  for (auto& writer : writers) {
+    writer.join();
+  }
+}
+
+TEST_F(LockFreeListTest, ConcurrentRangeScanWithHazardPointers) {
+  // With hazard pointers, a scan that meets a removed node resumes from the
+  // head, and must still visit every stable item exactly once
+  constexpr int kNumItems = 512;
+  constexpr int kNumWriters = 3;
+  constexpr int kNumScans = 200;
+
+  LockFreeList<int, IdentityHash, HazardPtr> list;
+  for (int i = 0; i < kNumItems; i += 2) {
+    EXPECT_TRUE(list.add(i));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kNumWriters; t++) {
+    writers.emplace_back([&list, &done]() {
+      std::mt19937 gen(std::random_device{}());
+      std::uniform_int_distribution<> dist(0, kNumItems / 2 - 1);
+      while (!done.load()) {
+        int value = 2 * dist(gen) + 1;
+        list.add(value);
+        list.remove(value);
+      }
+    });
+  }
+
+  for (int scan = 0; scan < kNumScans; scan++) {
+    std::vector<int> evens;
+    list.for_each_in_range(0, kNumItems, [&](int item) {
+      if (item % 2 == 0) {
+        evens.push_back(item);
+      }
+    });
+    ASSERT_EQ(evens.size(), static_cast<size_t>(kNumItems / 2));
+    for (int i = 0; i < kNumItems / 2; i++) {
+      ASSERT_EQ(evens[i], 2 * i);
+    }
+  }
+
+  done.store(true);
+  for (auto& writer : writers) {
+    writer.join();
+  }
+}
+
+// Maps every item to the same hash, so only the comparator tells items apart
+struct ConstantHash {
+  auto operator()(int) const -> size_t { return 42; }
+};
+
+TEST(LockFreeListComparatorTest, CollidingHashesAreDistinctItems) {
+  LockFreeList<int, ConstantHash, EpochBasedReclamation, std::less<int>> list;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(list.add(i));
+  }
+  EXPECT_FALSE(list.add(7));
+  EXPECT_TRUE(list.contains(99));
+  EXPECT_FALSE(list.contains(100));
+
+  for (int i = 0; i < 100; i += 2) {
+    EXPECT_TRUE(list.remove(i));
+  }
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(list.contains(i), i % 2 == 1);
+  }
+}
+
+TEST(LockFreeListComparatorTest, ConcurrentAddWithCollidingHashes) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 200;
+  LockFreeList<int, ConstantHash, EpochBasedReclamation, std::less<int>> list;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      // Interleave the items of different threads in the list
+      for (int i = 0; i < kItemsPerThread; i++) {
+        EXPECT_TRUE(list.add(i * kNumThreads + t));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumThreads * kItemsPerThread; i++) {
+    EXPECT_TRUE(list.contains(i));
+  }
+}
+
+TEST(LockFreeListComparatorTest, RangeScanFollowsComparator) {
+  LockFreeList<int, ConstantHash, EpochBasedReclamation, std::greater<int>>
+      list;
+  for (int i = 0; i < 20; i++) {
+    EXPECT_TRUE(list.add(i));
+  }
+
+  std::vector<int> visited;
+  list.for_each_in_range(15, 5, [&](int item) { visited.push_back(item); });
+  EXPECT_EQ(visited,
+            (std::vector<int>{15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5}));
+  EXPECT_EQ(std::vector<int>(list.begin(), list.end()).front(), 19);
+}
+
+TEST(LockFreeListAllocatorTest, PooledNodesAreRecycledAfterReclamation) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumOperations = 20000;
+  {
+    LockFreeList<CountedItem, CountedItemHash, EpochBasedReclamation, void,
+                 PoolAllocator>
+        list;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&list, t]() {
+        for (int i = 0; i < kNumOperations; i++) {
+          CountedItem item(i % 64 * kNumThreads + t);
+          list.add(item);
+          list.remove(item);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  EXPECT_EQ(CountedItem::num_alive.load(), 0);
+}
+
+struct ListMessage : IntrusiveHook {
+  int key_{};
+
+  auto operator<(const ListMessage& other) const -> bool {
+    return key_ < other.key_;
+  }
+};
+
+// Counts the nodes the list is done with
+struct CountingDisposer {
+  static inline std::atomic<int> num_disposed{0};
+
+  auto operator()(ListMessage*) const -> void { num_disposed++; }
+};
+
+TEST(IntrusiveLockFreeListTest, AddRemoveContains) {
+  std::vector<ListMessage> arena(4);
+  ListMessage duplicate;
+  for (int i = 0; i < 4; i++) {
+    arena[i].key_ = 3 - i;
+  }
+  duplicate.key_ = 2;
+
+  IntrusiveLockFreeList<ListMessage> list;
+  for (auto& node : arena) {
+    EXPECT_TRUE(list.add(&node));
+  }
+  EXPECT_FALSE(list.add(&duplicate));
+
+  ListMessage probe;
+  for (int key = 0; key < 4; key++) {
+    probe.key_ = key;
+    EXPECT_TRUE(list.contains(probe));
+  }
+  probe.key_ = 2;
+  EXPECT_TRUE(list.remove(probe));
+  EXPECT_FALSE(list.contains(probe));
+  EXPECT_FALSE(list.remove(probe));
+  probe.key_ = 4;
+  EXPECT_FALSE(list.contains(probe));
+}
+
+// Test that every node is disposed of exactly once, whether it was removed
+// concurrently or was still in the list when it was destroyed
+TEST(IntrusiveLockFreeListTest, ConcurrentRemovalDisposesEveryNode) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNodesPerThread = 5000;
+
+  CountingDisposer::num_disposed = 0;
+  std::vector<ListMessage> arena(kNumThreads * kNodesPerThread);
+  {
+    IntrusiveLockFreeList<ListMessage, std::less<ListMessage>,
+                          CountingDisposer>
+        list;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&list, &arena, t]() {
+        for (int i = 0; i < kNodesPerThread; i++) {
+          ListMessage& node = arena[t * kNodesPerThread + i];
+          node.key_ = i * kNumThreads + t;
+          ASSERT_TRUE(list.add(&node));
+          // Remove every other node, leaving the rest to the destructor
+          if (i % 2 == 1) {
+            ASSERT_TRUE(list.remove(node));
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    ListMessage probe;
+    for (int key = 0; key < kNumThreads * kNodesPerThread; key++) {
+      probe.key_ = key;
+      EXPECT_EQ(list.contains(probe), key / kNumThreads % 2 == 0);
+    }
+  }
+  EXPECT_EQ(CountingDisposer::num_disposed.load(),
+            kNumThreads * kNodesPerThread);
+}
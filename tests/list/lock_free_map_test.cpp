@@ -0,0 +1,157 @@
+#include "list/lock_free_map.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// A value that counts how many instances are alive, to observe when the map
+// frees replaced values
+struct CountedValue {
+  static inline std::atomic<int> num_alive{0};
+
+  int value;
+
+  explicit CountedValue(int v) : value(v) { num_alive++; }
+
+  CountedValue(const CountedValue& other) : value(other.value) { num_alive++; }
+
+  ~CountedValue() { num_alive--; }
+};
+
+TEST(LockFreeMapTest, EmptyMapFindReturnsNothing) {
+  LockFreeMap<int, std::string> map;
+  EXPECT_FALSE(map.find(1).has_value());
+  EXPECT_FALSE(map.contains(1));
+  EXPECT_FALSE(map.erase(1));
+}
+
+TEST(LockFreeMapTest, InsertOrAssign) {
+  LockFreeMap<int, std::string> map;
+  EXPECT_TRUE(map.insert_or_assign(1, "one"));
+  EXPECT_TRUE(map.insert_or_assign(2, "two"));
+  EXPECT_EQ(map.find(1), "one");
+  EXPECT_EQ(map.find(2), "two");
+
+  EXPECT_FALSE(map.insert_or_assign(1, "uno"));
+  EXPECT_EQ(map.find(1), "uno");
+  EXPECT_TRUE(map.contains(1));
+}
+
+TEST(LockFreeMapTest, Erase) {
+  LockFreeMap<int, std::string> map;
+  EXPECT_TRUE(map.insert_or_assign(1, "one"));
+  EXPECT_TRUE(map.erase(1));
+  EXPECT_FALSE(map.erase(1));
+  EXPECT_FALSE(map.find(1).has_value());
+
+  EXPECT_TRUE(map.insert_or_assign(1, "again"));
+  EXPECT_EQ(map.find(1), "again");
+}
+
+// Maps every key to the same hash, so only the comparator tells keys apart
+struct ConstantHash {
+  auto operator()(const std::string&) const -> size_t { return 0; }
+};
+
+TEST(LockFreeMapTest, CollidingHashesAreDistinctKeys) {
+  LockFreeMap<std::string, int, ConstantHash> map;
+  EXPECT_TRUE(map.insert_or_assign("a", 1));
+  EXPECT_TRUE(map.insert_or_assign("b", 2));
+  EXPECT_EQ(map.find("a"), 1);
+  EXPECT_EQ(map.find("b"), 2);
+  EXPECT_TRUE(map.erase("a"));
+  EXPECT_EQ(map.find("b"), 2);
+}
+
+TEST(LockFreeMapTest, HashOrderWithoutComparator) {
+  LockFreeMap<int, int, std::hash<int>, void> map;
+  EXPECT_TRUE(map.insert_or_assign(3, 30));
+  EXPECT_FALSE(map.insert_or_assign(3, 31));
+  EXPECT_EQ(map.find(3), 31);
+  EXPECT_TRUE(map.erase(3));
+}
+
+TEST(LockFreeMapTest, ReplacedValuesAreReclaimed) {
+  constexpr int kNumAssignments = 10000;
+  {
+    LockFreeMap<int, CountedValue> map;
+    for (int i = 0; i < kNumAssignments; i++) {
+      map.insert_or_assign(i % 4, CountedValue(i));
+    }
+    EXPECT_EQ(map.find(3)->value, kNumAssignments - 1);
+
+    // Live values, plus a bounded number of replaced values that have not been
+    // reclaimed yet
+    EXPECT_LT(CountedValue::num_alive.load(), kNumAssignments / 10);
+    map.erase(0);
+  }
+  EXPECT_EQ(CountedValue::num_alive.load(), 0);
+}
+
+TEST(LockFreeMapTest, ConcurrentAssignmentsToSameKeys) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumKeys = 8;
+  constexpr int kNumOperations = 5000;
+  LockFreeMap<int, int> map;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&map, t]() {
+      for (int i = 0; i < kNumOperations; i++) {
+        int key = i % kNumKeys;
+        // Values encode the key, so a reader can check it never sees a value
+        // of another key
+        switch (i % 3) {
+          case 0:
+            map.insert_or_assign(key, key * 1000 + t);
+            break;
+          case 1:
+            if (auto value = map.find(key)) {
+              EXPECT_EQ(*value / 1000, key);
+            }
+            break;
+          default:
+            if (t == 0) {
+              map.erase(key);
+            }
+            break;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int key = 0; key < kNumKeys; key++) {
+    if (auto value = map.find(key)) {
+      EXPECT_EQ(*value / 1000, key);
+    }
+  }
+}
+
+TEST(LockFreeMapTest, ConcurrentInsertsOfDistinctKeys) {
+  constexpr int kNumThreads = 4;
+  constexpr int kKeysPerThread = 500;
+  LockFreeMap<int, int> map;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&map, t]() {
+      for (int i = 0; i < kKeysPerThread; i++) {
+        int key = i * kNumThreads + t;
+        EXPECT_TRUE(map.insert_or_assign(key, -key));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int key = 0; key < kNumThreads * kKeysPerThread; key++) {
+    EXPECT_EQ(map.find(key), -key);
+  }
+}
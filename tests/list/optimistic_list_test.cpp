@@ -1,12 +1,35 @@
 #include "list/optimistic_list.h"
 
 #include <atomic>
+#include <functional>
 #include <random>
 #include <thread>
 #include <vector>
 
 #include "gtest/gtest.h"
 
+// An item that counts how many instances are alive, to observe when the list
+// frees the nodes holding them
+struct CountedItem {
+  static inline std::atomic<int> num_alive{0};
+
+  CountedItem(int value) : value_(value) { num_alive++; }
+  CountedItem(const CountedItem& other) : value_(other.value_) { num_alive++; }
+  ~CountedItem() { num_alive--; }
+
+  auto operator==(const CountedItem& other) const -> bool {
+    return value_ == other.value_;
+  }
+
+  int value_;
+};
+
+struct CountedItemHash {
+  auto operator()(const CountedItem& item) const -> size_t {
+    return std::hash<int>{}(item.value_);
+  }
+};
+
 class OptimisticListTest : public ::testing::Test {
  protected:
   void SetUp() override { list_ = new OptimisticList<int>(); }
@@ -363,3 +386,115 @@ TEST_F(OptimisticListTest, MemoryLeakTest) {
     EXPECT_TRUE(list_->contains(static_cast<int>(i)));
   }
 }
+
+TEST_F(OptimisticListTest, LockFreeContainsSeesStableItemsDuringChurn) {
+  // Even items stay in the list while writers keep adding and removing the odd
+  // items around them, so lock-free readers must always find them
+  constexpr int kNumItems = 200;
+  constexpr size_t kNumWriters = 2;
+  constexpr size_t kNumReaders = 2;
+  for (int i = 0; i < kNumItems; i += 2) {
+    list_->add(i);
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<int> missed{0};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kNumWriters; t++) {
+    threads.emplace_back([this]() {
+      for (int round = 0; round < 200; round++) {
+        for (int i = 1; i < kNumItems; i += 2) {
+          list_->add(i);
+        }
+        for (int i = 1; i < kNumItems; i += 2) {
+          list_->remove(i);
+        }
+      }
+    });
+  }
+  for (size_t t = 0; t < kNumReaders; t++) {
+    threads.emplace_back([this, &done, &missed]() {
+      while (!done.load()) {
+        for (int i = 0; i < kNumItems; i += 2) {
+          if (!list_->contains(i)) {
+            missed++;
+          }
+        }
+      }
+    });
+  }
+
+  for (size_t t = 0; t < kNumWriters; t++) {
+    threads[t].join();
+  }
+  done.store(true);
+  for (size_t t = kNumWriters; t < threads.size(); t++) {
+    threads[t].join();
+  }
+
+  EXPECT_EQ(missed.load(), 0);
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_EQ(list_->contains(i), i % 2 == 0);
+  }
+}
+
+TEST_F(OptimisticListTest, RemovedNodesAreReclaimed) {
+  constexpr int kNumItems = 10000;
+  {
+    OptimisticList<CountedItem, CountedItemHash> counted_list;
+    for (int i = 0; i < kNumItems; i++) {
+      EXPECT_TRUE(counted_list.add(CountedItem(i)));
+      EXPECT_TRUE(counted_list.remove(CountedItem(i)));
+    }
+
+    // Memory is proportional to the live elements (none), plus a bounded
+    // number of removed nodes that have not been reclaimed yet
+    EXPECT_LT(CountedItem::num_alive.load(), kNumItems / 10);
+  }
+  EXPECT_EQ(CountedItem::num_alive.load(), 0);
+}
+
+// Maps every item to the same hash, so only the comparator tells items apart
+struct ConstantHash {
+  auto operator()(int) const -> size_t { return 42; }
+};
+
+TEST(OptimisticListComparatorTest, CollidingHashesAreDistinctItems) {
+  OptimisticList<int, ConstantHash, EpochBasedReclamation, std::less<int>> list;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(list.add(i));
+  }
+  EXPECT_FALSE(list.add(7));
+  EXPECT_TRUE(list.contains(99));
+  EXPECT_FALSE(list.contains(100));
+
+  for (int i = 0; i < 100; i += 2) {
+    EXPECT_TRUE(list.remove(i));
+  }
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(list.contains(i), i % 2 == 1);
+  }
+}
+
+TEST(OptimisticListComparatorTest, ConcurrentAddWithCollidingHashes) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 200;
+  OptimisticList<int, ConstantHash, EpochBasedReclamation, std::less<int>> list;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      // Interleave the items of different threads in the list
+      for (int i = 0; i < kItemsPerThread; i++) {
+        EXPECT_TRUE(list.add(i * kNumThreads + t));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumThreads * kItemsPerThread; i++) {
+    EXPECT_TRUE(list.contains(i));
+  }
+}
@@ -0,0 +1,185 @@
+#include "list/unrolled_lazy_list.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+struct IdentityHash {
+  auto operator()(size_t item) const -> size_t { return item; }
+};
+
+// Blocks of four keys, so that a few items already split and merge blocks
+using SmallBlockList =
+    UnrolledLazyList<size_t, IdentityHash, EpochBasedReclamation, 4>;
+
+class UnrolledLazyListTest : public ::testing::Test {
+ protected:
+  UnrolledLazyList<int> list_;
+};
+
+TEST_F(UnrolledLazyListTest, EmptyListContainsReturnsFalse) {
+  EXPECT_FALSE(list_.contains(1));
+  EXPECT_FALSE(list_.remove(1));
+}
+
+TEST_F(UnrolledLazyListTest, AddRemoveContains) {
+  EXPECT_TRUE(list_.add(5));
+  EXPECT_FALSE(list_.add(5));
+  EXPECT_TRUE(list_.contains(5));
+  EXPECT_FALSE(list_.contains(4));
+  EXPECT_TRUE(list_.remove(5));
+  EXPECT_FALSE(list_.remove(5));
+  EXPECT_FALSE(list_.contains(5));
+}
+
+TEST(UnrolledLazyListBlockTest, BoundaryKeys) {
+  SmallBlockList list;
+  constexpr size_t kMax = std::numeric_limits<size_t>::max();
+  EXPECT_TRUE(list.add(0));
+  EXPECT_TRUE(list.add(kMax));
+  EXPECT_TRUE(list.add(kMax - 1));
+  EXPECT_TRUE(list.contains(0));
+  EXPECT_TRUE(list.contains(kMax));
+  EXPECT_TRUE(list.contains(kMax - 1));
+  EXPECT_FALSE(list.contains(1));
+  EXPECT_TRUE(list.remove(0));
+  EXPECT_TRUE(list.remove(kMax));
+  EXPECT_FALSE(list.contains(0));
+  EXPECT_FALSE(list.contains(kMax));
+}
+
+TEST(UnrolledLazyListBlockTest, SplitsAndMergesKeepAllItems) {
+  // Ascending, descending and shuffled orders split and merge different blocks
+  constexpr size_t kNumItems = 2000;
+  std::vector<size_t> items;
+  for (size_t i = 0; i < kNumItems; i++) {
+    items.push_back(i * 3);
+  }
+  std::vector<std::vector<size_t>> orders{items, items, items};
+  std::reverse(orders[1].begin(), orders[1].end());
+  std::shuffle(orders[2].begin(), orders[2].end(), std::mt19937(42));
+
+  for (const auto& order : orders) {
+    SmallBlockList list;
+    for (size_t item : order) {
+      ASSERT_TRUE(list.add(item));
+    }
+    for (size_t i = 0; i < 3 * kNumItems; i++) {
+      ASSERT_EQ(list.contains(i), i % 3 == 0);
+    }
+    // Remove every other item, then the rest
+    for (size_t i = 0; i < kNumItems; i += 2) {
+      ASSERT_TRUE(list.remove(order[i]));
+    }
+    for (size_t i = 0; i < kNumItems; i++) {
+      ASSERT_EQ(list.contains(order[i]), i % 2 == 1);
+    }
+    for (size_t i = 1; i < kNumItems; i += 2) {
+      ASSERT_TRUE(list.remove(order[i]));
+    }
+    for (size_t item : items) {
+      ASSERT_FALSE(list.contains(item));
+    }
+  }
+}
+
+TEST_F(UnrolledLazyListTest, ConcurrentAddDifferentItems) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 2000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t]() {
+      // Interleaved items, so that threads split the same blocks
+      for (int i = 0; i < kItemsPerThread; i++) {
+        EXPECT_TRUE(list_.add(i * kNumThreads + t));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumThreads * kItemsPerThread; i++) {
+    ASSERT_TRUE(list_.contains(i));
+  }
+}
+
+TEST(UnrolledLazyListBlockTest, ConcurrentAddRemoveSameItems) {
+  // Every thread adds and removes the same items; for each item, the number
+  // of successful adds minus successful removes is whether it ends up present
+  constexpr int kNumThreads = 4;
+  constexpr size_t kNumItems = 200;
+  constexpr int kOpsPerThread = 20000;
+
+  SmallBlockList list;
+  std::vector<std::atomic<int>> balance(kNumItems);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<size_t> dist(0, kNumItems - 1);
+      for (int i = 0; i < kOpsPerThread; i++) {
+        size_t item = dist(gen);
+        if (gen() % 2 == 0) {
+          balance[item] += list.add(item);
+        } else {
+          balance[item] -= list.remove(item);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < kNumItems; i++) {
+    ASSERT_TRUE(balance[i] == 0 || balance[i] == 1);
+    EXPECT_EQ(list.contains(i), balance[i] == 1);
+  }
+}
+
+TEST(UnrolledLazyListBlockTest, ConcurrentReadersSeeStableItems) {
+  // Even items stay in the list while writers add and remove odd ones, which
+  // splits and merges blocks under the readers; every lookup of an even item
+  // must still find it
+  constexpr size_t kNumItems = 1000;
+  constexpr int kNumWriters = 3;
+  constexpr int kNumRounds = 50;
+
+  SmallBlockList list;
+  for (size_t i = 0; i < kNumItems; i += 2) {
+    EXPECT_TRUE(list.add(i));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kNumWriters; t++) {
+    writers.emplace_back([&list, &done, t]() {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<size_t> dist(0, kNumItems / 2 - 1);
+      while (!done.load()) {
+        size_t value = 2 * dist(gen) + 1;
+        list.add(value);
+        list.remove(value);
+      }
+    });
+  }
+
+  for (int round = 0; round < kNumRounds; round++) {
+    for (size_t i = 0; i < kNumItems; i += 2) {
+      ASSERT_TRUE(list.contains(i));
+    }
+  }
+
+  done.store(true);
+  for (auto& writer : writers) {
+    writer.join();
+  }
+}
@@ -0,0 +1,129 @@
+#include "memory/background_reclaimer.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "list/lazy_list.h"
+#include "memory/epoch_based_reclamation.h"
+#include "memory/hazard_ptr.h"
+#include "memory/pool_allocator.h"
+#include "memory/rcu.h"
+
+// A node that counts how many instances have been destroyed, and on which
+// thread the last one was
+struct TrackedNode {
+  explicit TrackedNode(std::atomic<int>* num_deleted)
+      : num_deleted_(num_deleted) {}
+
+  ~TrackedNode() {
+    deleted_on = std::this_thread::get_id();
+    num_deleted_->fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static inline std::atomic<std::thread::id> deleted_on;
+
+  std::atomic<int>* num_deleted_;
+};
+
+template<typename Reclaimer>
+class BackgroundReclaimerTest : public ::testing::Test {};
+
+using Reclaimers =
+    ::testing::Types<HazardPtr, EpochBasedReclamation, QsbrRcu, MembRcu>;
+TYPED_TEST_SUITE(BackgroundReclaimerTest, Reclaimers);
+
+TYPED_TEST(BackgroundReclaimerTest, ExpiredPointersAreFreedInTheBackground) {
+  constexpr int kNumRetired = 1000;
+  std::atomic<int> num_deleted{0};
+  BackgroundReclaimer background;
+  background.install();
+  {
+    TypeParam reclaimer;
+    for (int i = 0; i < kNumRetired; i++) {
+      reclaimer.op_begin();
+      reclaimer.sched_for_reclaim(new TrackedNode(&num_deleted));
+      reclaimer.op_end();
+    }
+    reclaimer.flush();
+    if constexpr (requires { reclaimer.synchronize_rcu(); }) {
+      reclaimer.synchronize_rcu();
+    }
+
+    background.drain();
+    EXPECT_GT(num_deleted.load(), 0);
+    EXPECT_EQ(static_cast<uint64_t>(num_deleted.load()),
+              background.num_freed());
+    EXPECT_NE(TrackedNode::deleted_on.load(), std::this_thread::get_id());
+  }
+  // Whatever the domain still held is freed by its destructor
+  EXPECT_EQ(num_deleted.load(), kNumRetired);
+}
+
+TEST(BackgroundReclaimerTest, UninstalledReclaimerIsNotUsed) {
+  std::atomic<int> num_deleted{0};
+  BackgroundReclaimer background;
+  background.install();
+  EXPECT_EQ(BackgroundReclaimer::installed(), &background);
+  background.uninstall();
+  EXPECT_EQ(BackgroundReclaimer::installed(), nullptr);
+
+  EpochBasedReclamation ebr;
+  ebr.op_begin();
+  ebr.sched_for_reclaim(new TrackedNode(&num_deleted));
+  ebr.op_end();
+  ebr.flush();
+  EXPECT_EQ(num_deleted.load(), 1);
+  EXPECT_EQ(TrackedNode::deleted_on.load(), std::this_thread::get_id());
+  EXPECT_EQ(background.num_freed(), 0u);
+}
+
+TEST(BackgroundReclaimerTest, DestructorFreesSubmittedBatches) {
+  constexpr int kNumBatches = 100;
+  std::atomic<int> num_deleted{0};
+  {
+    BackgroundReclaimer background;
+    for (int i = 0; i < kNumBatches; i++) {
+      std::vector<data_to_reclaim> batch{new TrackedNode(&num_deleted),
+                                         new TrackedNode(&num_deleted)};
+      background.submit(batch);
+      EXPECT_TRUE(batch.empty());
+    }
+  }
+  EXPECT_EQ(num_deleted.load(), 2 * kNumBatches);
+}
+
+TEST(BackgroundReclaimerTest, ConcurrentListUpdatesWithPooledNodes) {
+  // Removed nodes return to the pool from the reclaimer thread, and the
+  // updating threads allocate them again through the pool's depot
+  constexpr int kNumThreads = 4;
+  constexpr int kOpsPerThread = 20000;
+  BackgroundReclaimer background;
+  background.install();
+  {
+    LazyList<int, std::hash<int>, EpochBasedReclamation, void, PoolAllocator>
+        list;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&list, t]() {
+        for (int i = 0; i < kOpsPerThread; i++) {
+          int item = (i % 100) * kNumThreads + t;
+          if (i % 200 < 100) {
+            EXPECT_TRUE(list.add(item));
+          } else {
+            EXPECT_TRUE(list.remove(item));
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (int i = 0; i < 100 * kNumThreads; i++) {
+      EXPECT_FALSE(list.contains(i));
+    }
+  }
+  background.drain();
+  EXPECT_GT(background.num_freed(), 0u);
+}
@@ -0,0 +1,182 @@
+#include "memory/epoch_based_reclamation.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// A node that counts how many instances have been destroyed
+struct TrackedNode {
+  explicit TrackedNode(std::atomic<int>* num_deleted, int value = 0)
+      : num_deleted_(num_deleted), value_(value) {}
+
+  ~TrackedNode() { num_deleted_->fetch_add(1, std::memory_order_relaxed); }
+
+  std::atomic<int>* num_deleted_;
+  int value_;
+};
+
+TEST(EpochBasedReclamationTest, FlushReclaimsWhenQuiescent) {
+  std::atomic<int> num_deleted{0};
+  EpochBasedReclamation ebr;
+
+  ebr.op_begin();
+  ebr.sched_for_reclaim(new TrackedNode(&num_deleted));
+  ebr.op_end();
+
+  EXPECT_EQ(num_deleted.load(), 0);
+  EXPECT_EQ(ebr.num_pending(), 1);
+
+  ebr.flush();
+  EXPECT_EQ(num_deleted.load(), 1);
+  EXPECT_EQ(ebr.num_pending(), 0);
+}
+
+TEST(EpochBasedReclamationTest, RetiredPointersAreBounded) {
+  constexpr int kNumRetired = 1000;
+  std::atomic<int> num_deleted{0};
+  EpochBasedReclamation ebr;
+
+  for (int i = 0; i < kNumRetired; i++) {
+    ebr.op_begin();
+    ebr.sched_for_reclaim(new TrackedNode(&num_deleted));
+    ebr.op_end();
+  }
+
+  // Without lagging threads the epoch keeps advancing, so only the last few
+  // epochs worth of retired pointers are pending
+  EXPECT_LT(ebr.num_pending(), 256);
+  EXPECT_EQ(num_deleted.load() + static_cast<int>(ebr.num_pending()),
+            kNumRetired);
+}
+
+TEST(EpochBasedReclamationTest, ActiveReaderBlocksReclamation) {
+  std::atomic<int> num_deleted{0};
+  EpochBasedReclamation ebr;
+  auto node = new TrackedNode(&num_deleted, 42);
+
+  std::atomic<bool> started{false};
+  std::atomic<bool> done{false};
+  std::thread reader([&]() {
+    ebr.op_begin();
+    started.store(true);
+    while (!done.load()) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(node->value_, 42);
+    ebr.op_end();
+  });
+
+  while (!started.load()) {
+    std::this_thread::yield();
+  }
+
+  ebr.op_begin();
+  ebr.sched_for_reclaim(node);
+  ebr.op_end();
+  ebr.flush();
+  EXPECT_EQ(num_deleted.load(), 0);
+
+  done.store(true);
+  reader.join();
+
+  ebr.flush();
+  EXPECT_EQ(num_deleted.load(), 1);
+}
+
+TEST(EpochBasedReclamationTest, NestedOperations) {
+  std::atomic<int> num_deleted{0};
+  EpochBasedReclamation ebr;
+  auto node = new TrackedNode(&num_deleted);
+
+  std::atomic<bool> started{false};
+  std::atomic<bool> inner_done{false};
+  std::atomic<bool> done{false};
+  std::thread reader([&]() {
+    ebr.op_begin();
+    ebr.op_begin();
+    started.store(true);
+    ebr.op_end();
+    inner_done.store(true);
+    // Still protected by the outer operation
+    while (!done.load()) {
+      std::this_thread::yield();
+    }
+    ebr.op_end();
+  });
+
+  while (!started.load()) {
+    std::this_thread::yield();
+  }
+  ebr.sched_for_reclaim(node);
+  while (!inner_done.load()) {
+    std::this_thread::yield();
+  }
+  ebr.flush();
+  EXPECT_EQ(num_deleted.load(), 0);
+
+  done.store(true);
+  reader.join();
+  ebr.flush();
+  EXPECT_EQ(num_deleted.load(), 1);
+}
+
+TEST(EpochBasedReclamationTest, DestructorReclaimsPending) {
+  std::atomic<int> num_deleted{0};
+  {
+    EpochBasedReclamation ebr;
+    for (int i = 0; i < 10; i++) {
+      ebr.sched_for_reclaim(new TrackedNode(&num_deleted));
+    }
+  }
+  EXPECT_EQ(num_deleted.load(), 10);
+}
+
+// Threads repeatedly swap a shared pointer and read through it inside an
+// operation, so the sanitizer would flag a premature reclamation as a
+// use-after-free.
+TEST(EpochBasedReclamationTest, ConcurrentReadAndRetire) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumIterations = 5000;
+  std::atomic<int> num_deleted{0};
+  std::atomic<int> num_allocated{1};
+
+  {
+    EpochBasedReclamation ebr;
+    std::atomic<TrackedNode*> shared{new TrackedNode(&num_deleted)};
+
+    std::vector<std::thread> threads;
+    threads.reserve(kNumThreads);
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < kNumIterations; i++) {
+          ebr.op_begin();
+          TrackedNode* node = shared.load();
+          EXPECT_GE(node->value_, 0);
+
+          if (i % 2 == t % 2) {
+            auto new_node = new TrackedNode(&num_deleted, i);
+            num_allocated.fetch_add(1);
+            TrackedNode* expected = node;
+            if (shared.compare_exchange_strong(expected, new_node)) {
+              ebr.sched_for_reclaim(node);
+            } else {
+              delete new_node;
+            }
+          }
+          ebr.op_end();
+        }
+        ebr.unregister_thread();
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    delete shared.load();
+  }
+
+  EXPECT_EQ(num_deleted.load(), num_allocated.load());
+}
@@ -0,0 +1,206 @@
+#include "memory/hazard_ptr.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// A node that counts how many instances have been destroyed
+struct TrackedNode {
+  explicit TrackedNode(std::atomic<int>* num_deleted, int value = 0)
+      : num_deleted_(num_deleted), value_(value) {}
+
+  ~TrackedNode() { num_deleted_->fetch_add(1, std::memory_order_relaxed); }
+
+  std::atomic<int>* num_deleted_;
+  int value_;
+};
+
+TEST(HazardPtrTest, RetiredPointersAreBatched) {
+  std::atomic<int> num_deleted{0};
+  HazardPtr hazard_ptr;
+
+  hazard_ptr.op_begin();
+  hazard_ptr.sched_for_reclaim(new TrackedNode(&num_deleted));
+  hazard_ptr.op_end();
+
+  // A single retired pointer stays in the batch until the threshold is hit
+  EXPECT_EQ(num_deleted.load(), 0);
+  EXPECT_EQ(hazard_ptr.num_pending(), 1);
+
+  hazard_ptr.flush();
+  EXPECT_EQ(num_deleted.load(), 1);
+  EXPECT_EQ(hazard_ptr.num_pending(), 0);
+}
+
+TEST(HazardPtrTest, ThresholdTriggersScan) {
+  constexpr int kNumRetired = 1000;
+  std::atomic<int> num_deleted{0};
+  HazardPtr hazard_ptr;
+
+  for (int i = 0; i < kNumRetired; i++) {
+    hazard_ptr.op_begin();
+    hazard_ptr.sched_for_reclaim(new TrackedNode(&num_deleted));
+    hazard_ptr.op_end();
+  }
+
+  // Pending reclaims are bounded by the scan threshold, not by the number of
+  // retired pointers
+  EXPECT_LT(hazard_ptr.num_pending(), 100);
+  EXPECT_EQ(num_deleted.load() + static_cast<int>(hazard_ptr.num_pending()),
+            kNumRetired);
+}
+
+TEST(HazardPtrTest, ReservedPointerIsNotReclaimed) {
+  std::atomic<int> num_deleted{0};
+  HazardPtr hazard_ptr;
+  auto protected_node = new TrackedNode(&num_deleted, 42);
+
+  std::atomic<bool> reserved{false};
+  std::atomic<bool> done{false};
+  std::thread reader([&]() {
+    hazard_ptr.op_begin();
+    hazard_ptr.try_reserve(protected_node);
+    reserved.store(true);
+    while (!done.load()) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(protected_node->value_, 42);
+    hazard_ptr.op_end();
+  });
+
+  while (!reserved.load()) {
+    std::this_thread::yield();
+  }
+
+  hazard_ptr.op_begin();
+  hazard_ptr.sched_for_reclaim(protected_node);
+  hazard_ptr.op_end();
+  hazard_ptr.flush();
+  EXPECT_EQ(num_deleted.load(), 0);
+
+  done.store(true);
+  reader.join();
+
+  hazard_ptr.flush();
+  EXPECT_EQ(num_deleted.load(), 1);
+}
+
+TEST(HazardPtrTest, UnreserveAllowsReclamation) {
+  std::atomic<int> num_deleted{0};
+  HazardPtr hazard_ptr;
+  auto node = new TrackedNode(&num_deleted);
+
+  hazard_ptr.op_begin();
+  hazard_ptr.try_reserve(node);
+  hazard_ptr.sched_for_reclaim(node);
+  hazard_ptr.flush();
+  EXPECT_EQ(num_deleted.load(), 0);
+
+  hazard_ptr.unreserve(node);
+  hazard_ptr.flush();
+  EXPECT_EQ(num_deleted.load(), 1);
+  hazard_ptr.op_end();
+}
+
+TEST(HazardPtrTest, ReservationLimit) {
+  HazardPtr hazard_ptr;
+  hazard_ptr.register_thread(2);
+
+  int a, b, c;
+  hazard_ptr.op_begin();
+  EXPECT_TRUE(hazard_ptr.try_reserve(&a));
+  EXPECT_TRUE(hazard_ptr.try_reserve(&b));
+  EXPECT_THROW(hazard_ptr.try_reserve(&c), std::runtime_error);
+  hazard_ptr.op_end();
+}
+
+TEST(HazardPtrTest, DestructorReclaimsPending) {
+  std::atomic<int> num_deleted{0};
+  {
+    HazardPtr hazard_ptr;
+    for (int i = 0; i < 10; i++) {
+      hazard_ptr.sched_for_reclaim(new TrackedNode(&num_deleted));
+    }
+  }
+  EXPECT_EQ(num_deleted.load(), 10);
+}
+
+TEST(HazardPtrTest, MultipleDomainsPerThread) {
+  std::atomic<int> num_deleted{0};
+  HazardPtr first;
+  HazardPtr second;
+  int value;
+
+  first.op_begin();
+  second.op_begin();
+  first.try_reserve(&value);
+  second.sched_for_reclaim(new TrackedNode(&num_deleted));
+
+  // Reservations of one domain do not leak into the other
+  EXPECT_EQ(first.num_pending(), 0);
+  EXPECT_EQ(second.num_pending(), 1);
+  second.flush();
+  EXPECT_EQ(num_deleted.load(), 1);
+
+  first.op_end();
+  second.op_end();
+}
+
+// Threads repeatedly swap a shared pointer and read through it. Each reader
+// protects the pointer with a hazard pointer before dereferencing it, so the
+// sanitizer would flag a premature reclamation as a use-after-free.
+TEST(HazardPtrTest, ConcurrentProtectAndRetire) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumIterations = 5000;
+  std::atomic<int> num_deleted{0};
+  std::atomic<int> num_allocated{1};
+
+  {
+    HazardPtr hazard_ptr;
+    std::atomic<TrackedNode*> shared{new TrackedNode(&num_deleted)};
+
+    std::vector<std::thread> threads;
+    threads.reserve(kNumThreads);
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < kNumIterations; i++) {
+          hazard_ptr.op_begin();
+          TrackedNode* node;
+          do {
+            node = shared.load();
+            hazard_ptr.try_reserve(node);
+            if (node == shared.load()) {
+              break;
+            }
+            hazard_ptr.unreserve(node);
+          } while (true);
+
+          EXPECT_GE(node->value_, 0);
+
+          if (i % 2 == t % 2) {
+            auto new_node = new TrackedNode(&num_deleted, i);
+            num_allocated.fetch_add(1);
+            TrackedNode* expected = node;
+            if (shared.compare_exchange_strong(expected, new_node)) {
+              hazard_ptr.sched_for_reclaim(node);
+            } else {
+              delete new_node;
+            }
+          }
+          hazard_ptr.op_end();
+        }
+        hazard_ptr.unregister_thread();
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    delete shared.load();
+  }
+
+  EXPECT_EQ(num_deleted.load(), num_allocated.load());
+}
@@ -0,0 +1,139 @@
+#include "memory/pool_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+struct PooledNode : AllocatedBy<PoolAllocator> {
+  int64_t value_;
+  PooledNode* next_{nullptr};
+
+  explicit PooledNode(int64_t value) : value_(value) {}
+};
+
+struct alignas(64) AlignedNode : AllocatedBy<PoolAllocator> {
+  int value_{0};
+};
+
+TEST(PoolAllocatorTest, FreedBlocksAreReused) {
+  auto first = new PooledNode(1);
+  void* address = first;
+  delete first;
+
+  // The block is on top of the calling thread's cache
+  auto second = new PooledNode(2);
+  EXPECT_EQ(address, static_cast<void*>(second));
+  EXPECT_EQ(second->value_, 2);
+  delete second;
+}
+
+TEST(PoolAllocatorTest, BlocksAreDistinctAndAligned) {
+  constexpr int kNumNodes = 1000;
+  std::vector<AlignedNode*> nodes;
+  std::set<AlignedNode*> addresses;
+  for (int i = 0; i < kNumNodes; i++) {
+    nodes.push_back(new AlignedNode());
+    addresses.insert(nodes.back());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(nodes.back()) % 64, 0U);
+  }
+  EXPECT_EQ(addresses.size(), static_cast<size_t>(kNumNodes));
+  for (auto node : nodes) {
+    delete node;
+  }
+}
+
+TEST(PoolAllocatorTest, LargeObjectsBypassThePool) {
+  struct LargeNode : AllocatedBy<PoolAllocator> {
+    char data_[PoolAllocator::kMaxPooledSize + 1];
+  };
+  auto node = new LargeNode();
+  node->data_[PoolAllocator::kMaxPooledSize] = 'x';
+  delete node;
+}
+
+TEST(PoolAllocatorTest, BlocksFreedByAnotherThreadAreRecycled) {
+  constexpr int kNumNodes = 10000;
+  std::vector<PooledNode*> nodes(kNumNodes);
+  for (int i = 0; i < kNumNodes; i++) {
+    nodes[i] = new PooledNode(i);
+  }
+
+  // The freeing thread gives full batches back to the shared depot, and the
+  // rest of its cache when it exits
+  std::thread consumer([&nodes]() {
+    for (auto node : nodes) {
+      delete node;
+    }
+  });
+  consumer.join();
+
+  // Except for the blocks left in the calling thread's cache, every new node
+  // reuses a block freed by the other thread
+  std::set<void*> freed(nodes.begin(), nodes.end());
+  size_t recycled = 0;
+  for (int i = 0; i < kNumNodes; i++) {
+    nodes[i] = new PooledNode(i);
+    recycled += freed.count(nodes[i]);
+  }
+  EXPECT_GE(recycled, kNumNodes - NodePool::kBatchSize);
+  for (auto node : nodes) {
+    delete node;
+  }
+}
+
+TEST(PoolAllocatorTest, ConcurrentProducersAndConsumers) {
+  constexpr int kNumPairs = 4;
+  constexpr int kNodesPerProducer = 20000;
+
+  // Each producer hands its nodes to a consumer through a lock-free stack, so
+  // blocks constantly migrate between threads
+  struct Channel {
+    std::atomic<PooledNode*> top_{nullptr};
+    std::atomic<bool> done_{false};
+  };
+  std::vector<Channel> channels(kNumPairs);
+  std::atomic<int64_t> sum{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kNumPairs; p++) {
+    threads.emplace_back([&channel = channels[p]]() {
+      for (int i = 0; i < kNodesPerProducer; i++) {
+        auto node = new PooledNode(i);
+        node->next_ = channel.top_.load(std::memory_order_relaxed);
+        while (!channel.top_.compare_exchange_weak(
+            node->next_, node, std::memory_order_release,
+            std::memory_order_relaxed)) {}
+      }
+      channel.done_.store(true, std::memory_order_release);
+    });
+    threads.emplace_back([&channel = channels[p], &sum]() {
+      while (true) {
+        bool done = channel.done_.load(std::memory_order_acquire);
+        PooledNode* node =
+            channel.top_.exchange(nullptr, std::memory_order_acquire);
+        while (node != nullptr) {
+          PooledNode* next = node->next_;
+          sum.fetch_add(node->value_, std::memory_order_relaxed);
+          delete node;
+          node = next;
+        }
+        if (done) {
+          break;
+        }
+        std::this_thread::yield();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  int64_t expected =
+      kNumPairs * (int64_t{kNodesPerProducer} * (kNodesPerProducer - 1) / 2);
+  EXPECT_EQ(sum.load(), expected);
+}
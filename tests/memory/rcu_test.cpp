@@ -0,0 +1,297 @@
+#include "memory/rcu.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// A node that counts how many instances have been destroyed
+struct TrackedNode {
+  explicit TrackedNode(std::atomic<int>* num_deleted, int value = 0)
+      : num_deleted_(num_deleted), value_(value) {}
+
+  ~TrackedNode() { num_deleted_->fetch_add(1, std::memory_order_relaxed); }
+
+  std::atomic<int>* num_deleted_;
+  int value_;
+};
+
+// Reports a quiescent state to QSBR domains; memb domains need none
+template<typename Rcu>
+auto quiesce(Rcu& rcu) -> void {
+  if constexpr (requires { rcu.quiescent_state(); }) {
+    rcu.quiescent_state();
+  }
+}
+
+template<typename Rcu>
+class RcuTest : public ::testing::Test {};
+
+using RcuFlavors = ::testing::Types<QsbrRcu, MembRcu>;
+TYPED_TEST_SUITE(RcuTest, RcuFlavors);
+
+TYPED_TEST(RcuTest, SynchronizeReclaimsEverything) {
+  constexpr int kNumRetired = 1000;
+  std::atomic<int> num_deleted{0};
+  TypeParam rcu;
+
+  for (int i = 0; i < kNumRetired; i++) {
+    rcu.read_lock();
+    rcu.call_rcu(new TrackedNode(&num_deleted));
+    rcu.read_unlock();
+  }
+  EXPECT_EQ(num_deleted.load() + static_cast<int>(rcu.num_pending()),
+            kNumRetired);
+
+  rcu.synchronize_rcu();
+  rcu.flush();
+  EXPECT_EQ(num_deleted.load(), kNumRetired);
+  EXPECT_EQ(rcu.num_pending(), 0);
+}
+
+TYPED_TEST(RcuTest, SynchronizeWaitsForReaders) {
+  TypeParam rcu;
+  std::atomic<bool> started{false};
+  std::atomic<bool> release{false};
+  std::atomic<bool> synchronized{false};
+
+  std::thread reader([&]() {
+    rcu.read_lock();
+    started.store(true);
+    while (!release.load()) {
+      std::this_thread::yield();
+    }
+    EXPECT_FALSE(synchronized.load());
+    rcu.read_unlock();
+    rcu.unregister_thread();
+  });
+  while (!started.load()) {
+    std::this_thread::yield();
+  }
+
+  std::thread writer([&]() {
+    rcu.synchronize_rcu();
+    synchronized.store(true);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(synchronized.load());
+
+  release.store(true);
+  reader.join();
+  writer.join();
+  EXPECT_TRUE(synchronized.load());
+}
+
+TYPED_TEST(RcuTest, ActiveReaderBlocksCallRcu) {
+  std::atomic<int> num_deleted{0};
+  TypeParam rcu;
+  auto node = new TrackedNode(&num_deleted, 42);
+
+  std::atomic<bool> started{false};
+  std::atomic<bool> done{false};
+  std::thread reader([&]() {
+    rcu.read_lock();
+    started.store(true);
+    while (!done.load()) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(node->value_, 42);
+    rcu.read_unlock();
+    rcu.unregister_thread();
+  });
+  while (!started.load()) {
+    std::this_thread::yield();
+  }
+
+  rcu.call_rcu(node);
+  rcu.flush();
+  EXPECT_EQ(num_deleted.load(), 0);
+
+  done.store(true);
+  reader.join();
+
+  rcu.flush();
+  EXPECT_EQ(num_deleted.load(), 1);
+}
+
+TYPED_TEST(RcuTest, DestructorReclaimsPending) {
+  std::atomic<int> num_deleted{0};
+  {
+    TypeParam rcu;
+    for (int i = 0; i < 10; i++) {
+      rcu.call_rcu(new TrackedNode(&num_deleted));
+    }
+  }
+  EXPECT_EQ(num_deleted.load(), 10);
+}
+
+// Threads repeatedly swap a shared pointer and read through it inside a
+// critical section, so the sanitizer would flag a premature reclamation as a
+// use-after-free.
+TYPED_TEST(RcuTest, ConcurrentReadAndRetire) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumIterations = 5000;
+  std::atomic<int> num_deleted{0};
+  std::atomic<int> num_allocated{1};
+
+  {
+    TypeParam rcu;
+    std::atomic<TrackedNode*> shared{new TrackedNode(&num_deleted)};
+
+    std::vector<std::thread> threads;
+    threads.reserve(kNumThreads);
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&, t]() {
+        for (int i = 0; i < kNumIterations; i++) {
+          rcu.read_lock();
+          TrackedNode* node = shared.load();
+          EXPECT_GE(node->value_, 0);
+
+          if (i % 2 == t % 2) {
+            auto new_node = new TrackedNode(&num_deleted, i);
+            num_allocated.fetch_add(1);
+            TrackedNode* expected = node;
+            if (shared.compare_exchange_strong(expected, new_node)) {
+              rcu.call_rcu(node);
+            } else {
+              delete new_node;
+            }
+          }
+          rcu.read_unlock();
+          quiesce(rcu);
+        }
+        rcu.unregister_thread();
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    delete shared.load();
+  }
+
+  EXPECT_EQ(num_deleted.load(), num_allocated.load());
+}
+
+TEST(MembRcuTest, NestedReadSections) {
+  std::atomic<int> num_deleted{0};
+  MembRcu rcu;
+  auto node = new TrackedNode(&num_deleted);
+
+  std::atomic<bool> started{false};
+  std::atomic<bool> inner_done{false};
+  std::atomic<bool> done{false};
+  std::thread reader([&]() {
+    rcu.read_lock();
+    rcu.read_lock();
+    started.store(true);
+    rcu.read_unlock();
+    inner_done.store(true);
+    // Still protected by the outer section
+    while (!done.load()) {
+      std::this_thread::yield();
+    }
+    rcu.read_unlock();
+  });
+
+  while (!started.load()) {
+    std::this_thread::yield();
+  }
+  rcu.call_rcu(node);
+  while (!inner_done.load()) {
+    std::this_thread::yield();
+  }
+  rcu.flush();
+  EXPECT_EQ(num_deleted.load(), 0);
+
+  done.store(true);
+  reader.join();
+  rcu.flush();
+  EXPECT_EQ(num_deleted.load(), 1);
+}
+
+TEST(QsbrRcuTest, QuiescentStatesBoundPendingPointers) {
+  constexpr int kNumRetired = 10000;
+  std::atomic<int> num_deleted{0};
+  QsbrRcu rcu;
+
+  for (int i = 0; i < kNumRetired; i++) {
+    rcu.read_lock();
+    rcu.call_rcu(new TrackedNode(&num_deleted));
+    rcu.read_unlock();
+    rcu.quiescent_state();
+  }
+
+  // Each quiescent state ends the grace period of the last full batch
+  EXPECT_LT(rcu.num_pending(), 256);
+  EXPECT_EQ(num_deleted.load() + static_cast<int>(rcu.num_pending()),
+            kNumRetired);
+}
+
+TEST(QsbrRcuTest, OnlineThreadBlocksUntilQuiescent) {
+  QsbrRcu rcu;
+  std::atomic<int> phase{0};
+  std::atomic<bool> synchronized{false};
+
+  // The reader is online from its first read, even after read_unlock(), until
+  // it reports a quiescent state
+  std::thread reader([&]() {
+    rcu.read_lock();
+    rcu.read_unlock();
+    phase.store(1);
+    while (phase.load() != 2) {
+      std::this_thread::yield();
+    }
+    rcu.quiescent_state();
+    while (phase.load() != 3) {
+      std::this_thread::yield();
+    }
+    rcu.unregister_thread();
+  });
+  while (phase.load() != 1) {
+    std::this_thread::yield();
+  }
+
+  std::thread writer([&]() {
+    rcu.synchronize_rcu();
+    synchronized.store(true);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(synchronized.load());
+
+  phase.store(2);
+  writer.join();
+  EXPECT_TRUE(synchronized.load());
+  phase.store(3);
+  reader.join();
+}
+
+TEST(QsbrRcuTest, OfflineThreadDoesNotBlock) {
+  QsbrRcu rcu;
+  std::atomic<bool> offline{false};
+  std::atomic<bool> done{false};
+
+  std::thread reader([&]() {
+    rcu.read_lock();
+    rcu.read_unlock();
+    rcu.thread_offline();
+    offline.store(true);
+    while (!done.load()) {
+      std::this_thread::yield();
+    }
+    // Reading again brings the thread back online
+    rcu.read_lock();
+    rcu.read_unlock();
+    rcu.unregister_thread();
+  });
+  while (!offline.load()) {
+    std::this_thread::yield();
+  }
+
+  rcu.synchronize_rcu();
+  done.store(true);
+  reader.join();
+}
@@ -0,0 +1,60 @@
+#include "priority_queue/flat_combining_priority_queue.h"
+
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class FlatCombiningPriorityQueueTest : public ::testing::Test {
+ protected:
+  FlatCombiningPriorityQueue<int> queue_;
+};
+
+// Normal Cases
+
+// Test that items come out in priority order, and equal priorities in FIFO
+// order.
+TEST_F(FlatCombiningPriorityQueueTest, PriorityThenFifoOrder) {
+  queue_.add(30, 3);
+  queue_.add(11, 1);
+  queue_.add(12, 1);
+  queue_.add(0, 0);
+  for (int item : {0, 11, 12, 30}) {
+    EXPECT_EQ(queue_.remove_min(), item);
+  }
+  EXPECT_FALSE(queue_.remove_min().has_value());
+}
+
+// Concurrent Operations
+
+// Test that concurrent adds and removes lose and duplicate no items.
+TEST_F(FlatCombiningPriorityQueueTest, ConcurrentAddAndRemoveMin) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 10000;
+
+  std::vector<std::atomic<int>> taken(kNumThreads * kItemsPerThread);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t, &taken]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        int item = t * kItemsPerThread + i;
+        queue_.add(item, item % 100);
+        if (std::optional<int> min = queue_.remove_min()) {
+          taken[*min]++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  while (std::optional<int> min = queue_.remove_min()) {
+    taken[*min]++;
+  }
+
+  for (const auto& count : taken) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
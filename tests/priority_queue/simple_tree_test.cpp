@@ -0,0 +1,95 @@
+#include "priority_queue/simple_tree.h"
+
+#include <atomic>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class SimpleTreeTest : public ::testing::Test {
+ protected:
+  static constexpr int kRange = 16;
+
+  SimpleTree<int> queue_{kRange};
+};
+
+// Normal Cases
+
+// Test that items come out in priority order.
+TEST_F(SimpleTreeTest, RemoveMinFollowsPriority) {
+  for (int priority : {5, 3, 9, 0, 15, 7}) {
+    queue_.add(priority * 10, priority);
+  }
+  for (int priority : {0, 3, 5, 7, 9, 15}) {
+    EXPECT_EQ(queue_.remove_min(), priority * 10);
+  }
+  EXPECT_FALSE(queue_.remove_min().has_value());
+}
+
+// Test that several items may share a priority.
+TEST_F(SimpleTreeTest, SharedPriority) {
+  queue_.add(1, 4);
+  queue_.add(2, 4);
+  queue_.add(0, 2);
+  EXPECT_EQ(queue_.remove_min(), 0);
+  int sum = *queue_.remove_min() + *queue_.remove_min();
+  EXPECT_EQ(sum, 3);
+  EXPECT_FALSE(queue_.remove_min().has_value());
+}
+
+// Edge Cases
+
+// Test that the range is rounded up to a power of two and enforced.
+TEST(SimpleTreeRangeTest, RangeIsRoundedUpAndChecked) {
+  SimpleTree<int> queue(5);
+  EXPECT_EQ(queue.range(), 8U);
+  queue.add(7, 7);
+  EXPECT_THROW(queue.add(8, 8), std::out_of_range);
+  EXPECT_EQ(queue.remove_min(), 7);
+
+  SimpleTree<int> single(1);
+  single.add(1, 0);
+  EXPECT_EQ(single.remove_min(), 1);
+  EXPECT_FALSE(single.remove_min().has_value());
+}
+
+// Concurrent Operations
+
+// Test that once the adders are done, concurrent removers take every item
+// exactly once.
+TEST_F(SimpleTreeTest, ConcurrentAddAndRemoveMin) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 5000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        int item = i * kNumThreads + t;
+        queue_.add(item, item % kRange);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  std::vector<std::atomic<int>> taken(kNumThreads * kItemsPerThread);
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, &taken]() {
+      while (std::optional<int> item = queue_.remove_min()) {
+        taken[*item]++;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& count : taken) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
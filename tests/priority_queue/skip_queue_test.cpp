@@ -0,0 +1,102 @@
+#include "priority_queue/skip_queue.h"
+
+#include <atomic>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class SkipQueueTest : public ::testing::Test {
+ protected:
+  SkipQueue<int> queue_;
+};
+
+// Normal Cases
+
+// Test that items come out in priority order.
+TEST_F(SkipQueueTest, RemoveMinFollowsPriority) {
+  for (int priority : {5, 3, 9, 0, 7}) {
+    queue_.add(priority * 10, priority);
+  }
+  for (int priority : {0, 3, 5, 7, 9}) {
+    EXPECT_EQ(queue_.remove_min(), priority * 10);
+  }
+  EXPECT_FALSE(queue_.remove_min().has_value());
+}
+
+// Test that items of the same priority come out in the order they were added.
+TEST_F(SkipQueueTest, EqualPrioritiesAreFifo) {
+  for (int i = 0; i < 10; i++) {
+    queue_.add(i, 1);
+  }
+  queue_.add(-1, 0);
+  EXPECT_EQ(queue_.remove_min(), -1);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(queue_.remove_min(), i);
+  }
+}
+
+// Edge Cases
+
+// Test the empty queue and the extreme priorities.
+TEST_F(SkipQueueTest, EmptyAndExtremePriorities) {
+  EXPECT_FALSE(queue_.remove_min().has_value());
+  queue_.add(2, UINT32_MAX);
+  queue_.add(1, 0);
+  EXPECT_EQ(queue_.remove_min(), 1);
+  EXPECT_EQ(queue_.remove_min(), 2);
+  EXPECT_FALSE(queue_.remove_min().has_value());
+}
+
+// Test that items that are not trivially copyable are moved out intact.
+TEST(SkipQueueStringTest, HoldsStrings) {
+  SkipQueue<std::string> queue;
+  queue.add(std::string(100, 'b'), 2);
+  queue.add(std::string(100, 'a'), 1);
+  EXPECT_EQ(queue.remove_min(), std::string(100, 'a'));
+  EXPECT_EQ(queue.remove_min(), std::string(100, 'b'));
+}
+
+// Concurrent Operations
+
+// Test that concurrent removers take every item exactly once, and that each
+// remover sees its items in priority order.
+TEST_F(SkipQueueTest, ConcurrentAddAndRemoveMin) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 5000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        int item = i * kNumThreads + t;
+        queue_.add(item, item);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  std::vector<std::atomic<int>> taken(kNumThreads * kItemsPerThread);
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, &taken]() {
+      int last = -1;
+      while (std::optional<int> item = queue_.remove_min()) {
+        EXPECT_GT(*item, last);
+        last = *item;
+        taken[*item]++;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& count : taken) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
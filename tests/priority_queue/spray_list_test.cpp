@@ -0,0 +1,90 @@
+#include "priority_queue/spray_list.h"
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// Normal Cases
+
+// Test that a single-threaded SprayList removes every item once, mostly from
+// the front. The distance depends on the node levels and jumps drawn, so the
+// generator is seeded to make the test reproducible.
+TEST(SprayListTest, RemovesEveryItemNearTheFront) {
+  constexpr int kNumItems = 1000;
+  SprayList<int>::seed_random(1);
+  SprayList<int> queue(1);
+  for (int i = 0; i < kNumItems; i++) {
+    queue.add(i, i);
+  }
+
+  std::vector<bool> taken(kNumItems, false);
+  int smallest = 0;
+  int64_t total_distance = 0;
+  for (int i = 0; i < kNumItems; i++) {
+    std::optional<int> item = queue.remove_min();
+    ASSERT_TRUE(item.has_value());
+    EXPECT_FALSE(taken[*item]);
+    taken[*item] = true;
+    while (smallest < kNumItems && taken[smallest]) {
+      smallest++;
+    }
+    total_distance += *item >= smallest ? *item - smallest : 0;
+  }
+  // A spray of one thread jumps over a couple of nodes on average
+  EXPECT_LT(total_distance, 4 * kNumItems);
+  EXPECT_FALSE(queue.remove_min().has_value());
+}
+
+// Edge Cases
+
+// Test that a spray wider than the queue still finds its items.
+TEST(SprayListTest, WideSprayOnSmallQueue) {
+  SprayList<int> queue(64);
+  EXPECT_FALSE(queue.remove_min().has_value());
+  queue.add(1, 1);
+  queue.add(2, 2);
+  int sum = *queue.remove_min() + *queue.remove_min();
+  EXPECT_EQ(sum, 3);
+  EXPECT_FALSE(queue.remove_min().has_value());
+}
+
+// Concurrent Operations
+
+// Test that concurrent adders and removers lose and duplicate no items.
+TEST(SprayListTest, ConcurrentAddAndRemoveMin) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 5000;
+  SprayList<int> queue(kNumThreads);
+
+  std::vector<std::atomic<int>> taken(kNumThreads * kItemsPerThread);
+  std::atomic<int> num_taken{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&queue, t]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        int item = i * kNumThreads + t;
+        queue.add(item, item % 100);
+      }
+    });
+    threads.emplace_back([&queue, &taken, &num_taken]() {
+      while (num_taken.load() < kNumThreads * kItemsPerThread) {
+        if (std::optional<int> item = queue.remove_min()) {
+          taken[*item]++;
+          num_taken++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& count : taken) {
+    EXPECT_EQ(count.load(), 1);
+  }
+  EXPECT_FALSE(queue.remove_min().has_value());
+}
@@ -0,0 +1,121 @@
+#include "queue/baskets_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(BasketsQueueTest, EnqueueDequeueInOrder) {
+  BasketsQueue<int> queue;
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+  EXPECT_THROW(queue.dequeue(), EmptyException);
+
+  for (int i = 0; i < 100; i++) {
+    queue.enqueue(i);
+  }
+  EXPECT_EQ(queue.approx_size(), 100U);
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(queue.dequeue(), i);
+  }
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+
+  queue.enqueue(7);
+  EXPECT_EQ(queue.try_dequeue(), 7);
+  EXPECT_EQ(queue.approx_size(), 0U);
+}
+
+// Test that move-only items can be enqueued, emplaced and dequeued
+TEST(BasketsQueueTest, MoveOnlyItems) {
+  BasketsQueue<std::unique_ptr<int>> queue;
+  queue.enqueue(std::make_unique<int>(1));
+  queue.emplace(new int(2));
+  EXPECT_EQ(*queue.dequeue(), 1);
+  EXPECT_EQ(*queue.dequeue(), 2);
+}
+
+// Test that producers that end up in the same basket still see their own
+// items dequeued in order, and that every item comes out exactly once
+TEST(BasketsQueueTest, ConcurrentProducersKeepTheirOrder) {
+  constexpr int kNumProducers = 8;
+  constexpr int kNumConsumers = 4;
+  constexpr int kItemsPerProducer = 10000;
+  constexpr int kNumItems = kNumProducers * kItemsPerProducer;
+
+  BasketsQueue<int> queue;
+  std::atomic<int> consumed{0};
+  std::vector<std::vector<int>> received(kNumConsumers);
+
+  std::vector<std::thread> threads;
+  for (int c = 0; c < kNumConsumers; c++) {
+    threads.emplace_back([&, c]() {
+      while (consumed.load() < kNumItems) {
+        if (std::optional<int> value = queue.try_dequeue()) {
+          received[c].push_back(*value);
+          consumed++;
+        }
+      }
+    });
+  }
+  for (int p = 0; p < kNumProducers; p++) {
+    threads.emplace_back([&, p]() {
+      for (int i = 0; i < kItemsPerProducer; i++) {
+        queue.enqueue(p * kItemsPerProducer + i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<int> all;
+  for (const auto& values : received) {
+    std::vector<int> last(kNumProducers, -1);
+    for (int value : values) {
+      int producer = value / kItemsPerProducer;
+      EXPECT_GT(value, last[producer]);
+      last[producer] = value;
+    }
+    all.insert(all.end(), values.begin(), values.end());
+  }
+  std::sort(all.begin(), all.end());
+  ASSERT_EQ(all.size(), static_cast<size_t>(kNumItems));
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_EQ(all[i], i);
+  }
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+// Test that threads that both enqueue and dequeue, often on a near-empty
+// queue, neither lose nor duplicate items
+TEST(BasketsQueueTest, MixedOperations) {
+  constexpr int kNumThreads = 8;
+  constexpr int kOpsPerThread = 20000;
+
+  BasketsQueue<int> queue;
+  std::atomic<int64_t> enqueued_sum{0};
+  std::atomic<int64_t> dequeued_sum{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kOpsPerThread; i++) {
+        if ((i + t) % 2 == 0) {
+          queue.enqueue(i);
+          enqueued_sum += i;
+        } else if (std::optional<int> value = queue.try_dequeue()) {
+          dequeued_sum += *value;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  while (std::optional<int> value = queue.try_dequeue()) {
+    dequeued_sum += *value;
+  }
+  EXPECT_EQ(enqueued_sum.load(), dequeued_sum.load());
+}
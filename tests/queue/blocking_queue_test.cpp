@@ -0,0 +1,129 @@
+#include "queue/blocking_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "queue/lock_free_queue.h"
+#include "queue/mpmc_queue.h"
+#include "queue/unbounded_queue.h"
+
+using namespace std::chrono_literals;
+
+TEST(BlockingQueueTest, EnqueueDequeue) {
+  BlockingQueue<LockFreeQueue<int>> queue;
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+  queue.enqueue(1);
+  queue.enqueue(2);
+  EXPECT_EQ(queue.dequeue(), 1);
+  EXPECT_EQ(queue.try_dequeue(), 2);
+}
+
+TEST(BlockingQueueTest, DequeueSleepsUntilEnqueue) {
+  BlockingQueue<UnboundedQueue<int>> queue;
+  std::atomic<bool> has_dequeued{false};
+
+  std::thread consumer([&]() {
+    EXPECT_EQ(queue.dequeue(), 42);
+    has_dequeued = true;
+  });
+
+  // Long enough for the consumer to give up spinning and park
+  std::this_thread::sleep_for(20ms);
+  EXPECT_FALSE(has_dequeued.load());
+  queue.enqueue(42);
+  consumer.join();
+  EXPECT_TRUE(has_dequeued.load());
+}
+
+TEST(BlockingQueueTest, BoundedEnqueueSleepsWhileFull) {
+  BlockingQueue<MPMCQueue<int>> queue(2);
+  queue.enqueue(1);
+  queue.enqueue(2);
+  std::atomic<bool> has_enqueued{false};
+
+  std::thread producer([&]() {
+    queue.enqueue(3);
+    has_enqueued = true;
+  });
+
+  std::this_thread::sleep_for(20ms);
+  EXPECT_FALSE(has_enqueued.load());
+  EXPECT_EQ(queue.dequeue(), 1);
+  producer.join();
+  EXPECT_TRUE(has_enqueued.load());
+  EXPECT_EQ(queue.dequeue(), 2);
+  EXPECT_EQ(queue.dequeue(), 3);
+}
+
+template<typename Queue>
+void ProducersAndSleepingConsumers(Queue& queue) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumConsumers = 4;
+  constexpr int kElementsPerProducer = 5000;
+
+  std::vector<std::thread> threads;
+  std::vector<int> dequeued;
+  std::mutex deq_mutex;
+
+  // Consumers start first, so that they park on the empty queue
+  for (int c = 0; c < kNumConsumers; c++) {
+    threads.emplace_back([&]() {
+      std::vector<int> local;
+      for (int i = 0; i < kElementsPerProducer; i++) {
+        local.push_back(queue.dequeue());
+      }
+      std::lock_guard<std::mutex> lock(deq_mutex);
+      dequeued.insert(dequeued.end(), local.begin(), local.end());
+    });
+  }
+  std::this_thread::sleep_for(10ms);
+  for (int p = 0; p < kNumProducers; p++) {
+    threads.emplace_back([&queue, p]() {
+      for (int i = 0; i < kElementsPerProducer; i++) {
+        queue.enqueue(p * kElementsPerProducer + i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(dequeued.size(),
+            static_cast<size_t>(kNumProducers * kElementsPerProducer));
+  std::sort(dequeued.begin(), dequeued.end());
+  for (int i = 0; i < kNumProducers * kElementsPerProducer; i++) {
+    EXPECT_EQ(dequeued[i], i);
+  }
+}
+
+TEST(BlockingQueueTest, ConcurrentUnbounded) {
+  BlockingQueue<LockFreeQueue<int>> queue;
+  ProducersAndSleepingConsumers(queue);
+}
+
+TEST(BlockingQueueTest, ConcurrentBounded) {
+  BlockingQueue<MPMCQueue<int>> queue(8);
+  ProducersAndSleepingConsumers(queue);
+}
+
+// Test that move-only items pass through both a bounded and an unbounded
+// underlying queue
+TEST(BlockingQueueMoveTest, MoveOnlyItems) {
+  BlockingQueue<MPMCQueue<std::unique_ptr<int>>> bounded(2);
+  bounded.enqueue(std::make_unique<int>(1));
+  bounded.emplace(new int(2));
+  EXPECT_EQ(*bounded.dequeue(), 1);
+  EXPECT_EQ(*bounded.dequeue(), 2);
+
+  BlockingQueue<LockFreeQueue<std::unique_ptr<int>>> unbounded;
+  unbounded.enqueue(std::make_unique<int>(1));
+  unbounded.emplace(new int(2));
+  EXPECT_EQ(*unbounded.dequeue(), 1);
+  EXPECT_EQ(*unbounded.dequeue(), 2);
+}
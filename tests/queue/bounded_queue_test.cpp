@@ -1,11 +1,14 @@
 #include "queue/bounded_queue.h"
 
 #include <algorithm>
+#include <iterator>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "synchronization/mcs_lock.h"
 
 using namespace std::chrono_literals;
 
@@ -170,3 +173,138 @@ TEST(BoundedQueueTest, DequeueBlocksWhenEmpty) {
   EXPECT_TRUE(has_dequeued) << "Consumer did not dequeue after enqueue";
   EXPECT_EQ(dequeued_value, 42) << "Incorrect value dequeued";
 }
+
+// Test 6: Bulk operations keep FIFO order and report how many items they
+// removed
+TEST(BoundedQueueTest, BulkEnqueueDequeue) {
+  BoundedQueue<int> queue(8);
+  std::vector<int> items{1, 2, 3, 4, 5};
+  queue.enqueue(0);
+  queue.enqueue_bulk(items.begin(), items.end());
+
+  std::vector<int> out;
+  EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 4), 4U);
+  EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3}));
+  EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 10), 2U);
+  EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3, 4, 5}));
+  EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 0), 0U);
+}
+
+// Test 7: A batch larger than the capacity is enqueued in runs that fit, as
+// a consumer makes room
+TEST(BoundedQueueTest, BulkEnqueueLargerThanCapacity) {
+  constexpr int kNumElements = 1000;
+  BoundedQueue<int> queue(10);
+  std::vector<int> items(kNumElements);
+  for (int i = 0; i < kNumElements; i++) {
+    items[i] = i;
+  }
+
+  std::thread producer(
+      [&queue, &items]() { queue.enqueue_bulk(items.begin(), items.end()); });
+
+  std::vector<int> out;
+  while (out.size() < static_cast<size_t>(kNumElements)) {
+    size_t count = queue.dequeue_bulk(std::back_inserter(out), 3);
+    EXPECT_GE(count, 1U);
+    EXPECT_LE(count, 3U);
+  }
+  producer.join();
+  EXPECT_EQ(out, items);
+}
+
+// Test 8: try_dequeue does not wait on an empty queue, and wakes enqueuers
+// waiting on a full one
+TEST(BoundedQueueTest, TryDequeueDoesNotBlock) {
+  BoundedQueue<int> queue(1);
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+
+  queue.enqueue(1);
+  std::thread producer([&queue]() { queue.enqueue(2); });  // Blocks when full
+  EXPECT_EQ(queue.try_dequeue(), 1);
+  producer.join();
+  EXPECT_EQ(queue.try_dequeue(), 2);
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+// approx_size() follows the split counters, also after enqueuers have moved
+// the dequeuers' count over on reaching the capacity
+TEST(BoundedQueueTest, ApproxSize) {
+  BoundedQueue<int> queue(4);
+  EXPECT_EQ(queue.approx_size(), 0U);
+  for (int i = 0; i < 4; i++) {
+    queue.enqueue(i);
+  }
+  EXPECT_EQ(queue.approx_size(), 4U);
+
+  std::vector<int> out;
+  EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 3), 3U);
+  EXPECT_EQ(queue.approx_size(), 1U);
+  std::vector<int> items{4, 5, 6};
+  queue.enqueue_bulk(items.begin(), items.end());
+  EXPECT_EQ(queue.approx_size(), 4U);
+  EXPECT_EQ(queue.try_dequeue(), 3);
+  EXPECT_EQ(queue.approx_size(), 3U);
+}
+
+// Concurrent producers and consumers keep a small queue full and empty in
+// turn, so that both sides wait and wake each other many times
+TEST(BoundedQueueTest, ProducersAndConsumersWaitOnEachOther) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 20000;
+  BoundedQueue<int> queue(2);
+
+  std::vector<std::thread> threads;
+  std::vector<long> sums(kNumThreads);
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&queue]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        queue.enqueue(i);
+      }
+    });
+    threads.emplace_back([&queue, &sums, t]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        sums[t] += queue.dequeue();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  long total = 0;
+  for (long sum : sums) {
+    total += sum;
+  }
+  EXPECT_EQ(total, static_cast<long>(kNumThreads) * kItemsPerThread *
+                       (kItemsPerThread - 1) / 2);
+  EXPECT_EQ(queue.approx_size(), 0U);
+}
+
+// Waiting on a full or empty queue releases the lock through the guard, which
+// owns the queue node of an MCS lock
+TEST(BoundedQueueTest, WaitsWithMCSLock) {
+  constexpr size_t kCapacity = 2;
+  constexpr int kNumItems = 1000;
+  BoundedQueue<int, MCSLock<>> queue(kCapacity);
+
+  std::thread producer([&queue]() {
+    for (int i = 0; i < kNumItems; i++) {
+      queue.enqueue(i);
+    }
+  });
+
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_EQ(queue.dequeue(), i);
+  }
+  producer.join();
+}
+
+// Test that move-only items can be enqueued, emplaced and dequeued
+TEST(BoundedQueueMoveTest, MoveOnlyItems) {
+  BoundedQueue<std::unique_ptr<int>> queue(4);
+  queue.enqueue(std::make_unique<int>(1));
+  queue.emplace(new int(2));
+  EXPECT_EQ(*queue.dequeue(), 1);
+  EXPECT_EQ(*queue.dequeue(), 2);
+}
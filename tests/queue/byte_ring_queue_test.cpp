@@ -0,0 +1,167 @@
+#include "queue/byte_ring_queue.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+auto fill(std::span<std::byte> bytes, uint8_t seed) -> void {
+  for (size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = static_cast<std::byte>(seed + i);
+  }
+}
+
+auto matches(std::span<const std::byte> bytes, uint8_t seed) -> bool {
+  for (size_t i = 0; i < bytes.size(); i++) {
+    if (bytes[i] != static_cast<std::byte>(seed + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(ByteRingQueueTest, ReserveCommitPeekRelease) {
+  ByteRingQueue queue(256);
+  EXPECT_FALSE(queue.peek().has_value());
+
+  ByteRingQueue::Reservation reservation = queue.reserve(10);
+  ASSERT_EQ(reservation.bytes().size(), 10U);
+  fill(reservation.bytes(), 1);
+  // Not visible before it is committed
+  EXPECT_FALSE(queue.peek().has_value());
+  queue.commit(reservation);
+
+  std::optional<std::span<const std::byte>> record = queue.peek();
+  ASSERT_TRUE(record.has_value());
+  EXPECT_EQ(record->size(), 10U);
+  EXPECT_TRUE(matches(*record, 1));
+  queue.release();
+  EXPECT_FALSE(queue.peek().has_value());
+}
+
+TEST(ByteRingQueueTest, CommitFewerBytesThanReserved) {
+  ByteRingQueue queue(256);
+  ByteRingQueue::Reservation reservation = queue.reserve(100);
+  fill(reservation.bytes().first(7), 3);
+  queue.commit(reservation, 7);
+  std::vector<std::byte> next(5);
+  fill(next, 9);
+  EXPECT_TRUE(queue.try_enqueue(next));
+
+  std::optional<std::span<const std::byte>> record = queue.peek();
+  ASSERT_TRUE(record.has_value());
+  EXPECT_EQ(record->size(), 7U);
+  EXPECT_TRUE(matches(*record, 3));
+  queue.release();
+  record = queue.peek();
+  ASSERT_TRUE(record.has_value());
+  EXPECT_EQ(record->size(), 5U);
+  EXPECT_TRUE(matches(*record, 9));
+  queue.release();
+}
+
+// Records that do not fit before the end of the ring start over at its
+// beginning, and the ring refuses records while it is full
+TEST(ByteRingQueueTest, RecordsNeverWrap) {
+  ByteRingQueue queue(64);
+  EXPECT_EQ(queue.max_record_size(), 24U);
+  EXPECT_THROW(queue.try_reserve(25), std::invalid_argument);
+
+  std::vector<std::byte> bytes(20);
+  for (uint8_t round = 0; round < 50; round++) {
+    fill(bytes, round);
+    // 32 bytes per record: two fit, a third does not
+    EXPECT_TRUE(queue.try_enqueue(bytes));
+    EXPECT_TRUE(queue.try_enqueue(bytes));
+    EXPECT_FALSE(queue.try_enqueue(bytes));
+    for (int i = 0; i < 2; i++) {
+      std::optional<std::span<const std::byte>> record = queue.peek();
+      ASSERT_TRUE(record.has_value());
+      EXPECT_EQ(record->size(), bytes.size());
+      EXPECT_TRUE(matches(*record, round));
+      queue.release();
+    }
+    EXPECT_FALSE(queue.peek().has_value());
+  }
+}
+
+// A record of any size up to max_record_size() fits in the empty ring, even
+// when the tail is not at the start of the ring and it needs padding
+TEST(ByteRingQueueTest, LargestRecordFitsInEmptyRing) {
+  ByteRingQueue queue(64);
+  std::vector<std::byte> small(8);
+  for (size_t size = 0; size <= queue.max_record_size(); size++) {
+    for (int shift = 0; shift < 4; shift++) {
+      // Moves the tail on by 16 bytes
+      ASSERT_TRUE(queue.try_enqueue(small));
+      ASSERT_TRUE(queue.peek().has_value());
+      queue.release();
+
+      std::optional<ByteRingQueue::Reservation> reservation =
+          queue.try_reserve(size);
+      ASSERT_TRUE(reservation.has_value());
+      fill(reservation->bytes(), static_cast<uint8_t>(size));
+      queue.commit(*reservation);
+      std::optional<std::span<const std::byte>> record = queue.peek();
+      ASSERT_TRUE(record.has_value());
+      EXPECT_EQ(record->size(), size);
+      EXPECT_TRUE(matches(*record, static_cast<uint8_t>(size)));
+      queue.release();
+      EXPECT_FALSE(queue.peek().has_value());
+    }
+  }
+}
+
+// Records of many sizes from several producers reach the consumer whole, and
+// each producer's records in the order it committed them
+TEST(ByteRingQueueTest, ConcurrentProducersSingleConsumer) {
+  constexpr int kNumProducers = 4;
+  constexpr int kRecordsPerProducer = 5000;
+  ByteRingQueue queue(4096);
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kNumProducers; p++) {
+    producers.emplace_back([&queue, p]() {
+      std::mt19937 gen(p);
+      std::uniform_int_distribution<size_t> size_dist(8, 600);
+      for (uint32_t i = 0; i < kRecordsPerProducer; i++) {
+        ByteRingQueue::Reservation reservation = queue.reserve(size_dist(gen));
+        std::span<std::byte> bytes = reservation.bytes();
+        uint32_t tag[2] = {static_cast<uint32_t>(p), i};
+        std::memcpy(bytes.data(), tag, sizeof(tag));
+        fill(bytes.subspan(sizeof(tag)), static_cast<uint8_t>(i));
+        queue.commit(reservation);
+      }
+    });
+  }
+
+  std::vector<uint32_t> next(kNumProducers, 0);
+  for (int n = 0; n < kNumProducers * kRecordsPerProducer; n++) {
+    std::optional<std::span<const std::byte>> record;
+    while (!(record = queue.peek()).has_value()) {
+      std::this_thread::yield();
+    }
+    uint32_t tag[2];
+    std::memcpy(tag, record->data(), sizeof(tag));
+    ASSERT_LT(tag[0], static_cast<uint32_t>(kNumProducers));
+    EXPECT_EQ(tag[1], next[tag[0]]++);
+    EXPECT_TRUE(
+        matches(record->subspan(sizeof(tag)), static_cast<uint8_t>(tag[1])));
+    queue.release();
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_FALSE(queue.peek().has_value());
+}
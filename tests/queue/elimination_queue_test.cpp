@@ -0,0 +1,120 @@
+#include "queue/elimination_queue.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "memory/garbage_list.h"
+
+class EliminationQueueTest : public ::testing::Test {
+ protected:
+  EliminationQueue<int> queue_;
+};
+
+TEST_F(EliminationQueueTest, EnqueueDequeueSingleItem) {
+  queue_.enqueue(42);
+  EXPECT_EQ(queue_.dequeue(), 42);
+}
+
+TEST_F(EliminationQueueTest, DequeueEmptyThrows) {
+  EXPECT_THROW(queue_.dequeue(), EmptyException);
+}
+
+TEST_F(EliminationQueueTest, TryDequeueDoesNotThrow) {
+  EXPECT_FALSE(queue_.try_dequeue().has_value());
+  queue_.enqueue(1);
+  EXPECT_EQ(queue_.try_dequeue(), 1);
+  EXPECT_FALSE(queue_.try_dequeue().has_value());
+}
+
+TEST_F(EliminationQueueTest, FIFOOrder) {
+  constexpr int kNumItems = 1000;
+  for (int i = 0; i < kNumItems; i++) {
+    queue_.enqueue(i);
+  }
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_EQ(queue_.dequeue(), i);
+  }
+  EXPECT_FALSE(queue_.try_dequeue().has_value());
+}
+
+TEST(EliminationQueueDestructorTest, DestroysRemainingItems) {
+  EliminationQueue<std::string> queue;
+  queue.enqueue(std::string(100, 'a'));
+  queue.enqueue(std::string(100, 'b'));
+  EXPECT_EQ(queue.dequeue(), std::string(100, 'a'));
+}
+
+TEST(EliminationQueueReclaimerTest, GarbageListReclaimer) {
+  EliminationQueue<int, GarbageList> queue;
+  for (int i = 0; i < 100; i++) {
+    queue.enqueue(i);
+  }
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(queue.dequeue(), i);
+  }
+}
+
+// Producers and consumers race on the tail and the head, so many of the
+// operations go through the elimination array; per-producer order must hold
+// all the same
+TEST(EliminationQueueConcurrentTest, ConcurrentEnqueueDequeue) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumConsumers = 4;
+  constexpr int kItemsPerProducer = 20000;
+
+  for (size_t spin_budget : {size_t{0}, size_t{64}, size_t{4096}}) {
+    EliminationQueue<int> queue(2, spin_budget);
+    std::vector<std::atomic<int>> dequeued(kNumProducers * kItemsPerProducer);
+    std::atomic<int> remaining{kNumProducers * kItemsPerProducer};
+    std::atomic<bool> in_order{true};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kNumProducers; p++) {
+      threads.emplace_back([&queue, p]() {
+        for (int i = 0; i < kItemsPerProducer; i++) {
+          queue.enqueue(p * kItemsPerProducer + i);
+        }
+      });
+    }
+    for (int c = 0; c < kNumConsumers; c++) {
+      threads.emplace_back([&queue, &dequeued, &remaining, &in_order]() {
+        std::vector<int> last(kNumProducers, -1);
+        while (remaining.load() > 0) {
+          std::optional<int> item = queue.try_dequeue();
+          if (!item.has_value()) {
+            std::this_thread::yield();
+            continue;
+          }
+          int producer = *item / kItemsPerProducer;
+          if (*item <= last[producer]) {
+            in_order = false;
+          }
+          last[producer] = *item;
+          dequeued[*item]++;
+          remaining--;
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    EXPECT_TRUE(in_order);
+    for (const auto& count : dequeued) {
+      EXPECT_EQ(count.load(), 1);
+    }
+  }
+}
+
+// Test that move-only items can be enqueued, emplaced and dequeued
+TEST(EliminationQueueMoveTest, MoveOnlyItems) {
+  EliminationQueue<std::unique_ptr<int>> queue;
+  queue.enqueue(std::make_unique<int>(1));
+  queue.emplace(new int(2));
+  EXPECT_EQ(*queue.dequeue(), 1);
+  EXPECT_EQ(*queue.dequeue(), 2);
+}
@@ -0,0 +1,136 @@
+#include "queue/faa_array_queue.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "memory/garbage_list.h"
+
+class FAAArrayQueueTest : public ::testing::Test {
+ protected:
+  FAAArrayQueue<int> queue_;
+};
+
+TEST_F(FAAArrayQueueTest, EnqueueDequeueSingleItem) {
+  queue_.enqueue(42);
+  EXPECT_EQ(queue_.dequeue(), 42);
+}
+
+TEST_F(FAAArrayQueueTest, DequeueEmptyThrows) {
+  EXPECT_THROW(queue_.dequeue(), EmptyException);
+}
+
+TEST_F(FAAArrayQueueTest, TryDequeueDoesNotThrow) {
+  EXPECT_FALSE(queue_.try_dequeue().has_value());
+  queue_.enqueue(1);
+  EXPECT_EQ(queue_.try_dequeue(), 1);
+  EXPECT_FALSE(queue_.try_dequeue().has_value());
+}
+
+// Test FIFO order across several nodes
+TEST_F(FAAArrayQueueTest, FIFOOrderAcrossNodes) {
+  constexpr int kNumItems = 3 * FAAArrayQueue<int>::kNodeCapacity + 10;
+  for (int i = 0; i < kNumItems; i++) {
+    queue_.enqueue(i);
+  }
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_EQ(queue_.dequeue(), i);
+  }
+  EXPECT_FALSE(queue_.try_dequeue().has_value());
+}
+
+// Test that polling an empty queue does not use up slots for later items
+TEST_F(FAAArrayQueueTest, PollingEmptyQueueKeepsItems) {
+  constexpr int kNumItems = 2 * FAAArrayQueue<int>::kNodeCapacity;
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_FALSE(queue_.try_dequeue().has_value());
+    queue_.enqueue(i);
+    EXPECT_EQ(queue_.try_dequeue(), i);
+  }
+}
+
+// Test that items that were never dequeued are destroyed with the queue
+TEST(FAAArrayQueueDestructorTest, DestroysRemainingItems) {
+  auto item = std::make_shared<int>(0);
+  {
+    FAAArrayQueue<std::shared_ptr<int>> queue;
+    for (int i = 0; i < 2000; i++) {
+      queue.enqueue(item);
+    }
+    for (int i = 0; i < 1000; i++) {
+      queue.dequeue();
+    }
+    EXPECT_EQ(item.use_count(), 1001);
+  }
+  EXPECT_EQ(item.use_count(), 1);
+}
+
+TEST(FAAArrayQueueReclaimerTest, GarbageListReclaimer) {
+  FAAArrayQueue<std::string, GarbageList> queue;
+  for (int i = 0; i < 5000; i++) {
+    queue.enqueue(std::to_string(i));
+  }
+  for (int i = 0; i < 5000; i++) {
+    EXPECT_EQ(queue.dequeue(), std::to_string(i));
+  }
+}
+
+// Test that every item is dequeued exactly once, and that the items of each
+// producer come out in order
+TEST_F(FAAArrayQueueTest, ConcurrentEnqueueDequeue) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumConsumers = 4;
+  constexpr int kItemsPerProducer = 20000;
+
+  std::vector<std::atomic<int>> dequeued(kNumProducers * kItemsPerProducer);
+  std::atomic<int> remaining{kNumProducers * kItemsPerProducer};
+  std::atomic<bool> in_order{true};
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kNumProducers; p++) {
+    threads.emplace_back([this, p]() {
+      for (int i = 0; i < kItemsPerProducer; i++) {
+        queue_.enqueue(p * kItemsPerProducer + i);
+      }
+    });
+  }
+  for (int c = 0; c < kNumConsumers; c++) {
+    threads.emplace_back([this, &dequeued, &remaining, &in_order]() {
+      std::vector<int> last(kNumProducers, -1);
+      while (remaining.load() > 0) {
+        std::optional<int> item = queue_.try_dequeue();
+        if (!item.has_value()) {
+          std::this_thread::yield();
+          continue;
+        }
+        int producer = *item / kItemsPerProducer;
+        if (*item <= last[producer]) {
+          in_order = false;
+        }
+        last[producer] = *item;
+        dequeued[*item]++;
+        remaining--;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_TRUE(in_order);
+  for (const auto& count : dequeued) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
+
+// Test that move-only items can be enqueued, emplaced and dequeued
+TEST(FAAArrayQueueMoveTest, MoveOnlyItems) {
+  FAAArrayQueue<std::unique_ptr<int>> queue;
+  queue.enqueue(std::make_unique<int>(1));
+  queue.emplace(new int(2));
+  EXPECT_EQ(*queue.dequeue(), 1);
+  EXPECT_EQ(*queue.dequeue(), 2);
+}
@@ -0,0 +1,93 @@
+#include "queue/flat_combining_queue.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class FlatCombiningQueueTest : public ::testing::Test {
+ protected:
+  FlatCombiningQueue<int> queue_;
+};
+
+// Normal Cases
+
+// Test that items are dequeued in FIFO order.
+TEST_F(FlatCombiningQueueTest, FifoOrder) {
+  for (int i = 0; i < 10; i++) {
+    queue_.enqueue(i);
+  }
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(queue_.dequeue(), i);
+  }
+}
+
+// Test that the queue holds items that are not trivially copyable.
+TEST(FlatCombiningQueueStringTest, HoldsStrings) {
+  FlatCombiningQueue<std::string> queue;
+  queue.enqueue(std::string(100, 'a'));
+  EXPECT_EQ(queue.try_dequeue(), std::string(100, 'a'));
+}
+
+// Edge Cases
+
+// Test dequeuing from an empty queue.
+TEST_F(FlatCombiningQueueTest, EmptyQueue) {
+  EXPECT_FALSE(queue_.try_dequeue().has_value());
+  EXPECT_THROW(queue_.dequeue(), EmptyException);
+  queue_.enqueue(1);
+  EXPECT_EQ(queue_.try_dequeue(), 1);
+  EXPECT_FALSE(queue_.try_dequeue().has_value());
+}
+
+// Concurrent Operations
+
+// Test that concurrent producers and consumers transfer every item once, and
+// that each producer's items stay in order.
+TEST_F(FlatCombiningQueueTest, ConcurrentProducersAndConsumers) {
+  constexpr int kNumPairs = 4;
+  constexpr int kItemsPerProducer = 10000;
+
+  std::vector<std::atomic<int>> received(kNumPairs * kItemsPerProducer);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumPairs; t++) {
+    threads.emplace_back([this, t]() {
+      for (int i = 0; i < kItemsPerProducer; i++) {
+        queue_.enqueue(t * kItemsPerProducer + i);
+      }
+    });
+    threads.emplace_back([this, &received]() {
+      std::vector<int> last(kNumPairs, -1);
+      int count = 0;
+      while (count < kItemsPerProducer) {
+        if (std::optional<int> item = queue_.try_dequeue()) {
+          int producer = *item / kItemsPerProducer;
+          EXPECT_GT(*item, last[producer]);
+          last[producer] = *item;
+          received[*item]++;
+          count++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& count : received) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
+
+// Test that move-only items can be enqueued, emplaced and dequeued
+TEST(FlatCombiningQueueMoveTest, MoveOnlyItems) {
+  FlatCombiningQueue<std::unique_ptr<int>> queue;
+  queue.enqueue(std::make_unique<int>(1));
+  queue.emplace(new int(2));
+  EXPECT_EQ(*queue.dequeue(), 1);
+  EXPECT_EQ(*queue.dequeue(), 2);
+}
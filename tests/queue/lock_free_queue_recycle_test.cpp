@@ -1,8 +1,13 @@
 
 #include "queue/lock_free_queue_recycle.h"
 
+#include <atomic>
+#include <memory>
+#include <optional>
 #include <random>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -25,6 +30,15 @@ TEST_F(LockFreeQueueRecycleTest, DequeueEmptyThrows) {
   EXPECT_THROW(queue_->dequeue(), EmptyException);
 }
 
+TEST_F(LockFreeQueueRecycleTest, TryDequeueDoesNotThrow) {
+  EXPECT_FALSE(queue_->try_dequeue().has_value());
+  queue_->enqueue(1);
+  queue_->enqueue(2);
+  EXPECT_EQ(queue_->try_dequeue(), 1);
+  EXPECT_EQ(queue_->try_dequeue(), 2);
+  EXPECT_FALSE(queue_->try_dequeue().has_value());
+}
+
 TEST_F(LockFreeQueueRecycleTest, MultipleItems) {
   queue_->enqueue(1);
   queue_->enqueue(2);
@@ -205,3 +219,43 @@ TEST_F(LockFreeQueueRecycleTest, RapidSingleThreadOperations) {
 
   EXPECT_THROW(queue_->dequeue(), EmptyException);
 }
+
+// Test that move-only items can be enqueued, emplaced and dequeued
+TEST(LockFreeQueueRecycleMoveTest, MoveOnlyItems) {
+  LockFreeQueueRecycle<std::unique_ptr<int>> queue;
+  queue.enqueue(std::make_unique<int>(1));
+  queue.emplace(new int(2));
+  EXPECT_EQ(*queue.dequeue(), 1);
+  EXPECT_EQ(*queue.dequeue(), 2);
+}
+
+// Test that items moved out of recycled nodes arrive intact while other
+// threads keep recycling nodes
+TEST(LockFreeQueueRecycleMoveTest, ConcurrentHeapPayloads) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 5000;
+
+  LockFreeQueueRecycle<std::string> queue;
+  std::vector<std::thread> threads;
+  std::atomic<int> dequeued{0};
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&queue, &dequeued, t]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        queue.emplace(64, static_cast<char>('a' + t));
+        std::optional<std::string> item = queue.try_dequeue();
+        if (item.has_value()) {
+          ASSERT_EQ(item->size(), 64u);
+          EXPECT_EQ(item->find_first_not_of(item->front()), std::string::npos);
+          dequeued++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  while (queue.try_dequeue().has_value()) {
+    dequeued++;
+  }
+  EXPECT_EQ(dequeued.load(), kNumThreads * kItemsPerThread);
+}
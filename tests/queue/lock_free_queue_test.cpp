@@ -1,5 +1,9 @@
 #include "queue/lock_free_queue.h"
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
 #include <random>
 #include <thread>
 #include <vector>
@@ -23,6 +27,15 @@ TEST_F(LockFreeQueueTest, DequeueEmptyThrows) {
   EXPECT_THROW(queue_->dequeue(), EmptyException);
 }
 
+TEST_F(LockFreeQueueTest, TryDequeueDoesNotThrow) {
+  EXPECT_FALSE(queue_->try_dequeue().has_value());
+  queue_->enqueue(1);
+  queue_->enqueue(2);
+  EXPECT_EQ(queue_->try_dequeue(), 1);
+  EXPECT_EQ(queue_->try_dequeue(), 2);
+  EXPECT_FALSE(queue_->try_dequeue().has_value());
+}
+
 TEST_F(LockFreeQueueTest, MultipleItems) {
   queue_->enqueue(1);
   queue_->enqueue(2);
@@ -191,3 +204,269 @@ TEST_F(LockFreeQueueTest, RapidSingleThreadOperations) {
 
   EXPECT_THROW(queue_->dequeue(), EmptyException);
 }
+
+// Bulk operations keep FIFO order and report how many items they removed
+TEST_F(LockFreeQueueTest, BulkEnqueueDequeue) {
+  std::vector<int> items{1, 2, 3, 4, 5};
+  queue_->enqueue(0);
+  queue_->enqueue_bulk(items.begin(), items.end());
+  queue_->enqueue_bulk(items.end(), items.end());
+
+  std::vector<int> out;
+  EXPECT_EQ(queue_->dequeue_bulk(std::back_inserter(out), 4), 4U);
+  EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3}));
+  EXPECT_EQ(queue_->dequeue_bulk(std::back_inserter(out), 10), 2U);
+  EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3, 4, 5}));
+  EXPECT_EQ(queue_->dequeue_bulk(std::back_inserter(out), 10), 0U);
+
+  queue_->enqueue(6);
+  EXPECT_EQ(queue_->dequeue(), 6);
+}
+
+// The items of a batch are spliced at once, so they stay adjacent
+TEST_F(LockFreeQueueTest, ConcurrentBulkBatchesStayContiguous) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumBatches = 500;
+  constexpr int kBatchSize = 16;
+  constexpr int kTotal = kNumProducers * kNumBatches * kBatchSize;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kNumProducers; p++) {
+    producers.emplace_back([this, p]() {
+      std::vector<int> batch(kBatchSize);
+      for (int b = 0; b < kNumBatches; b++) {
+        int base = (p * kNumBatches + b) * kBatchSize;
+        for (int i = 0; i < kBatchSize; i++) {
+          batch[i] = base + i;
+        }
+        queue_->enqueue_bulk(batch.begin(), batch.end());
+      }
+    });
+  }
+
+  // The consumer removes items in chunks that do not line up with batches
+  std::vector<int> dequeued;
+  std::thread consumer([this, &dequeued]() {
+    while (dequeued.size() < static_cast<size_t>(kTotal)) {
+      queue_->dequeue_bulk(std::back_inserter(dequeued), 7);
+    }
+  });
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  consumer.join();
+
+  ASSERT_EQ(dequeued.size(), static_cast<size_t>(kTotal));
+  for (int i = 0; i < kTotal; i++) {
+    if (dequeued[i] % kBatchSize != 0) {
+      ASSERT_GT(i, 0);
+      EXPECT_EQ(dequeued[i - 1], dequeued[i] - 1);
+    }
+  }
+  std::sort(dequeued.begin(), dequeued.end());
+  for (int i = 0; i < kTotal; i++) {
+    EXPECT_EQ(dequeued[i], i);
+  }
+}
+
+// approx_size() adds up the per-thread counts of all enqueuers and dequeuers
+TEST_F(LockFreeQueueTest, ApproxSizeAfterConcurrentOperations) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 10000;
+  EXPECT_EQ(queue_->approx_size(), 0U);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this]() {
+      std::vector<int> batch{1, 2, 3};
+      for (int i = 0; i < kItemsPerThread; i++) {
+        queue_->enqueue(i);
+        queue_->enqueue_bulk(batch.begin(), batch.end());
+        queue_->try_dequeue();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(queue_->approx_size(),
+            static_cast<size_t>(3 * kNumThreads * kItemsPerThread));
+  std::vector<int> out;
+  EXPECT_EQ(queue_->dequeue_bulk(std::back_inserter(out), 5), 5U);
+  EXPECT_EQ(queue_->approx_size(),
+            static_cast<size_t>(3 * kNumThreads * kItemsPerThread - 5));
+}
+
+// Batches and single items from one thread come out in a single order
+TEST_F(LockFreeQueueTest, BulkAndSingleOperationsInterleave) {
+  std::vector<int> batch(64);
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < 64; i++) {
+      batch[i] = round * 65 + i;
+    }
+    queue_->enqueue_bulk(batch.begin(), batch.end());
+    queue_->enqueue(round * 65 + 64);
+  }
+  std::vector<int> out;
+  while (queue_->dequeue_bulk(std::back_inserter(out), 33) > 0) {}
+  ASSERT_EQ(out.size(), 6500U);
+  for (int i = 0; i < 6500; i++) {
+    EXPECT_EQ(out[i], i);
+  }
+}
+
+// Test that move-only items can be enqueued, emplaced and dequeued
+TEST(LockFreeQueueMoveTest, MoveOnlyItems) {
+  LockFreeQueue<std::unique_ptr<int>> queue;
+  queue.enqueue(std::make_unique<int>(1));
+  queue.emplace(new int(2));
+  EXPECT_EQ(*queue.dequeue(), 1);
+  EXPECT_EQ(*queue.dequeue(), 2);
+}
+
+// Test that a queue that backs off after failed CASes loses no items
+TEST(LockFreeQueueBackoffTest, ConcurrentProducersAndConsumers) {
+  constexpr int kNumThreads = 8;
+  constexpr int kItemsPerThread = 10000;
+  LockFreeQueue<int, PauseBackoff<>> queue;
+  std::atomic<int64_t> dequeued_sum{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        queue.enqueue(i);
+        if (std::optional<int> value = queue.try_dequeue()) {
+          dequeued_sum += *value;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  while (std::optional<int> value = queue.try_dequeue()) {
+    dequeued_sum += *value;
+  }
+  EXPECT_EQ(dequeued_sum.load(), int64_t{kNumThreads} * kItemsPerThread *
+                                     (kItemsPerThread - 1) / 2);
+}
+
+struct QueueMessage : IntrusiveHook {
+  int value_{};
+};
+
+// Test that caller-allocated nodes come back in FIFO order and can be enqueued
+// again right away
+TEST(IntrusiveLockFreeQueueTest, LinksCallerNodesInOrder) {
+  std::vector<QueueMessage> arena(8);
+  IntrusiveLockFreeQueue<QueueMessage> queue;
+  EXPECT_EQ(queue.try_dequeue(), nullptr);
+  for (int i = 0; i < 8; i++) {
+    arena[i].value_ = i;
+    queue.enqueue(&arena[i]);
+  }
+  for (int i = 0; i < 8; i++) {
+    EXPECT_EQ(queue.try_dequeue(), &arena[i]);
+  }
+  EXPECT_EQ(queue.try_dequeue(), nullptr);
+
+  // A lone node is dequeued through the stub, twice in a row
+  for (int round = 0; round < 2; round++) {
+    queue.enqueue(&arena[3]);
+    EXPECT_EQ(queue.try_dequeue(), &arena[3]);
+    EXPECT_EQ(queue.try_dequeue(), nullptr);
+  }
+}
+
+// Test that nodes circulating between threads, each dequeued node being
+// enqueued again at once, are neither lost nor duplicated
+TEST(IntrusiveLockFreeQueueTest, ConcurrentRecirculation) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumNodes = 16;
+  constexpr int kOpsPerThread = 20000;
+
+  std::vector<QueueMessage> arena(kNumNodes);
+  IntrusiveLockFreeQueue<QueueMessage> queue;
+  for (int i = 0; i < kNumNodes; i++) {
+    arena[i].value_ = i;
+    queue.enqueue(&arena[i]);
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&queue]() {
+      for (int i = 0; i < kOpsPerThread; i++) {
+        if (QueueMessage* node = queue.try_dequeue()) {
+          queue.enqueue(node);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<int> seen(kNumNodes, 0);
+  while (QueueMessage* node = queue.try_dequeue()) {
+    seen[node->value_]++;
+  }
+  for (int i = 0; i < kNumNodes; i++) {
+    EXPECT_EQ(seen[i], 1) << "node " << i;
+  }
+}
+
+// Test that every producer's nodes reach the consumers in the order they were
+// enqueued
+TEST(IntrusiveLockFreeQueueTest, ConcurrentProducersKeepTheirOrder) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumConsumers = 4;
+  constexpr int kItemsPerProducer = 10000;
+
+  std::vector<QueueMessage> arena(kNumProducers * kItemsPerProducer);
+  IntrusiveLockFreeQueue<QueueMessage> queue;
+  std::atomic<int> consumed{0};
+  std::vector<std::vector<int>> received(kNumConsumers);
+
+  std::vector<std::thread> threads;
+  for (int c = 0; c < kNumConsumers; c++) {
+    threads.emplace_back([&, c]() {
+      while (consumed.load() < kNumProducers * kItemsPerProducer) {
+        if (QueueMessage* node = queue.try_dequeue()) {
+          received[c].push_back(node->value_);
+          consumed++;
+        }
+      }
+    });
+  }
+  for (int p = 0; p < kNumProducers; p++) {
+    threads.emplace_back([&, p]() {
+      for (int i = 0; i < kItemsPerProducer; i++) {
+        QueueMessage& node = arena[p * kItemsPerProducer + i];
+        node.value_ = p * kItemsPerProducer + i;
+        queue.enqueue(&node);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<int> all;
+  for (const auto& values : received) {
+    // Each consumer sees every producer's items in increasing order
+    std::vector<int> last(kNumProducers, -1);
+    for (int value : values) {
+      int producer = value / kItemsPerProducer;
+      EXPECT_GT(value, last[producer]);
+      last[producer] = value;
+    }
+    all.insert(all.end(), values.begin(), values.end());
+  }
+  std::sort(all.begin(), all.end());
+  ASSERT_EQ(all.size(), arena.size());
+  for (size_t i = 0; i < all.size(); i++) {
+    EXPECT_EQ(all[i], static_cast<int>(i));
+  }
+}
@@ -0,0 +1,152 @@
+#include "queue/mapped_queue.h"
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class MappedQueueTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = (std::filesystem::temp_directory_path() /
+             ("mapped_queue_test_" + std::to_string(::getpid())))
+                .string();
+    std::filesystem::remove(path_);
+  }
+
+  void TearDown() override { std::filesystem::remove(path_); }
+
+  std::string path_;
+};
+
+TEST_F(MappedQueueTest, FIFOAcrossLaps) {
+  MappedQueue<int> queue(path_, 4);
+  EXPECT_EQ(queue.capacity(), 4U);
+  for (int lap = 0; lap < 3; lap++) {
+    for (int i = 0; i < 4; i++) {
+      EXPECT_TRUE(queue.try_enqueue(lap * 4 + i));
+    }
+    EXPECT_FALSE(queue.try_enqueue(-1));
+    EXPECT_EQ(queue.approx_size(), 4U);
+    for (int i = 0; i < 4; i++) {
+      EXPECT_EQ(queue.try_dequeue(), lap * 4 + i);
+    }
+    EXPECT_FALSE(queue.try_dequeue().has_value());
+  }
+}
+
+// Items that were not dequeued are still there when the file is mapped again
+TEST_F(MappedQueueTest, ReopenKeepsBufferedItems) {
+  {
+    MappedQueue<int> queue(path_, 8);
+    for (int i = 0; i < 5; i++) {
+      queue.enqueue(i);
+    }
+    EXPECT_EQ(queue.dequeue(), 0);
+  }
+  MappedQueue<int> queue(path_, 8);
+  EXPECT_EQ(queue.approx_size(), 4U);
+  for (int i = 1; i < 5; i++) {
+    EXPECT_EQ(queue.dequeue(), i);
+  }
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+TEST_F(MappedQueueTest, RejectsQueueOfAnotherLayout) {
+  { MappedQueue<int> queue(path_, 8); }
+  EXPECT_THROW((MappedQueue<int>(path_, 16)), std::runtime_error);
+  EXPECT_THROW((MappedQueue<int64_t>(path_, 8)), std::runtime_error);
+}
+
+// A file of the right size that is not a MappedQueue, or whose creator never
+// finished laying it out, is rejected rather than waited on forever
+TEST_F(MappedQueueTest, RejectsFileOfUnknownState) {
+  { MappedQueue<int> queue(path_, 8); }
+  auto set_state = [this](uint32_t state) {
+    int fd = ::open(path_.c_str(), O_RDWR);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(::pwrite(fd, &state, sizeof(state), 0),
+              static_cast<ssize_t>(sizeof(state)));
+    ::close(fd);
+  };
+
+  set_state(0xdeadbeef);
+  EXPECT_THROW((MappedQueue<int>(path_, 8)), std::runtime_error);
+  set_state(1);  // kInitializing
+  EXPECT_THROW((MappedQueue<int>(path_, 8)), std::runtime_error);
+  set_state(2);  // kReady
+  MappedQueue<int> queue(path_, 8);
+  EXPECT_TRUE(queue.try_enqueue(1));
+}
+
+TEST_F(MappedQueueTest, RecordsKeepTheirLength) {
+  MappedQueue<MappedRecord<16>> queue(path_, 4);
+  std::string text = "hello";
+  MappedRecord<16> record;
+  EXPECT_TRUE(record.assign(std::as_bytes(std::span(text))));
+  EXPECT_TRUE(queue.try_enqueue(record));
+
+  std::vector<std::byte> too_long(17);
+  EXPECT_FALSE(record.assign(too_long));
+
+  MappedRecord<16> out = queue.dequeue();
+  ASSERT_EQ(out.bytes().size(), text.size());
+  EXPECT_EQ(std::memcmp(out.bytes().data(), text.data(), text.size()), 0);
+}
+
+// Two mappings in one process see each other's items and wake each other
+TEST_F(MappedQueueTest, MappingsShareTheQueue) {
+  constexpr int kNumItems = 10000;
+  MappedQueue<int> producer_view(path_, 4);
+  MappedQueue<int> consumer_view(path_, 4);
+
+  std::thread producer([&producer_view]() {
+    for (int i = 0; i < kNumItems; i++) {
+      producer_view.enqueue(i);
+    }
+  });
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_EQ(consumer_view.dequeue(), i);
+  }
+  producer.join();
+}
+
+// A child process hands items to its parent through the file, waiting on a
+// full queue and waking the parent on an empty one
+TEST_F(MappedQueueTest, HandsItemsToAnotherProcess) {
+  constexpr int kNumItems = 10000;
+  auto queue = std::make_unique<MappedQueue<int>>(path_, 4);
+
+  pid_t pid = ::fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    MappedQueue<int> child_queue(path_, 4);
+    for (int i = 0; i < kNumItems; i++) {
+      child_queue.enqueue(i);
+    }
+    ::_exit(0);
+  }
+
+  long sum = 0;
+  for (int i = 0; i < kNumItems; i++) {
+    int item = queue->dequeue();
+    EXPECT_EQ(item, i);
+    sum += item;
+  }
+  int status = 0;
+  ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(sum, static_cast<long>(kNumItems) * (kNumItems - 1) / 2);
+}
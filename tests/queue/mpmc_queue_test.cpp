@@ -0,0 +1,187 @@
+#include "queue/mpmc_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(MPMCQueueTest, SingleEnqueueDequeue) {
+  MPMCQueue<int> queue(4);
+  queue.enqueue(42);
+  EXPECT_EQ(queue.dequeue(), 42);
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+TEST(MPMCQueueTest, CapacityIsRoundedUpToPowerOfTwo) {
+  EXPECT_EQ(MPMCQueue<int>(1).capacity(), 2U);
+  EXPECT_EQ(MPMCQueue<int>(8).capacity(), 8U);
+  EXPECT_EQ(MPMCQueue<int>(100).capacity(), 128U);
+}
+
+TEST(MPMCQueueTest, TryEnqueueFailsWhenFull) {
+  MPMCQueue<int> queue(8);
+  for (int i = 0; i < 8; i++) {
+    EXPECT_TRUE(queue.try_enqueue(i));
+  }
+  EXPECT_FALSE(queue.try_enqueue(8));
+
+  EXPECT_EQ(queue.try_dequeue(), 0);
+  EXPECT_TRUE(queue.try_enqueue(8));
+  for (int i = 1; i <= 8; i++) {
+    EXPECT_EQ(queue.try_dequeue(), i);
+  }
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+TEST(MPMCQueueTest, FIFOOrderAcrossManyLaps) {
+  constexpr int kNumElements = 10000;
+  MPMCQueue<int> queue(16);
+  int next_expected = 0;
+  for (int i = 0; i < kNumElements; i++) {
+    ASSERT_TRUE(queue.try_enqueue(i));
+    if (i >= 10) {
+      // Keep the queue partially full while positions wrap around the ring
+      EXPECT_EQ(queue.try_dequeue(), next_expected++);
+    }
+  }
+  while (auto value = queue.try_dequeue()) {
+    EXPECT_EQ(*value, next_expected++);
+  }
+  EXPECT_EQ(next_expected, kNumElements);
+}
+
+TEST(MPMCQueueTest, DestructorDestroysRemainingItems) {
+  auto item = std::make_shared<int>(7);
+  {
+    MPMCQueue<std::shared_ptr<int>> queue(4);
+    queue.enqueue(item);
+    queue.enqueue(item);
+    queue.enqueue(item);
+    EXPECT_EQ(*queue.dequeue(), 7);
+    EXPECT_EQ(item.use_count(), 3);
+  }
+  EXPECT_EQ(item.use_count(), 1);
+}
+
+TEST(MPMCQueueTest, SingleProducerSingleConsumerFIFO) {
+  constexpr int kNumElements = 100000;
+  MPMCQueue<int> queue(64);
+
+  std::thread producer([&queue]() {
+    for (int i = 0; i < kNumElements; i++) {
+      queue.enqueue(i);
+    }
+  });
+
+  for (int i = 0; i < kNumElements; i++) {
+    ASSERT_EQ(queue.dequeue(), i) << "FIFO order violated at index " << i;
+  }
+  producer.join();
+}
+
+TEST(MPMCQueueTest, MultipleProducersMultipleConsumers) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumConsumers = 4;
+  constexpr int kElementsPerProducer = 20000;
+  constexpr int kTotal = kNumProducers * kElementsPerProducer;
+  MPMCQueue<int> queue(32);
+
+  std::vector<std::thread> threads;
+  std::vector<int> dequeued;
+  std::mutex deq_mutex;
+
+  for (int p = 0; p < kNumProducers; p++) {
+    threads.emplace_back([&queue, p]() {
+      for (int i = 0; i < kElementsPerProducer; i++) {
+        queue.enqueue(p * kElementsPerProducer + i);
+      }
+    });
+  }
+  for (int c = 0; c < kNumConsumers; c++) {
+    threads.emplace_back([&]() {
+      std::vector<int> local;
+      // Each consumer also checks that the items of every producer come out
+      // in the order that producer enqueued them
+      std::vector<int> last_seen(kNumProducers, -1);
+      for (int i = 0; i < kTotal / kNumConsumers; i++) {
+        int value = queue.dequeue();
+        int producer = value / kElementsPerProducer;
+        EXPECT_GT(value, last_seen[producer]);
+        last_seen[producer] = value;
+        local.push_back(value);
+      }
+      std::lock_guard<std::mutex> lock(deq_mutex);
+      dequeued.insert(dequeued.end(), local.begin(), local.end());
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+  ASSERT_EQ(dequeued.size(), static_cast<size_t>(kTotal));
+  std::sort(dequeued.begin(), dequeued.end());
+  for (int i = 0; i < kTotal; i++) {
+    EXPECT_EQ(dequeued[i], i);
+  }
+}
+
+// approx_size() is the distance between the enqueue and dequeue positions,
+// across laps of the ring
+TEST(MPMCQueueTest, ApproxSize) {
+  MPMCQueue<int> queue(4);
+  EXPECT_EQ(queue.approx_size(), 0U);
+  for (int lap = 0; lap < 3; lap++) {
+    for (int i = 0; i < 4; i++) {
+      EXPECT_TRUE(queue.try_enqueue(i));
+    }
+    EXPECT_FALSE(queue.try_enqueue(4));
+    EXPECT_EQ(queue.approx_size(), 4U);
+    queue.dequeue();
+    EXPECT_EQ(queue.approx_size(), 3U);
+    while (queue.try_dequeue().has_value()) {
+    }
+    EXPECT_EQ(queue.approx_size(), 0U);
+  }
+}
+
+// Test that move-only items can be enqueued and emplaced, and that a failed
+// try_enqueue() leaves the item with the caller
+TEST(MPMCQueueTest, MoveOnlyItems) {
+  MPMCQueue<std::unique_ptr<int>> queue(2);
+  EXPECT_TRUE(queue.try_enqueue(std::make_unique<int>(1)));
+  queue.emplace(new int(2));
+  auto item = std::make_unique<int>(3);
+  EXPECT_FALSE(queue.try_enqueue(std::move(item)));
+  ASSERT_NE(item, nullptr);
+  EXPECT_EQ(*item, 3);
+  EXPECT_EQ(*queue.dequeue(), 1);
+  EXPECT_EQ(*queue.dequeue(), 2);
+}
+
+// Test that an item whose constructor throws does not block its slot for
+// the enqueuers and dequeuers of later positions
+TEST(MPMCQueueTest, ThrowingConstructorSkipsSlot) {
+  struct Item {
+    explicit Item(int value) : value_(value) {
+      if (value < 0) {
+        throw std::runtime_error("negative");
+      }
+    }
+
+    int value_;
+  };
+
+  MPMCQueue<Item> queue(2);
+  for (int lap = 0; lap < 4; lap++) {
+    queue.emplace(lap);
+    EXPECT_THROW(queue.emplace(-1), std::runtime_error);
+    EXPECT_EQ(queue.dequeue().value_, lap);
+    EXPECT_FALSE(queue.try_dequeue().has_value());
+  }
+}
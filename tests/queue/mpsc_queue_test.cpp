@@ -0,0 +1,105 @@
+#include "queue/mpsc_queue.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+struct Task : MPSCHook {
+  int id_;
+
+  explicit Task(int id) : id_(id) {}
+};
+
+TEST(IntrusiveMPSCQueueTest, EnqueueDequeueCallerNodes) {
+  IntrusiveMPSCQueue<Task> queue;
+  EXPECT_EQ(queue.try_dequeue(), nullptr);
+
+  Task first(1);
+  Task second(2);
+  queue.enqueue(&first);
+  queue.enqueue(&second);
+  EXPECT_EQ(queue.try_dequeue(), &first);
+  EXPECT_EQ(queue.try_dequeue(), &second);
+  EXPECT_EQ(queue.try_dequeue(), nullptr);
+
+  // Dequeued nodes can be enqueued again
+  queue.enqueue(&first);
+  EXPECT_EQ(queue.try_dequeue(), &first);
+  EXPECT_EQ(queue.try_dequeue(), nullptr);
+}
+
+TEST(MPSCQueueTest, EmptyQueueThrows) {
+  MPSCQueue<int> queue;
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+  EXPECT_THROW(queue.dequeue(), EmptyException);
+}
+
+TEST(MPSCQueueTest, FIFOOrder) {
+  MPSCQueue<int> queue;
+  for (int i = 0; i < 100; i++) {
+    queue.enqueue(i);
+    if (i % 2 == 1) {
+      EXPECT_EQ(queue.dequeue(), i / 2);
+    }
+  }
+  for (int i = 50; i < 100; i++) {
+    EXPECT_EQ(queue.dequeue(), i);
+  }
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+TEST(MPSCQueueTest, DestructorFreesRemainingItems) {
+  auto item = std::make_shared<int>(7);
+  {
+    MPSCQueue<std::shared_ptr<int>> queue;
+    queue.enqueue(item);
+    queue.enqueue(item);
+    EXPECT_EQ(item.use_count(), 3);
+  }
+  EXPECT_EQ(item.use_count(), 1);
+}
+
+TEST(MPSCQueueTest, MultipleProducersSingleConsumer) {
+  constexpr int kNumProducers = 4;
+  constexpr int kElementsPerProducer = 20000;
+  MPSCQueue<int> queue;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kNumProducers; p++) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < kElementsPerProducer; i++) {
+        queue.enqueue(p * kElementsPerProducer + i);
+      }
+    });
+  }
+
+  // Items of each producer come out in the order that producer enqueued them
+  std::vector<int> next_expected(kNumProducers, 0);
+  int consumed = 0;
+  while (consumed < kNumProducers * kElementsPerProducer) {
+    auto value = queue.try_dequeue();
+    if (!value.has_value()) {
+      std::this_thread::yield();
+      continue;
+    }
+    int producer = *value / kElementsPerProducer;
+    ASSERT_EQ(*value % kElementsPerProducer, next_expected[producer]);
+    next_expected[producer]++;
+    consumed++;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+// Test that move-only items can be enqueued, emplaced and dequeued
+TEST(MPSCQueueTest, MoveOnlyItems) {
+  MPSCQueue<std::unique_ptr<int>> queue;
+  queue.enqueue(std::make_unique<int>(1));
+  queue.emplace(new int(2));
+  EXPECT_EQ(*queue.dequeue(), 1);
+  EXPECT_EQ(*queue.dequeue(), 2);
+}
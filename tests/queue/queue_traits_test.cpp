@@ -0,0 +1,47 @@
+#include "queue/queue_traits.h"
+
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(QueueTraitsTest, PicksCheapestQueue) {
+  using SPSC = QueueTraits<Concurrency::kSingle, Concurrency::kSingle>;
+  using MPSC = QueueTraits<Concurrency::kMulti, Concurrency::kSingle>;
+  using SPMC = QueueTraits<Concurrency::kSingle, Concurrency::kMulti>;
+  using MPMC = QueueTraits<Concurrency::kMulti, Concurrency::kMulti>;
+
+  static_assert(std::is_same_v<SPSC::Bounded<int>, SPSCQueue<int>>);
+  static_assert(std::is_same_v<SPSC::Unbounded<int>, MPSCQueue<int>>);
+  static_assert(std::is_same_v<MPSC::Bounded<int>, MPMCQueue<int>>);
+  static_assert(std::is_same_v<MPSC::Unbounded<int>, MPSCQueue<int>>);
+  static_assert(std::is_same_v<SPMC::Bounded<int>, MPMCQueue<int>>);
+  static_assert(std::is_same_v<SPMC::Unbounded<int>, LockFreeQueue<int>>);
+  static_assert(std::is_same_v<MPMC::Bounded<int>, MPMCQueue<int>>);
+  static_assert(std::is_same_v<MPMC::Unbounded<int>, LockFreeQueue<int>>);
+}
+
+TEST(QueueTraitsTest, MultiProducerBoundedQueue) {
+  constexpr int kNumProducers = 4;
+  constexpr int kElementsPerProducer = 1000;
+  using Traits = QueueTraits<Concurrency::kMulti, Concurrency::kSingle>;
+  Traits::Bounded<int> queue(16);
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kNumProducers; p++) {
+    producers.emplace_back([&queue]() {
+      for (int i = 0; i < kElementsPerProducer; i++) {
+        queue.enqueue(1);
+      }
+    });
+  }
+  int sum = 0;
+  for (int i = 0; i < kNumProducers * kElementsPerProducer; i++) {
+    sum += queue.dequeue();
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_EQ(sum, kNumProducers * kElementsPerProducer);
+}
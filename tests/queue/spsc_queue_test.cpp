@@ -0,0 +1,75 @@
+#include "queue/spsc_queue.h"
+
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+TEST(SPSCQueueTest, SingleEnqueueDequeue) {
+  SPSCQueue<int> queue(4);
+  queue.enqueue(42);
+  EXPECT_EQ(queue.dequeue(), 42);
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+TEST(SPSCQueueTest, CapacityIsRoundedUpToPowerOfTwo) {
+  EXPECT_EQ(SPSCQueue<int>(1).capacity(), 1U);
+  EXPECT_EQ(SPSCQueue<int>(5).capacity(), 8U);
+}
+
+TEST(SPSCQueueTest, TryEnqueueFailsWhenFull) {
+  SPSCQueue<int> queue(4);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(queue.try_enqueue(i));
+  }
+  EXPECT_FALSE(queue.try_enqueue(4));
+
+  EXPECT_EQ(queue.try_dequeue(), 0);
+  EXPECT_TRUE(queue.try_enqueue(4));
+  for (int i = 1; i <= 4; i++) {
+    EXPECT_EQ(queue.try_dequeue(), i);
+  }
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+TEST(SPSCQueueTest, DestructorDestroysRemainingItems) {
+  auto item = std::make_shared<int>(7);
+  {
+    SPSCQueue<std::shared_ptr<int>> queue(4);
+    queue.enqueue(item);
+    queue.enqueue(item);
+    EXPECT_EQ(item.use_count(), 3);
+  }
+  EXPECT_EQ(item.use_count(), 1);
+}
+
+TEST(SPSCQueueTest, ProducerConsumerFIFO) {
+  constexpr int kNumElements = 200000;
+  SPSCQueue<int> queue(64);
+
+  std::thread producer([&queue]() {
+    for (int i = 0; i < kNumElements; i++) {
+      queue.enqueue(i);
+    }
+  });
+
+  for (int i = 0; i < kNumElements; i++) {
+    ASSERT_EQ(queue.dequeue(), i) << "FIFO order violated at index " << i;
+  }
+  producer.join();
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+// Test that move-only items can be enqueued and emplaced, and that a failed
+// try_enqueue() leaves the item with the caller
+TEST(SPSCQueueTest, MoveOnlyItems) {
+  SPSCQueue<std::unique_ptr<int>> queue(2);
+  EXPECT_TRUE(queue.try_enqueue(std::make_unique<int>(1)));
+  queue.emplace(new int(2));
+  auto item = std::make_unique<int>(3);
+  EXPECT_FALSE(queue.try_enqueue(std::move(item)));
+  ASSERT_NE(item, nullptr);
+  EXPECT_EQ(*item, 3);
+  EXPECT_EQ(*queue.dequeue(), 1);
+  EXPECT_EQ(*queue.dequeue(), 2);
+}
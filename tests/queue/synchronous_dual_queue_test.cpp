@@ -0,0 +1,190 @@
+#include "queue/synchronous_dual_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+
+class SynchronousDualQueueTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    queue_ = std::make_unique<SynchronousDualQueue<int>>();
+  }
+
+  std::unique_ptr<SynchronousDualQueue<int>> queue_;
+};
+
+// Normal Cases
+
+// Test that a producer waits until a consumer takes its item.
+TEST_F(SynchronousDualQueueTest, ProducerWaitsForConsumer) {
+  std::atomic<bool> delivered{false};
+  std::thread producer([this, &delivered] {
+    queue_->enqueue(42);
+    delivered = true;
+  });
+
+  std::this_thread::sleep_for(10ms);
+  EXPECT_FALSE(delivered);
+  EXPECT_EQ(queue_->dequeue(), 42);
+
+  producer.join();
+  EXPECT_TRUE(delivered);
+}
+
+// Test that a consumer waits until a producer provides an item.
+TEST_F(SynchronousDualQueueTest, ConsumerWaitsForProducer) {
+  std::atomic<bool> received{false};
+  std::thread consumer([this, &received] {
+    EXPECT_EQ(queue_->dequeue(), 42);
+    received = true;
+  });
+
+  std::this_thread::sleep_for(10ms);
+  EXPECT_FALSE(received);
+  queue_->enqueue(42);
+
+  consumer.join();
+  EXPECT_TRUE(received);
+}
+
+// Test that try_dequeue only takes an item an enqueuer is already offering.
+TEST_F(SynchronousDualQueueTest, TryDequeueTakesOfferedItem) {
+  EXPECT_FALSE(queue_->try_dequeue().has_value());
+
+  std::thread producer([this] { queue_->enqueue(42); });
+  std::optional<int> value;
+  while (!(value = queue_->try_dequeue()).has_value()) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(value, 42);
+  producer.join();
+  EXPECT_FALSE(queue_->try_dequeue().has_value());
+}
+
+// Test that offer and poll give up when no partner arrives in time.
+TEST_F(SynchronousDualQueueTest, OfferAndPollTimeOut) {
+  EXPECT_FALSE(queue_->offer(1, 1ms));
+  EXPECT_FALSE(queue_->poll(1ms).has_value());
+
+  // The cancelled nodes must not be matched by later operations
+  std::thread producer([this] { queue_->enqueue(2); });
+  EXPECT_EQ(queue_->dequeue(), 2);
+  producer.join();
+}
+
+// Test that a timed offer is taken by a consumer that arrives in time.
+TEST_F(SynchronousDualQueueTest, OfferTakenBeforeTimeout) {
+  std::thread consumer([this] { EXPECT_EQ(queue_->dequeue(), 42); });
+  EXPECT_TRUE(queue_->offer(42, 10s));
+  consumer.join();
+}
+
+// Test that a timed poll receives an item offered in time.
+TEST_F(SynchronousDualQueueTest, PollReceivesBeforeTimeout) {
+  std::thread producer([this] { queue_->enqueue(42); });
+  EXPECT_EQ(queue_->poll(10s), 42);
+  producer.join();
+}
+
+// Edge Cases
+
+// Test that waiting producers are served in arrival order.
+TEST_F(SynchronousDualQueueTest, WaitingProducersAreServedInOrder) {
+  constexpr int kNumProducers = 4;
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kNumProducers; i++) {
+    producers.emplace_back([this, i] { queue_->enqueue(i); });
+    // Let the producer append its node before starting the next one
+    std::this_thread::sleep_for(10ms);
+  }
+
+  for (int i = 0; i < kNumProducers; i++) {
+    EXPECT_EQ(queue_->dequeue(), i);
+  }
+  for (auto& thread : producers) {
+    thread.join();
+  }
+}
+
+// Test that a cancelled reservation between two waiting consumers is skipped.
+TEST_F(SynchronousDualQueueTest, CancelledReservationIsSkipped) {
+  std::thread first([this] { EXPECT_EQ(queue_->dequeue(), 1); });
+  std::this_thread::sleep_for(10ms);
+  EXPECT_FALSE(queue_->poll(10ms).has_value());
+  std::thread last([this] { EXPECT_EQ(queue_->dequeue(), 2); });
+  std::this_thread::sleep_for(10ms);
+
+  queue_->enqueue(1);
+  queue_->enqueue(2);
+  first.join();
+  last.join();
+}
+
+// Concurrent Operations
+
+// Test that every item is transferred exactly once under contention.
+TEST_F(SynchronousDualQueueTest, ConcurrentTransfers) {
+  constexpr int kNumPairs = 4;
+  constexpr int kItemsPerProducer = 2000;
+
+  std::vector<std::thread> threads;
+  std::vector<std::atomic<int>> received(kNumPairs * kItemsPerProducer);
+  for (int t = 0; t < kNumPairs; t++) {
+    threads.emplace_back([this, t] {
+      for (int i = 0; i < kItemsPerProducer; i++) {
+        queue_->enqueue(t * kItemsPerProducer + i);
+      }
+    });
+    threads.emplace_back([this, &received] {
+      for (int i = 0; i < kItemsPerProducer; i++) {
+        received[queue_->dequeue()]++;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& count : received) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
+
+// Test that timed operations racing with untimed ones lose no items.
+TEST_F(SynchronousDualQueueTest, ConcurrentTimedTransfers) {
+  constexpr int kNumItems = 2000;
+
+  std::atomic<int> accepted{0};
+  std::atomic<int> taken{0};
+  std::thread producer([this, &accepted] {
+    for (int i = 0; i < kNumItems; i++) {
+      if (queue_->offer(i, 100us)) {
+        accepted++;
+      }
+    }
+    // Tell the consumer to stop
+    queue_->enqueue(-1);
+  });
+  std::thread consumer([this, &taken] {
+    while (true) {
+      std::optional<int> value = queue_->poll(100us);
+      if (!value.has_value()) {
+        continue;
+      }
+      if (*value == -1) {
+        break;
+      }
+      taken++;
+    }
+  });
+  producer.join();
+  consumer.join();
+
+  EXPECT_EQ(accepted.load(), taken.load());
+}
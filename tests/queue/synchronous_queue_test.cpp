@@ -1,6 +1,7 @@
 #include "queue/synchronous_queue.h"
 
 #include <atomic>
+#include <optional>
 #include <thread>
 #include <vector>
 
@@ -37,6 +38,20 @@ TEST_F(SynchronousQueueTest, SingleProducerConsumerRendezvous) {
   consumer.join();
 }
 
+// Test that try_dequeue only takes an item an enqueuer is already offering.
+TEST_F(SynchronousQueueTest, TryDequeueTakesOfferedItem) {
+  EXPECT_FALSE(queue_->try_dequeue().has_value());
+
+  std::thread producer([this] { queue_->enqueue(42); });
+  std::optional<int> value;
+  while (!(value = queue_->try_dequeue()).has_value()) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(value, 42);
+  producer.join();
+  EXPECT_FALSE(queue_->try_dequeue().has_value());
+}
+
 // Test that a consumer blocks until a producer provides an item.
 TEST_F(SynchronousQueueTest, SingleConsumerProducerRendezvous) {
   std::atomic<bool> consumerBlocked{false};
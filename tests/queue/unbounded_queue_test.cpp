@@ -1,6 +1,8 @@
 #include "queue/unbounded_queue.h"
 
 #include <algorithm>
+#include <iterator>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -135,3 +137,103 @@ TEST_F(UnboundedQueueTest, DequeueEmptyQueueThrows) {
   UnboundedQueue<int> queue;
   EXPECT_THROW({ queue.dequeue(); }, EmptyException);
 }
+
+// Test 5: try_dequeue reports an empty queue without throwing
+TEST_F(UnboundedQueueTest, TryDequeueDoesNotThrow) {
+  UnboundedQueue<int> queue;
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+  queue.enqueue(1);
+  queue.enqueue(2);
+  EXPECT_EQ(queue.try_dequeue(), 1);
+  EXPECT_EQ(queue.try_dequeue(), 2);
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+// Test 6: Bulk operations keep FIFO order and report how many items they
+// removed
+TEST_F(UnboundedQueueTest, BulkEnqueueDequeue) {
+  UnboundedQueue<int> queue;
+  std::vector<int> items{1, 2, 3, 4, 5};
+  queue.enqueue(0);
+  queue.enqueue_bulk(items.begin(), items.end());
+
+  std::vector<int> out;
+  EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 4), 4U);
+  EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3}));
+  EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 10), 2U);
+  EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3, 4, 5}));
+  EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 10), 0U);
+  EXPECT_THROW({ queue.dequeue(); }, EmptyException);
+}
+
+// Test 7: Concurrent batches, each enqueued under a single lock acquisition,
+// stay contiguous
+TEST_F(UnboundedQueueTest, ConcurrentBulkBatchesStayContiguous) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumBatches = 500;
+  constexpr int kBatchSize = 16;
+  constexpr int kTotal = kNumProducers * kNumBatches * kBatchSize;
+  UnboundedQueue<int> queue;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kNumProducers; p++) {
+    producers.emplace_back([&queue, p]() {
+      std::vector<int> batch(kBatchSize);
+      for (int b = 0; b < kNumBatches; b++) {
+        int base = (p * kNumBatches + b) * kBatchSize;
+        for (int i = 0; i < kBatchSize; i++) {
+          batch[i] = base + i;
+        }
+        queue.enqueue_bulk(batch.begin(), batch.end());
+      }
+    });
+  }
+
+  std::vector<int> dequeued;
+  std::thread consumer([&queue, &dequeued]() {
+    while (dequeued.size() < static_cast<size_t>(kTotal)) {
+      queue.dequeue_bulk(std::back_inserter(dequeued), 7);
+    }
+  });
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  consumer.join();
+
+  ASSERT_EQ(dequeued.size(), static_cast<size_t>(kTotal));
+  for (int i = 0; i < kTotal; i++) {
+    if (dequeued[i] % kBatchSize != 0) {
+      ASSERT_GT(i, 0);
+      EXPECT_EQ(dequeued[i - 1], dequeued[i] - 1);
+    }
+  }
+  std::sort(dequeued.begin(), dequeued.end());
+  for (int i = 0; i < kTotal; i++) {
+    EXPECT_EQ(dequeued[i], i);
+  }
+}
+
+// approx_size() counts single and bulk operations
+TEST_F(UnboundedQueueTest, ApproxSize) {
+  UnboundedQueue<int> queue;
+  EXPECT_EQ(queue.approx_size(), 0U);
+  std::vector<int> items{1, 2, 3, 4};
+  queue.enqueue(0);
+  queue.enqueue_bulk(items.begin(), items.end());
+  EXPECT_EQ(queue.approx_size(), 5U);
+
+  std::vector<int> out;
+  EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 3), 3U);
+  EXPECT_EQ(queue.approx_size(), 2U);
+  queue.dequeue();
+  EXPECT_EQ(queue.approx_size(), 1U);
+}
+
+// Test that move-only items can be enqueued, emplaced and dequeued
+TEST(UnboundedQueueMoveTest, MoveOnlyItems) {
+  UnboundedQueue<std::unique_ptr<int>> queue;
+  queue.enqueue(std::make_unique<int>(1));
+  queue.emplace(new int(2));
+  EXPECT_EQ(*queue.dequeue(), 1);
+  EXPECT_EQ(*queue.dequeue(), 2);
+}
@@ -0,0 +1,100 @@
+#include "scheduler/executor.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+template<typename Scheduling>
+class ExecutorTest : public ::testing::Test {};
+
+using SchedulingPolicies =
+    ::testing::Types<CentralQueue, WorkStealing, ShardedQueues>;
+TYPED_TEST_SUITE(ExecutorTest, SchedulingPolicies);
+
+// Test that every task submitted from outside the executor runs once
+TYPED_TEST(ExecutorTest, RunsSubmittedTasks) {
+  constexpr int kNumTasks = 1000;
+  std::vector<std::atomic<int>> runs(kNumTasks);
+
+  Executor<TypeParam> executor(4);
+  EXPECT_EQ(executor.num_workers(), 4U);
+  for (int i = 0; i < kNumTasks; i++) {
+    executor.submit([&runs, i]() { runs[i]++; });
+  }
+  executor.wait_idle();
+
+  for (const auto& count : runs) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
+
+// Test that tasks submitted by tasks are waited for, as in a fork-join tree
+TYPED_TEST(ExecutorTest, RunsForkedTasks) {
+  constexpr int kDepth = 12;
+  std::atomic<int> leaves{0};
+  Executor<TypeParam> executor(4);
+
+  std::function<void(int)> fork = [&](int depth) {
+    if (depth == 0) {
+      leaves++;
+      return;
+    }
+    executor.submit([&fork, depth]() { fork(depth - 1); });
+    executor.submit([&fork, depth]() { fork(depth - 1); });
+  };
+  executor.submit([&fork]() { fork(kDepth); });
+  executor.wait_idle();
+
+  EXPECT_EQ(leaves.load(), 1 << kDepth);
+}
+
+// Test that a batch, submitted from outside or from a task, runs in full
+TYPED_TEST(ExecutorTest, SubmitBulk) {
+  constexpr int kBatchSize = 500;
+  std::atomic<int> runs{0};
+  Executor<TypeParam> executor(4);
+
+  std::vector<std::function<void()>> batch(kBatchSize,
+                                           [&runs]() { runs++; });
+  executor.submit_bulk(batch.begin(), batch.end());
+  executor.submit([&]() { executor.submit_bulk(batch.begin(), batch.end()); });
+  executor.submit_bulk(batch.end(), batch.end());
+  executor.wait_idle();
+
+  EXPECT_EQ(runs.load(), 2 * kBatchSize);
+}
+
+// Test that workers that have parked wake up for new tasks, and that an idle
+// executor shuts down
+TYPED_TEST(ExecutorTest, ParkedWorkersWakeUp) {
+  std::atomic<int> runs{0};
+  Executor<TypeParam> executor(4, true);
+  for (int round = 0; round < 5; round++) {
+    // Long enough for every worker to stop spinning and park
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    for (int i = 0; i < 8; i++) {
+      executor.submit([&runs]() { runs++; });
+    }
+    executor.wait_idle();
+  }
+  EXPECT_EQ(runs.load(), 40);
+}
+
+// Test that the destructor runs the tasks that are still queued
+TYPED_TEST(ExecutorTest, DestructorRunsPendingTasks) {
+  std::atomic<int> runs{0};
+  {
+    Executor<TypeParam> executor(2);
+    for (int i = 0; i < 100; i++) {
+      executor.submit([&runs]() {
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+        runs++;
+      });
+    }
+  }
+  EXPECT_EQ(runs.load(), 100);
+}
@@ -0,0 +1,82 @@
+#include "scheduler/work_stealing_pool.h"
+
+#include <atomic>
+#include <functional>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "synchronization/scoped_lock.h"
+#include "synchronization/ttas_lock.h"
+
+// Test that every task submitted from outside the pool runs once
+TEST(WorkStealingPoolTest, RunsSubmittedTasks) {
+  constexpr int kNumTasks = 1000;
+  std::vector<std::atomic<int>> runs(kNumTasks);
+
+  WorkStealingPool pool(4);
+  EXPECT_EQ(pool.num_workers(), 4);
+  for (int i = 0; i < kNumTasks; i++) {
+    pool.submit([&runs, i]() { runs[i]++; });
+  }
+  pool.wait_idle();
+
+  for (const auto& count : runs) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
+
+// Test that tasks submitted by tasks are waited for, as in a fork-join tree
+TEST(WorkStealingPoolTest, RunsForkedTasks) {
+  constexpr int kDepth = 12;
+  std::atomic<int> leaves{0};
+  WorkStealingPool pool(4);
+
+  std::function<void(int)> fork = [&](int depth) {
+    if (depth == 0) {
+      leaves++;
+      return;
+    }
+    pool.submit([&fork, depth]() { fork(depth - 1); });
+    pool.submit([&fork, depth]() { fork(depth - 1); });
+  };
+  pool.submit([&fork]() { fork(kDepth); });
+  pool.wait_idle();
+
+  EXPECT_EQ(leaves.load(), 1 << kDepth);
+}
+
+// Test that idle workers steal the tasks forked by a busy one
+TEST(WorkStealingPoolTest, IdleWorkersStealForkedTasks) {
+  constexpr int kNumTasks = 64;
+  TTASLock<> mutex;
+  std::set<std::thread::id> workers;
+  WorkStealingPool pool(4);
+
+  pool.submit([&]() {
+    for (int i = 0; i < kNumTasks; i++) {
+      pool.submit([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ScopedLock<TTASLock<>> lock(mutex);
+        workers.insert(std::this_thread::get_id());
+      });
+    }
+  });
+  pool.wait_idle();
+
+  EXPECT_GT(workers.size(), 1);
+}
+
+// Test that the destructor runs the remaining tasks
+TEST(WorkStealingPoolTest, DestructorRunsPendingTasks) {
+  constexpr int kNumTasks = 100;
+  std::atomic<int> runs{0};
+  {
+    WorkStealingPool pool(2);
+    for (int i = 0; i < kNumTasks; i++) {
+      pool.submit([&runs]() { runs++; });
+    }
+  }
+  EXPECT_EQ(runs.load(), kNumTasks);
+}
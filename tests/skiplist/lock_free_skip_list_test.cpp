@@ -0,0 +1,367 @@
+#include "skiplist/lock_free_skip_list.h"
+
+#include <atomic>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// An item that counts how many instances are alive, to observe when the skip
+// list frees the nodes holding them
+struct CountedItem {
+  static inline std::atomic<int> num_alive{0};
+
+  CountedItem(int value) : value_(value) { num_alive++; }
+  CountedItem(const CountedItem& other) : value_(other.value_) { num_alive++; }
+  ~CountedItem() { num_alive--; }
+
+  auto operator==(const CountedItem& other) const -> bool {
+    return value_ == other.value_;
+  }
+
+  int value_;
+};
+
+struct CountedItemHash {
+  auto operator()(const CountedItem& item) const -> size_t {
+    return std::hash<int>{}(item.value_);
+  }
+};
+
+class LockFreeSkipListTest : public ::testing::Test {
+ protected:
+  LockFreeSkipList<int> list_;
+};
+
+TEST_F(LockFreeSkipListTest, EmptyListContainsReturnsFalse) {
+  EXPECT_FALSE(list_.contains(1));
+}
+
+TEST_F(LockFreeSkipListTest, AddRemoveContains) {
+  EXPECT_TRUE(list_.add(1));
+  EXPECT_TRUE(list_.contains(1));
+  EXPECT_FALSE(list_.add(1));
+  EXPECT_TRUE(list_.remove(1));
+  EXPECT_FALSE(list_.contains(1));
+  EXPECT_FALSE(list_.remove(1));
+}
+
+TEST_F(LockFreeSkipListTest, BoundaryCheck) {
+  // Items whose keys collide with the keys of the sentinels must be treated
+  // like any other item
+  LockFreeSkipList<size_t> s_list;
+
+  size_t min_val = std::numeric_limits<size_t>::min();
+  size_t max_val = std::numeric_limits<size_t>::max();
+
+  EXPECT_FALSE(s_list.contains(min_val));
+  EXPECT_FALSE(s_list.contains(max_val));
+  EXPECT_FALSE(s_list.remove(min_val));
+  EXPECT_FALSE(s_list.remove(max_val));
+
+  EXPECT_TRUE(s_list.add(min_val));
+  EXPECT_TRUE(s_list.add(max_val));
+  EXPECT_TRUE(s_list.contains(min_val));
+  EXPECT_TRUE(s_list.contains(max_val));
+  EXPECT_TRUE(s_list.remove(min_val));
+  EXPECT_TRUE(s_list.remove(max_val));
+  EXPECT_FALSE(s_list.contains(min_val));
+  EXPECT_FALSE(s_list.contains(max_val));
+}
+
+TEST_F(LockFreeSkipListTest, ManyItems) {
+  // Enough items for the upper levels to be used
+  constexpr int kNumItems = 10000;
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_TRUE(list_.add(i));
+  }
+  for (int i = 0; i < kNumItems; i += 2) {
+    EXPECT_TRUE(list_.remove(i));
+  }
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_EQ(list_.contains(i), i % 2 == 1);
+  }
+}
+
+// Test with custom type and hash function
+struct TestItem {
+  int id;
+  std::string name;
+
+  bool operator==(const TestItem& other) const {
+    return id == other.id && name == other.name;
+  }
+};
+
+struct TestItemHasher {
+  size_t operator()(const TestItem& item) const {
+    return std::hash<int>()(item.id);
+  }
+};
+
+TEST(LockFreeSkipListCustomTypeTest, BasicOperations) {
+  LockFreeSkipList<TestItem, TestItemHasher> list;
+
+  TestItem item1{1, "Item1"};
+  TestItem item2{2, "Item2"};
+
+  EXPECT_TRUE(list.add(item1));
+  EXPECT_TRUE(list.add(item2));
+  EXPECT_TRUE(list.contains(item1));
+  EXPECT_TRUE(list.contains(item2));
+
+  EXPECT_TRUE(list.remove(item1));
+  EXPECT_FALSE(list.contains(item1));
+  EXPECT_TRUE(list.contains(item2));
+}
+
+// Concurrency tests
+TEST_F(LockFreeSkipListTest, ConcurrentAddDifferentItems) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 1000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        EXPECT_TRUE(list_.add(t * kItemsPerThread + i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumThreads * kItemsPerThread; i++) {
+    EXPECT_TRUE(list_.contains(i));
+  }
+}
+
+TEST_F(LockFreeSkipListTest, ConcurrentAddRemove) {
+  constexpr int kNumItems = 100;
+  constexpr int kNumThreads = 4;
+  constexpr int kOperationsPerThread = 10000;
+
+  std::atomic<int> successful_adds{0};
+  std::atomic<int> successful_removes{0};
+
+  for (int i = 0; i < kNumItems / 2; i++) {
+    EXPECT_TRUE(list_.add(i));
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, &successful_adds, &successful_removes]() {
+      std::mt19937 gen(std::random_device{}());
+      std::uniform_int_distribution<> val_dist(0, kNumItems - 1);
+      std::uniform_int_distribution<> op_dist(0, 2);
+
+      for (int i = 0; i < kOperationsPerThread; i++) {
+        int value = val_dist(gen);
+        switch (op_dist(gen)) {
+          case 0:
+            if (list_.add(value)) {
+              successful_adds++;
+            }
+            break;
+          case 1:
+            if (list_.remove(value)) {
+              successful_removes++;
+            }
+            break;
+          case 2:
+            list_.contains(value);
+            break;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  int items_in_list = 0;
+  for (int i = 0; i < kNumItems; i++) {
+    if (list_.contains(i)) {
+      items_in_list++;
+    }
+  }
+  EXPECT_EQ(items_in_list,
+            kNumItems / 2 + successful_adds - successful_removes);
+}
+
+TEST_F(LockFreeSkipListTest, OwnedKeysStressTest) {
+  // Each thread repeatedly adds and removes its own keys while the other
+  // threads modify the neighboring ones, so every operation has a known result
+  constexpr int kNumThreads = 8;
+  constexpr int kKeysPerThread = 64;
+  constexpr int kRounds = 100;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t]() {
+      for (int round = 0; round < kRounds; round++) {
+        for (int i = 0; i < kKeysPerThread; i++) {
+          int key = i * kNumThreads + t;
+          EXPECT_TRUE(list_.add(key));
+          EXPECT_TRUE(list_.contains(key));
+        }
+        for (int i = 0; i < kKeysPerThread; i++) {
+          int key = i * kNumThreads + t;
+          EXPECT_TRUE(list_.remove(key));
+          EXPECT_FALSE(list_.contains(key));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST_F(LockFreeSkipListTest, HighContentionTest) {
+  constexpr int kNumThreads = 8;
+  constexpr int kOperationsPerThread = 5000;
+  constexpr int kValueRange = 10;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this]() {
+      std::mt19937 gen(std::random_device{}());
+      std::uniform_int_distribution<> op_dist(0, 2);
+      std::uniform_int_distribution<> val_dist(0, kValueRange - 1);
+
+      for (int i = 0; i < kOperationsPerThread; i++) {
+        int value = val_dist(gen);
+        switch (op_dist(gen)) {
+          case 0:
+            list_.add(value);
+            break;
+          case 1:
+            list_.remove(value);
+            break;
+          case 2:
+            list_.contains(value);
+            break;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // The list is still well formed: every key can be removed and re-added
+  for (int i = 0; i < kValueRange; i++) {
+    list_.remove(i);
+    EXPECT_TRUE(list_.add(i));
+    EXPECT_TRUE(list_.contains(i));
+  }
+}
+
+TEST_F(LockFreeSkipListTest, RemovedNodesAreReclaimed) {
+  constexpr int kNumItems = 10000;
+  {
+    LockFreeSkipList<CountedItem, CountedItemHash> counted_list;
+    for (int i = 0; i < kNumItems; i++) {
+      EXPECT_TRUE(counted_list.add(CountedItem(i)));
+      EXPECT_TRUE(counted_list.remove(CountedItem(i)));
+    }
+
+    // Memory is proportional to the live elements (none), plus a bounded
+    // number of removed nodes that have not been reclaimed yet
+    EXPECT_LT(CountedItem::num_alive.load(), kNumItems / 10);
+  }
+  EXPECT_EQ(CountedItem::num_alive.load(), 0);
+}
+
+TEST_F(LockFreeSkipListTest, ConcurrentRemovedNodesAreReclaimed) {
+  constexpr int kNumThreads = 4;
+  constexpr int kOperationsPerThread = 10000;
+  constexpr int kValueRange = 32;
+  {
+    LockFreeSkipList<CountedItem, CountedItemHash> counted_list;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&counted_list]() {
+        std::mt19937 gen(std::random_device{}());
+        std::uniform_int_distribution<> val_dist(0, kValueRange - 1);
+        for (int i = 0; i < kOperationsPerThread; i++) {
+          CountedItem item(val_dist(gen));
+          if (i % 2 == 0) {
+            counted_list.add(item);
+          } else {
+            counted_list.remove(item);
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+  // Every node, whether still in the list or removed by a racing remove, is
+  // freed exactly once
+  EXPECT_EQ(CountedItem::num_alive.load(), 0);
+}
+
+TEST_F(LockFreeSkipListTest, RemoveFirstFollowsKeyOrder) {
+  EXPECT_FALSE(list_.remove_first().has_value());
+  for (int i : {5, 3, 9, 1, 7}) {
+    list_.add(i);
+  }
+  for (int i : {1, 3, 5, 7, 9}) {
+    EXPECT_EQ(list_.remove_first(), i);
+    EXPECT_FALSE(list_.contains(i));
+  }
+  EXPECT_FALSE(list_.remove_first().has_value());
+}
+
+TEST_F(LockFreeSkipListTest, SprayRemoveDrainsTheList) {
+  EXPECT_FALSE(list_.spray_remove(3, 3).has_value());
+  constexpr int kNumItems = 1000;
+  for (int i = 0; i < kNumItems; i++) {
+    list_.add(i);
+  }
+  std::vector<bool> removed(kNumItems, false);
+  for (int i = 0; i < kNumItems; i++) {
+    std::optional<int> item = list_.spray_remove(3, 3);
+    ASSERT_TRUE(item.has_value());
+    EXPECT_FALSE(removed[*item]);
+    removed[*item] = true;
+  }
+  EXPECT_FALSE(list_.spray_remove(3, 3).has_value());
+}
+
+TEST_F(LockFreeSkipListTest, ConcurrentRemoveFirstTakesEachItemOnce) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumItems = 20000;
+  for (int i = 0; i < kNumItems; i++) {
+    list_.add(i);
+  }
+
+  std::vector<std::atomic<int>> taken(kNumItems);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t, &taken]() {
+      while (true) {
+        std::optional<int> item =
+            t % 2 == 0 ? list_.remove_first() : list_.spray_remove(2, 2);
+        if (!item.has_value()) {
+          break;
+        }
+        taken[*item]++;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& count : taken) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
@@ -44,6 +44,18 @@ TEST_F(EliminationBackoffStackTest, PopEmptyStack) {
   EXPECT_THROW(stack_->pop(), EmptyException);
 }
 
+TEST_F(EliminationBackoffStackTest, TryPopDoesNotThrow) {
+  int value = -1;
+  EXPECT_FALSE(stack_->try_pop(value));
+  stack_->push(1);
+  stack_->push(2);
+  EXPECT_TRUE(stack_->try_pop(value));
+  EXPECT_EQ(value, 2);
+  EXPECT_TRUE(stack_->try_pop(value));
+  EXPECT_EQ(value, 1);
+  EXPECT_FALSE(stack_->try_pop(value));
+}
+
 TEST_F(EliminationBackoffStackTest, PushPopLargeValue) {
   struct LargeValue {
     int data[1000];
@@ -371,3 +383,35 @@ TEST(EliminationBackoffStackPerformanceTest, CapacityComparison) {
               << " operations" << std::endl;
   }
 }
+
+TEST(EliminationBackoffStackSpinBudgetTest, WorksWithAnySpinBudget) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 2000;
+
+  for (size_t spin_budget : {size_t{0}, size_t{1}, size_t{100000}}) {
+    EliminationBackoffStack<int> stack(4, spin_budget);
+    std::vector<std::atomic<int>> popped(kNumThreads * kItemsPerThread);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+      threads.emplace_back([&stack, &popped, t]() {
+        for (int i = 0; i < kItemsPerThread; i++) {
+          stack.push(t * kItemsPerThread + i);
+          int value = 0;
+          if (stack.try_pop(value)) {
+            popped[value]++;
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    int value = 0;
+    while (stack.try_pop(value)) {
+      popped[value]++;
+    }
+    for (const auto& count : popped) {
+      EXPECT_EQ(count.load(), 1);
+    }
+  }
+}
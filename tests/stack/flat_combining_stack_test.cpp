@@ -0,0 +1,69 @@
+#include "stack/flat_combining_stack.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class FlatCombiningStackTest : public ::testing::Test {
+ protected:
+  FlatCombiningStack<int> stack_;
+};
+
+// Normal Cases
+
+// Test that items are popped in LIFO order.
+TEST_F(FlatCombiningStackTest, LifoOrder) {
+  for (int i = 0; i < 10; i++) {
+    stack_.push(i);
+  }
+  for (int i = 9; i >= 0; i--) {
+    EXPECT_EQ(stack_.pop(), i);
+  }
+}
+
+// Edge Cases
+
+// Test popping from an empty stack.
+TEST_F(FlatCombiningStackTest, EmptyStack) {
+  int value = 0;
+  EXPECT_FALSE(stack_.try_pop(value));
+  EXPECT_THROW(stack_.pop(), EmptyException);
+  stack_.push(1);
+  EXPECT_TRUE(stack_.try_pop(value));
+  EXPECT_EQ(value, 1);
+}
+
+// Concurrent Operations
+
+// Test that concurrent pushes and pops lose and duplicate no items.
+TEST_F(FlatCombiningStackTest, ConcurrentPushAndPop) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 10000;
+
+  std::vector<std::atomic<int>> popped(kNumThreads * kItemsPerThread);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t, &popped]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        stack_.push(t * kItemsPerThread + i);
+        int value = 0;
+        if (stack_.try_pop(value)) {
+          popped[value]++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  int value = 0;
+  while (stack_.try_pop(value)) {
+    popped[value]++;
+  }
+
+  for (const auto& count : popped) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
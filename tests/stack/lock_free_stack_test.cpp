@@ -46,6 +46,20 @@ TEST_F(LockFreeStackTest, EmptyStackException) {
   EXPECT_THROW(stack_->pop(), EmptyException);
 }
 
+// Test that try_pop reports an empty stack without throwing
+TEST_F(LockFreeStackTest, TryPopDoesNotThrow) {
+  int value = -1;
+  EXPECT_FALSE(stack_->try_pop(value));
+  stack_->push(1);
+  stack_->push(2);
+  EXPECT_TRUE(stack_->try_pop(value));
+  EXPECT_EQ(value, 2);
+  EXPECT_TRUE(stack_->try_pop(value));
+  EXPECT_EQ(value, 1);
+  EXPECT_FALSE(stack_->try_pop(value));
+  EXPECT_EQ(value, 1);
+}
+
 // Test custom backoff parameters
 TEST_F(LockFreeStackTest, CustomBackoffParameters) {
   auto custom_stack = new LockFreeStack<int>{10, 50};  // 10ms min, 50ms max
@@ -255,6 +269,24 @@ TEST_F(LockFreeStackTest, MemoryLeakTest) {
   EXPECT_THROW(stack_->pop(), EmptyException);  // Verify stack is empty
 }
 
+// Test that approx_size() counts pushes and successful pops only
+TEST_F(LockFreeStackTest, ApproxSize) {
+  EXPECT_EQ(stack_->approx_size(), 0U);
+  for (int i = 0; i < 10; i++) {
+    stack_->push(i);
+  }
+  EXPECT_EQ(stack_->approx_size(), 10U);
+
+  int value;
+  EXPECT_TRUE(stack_->try_pop(value));
+  stack_->pop();
+  EXPECT_EQ(stack_->approx_size(), 8U);
+  while (stack_->try_pop(value)) {
+  }
+  EXPECT_THROW(stack_->pop(), EmptyException);
+  EXPECT_EQ(stack_->approx_size(), 0U);
+}
+
 // Test custom duration type with high contention
 TEST_F(LockFreeStackTest, HighContentionWithCustomDuration) {
   auto contention_stack =
@@ -433,3 +465,174 @@ TEST_F(LockFreeStackTest, RapidPushPopAlternation) {
 
   // No specific assertion here, just making sure we don't deadlock or crash
 }
+
+TEST(LockFreeStackAllocatorTest, PooledNodes) {
+  constexpr int kNumItems = 1000;
+  LockFreeStack<int, std::chrono::microseconds, PoolAllocator> stack;
+  for (int i = 0; i < kNumItems; ++i) {
+    stack.push(i);
+  }
+  for (int i = kNumItems - 1; i >= 0; --i) {
+    EXPECT_EQ(i, stack.pop());
+  }
+  EXPECT_THROW(stack.pop(), EmptyException);
+}
+
+// Counts the nodes that stacks allocate, as opposed to recycle
+struct CountingAllocator {
+  static inline std::atomic<size_t> allocations{0};
+
+  static auto allocate(size_t size) -> void* {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+  }
+
+  static auto deallocate(void* ptr, size_t size) -> void {
+    ::operator delete(ptr, size);
+  }
+};
+
+// Test that popped nodes are reused, so that the number of nodes is bounded by
+// the peak size of the stack rather than by the number of pushes
+TEST(LockFreeStackRecyclingTest, MemoryIsBoundedByPeakSize) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 20000;
+
+  CountingAllocator::allocations = 0;
+  LockFreeStack<int, std::chrono::microseconds, CountingAllocator> stack;
+  for (int i = 0; i < 100; i++) {
+    stack.push(i);
+  }
+  for (int i = 0; i < 100; i++) {
+    stack.pop();
+  }
+  EXPECT_EQ(CountingAllocator::allocations.load(), 100);
+
+  std::vector<std::atomic<int>> popped(kNumThreads * kItemsPerThread);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&stack, &popped, t]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        stack.push(t * kItemsPerThread + i);
+        int value = 0;
+        if (stack.try_pop(value)) {
+          popped[value]++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  int value = 0;
+  while (stack.try_pop(value)) {
+    popped[value]++;
+  }
+  for (const auto& count : popped) {
+    EXPECT_EQ(count.load(), 1);
+  }
+  // At most one node per thread on the stack and one in a thread's hands
+  EXPECT_LE(CountingAllocator::allocations.load(), 100 + 2 * kNumThreads);
+}
+
+// Test that the elimination policy keeps every item, whether it goes through
+// the top or is handed from a push to a pop directly
+TEST(LockFreeStackEliminationTest, ConcurrentPushPopKeepsEveryItem) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 5000;
+
+  LockFreeStack<int, std::chrono::microseconds, DefaultAllocator,
+                WithElimination<2, 64>>
+      stack;
+  std::vector<std::atomic<int>> popped(kNumThreads * kItemsPerThread);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&stack, &popped, t]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        stack.push(t * kItemsPerThread + i);
+        int value = 0;
+        if (stack.try_pop(value)) {
+          popped[value]++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  int value = 0;
+  while (stack.try_pop(value)) {
+    popped[value]++;
+  }
+  for (const auto& count : popped) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
+
+TEST(LockFreeStackEliminationTest, SequentialOrderIsLIFO) {
+  LockFreeStack<int, std::chrono::microseconds, DefaultAllocator,
+                WithElimination<>>
+      stack;
+  for (int i = 0; i < 100; i++) {
+    stack.push(i);
+  }
+  for (int i = 99; i >= 0; i--) {
+    EXPECT_EQ(stack.pop(), i);
+  }
+  EXPECT_THROW(stack.pop(), EmptyException);
+}
+
+struct StackMessage : IntrusiveHook {
+  int value_{};
+};
+
+// Test that caller-allocated nodes come back in LIFO order
+TEST(IntrusiveLockFreeStackTest, LinksCallerNodesInOrder) {
+  std::vector<StackMessage> arena(8);
+  IntrusiveLockFreeStack<StackMessage> stack;
+  EXPECT_EQ(stack.try_pop(), nullptr);
+  for (auto& node : arena) {
+    stack.push(&node);
+  }
+  for (int i = 7; i >= 0; i--) {
+    EXPECT_EQ(stack.try_pop(), &arena[i]);
+  }
+  EXPECT_EQ(stack.try_pop(), nullptr);
+}
+
+// Test that nodes popped and pushed again at once by many threads, which
+// exposes ABA on the top, are neither lost nor duplicated
+TEST(IntrusiveLockFreeStackTest, ConcurrentRecirculation) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumNodes = 4;
+  constexpr int kOpsPerThread = 20000;
+
+  std::vector<StackMessage> arena(kNumNodes);
+  IntrusiveLockFreeStack<StackMessage> stack;
+  for (int i = 0; i < kNumNodes; i++) {
+    arena[i].value_ = i;
+    stack.push(&arena[i]);
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&stack]() {
+      for (int i = 0; i < kOpsPerThread; i++) {
+        if (StackMessage* node = stack.try_pop()) {
+          stack.push(node);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<int> seen(kNumNodes, 0);
+  while (StackMessage* node = stack.try_pop()) {
+    seen[node->value_]++;
+  }
+  for (int i = 0; i < kNumNodes; i++) {
+    EXPECT_EQ(seen[i], 1) << "node " << i;
+  }
+}
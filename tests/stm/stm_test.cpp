@@ -0,0 +1,129 @@
+#include "stm/stm.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// A node that counts how many instances have been destroyed
+struct TrackedNode {
+  explicit TrackedNode(std::atomic<int>* num_deleted)
+      : num_deleted_(num_deleted) {}
+
+  ~TrackedNode() { num_deleted_->fetch_add(1, std::memory_order_relaxed); }
+
+  std::atomic<int>* num_deleted_;
+};
+
+TEST(StmTest, ReadsItsOwnWrites) {
+  TVar<int> a(1);
+  TVar<int> b(2);
+  int sum = atomically([&]() {
+    a.set(a.get() + 10);
+    b.set(a.get() + b.get());
+    return a.get() + b.get();
+  });
+  EXPECT_EQ(sum, 11 + 13);
+  EXPECT_EQ(a.get(), 11);
+  EXPECT_EQ(b.get(), 13);
+}
+
+TEST(StmTest, ExceptionDiscardsWritesAndAllocations) {
+  std::atomic<int> num_deleted{0};
+  TVar<int> value(7);
+  TVar<TrackedNode*> node(nullptr);
+
+  EXPECT_THROW(atomically([&]() {
+                 value.set(8);
+                 node.set(tm_new<TrackedNode>(&num_deleted));
+                 throw std::runtime_error("give up");
+               }),
+               std::runtime_error);
+
+  EXPECT_EQ(value.get(), 7);
+  EXPECT_EQ(node.get(), nullptr);
+  EXPECT_EQ(num_deleted.load(), 1);
+}
+
+TEST(StmTest, NestedTransactionsCommitTogether) {
+  TVar<int> a(0);
+  TVar<int> b(0);
+  EXPECT_THROW(atomically([&]() {
+                 atomically([&]() { a.set(1); });
+                 b.set(1);
+                 throw std::runtime_error("give up");
+               }),
+               std::runtime_error);
+  EXPECT_EQ(a.get(), 0);
+  EXPECT_EQ(b.get(), 0);
+}
+
+TEST(StmTest, DeleteWaitsForTheCommit) {
+  std::atomic<int> num_deleted{0};
+  auto node = new TrackedNode(&num_deleted);
+  EXPECT_THROW(atomically([&]() {
+                 tm_delete(node);
+                 throw std::runtime_error("give up");
+               }),
+               std::runtime_error);
+  EXPECT_EQ(num_deleted.load(), 0);
+
+  atomically([&]() { tm_delete(node); });
+  Transaction::domain().flush();
+  EXPECT_EQ(num_deleted.load(), 1);
+}
+
+// Threads move random amounts between accounts while others sum them up; the
+// total is the same in every snapshot.
+TEST(StmTest, TransfersPreserveTheTotal) {
+  constexpr int kNumAccounts = 16;
+  constexpr int kInitialBalance = 1000;
+  constexpr int kNumWriters = 4;
+  constexpr int kNumTransfers = 5000;
+
+  std::vector<TVar<int>> accounts(kNumAccounts);
+  for (auto& account : accounts) {
+    account.set(kInitialBalance);
+  }
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kNumWriters; t++) {
+    writers.emplace_back([&accounts, t]() {
+      for (int i = 0; i < kNumTransfers; i++) {
+        int from = (i * 7 + t) % kNumAccounts;
+        int to = (i * 13 + 3 * t + 1) % kNumAccounts;
+        atomically([&]() {
+          accounts[from].set(accounts[from].get() - 1);
+          accounts[to].set(accounts[to].get() + 1);
+        });
+      }
+    });
+  }
+  std::thread reader([&]() {
+    while (!done.load()) {
+      int total = atomically([&]() {
+        int sum = 0;
+        for (auto& account : accounts) {
+          sum += account.get();
+        }
+        return sum;
+      });
+      EXPECT_EQ(total, kNumAccounts * kInitialBalance);
+    }
+  });
+
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  done.store(true);
+  reader.join();
+
+  int total = 0;
+  for (auto& account : accounts) {
+    total += account.get();
+  }
+  EXPECT_EQ(total, kNumAccounts * kInitialBalance);
+}
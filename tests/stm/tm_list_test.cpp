@@ -0,0 +1,95 @@
+#include "stm/tm_list.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(TMListTest, SequentialOperations) {
+  TMList<int> list;
+  EXPECT_TRUE(list.add(3));
+  EXPECT_TRUE(list.add(1));
+  EXPECT_FALSE(list.add(3));
+  EXPECT_TRUE(list.contains(1));
+  EXPECT_TRUE(list.contains(3));
+  EXPECT_FALSE(list.contains(2));
+  EXPECT_TRUE(list.remove(3));
+  EXPECT_FALSE(list.remove(3));
+  EXPECT_FALSE(list.contains(3));
+}
+
+TEST(TMListTest, ItemOrder) {
+  TMList<int, std::hash<int>, std::less<int>> list;
+  for (int i : {5, 1, 4, 2, 3}) {
+    EXPECT_TRUE(list.add(i));
+  }
+  for (int i = 1; i <= 5; i++) {
+    EXPECT_TRUE(list.contains(i));
+    EXPECT_TRUE(list.remove(i));
+  }
+}
+
+TEST(TMListTest, ConcurrentAddRemove) {
+  constexpr int kNumThreads = 4;
+  constexpr int kOpsPerThread = 2000;
+  TMList<int> list;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      for (int i = 0; i < kOpsPerThread; i++) {
+        int item = (i % 20) * kNumThreads + t;
+        if (i % 40 < 20) {
+          EXPECT_TRUE(list.add(item));
+        } else {
+          EXPECT_TRUE(list.remove(item));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < 20 * kNumThreads; i++) {
+    EXPECT_FALSE(list.contains(i));
+  }
+}
+
+// Items move between two lists in transactions, so every item is in exactly
+// one of them in every snapshot.
+TEST(TMListTest, AtomicMoveBetweenLists) {
+  constexpr int kNumItems = 32;
+  constexpr int kNumThreads = 4;
+  constexpr int kMovesPerThread = 2000;
+  TMList<int> left;
+  TMList<int> right;
+  for (int i = 0; i < kNumItems; i++) {
+    left.add(i);
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kMovesPerThread; i++) {
+        int item = (i * 5 + t) % kNumItems;
+        atomically([&]() {
+          if (left.remove(item)) {
+            right.add(item);
+          } else if (right.remove(item)) {
+            left.add(item);
+          }
+        });
+        int other = (i * 3 + t) % kNumItems;
+        EXPECT_TRUE(atomically([&]() {
+          return left.contains(other) != right.contains(other);
+        }));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < kNumItems; i++) {
+    EXPECT_NE(left.contains(i), right.contains(i));
+  }
+}
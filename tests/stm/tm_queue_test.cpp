@@ -0,0 +1,93 @@
+#include "stm/tm_queue.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(TMQueueTest, FifoOrder) {
+  TMQueue<int> queue;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.try_dequeue(), std::nullopt);
+  for (int i = 0; i < 10; i++) {
+    queue.enqueue(i);
+  }
+  EXPECT_FALSE(queue.empty());
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(queue.try_dequeue(), i);
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(TMQueueTest, ConcurrentProducersAndConsumers) {
+  constexpr int kNumProducers = 2;
+  constexpr int kNumConsumers = 2;
+  constexpr int kItemsPerProducer = 5000;
+  TMQueue<int> queue;
+  std::atomic<int> num_consumed{0};
+  std::atomic<long> sum{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < kNumProducers; p++) {
+    threads.emplace_back([&queue, p]() {
+      for (int i = 0; i < kItemsPerProducer; i++) {
+        queue.enqueue(p * kItemsPerProducer + i);
+      }
+    });
+  }
+  for (int c = 0; c < kNumConsumers; c++) {
+    threads.emplace_back([&]() {
+      while (num_consumed.load() < kNumProducers * kItemsPerProducer) {
+        if (auto value = queue.try_dequeue()) {
+          sum.fetch_add(*value);
+          num_consumed.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  constexpr long kNumItems = kNumProducers * kItemsPerProducer;
+  EXPECT_EQ(sum.load(), kNumItems * (kNumItems - 1) / 2);
+  EXPECT_TRUE(queue.empty());
+}
+
+// Moving the front of one queue to the back of the other is atomic, so no
+// snapshot misses a value.
+TEST(TMQueueTest, AtomicTransferBetweenQueues) {
+  constexpr int kNumItems = 16;
+  constexpr int kNumThreads = 4;
+  constexpr int kTransfersPerThread = 2000;
+  TMQueue<int> first;
+  TMQueue<int> second;
+  for (int i = 0; i < kNumItems; i++) {
+    first.enqueue(i);
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      TMQueue<int>& from = t % 2 == 0 ? first : second;
+      TMQueue<int>& to = t % 2 == 0 ? second : first;
+      for (int i = 0; i < kTransfersPerThread; i++) {
+        atomically([&]() {
+          if (auto value = from.try_dequeue()) {
+            to.enqueue(*value);
+          }
+        });
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  int count = 0;
+  while (first.try_dequeue() || second.try_dequeue()) {
+    count++;
+  }
+  EXPECT_EQ(count, kNumItems);
+}
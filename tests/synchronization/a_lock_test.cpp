@@ -1,13 +1,14 @@
 #include "synchronization/a_lock.h"
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
-// Definition of the thread-local static member (outside the class)
-thread_local uint64_t ALock::my_slot_index = 0;
-
 /**
  * @brief This test ensures that at most one thread is in the critical section
  * at any time.
@@ -16,7 +17,7 @@ TEST(ALockTest, MutualExclusion) {
   constexpr uint32_t kNumThreads = 8;
   constexpr uint32_t kNumIterations = 10000;
 
-  ALock lock{kNumThreads};
+  ALock<> lock{kNumThreads};
   uint32_t counter = 0;
 
   auto critical_section = [&]() {
@@ -51,7 +52,7 @@ TEST(ALockTest, StressTest) {
   constexpr uint32_t kNumThreads = 8;
   constexpr uint32_t kNumIterations = 125000;
 
-  ALock lock{kNumThreads};
+  ALock<> lock{kNumThreads};
   std::atomic<uint32_t> counter = 0;
 
   auto worker = [&]() {
@@ -83,7 +84,7 @@ TEST(ALockTest, StressTest) {
 TEST(ALockTest, NoDeadLock) {
   constexpr uint32_t kNumThreads = 8;
 
-  ALock lock{kNumThreads};
+  ALock<> lock{kNumThreads};
   bool done = false;
 
   auto worker = [&]() {
@@ -104,3 +105,111 @@ TEST(ALockTest, NoDeadLock) {
 
   EXPECT_TRUE(done);
 }
+
+/**
+ * @brief This test checks that try_lock() and try_lock_for() fail while
+ * another thread holds the lock, and succeed once it is released.
+ */
+TEST(ALockTest, TryLock) {
+  ALock<> lock{2};
+
+  lock.lock();
+  std::thread holder_waits([&lock]() {
+    EXPECT_FALSE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock_for(std::chrono::milliseconds(1)));
+  });
+  holder_waits.join();
+  lock.unlock();
+
+  std::thread lock_free([&lock]() {
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+    EXPECT_TRUE(lock.try_lock_for(std::chrono::milliseconds(1)));
+    lock.unlock();
+  });
+  lock_free.join();
+}
+
+/**
+ * @brief This test checks mutual exclusion when some threads give up waiting,
+ * and that they do not keep the others from acquiring the lock.
+ */
+TEST(ALockTest, TimedOutWaitersDoNotBlock) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 2000;
+
+  ALock<> lock{kNumThreads};
+  uint32_t counter = 0;
+  std::atomic<uint32_t> acquisitions = 0;
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      bool acquired = true;
+      if (i % 2 == 0) {
+        lock.lock();
+      } else {
+        acquired = lock.try_lock_for(std::chrono::microseconds(i % 7 * 10));
+      }
+      if (acquired) {
+        counter++;
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+        lock.unlock();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, acquisitions) << "Race condition detected!";
+  EXPECT_GE(acquisitions, kNumThreads * kNumIterations / 2);
+}
+
+/**
+ * @brief Test that a thread can hold several locks of the same type at once
+ * by walking a chain of locks hand over hand.
+ */
+TEST(ALockTest, HandOverHand) {
+  constexpr uint32_t kNumThreads = 4;
+  constexpr uint32_t kNumIterations = 1000;
+  constexpr size_t kNumLocks = 4;
+
+  std::array<std::unique_ptr<ALock<>>, kNumLocks> locks;
+  for (auto& lock : locks) {
+    lock = std::make_unique<ALock<>>(kNumThreads);
+  }
+  std::array<uint32_t, kNumLocks> counters{};
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      locks[0]->lock();
+      for (size_t j = 0; j < kNumLocks; j++) {
+        counters[j]++;
+        if (j + 1 < kNumLocks) {
+          locks[j + 1]->lock();
+        }
+        locks[j]->unlock();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (uint32_t counter : counters) {
+    EXPECT_EQ(counter, kNumThreads * kNumIterations);
+  }
+}
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <chrono>
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -108,3 +109,68 @@ TEST(BackoffLockTest, NoDeadLock) {
 
   EXPECT_TRUE(done);
 }
+
+/**
+ * @brief This test checks that try_lock() and try_lock_for() fail while
+ * another thread holds the lock, and succeed once it is released.
+ */
+TEST(BackoffLockTest, TryLock) {
+  BackoffLock<std::chrono::microseconds> lock{1, 16};
+
+  lock.lock();
+  std::thread holder_waits([&lock]() {
+    EXPECT_FALSE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock_for(std::chrono::milliseconds(1)));
+  });
+  holder_waits.join();
+  lock.unlock();
+
+  std::thread lock_free([&lock]() {
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+    EXPECT_TRUE(lock.try_lock_for(std::chrono::milliseconds(1)));
+    lock.unlock();
+  });
+  lock_free.join();
+}
+
+/**
+ * @brief This test checks mutual exclusion when some threads give up waiting,
+ * and that they do not keep the others from acquiring the lock.
+ */
+TEST(BackoffLockTest, TimedOutWaitersDoNotBlock) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 2000;
+
+  BackoffLock<std::chrono::microseconds> lock{1, 16};
+  uint32_t counter = 0;
+  std::atomic<uint32_t> acquisitions = 0;
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      bool acquired = true;
+      if (i % 2 == 0) {
+        lock.lock();
+      } else {
+        acquired = lock.try_lock_for(std::chrono::microseconds(i % 7 * 10));
+      }
+      if (acquired) {
+        counter++;
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+        lock.unlock();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, acquisitions) << "Race condition detected!";
+  EXPECT_GE(acquisitions, kNumThreads * kNumIterations / 2);
+}
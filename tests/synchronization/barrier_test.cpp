@@ -0,0 +1,98 @@
+#include "synchronization/barrier.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// Arrives at `barrier` as thread `id`, for the barriers that take no id too
+template<typename Barrier>
+auto arrive_and_wait(Barrier& barrier, size_t id) -> void {
+  if constexpr (requires { barrier.arrive_and_wait(id); }) {
+    barrier.arrive_and_wait(id);
+  } else {
+    barrier.arrive_and_wait();
+  }
+}
+
+template<typename Barrier>
+class BarrierTest : public ::testing::Test {};
+
+using Barriers =
+    ::testing::Types<SenseReversingBarrier<>, CombiningTreeBarrier<>,
+                     StaticTreeBarrier<>, DisseminationBarrier<>,
+                     SenseReversingBarrier<SpinThenYield<>>,
+                     DisseminationBarrier<SpinThenYield<>>>;
+TYPED_TEST_SUITE(BarrierTest, Barriers);
+
+/**
+ * @brief In every phase, each thread writes its slot before the barrier and
+ * reads all slots after it, so a thread that leaves a phase early reads a
+ * stale slot.
+ */
+TYPED_TEST(BarrierTest, NoThreadLeavesAPhaseEarly) {
+  constexpr uint32_t kNumPhases = 200;
+
+  // Sizes that fill the trees exactly and sizes that leave them ragged
+  for (size_t num_threads : {1, 2, 5, 8, 13, 16}) {
+    TypeParam barrier{num_threads};
+    std::vector<std::atomic<uint32_t>> slots(num_threads);
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (size_t id = 0; id < num_threads; id++) {
+      threads.emplace_back([&, id]() {
+        for (uint32_t phase = 1; phase <= kNumPhases; phase++) {
+          slots[id].store(phase, std::memory_order_relaxed);
+          arrive_and_wait(barrier, id);
+          for (auto& slot : slots) {
+            EXPECT_EQ(slot.load(std::memory_order_relaxed), phase);
+          }
+          // Nobody writes the next phase before everybody has read this one
+          arrive_and_wait(barrier, id);
+        }
+      });
+    }
+
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+}
+
+/**
+ * @brief The plain data written before a barrier is visible after it.
+ */
+TYPED_TEST(BarrierTest, PublishesWritesBeforeTheBarrier) {
+  constexpr size_t kNumThreads = 6;
+  constexpr uint32_t kNumPhases = 100;
+
+  TypeParam barrier{kNumThreads};
+  std::vector<uint64_t> data(kNumThreads, 0);
+  std::vector<uint64_t> sums(kNumThreads, 0);
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (size_t id = 0; id < kNumThreads; id++) {
+    threads.emplace_back([&, id]() {
+      for (uint32_t phase = 0; phase < kNumPhases; phase++) {
+        data[id]++;
+        arrive_and_wait(barrier, id);
+        for (uint64_t value : data) {
+          sums[id] += value;
+        }
+        arrive_and_wait(barrier, id);
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+  // In phase p every thread sums kNumThreads values of p + 1
+  for (uint64_t sum : sums) {
+    EXPECT_EQ(sum, kNumThreads * kNumPhases * (kNumPhases + 1) / 2);
+  }
+}
@@ -0,0 +1,148 @@
+#include "synchronization/cohort_lock.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "synchronization/ttas_lock.h"
+#include "util/thread_index.h"
+
+// Spreads threads over three nodes, so that tests exercise the handoff of the
+// global lock between cohorts on a single-node machine
+struct ThreeNodeTopology {
+  static auto node_count() -> size_t { return 3; }
+
+  static auto this_thread_node() -> size_t { return this_thread_index() % 3; }
+};
+
+template<typename LockType>
+auto check_mutual_exclusion(LockType& lock) -> void {
+  constexpr uint32_t kNumThreads = 6;
+  constexpr uint32_t kNumIterations = 5000;
+
+  uint32_t counter = 0;
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&lock, &counter]() {
+      for (uint32_t j = 0; j < kNumIterations; j++) {
+        lock.lock();
+        uint32_t prev = counter;
+        counter++;
+        EXPECT_EQ(counter, prev + 1) << "Race condition detected!";
+        lock.unlock();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(counter, kNumThreads * kNumIterations);
+}
+
+TEST(CohortLockTest, MutualExclusionWithMCSCohorts) {
+  CohortLock<TicketLock<>, MCSLock<>, ThreeNodeTopology> lock;
+  check_mutual_exclusion(lock);
+}
+
+TEST(CohortLockTest, MutualExclusionWithTicketCohorts) {
+  CohortLock<TTASLock<>, TicketLock<>, ThreeNodeTopology> lock;
+  check_mutual_exclusion(lock);
+}
+
+TEST(CohortLockTest, MoreNodesThanCohorts) {
+  CohortLock<TicketLock<>, MCSLock<>, ThreeNodeTopology> lock{2};
+  check_mutual_exclusion(lock);
+}
+
+TEST(CohortLockTest, DefaultTopology) {
+  CohortLock<> lock;
+  check_mutual_exclusion(lock);
+}
+
+TEST(CohortLockTest, HasWaitersSeesQueuedThread) {
+  MCSLock<> lock;
+  lock.lock();
+  EXPECT_FALSE(lock.has_waiters());
+  std::atomic<bool> acquired{false};
+  std::thread waiter([&lock, &acquired]() {
+    lock.lock();
+    acquired = true;
+    lock.unlock();
+  });
+  while (!lock.has_waiters()) {
+    std::this_thread::yield();
+  }
+  EXPECT_FALSE(acquired);
+  lock.unlock();
+  waiter.join();
+  EXPECT_TRUE(acquired);
+}
+
+/**
+ * @brief This test checks that try_lock() and try_lock_for() fail while
+ * another thread holds the lock, and succeed once it is released.
+ */
+TEST(CohortLockTest, TryLock) {
+  CohortLock<TicketLock<>, MCSLock<>, ThreeNodeTopology> lock;
+
+  lock.lock();
+  std::thread holder_waits([&lock]() {
+    EXPECT_FALSE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock_for(std::chrono::milliseconds(1)));
+  });
+  holder_waits.join();
+  lock.unlock();
+
+  std::thread lock_free([&lock]() {
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+    EXPECT_TRUE(lock.try_lock_for(std::chrono::milliseconds(1)));
+    lock.unlock();
+  });
+  lock_free.join();
+}
+
+/**
+ * @brief This test checks mutual exclusion when some threads give up waiting,
+ * and that they do not keep the others from acquiring the lock.
+ */
+TEST(CohortLockTest, TimedOutWaitersDoNotBlock) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 2000;
+
+  CohortLock<TicketLock<>, MCSLock<>, ThreeNodeTopology> lock;
+  uint32_t counter = 0;
+  std::atomic<uint32_t> acquisitions = 0;
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      bool acquired = true;
+      if (i % 2 == 0) {
+        lock.lock();
+      } else {
+        acquired = lock.try_lock_for(std::chrono::microseconds(i % 7 * 10));
+      }
+      if (acquired) {
+        counter++;
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+        lock.unlock();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, acquisitions) << "Race condition detected!";
+  EXPECT_GE(acquisitions, kNumThreads * kNumIterations / 2);
+}
@@ -6,9 +6,6 @@
 
 #include "gtest/gtest.h"
 
-// Define static variables
-thread_local CompositeLock::QNode* CompositeLock::my_node_ = nullptr;
-
 using namespace std::chrono_literals;
 
 /**
@@ -163,3 +160,96 @@ TEST(CompositeLockTest, Fairness) {
 
   EXPECT_EQ(counter + failed_attempt, kNumThreads);
 }
+
+/**
+ * @brief An uncontended thread takes the fast path, and the lock still
+ * excludes other threads while it holds it.
+ */
+TEST(CompositeLockTest, FastPath) {
+  CompositeLock lock;
+  for (uint32_t i = 0; i < 1000; i++) {
+    ASSERT_TRUE(lock.try_lock());
+    lock.unlock();
+  }
+
+  lock.lock();
+  std::thread([&lock]() {
+    EXPECT_FALSE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock_for(1ms));
+  }).join();
+  lock.unlock();
+
+  // The thread that timed out above left its node in the queue, which must
+  // not keep the free lock from the fast path
+  std::thread([&lock]() {
+    bool locked = lock.try_lock();
+    EXPECT_TRUE(locked);
+    if (locked) {
+      lock.unlock();
+    }
+  }).join();
+}
+
+/**
+ * @brief Nodes abandoned by threads that timed out behind the holder leave
+ * the lock free for try_lock() once the holder releases it.
+ */
+TEST(CompositeLockTest, TryLockAfterAbortedWaiters) {
+  constexpr uint32_t kNumWaiters = 4;
+  CompositeLock lock{kNumWaiters + 1, 1, 2};
+
+  for (int round = 0; round < 20; round++) {
+    ASSERT_TRUE(lock.try_lock_for(1s));
+    std::vector<std::thread> waiters;
+    for (uint32_t i = 0; i < kNumWaiters; i++) {
+      waiters.emplace_back(
+          [&lock]() { EXPECT_FALSE(lock.try_lock_for(1ms)); });
+    }
+    for (auto& waiter : waiters) {
+      waiter.join();
+    }
+    lock.unlock();
+
+    bool locked = lock.try_lock();
+    EXPECT_TRUE(locked);
+    if (locked) {
+      lock.unlock();
+    }
+  }
+}
+
+/**
+ * @brief Threads that find the queue empty take the fast path while others
+ * queue up behind them, so both paths must exclude each other.
+ */
+TEST(CompositeLockTest, MixedFastAndSlowPaths) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 20000;
+
+  CompositeLock lock{kNumThreads / 2, 1, 10};
+  uint32_t counter = 0;
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      lock.lock();
+      counter++;
+      lock.unlock();
+      if (i % 64 == 0) {
+        // Lets the queue drain now and then, so the fast path is taken
+        std::this_thread::yield();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, kNumThreads * kNumIterations);
+}
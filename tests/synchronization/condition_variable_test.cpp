@@ -19,7 +19,7 @@ class ConditionVariableTest : public ::testing::Test {
   // Shared variables for tests
   uint32_t shared_counter_{0};
   bool ready_flag_{false};
-  TTASLock mutex_;
+  TTASLock<> mutex_;
   ConditionVariable cv_;
 };
 
@@ -81,6 +81,47 @@ TEST_F(ConditionVariableTest, NotifyAll) {
       << "All threads should increment counter";
 }
 
+// Test that notify_one wakes exactly one of several parked threads
+TEST_F(ConditionVariableTest, NotifyOneWakesExactlyOne) {
+  constexpr uint32_t kNumThreads = 4;
+  uint32_t waiting = 0;
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([this, &waiting]() {
+      mutex_.lock();
+      waiting++;
+      cv_.wait(mutex_);
+      shared_counter_++;
+      mutex_.unlock();
+    });
+  }
+
+  // A waiter is registered before it releases the lock
+  while (true) {
+    mutex_.lock();
+    bool all_waiting = waiting == kNumThreads;
+    mutex_.unlock();
+    if (all_waiting) {
+      break;
+    }
+    std::this_thread::yield();
+  }
+
+  cv_.notify_one();
+  std::this_thread::sleep_for(10ms);
+  mutex_.lock();
+  EXPECT_EQ(shared_counter_, 1) << "Exactly one thread should wake up";
+  mutex_.unlock();
+
+  cv_.notify_all();
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(shared_counter_, kNumThreads);
+}
+
 // Test predicate-based wait
 TEST_F(ConditionVariableTest, PredicateWait) {
   std::thread consumer([this]() {
@@ -340,7 +381,7 @@ TEST_F(ConditionVariableTest, StressTest) {
 TEST_F(ConditionVariableTest, DestructionTest) {
   {
     ConditionVariable local_cv;
-    TTASLock local_mutex;
+    TTASLock<> local_mutex;
 
     std::thread waiter([&local_cv, &local_mutex]() {
       local_mutex.lock();
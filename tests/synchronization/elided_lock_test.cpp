@@ -0,0 +1,140 @@
+#include "synchronization/elided_lock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "list/coarse_list.h"
+#include "synchronization/tas_lock.h"
+#include "synchronization/ticket_lock.h"
+
+template<typename Lock>
+class ElidedLockTest : public ::testing::Test {};
+
+using UnderlyingLocks = ::testing::Types<TASLock, TTASLock<>, TicketLock<>>;
+TYPED_TEST_SUITE(ElidedLockTest, UnderlyingLocks);
+
+/**
+ * @brief Elided or not, at most one thread updates the counter at a time.
+ */
+TYPED_TEST(ElidedLockTest, MutualExclusion) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 10000;
+
+  ElidedLock<TypeParam> lock;
+  uint32_t counter = 0;
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&]() {
+      for (uint32_t i = 0; i < kNumIterations; i++) {
+        lock.lock();
+        counter++;
+        lock.unlock();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(counter, kNumThreads * kNumIterations);
+}
+
+/**
+ * @brief try_lock() takes the underlying lock, which blocks lock() elsewhere.
+ */
+TYPED_TEST(ElidedLockTest, TryLockTakesTheUnderlyingLock) {
+  ElidedLock<TypeParam> lock;
+  ASSERT_TRUE(lock.try_lock());
+  EXPECT_TRUE(lock.is_locked());
+
+  std::atomic<bool> acquired{false};
+  std::thread other([&]() {
+    EXPECT_FALSE(lock.try_lock());
+    lock.lock();
+    acquired.store(true);
+    lock.unlock();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(acquired.load());
+
+  lock.unlock();
+  other.join();
+  EXPECT_TRUE(acquired.load());
+  EXPECT_FALSE(lock.is_locked());
+}
+
+TEST(ElidedLockTest, TryLockForTimesOut) {
+  ElidedLock<> lock;
+  lock.lock();
+  std::thread other([&]() {
+    EXPECT_FALSE(lock.try_lock_for(std::chrono::milliseconds(10)));
+  });
+  other.join();
+  lock.unlock();
+  EXPECT_TRUE(lock.try_lock_for(std::chrono::milliseconds(10)));
+  lock.unlock();
+}
+
+/**
+ * @brief Fallbacks double the number of acquisitions that skip elision, up to
+ * the maximum, and one successful elision clears the penalty.
+ */
+TEST(ElisionAdaptationTest, PenaltyGrowsAndClears) {
+  ElisionAdaptation adaptation;
+  EXPECT_TRUE(adaptation.should_elide());
+
+  uint32_t expected = 1;
+  for (int fallback = 0; fallback < 10; fallback++) {
+    adaptation.on_fallback();
+    EXPECT_EQ(adaptation.penalty(), expected);
+    for (uint32_t i = 0; i < expected; i++) {
+      EXPECT_FALSE(adaptation.should_elide());
+    }
+    EXPECT_TRUE(adaptation.should_elide());
+    expected = std::min(2 * expected, ElisionAdaptation::kMaxPenalty);
+  }
+  EXPECT_EQ(adaptation.penalty(), ElisionAdaptation::kMaxPenalty);
+
+  adaptation.on_elided();
+  EXPECT_EQ(adaptation.penalty(), 0U);
+  adaptation.on_fallback();
+  EXPECT_EQ(adaptation.penalty(), 1U);
+  EXPECT_FALSE(adaptation.should_elide());
+  EXPECT_TRUE(adaptation.should_elide());
+}
+
+/**
+ * @brief A list whose operations are mostly elided stays consistent.
+ */
+TEST(ElidedLockTest, CoarseListUpdates) {
+  constexpr int kNumThreads = 4;
+  constexpr int kOpsPerThread = 5000;
+  CoarseList<int, std::hash<int>, void, DefaultAllocator, ElidedLock<>> list;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      for (int i = 0; i < kOpsPerThread; i++) {
+        int item = (i % 50) * kNumThreads + t;
+        if (i % 100 < 50) {
+          EXPECT_TRUE(list.add(item));
+        } else {
+          EXPECT_TRUE(list.remove(item));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < 50 * kNumThreads; i++) {
+    EXPECT_FALSE(list.contains(i));
+  }
+}
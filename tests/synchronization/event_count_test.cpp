@@ -0,0 +1,113 @@
+#include "synchronization/event_count.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+
+TEST(EventCountTest, CancelWaitDoesNotBlock) {
+  EventCount event;
+  event.prepare_wait();
+  event.cancel_wait();
+  // Nobody is waiting, so neither call has anything to wake
+  event.notify_one();
+  event.notify_all();
+}
+
+TEST(EventCountTest, NotificationAfterPrepareIsNotLost) {
+  EventCount event;
+  uint32_t key = event.prepare_wait();
+  // The notification arrives before the thread waits, and wait() returns
+  // immediately
+  event.notify_one();
+  event.wait(key);
+}
+
+TEST(EventCountTest, WaiterSleepsUntilNotified) {
+  EventCount event;
+  std::atomic<bool> flag{false};
+  std::atomic<bool> woken{false};
+
+  std::thread waiter([&]() {
+    while (!flag.load()) {
+      uint32_t key = event.prepare_wait();
+      if (flag.load()) {
+        event.cancel_wait();
+        break;
+      }
+      event.wait(key);
+    }
+    woken = true;
+  });
+
+  std::this_thread::sleep_for(10ms);
+  EXPECT_FALSE(woken.load());
+  flag = true;
+  event.notify_one();
+  waiter.join();
+  EXPECT_TRUE(woken.load());
+}
+
+TEST(EventCountTest, NotifyAllWakesEveryWaiter) {
+  constexpr int kNumWaiters = 4;
+  EventCount event;
+  std::atomic<bool> flag{false};
+  std::atomic<int> num_woken{0};
+
+  std::vector<std::thread> waiters;
+  for (int i = 0; i < kNumWaiters; i++) {
+    waiters.emplace_back([&]() {
+      while (!flag.load()) {
+        uint32_t key = event.prepare_wait();
+        if (flag.load()) {
+          event.cancel_wait();
+          break;
+        }
+        event.wait(key);
+      }
+      num_woken++;
+    });
+  }
+
+  std::this_thread::sleep_for(10ms);
+  flag = true;
+  event.notify_all();
+  for (auto& waiter : waiters) {
+    waiter.join();
+  }
+  EXPECT_EQ(num_woken.load(), kNumWaiters);
+}
+
+TEST(EventCountTest, NotifyWakesAtMostCount) {
+  constexpr size_t kNumThreads = 4;
+
+  EventCount event;
+  std::atomic<size_t> waiting{0};
+  std::atomic<size_t> woken{0};
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (size_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&]() {
+      uint32_t key = event.prepare_wait();
+      waiting.fetch_add(1);
+      event.wait(key);
+      woken.fetch_add(1);
+    });
+  }
+  while (waiting.load() < kNumThreads) {
+    std::this_thread::yield();
+  }
+
+  // A waiter may not have parked yet, and then returns without a wake-up
+  event.notify(0);
+  event.notify(kNumThreads);
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(woken.load(), kNumThreads);
+}
@@ -15,7 +15,7 @@ class FIFOReadWriteLockTest : public ::testing::Test {
   void SetUp() override { shared_data_ = 0; }
 
   // Shared variables for tests
-  FIFOReadWriteLock lock;
+  FIFOReadWriteLock<> lock;
   uint64_t shared_data_;
 };
 
@@ -0,0 +1,79 @@
+#include "synchronization/flat_combining.h"
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class FlatCombiningTest : public ::testing::Test {
+ protected:
+  FlatCombining<std::vector<int>> fc_;
+};
+
+// Normal Cases
+
+// Test that operations run on the structure and return their results.
+TEST_F(FlatCombiningTest, AppliesOperations) {
+  fc_.apply([](std::vector<int>& v) { v.push_back(1); });
+  fc_.apply([](std::vector<int>& v) { v.push_back(2); });
+  EXPECT_EQ(fc_.apply([](std::vector<int>& v) { return v.size(); }), 2U);
+  EXPECT_EQ(fc_.apply([](const std::vector<int>& v) { return v.back(); }), 2);
+}
+
+// Test that the constructor arguments are forwarded to the structure.
+TEST(FlatCombiningConstructorTest, ForwardsArguments) {
+  FlatCombining<std::vector<int>> fc(3, 7);
+  EXPECT_EQ(fc.apply([](std::vector<int>& v) { return v; }),
+            std::vector<int>({7, 7, 7}));
+}
+
+// Edge Cases
+
+// Test that an exception thrown by an operation reaches its caller and leaves
+// the combiner usable.
+TEST_F(FlatCombiningTest, RethrowsExceptions) {
+  EXPECT_THROW(fc_.apply([](std::vector<int>& v) { return v.at(5); }),
+               std::out_of_range);
+  fc_.apply([](std::vector<int>& v) { v.push_back(1); });
+  EXPECT_EQ(fc_.apply([](std::vector<int>& v) { return v.size(); }), 1U);
+}
+
+// Test that a released record is adopted by a later thread.
+TEST_F(FlatCombiningTest, UnregisteredThreadsCanBeReplaced) {
+  for (int i = 0; i < 10; i++) {
+    std::thread thread([this, i]() {
+      fc_.apply([i](std::vector<int>& v) { v.push_back(i); });
+      fc_.unregister_thread();
+    });
+    thread.join();
+  }
+  EXPECT_EQ(fc_.apply([](std::vector<int>& v) { return v.size(); }), 10U);
+}
+
+// Concurrent Operations
+
+// Test that concurrent operations are applied exactly once each, atomically.
+TEST(FlatCombiningConcurrentTest, ConcurrentIncrements) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumOps = 20000;
+  FlatCombining<int64_t> counter(0);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&counter]() {
+      int64_t last = -1;
+      for (int i = 0; i < kNumOps; i++) {
+        int64_t value = counter.apply([](int64_t& c) { return c++; });
+        EXPECT_GT(value, last);
+        last = value;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(counter.apply([](int64_t& c) { return c; }),
+            int64_t(kNumThreads) * kNumOps);
+}
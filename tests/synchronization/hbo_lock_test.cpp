@@ -0,0 +1,123 @@
+#include "synchronization/hbo_lock.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "util/thread_index.h"
+
+struct TwoNodeTopology {
+  static auto node_count() -> size_t { return 2; }
+
+  static auto this_thread_node() -> size_t { return this_thread_index() % 2; }
+};
+
+/**
+ * @brief This test ensures that at most one thread is in the critical section
+ * at any time, with threads on two nodes.
+ */
+TEST(HBOLockTest, MutualExclusion) {
+  constexpr uint32_t kNumThreads = 4;
+  constexpr uint32_t kNumIterations = 5000;
+
+  HBOLock<std::chrono::microseconds, TwoNodeTopology> lock{1, 4, 4, 32};
+  uint32_t counter = 0;
+
+  auto critical_section = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      lock.lock();
+      uint32_t prev = counter;
+      counter++;
+      EXPECT_EQ(counter, prev + 1) << "Race condition detected!";
+      lock.unlock();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(critical_section);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, kNumThreads * kNumIterations)
+      << "Final counter value incorrect!";
+}
+
+TEST(HBOLockTest, DefaultTopology) {
+  HBOLock<> lock;
+  lock.lock();
+  lock.unlock();
+  lock.lock();
+  lock.unlock();
+}
+
+/**
+ * @brief This test checks that try_lock() and try_lock_for() fail while
+ * another thread holds the lock, and succeed once it is released.
+ */
+TEST(HBOLockTest, TryLock) {
+  HBOLock<std::chrono::microseconds, TwoNodeTopology> lock{1, 4, 4, 32};
+
+  lock.lock();
+  std::thread holder_waits([&lock]() {
+    EXPECT_FALSE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock_for(std::chrono::milliseconds(1)));
+  });
+  holder_waits.join();
+  lock.unlock();
+
+  std::thread lock_free([&lock]() {
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+    EXPECT_TRUE(lock.try_lock_for(std::chrono::milliseconds(1)));
+    lock.unlock();
+  });
+  lock_free.join();
+}
+
+/**
+ * @brief This test checks mutual exclusion when some threads give up waiting,
+ * and that they do not keep the others from acquiring the lock.
+ */
+TEST(HBOLockTest, TimedOutWaitersDoNotBlock) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 2000;
+
+  HBOLock<std::chrono::microseconds, TwoNodeTopology> lock{1, 4, 4, 32};
+  uint32_t counter = 0;
+  std::atomic<uint32_t> acquisitions = 0;
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      bool acquired = true;
+      if (i % 2 == 0) {
+        lock.lock();
+      } else {
+        acquired = lock.try_lock_for(std::chrono::microseconds(i % 7 * 10));
+      }
+      if (acquired) {
+        counter++;
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+        lock.unlock();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, acquisitions) << "Race condition detected!";
+  EXPECT_GE(acquisitions, kNumThreads * kNumIterations / 2);
+}
@@ -0,0 +1,58 @@
+#include "synchronization/latch.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(LatchTest, WaitersLeaveOnceCountedDown) {
+  constexpr size_t kNumWaiters = 4;
+
+  Latch latch{3};
+  std::atomic<size_t> left{0};
+
+  std::vector<std::thread> waiters;
+  waiters.reserve(kNumWaiters);
+  for (size_t i = 0; i < kNumWaiters; i++) {
+    waiters.emplace_back([&]() {
+      latch.wait();
+      left.fetch_add(1);
+    });
+  }
+
+  EXPECT_FALSE(latch.try_wait());
+  latch.count_down();
+  latch.count_down();
+  std::this_thread::yield();
+  EXPECT_EQ(left.load(), 0);
+  EXPECT_FALSE(latch.try_wait());
+
+  latch.count_down();
+  for (auto& t : waiters) {
+    t.join();
+  }
+  EXPECT_EQ(left.load(), kNumWaiters);
+  EXPECT_TRUE(latch.try_wait());
+}
+
+TEST(LatchTest, ArriveAndWait) {
+  constexpr size_t kNumThreads = 8;
+
+  Latch latch{kNumThreads};
+  std::atomic<size_t> arrived{0};
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (size_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&]() {
+      arrived.fetch_add(1);
+      latch.arrive_and_wait();
+      EXPECT_EQ(arrived.load(), kNumThreads);
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+}
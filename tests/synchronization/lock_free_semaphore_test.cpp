@@ -0,0 +1,151 @@
+#include "synchronization/lock_free_semaphore.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+
+TEST(LockFreeSemaphoreTest, BasicAcquireRelease) {
+  LockFreeSemaphore sem{1};
+  sem.acquire();
+  EXPECT_EQ(sem.get_value(), 0);
+  sem.release();
+  EXPECT_EQ(sem.get_value(), 1);
+}
+
+TEST(LockFreeSemaphoreTest, TryAcquire) {
+  LockFreeSemaphore sem{10};
+  EXPECT_TRUE(sem.try_acquire());
+  EXPECT_TRUE(sem.try_acquire(4));
+  EXPECT_EQ(sem.get_value(), 5);
+  EXPECT_FALSE(sem.try_acquire(6));
+  EXPECT_EQ(sem.get_value(), 5);
+  EXPECT_TRUE(sem.try_acquire(5));
+  EXPECT_FALSE(sem.try_acquire());
+  EXPECT_TRUE(sem.try_acquire(0));
+}
+
+TEST(LockFreeSemaphoreTest, TryAcquireWithTimeout) {
+  LockFreeSemaphore sem{0};
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(sem.try_acquire_for(100us));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 100us);
+
+  std::thread t([&sem]() { EXPECT_TRUE(sem.try_acquire_for(1s)); });
+  std::this_thread::sleep_for(1ms);
+  sem.release();
+  t.join();
+  EXPECT_EQ(sem.get_value(), 0);
+}
+
+// Test that acquire() parks until a release
+TEST(LockFreeSemaphoreTest, AcquireBlocksWhenZero) {
+  LockFreeSemaphore sem{0};
+  std::atomic<bool> acquired{false};
+
+  std::thread t([&]() {
+    sem.acquire();
+    acquired = true;
+  });
+
+  std::this_thread::sleep_for(1ms);
+  EXPECT_FALSE(acquired.load());
+  sem.release();
+  t.join();
+  EXPECT_TRUE(acquired.load());
+}
+
+// Test that release(n) lets exactly n of many waiters through
+TEST(LockFreeSemaphoreTest, ReleaseWakesAsManyWaitersAsPermits) {
+  constexpr size_t kNumThreads = 16;
+  constexpr int kBatch = 5;
+
+  LockFreeSemaphore sem{0};
+  std::atomic<int> acquired{0};
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (size_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&]() {
+      sem.acquire();
+      acquired.fetch_add(1);
+    });
+  }
+
+  std::this_thread::sleep_for(1ms);
+  sem.release(kBatch);
+  while (acquired.load() < kBatch) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(1ms);
+  EXPECT_EQ(acquired.load(), kBatch);
+
+  sem.release(kNumThreads - kBatch);
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(sem.get_value(), 0);
+}
+
+// Test that a batch acquire waits for enough permits, while a waiter for one
+// permit is not kept asleep by it
+TEST(LockFreeSemaphoreTest, BatchAcquire) {
+  LockFreeSemaphore sem{0};
+  std::atomic<bool> batch_acquired{false};
+  std::atomic<bool> single_acquired{false};
+
+  std::thread batch([&]() {
+    sem.acquire(3);
+    batch_acquired = true;
+  });
+  std::thread single([&]() {
+    sem.acquire();
+    single_acquired = true;
+  });
+
+  std::this_thread::sleep_for(1ms);
+  sem.release(2);
+  while (!single_acquired.load()) {
+    std::this_thread::yield();
+  }
+  EXPECT_FALSE(batch_acquired.load());
+
+  sem.release(2);
+  batch.join();
+  single.join();
+  EXPECT_TRUE(batch_acquired.load());
+  EXPECT_EQ(sem.get_value(), 0);
+}
+
+// Test that the permits are conserved under contention
+TEST(LockFreeSemaphoreTest, StressTest) {
+  constexpr size_t kNumThreads = 16;
+  constexpr size_t kNumIterations = 5000;
+  constexpr int kPermits = 3;
+
+  LockFreeSemaphore sem{kPermits};
+  std::atomic<int> inside{0};
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (size_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&, i]() {
+      int count = i % 4 == 0 ? 2 : 1;
+      for (size_t j = 0; j < kNumIterations; j++) {
+        sem.acquire(count);
+        EXPECT_LE(inside.fetch_add(count) + count, kPermits);
+        inside.fetch_sub(count);
+        sem.release(count);
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(sem.get_value(), kPermits);
+}
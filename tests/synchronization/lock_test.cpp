@@ -0,0 +1,86 @@
+#include "synchronization/lock.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "synchronization/a_lock.h"
+#include "synchronization/backoff_lock.h"
+#include "synchronization/clh_lock.h"
+#include "synchronization/cohort_lock.h"
+#include "synchronization/composite_lock.h"
+#include "synchronization/hbo_lock.h"
+#include "synchronization/mcs_lock.h"
+#include "synchronization/reentrant_lock.h"
+#include "synchronization/tas_lock.h"
+#include "synchronization/ticket_lock.h"
+#include "synchronization/timeout_lock.h"
+#include "synchronization/ttas_lock.h"
+
+// The locks satisfy the concepts without virtual functions, so calls through
+// a known lock type are direct
+static_assert(TimedLockable<TASLock> && !std::is_polymorphic_v<TASLock>);
+static_assert(TimedLockable<TTASLock<>> && !std::is_polymorphic_v<TTASLock<>>);
+static_assert(TimedLockable<TicketLock<>> &&
+              !std::is_polymorphic_v<TicketLock<>>);
+static_assert(TimedLockable<BackoffLock<>> &&
+              !std::is_polymorphic_v<BackoffLock<>>);
+static_assert(TimedLockable<ALock<>> && !std::is_polymorphic_v<ALock<>>);
+static_assert(TimedLockable<CLHLock<>> && !std::is_polymorphic_v<CLHLock<>>);
+static_assert(TimedLockable<MCSLock<>> && !std::is_polymorphic_v<MCSLock<>>);
+static_assert(TimedLockable<CohortLock<>> &&
+              !std::is_polymorphic_v<CohortLock<>>);
+static_assert(TimedLockable<HBOLock<>> && !std::is_polymorphic_v<HBOLock<>>);
+static_assert(TimedLockable<TOLock> && !std::is_polymorphic_v<TOLock>);
+static_assert(TimedLockable<CompositeLock<>> &&
+              !std::is_polymorphic_v<CompositeLock<>>);
+static_assert(TimedLockable<ReentrantLock<>> &&
+              !std::is_polymorphic_v<ReentrantLock<>>);
+
+// The queue locks also accept a node supplied by the caller
+static_assert(NodeLockable<ALock<>> && NodeLockable<CLHLock<>> &&
+              NodeLockable<MCSLock<>> && NodeLockable<TOLock>);
+static_assert(!NodeLockable<TTASLock<>> && !NodeLockable<TicketLock<>>);
+static_assert(TimedLockable<Lock>);
+static_assert(!BasicLockable<int>);
+
+// Test that locks chosen at run time behind the Lock interface still exclude
+// each other's critical sections.
+TEST(LockAdapterTest, TypeErasedLocks) {
+  constexpr uint32_t kNumThreads = 4;
+  constexpr uint32_t kNumIterations = 1000;
+
+  std::vector<std::unique_ptr<Lock>> locks;
+  locks.push_back(std::make_unique<LockAdapter<TTASLock<>>>());
+  locks.push_back(std::make_unique<LockAdapter<MCSLock<>>>());
+  locks.push_back(std::make_unique<LockAdapter<ALock<>>>(kNumThreads));
+
+  for (auto& lock : locks) {
+    uint32_t counter = 0;
+    std::vector<std::thread> threads;
+    threads.reserve(kNumThreads);
+    for (uint32_t i = 0; i < kNumThreads; i++) {
+      threads.emplace_back([&lock, &counter]() {
+        for (uint32_t j = 0; j < kNumIterations; j++) {
+          lock->lock();
+          counter++;
+          lock->unlock();
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    EXPECT_EQ(counter, kNumThreads * kNumIterations);
+
+    EXPECT_TRUE(lock->try_lock());
+    std::thread other([&lock]() {
+      EXPECT_FALSE(lock->try_lock_for(std::chrono::milliseconds(1)));
+    });
+    other.join();
+    lock->unlock();
+  }
+}
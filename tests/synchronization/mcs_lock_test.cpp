@@ -1,12 +1,13 @@
 #include "synchronization/mcs_lock.h"
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <thread>
 #include <vector>
 
 #include "gtest/gtest.h"
-
-thread_local MCSLock::QNode MCSLock::my_node_;
+#include "synchronization/scoped_lock.h"
 
 /**
  * @brief This test ensures that at most one thread is in the critical section
@@ -16,7 +17,7 @@ TEST(MCSLockTest, MutualExclusion) {
   constexpr uint32_t kNumThreads = 8;
   constexpr uint32_t kNumIterations = 10000;
 
-  MCSLock lock;
+  MCSLock<> lock;
   uint32_t counter = 0;
 
   auto critical_section = [&]() {
@@ -51,7 +52,7 @@ TEST(MCSLockTest, StressTest) {
   constexpr uint32_t kNumThreads = 8;
   constexpr uint32_t kNumIterations = 125000;
 
-  MCSLock lock;
+  MCSLock<> lock;
   std::atomic<uint32_t> counter = 0;
 
   auto worker = [&]() {
@@ -83,7 +84,7 @@ TEST(MCSLockTest, StressTest) {
 TEST(MCSLockTest, NoDeadLock) {
   constexpr uint32_t kNumThreads = 8;
 
-  MCSLock lock;
+  MCSLock<> lock;
   bool done = false;
 
   auto worker = [&]() {
@@ -104,3 +105,154 @@ TEST(MCSLockTest, NoDeadLock) {
 
   EXPECT_TRUE(done);
 }
+
+/**
+ * @brief This test checks that try_lock() and try_lock_for() fail while
+ * another thread holds the lock, and succeed once it is released.
+ */
+TEST(MCSLockTest, TryLock) {
+  MCSLock<> lock;
+
+  lock.lock();
+  std::thread holder_waits([&lock]() {
+    EXPECT_FALSE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock_for(std::chrono::milliseconds(1)));
+  });
+  holder_waits.join();
+  lock.unlock();
+
+  std::thread lock_free([&lock]() {
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+    EXPECT_TRUE(lock.try_lock_for(std::chrono::milliseconds(1)));
+    lock.unlock();
+  });
+  lock_free.join();
+}
+
+/**
+ * @brief This test checks mutual exclusion when some threads give up waiting,
+ * and that they do not keep the others from acquiring the lock.
+ */
+TEST(MCSLockTest, TimedOutWaitersDoNotBlock) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 2000;
+
+  MCSLock<> lock;
+  uint32_t counter = 0;
+  std::atomic<uint32_t> acquisitions = 0;
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      bool acquired = true;
+      if (i % 2 == 0) {
+        lock.lock();
+      } else {
+        acquired = lock.try_lock_for(std::chrono::microseconds(i % 7 * 10));
+      }
+      if (acquired) {
+        counter++;
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+        lock.unlock();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, acquisitions) << "Race condition detected!";
+  EXPECT_GE(acquisitions, kNumThreads * kNumIterations / 2);
+}
+
+/**
+ * @brief Test that a thread can hold several locks of the same type at once
+ * by walking a chain of locks hand over hand.
+ */
+TEST(MCSLockTest, HandOverHand) {
+  constexpr uint32_t kNumThreads = 4;
+  constexpr uint32_t kNumIterations = 1000;
+  constexpr size_t kNumLocks = 4;
+
+  std::array<MCSLock<>, kNumLocks> locks;
+  std::array<uint32_t, kNumLocks> counters{};
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      locks[0].lock();
+      for (size_t j = 0; j < kNumLocks; j++) {
+        counters[j]++;
+        if (j + 1 < kNumLocks) {
+          locks[j + 1].lock();
+        }
+        locks[j].unlock();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (uint32_t counter : counters) {
+    EXPECT_EQ(counter, kNumThreads * kNumIterations);
+  }
+}
+
+/**
+ * @brief Test locking with nodes supplied by the caller, both hand over hand
+ * and nested through ScopedLock.
+ */
+TEST(MCSLockTest, CallerSuppliedNodes) {
+  constexpr uint32_t kNumThreads = 4;
+  constexpr uint32_t kNumIterations = 1000;
+  constexpr size_t kNumLocks = 4;
+
+  std::array<MCSLock<>, kNumLocks> locks;
+  std::array<uint32_t, kNumLocks> counters{};
+
+  auto worker = [&]() {
+    std::array<MCSLock<>::Node, kNumLocks> nodes;
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      locks[0].lock(nodes[0]);
+      for (size_t j = 0; j < kNumLocks; j++) {
+        counters[j]++;
+        if (j + 1 < kNumLocks) {
+          locks[j + 1].lock(nodes[j + 1]);
+        }
+        locks[j].unlock(nodes[j]);
+      }
+
+      ScopedLock<MCSLock<>> first(locks[0]);
+      ScopedLock<MCSLock<>> last(locks[kNumLocks - 1]);
+      counters[0]++;
+      counters[kNumLocks - 1]++;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counters[0], 2 * kNumThreads * kNumIterations);
+  EXPECT_EQ(counters[1], kNumThreads * kNumIterations);
+  EXPECT_EQ(counters[kNumLocks - 1], 2 * kNumThreads * kNumIterations);
+}
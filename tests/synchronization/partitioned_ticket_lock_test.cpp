@@ -0,0 +1,147 @@
+#include "synchronization/partitioned_ticket_lock.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/**
+ * @brief This test ensures that at most one thread is in the critical section
+ * at any time, with more threads than slots so that waiters share slots.
+ */
+TEST(PartitionedTicketLockTest, MutualExclusion) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 1000;
+
+  PartitionedTicketLock<2> lock;
+  uint32_t counter = 0;
+
+  auto critical_section = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      lock.lock();
+      uint32_t expected = counter++;
+      std::this_thread::yield();  // Encourage race conditions
+      EXPECT_EQ(counter, expected + 1);
+      lock.unlock();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(critical_section);
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, kNumIterations * kNumThreads);
+  EXPECT_FALSE(lock.is_locked());
+}
+
+/**
+ * @brief This test checks that threads enter in the order they took their
+ * tickets, across more than one lap of the slots.
+ */
+TEST(PartitionedTicketLockTest, FIFOOrder) {
+  constexpr uint32_t kNumThreads = 6;
+
+  PartitionedTicketLock<4, SpinThenPark<>> lock;
+  std::vector<uint32_t> order;
+
+  lock.lock();
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    std::atomic<bool> started = false;
+    threads.emplace_back([&lock, &order, &started, i]() {
+      started = true;
+      lock.lock();
+      order.push_back(i);
+      lock.unlock();
+    });
+    while (!started) {
+      std::this_thread::yield();
+    }
+    // Long enough for the thread to take its ticket
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(lock.has_waiters());
+  lock.unlock();
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(order.size(), kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    EXPECT_EQ(order[i], i);
+  }
+}
+
+/**
+ * @brief This test checks that try_lock() and try_lock_for() fail while
+ * another thread holds the lock, and succeed once it is released.
+ */
+TEST(PartitionedTicketLockTest, TryLock) {
+  PartitionedTicketLock<> lock;
+
+  lock.lock();
+  std::thread holder_waits([&lock]() {
+    EXPECT_FALSE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock_for(std::chrono::milliseconds(1)));
+  });
+  holder_waits.join();
+  lock.unlock();
+
+  std::thread lock_free([&lock]() {
+    EXPECT_TRUE(lock.try_lock());
+    EXPECT_FALSE(lock.has_waiters());
+    lock.unlock();
+    EXPECT_TRUE(lock.try_lock_for(std::chrono::milliseconds(1)));
+    lock.unlock();
+  });
+  lock_free.join();
+}
+
+/**
+ * @brief This test checks mutual exclusion when some threads give up waiting,
+ * and that they do not keep the others from acquiring the lock.
+ */
+TEST(PartitionedTicketLockTest, TimedOutWaitersDoNotBlock) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 2000;
+
+  PartitionedTicketLock<4> lock;
+  uint32_t counter = 0;
+  std::atomic<uint32_t> acquisitions = 0;
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      bool acquired = true;
+      if (i % 2 == 0) {
+        lock.lock();
+      } else {
+        acquired = lock.try_lock_for(std::chrono::microseconds(i % 7 * 10));
+      }
+      if (acquired) {
+        counter++;
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+        lock.unlock();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, acquisitions) << "Race condition detected!";
+  EXPECT_GE(acquisitions, kNumThreads * kNumIterations / 2);
+}
@@ -0,0 +1,209 @@
+#include "synchronization/qspin_lock.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "list/lazy_list.h"
+#include "memory/epoch_based_reclamation.h"
+
+static_assert(sizeof(QSpinLock<>) == 4);
+
+/**
+ * @brief This test ensures that at most one thread is in the critical section
+ * at any time, while waiters go through both the pending bit and the queue.
+ */
+TEST(QSpinLockTest, MutualExclusion) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 1000;
+
+  QSpinLock<> lock;
+  uint32_t counter = 0;
+
+  auto critical_section = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      lock.lock();
+      uint32_t expected = counter++;
+      std::this_thread::yield();  // Encourage race conditions
+      EXPECT_EQ(counter, expected + 1);
+      lock.unlock();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(critical_section);
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, kNumIterations * kNumThreads);
+  // The queue has drained, so the lock is a plain free word again
+  EXPECT_FALSE(lock.is_locked());
+  EXPECT_TRUE(lock.try_lock());
+  lock.unlock();
+}
+
+/**
+ * @brief This test checks correctness under high contention, with waiters
+ * parking on the lock word and on their queue nodes.
+ */
+TEST(QSpinLockTest, StressTest) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 20000;
+
+  QSpinLock<SpinThenPark<>> lock;
+  uint64_t counter = 0;
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      lock.lock();
+      counter++;
+      lock.unlock();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, uint64_t{kNumThreads} * kNumIterations);
+}
+
+/**
+ * @brief A stress test in which waiters park without spinning first, so that
+ * every hand-over depends on a notification. It exercises the pending bit
+ * and the queue under contention, but can not force any one interleaving.
+ */
+TEST(QSpinLockTest, ParkingWaitersStressTest) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 20000;
+
+  QSpinLock<SpinThenPark<0>> lock;
+  uint64_t counter = 0;
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      lock.lock();
+      counter++;
+      if (i % 8 == 0) {
+        std::this_thread::yield();  // Let waiters pile up behind the holder
+      }
+      lock.unlock();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, uint64_t{kNumThreads} * kNumIterations);
+  EXPECT_FALSE(lock.is_locked());
+}
+
+/**
+ * @brief This test checks that try_lock() and try_lock_for() fail while
+ * another thread holds the lock, and succeed once it is released.
+ */
+TEST(QSpinLockTest, TryLock) {
+  QSpinLock<> lock;
+
+  lock.lock();
+  EXPECT_TRUE(lock.is_locked());
+  std::thread holder_waits([&lock]() {
+    EXPECT_FALSE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock_for(std::chrono::milliseconds(1)));
+  });
+  holder_waits.join();
+  lock.unlock();
+
+  std::thread lock_free([&lock]() {
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+    EXPECT_TRUE(lock.try_lock_for(std::chrono::milliseconds(1)));
+    lock.unlock();
+  });
+  lock_free.join();
+}
+
+/**
+ * @brief This test checks that exited threads hand back their queue nodes, so
+ * that far more threads than there are node ids can use the lock over time.
+ */
+TEST(QSpinLockTest, ExitedThreadsReleaseTheirNodes) {
+  constexpr uint32_t kNumRounds = 200;
+  constexpr uint32_t kNumThreads = 4;
+
+  QSpinLock<> lock;
+  uint32_t counter = 0;
+  for (uint32_t round = 0; round < kNumRounds; round++) {
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < kNumThreads; i++) {
+      threads.emplace_back([&]() {
+        for (int j = 0; j < 10; j++) {
+          lock.lock();
+          counter++;
+          std::this_thread::yield();
+          lock.unlock();
+        }
+        // Ids are reused, so they stay below the number of threads that
+        // have been alive at once in this program
+        EXPECT_GE(QSpinNodes::this_thread_id(), 1U);
+        EXPECT_LE(QSpinNodes::this_thread_id(), 16U);
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+  EXPECT_EQ(counter, kNumRounds * kNumThreads * 10);
+}
+
+/**
+ * @brief This test checks the lock as the per-node lock of a LazyList, which
+ * it does not grow beyond a TTASLock.
+ */
+TEST(QSpinLockTest, PerNodeLockOfLazyList) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumKeys = 1000;
+
+  LazyList<int, std::hash<int>, EpochBasedReclamation, void, DefaultAllocator,
+           QSpinLock<>>
+      list;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      for (int key = t; key < kNumKeys; key += kNumThreads) {
+        EXPECT_TRUE(list.add(key));
+      }
+      for (int key = t; key < kNumKeys; key += 2 * kNumThreads) {
+        EXPECT_TRUE(list.remove(key));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (int key = 0; key < kNumKeys; key++) {
+    EXPECT_EQ(list.contains(key), key % (2 * kNumThreads) >= kNumThreads);
+  }
+}
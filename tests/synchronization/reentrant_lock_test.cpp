@@ -297,3 +297,30 @@ TEST(ReentrantLockTest, NotifyAllWakesUpWaitingThreads) {
     t.join();
   }
 }
+
+/**
+ * @brief This test verifies that the owner re-enters with try_lock() and
+ * try_lock_for() while other threads fail to acquire the lock.
+ */
+TEST(ReentrantLockTest, TryLock) {
+  ReentrantLock lock;
+
+  ASSERT_TRUE(lock.try_lock());
+  EXPECT_TRUE(lock.try_lock_for(1ms));
+  EXPECT_TRUE(lock.is_held_by_current_thread());
+
+  std::thread([&lock]() {
+    EXPECT_FALSE(lock.is_held_by_current_thread());
+    EXPECT_FALSE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock_for(1ms));
+  }).join();
+
+  lock.unlock();
+  lock.unlock();
+  EXPECT_FALSE(lock.is_held_by_current_thread());
+
+  std::thread([&lock]() {
+    EXPECT_TRUE(lock.try_lock_for(1ms));
+    lock.unlock();
+  }).join();
+}
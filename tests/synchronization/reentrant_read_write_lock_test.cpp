@@ -0,0 +1,205 @@
+#include "synchronization/reentrant_read_write_lock.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+
+/**
+ * @brief A reader re-enters the read lock even while a writer waits for it,
+ * which would deadlock if re-entry queued up behind the writer.
+ */
+TEST(ReentrantReadWriteLockTest, ReentrantReadsWithWaitingWriter) {
+  ReentrantReadWriteLock<> lock;
+  std::atomic<bool> writer_done{false};
+
+  lock.read_lock();
+  std::thread writer([&]() {
+    lock.write_lock();
+    writer_done = true;
+    lock.write_unlock();
+  });
+
+  std::this_thread::sleep_for(1ms);
+  lock.read_lock();
+  lock.read_lock();
+  EXPECT_FALSE(writer_done.load());
+  lock.read_unlock();
+  lock.read_unlock();
+  lock.read_unlock();
+
+  writer.join();
+  EXPECT_TRUE(writer_done.load());
+}
+
+/**
+ * @brief A writer re-enters the write lock, may also read, and stays a reader
+ * when it releases the write lock while still holding the read lock.
+ */
+TEST(ReentrantReadWriteLockTest, WriterDowngradesToReader) {
+  ReentrantReadWriteLock<> lock;
+  std::atomic<bool> writer_done{false};
+
+  lock.write_lock();
+  lock.write_lock();
+  lock.read_lock();
+  lock.write_unlock();
+  lock.write_unlock();
+
+  // Other readers may enter now, but writers may not
+  std::thread([&lock]() {
+    lock.read_lock();
+    lock.read_unlock();
+  }).join();
+  std::thread writer([&]() {
+    lock.write_lock();
+    writer_done = true;
+    lock.write_unlock();
+  });
+  std::this_thread::sleep_for(1ms);
+  EXPECT_FALSE(writer_done.load());
+
+  lock.read_unlock();
+  writer.join();
+  EXPECT_TRUE(writer_done.load());
+}
+
+/**
+ * @brief The upgradeable holder shares the lock with readers, and takes the
+ * write lock once they have left.
+ */
+TEST(ReentrantReadWriteLockTest, UpgradeWaitsForReaders) {
+  ReentrantReadWriteLock<> lock;
+  std::atomic<bool> reader_in{false};
+  std::atomic<bool> reader_leaving{false};
+  std::atomic<bool> upgraded{false};
+
+  lock.upgradeable_lock();
+  std::thread reader([&]() {
+    lock.read_lock();
+    reader_in = true;
+    std::this_thread::sleep_for(1ms);
+    EXPECT_FALSE(upgraded.load());
+    reader_leaving = true;
+    lock.read_unlock();
+  });
+  while (!reader_in.load()) {
+    std::this_thread::yield();
+  }
+
+  // Only one thread at a time holds the upgradeable lock
+  std::atomic<bool> other_upgrader_in{false};
+  std::thread other_upgrader([&]() {
+    lock.upgradeable_lock();
+    other_upgrader_in = true;
+    lock.upgradeable_unlock();
+  });
+
+  lock.write_lock();
+  upgraded = true;
+  EXPECT_TRUE(reader_leaving.load());
+  lock.write_unlock();
+
+  // Back to the upgradeable lock
+  std::this_thread::sleep_for(1ms);
+  EXPECT_FALSE(other_upgrader_in.load());
+  lock.upgradeable_unlock();
+
+  reader.join();
+  other_upgrader.join();
+  EXPECT_TRUE(other_upgrader_in.load());
+}
+
+/**
+ * @brief Misuse throws: a plain reader cannot upgrade, and a thread cannot
+ * release a mode it does not hold.
+ */
+TEST(ReentrantReadWriteLockTest, Misuse) {
+  ReentrantReadWriteLock<> lock;
+
+  EXPECT_THROW(lock.read_unlock(), std::runtime_error);
+  EXPECT_THROW(lock.upgradeable_unlock(), std::runtime_error);
+  EXPECT_THROW(lock.write_unlock(), std::runtime_error);
+
+  lock.read_lock();
+  EXPECT_THROW(lock.write_lock(), std::logic_error);
+  EXPECT_THROW(lock.upgradeable_lock(), std::logic_error);
+  lock.read_unlock();
+
+  // The lock is free again
+  lock.write_lock();
+  std::thread([&lock]() {
+    EXPECT_THROW(lock.write_unlock(), std::runtime_error);
+  }).join();
+  lock.write_unlock();
+}
+
+/**
+ * @brief Readers, upgraders and writers, all re-entering, never see a
+ * half-done write.
+ */
+TEST(ReentrantReadWriteLockTest, StressTest) {
+  constexpr size_t kNumThreads = 8;
+  constexpr size_t kNumIterations = 20000;
+
+  ReentrantReadWriteLock<> lock;
+  uint64_t first = 0;
+  uint64_t second = 0;
+  std::atomic<uint64_t> num_writes{0};
+
+  auto worker = [&](size_t id) {
+    for (size_t i = 0; i < kNumIterations; i++) {
+      switch ((id + i) % 3) {
+        case 0:
+          lock.read_lock();
+          lock.read_lock();
+          EXPECT_EQ(first, second);
+          lock.read_unlock();
+          lock.read_unlock();
+          break;
+        case 1:
+          lock.upgradeable_lock();
+          EXPECT_EQ(first, second);
+          if (i % 2 == 0) {
+            lock.write_lock();
+            first++;
+            second++;
+            num_writes.fetch_add(1, std::memory_order_relaxed);
+            lock.write_unlock();
+          }
+          lock.upgradeable_unlock();
+          break;
+        default:
+          lock.write_lock();
+          lock.write_lock();
+          first++;
+          lock.read_lock();
+          second++;
+          num_writes.fetch_add(1, std::memory_order_relaxed);
+          lock.write_unlock();
+          lock.write_unlock();
+          EXPECT_EQ(first, second);
+          lock.read_unlock();
+          break;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (size_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker, i);
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(first, num_writes.load());
+  EXPECT_EQ(second, num_writes.load());
+}
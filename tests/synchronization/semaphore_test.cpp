@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "synchronization/mcs_lock.h"
 #include "synchronization/semaphore.h"
 
 using namespace std::chrono_literals;
@@ -355,3 +356,33 @@ TEST(SemaphoreTest, StressTest) {
   // The final value should be the same as the initial value
   EXPECT_EQ(sem.get_value(), kInitValue);
 }
+
+// Test a semaphore whose internal lock is a queue lock, which the condition
+// variable releases and reacquires through the guard's node
+TEST(SemaphoreTest, WorksWithMCSLock) {
+  constexpr size_t kNumThreads = 8;
+  constexpr int kIterations = 1000;
+
+  Semaphore<MCSLock<>> sem{1};
+  int counter = 0;
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (size_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < kIterations; j++) {
+        sem.acquire();
+        counter++;
+        sem.release();
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter, static_cast<int>(kNumThreads) * kIterations);
+  EXPECT_TRUE(sem.try_acquire_for(1ms));
+  EXPECT_FALSE(sem.try_acquire_for(1ms));
+}
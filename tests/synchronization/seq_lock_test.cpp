@@ -0,0 +1,109 @@
+#include "synchronization/seq_lock.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "synchronization/mcs_lock.h"
+
+namespace {
+
+// A value spanning several words, whose fields a torn read would disagree on
+struct Snapshot {
+  uint64_t version;
+  uint64_t fields[5];
+};
+
+auto make_snapshot(uint64_t version) -> Snapshot {
+  Snapshot snapshot{version, {}};
+  for (uint64_t& field : snapshot.fields) {
+    field = version;
+  }
+  return snapshot;
+}
+
+}  // namespace
+
+// Test loads and stores from a single thread
+TEST(SeqLockTest, BasicFunctionality) {
+  SeqLock<Snapshot> lock{make_snapshot(3)};
+  EXPECT_EQ(lock.load().version, 3);
+
+  lock.store(make_snapshot(4));
+  EXPECT_EQ(lock.load().fields[4], 4);
+
+  lock.update([](Snapshot& snapshot) { snapshot.fields[0] = 7; });
+  Snapshot snapshot = lock.load();
+  EXPECT_EQ(snapshot.version, 4);
+  EXPECT_EQ(snapshot.fields[0], 7);
+}
+
+// Test that a stamp taken before a write fails validation
+TEST(SeqLockTest, WriteInvalidatesStamp) {
+  SeqLock<uint64_t> lock;
+  uint64_t stamp = lock.try_optimistic_read();
+  ASSERT_NE(stamp, 0);
+  EXPECT_TRUE(lock.validate(stamp));
+
+  lock.store(1);
+  EXPECT_FALSE(lock.validate(stamp));
+  EXPECT_TRUE(lock.validate(lock.try_optimistic_read()));
+  EXPECT_FALSE(lock.validate(0));
+}
+
+// Test that readers never see a torn value while writers update it
+TEST(SeqLockTest, ReadersNeverSeeTornValues) {
+  constexpr size_t kNumReaders = 4;
+  constexpr size_t kNumWriters = 2;
+  constexpr uint64_t kWritesPerWriter = 5000;
+
+  SeqLock<Snapshot, MCSLock<>> lock{make_snapshot(0)};
+  std::atomic<bool> done{false};
+  std::atomic<uint64_t> torn_reads{0};
+
+  std::vector<std::thread> readers;
+  readers.reserve(kNumReaders);
+  for (size_t i = 0; i < kNumReaders; i++) {
+    readers.emplace_back([&lock, &done, &torn_reads]() {
+      uint64_t last_version = 0;
+      while (!done) {
+        Snapshot snapshot = lock.load();
+        for (uint64_t field : snapshot.fields) {
+          if (field != snapshot.version) {
+            torn_reads++;
+          }
+        }
+        // Versions only grow
+        if (snapshot.version < last_version) {
+          torn_reads++;
+        }
+        last_version = snapshot.version;
+      }
+    });
+  }
+
+  std::vector<std::thread> writers;
+  writers.reserve(kNumWriters);
+  for (size_t i = 0; i < kNumWriters; i++) {
+    writers.emplace_back([&lock]() {
+      for (uint64_t j = 0; j < kWritesPerWriter; j++) {
+        lock.update([](Snapshot& snapshot) {
+          snapshot = make_snapshot(snapshot.version + 1);
+        });
+      }
+    });
+  }
+
+  for (auto& t : writers) {
+    t.join();
+  }
+  done = true;
+  for (auto& t : readers) {
+    t.join();
+  }
+
+  EXPECT_EQ(torn_reads, 0);
+  EXPECT_EQ(lock.load().version, kNumWriters * kWritesPerWriter);
+}
@@ -0,0 +1,99 @@
+#include "synchronization/shared_ttas_lock.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(SharedTTASLockTest, ReadersShareTheLock) {
+  SharedTTASLock<> lock;
+  lock.lock_shared();
+  EXPECT_TRUE(lock.try_lock_shared());
+  EXPECT_FALSE(lock.try_lock());
+  lock.unlock_shared();
+  lock.unlock_shared();
+  EXPECT_TRUE(lock.try_lock());
+  EXPECT_FALSE(lock.try_lock_shared());
+  lock.unlock();
+}
+
+TEST(SharedTTASLockTest, WriterWaitsForReaders) {
+  SharedTTASLock<> lock;
+  std::atomic<bool> written{false};
+  lock.lock_shared();
+
+  std::thread writer([&]() {
+    lock.lock();
+    written.store(true);
+    lock.unlock();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(written.load());
+  // The waiting writer turns new readers away
+  EXPECT_FALSE(lock.try_lock_shared());
+
+  lock.unlock_shared();
+  writer.join();
+  EXPECT_TRUE(written.load());
+}
+
+TEST(SharedTTASLockTest, TryLockForTimesOut) {
+  SharedTTASLock<> lock;
+  lock.lock_shared();
+  std::thread other([&]() {
+    EXPECT_FALSE(lock.try_lock_for(std::chrono::milliseconds(10)));
+  });
+  other.join();
+  lock.unlock_shared();
+  EXPECT_TRUE(lock.try_lock_for(std::chrono::milliseconds(10)));
+  lock.unlock();
+}
+
+/**
+ * @brief Writers update two counters that readers must always see equal.
+ */
+template<typename WaitPolicy>
+void check_readers_and_writers() {
+  constexpr int kNumReaders = 4;
+  constexpr int kNumWriters = 2;
+  constexpr int kNumIterations = 5000;
+  SharedTTASLock<WaitPolicy> lock;
+  int first = 0;
+  int second = 0;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumWriters; t++) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < kNumIterations; i++) {
+        lock.lock();
+        first++;
+        std::this_thread::yield();
+        second++;
+        lock.unlock();
+      }
+    });
+  }
+  for (int t = 0; t < kNumReaders; t++) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < kNumIterations; i++) {
+        lock.lock_shared();
+        EXPECT_EQ(first, second);
+        lock.unlock_shared();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(first, kNumWriters * kNumIterations);
+}
+
+TEST(SharedTTASLockTest, ReadersAndWriters) {
+  check_readers_and_writers<DefaultWaitPolicy>();
+}
+
+TEST(SharedTTASLockTest, ReadersAndWritersParking) {
+  check_readers_and_writers<SpinThenPark<>>();
+}
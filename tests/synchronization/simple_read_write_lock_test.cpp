@@ -15,7 +15,7 @@ class SimpleReadWriteLockTest : public ::testing::Test {
   void SetUp() override { shared_data_ = 0; }
 
   // Shared variables for tests
-  SimpleReadWriteLock lock;
+  SimpleReadWriteLock<> lock;
   uint64_t shared_data_;
 };
 
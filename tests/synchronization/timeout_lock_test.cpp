@@ -1,15 +1,12 @@
 #include "synchronization/timeout_lock.h"
 
+#include <array>
 #include <atomic>
 #include <thread>
 #include <vector>
 
 #include "gtest/gtest.h"
 
-// Define static variables
-thread_local TOLock::QNode* TOLock::my_node_;
-const TOLock::QNode TOLock::AVAILABLE;
-
 using namespace std::chrono_literals;
 
 /**
@@ -143,3 +140,82 @@ TEST(TOLockTest, Fairness) {
 
   EXPECT_EQ(counter, kNumThreads);
 }
+
+/**
+ * @brief Test that waiters which time out in the middle of the queue leave
+ * nodes that their successors reclaim, so that the lock stays usable and
+ * nothing leaks when many attempts give up.
+ */
+TEST(TOLockTest, AbandonedNodesAreReclaimed) {
+  constexpr uint32_t kNumThreads = 8;
+  constexpr uint32_t kNumIterations = 20000;
+
+  TOLock lock;
+  uint32_t counter = 0;
+  std::atomic<uint32_t> failed_attempt{0};
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      if (lock.try_lock(1us)) {
+        counter++;
+        lock.unlock();
+      } else {
+        failed_attempt.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(counter + failed_attempt, kNumThreads * kNumIterations);
+  EXPECT_TRUE(lock.try_lock());
+  lock.unlock();
+}
+
+/**
+ * @brief Test that a thread can hold several locks of the same type at once
+ * by walking a chain of locks hand over hand.
+ */
+TEST(TOLockTest, HandOverHand) {
+  constexpr uint32_t kNumThreads = 4;
+  constexpr uint32_t kNumIterations = 1000;
+  constexpr size_t kNumLocks = 4;
+
+  std::array<TOLock, kNumLocks> locks;
+  std::array<uint32_t, kNumLocks> counters{};
+
+  auto worker = [&]() {
+    for (uint32_t i = 0; i < kNumIterations; i++) {
+      locks[0].lock();
+      for (size_t j = 0; j < kNumLocks; j++) {
+        counters[j]++;
+        if (j + 1 < kNumLocks) {
+          locks[j + 1].lock();
+        }
+        locks[j].unlock();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back(worker);
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (uint32_t counter : counters) {
+    EXPECT_EQ(counter, kNumThreads * kNumIterations);
+  }
+}
@@ -0,0 +1,71 @@
+#include "synchronization/wait_policy.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "synchronization/a_lock.h"
+#include "synchronization/clh_lock.h"
+#include "synchronization/mcs_lock.h"
+#include "synchronization/ticket_lock.h"
+#include "synchronization/ttas_lock.h"
+
+template<typename WaitPolicy>
+class WaitPolicyTest : public ::testing::Test {};
+
+using WaitPolicies = ::testing::Types<SpinWait, PauseBackoffWait<>,
+                                      SpinThenYield<>, SpinThenPark<>>;
+TYPED_TEST_SUITE(WaitPolicyTest, WaitPolicies);
+
+TYPED_TEST(WaitPolicyTest, WaitReturnsOnceReady) {
+  std::atomic<uint32_t> flag{0};
+  std::thread setter([&flag]() {
+    for (uint32_t i = 1; i <= 3; i++) {
+      flag.store(i, std::memory_order_release);
+      TypeParam::notify_all(flag);
+    }
+  });
+  uint32_t value =
+      TypeParam::wait_until(flag, [](uint32_t v) { return v == 3; });
+  EXPECT_EQ(value, 3);
+  setter.join();
+}
+
+// Runs `kNumThreads` threads that increment a plain counter under `lock`
+template<typename LockType>
+auto count_under_lock(LockType& lock) -> void {
+  constexpr uint32_t kNumThreads = 4;
+  constexpr uint32_t kNumIterations = 5000;
+
+  uint32_t counter = 0;
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (uint32_t i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&lock, &counter]() {
+      for (uint32_t j = 0; j < kNumIterations; j++) {
+        lock.lock();
+        counter++;
+        lock.unlock();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(counter, kNumThreads * kNumIterations);
+}
+
+TYPED_TEST(WaitPolicyTest, LocksStayMutuallyExclusive) {
+  ALock<TypeParam> a_lock{4};
+  count_under_lock(a_lock);
+  CLHLock<TypeParam> clh_lock;
+  count_under_lock(clh_lock);
+  MCSLock<TypeParam> mcs_lock;
+  count_under_lock(mcs_lock);
+  TicketLock<TypeParam> ticket_lock;
+  count_under_lock(ticket_lock);
+  TTASLock<TypeParam> ttas_lock;
+  count_under_lock(ttas_lock);
+}
@@ -0,0 +1,237 @@
+#include "tree/optimistic_btree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// Small nodes, so that a few hundred items already make a tree of several
+// levels
+using SmallNodeTree = OptimisticBTree<int, std::less<int>, 128>;
+
+class OptimisticBTreeTest : public ::testing::Test {
+ protected:
+  SmallNodeTree tree_;
+};
+
+TEST_F(OptimisticBTreeTest, EmptyTreeContainsReturnsFalse) {
+  EXPECT_FALSE(tree_.contains(1));
+  EXPECT_FALSE(tree_.remove(1));
+}
+
+TEST_F(OptimisticBTreeTest, AddRemoveContains) {
+  EXPECT_TRUE(tree_.add(5));
+  EXPECT_FALSE(tree_.add(5));
+  EXPECT_TRUE(tree_.contains(5));
+  EXPECT_FALSE(tree_.contains(4));
+  EXPECT_TRUE(tree_.remove(5));
+  EXPECT_FALSE(tree_.remove(5));
+  EXPECT_FALSE(tree_.contains(5));
+}
+
+TEST_F(OptimisticBTreeTest, BoundaryValues) {
+  EXPECT_TRUE(tree_.add(INT32_MIN));
+  EXPECT_TRUE(tree_.add(INT32_MAX));
+  EXPECT_TRUE(tree_.add(0));
+  EXPECT_TRUE(tree_.contains(INT32_MIN));
+  EXPECT_TRUE(tree_.contains(INT32_MAX));
+  EXPECT_TRUE(tree_.contains(0));
+  EXPECT_FALSE(tree_.contains(1));
+}
+
+TEST_F(OptimisticBTreeTest, SplitsKeepAllItems) {
+  // Ascending, descending and shuffled insertion orders split different nodes
+  constexpr int kNumItems = 5000;
+  std::vector<int> items;
+  for (int i = 0; i < kNumItems; i++) {
+    items.push_back(i);
+  }
+  std::vector<std::vector<int>> orders{items, items, items};
+  std::reverse(orders[1].begin(), orders[1].end());
+  std::shuffle(orders[2].begin(), orders[2].end(), std::mt19937(42));
+
+  for (const auto& order : orders) {
+    SmallNodeTree tree;
+    for (int item : order) {
+      ASSERT_TRUE(tree.add(item));
+    }
+    for (int i = 0; i < kNumItems; i++) {
+      ASSERT_TRUE(tree.contains(i));
+      ASSERT_FALSE(tree.add(i));
+    }
+    EXPECT_FALSE(tree.contains(-1));
+    EXPECT_FALSE(tree.contains(kNumItems));
+
+    std::vector<int> visited;
+    tree.for_each_in_range(INT32_MIN, INT32_MAX,
+                           [&](int item) { visited.push_back(item); });
+    EXPECT_EQ(visited, items);
+
+    for (int item : order) {
+      ASSERT_TRUE(tree.remove(item));
+    }
+    for (int i = 0; i < kNumItems; i++) {
+      ASSERT_FALSE(tree.contains(i));
+    }
+  }
+}
+
+TEST_F(OptimisticBTreeTest, ForEachInRange) {
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_TRUE(tree_.add(i));
+  }
+  EXPECT_TRUE(tree_.remove(15));
+
+  std::vector<int> visited;
+  tree_.for_each_in_range(10, 19, [&](int item) { visited.push_back(item); });
+  EXPECT_EQ(visited, (std::vector<int>{10, 11, 12, 13, 14, 16, 17, 18, 19}));
+
+  visited.clear();
+  tree_.for_each_in_range(990, 2000,
+                          [&](int item) { visited.push_back(item); });
+  EXPECT_EQ(visited.size(), 10u);
+  EXPECT_EQ(visited.front(), 990);
+
+  visited.clear();
+  tree_.for_each_in_range(2000, 3000,
+                          [&](int item) { visited.push_back(item); });
+  EXPECT_TRUE(visited.empty());
+}
+
+TEST(OptimisticBTreeComparatorTest, OrderFollowsComparator) {
+  OptimisticBTree<int, std::greater<int>, 128> tree;
+  for (int i = 0; i < 500; i++) {
+    EXPECT_TRUE(tree.add(i));
+  }
+  std::vector<int> visited;
+  tree.for_each_in_range(20, 10, [&](int item) { visited.push_back(item); });
+  EXPECT_EQ(visited,
+            (std::vector<int>{20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10}));
+}
+
+TEST(OptimisticBTreeDefaultNodeTest, LargeTree) {
+  OptimisticBTree<int64_t> tree;
+  constexpr int64_t kNumItems = 100000;
+  for (int64_t i = 0; i < kNumItems; i++) {
+    ASSERT_TRUE(tree.add(i * 7 % kNumItems));
+  }
+  for (int64_t i = 0; i < kNumItems; i++) {
+    ASSERT_TRUE(tree.contains(i));
+  }
+  int64_t expected = 0;
+  tree.for_each_in_range(0, kNumItems, [&](int64_t item) {
+    EXPECT_EQ(item, expected);
+    expected++;
+  });
+  EXPECT_EQ(expected, kNumItems);
+}
+
+TEST_F(OptimisticBTreeTest, ConcurrentAddDifferentItems) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 2000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([this, t]() {
+      // Interleaved items, so that threads split the same nodes
+      for (int i = 0; i < kItemsPerThread; i++) {
+        EXPECT_TRUE(tree_.add(i * kNumThreads + t));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumThreads * kItemsPerThread; i++) {
+    ASSERT_TRUE(tree_.contains(i));
+  }
+}
+
+TEST_F(OptimisticBTreeTest, ConcurrentAddRemoveSameItems) {
+  // Every thread adds and removes the same items; for each item, the number
+  // of successful adds minus successful removes is whether it ends up present
+  constexpr int kNumThreads = 4;
+  constexpr int kNumItems = 500;
+  constexpr int kOpsPerThread = 20000;
+
+  std::vector<std::atomic<int>> balance(kNumItems);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<> dist(0, kNumItems - 1);
+      for (int i = 0; i < kOpsPerThread; i++) {
+        int item = dist(gen);
+        if (gen() % 2 == 0) {
+          balance[item] += tree_.add(item);
+        } else {
+          balance[item] -= tree_.remove(item);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < kNumItems; i++) {
+    ASSERT_TRUE(balance[i] == 0 || balance[i] == 1);
+    EXPECT_EQ(tree_.contains(i), balance[i] == 1);
+  }
+}
+
+TEST_F(OptimisticBTreeTest, ConcurrentReadersSeeStableItems) {
+  // Even items stay in the tree while writers add and remove odd ones, which
+  // splits nodes under the readers; every lookup and scan must still find each
+  // even item exactly once, in order
+  constexpr int kNumItems = 4000;
+  constexpr int kNumWriters = 3;
+  constexpr int kNumScans = 100;
+
+  for (int i = 0; i < kNumItems; i += 2) {
+    EXPECT_TRUE(tree_.add(i));
+  }
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (int t = 0; t < kNumWriters; t++) {
+    writers.emplace_back([this, &done, t]() {
+      std::mt19937 gen(t);
+      std::uniform_int_distribution<> dist(0, kNumItems / 2 - 1);
+      while (!done.load()) {
+        int value = 2 * dist(gen) + 1;
+        tree_.add(value);
+        tree_.remove(value);
+      }
+    });
+  }
+
+  for (int scan = 0; scan < kNumScans; scan++) {
+    std::vector<int> evens;
+    tree_.for_each_in_range(0, kNumItems, [&](int item) {
+      if (item % 2 == 0) {
+        evens.push_back(item);
+      }
+    });
+    ASSERT_EQ(evens.size(), static_cast<size_t>(kNumItems / 2));
+    for (int i = 0; i < kNumItems / 2; i++) {
+      ASSERT_EQ(evens[i], 2 * i);
+    }
+    for (int i = scan; i < kNumItems; i += 97) {
+      if (i % 2 == 0) {
+        ASSERT_TRUE(tree_.contains(i));
+      }
+    }
+  }
+
+  done.store(true);
+  for (auto& writer : writers) {
+    writer.join();
+  }
+}
@@ -74,8 +74,11 @@ TEST_F(AtomicStampedPtrTest, ConcurrentUpdates) {
     thread.join();
   }
 
+  // Stamps wrap around with the packed representation
   uint64_t final_stamp = atomic_stamped_ptr_->get_stamp();
-  EXPECT_EQ(successful_updates.load(std::memory_order_relaxed), final_stamp);
+  EXPECT_EQ(successful_updates.load(std::memory_order_relaxed) &
+                AtomicStampedPtr<int>::kMaxStamp,
+            final_stamp);
 }
 
 // Test ABA Prevention
@@ -112,3 +115,36 @@ TEST_F(AtomicStampedPtrTest, ABAProtection) {
   delete B;
   delete C;
 }
+
+// The default representation never takes a lock
+static_assert(AtomicStampedPtr<int>::kIsLockFree);
+static_assert(AtomicStampedPtr<int, PackedStamp>::kIsLockFree);
+
+template<typename Stamp>
+class AtomicStampedPtrRepresentationTest : public ::testing::Test {};
+
+using Representations = ::testing::Types<WideStamp, PackedStamp>;
+TYPED_TEST_SUITE(AtomicStampedPtrRepresentationTest, Representations);
+
+TYPED_TEST(AtomicStampedPtrRepresentationTest, KeepsPointerAndStamp) {
+  int value = 0;
+  AtomicStampedPtr<int, TypeParam> ptr;
+  EXPECT_EQ(ptr.get(), std::make_pair(static_cast<int*>(nullptr), uint64_t{0}));
+  ptr.set(&value, 7);
+  EXPECT_EQ(ptr.get_ptr(), &value);
+  EXPECT_EQ(ptr.get_stamp(), 7);
+  EXPECT_FALSE(ptr.compare_and_swap(&value, nullptr, 6, 8));
+  EXPECT_TRUE(ptr.compare_and_swap(&value, nullptr, 7, 8));
+  EXPECT_EQ(ptr.get(), std::make_pair(static_cast<int*>(nullptr), uint64_t{8}));
+}
+
+TYPED_TEST(AtomicStampedPtrRepresentationTest, StampWrapsAround) {
+  using Ptr = AtomicStampedPtr<int, TypeParam>;
+  int value = 0;
+  Ptr ptr(&value, Ptr::kMaxStamp);
+  EXPECT_EQ(ptr.get_stamp(), Ptr::kMaxStamp);
+  EXPECT_TRUE(
+      ptr.compare_and_swap(&value, &value, Ptr::kMaxStamp, Ptr::kMaxStamp + 1));
+  EXPECT_EQ(ptr.get_stamp(), 0);
+  EXPECT_EQ(ptr.get_ptr(), &value);
+}
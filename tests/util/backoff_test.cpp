@@ -0,0 +1,62 @@
+#include "util/backoff.h"
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// Test that every value of a small range comes up, and nothing outside it.
+TEST(GetRandomIntTest, CoversTheRangeAndStaysInside) {
+  std::vector<int> counts(11);
+  for (int i = 0; i < 11000; i++) {
+    int value = get_random_int<int>(-5, 5);
+    ASSERT_GE(value, -5);
+    ASSERT_LE(value, 5);
+    counts[value + 5]++;
+  }
+  for (int count : counts) {
+    // 1000 expected per value
+    EXPECT_GT(count, 700);
+    EXPECT_LT(count, 1300);
+  }
+}
+
+// Test the degenerate and full ranges.
+TEST(GetRandomIntTest, SingleValueAndFullRange) {
+  EXPECT_EQ(get_random_int<long>(7, 7), 7);
+  std::set<uint64_t> values;
+  for (int i = 0; i < 100; i++) {
+    values.insert(get_random_int<unsigned long long>(
+        0, std::numeric_limits<unsigned long long>::max()));
+  }
+  EXPECT_GT(values.size(), 90);
+}
+
+// Test that threads do not share a sequence.
+TEST(GetRandomIntTest, ThreadsDrawDifferentSequences) {
+  std::vector<uint64_t> first(2);
+  std::thread a([&first]() { first[0] = random_uint64(); });
+  std::thread b([&first]() { first[1] = random_uint64(); });
+  a.join();
+  b.join();
+  EXPECT_NE(first[0], first[1]);
+}
+
+// Test that delays below the spin threshold are spun through without
+// sleeping, which would take tens of microseconds per call.
+TEST(BackoffTest, SpinsThroughShortDelays) {
+  EXPECT_GE(pauses_per_microsecond(), 1);
+
+  Backoff<std::chrono::microseconds> backoff{10, 10};
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 100; i++) {
+    backoff.backoff();
+  }
+  // At most 100 delays of 10us, plus generous slack for preemption
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(500));
+}
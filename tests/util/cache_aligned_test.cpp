@@ -0,0 +1,41 @@
+#include "util/cache_aligned.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(CacheAlignedTest, OccupiesWholeCacheLines) {
+  static_assert(alignof(CacheAligned<char>) == kCacheLineSize);
+  static_assert(sizeof(CacheAligned<char>) == kCacheLineSize);
+  static_assert(sizeof(CacheAligned<char[kCacheLineSize + 1]>) ==
+                2 * kCacheLineSize);
+
+  // Consecutive elements never share a cache line
+  std::vector<CacheAligned<std::atomic<int>>> counters(4);
+  for (const auto& counter : counters) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(&*counter) % kCacheLineSize, 0U);
+  }
+}
+
+TEST(CacheAlignedTest, MembersAfterAnAlignedMemberStartANewLine) {
+  struct Layout {
+    CacheAligned<std::atomic<int>> first_;
+    int second_;
+    CacheAligned<std::atomic<int>> third_;
+  };
+  static_assert(offsetof(Layout, second_) == kCacheLineSize);
+  static_assert(offsetof(Layout, third_) == 2 * kCacheLineSize);
+}
+
+TEST(CacheAlignedTest, ForwardsConstructorArgumentsAndAccess) {
+  CacheAligned<std::atomic<int>> counter{41};
+  counter->fetch_add(1);
+  EXPECT_EQ(counter->load(), 42);
+
+  CacheAligned<std::vector<int>> values(3, 7);
+  EXPECT_EQ(values->size(), 3U);
+  EXPECT_EQ((*values)[2], 7);
+}
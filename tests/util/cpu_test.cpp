@@ -0,0 +1,42 @@
+#include "util/cpu.h"
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+TEST(CpuTest, CycleCounterAdvancesWithTime) {
+  EXPECT_GT(cycles_per_nanosecond(), 0.0);
+  uint64_t start = read_cycle_counter();
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  uint64_t elapsed = read_cycle_counter() - start;
+  // At least a millisecond's worth of ticks, allowing for calibration error
+  EXPECT_GE(static_cast<double>(elapsed), 1e6 * cycles_per_nanosecond());
+}
+
+TEST(CpuTest, CycleDeadlineExpires) {
+  using Clock = std::chrono::steady_clock;
+  EXPECT_TRUE(CycleDeadline(Clock::time_point::min()).expired());
+  EXPECT_TRUE(CycleDeadline(Clock::now() - std::chrono::seconds(1)).expired());
+  EXPECT_FALSE(CycleDeadline(Clock::time_point::max()).expired());
+
+  auto start = Clock::now();
+  CycleDeadline deadline(start + std::chrono::milliseconds(5));
+  EXPECT_FALSE(deadline.expired());
+  while (!deadline.expired()) {
+    cpu_relax();
+  }
+  auto elapsed = Clock::now() - start;
+  EXPECT_GE(elapsed, std::chrono::milliseconds(4));
+  EXPECT_LT(elapsed, std::chrono::seconds(1));
+}
+
+TEST(CpuTest, PrefetchAcceptsAnyAddress) {
+  int value = 0;
+  prefetch_read(&value);
+  prefetch_write(&value);
+  // Prefetching never faults, even on a null or dangling address
+  prefetch_read(nullptr);
+  EXPECT_EQ(value, 0);
+}
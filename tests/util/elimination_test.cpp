@@ -0,0 +1,61 @@
+#include "util/elimination.h"
+
+#include <chrono>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+#include "gtest/gtest.h"
+
+TEST(LockFreeExchangerTest, TryExchangeTimesOutWithoutThrowing) {
+  LockFreeExchanger<int> exchanger;
+  int item = 1;
+  bool collided = true;
+  EXPECT_FALSE(exchanger.try_exchange(&item, 100, collided).has_value());
+  EXPECT_FALSE(collided);
+  EXPECT_THROW(exchanger.exchange(&item, std::chrono::microseconds(10)),
+               TimeoutException);
+}
+
+TEST(LockFreeExchangerTest, PartnersSwapItems) {
+  LockFreeExchanger<int> exchanger;
+  int first = 1;
+  int second = 2;
+  int* received_by_first = nullptr;
+  std::thread partner([&]() {
+    received_by_first = exchanger.exchange(&first, std::chrono::seconds(10));
+  });
+  EXPECT_EQ(exchanger.exchange(&second, std::chrono::seconds(10)), &first);
+  partner.join();
+  EXPECT_EQ(received_by_first, &second);
+}
+
+TEST(EliminationArrayTest, VisitWithoutPartnerFails) {
+  EliminationArray<int> array(4, 16);
+  int item = 1;
+  EXPECT_EQ(array.size(), 4);
+  EXPECT_FALSE(array.visit(&item).has_value());
+}
+
+TEST(EliminationArrayTest, PartnersMeetInASingleSlot) {
+  EliminationArray<int> array(1, 1 << 30);
+  int first = 1;
+  int second = 2;
+  std::optional<int*> received_by_first;
+  std::thread partner([&]() { received_by_first = array.visit(&first); });
+  EXPECT_EQ(array.visit(&second), &first);
+  partner.join();
+  EXPECT_EQ(received_by_first, &second);
+}
+
+TEST(EliminationPolicyTest, ArraysMatchThePolicy) {
+  static_assert(!NoElimination::kEnabled);
+  static_assert(std::is_empty_v<NoElimination::Array<int>>);
+
+  using Policy = WithElimination<3, 8>;
+  static_assert(Policy::kEnabled);
+  Policy::Array<int> array;
+  EXPECT_EQ(array.size(), 3);
+  int item = 1;
+  EXPECT_FALSE(array.visit(&item).has_value());
+}
@@ -0,0 +1,73 @@
+#include "util/node_value.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "queue/lock_free_queue.h"
+#include "queue/unbounded_queue.h"
+
+struct Handle {
+  uint32_t index_;
+  uint32_t generation_;
+};
+
+static_assert(InlineValue<int>);
+static_assert(InlineValue<uint64_t>);
+static_assert(InlineValue<int*>);
+static_assert(InlineValue<Handle>);
+static_assert(!InlineValue<std::string>);
+static_assert(!InlineValue<std::unique_ptr<int>>);
+static_assert(!InlineValue<__int128>);
+
+// Inline values take no more room than the value itself
+static_assert(sizeof(NodeValue<uint64_t>) == sizeof(uint64_t));
+static_assert(sizeof(NodeValue<Handle>) == sizeof(Handle));
+static_assert(sizeof(NodeValue<std::string>) ==
+              sizeof(std::optional<std::string>));
+
+TEST(NodeValueTest, InlineValue) {
+  NodeValue<Handle> value(std::in_place, Handle{3, 7});
+  Handle handle = value.take();
+  EXPECT_EQ(handle.index_, 3U);
+  EXPECT_EQ(handle.generation_, 7U);
+
+  NodeValue<uint64_t> sentinel;
+  sentinel.emplace(42U);
+  EXPECT_EQ(sentinel.take(), 42U);
+  sentinel.reset();
+}
+
+TEST(NodeValueTest, OptionalValue) {
+  NodeValue<std::unique_ptr<int>> value(std::in_place, new int(5));
+  std::unique_ptr<int> item = value.take();
+  ASSERT_NE(item, nullptr);
+  EXPECT_EQ(*item, 5);
+
+  value.emplace(new int(6));
+  value.reset();
+  value.emplace(new int(7));
+  EXPECT_EQ(*value.take(), 7);
+}
+
+// Test that queues of 8-byte handles, which keep them inline, still hand
+// them back in order
+TEST(NodeValueTest, QueuesOfInlineValues) {
+  LockFreeQueue<uint64_t> lock_free_queue;
+  UnboundedQueue<Handle> unbounded_queue;
+  for (uint32_t i = 0; i < 100; i++) {
+    lock_free_queue.enqueue(i);
+    unbounded_queue.emplace(Handle{i, i + 1});
+  }
+  for (uint32_t i = 0; i < 100; i++) {
+    EXPECT_EQ(lock_free_queue.dequeue(), i);
+    Handle handle = unbounded_queue.dequeue();
+    EXPECT_EQ(handle.index_, i);
+    EXPECT_EQ(handle.generation_, i + 1);
+  }
+  EXPECT_FALSE(lock_free_queue.try_dequeue().has_value());
+  EXPECT_FALSE(unbounded_queue.try_dequeue().has_value());
+}
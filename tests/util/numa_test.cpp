@@ -0,0 +1,24 @@
+#include "util/numa.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(NumaTest, ParsesCpuLists) {
+  EXPECT_EQ(parse_cpu_list("0"), std::vector<int>({0}));
+  EXPECT_EQ(parse_cpu_list("0-3,8,10-11\n"),
+            std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_TRUE(parse_cpu_list("").empty());
+}
+
+// Test that every machine has at least one node, and that the calling thread
+// maps to one of them.
+TEST(NumaTest, ThreadRunsOnAKnownNode) {
+  EXPECT_GE(numa_node_count(), 1);
+  EXPECT_LT(this_thread_numa_node(), numa_node_count());
+  size_t num_cpus = 0;
+  for (size_t node = 0; node < numa_node_count(); node++) {
+    num_cpus += NumaMap::instance().cpus(node).size();
+  }
+  EXPECT_GE(num_cpus, 1);
+}
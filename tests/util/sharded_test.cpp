@@ -0,0 +1,120 @@
+#include "util/sharded.h"
+
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "list/lazy_list.h"
+#include "queue/lock_free_queue.h"
+#include "stack/lock_free_stack.h"
+
+TEST(ShardedTest, ItemsLiveInTheShardOfTheirHash) {
+  Sharded<LazyList<int>, 4> set;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(set.add(i));
+  }
+  EXPECT_FALSE(set.add(42));
+  EXPECT_EQ(set.size(), 100U);
+
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(set.shard_for(i).contains(i));
+  }
+  for (int i = 0; i < 100; i += 2) {
+    EXPECT_TRUE(set.remove(i));
+  }
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(set.contains(i), i % 2 == 1);
+  }
+
+  std::vector<int> items;
+  set.for_each([&items](int item) { items.push_back(item); });
+  std::sort(items.begin(), items.end());
+  ASSERT_EQ(items.size(), 50U);
+  EXPECT_EQ(items.front(), 1);
+  EXPECT_EQ(items.back(), 99);
+}
+
+TEST(ShardedTest, ApproxSizeSumsShards) {
+  Sharded<LockFreeQueue<int>, 4, ThreadPlacement> queue;
+  for (size_t s = 0; s < 4; s++) {
+    for (size_t i = 0; i <= s; i++) {
+      queue.shard(s).enqueue(static_cast<int>(i));
+    }
+  }
+  EXPECT_EQ(queue.approx_size(), 10U);
+  queue.try_dequeue();
+  EXPECT_EQ(queue.approx_size(), 9U);
+}
+
+TEST(ShardedTest, DequeueStealsFromOtherShards) {
+  Sharded<LockFreeQueue<int>, 4, ThreadPlacement> queue;
+  // Items enqueued into every shard but the local one are still found
+  for (size_t s = 0; s < 4; s++) {
+    queue.shard(s).enqueue(static_cast<int>(s));
+  }
+  std::vector<int> items;
+  while (std::optional<int> item = queue.try_dequeue()) {
+    items.push_back(*item);
+  }
+  std::sort(items.begin(), items.end());
+  EXPECT_EQ(items, (std::vector<int>{0, 1, 2, 3}));
+  EXPECT_FALSE(queue.try_dequeue().has_value());
+}
+
+TEST(ShardedTest, LocalShardKeepsFifoOrder) {
+  Sharded<LockFreeQueue<int>, 8, ThreadPlacement> queue;
+  for (int i = 0; i < 10; i++) {
+    queue.enqueue(i);
+  }
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(queue.try_dequeue(), i);
+  }
+}
+
+TEST(ShardedTest, ConcurrentProducersAndConsumers) {
+  constexpr int kNumThreads = 4;
+  constexpr int kItemsPerThread = 10000;
+  Sharded<LockFreeStack<int>, kNumThreads, CpuPlacement> stack;
+
+  std::atomic<int64_t> sum{0};
+  std::atomic<int> popped{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kItemsPerThread; i++) {
+        stack.push(t * kItemsPerThread + i);
+      }
+      int value = 0;
+      while (popped.load() < kNumThreads * kItemsPerThread) {
+        if (stack.try_pop(value)) {
+          sum += value;
+          popped++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  int64_t n = kNumThreads * kItemsPerThread;
+  EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+  int value = 0;
+  EXPECT_FALSE(stack.try_pop(value));
+}
+
+TEST(ShardedTest, PinnedThreadStaysOnItsCpuShard) {
+  int cpu = this_thread_cpu();
+  if (cpu < 0) {
+    GTEST_SKIP() << "the CPU of a thread is unknown on this platform";
+  }
+  std::thread pinned([cpu]() {
+    ASSERT_TRUE(pin_this_thread_to_cpu(cpu));
+    EXPECT_EQ(this_thread_cpu(), cpu);
+    EXPECT_EQ(CpuPlacement::this_thread_shard(4), static_cast<size_t>(cpu) % 4);
+  });
+  pinned.join();
+}
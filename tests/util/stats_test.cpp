@@ -0,0 +1,76 @@
+#include "util/stats.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "queue/lock_free_queue.h"
+#include "synchronization/mcs_lock.h"
+#include "synchronization/ttas_lock.h"
+
+// Built with LAMP_STATS (see CMakeLists.txt), so the macros count.
+
+// Test that the counts of threads that have exited are kept.
+TEST(StatsTest, SumsLiveAndExitedThreads) {
+  constexpr int kNumThreads = 4;
+  StatsSnapshot before = Stats::snapshot();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([]() {
+      for (int i = 0; i < 100; i++) {
+        LAMP_STAT_INC(Stat::kFindRestarts);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  LAMP_STAT_ADD(Stat::kFindRestarts, 5);
+  StatsSnapshot delta = Stats::snapshot() - before;
+  EXPECT_EQ(delta[Stat::kFindRestarts], kNumThreads * 100 + 5);
+  EXPECT_EQ(delta[Stat::kAcquisitions], 0);
+}
+
+// Test that every lock() counts once, and that contended ones are a subset.
+template<typename LockType>
+static auto check_lock_stats() -> void {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumIterations = 1000;
+  LockType lock;
+  int counter = 0;
+  StatsSnapshot before = Stats::snapshot();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&lock, &counter]() {
+      for (int i = 0; i < kNumIterations; i++) {
+        lock.lock();
+        counter++;
+        lock.unlock();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  StatsSnapshot delta = Stats::snapshot() - before;
+  EXPECT_EQ(counter, kNumThreads * kNumIterations);
+  EXPECT_EQ(delta[Stat::kAcquisitions], kNumThreads * kNumIterations);
+  EXPECT_LE(delta[Stat::kContendedAcquisitions], delta[Stat::kAcquisitions]);
+}
+
+TEST(StatsTest, CountsLockAcquisitions) {
+  check_lock_stats<MCSLock<>>();
+  check_lock_stats<TTASLock<>>();
+}
+
+// Test that an uncontended lock-free operation does not count a retry.
+TEST(StatsTest, UncontendedQueueDoesNotRetry) {
+  LockFreeQueue<int> queue;
+  StatsSnapshot before = Stats::snapshot();
+  for (int i = 0; i < 100; i++) {
+    queue.enqueue(i);
+  }
+  while (queue.try_dequeue().has_value()) {}
+  StatsSnapshot delta = Stats::snapshot() - before;
+  EXPECT_EQ(delta[Stat::kCasFailures], 0);
+}
@@ -0,0 +1,28 @@
+#include "util/thread_index.h"
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// Test that a thread keeps its index.
+TEST(ThreadIndexTest, StableWithinAThread) {
+  EXPECT_EQ(this_thread_index(), this_thread_index());
+}
+
+// Test that concurrent threads get distinct indices.
+TEST(ThreadIndexTest, DistinctAcrossThreads) {
+  constexpr int kNumThreads = 8;
+  std::vector<size_t> indices(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&indices, t]() { indices[t] = this_thread_index(); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  indices.push_back(this_thread_index());
+  EXPECT_EQ(std::set<size_t>(indices.begin(), indices.end()).size(),
+            indices.size());
+}